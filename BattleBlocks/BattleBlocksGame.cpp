@@ -15,11 +15,28 @@
 #include <VEDirectionalLight.h>
 #include <VEPointLight.h>
 #include <VESpotLight.h>
+#include <VEMemoryTracker.h>
+#include <VEFrameScheduler.h>
+#include <VEInputService.h>
+#include <VEWorldStore.h>
+#include <VEWorldCache.h>
+#include <VEChunk.h>
 
 
 // ----------------- Defines ----------------
 
-#define SIXTY_FPS 0.016f
+// The rate the game simulates at, and the most frames drawn per second
+#define SIMULATION_RATE		60.0
+#define FRAME_RATE_CAP		60.0
+
+// Where the world is saved, in the data directory
+#define WORLD_DIRECTORY		L"World/"
+
+// Where generated chunks & their meshes are cached, in the data directory
+#define CACHE_DIRECTORY		L"Cache/"
+
+// The timings of the engine's startup tasks & the time to the first frame, written to the data directory
+#define STARTUP_REPORT		L"StartupReport.txt"
 
 
 // ----------------- Statics ----------------
@@ -99,9 +116,11 @@ bool BattleBlocksGame::Initialise( int aScreenWidth /* 1024 */, int aScreenHeigh
 		return false;
 	}
 	
-	// Initialise the engine
+	// Initialise the engine, generating the world alongside the engine's own startup
 	VoxelEngine* voxelEngine = VoxelEngine::GetInstance();
 	assert( voxelEngine != NULL );
+
+	voxelEngine->AddStartupTask( "World", BattleBlocksGame::GenerateWorldTask, this, SR_Systems | SR_Device, SR_World );
 	
 	if( !voxelEngine->Initialise(myGameInstance, myWindowHandle, myScreenWidth, myScreenHeight, myFullScreen, myVsync, dataDirectory) )
 	{
@@ -112,11 +131,14 @@ bool BattleBlocksGame::Initialise( int aScreenWidth /* 1024 */, int aScreenHeigh
 	myLocalPlayer = new LocalPlayer();
 	myLocalPlayer->Initialise( true );
 
-	// Add a box voxel to the world
-	voxelEngine->GetTerrainGenerator()->GenerateTerrain( 2, 2 );
-
-	// Create an input processor
+	// Create an input processor, it's handed key presses as they arrive
 	myInputProcessor = new SystemInputProcessor();
+	voxelEngine->GetInputService()->AddListener( SystemInputProcessor::OnInputEvent, myInputProcessor );
+
+	// Pace the game loop
+	myFrameScheduler = new VEFrameScheduler();
+	myFrameScheduler->SetSimulationRate( SIMULATION_RATE );
+	myFrameScheduler->SetFrameRateCap( FRAME_RATE_CAP );
 
 	// Add a couple of lights in to the current scene
 // 	VELightingManager* lightingManager = voxelEngine->GetLightingManager();
@@ -165,6 +187,7 @@ void BattleBlocksGame::Uninitialise()
 
 	if( myInputProcessor != NULL )
 	{
+		VoxelEngine::GetInstance()->GetInputService()->RemoveListener( SystemInputProcessor::OnInputEvent, myInputProcessor );
 		delete myInputProcessor;
 
 		myInputProcessor = NULL;
@@ -176,6 +199,12 @@ void BattleBlocksGame::Uninitialise()
 		myLocalPlayer = NULL;
 	}
 
+	if( myFrameScheduler != NULL )
+	{
+		delete myFrameScheduler;
+		myFrameScheduler = NULL;
+	}
+
 	// Unregister the application
 	if( myGameInstance != NULL )
 	{
@@ -186,6 +215,8 @@ void BattleBlocksGame::Uninitialise()
 	// Clean up the engine
 	if( VoxelEngine* voxelEngine = VoxelEngine::GetInstance() )
 	{
+		SaveWorld();
+
 		voxelEngine->Uninitialise();
 		VoxelEngine::Cleanup();
 	}
@@ -198,41 +229,57 @@ void BattleBlocksGame::Run()
 	MSG     message;
 	memset( &message, 0, sizeof(MSG) );
 	bool    finished = false;
-	
-	// Start the frame timer
-	StartFrameTimer();
+
+	VoxelEngine* voxelEngine = VoxelEngine::GetInstance();
+	assert( voxelEngine != NULL );
+
+	// Start pacing frames
+	myFrameScheduler->Start();
+
+	bool isStartupReported = false;
 
 	// Main game loop
 	while( !finished )
 	{
-		// Dispatch any messages
-		if( PeekMessage(&message, NULL, 0, 0, PM_REMOVE) )
+		// Dispatch every waiting message, if one is WM_QUIT end the game loop
+		while( PeekMessage(&message, NULL, 0, 0, PM_REMOVE) )
 		{
+			if( message.message == WM_QUIT )
+			{
+				finished = true;
+				break;
+			}
+
 			TranslateMessage( &message );
 			DispatchMessage( &message );
 		}
 
-		// If the message is WM_QUIT, end the game loop
-		if( message.message == WM_QUIT )
+		if( finished )
 		{
-			finished = true;
+			break;
 		}
-		// Otherwise perform an engine update
-		else
-		{
-			myFrameTime += GetFrameTime();
 
-			// Restrict the engine updates to 60fps
-			if( myFrameTime > SIXTY_FPS )
-			{
-				// Update the engine
-				VoxelEngine::GetInstance()->Update( SIXTY_FPS );
+		// Sleep until the next frame is due, then step the engine by the time that's passed. Each step starts by
+		// delivering the input that's arrived to the player & input processor. Only the last step is drawn, and a
+		// frame with no steps due has nothing new to draw
+		unsigned int	stepCount	= myFrameScheduler->BeginFrame();
+		float			timeStep	= (float)myFrameScheduler->GetTimeStep();
+
+		for( unsigned int i = 0; i < stepCount; i++ )
+		{
+			voxelEngine->Update( timeStep, i == stepCount - 1 );
 
-				// Update the input processor
-				myInputProcessor->Update( myFrameTime );
+#ifdef VE_MEMORY_TRACKING
+			// Player input, messaging & movement shouldn't touch the heap once the game is running
+			assert( voxelEngine->GetObjectUpdateAllocations() == 0 );
+#endif
+		}
 
-				myFrameTime = 0.0f;
-			}
+		// Once the first frame's been drawn the startup's complete
+		if( !isStartupReported && voxelEngine->GetTimeToFirstFrame() > 0.0 )
+		{
+			voxelEngine->WriteStartupReport( voxelEngine->GetDataDirectory() + STARTUP_REPORT );
+			isStartupReported = true;
 		}
 	}
 }
@@ -256,14 +303,29 @@ BattleBlocksGame::BattleBlocksGame() :
 	myScreenWidth( 1024 ),
 	myScreenHeight( 768 ),
 	myInputProcessor( NULL ),
-	myFrameTime( 0.0 ),
-	myOldFrameTime( 0 ),
-	myTicksPerSecond( 0.0 ),
+	myFrameScheduler( NULL ),
 	myLocalPlayer( NULL )
 {
 }
 
 
+// Opens the saved world & the cache and generates the terrain, run by the engine's startup graph
+void BattleBlocksGame::GenerateWorldTask( void* aGame )
+{
+	VoxelEngine*	voxelEngine		= VoxelEngine::GetInstance();
+	std::wstring	dataDirectory	= voxelEngine->GetDataDirectory();
+
+	// Open the saved world, if there isn't one it's generated & saved on exit
+	voxelEngine->GetWorldStore()->Open( dataDirectory + WORLD_DIRECTORY );
+
+	// Chunks generated on an earlier run are loaded from the cache, along with their meshes
+	voxelEngine->GetWorldCache()->Open( dataDirectory + CACHE_DIRECTORY );
+
+	// Add a box voxel to the world
+	voxelEngine->GetTerrainGenerator()->GenerateTerrain( 2, 2 );
+}
+
+
 // Registers the BattleBlocks game window
 bool BattleBlocksGame::RegisterGameWindow()
 {
@@ -354,32 +416,22 @@ bool BattleBlocksGame::CreateGameWindow()
 }
 
 
-// Starts/restarts high performance timer
-void BattleBlocksGame::StartFrameTimer()
+// Saves the chunks that have changed since they were loaded, the engine finishes writing them as it shuts down
+void BattleBlocksGame::SaveWorld()
 {
-	LARGE_INTEGER frequencyCount;
-	QueryPerformanceFrequency( &frequencyCount );
-
-	myTicksPerSecond = (double)frequencyCount.QuadPart;
-}
-
-
-// Returns the number of milliseconds that have elapsed since the last time
-// this function was called
-float BattleBlocksGame::GetFrameTime()
-{
-	LARGE_INTEGER	currentTime;
-	float			tickCount;
-
-	QueryPerformanceCounter( &currentTime );
-
-	tickCount		= (float)(currentTime.QuadPart - myOldFrameTime);
-	myOldFrameTime	= currentTime.QuadPart;
-
-	if( tickCount < 0 )
+	VoxelEngine*	voxelEngine	= VoxelEngine::GetInstance();
+	VEWorldStore*	worldStore	= voxelEngine->GetWorldStore();
+	if( worldStore == NULL || !worldStore->GetIsOpen() )
 	{
-		tickCount = 0;
+		return;
 	}
 
-	return (float)((tickCount) / myTicksPerSecond);
+	const std::vector<VEChunk*>& chunks = voxelEngine->GetChunkManager()->GetChunks();
+	for( unsigned int i = 0; i < chunks.size(); i++ )
+	{
+		if( chunks[i]->GetIsModified() )
+		{
+			worldStore->SaveChunk( chunks[i] );
+		}
+	}
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 // ---------- Forward Declarations ----------
 
 class VEFreeCamera;
+class VEFrameScheduler;
 class SystemInputProcessor;
 class LocalPlayer;
 
@@ -52,12 +53,11 @@ class BattleBlocksGame
 		// Creates the window used for rendering
 		bool	CreateGameWindow();
 
-		// Starts/restarts high performance timer
-		void	StartFrameTimer();
+		// Saves the chunks that have changed since they were loaded
+		void	SaveWorld();
 
-		// Returns the number of milliseconds that have elapsed since the last time
-		// this function was called
-		float	GetFrameTime();
+		// Opens the saved world & the cache and generates the terrain, run by the engine's startup graph
+		static void	GenerateWorldTask( void* aGame );
 
 
 		// ---------- Private Variables ---------
@@ -72,9 +72,7 @@ class BattleBlocksGame
 		int                         myScreenWidth;
 		int                         myScreenHeight;
 
-		float						myFrameTime;
-		__int64						myOldFrameTime;
-		double						myTicksPerSecond;
+		VEFrameScheduler*			myFrameScheduler;
 
 		SystemInputProcessor*		myInputProcessor;
 
@@ -8,6 +8,9 @@
 #include "PlayerCameraComponent.h"
 #include "PlayerPhysicsComponent.h"
 
+#include <VoxelEngine.h>
+#include <VEComponentService.h>
+
 
 // ------------------ Class Functions -----------------
 
@@ -24,8 +27,14 @@ bool LocalPlayer::Initialise( bool isDynamic /* = true */ )
 	VEObject::Initialise( isDynamic );
 	myPosition = DirectX::XMFLOAT3( 0.0f, 30.0f, 0.0f );
 
+	// Physics components live in a component system, so they're stored together and updated in one pass
+	VEComponentService* componentService = VoxelEngine::GetInstance()->GetComponentService();
+	assert( componentService != NULL );
+
+	componentService->RegisterSystem<PlayerPhysicsComponent>( GC_PlayerPhysics );
+
 	// Add the components
-	PlayerPhysicsComponent* physics = new PlayerPhysicsComponent( this );
+	PlayerPhysicsComponent* physics = componentService->CreateComponent<PlayerPhysicsComponent>( GC_PlayerPhysics, this );
 	physics->Initialise();
 	AddComponent( physics );
  	
@@ -15,11 +15,6 @@
 #include "VEObject.h"
 
 
-// -------------------------- Typedefs ------------------------
-
-typedef std::vector<VESmartPointer<VEComponentMessage>>::iterator MessageIterator;
-
-
 // ------------------------- Namespaces -----------------------
 
 using namespace DirectX;
@@ -106,43 +101,39 @@ void PlayerCameraComponent::Cleanup()
 // Processes messages in the queue
 void PlayerCameraComponent::ProcessMessages( float anElapsedTime )
 {
-	for( MessageIterator msg = myMessageQueue.begin(); msg != myMessageQueue.end(); msg++ )
+	while( !myMessageQueue.IsEmpty() )
 	{
-		switch( (*msg)->GetType() )
+		VEComponentMessage* message = myMessageQueue.Front();
+		switch( message->GetType() )
 		{
 			case MT_MouseMove :
-				{
-					MouseMoveMessage* moveMessage = dynamic_cast<MouseMoveMessage*>( &(*msg) );
-					HandleMouseMoveMessage( moveMessage, anElapsedTime );
-				}
+				HandleMouseMoveMessage( static_cast<MouseMoveMessage*>(message) );
 				break;
 
 			default :
 				break;
 		}
 
-		(*msg) = NULL;
+		myMessageQueue.Pop();
 	}
-
-	myMessageQueue.clear();
 }
 
 
-// Applies data from the move message to the active camera
-void PlayerCameraComponent::HandleMouseMoveMessage( MouseMoveMessage* aMoveMessage, float anElapsedTime )
+// Applies data from the move message to the active camera. The delta is the whole turn, rather than a rate
+void PlayerCameraComponent::HandleMouseMoveMessage( MouseMoveMessage* aMoveMessage )
 {
 	assert( aMoveMessage != NULL );
 	switch( aMoveMessage->GetAxis() )
 	{
 		case MouseMoveMessage::MX_Pitch :
 			{
-				myCamera->AddPitch( aMoveMessage->GetDelta() * anElapsedTime );
+				myCamera->AddPitch( aMoveMessage->GetDelta() );
 			}
 			break;
 
 		case MouseMoveMessage::MX_Yaw :
 			{
-				myCamera->AddYaw( aMoveMessage->GetDelta() * anElapsedTime );
+				myCamera->AddYaw( aMoveMessage->GetDelta() );
 			}
 			break;
 
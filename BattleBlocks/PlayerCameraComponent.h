@@ -52,8 +52,8 @@ class PlayerCameraComponent : public VEObjectComponent
 
 		// ---- Private Functions -----
 
-		// Applies data from the move message to the active camera
-		void			HandleMouseMoveMessage( MouseMoveMessage* aMoveMessage, float anElapsedTime );
+		// Applies data from the move message to the active camera. The delta is the whole turn, rather than a rate
+		void			HandleMouseMoveMessage( MouseMoveMessage* aMoveMessage );
 
 
 		// ---- Private Variables -----
@@ -5,7 +5,8 @@
 #include "PlayerInputComponent.h"
 
 #include "VoxelEngine.h"
-#include "VEDirectXInput.h"
+#include "VEInputService.h"
+#include "VEBasicCamera.h"
 
 #include "MoveEventMessage.h"
 #include "MouseMoveMessage.h"
@@ -13,20 +14,8 @@
 
 // -------------------------- Typedefs ------------------------
 
-typedef std::pair<PlayerAction, PlayerInputComponent::ActiveAction> ActionMap;
-
-
-// -------------------------- Structs -------------------------
-
-// Used for retrieving keys from a std::map
-struct GetKey
-{
-	template<typename T>
-	typename T::first_type operator()( T aKeyValuePair ) const
-	{
-		return aKeyValuePair.first;
-	}
-};
+typedef std::pair<PlayerAction, PlayerInputComponent::ActiveAction>			ActionMap;
+typedef std::map<PlayerAction, PlayerInputComponent::ActiveAction>::iterator	ActionIterator;
 
 
 // ---------------------- Class Functions ---------------------
@@ -34,8 +23,8 @@ struct GetKey
 // Construction
 PlayerInputComponent::PlayerInputComponent( VEObject* aParent ) : VEObjectComponent( GC_PlayerInput, aParent ),
 	myCurrentMovementSpeed( 10.0f ),
-	myPitchSensitivity( 0.05f ),
-	myYawSensitivity( 0.05f )
+	myPitchSensitivity( 0.0008f ),
+	myYawSensitivity( 0.0008f )
 {
 }
 
@@ -46,32 +35,7 @@ PlayerInputComponent::~PlayerInputComponent()
 }
 
 
-// Handles per-frame updates of the input component
-void PlayerInputComponent::Update( float anElapsedTime )
-{
-	VEObjectComponent::Update( anElapsedTime );
-
-	ProcessKeyboardInput();
-	ProcessMouseInput();
-
-	// Send the messages
-	for( std::vector<VEComponentMessage*>::iterator msg = myMessages.begin(); msg != myMessages.end(); msg++ )
-	{
-		if( (*msg)->IsValid() )
-		{
-			SendMessage( (*msg) );
-		}
-		else
-		{
-			delete (*msg);
-			(*msg) = NULL;
-		}
-	}
-	myMessages.clear();
-}
-
-
-// Initialises the key to action maps
+// Initialises the key to action maps, and starts listening for input
 bool PlayerInputComponent::Initialise()
 {
 	myKeyboardActionMap.insert( ActionMap(PA_MoveForward, ActiveAction(DIK_W)) );
@@ -82,10 +46,28 @@ bool PlayerInputComponent::Initialise()
 	myKeyboardActionMap.insert( ActionMap(PA_Walk, ActiveAction(DIK_LCONTROL)) );
 	myKeyboardActionMap.insert( ActionMap(PA_Jump, ActiveAction(DIK_SPACE)) );
 
+	VEInputService* inputService = VoxelEngine::GetInstance()->GetInputService();
+	assert( inputService != NULL );
+
+	inputService->AddListener( PlayerInputComponent::OnInputEvent, this );
+	inputService->SetLateLatch( PlayerInputComponent::LateLatchCamera, this );
+
 	return true;
 }
 
 
+// Stops listening for input
+void PlayerInputComponent::Cleanup()
+{
+	VEInputService* inputService = VoxelEngine::GetInstance()->GetInputService();
+	if( inputService != NULL )
+	{
+		inputService->RemoveListener( PlayerInputComponent::OnInputEvent, this );
+		inputService->SetLateLatch( NULL, NULL );
+	}
+}
+
+
 // Processes messages in the message queue
 void PlayerInputComponent::ProcessMessages( float anElapsedTime )
 {
@@ -93,54 +75,89 @@ void PlayerInputComponent::ProcessMessages( float anElapsedTime )
 }
 
 
-// Checks the keyboard for any input events
-void PlayerInputComponent::ProcessKeyboardInput()
+// Receives events from the input service
+void PlayerInputComponent::OnInputEvent( const VEInputEvent& anEvent, void* aComponent )
+{
+	PlayerInputComponent* component = reinterpret_cast<PlayerInputComponent*>( aComponent );
+	assert( component != NULL );
+
+	if( !component->GetEnabled() )
+	{
+		return;
+	}
+
+	switch( anEvent.myType )
+	{
+		case IE_KeyDown :
+		case IE_KeyUp :
+			component->ProcessKeyboardInput( anEvent );
+			break;
+
+		case IE_MouseMove :
+			component->ProcessMouseInput( anEvent );
+			break;
+
+		default :
+			break;
+	}
+}
+
+
+// Turns a frame's copy of the camera by the mouse movement the simulation hasn't seen yet, the same way
+// PlayerCameraComponent turns the camera once it has
+void PlayerInputComponent::LateLatchCamera( VEBasicCamera& aCamera, long aMouseX, long aMouseY, void* aComponent )
 {
-	VEDirectXInput* directInput = VoxelEngine::GetInstance()->GetInputInterface();
-	assert( directInput != NULL );
+	PlayerInputComponent* component = reinterpret_cast<PlayerInputComponent*>( aComponent );
+	assert( component != NULL );
 
-	// Get the keys for the player actions
-	std::vector<unsigned int> keys;
-	std::transform( myKeyboardActionMap.begin(), myKeyboardActionMap.end(), std::back_inserter(keys), GetKey() );
+	aCamera.RotateView( (float)aMouseY * component->myPitchSensitivity, (float)aMouseX * component->myYawSensitivity );
+}
 
-	// Loop through the player actions, creating the appropriate move/end move messages
-	for( std::vector<unsigned int>::iterator action = keys.begin(); action != keys.end(); action++ )
+
+// Sends begin/end move messages for a key that's changed
+void PlayerInputComponent::ProcessKeyboardInput( const VEInputEvent& anEvent )
+{
+	// Messages are built on the stack and copied in to the targets' message queues
+	for( ActionIterator action = myKeyboardActionMap.begin(); action != myKeyboardActionMap.end(); action++ )
 	{
-		PlayerAction currentAction = (PlayerAction)(*action);
+		ActiveAction& currentAction = action->second;
+		if( currentAction.myKey != anEvent.myKey )
+		{
+			continue;
+		}
 
 		// If the key is down and the player action isn't active, send a begin move message
-		if( directInput->IsKeyDown(myKeyboardActionMap[currentAction].myKey) )
+		if( anEvent.myType == IE_KeyDown )
 		{
-			if( !myKeyboardActionMap[currentAction].myActive )
+			if( !currentAction.myActive )
 			{
-				myMessages.push_back( new MoveEventMessage(MT_BeginMovement, currentAction) );
-				myKeyboardActionMap[currentAction].myActive = true;
+				SendMessage( MoveEventMessage(MT_BeginMovement, action->first) );
+				currentAction.myActive = true;
 			}
 		}
 		// If the key is up and the player action is active, send an end move message
-		else if( myKeyboardActionMap[currentAction].myActive )
+		else if( currentAction.myActive )
 		{
-			myMessages.push_back( new MoveEventMessage(MT_EndMovement, currentAction) );
-			myKeyboardActionMap[currentAction].myActive = false;
+			SendMessage( MoveEventMessage(MT_EndMovement, action->first) );
+			currentAction.myActive = false;
 		}
 	}
 }
 
 
-// Checks the mouse for any input events
-void PlayerInputComponent::ProcessMouseInput()
+// Sends mouse move messages for the mouse's movement
+void PlayerInputComponent::ProcessMouseInput( const VEInputEvent& anEvent )
 {
-	VEDirectXInput* directInput = VoxelEngine::GetInstance()->GetInputInterface();
-	assert( directInput != NULL );
-
-	// Check the pitch & yaw of the mouse to see if any message processing is required
-	if( directInput->MouseDeltaY() != 0 )
+	// The camera turns by the movement itself, so the turn doesn't depend on the frame rate
+	MouseMoveMessage pitchMessage( MouseMoveMessage::MX_Pitch, (float)anEvent.myMouseY * myPitchSensitivity );
+	if( pitchMessage.IsValid() )
 	{
-		myMessages.push_back( new MouseMoveMessage(MouseMoveMessage::MX_Pitch, (float)directInput->MouseY() * myYawSensitivity) );
+		SendMessage( pitchMessage );
 	}
 
-	if( directInput->MouseDeltaX() != 0 )
+	MouseMoveMessage yawMessage( MouseMoveMessage::MX_Yaw, (float)anEvent.myMouseX * myYawSensitivity );
+	if( yawMessage.IsValid() )
 	{
-		myMessages.push_back( new MouseMoveMessage(MouseMoveMessage::MX_Yaw, (float)directInput->MouseX() * myPitchSensitivity) );
+		SendMessage( yawMessage );
 	}
 }
\ No newline at end of file
@@ -9,10 +9,18 @@
 #include "Types.h"
 
 
+// -------------------- Forward Declarations ------------------
+
+struct VEInputEvent;
+class VEBasicCamera;
+
+
 // ------------------------- Classes --------------------------
 
-// Interacts with the DirectX to detect input from the keyboard/mouse, and sends the appropriate messages to
-// any registered object components
+// Listens to the engine's input service for keyboard/mouse events, and sends the appropriate messages to any
+// registered object components. Events are delivered before the frame's objects update, so the messages are
+// processed in the frame the input arrived in. Also late latches the camera, turning each frame's view by the mouse
+// movement that arrived after the frame was simulated
 class PlayerInputComponent : public VEObjectComponent
 {
 	public :
@@ -25,17 +33,13 @@ class PlayerInputComponent : public VEObjectComponent
 		// Deconstruction
 		~PlayerInputComponent();
 
-		// Handles per-frame updates of the input component
-		virtual void Update( float anElapsedTime ) override;
-
-
 		// ---- Required Functions ----
 
-		// // Initialises the key to action maps
+		// Initialises the key to action maps, and starts listening for input
 		virtual bool Initialise();
 
-		// Placeholder
-		virtual void Cleanup() override		{}
+		// Stops listening for input
+		virtual void Cleanup() override;
 
 
 		// -------- Accessors ---------
@@ -85,11 +89,17 @@ class PlayerInputComponent : public VEObjectComponent
 
 		// ---- Private Functions ----
 
-		// Checks the keyboard for any input events
-		void		ProcessKeyboardInput();		
+		// Receives events from the input service, with the component as the parameter
+		static void	OnInputEvent( const VEInputEvent& anEvent, void* aComponent );
+
+		// Turns a frame's copy of the camera by the mouse movement the simulation hasn't seen yet
+		static void	LateLatchCamera( VEBasicCamera& aCamera, long aMouseX, long aMouseY, void* aComponent );
 
-		// Checks the mouse for any input events
-		void		ProcessMouseInput();
+		// Sends begin/end move messages for a key that's changed
+		void		ProcessKeyboardInput( const VEInputEvent& anEvent );
+
+		// Sends mouse move messages for the mouse's movement
+		void		ProcessMouseInput( const VEInputEvent& anEvent );
 
 		// Checks the gamepad for any input events
 		void		ProcessGamepadInput();
@@ -101,8 +111,6 @@ class PlayerInputComponent : public VEObjectComponent
 		float									myCurrentMovementSpeed;
 		float									myPitchSensitivity;
 		float									myYawSensitivity;
-
-		std::vector<VEComponentMessage*>		myMessages;
 };
 
 
@@ -14,11 +14,6 @@
 #include "VEFirstPersonCamera.h"
 
 
-// -------------------- Typedefs --------------------
-
-typedef std::vector<VESmartPointer<VEComponentMessage>>::iterator MessageIterator;
-
-
 // -------------------- Namespaces ------------------
 
 using namespace DirectX;
@@ -58,35 +53,24 @@ bool PlayerPhysicsComponent::Initialise()
 // Processing incoming movement messages
 void PlayerPhysicsComponent::ProcessMessages( float anElapsedTime )
 {
-	for( MessageIterator msg = myMessageQueue.begin(); msg != myMessageQueue.end(); msg++ )
+	while( !myMessageQueue.IsEmpty() )
 	{
-		switch( (*msg)->GetType() )
+		VEComponentMessage* message = myMessageQueue.Front();
+		switch( message->GetType() )
 		{
 			case MT_BeginMovement :
-				{
-					MoveEventMessage* moveMessage = dynamic_cast<MoveEventMessage*>( &(*msg) );
-					assert( moveMessage != NULL );
-
- 					HandleBeginMoveMessage( moveMessage );
-				}
+				HandleBeginMoveMessage( static_cast<MoveEventMessage*>(message) );
 				break;
 
 			case MT_EndMovement :
-				{
-					MoveEventMessage* endMessage = dynamic_cast<MoveEventMessage*>( &(*msg) );
-					assert( endMessage != NULL );
-
-					HandleEndMoveMessage( endMessage );
-				}
+				HandleEndMoveMessage( static_cast<MoveEventMessage*>(message) );
 
 			default :
 				break;
 		}
 
-		(*msg) = NULL;
+		myMessageQueue.Pop();
 	}
-
-	myMessageQueue.clear();
 }
 
 
@@ -16,6 +16,9 @@
 // Windows codecs
 #pragma comment( lib, "windowscodecs.lib" )
 
+// The system timer's period, for the engine's clock
+#pragma comment( lib, "winmm.lib" )
+
 // Noise generation
 #pragma comment( lib, "libnoise.lib" )
 
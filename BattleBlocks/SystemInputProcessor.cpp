@@ -6,10 +6,11 @@
 
 #include <VoxelEngine.h>
 #include <VEFirstPersonCamera.h>
-#include <VEDirectXInput.h>
+#include <VEInputService.h>
 #include <VERenderManager.h>
 #include <VEChunkManager.h>
 #include <VEChunk.h>
+#include <VEProfiler.h>
 
 
 // ---------------- Class Functions ---------------
@@ -23,49 +24,78 @@ SystemInputProcessor::SystemInputProcessor() :
 }
 
 
-// Updates the game/engine state based on mouse/keyboard input
-void SystemInputProcessor::Update( float anElapsedTime )
+// Updates the game/engine state based on keyboard input
+void SystemInputProcessor::OnInputEvent( const VEInputEvent& anEvent, void* aProcessor )
 {
-	VEDirectXInput*			directInput = VoxelEngine::GetInstance()->GetInputInterface();
-	VEFirstPersonCamera*	camera		= NULL;
+	SystemInputProcessor* processor = reinterpret_cast<SystemInputProcessor*>( aProcessor );
+	assert( processor != NULL );
 
+	if( anEvent.myType == IE_KeyDown )
+	{
+		processor->HandleKeyDown( anEvent.myKey );
+	}
+}
+
+
+// Handles a key being pressed
+void SystemInputProcessor::HandleKeyDown( unsigned int aKey )
+{
 	switch( VoxelEngine::GetInstance()->GetCameraType() )
 	{
 		case CT_Free :
 		case CT_FirstPerson :
-			camera = dynamic_cast<VEFirstPersonCamera*>( VoxelEngine::GetInstance()->GetCamera() );
 			break;
 
 		default :
 			return;
 	}
 
-	// Draw mode
-	if( directInput->IsKeyDown(DIK_F10) )
-	{
-		VoxelEngine::GetInstance()->SetDrawMode( DM_WireFrame );
-	}
-	else if( directInput->IsKeyDown(DIK_F11) )
+	switch( aKey )
 	{
-		VoxelEngine::GetInstance()->SetDrawMode( DM_BackFaceCulling );
-	}
-	else if( directInput->IsKeyDown(DIK_F9) )
-	{
-		SetChunkStyle( CS_Pyramid );
-	}
-	else if( directInput->IsKeyDown(DIK_F8) )
-	{
-		SetChunkStyle( CS_Sphere );
-	}
-	else if( directInput->IsKeyDown(DIK_F7) )
-	{
-		SetChunkStyle( CS_Box );
-	}
+		// Draw mode
+		case DIK_F10 :
+			VoxelEngine::GetInstance()->SetDrawMode( DM_WireFrame );
+			break;
 
-	// Screen capture
-	if( directInput->IsKeyDown(DIK_F1) )
-	{
-		VoxelEngine::GetInstance()->GetRenderManager()->CaptureFrame();
+		case DIK_F11 :
+			VoxelEngine::GetInstance()->SetDrawMode( DM_BackFaceCulling );
+			break;
+
+		case DIK_F9 :
+			SetChunkStyle( CS_Pyramid );
+			break;
+
+		case DIK_F8 :
+			SetChunkStyle( CS_Sphere );
+			break;
+
+		case DIK_F7 :
+			SetChunkStyle( CS_Box );
+			break;
+
+		// Screen capture
+		case DIK_F1 :
+			VoxelEngine::GetInstance()->GetRenderManager()->CaptureFrame();
+			break;
+
+		// Profiler capture, written out as a Chrome trace when the capture ends
+		case DIK_F2 :
+			if( !VEProfiler::IsCapturing() )
+			{
+				VEProfiler::BeginCapture();
+			}
+			break;
+
+		case DIK_F3 :
+			if( VEProfiler::IsCapturing() )
+			{
+				VEProfiler::EndCapture();
+				VEProfiler::ExportChromeTrace( VoxelEngine::GetInstance()->GetDataDirectory() + L"ProfileCapture.json" );
+			}
+			break;
+
+		default :
+			break;
 	}
 }
 
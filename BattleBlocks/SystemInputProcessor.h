@@ -6,6 +6,11 @@
 #include <VETypes.h>
 
 
+// ------------- Forward Declarations -------------
+
+struct VEInputEvent;
+
+
 // ------------------- Classes --------------------
 
 // Hands off keyboard/mouse input from the engine to various game components
@@ -18,14 +23,18 @@ class SystemInputProcessor
 		// Construction
 		SystemInputProcessor();
 
-		// Updates the game/engine state based on mouse/keyboard input
-		void Update( float anElapsedTime );
+		// Updates the game/engine state based on keyboard input. Registered as an input service listener, with the
+		// processor as the parameter
+		static void OnInputEvent( const VEInputEvent& anEvent, void* aProcessor );
 
 
 	private :
 
 		// ---------- Private Functions ---------
 
+		// Handles a key being pressed
+		void HandleKeyDown( unsigned int aKey );
+
 		// Changes the style of the chunk being rendered
 		void SetChunkStyle( ChunkStyle aStyle );
 
@@ -73,4 +73,21 @@ void VEBasicCamera::Update()
 	{
 		UpdateRotation();
 	}
+}
+
+
+// Turns the view matrix by a further pitch & yaw, for views built from the camera's pitch & yaw
+void VEBasicCamera::RotateView( float aPitch, float aYaw )
+{
+	if( aPitch == 0.0f && aYaw == 0.0f )
+	{
+		return;
+	}
+
+	// The view is the inverse of the camera's rotation after its translation, so undoing the current rotation and
+	// applying the turned one's inverse gives the turned view
+	XMMATRIX currentRotation	= XMMatrixRotationRollPitchYaw( myPitch, myYaw, myRoll );
+	XMMATRIX turnedRotation		= XMMatrixRotationRollPitchYaw( myPitch + aPitch, myYaw + aYaw, myRoll );
+
+	XMStoreFloat4x4( &myView, XMLoadFloat4x4(&myView) * currentRotation * XMMatrixTranspose(turnedRotation) );
 }
\ No newline at end of file
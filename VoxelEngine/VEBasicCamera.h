@@ -28,6 +28,11 @@ class VEBasicCamera
         // Updates the camera matrices
         void						Update();
 
+		// Turns the view matrix by a further pitch & yaw, for views built from the camera's pitch & yaw. The
+		// camera's own rotation is left alone, so a copy taken for drawing can be turned by input that arrived
+		// after it was taken
+		void						RotateView( float aPitch, float aYaw );
+
 
         // ----------- Accessors -----------
 
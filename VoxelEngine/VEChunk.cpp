@@ -10,6 +10,14 @@
 #include "VEChunkData.h"
 #include "VEThreadManager.h"
 #include "VEChunkManager.h"
+#include "VEProfiler.h"
+#include "VEMemoryTracker.h"
+#include "VEPoolAllocator.h"
+#include "VEChunkSnapshot.h"
+#include "VERenderState.h"
+#include "VEWorldStore.h"
+#include "VEWorldCache.h"
+#include "VEVoxelCodec.h"
 
 #include "noiseutils.h"
 
@@ -19,75 +27,45 @@
 using namespace DirectX;
 
 
+// ------------------------- Statics ------------------------
+
+unsigned int VEChunk::ourAccessTime = 0;
+
+
 // --------------------- Global Functions -------------------
 
-// A thread function that builds the chunk's data
-UINT VEChunk::BuildDataThread( LPVOID someData )
+// A thread function that builds the chunk's data. Only the chunk's snapshot is read, so the chunk isn't locked
+unsigned int VEChunk::BuildDataThread( void* someData )
 {
 	VEChunk* chunk = reinterpret_cast<VEChunk*>( someData );
-	if( chunk == NULL )
+	if( chunk == NULL || chunk->GetRenderData() == NULL )
 	{
-		ExitThread( -1 );
+		return (unsigned int)-1;
 	}
 
-	VEChunkData* renderData = chunk->GetRenderData();
-	if( renderData == NULL )
-	{
-		ExitThread( -1 );
-	}
-
-	XMFLOAT3	chunkPosition	= chunk->GetPosition();
-	int			chunkDimensions = chunk->GetDimensions();
-	float		voxelSize		= chunk->GetVoxelSize();
-	float		halfWidth		= (float)(chunkDimensions / 2) * voxelSize;
-	XMFLOAT3	voxelPosition( chunkPosition.x, chunkPosition.y, chunkPosition.z );
-	
-	// For the moment all voxels default to the grass colour
-	XMFLOAT4 grassColour = XMFLOAT4(0.0f, 0.36f, 0.04f, 1.0f);
-
 	// Generate the vertex & index data
-	EnterCriticalSection( chunk->GetCriticalSection() );
-	renderData->Reset();
-	for( int y = 0; y < chunkDimensions; y++ )
+	bool succeeded = false;
 	{
-		for( int x = 0; x < chunkDimensions; x++ )
-		{
-			for( int z = 0; z < chunkDimensions; z++ )
-			{
-				VEVoxel* currentVoxel = chunk->GetVoxel( x, y, z );
-				chunk->CalculateVoxelVisibility( x, y, z );
+		VE_PROFILE_ZONE( "VEChunk::BuildDataThread" );
 
-				if( currentVoxel->GetVisibility() == VV_None )
-				{
-					voxelPosition.z	+= voxelSize;
-					continue;
-				}
-
-				// If the voxel is visible, add the geometry to the chunk
-				chunk->myRenderData->AddFaces( voxelPosition, currentVoxel->GetVisibility(), grassColour );
-
-				voxelPosition.z += voxelSize;
-			}
-
-			voxelPosition.x += voxelSize;
-			voxelPosition.z = chunkPosition.z;
-		}
-
-		voxelPosition.y += voxelSize;
-		voxelPosition.x = chunkPosition.x;
+		succeeded = chunk->BuildData();
 	}
 
-	// Build the vertex and index buffers
-	if( !renderData->BuildBuffers() )
+	// Let the main thread know the chunk is ready to be drawn, rather than enabling it from this thread
+	VEEventBus* eventBus = VoxelEngine::GetInstance()->GetEventBus();
+	assert( eventBus != NULL );
+
 	{
-		LeaveCriticalSection( chunk->GetCriticalSection() );
-		ExitThread( -1 );
+		VE_MEMORY_TAG( MEM_Messages );
+
+		eventBus->Post( new VEChunkBuiltEvent(chunk->GetId(), succeeded) );
 	}
 
-	chunk->SetEnabled( true );
-	LeaveCriticalSection( chunk->GetCriticalSection() );
+	// Hand the profiler buffer & the thread's pooled blocks back before the thread exits
+	VEPoolAllocator::ReleaseThreadCaches();
+	VE_PROFILE_THREAD_END();
 
-	ExitThread( 0 );
+	return succeeded ? 0 : (unsigned int)-1;
 }
 
 
@@ -100,7 +78,18 @@ VEChunk::VEChunk( int anId, int aChunkDimensions, int aGridX, int aGridZ ) :
 	myVoxels( NULL ),
 	myChunkDimensions( aChunkDimensions ),
 	myIsDirty( false ),
+	myIsBuilding( false ),
+	myNeighboursDirty( false ),
+	myIsModified( false ),
+	myIsGenerated( false ),
 	myEnabled( false ),
+	myCompressedVoxels( NULL ),
+	myCompressedSize( 0 ),
+	myPaletteSize( 0 ),
+	myAccessTime( ourAccessTime ),
+	myIsSpilled( false ),
+	myVisibleTime( ourAccessTime ),
+	myIsMeshEvicted( false ),
 	myVoxelSize( 1.0f ),
 	myId( anId ),
 	myRenderData( NULL ),
@@ -110,22 +99,35 @@ VEChunk::VEChunk( int anId, int aChunkDimensions, int aGridX, int aGridZ ) :
 }
 
 
-// Creates the voxel array and builds the initial instance buffer
+// Takes a voxel block from the chunk manager and builds the initial instance buffer
 bool VEChunk::Initialise( XMFLOAT3 aChunkPosition )
 {
+	VE_MEMORY_TAG( MEM_Chunks );
+
 	myPosition = aChunkPosition;
-	
-	// Initialise the voxel array
-	myVoxels = new VEVoxel**[myChunkDimensions];
+
+	VEChunkManager* chunkManager = VoxelEngine::GetInstance()->GetChunkManager();
+	assert( chunkManager != NULL );
+
+	// Initialise the voxel block. The block is recycled, so every voxel is constructed in place
+	myVoxels = chunkManager->AllocateVoxels();
+	if( myVoxels == NULL )
+	{
+		return false;
+	}
+
 	for( int x = 0; x < myChunkDimensions; x++ )
 	{
-		myVoxels[x] = new VEVoxel*[myChunkDimensions];
 		for( int y = 0; y < myChunkDimensions; y++ )
 		{
-			myVoxels[x][y] = new VEVoxel[myChunkDimensions];
+			for( int z = 0; z < myChunkDimensions; z++ )
+			{
+				new( &myVoxels[GetVoxelIndex(x, y, z)] ) VEVoxel();
+			}
+
 			if( myGridX == 0 )
 			{
-				myVoxels[x][y]->SetType( VT_Water );
+				myVoxels[GetVoxelIndex(x, y, 0)].SetType( VT_Water );
 			}
 		}
 	}
@@ -136,36 +138,36 @@ bool VEChunk::Initialise( XMFLOAT3 aChunkPosition )
 		return false;
 	}
 
-	InitializeCriticalSection( &myCriticalSection );
-
 	// Signal that we need to build the chunk vertex & index buffers, but don't actually build...
 	// other classes may want to alter the structure of the chunk before this happens
-	myIsDirty = true;
+	myIsDirty		= true;
+	myIsModified	= true;
 
 	return true;
 }
 
 
-// Cleans up the memory used by the chunk
+// Hands the voxel block back to the chunk manager and cleans up the memory used by the chunk
 void VEChunk::Uninitialise()
 {
 	if( myVoxels != NULL )
 	{
-		for( int x = 0; x < myChunkDimensions; x++ )
-		{
-			for( int y = 0; y < myChunkDimensions; y++ )
-			{
-				delete [] myVoxels[x][y];
-			}
-
-			delete [] myVoxels[x];
-		}
+		VEChunkManager* chunkManager = VoxelEngine::GetInstance()->GetChunkManager();
+		assert( chunkManager != NULL );
 
-		delete [] myVoxels;
+		chunkManager->FreeVoxels( myVoxels );
 		myVoxels = NULL;
 	}
 
-	DeleteCriticalSection( &myCriticalSection );
+	if( myCompressedVoxels != NULL )
+	{
+		delete[] myCompressedVoxels;
+		myCompressedVoxels	= NULL;
+		myCompressedSize	= 0;
+	}
+
+	// Spilled voxels are left in the world cache, the chunk's entry is written over if it's spilled again
+	myIsSpilled = false;
 
 	if( myRenderData != NULL )
 	{
@@ -180,6 +182,23 @@ void VEChunk::Uninitialise()
 // Applies a particular style to the chunk
 void VEChunk::ApplyStyle( ChunkStyle aStyle )
 {
+	VEScopedLock<VESharedMutex> voxelLock( myVoxelLock );
+
+	// The styles write the voxels directly, so they must be decompressed first
+	GetVoxels();
+
+	// Keep the voxels the style replaces while the world's stored, so the ones it changes can be journaled
+	VEWorldStore*			worldStore	= VoxelEngine::GetInstance()->GetWorldStore();
+	bool					isJournaled	= worldStore != NULL && worldStore->GetIsOpen();
+	unsigned int			voxelCount	= (unsigned int)( myChunkDimensions * myChunkDimensions * myChunkDimensions );
+	std::vector<VEVoxel>	oldVoxels;
+	if( isJournaled )
+	{
+		VE_MEMORY_TAG( MEM_Chunks );
+
+		oldVoxels.assign( myVoxels, myVoxels + voxelCount );
+	}
+
 	switch( aStyle )
 	{
 		case CS_Box :
@@ -202,15 +221,32 @@ void VEChunk::ApplyStyle( ChunkStyle aStyle )
 			break;
 	}
 
-	myIsDirty = true;
+	// Each changed voxel is journaled like any other edit. Otherwise the chunk's older edits, which can still be in
+	// the journal after a crash, would be replayed over the style once a snapshot including it had been loaded
+	for( unsigned int i = 0; i < oldVoxels.size(); i++ )
+	{
+		if( oldVoxels[i].GetType() != myVoxels[i].GetType() || oldVoxels[i].GetEnabled() != myVoxels[i].GetEnabled() )
+		{
+			worldStore->RecordEdit( this, i, oldVoxels[i], myVoxels[i] );
+		}
+	}
+
+	myIsDirty			= true;
+	myNeighboursDirty	= true;
+	myIsModified		= true;
+	myIsGenerated		= false;
 }
 
 
-// Applies a height map to the chunk
+// Applies a height map to the chunk. It isn't journaled, it only builds the generated terrain that a chunk with no
+// snapshot has its journaled edits replayed on top of, which is built again the same way each time the world's loaded
 void VEChunk::ApplyHeightMap( noise::utils::NoiseMap* aHeightMap )
 {
 	assert( aHeightMap != NULL );
 
+	VEScopedLock<VESharedMutex> voxelLock( myVoxelLock );
+
+	GetVoxels();
 	GenerateEmpty();
 
 	for( int x = 0; x < myChunkDimensions; x++ )
@@ -229,19 +265,22 @@ void VEChunk::ApplyHeightMap( noise::utils::NoiseMap* aHeightMap )
 
 			if( terrainHeight < 1.0f )
 			{
-				myVoxels[x][0][z].SetEnabled( true );
+				myVoxels[GetVoxelIndex(x, 0, z)].SetEnabled( true );
 			}
 			else
 			{
 				for( int y = 0; y < terrainHeight; y++ )
 				{
-					myVoxels[x][y][z].SetEnabled( true );
+					myVoxels[GetVoxelIndex(x, y, z)].SetEnabled( true );
 				}
 			}
 		}
 	}
 
-	myIsDirty = true;
+	myIsDirty			= true;
+	myNeighboursDirty	= true;
+	myIsModified		= true;
+	myIsGenerated		= true;
 }
 
 
@@ -255,192 +294,423 @@ VEVoxel* VEChunk::GetVoxel( int anX, int aY, int aZ )
 		return NULL;
 	}
 
-	return &myVoxels[anX][aY][aZ];
+	return &GetVoxels()[GetVoxelIndex(anX, aY, aZ)];
 }
 
 
-// Builds the vertex & index buffers used for rendering the chunk
+// Whether the voxel at the supplied coordinates is solid, false if they're outside the chunk
+bool VEChunk::GetVoxelEnabled( int anX, int aY, int aZ )
+{
+	VEScopedSharedLock voxelLock( myVoxelLock );
+
+	VEVoxel* voxel = GetVoxel( anX, aY, aZ );
+	return voxel != NULL && voxel->GetEnabled();
+}
+
+
+// Changes the voxel at the supplied coordinates and records the edit in the world store's journal
+bool VEChunk::SetVoxel( int anX, int aY, int aZ, VoxelType aType, bool anIsEnabled )
+{
+	{
+		VEScopedLock<VESharedMutex> voxelLock( myVoxelLock );
+
+		VEVoxel* voxel = GetVoxel( anX, aY, aZ );
+		if( voxel == NULL || (voxel->GetType() == aType && voxel->GetEnabled() == anIsEnabled) )
+		{
+			return false;
+		}
+
+		VEVoxel oldVoxel = *voxel;
+		voxel->SetType( aType );
+		voxel->SetEnabled( anIsEnabled );
+
+		// Recorded while the voxel lock is held, so the journal's edits are in the same order as the chunk's
+		VEWorldStore* worldStore = VoxelEngine::GetInstance()->GetWorldStore();
+		if( worldStore != NULL )
+		{
+			worldStore->RecordEdit( this, GetVoxelIndex(anX, aY, aZ), oldVoxel, *voxel );
+		}
+
+		myIsGenerated = false;
+	}
+
+	myIsDirty			= true;
+	myNeighboursDirty	= true;
+	myIsModified		= true;
+
+	return true;
+}
+
+
+// Captures a snapshot of the chunk and starts a thread to build the vertex & index buffers used for rendering it
 void VEChunk::Rebuild()
 {
-	assert( myRenderData != NULL );
+	assert( myRenderData != NULL && !myIsBuilding );
+
+	myEnabled		= false;
+	myIsDirty		= false;
+	myIsBuilding	= true;
+	myIsMeshEvicted	= false;
 
-	myEnabled = false;
-	myIsDirty = false;
+	PrepareBuild();
 
 	VEThreadManager* threadManager = VoxelEngine::GetInstance()->GetThreadManager();
 	assert( threadManager != NULL );
 
-	threadManager->SpawnThread( (LPTHREAD_START_ROUTINE)VEChunk::BuildDataThread, this );
+	threadManager->SpawnThread( VEChunk::BuildDataThread, this );
 }
 
 
-// Prepares the chunk for rendering, loading the vertex & index buffers in to the
-// input assembler
-void VEChunk::Prepare()
+// Takes a scratch buffer and captures the chunk's voxels, plus the touching faces of the neighbouring chunks, in to
+// its snapshot. Everything the build needs is copied here on the main thread, so the build thread never reads another
+// chunk's voxels while they could be changing
+void VEChunk::PrepareBuild()
 {
-	VEDirectXInterface* renderInterface = VoxelEngine::GetInstance()->GetRenderInterface();
-	assert( renderInterface != NULL );
+	assert( myRenderData != NULL );
 
-	ID3D11DeviceContext* deviceContext	= renderInterface->GetDeviceContext();
-	assert( deviceContext != NULL );
+	VE_MEMORY_TAG( MEM_Meshes );
 
-	unsigned int	strides[1];
-	unsigned int	offsets[1];
-	ID3D11Buffer*	bufferPointers[1];
+	myRenderData->Reset();
 
-	// Set the stride of the input buffers
-	strides[0] = sizeof( VoxelVertices );
+	VEChunk* neighbours[CN_Max];
+	GetNeighbours( neighbours );
 
-	// Set the buffer offsets
-	offsets[0] = 0;
+	myRenderData->GetSnapshot()->Capture( this, neighbours );
 
-	// Set the pointers to the buffers
-	bufferPointers[0] = myRenderData->GetVertexBuffer();
+	// The build thread can't look the neighbours up, so whether its mesh goes in the world cache is decided here
+	myRenderData->SetMeshCacheable( IsMeshCacheable(neighbours), VEWorldCache::GetNeighbourMask(neighbours) );
+}
 
-	// Activate the buffers in the input assembler
-	deviceContext->IASetVertexBuffers( 0, 1, bufferPointers, strides, offsets );
-	deviceContext->IASetIndexBuffer( myRenderData->GetIndexBuffer(), DXGI_FORMAT_R32_UINT, 0 );
 
-	// Set the type of primitive that we're rendering
-	deviceContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
+// Fills in the chunk's neighbours in the chunk grid, NULL where the grid ends
+void VEChunk::GetNeighbours( VEChunk* someNeighbours[CN_Max] )
+{
+	VEChunkManager* chunkManager = VoxelEngine::GetInstance()->GetChunkManager();
+	assert( chunkManager != NULL );
+
+	someNeighbours[CN_Left]		= chunkManager->GetChunk( myGridX - 1, myGridZ );
+	someNeighbours[CN_Right]	= chunkManager->GetChunk( myGridX + 1, myGridZ );
+	someNeighbours[CN_Front]	= chunkManager->GetChunk( myGridX, myGridZ - 1 );
+	someNeighbours[CN_Back]		= chunkManager->GetChunk( myGridX, myGridZ + 1 );
 }
 
 
-// Returns the number of indices in the chunk's render data
-int VEChunk::GetIndexCount()
+// Whether the chunk's mesh can be cached: the chunk and all of its neighbours are exactly as generated
+bool VEChunk::IsMeshCacheable( VEChunk* someNeighbours[CN_Max] )
 {
-	if( myRenderData == NULL )
+	if( !myIsGenerated )
 	{
-		return 0;
+		return false;
 	}
 
-	return myRenderData->GetIndexCount();
+	for( unsigned int i = 0; i < CN_Max; i++ )
+	{
+		if( someNeighbours[i] != NULL && !someNeighbours[i]->GetIsGenerated() )
+		{
+			return false;
+		}
+	}
+
+	return true;
 }
 
 
-// Sets the visibility of a voxel based on surrounding voxels & chunks
-void VEChunk::CalculateVoxelVisibility( int anX, int aY, int aZ )
+// Compresses the chunk's voxels and hands its voxel block back to the chunk manager, if they haven't been touched for
+// the supplied time and the chunk isn't being rebuilt
+bool VEChunk::CompressVoxels( unsigned int anIdleTime, std::vector<unsigned char>& aScratch )
 {
-	VEChunkManager* chunkManager = VoxelEngine::GetInstance()->GetChunkManager();
-	assert( chunkManager != NULL );
+	VE_PROFILE_ZONE( "VEChunk::CompressVoxels" );
 
-	VEVoxel* voxel = GetVoxel( anX, aY, aZ );
-	if( !voxel->GetEnabled() )
+	// Nothing else can be reading the voxels while the voxel lock is held exclusively
+	VEScopedLock<VESharedMutex>	voxelLock( myVoxelLock );
+	VEScopedLock<VEMutex>		residencyLock( myResidencyLock );
+
+	if( myVoxels == NULL || myIsDirty || myIsBuilding || GetIdleTime() < anIdleTime )
 	{
-		voxel->SetVisibility( VV_None );
-		return;
+		return false;
 	}
 
-	DWORD visibility	= VV_All;
-	int	  chunkBounds	= myChunkDimensions - 1;
+	// The scratch buffer holds the palette indices, followed by the palette & the compressed indices
+	unsigned int voxelCount		= (unsigned int)( myChunkDimensions * myChunkDimensions * myChunkDimensions );
+	unsigned int maxDataSize	= VE_VOXEL_PALETTE_SIZE * 2 + VEVoxelCodec::GetMaxCompressedSize( voxelCount );
+	if( aScratch.size() < voxelCount + maxDataSize )
+	{
+		aScratch.resize( voxelCount + maxDataSize );
+	}
+
+	VEVoxel			palette[VE_VOXEL_PALETTE_SIZE];
+	unsigned int	paletteSize = VEVoxelCodec::BuildPalette( myVoxels, voxelCount, palette, &aScratch[0] );
+	if( paletteSize == 0 )
+	{
+		return false;
+	}
 
-	// ------ Left & right face checks ------
+	unsigned char*	data			= &aScratch[voxelCount];
+	unsigned int	paletteBytes	= paletteSize * 2;
 
-	if( anX	== 0 )
+	VEVoxelCodec::WritePalette( palette, paletteSize, data );
+
+	unsigned int compressedSize = VEVoxelCodec::Compress( &aScratch[0], voxelCount, data + paletteBytes, maxDataSize - paletteBytes );
+	if( compressedSize == 0 )
 	{
-		if( CheckAdjacentChunk(chunkBounds, aY, aZ, myGridX - 1, myGridZ) )
-		{
-			visibility &= ~VV_Left;
-		}
+		return false;
 	}
 
-	if( anX < chunkBounds )
 	{
-		if( myVoxels[anX + 1][aY][aZ].GetEnabled() )
-		{
-			visibility &= ~VV_Right;
-		}
+		VE_MEMORY_TAG( MEM_Chunks );
+
+		myCompressedSize	= paletteBytes + compressedSize;
+		myCompressedVoxels	= new unsigned char[myCompressedSize];
+		memcpy( myCompressedVoxels, data, myCompressedSize );
+	}
+
+	myPaletteSize = paletteSize;
+
+	// The block's memory goes back to the system, it isn't needed until a chunk is loaded or decompressed
+	VEChunkManager* chunkManager = VoxelEngine::GetInstance()->GetChunkManager();
+	assert( chunkManager != NULL );
+
+	chunkManager->FreeVoxels( myVoxels, true );
+	myVoxels = NULL;
+
+	return true;
+}
+
+
+// Writes the chunk's compressed voxels to the world cache and frees them
+bool VEChunk::SpillVoxels()
+{
+	VE_PROFILE_ZONE( "VEChunk::SpillVoxels" );
+
+	VEScopedLock<VESharedMutex>	voxelLock( myVoxelLock );
+	VEScopedLock<VEMutex>		residencyLock( myResidencyLock );
+
+	if( myCompressedVoxels == NULL )
+	{
+		return false;
 	}
-	else
+
+	VEWorldCache* worldCache = VoxelEngine::GetInstance()->GetWorldCache();
+	if( worldCache == NULL || !worldCache->SpillVoxels(this, myCompressedVoxels, myCompressedSize, myPaletteSize) )
 	{
-		if( CheckAdjacentChunk(0, aY, aZ, myGridX + 1, myGridZ) )
-		{
-			visibility &= ~VV_Right;
-		}
+		return false;
 	}
 
-	if( anX > 0 )
+	delete[] myCompressedVoxels;
+	myCompressedVoxels	= NULL;
+	myCompressedSize	= 0;
+	myIsSpilled			= true;
+
+	return true;
+}
+
+
+// Releases the chunk's vertex & index buffers and disables it until RestoreMesh is called
+void VEChunk::EvictMesh()
+{
+	assert( myRenderData != NULL && !myIsBuilding );
+
+	myRenderData->ReleaseBuffers();
+
+	myEnabled		= false;
+	myIsMeshEvicted	= true;
+}
+
+
+// Brings back an evicted mesh, from the world cache if it's there or by flagging the chunk to be rebuilt
+void VEChunk::RestoreMesh()
+{
+	myIsMeshEvicted = false;
+
+	// A chunk that's been edited since is rebuilt anyway
+	if( myIsDirty )
 	{
-		if( myVoxels[anX - 1][aY][aZ].GetEnabled() )
-		{
-			visibility &= ~VV_Left;
-		}
+		return;
 	}
 
-	// ------ Top & bottom face checks ------
+	VEChunk* neighbours[CN_Max];
+	GetNeighbours( neighbours );
 
-	// Is the top face blocked
-	if( aY < chunkBounds )
+	VEWorldCache* worldCache = VoxelEngine::GetInstance()->GetWorldCache();
+	if( worldCache != NULL && IsMeshCacheable(neighbours) && worldCache->LoadMesh(this) )
 	{
-		if( myVoxels[anX][aY + 1][aZ].GetEnabled() )
-		{
-			visibility &= ~VV_Top;
-		}
+		return;
 	}
 
-	// Is the bottom face blocked
-	if( aY > 0 )
+	myIsDirty = true;
+}
+
+
+// Decompresses the chunk's voxels in to a block from the chunk manager, unless another thread already has. Spilled
+// voxels are read back from the world cache first
+VEVoxel* VEChunk::DecompressVoxels()
+{
+	VE_PROFILE_ZONE( "VEChunk::DecompressVoxels" );
+
+	long long startTime = VEProfiler::GetTime();
+
+	VEScopedLock<VEMutex> residencyLock( myResidencyLock );
+
+	if( myVoxels != NULL || (myCompressedVoxels == NULL && !myIsSpilled) )
 	{
-		if( myVoxels[anX][aY -1][aZ].GetEnabled() )
-		{
-			visibility &= ~VV_Bottom;
-		}
+		return myVoxels;
 	}
 
-	// ------ Front & back face checks ------
-	
-	if( aZ == 0 )
+	if( myIsSpilled )
 	{
-		if( CheckAdjacentChunk(anX, aY, chunkBounds, myGridX, myGridZ - 1) )
+		VEWorldCache* worldCache = VoxelEngine::GetInstance()->GetWorldCache();
+		assert( worldCache != NULL );
+
+		myCompressedVoxels = worldCache->RestoreVoxels( this, myCompressedSize, myPaletteSize );
+		if( myCompressedVoxels == NULL )
 		{
-			visibility &= ~VV_Front;
+			assert( false );
+			return NULL;
 		}
+
+		myIsSpilled = false;
 	}
-	
-	if( aZ < chunkBounds )
+
+	VEChunkManager* chunkManager = VoxelEngine::GetInstance()->GetChunkManager();
+	assert( chunkManager != NULL );
+
+	VEVoxel* voxels = chunkManager->AllocateVoxels();
+	if( voxels == NULL )
 	{
-		if( myVoxels[anX][aY][aZ + 1].GetEnabled() )
-		{
-			visibility &= ~VV_Back;
-		}
+		assert( false );
+		return NULL;
 	}
-	else 
+
+	// The compressed voxels were written by CompressVoxels, and spilled ones are checked against their entry's key as
+	// they're read back, so they can't be corrupt
+	unsigned int	voxelCount		= (unsigned int)( myChunkDimensions * myChunkDimensions * myChunkDimensions );
+	unsigned int	paletteBytes	= myPaletteSize * 2;
+
+	VEVoxel palette[VE_VOXEL_PALETTE_SIZE];
+	VEVoxelCodec::ReadPalette( myCompressedVoxels, myPaletteSize, palette );
+
+	bool succeeded = VEVoxelCodec::DecompressVoxels( myCompressedVoxels + paletteBytes, myCompressedSize - paletteBytes, palette, myPaletteSize, voxels, voxelCount );
+	assert( succeeded );
+
+	delete[] myCompressedVoxels;
+	myCompressedVoxels	= NULL;
+	myCompressedSize	= 0;
+
+	// Threads that find the voxels without taking the residency lock must see them complete
+	std::atomic_thread_fence( std::memory_order_release );
+	myVoxels = voxels;
+
+	chunkManager->RecordDecompression( VEProfiler::GetTime() - startTime );
+
+	return myVoxels;
+}
+
+
+// Prepares a chunk captured in a render state for rendering, loading its vertex & index buffers in to the
+// input assembler
+void VEChunk::Prepare( const VEChunkDrawItem& aDrawItem )
+{
+	VEDirectXInterface* renderInterface = VoxelEngine::GetInstance()->GetRenderInterface();
+	assert( renderInterface != NULL );
+
+	ID3D11DeviceContext* deviceContext	= renderInterface->GetDeviceContext();
+	assert( deviceContext != NULL );
+
+	unsigned int	strides[1];
+	unsigned int	offsets[1];
+	ID3D11Buffer*	bufferPointers[1];
+
+	// Set the stride of the input buffers
+	strides[0] = sizeof( VoxelVertices );
+
+	// Set the buffer offsets
+	offsets[0] = 0;
+
+	// Set the pointers to the buffers
+	bufferPointers[0] = aDrawItem.myVertexBuffer;
+
+	// Activate the buffers in the input assembler
+	deviceContext->IASetVertexBuffers( 0, 1, bufferPointers, strides, offsets );
+	deviceContext->IASetIndexBuffer( aDrawItem.myIndexBuffer, DXGI_FORMAT_R32_UINT, 0 );
+
+	// Set the type of primitive that we're rendering
+	deviceContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
+}
+
+
+// Builds the chunk's vertex & index data and buffers from the snapshot taken by PrepareBuild. Returns false if the
+// buffers couldn't be created
+bool VEChunk::BuildData()
+{
+	assert( myRenderData != NULL && myRenderData->GetSnapshot() != NULL );
+
+	VE_MEMORY_TAG( MEM_Meshes );
+
+	// Chunks with the same contents share a mesh, there's nothing to build if the mesh cache already has it
+	if( myRenderData->AcquireCachedMesh() )
 	{
-		if( CheckAdjacentChunk(anX, aY, 0, myGridX, myGridZ + 1) )
-		{
-			visibility &= ~VV_Back;
-		}
+		return true;
 	}
 
-	if( aZ > 0 )
+	CalculateVisibility();
+	BuildMesh();
+
+	// Build the vertex and index buffers
+	return myRenderData->BuildBuffers();
+}
+
+
+// Sets the visibility of every voxel in the snapshot based on surrounding voxels & chunks
+void VEChunk::CalculateVisibility()
+{
+	assert( myRenderData->GetSnapshot() != NULL );
+
+	myRenderData->GetSnapshot()->CalculateVisibility();
+}
+
+
+// Adds the faces of every visible voxel in the snapshot to the chunk's render data. Visibility must have been calculated first
+void VEChunk::BuildMesh( bool anIsParallel )
+{
+	VE_PROFILE_ZONE( "VEChunk::BuildMesh" );
+
+	myRenderData->BuildMesh( anIsParallel );
+}
+
+
+// Returns the number of indices in the chunk's render data
+int VEChunk::GetIndexCount()
+{
+	if( myRenderData == NULL )
 	{
-		if( myVoxels[anX][aY][aZ - 1].GetEnabled() )
-		{
-			visibility &= ~VV_Front;
-		}
+		return 0;
 	}
 
-	voxel->SetVisibility( visibility );
+	return myRenderData->GetIndexCount();
 }
 
 
-// Checks the visibility of the voxel at the supplied co-ordinates in an adjacent chunk
-bool VEChunk::CheckAdjacentChunk( int anX, int aY, int aZ, int aChunkX, int aChunkZ )
+// Returns the bytes taken by the chunk's vertex & index buffers, unless they're shared through the mesh cache
+unsigned int VEChunk::GetMeshBytes()
 {
-	VEChunkManager* chunkManager = VoxelEngine::GetInstance()->GetChunkManager();
-	assert( chunkManager != NULL );
+	if( myRenderData == NULL )
+	{
+		return 0;
+	}
 
-	VEChunk* nextChunk = chunkManager->GetChunk( aChunkX, aChunkZ );
-	if( nextChunk != NULL )
+	return myRenderData->GetMeshBytes();
+}
+
+
+// Returns the bytes evicting the chunk's mesh would free
+unsigned int VEChunk::GetReleasedMeshBytes()
+{
+	if( myRenderData == NULL )
 	{
-		VEVoxel* adjacentVoxel = nextChunk->GetVoxel( anX, aY, aZ );
-		if( adjacentVoxel != NULL )
-		{
-			return adjacentVoxel->GetEnabled();
-		}
+		return 0;
 	}
 
-	return false;
+	return myRenderData->GetReleasedBytes();
 }
 
 
@@ -453,7 +723,7 @@ void VEChunk::GenerateBox()
 		{
 			for( int z = 0; z < myChunkDimensions; z++ )
 			{
-				myVoxels[x][y][z].SetEnabled( true );
+				myVoxels[GetVoxelIndex(x, y, z)].SetEnabled( true );
 			}
 		}
 	}
@@ -477,11 +747,11 @@ void VEChunk::GenerateSphere()
 
 				if( factor <= halfChunkSize )
 				{
-					myVoxels[x][y][z].SetEnabled( true );
+					myVoxels[GetVoxelIndex(x, y, z)].SetEnabled( true );
 				}
 				else
 				{
-					myVoxels[x][y][z].SetEnabled( false );
+					myVoxels[GetVoxelIndex(x, y, z)].SetEnabled( false );
 				}
 			}
 		}
@@ -505,7 +775,7 @@ void VEChunk::GeneratePyramid()
 		{
 			for( int z = zLimit; z < myChunkDimensions - zLimit; z++ )
 			{
-				myVoxels[x][y][z].SetEnabled( true );
+				myVoxels[GetVoxelIndex(x, y, z)].SetEnabled( true );
 			}
 		}
 
@@ -524,7 +794,7 @@ void VEChunk::GenerateEmpty()
 		{
 			for( int z = 0; z < myChunkDimensions; z++ )
 			{
-				myVoxels[x][y][z].SetEnabled( false );
+				myVoxels[GetVoxelIndex(x, y, z)].SetEnabled( false );
 			}
 		}
 	}
@@ -5,6 +5,9 @@
 // ------------------------ Includes ------------------------
 
 #include "VETypes.h"
+#include "VEEventBus.h"
+#include "VEThreading.h"
+#include "VEChunkSnapshot.h"
 
 
 // ------------------ Forward Declarations ------------------
@@ -12,6 +15,7 @@
 class	VEVoxelData;
 class	VEVoxel;
 class	VEChunkData;
+struct	VEChunkDrawItem;
 
 namespace noise
 {
@@ -24,9 +28,51 @@ namespace noise
 
 // ------------------------ Classes -------------------------
 
-// A chunk groups a number of voxels together in a three dimensional array. It also generates the vertex
+// Posted by a chunk's build thread once the chunk's vertex & index buffers have been built
+class VEChunkBuiltEvent : public VEEvent
+{
+	public :
+
+		// ------- Public Functions -------
+
+		// Construction
+		VEChunkBuiltEvent( int aChunkId, bool aSucceeded ) : VEEvent( EE_ChunkBuilt ),
+			myChunkId( aChunkId ),
+			mySucceeded( aSucceeded )
+		{
+		}
+
+
+		// ---------- Accessors -----------
+
+		int		GetChunkId()		{ return myChunkId; }
+
+		bool	GetSucceeded()		{ return mySucceeded; }
+
+
+	private :
+
+		// ------- Private Variables ------
+
+		int		myChunkId;
+		bool	mySucceeded;
+};
+
+
+// A chunk groups a number of voxels together in a three dimensional array, stored as a single block taken from
+// the chunk manager's voxel pool. It also generates the vertex
 // and index buffers used for drawing all of the voxels in the chunk. Note that non-visible faces are 
-// culled from the rendering when the data is generated
+// culled from the rendering when the data is generated. The mesh is built around the chunk's origin & drawn at the
+// chunk's position, so chunks with the same contents share one mesh through the mesh cache. The voxels are guarded by a reader-writer lock: edits hold
+// it exclusively, while queries & snapshots share it and never block each other.
+//
+// Chunks whose voxels haven't been touched for a while are compressed by the chunk manager's compression thread, which
+// hands their voxel block back and keeps their mesh. The voxels are decompressed the next time they're asked for.
+// The compression thread holds the voxel lock exclusively, so holding the lock keeps the voxels where they are.
+//
+// To keep within its memory budgets the chunk manager can also spill compressed voxels to the world cache, and evict the
+// meshes of chunks that are out of view. Spilled voxels are read back like compressed ones, and evicted meshes are
+// brought back once the chunk is in view again
 class VEChunk
 {
 	public :
@@ -36,31 +82,78 @@ class VEChunk
 		// Construction
 		VEChunk( int anId, int aChunkDimensions, int aGridX, int aGridZ );
 
-		// Creates the voxel array and builds the initial instance buffer. The position is at the center of the chunk, voxels
+		// Takes a voxel block from the chunk manager and builds the initial instance buffer. The position is at the center of the chunk, voxels
 		// are drawn around it
 		bool				Initialise( DirectX::XMFLOAT3 aChunkPosition );
 
-		// Cleans up the memory used by the chunk
+		// Hands the voxel block back to the chunk manager and cleans up the memory used by the chunk
 		void				Uninitialise();
 
-		// Applies a particular style to the chunk
+		// Applies a particular style to the chunk, journaling the voxels it changes if the world's stored
 		void				ApplyStyle( ChunkStyle aStyle );
 		
-		// Applies a height map to the chunk
+		// Applies a height map to the chunk. Only used to generate terrain, so it isn't journaled
 		void				ApplyHeightMap( noise::utils::NoiseMap* aHeightMap );
 
-		// Returns the voxel at the supplied coordinates
+		// Returns the voxel at the supplied coordinates, decompressing the chunk's voxels if needed. The voxel isn't
+		// locked, so the caller should hold the voxel lock
 		VEVoxel*			GetVoxel( int anX, int aY, int aZ );
 
+		// Whether the voxel at the supplied coordinates is solid, false if they're outside the chunk. Takes the voxel
+		// lock for reading, so it's safe from any thread
+		bool				GetVoxelEnabled( int anX, int aY, int aZ );
+
+		// Changes the voxel at the supplied coordinates and records the edit in the world store's journal, if a world is
+		// open. Returns false if the coordinates are outside the chunk or the voxel is unchanged
+		bool				SetVoxel( int anX, int aY, int aZ, VoxelType aType, bool anIsEnabled );
+
 		// Converts the supplied world space coordinates to voxel space coordinates
 		void				GetVoxelSpaceCoordinates( const DirectX::XMFLOAT3& aWorldPosition, DirectX::XMFLOAT3& aVoxelPosition );
 
-		// Builds the vertex & index buffers used for rendering the chunk
+		// Captures a snapshot of the chunk and starts a thread to build the vertex & index buffers used for rendering it
 		void				Rebuild();
+
+		// Takes a scratch buffer and captures the chunk's voxels, plus the touching faces of the neighbouring chunks,
+		// in to its snapshot. Must be called on the main thread, before building the chunk's data
+		void				PrepareBuild();
+
+		// Fills in the chunk's neighbours in the chunk grid, NULL where the grid ends. Must be called on the main thread
+		void				GetNeighbours( VEChunk* someNeighbours[CN_Max] );
+
+		// Whether the chunk's mesh can be cached: the chunk and all of its neighbours are exactly as generated, so the
+		// mesh only depends on the terrain generator
+		bool				IsMeshCacheable( VEChunk* someNeighbours[CN_Max] );
+
+		// Compresses the chunk's voxels and hands its voxel block back to the chunk manager, if they haven't been
+		// touched for the supplied time in milliseconds and the chunk isn't being rebuilt. The scratch buffer is reused
+		// between calls. Returns false if the chunk wasn't compressed
+		bool				CompressVoxels( unsigned int anIdleTime, std::vector<unsigned char>& aScratch );
+
+		// Writes the chunk's compressed voxels to the world cache and frees them, they're read back the next time
+		// they're asked for. Returns false if the chunk isn't compressed or the cache can't take them
+		bool				SpillVoxels();
+
+		// Releases the chunk's vertex & index buffers and disables it until RestoreMesh is called. The chunk mustn't be
+		// building
+		void				EvictMesh();
+
+		// Brings back an evicted mesh, from the world cache if it's there or by flagging the chunk to be rebuilt
+		void				RestoreMesh();
 		
-		// Prepares the chunk for rendering, loading the vertex, index & instance buffers in to the
+		// Builds the chunk's vertex & index data and buffers from the snapshot taken by PrepareBuild. Returns false if
+		// the buffers couldn't be created
+		bool				BuildData();
+
+		// Sets the visibility of every voxel in the snapshot based on surrounding voxels & chunks
+		void				CalculateVisibility();
+
+		// Adds the faces of every visible voxel in the snapshot to the chunk's render data, optionally spreading the
+		// work over the worker threads. Visibility must have been calculated first
+		void				BuildMesh( bool anIsParallel = false );
+		
+		// Prepares a chunk captured in a render state for rendering, loading its vertex & index buffers in to the
 		// input assembler
-		void				Prepare();
+		static void			Prepare( const VEChunkDrawItem& aDrawItem );
 
 
 		// ---------- Accessors -----------
@@ -71,6 +164,26 @@ class VEChunk
 		void						SetEnabled( bool anIsReady )						{ myEnabled = anIsReady; }
 
 		bool						GetIsDirty()										{ return myIsDirty; }
+		void						SetIsDirty( bool anIsDirty )						{ myIsDirty = anIsDirty; }
+
+		// Set while a build thread is working on the chunk's snapshot, the chunk isn't rebuilt again until it finishes
+		bool						GetIsBuilding()										{ return myIsBuilding; }
+		void						SetIsBuilding( bool anIsBuilding )					{ myIsBuilding = anIsBuilding; }
+
+		// Set when the chunk's voxels change, the neighbouring chunks' halos are out of date until they're rebuilt
+		bool						GetNeighboursDirty()								{ return myNeighboursDirty; }
+		void						SetNeighboursDirty( bool anIsDirty )				{ myNeighboursDirty = anIsDirty; }
+
+		// Set when the chunk's voxels change, cleared once they've been loaded from or saved to the world store
+		bool						GetIsModified()										{ return myIsModified; }
+		void						SetIsModified( bool anIsModified )					{ myIsModified = anIsModified; }
+
+		// Set while the chunk's voxels are exactly as the terrain generator made them
+		bool						GetIsGenerated()									{ return myIsGenerated; }
+		void						SetIsGenerated( bool anIsGenerated )				{ myIsGenerated = anIsGenerated; }
+
+		int							GetGridX()											{ return myGridX; }
+		int							GetGridZ()											{ return myGridZ; }
 
 		int							GetDimensions() const								{ return myChunkDimensions; }
 
@@ -78,11 +191,38 @@ class VEChunk
 
 		const DirectX::XMFLOAT3&	GetPosition() const									{ return myPosition; }
 
-		VEVoxel***					GetVoxels() 										{ return myVoxels; }
+		// Returns the chunk's voxels, decompressing them if the chunk has been compressed. The caller should hold the
+		// voxel lock while using them
+		VEVoxel*					GetVoxels() 										{ myAccessTime = ourAccessTime; return myVoxels != NULL ? myVoxels : DecompressVoxels(); }
+
+		// Whether the chunk's voxels are compressed, and the bytes they take while they are
+		bool						GetIsCompressed()									{ return myCompressedVoxels != NULL; }
+		unsigned int				GetCompressedSize()									{ return myCompressedSize; }
+
+		// Whether the chunk's voxels are in their block, rather than compressed or spilled. Doesn't count as an access
+		bool						GetIsResident()										{ return myVoxels != NULL; }
+
+		bool						GetIsSpilled()										{ return myIsSpilled; }
+
+		// Set while the chunk's mesh is evicted, the chunk isn't rebuilt until it's restored
+		bool						GetIsMeshEvicted()									{ return myIsMeshEvicted; }
+
+		// When the chunk was last in view, in the chunk manager's milliseconds
+		unsigned int				GetVisibleTime()									{ return myVisibleTime; }
+		void						SetVisibleTime( unsigned int aVisibleTime )			{ myVisibleTime = aVisibleTime; }
+
+		// The milliseconds since the chunk's voxels were last asked for
+		unsigned int				GetIdleTime()										{ return ourAccessTime - myAccessTime; }
+
+		// The time voxel accesses are stamped with, in milliseconds, kept by the chunk manager
+		static void					SetAccessTime( unsigned int anAccessTime )			{ ourAccessTime = anAccessTime; }
+
+		// Returns the index of the voxel at the supplied coordinates in the voxel block. Z is stored contiguously
+		int							GetVoxelIndex( int anX, int aY, int aZ ) const		{ return (anX * myChunkDimensions + aY) * myChunkDimensions + aZ; }
 
 		void						SetPosition( const DirectX::XMFLOAT3& aPosition )	{ myIsDirty = true; myPosition = aPosition; }
 	
-		CRITICAL_SECTION*			GetCriticalSection()								{ return &myCriticalSection; }
+		VESharedMutex&				GetVoxelLock()										{ return myVoxelLock; }
 
 		VEChunkData*				GetRenderData()										{ return myRenderData; }
 
@@ -91,16 +231,16 @@ class VEChunk
 
 		int							GetIndexCount();
 
+		// The bytes taken by the chunk's vertex & index buffers, unless they're shared through the mesh cache
+		unsigned int				GetMeshBytes();
 
-	private :
+		// The bytes evicting the chunk's mesh would free, a shared mesh only counts if no other chunk uses it
+		unsigned int				GetReleasedMeshBytes();
 
-		// ------- Private Functions ------
 
-		// Sets the visibility of a voxel based on surrounding voxels & chunks
-		void						CalculateVoxelVisibility( int anX, int aY, int aZ );
+	private :
 
-		// Checks the visibility of the voxel at the supplied co-ordinates in an adjacent chunk
-		bool						CheckAdjacentChunk( int anX, int aY, int aZ, int aChunkX, int aChunkZ );
+		// ------- Private Functions ------
 
 		// Enables all voxels in the chunk
 		void						GenerateBox();
@@ -118,7 +258,11 @@ class VEChunk
 		void						GenerateEmpty();
 
 		// A thread function that builds the chunk's data
-		static UINT					BuildDataThread( LPVOID someData );
+		static unsigned int			BuildDataThread( void* someData );
+
+		// Decompresses the chunk's voxels in to a block from the chunk manager, unless another thread already has.
+		// Returns the voxels
+		VEVoxel*					DecompressVoxels();
 
 
 		// ------- Private Variables ------
@@ -130,14 +274,32 @@ class VEChunk
 
 		int							myMaxHeight;
 
-		VEVoxel***					myVoxels;
+		VEVoxel*					myVoxels;
 		VEChunkData*				myRenderData;
 		const int					myChunkDimensions;
 		float						myVoxelSize;
 
-		CRITICAL_SECTION			myCriticalSection;
+		VESharedMutex				myVoxelLock;
+
+		// The compressed voxels: the palette followed by the compressed palette indices. The residency lock guards
+		// the voxels being compressed & decompressed
+		VEMutex						myResidencyLock;
+		unsigned char*				myCompressedVoxels;
+		unsigned int				myCompressedSize;
+		unsigned int				myPaletteSize;
+		unsigned int				myAccessTime;
+		bool						myIsSpilled;
+
+		static unsigned int			ourAccessTime;
+
+		unsigned int				myVisibleTime;
+		bool						myIsMeshEvicted;
 
 		bool						myIsDirty;		
+		bool						myIsBuilding;
+		bool						myNeighboursDirty;
+		bool						myIsModified;
+		bool						myIsGenerated;
 		bool						myEnabled;
 
 		int							myId;
@@ -6,21 +6,85 @@
 
 #include "VoxelEngine.h"
 #include "VEChunk.h"
-#include "VEDirectXInterface.h"
+#include "VEChunkManager.h"
+#include "VEMeshScratchPool.h"
+#include "VEMeshCache.h"
+#include "VEChunkSnapshot.h"
+#include "VERenderBackend.h"
 #include "VEVoxel.h"
+#include "VEProfiler.h"
+#include "VEWorldCache.h"
+
+#include <ppl.h>
+
 
 // ---------------------- Namespaces ----------------------
 
 using namespace DirectX;
 
 
+// ---------------------- Structures ----------------------
+
+// A voxel face: the visibility bit that enables it, its normal, and its corners as indices in to the voxel's
+// eight corners (see EmitFaces)
+struct FaceDefinition
+{
+	DWORD		myVisibility;
+	XMFLOAT3	myNormal;
+	int			myCorners[4];
+};
+
+
+// ----------------------- Globals ------------------------
+
+// The faces of a voxel, in the order they're emitted
+static const FaceDefinition ourFaces[] =
+{
+	{ VV_Front,		XMFLOAT3( 0.0f, 0.0f, -1.0f ),	{ 0, 1, 2, 3 } },
+	{ VV_Back,		XMFLOAT3( 0.0f, 0.0f, 1.0f ),	{ 4, 5, 6, 7 } },
+	{ VV_Left,		XMFLOAT3( -1.0f, 0.0f, 0.0f ),	{ 4, 3, 0, 6 } },
+	{ VV_Right,		XMFLOAT3( 1.0f, 0.0f, 0.0f ),	{ 2, 5, 7, 1 } },
+	{ VV_Top,		XMFLOAT3( 0.0f, 1.0f, 0.0f ),	{ 3, 5, 1, 6 } },
+	{ VV_Bottom,	XMFLOAT3( 0.0f, -1.0f, 0.0f ),	{ 0, 7, 4, 2 } }
+};
+
+// The indices of a face's two triangles, relative to the face's first vertex
+static const unsigned long ourFaceIndices[] = { 0, 1, 2, 0, 3, 1 };
+
+// For the moment all voxels default to the grass colour
+static const XMFLOAT4 ourGrassColour( 0.0f, 0.36f, 0.04f, 1.0f );
+
+
+// ---------------------- Functions -----------------------
+
+// Returns the number of faces set in a visibility mask
+static inline unsigned int CountFaces( DWORD aVisibility )
+{
+	DWORD count = aVisibility & VV_All;
+	count = count - ( (count >> 1) & 0x55 );
+	count = ( count & 0x33 ) + ( (count >> 2) & 0x33 );
+
+	return ( count + (count >> 4) ) & 0x0F;
+}
+
+
 // -------------------- Class Functions -------------------
 
 // Construction
 VEChunkData::VEChunkData( VEChunk* aChunk ) :
 	myChunk( aChunk ),
 	myIndexBuffer( NULL ),
-	myVertexBuffer( NULL )
+	myVertexBuffer( NULL ),
+	myIndexCount( 0 ),
+	myMeshBytes( 0 ),
+	myMeshEntry( NULL ),
+	myMeshHash( 0 ),
+	myMeshCheckHash( 0 ),
+	myHasMeshHash( false ),
+	myBuildStartTime( 0 ),
+	myScratch( NULL ),
+	myIsMeshCacheable( false ),
+	myNeighbourMask( 0 )
 {
 }
 
@@ -35,216 +99,218 @@ bool VEChunkData::Initialise()
 // Cleans up the memory used by the 
 void VEChunkData::Uninitialise()
 {
-	Reset();
+	ReleaseBuffers();
+	ReleaseScratch();
 }
 
 
-// Clears the vertex and index buffers
+// Clears the vertex and index buffers, and takes a scratch buffer to build the new vertices & indices in
 void VEChunkData::Reset()
 {
-	SetVertexBuffer( NULL );
-	SetIndexBuffer( NULL );
+	ReleaseBuffers();
 
-	myVertices.clear();
-	myIndices.clear();
+	myHasMeshHash = false;
+
+	if( myScratch == NULL )
+	{
+		VEChunkManager* chunkManager = VoxelEngine::GetInstance()->GetChunkManager();
+		assert( chunkManager != NULL );
+
+		myScratch = chunkManager->GetMeshScratchPool()->Acquire();
+	}
+	else
+	{
+		myScratch->myVertices.clear();
+		myScratch->myIndices.clear();
+	}
 }
 
 
-// Adds visible faces in to the vertex & index vectors
-void VEChunkData::AddFaces( XMFLOAT3& aPosition, DWORD aVisiblity, XMFLOAT4& aColour )
+// Builds the chunk's vertices & indices from the visibility in its snapshot
+void VEChunkData::BuildMesh( bool anIsParallel )
 {
-	int currentIndex	= myVertices.size();
-	float voxelSize		= myChunk->GetVoxelSize();
+	assert( myScratch != NULL );
 
-	XMFLOAT3 point1( aPosition.x, aPosition.y, aPosition.z );
-	XMFLOAT3 point2( aPosition.x + voxelSize, aPosition.y + voxelSize, aPosition.z );
-	XMFLOAT3 point3( aPosition.x + voxelSize, aPosition.y, aPosition.z );
-	XMFLOAT3 point4( aPosition.x, aPosition.y + voxelSize, aPosition.z );
-
-	XMFLOAT3 point5( aPosition.x, aPosition.y, aPosition.z + voxelSize );
-	XMFLOAT3 point6( aPosition.x + voxelSize, aPosition.y + voxelSize, aPosition.z + voxelSize );
-	XMFLOAT3 point7( aPosition.x, aPosition.y + voxelSize, aPosition.z + voxelSize );
-	XMFLOAT3 point8( aPosition.x + voxelSize, aPosition.y, aPosition.z + voxelSize );
+	BuildMesh( *myScratch, anIsParallel );
+}
 
-	XMFLOAT3 currentNormal;
 
-	// Front face
-	if( aVisiblity & VV_Front)
-	{
-		currentNormal = XMFLOAT3( 0.0f, 0.0f, -1.0f );
+// Builds the vertices & indices for the snapshot held in a scratch buffer. The faces are counted first so the
+// buffers can be sized exactly, then each Y-slab fills its own range of the buffers
+void VEChunkData::BuildMesh( VEMeshScratch& aScratch, bool anIsParallel )
+{
+	int dimensions = aScratch.mySnapshot.GetDimensions();
 
-		myVertices.push_back( VoxelVertices(point1, currentNormal, aColour) );
-		myVertices.push_back( VoxelVertices(point2, currentNormal, aColour) );
-		myVertices.push_back( VoxelVertices(point3, currentNormal, aColour) );
-		myVertices.push_back( VoxelVertices(point4, currentNormal, aColour) );
+	// Count the faces in each slab, and work out where each slab's faces start
+	std::vector<unsigned int>& slabOffsets = aScratch.mySlabOffsets;
+	slabOffsets.resize( dimensions + 1 );
 
-		myIndices.push_back( currentIndex );
-		myIndices.push_back( currentIndex + 1 );
-		myIndices.push_back( currentIndex + 2 );
+	unsigned int faceCount = 0;
+	for( int y = 0; y < dimensions; y++ )
+	{
+		slabOffsets[y]	= faceCount;
+		faceCount		+= CountSlabFaces( aScratch, y );
+	}
+	slabOffsets[dimensions] = faceCount;
 
-		myIndices.push_back( currentIndex );
-		myIndices.push_back( currentIndex + 3 );
-		myIndices.push_back( currentIndex + 1 );
+	// Allocate the buffers once
+	aScratch.myVertices.resize( faceCount * 4 );
+	aScratch.myIndices.resize( faceCount * 6 );
 
-		currentIndex = myVertices.size();
+	if( faceCount == 0 )
+	{
+		return;
 	}
 
-	// Back face
-	if( aVisiblity & VV_Back )
+	// Slabs write to separate ranges, so they can be filled in any order
+	if( anIsParallel )
+	{
+		VEMeshScratch* scratch = &aScratch;
+		Concurrency::parallel_for( 0, dimensions, [scratch]( int aY )
+		{
+			FillSlab( *scratch, aY );
+		});
+	}
+	else
 	{
-		currentNormal = XMFLOAT3( 0.0f, 0.0f, 1.0f );
+		for( int y = 0; y < dimensions; y++ )
+		{
+			FillSlab( aScratch, y );
+		}
+	}
+}
 
-		myVertices.push_back( VoxelVertices(point5, currentNormal, aColour) );
-		myVertices.push_back( VoxelVertices(point6, currentNormal, aColour) );
-		myVertices.push_back( VoxelVertices(point7, currentNormal, aColour) );
-		myVertices.push_back( VoxelVertices(point8, currentNormal, aColour) );
 
-		myIndices.push_back( currentIndex );
-		myIndices.push_back( currentIndex + 1 );
-		myIndices.push_back( currentIndex + 2 );
+// Shares the mesh cache's mesh for the snapshot rather than building one, handing the scratch buffer back
+bool VEChunkData::AcquireCachedMesh()
+{
+	VE_PROFILE_ZONE( "VEChunkData::AcquireCachedMesh" );
 
-		myIndices.push_back( currentIndex );
-		myIndices.push_back( currentIndex + 3 );
-		myIndices.push_back( currentIndex + 1 );
+	assert( myScratch != NULL );
 
-		currentIndex = myVertices.size();
-	}
+	VEChunkManager* chunkManager = VoxelEngine::GetInstance()->GetChunkManager();
+	assert( chunkManager != NULL );
 
-	// Left face
-	if( aVisiblity & VV_Left )
+	VEMeshCache* meshCache = chunkManager->GetMeshCache();
+	if( !meshCache->GetIsEnabled() )
 	{
-		currentNormal = XMFLOAT3( -1.0f, 0.0f, 0.0f );
-
-		myVertices.push_back( VoxelVertices(point5, currentNormal, aColour) );
-		myVertices.push_back( VoxelVertices(point4, currentNormal, aColour) );
-		myVertices.push_back( VoxelVertices(point1, currentNormal, aColour) );
-		myVertices.push_back( VoxelVertices(point7, currentNormal, aColour) );
-
-		myIndices.push_back( currentIndex );
-		myIndices.push_back( currentIndex + 1 );
-		myIndices.push_back( currentIndex + 2 );
+		return false;
+	}
 
-		myIndices.push_back( currentIndex );
-		myIndices.push_back( currentIndex + 3 );
-		myIndices.push_back( currentIndex + 1 );
+	myBuildStartTime	= VEProfiler::GetTime();
+	myMeshHash			= myScratch->mySnapshot.CalculateHash( myMeshCheckHash );
+	myHasMeshHash		= true;
 
-		currentIndex = myVertices.size();
+	// A mesh going in to the world cache is built anyway, the world cache needs its vertices
+	VEWorldCache* worldCache = VoxelEngine::GetInstance()->GetWorldCache();
+	if( myIsMeshCacheable && worldCache != NULL && worldCache->GetIsOpen() )
+	{
+		return false;
 	}
 
-	// Right face
-	if( aVisiblity & VV_Right )
+	VEMeshCacheEntry* entry = meshCache->Acquire( myMeshHash, myMeshCheckHash );
+	if( entry == NULL )
 	{
-		currentNormal = XMFLOAT3( 1.0f, 0.0f, 0.0f );
+		return false;
+	}
+
+	SetMeshEntry( entry );
+	ReleaseScratch();
+
+	return true;
+}
+
 
-		myVertices.push_back( VoxelVertices(point3, currentNormal, aColour) );
-		myVertices.push_back( VoxelVertices(point6, currentNormal, aColour) );
-		myVertices.push_back( VoxelVertices(point8, currentNormal, aColour) );
-		myVertices.push_back( VoxelVertices(point2, currentNormal, aColour) );
+// Builds the vertex and index buffers, then hands the scratch buffer back to the chunk manager
+bool VEChunkData::BuildBuffers()
+{
+	VE_PROFILE_ZONE( "VEChunkData::BuildBuffers" );
 
-		myIndices.push_back( currentIndex );
-		myIndices.push_back( currentIndex + 1 );
-		myIndices.push_back( currentIndex + 2 );
+	assert( myScratch != NULL );
 
-		myIndices.push_back( currentIndex );
-		myIndices.push_back( currentIndex + 3 );
-		myIndices.push_back( currentIndex + 1 );
+	std::vector<VoxelVertices>& vertices	= myScratch->myVertices;
+	std::vector<unsigned long>& indices		= myScratch->myIndices;
 
-		currentIndex = myVertices.size();
+	// Save the mesh while it's still in the scratch buffer, the next start skips building it
+	VEWorldCache* worldCache = VoxelEngine::GetInstance()->GetWorldCache();
+	if( myIsMeshCacheable && worldCache != NULL && worldCache->GetIsOpen() )
+	{
+		worldCache->SaveMesh( myChunk, myNeighbourMask, vertices.data(), vertices.size(), indices.data(), indices.size() );
 	}
 
-	// Top face
-	if( aVisiblity & VV_Top )
+	// Build the vertex & index buffers
+	bool succeeded = CreateBuffers( vertices.data(), vertices.size(), indices.data(), indices.size() );
+
+	// Chunks with the same contents share the buffers from now on
+	if( succeeded && myHasMeshHash )
 	{
-		currentNormal = XMFLOAT3( 0.0f, 1.0f, 0.0f );
+		VEMeshCache* meshCache = VoxelEngine::GetInstance()->GetChunkManager()->GetMeshCache();
 
-		myVertices.push_back( VoxelVertices(point4, currentNormal, aColour) );
-		myVertices.push_back( VoxelVertices(point6, currentNormal, aColour) );
-		myVertices.push_back( VoxelVertices(point2, currentNormal, aColour) );
-		myVertices.push_back( VoxelVertices(point7, currentNormal, aColour) );
+		VEMeshCacheEntry* entry = meshCache->Insert( myMeshHash, myMeshCheckHash, myVertexBuffer, myIndexBuffer, myIndexCount, myMeshBytes, VEProfiler::GetTime() - myBuildStartTime );
+		if( entry != NULL )
+		{
+			SetMeshEntry( entry );
+		}
+	}
 
-		myIndices.push_back( currentIndex );
-		myIndices.push_back( currentIndex + 1 );
-		myIndices.push_back( currentIndex + 2 );
+	// The buffers hold the data now, so the scratch buffer can be used by another chunk
+	ReleaseScratch();
 
-		myIndices.push_back( currentIndex );
-		myIndices.push_back( currentIndex + 3 );
-		myIndices.push_back( currentIndex + 1 );
+	return succeeded;
+}
 
-		currentIndex = myVertices.size();
-	}
 
-	// Bottom face
-	if( aVisiblity & VV_Bottom )
-	{
-		currentNormal = XMFLOAT3( 0.0f, -1.0f, 0.0f );
+// Creates the vertex & index buffers from the supplied vertices & indices
+bool VEChunkData::CreateBuffers( const VoxelVertices* someVertices, unsigned int aVertexCount, const unsigned long* someIndices, unsigned int anIndexCount )
+{
+	VERenderBackend* renderBackend = VoxelEngine::GetInstance()->GetRenderBackend();
+	assert( renderBackend != NULL );
 
-		myVertices.push_back( VoxelVertices(point1, currentNormal, aColour) );
-		myVertices.push_back( VoxelVertices(point8, currentNormal, aColour) );
-		myVertices.push_back( VoxelVertices(point5, currentNormal, aColour) );
-		myVertices.push_back( VoxelVertices(point3, currentNormal, aColour) );
+	ReleaseBuffers();
 
-		myIndices.push_back( currentIndex );
-		myIndices.push_back( currentIndex + 1 );
-		myIndices.push_back( currentIndex + 2 );
+	bool succeeded = renderBackend->CreateBuffer( BT_Vertex, someVertices, sizeof(VoxelVertices) * aVertexCount, &myVertexBuffer ) &&
+					 renderBackend->CreateBuffer( BT_Index, someIndices, sizeof(unsigned long) * anIndexCount, &myIndexBuffer );
 
-		myIndices.push_back( currentIndex );
-		myIndices.push_back( currentIndex + 3 );
-		myIndices.push_back( currentIndex + 1 );
+	myIndexCount	= succeeded ? anIndexCount : 0;
+	myMeshBytes		= succeeded ? sizeof(VoxelVertices) * aVertexCount + sizeof(unsigned long) * anIndexCount : 0;
 
-		currentIndex = myVertices.size();
-	}
+	return succeeded;
 }
 
 
-// Creates a thread that builds the vertex and index buffers
-bool VEChunkData::BuildBuffers()
+// Releases the vertex & index buffers. Render states hold their own references, so a frame being drawn keeps them
+void VEChunkData::ReleaseBuffers()
 {
-	VEDirectXInterface* renderInterface = VoxelEngine::GetInstance()->GetRenderInterface();
-	assert( renderInterface != NULL );
-
-	D3D11_BUFFER_DESC       bufferDescription;
-	D3D11_SUBRESOURCE_DATA  bufferData;
-	HRESULT					result;
-
-	// Build the vertex buffer
-	ZeroMemory( &bufferDescription, sizeof(D3D11_BUFFER_DESC) );
-	bufferDescription.Usage                 = D3D11_USAGE_DEFAULT;
-	bufferDescription.ByteWidth             = sizeof(VoxelVertices) * myVertices.size();
-	bufferDescription.BindFlags             = D3D11_BIND_VERTEX_BUFFER;
-	bufferDescription.CPUAccessFlags        = 0;
-	bufferDescription.MiscFlags             = 0;
-	bufferDescription.StructureByteStride   = 0;
-
-	bufferData.pSysMem          = myVertices.data();
-	bufferData.SysMemPitch      = 0;
-	bufferData.SysMemSlicePitch = 0;
-
-	result = renderInterface->GetDevice()->CreateBuffer( &bufferDescription, &bufferData, &myVertexBuffer );  
-	if( FAILED(result) )
+	SetVertexBuffer( NULL );
+	SetIndexBuffer( NULL );
+
+	myIndexCount	= 0;
+	myMeshBytes		= 0;
+
+	if( myMeshEntry != NULL )
 	{
-		return false;
+		VoxelEngine::GetInstance()->GetChunkManager()->GetMeshCache()->Release( myMeshEntry );
+		myMeshEntry = NULL;
 	}
+}
 
-	// Build the index buffer
-	ZeroMemory( &bufferDescription, sizeof(D3D11_BUFFER_DESC) );
-	bufferDescription.Usage                 = D3D11_USAGE_DEFAULT;
-	bufferDescription.ByteWidth             = sizeof(unsigned long) * myIndices.size();
-	bufferDescription.BindFlags             = D3D11_BIND_INDEX_BUFFER;
-	bufferDescription.CPUAccessFlags        = 0;
-	bufferDescription.MiscFlags             = 0;
-	bufferDescription.StructureByteStride   = 0;
-
-	bufferData.pSysMem			= myIndices.data();
-	bufferData.SysMemPitch		= 0;
-	bufferData.SysMemSlicePitch = 0;
-
-	result = renderInterface->GetDevice()->CreateBuffer( &bufferDescription, &bufferData, &myIndexBuffer );
-	if( FAILED(result) )
+
+// The bytes releasing the buffers would free, including a cached mesh no other chunk shares
+unsigned int VEChunkData::GetReleasedBytes()
+{
+	if( myMeshEntry == NULL )
 	{
-		return false;
+		return myMeshBytes;
 	}
 
-	return true;
+	return VoxelEngine::GetInstance()->GetChunkManager()->GetMeshCache()->GetReleasedBytes( myMeshEntry );
+}
+
+
+// The snapshot in the current scratch buffer, NULL between builds
+VEChunkSnapshot* VEChunkData::GetSnapshot()
+{
+	return myScratch != NULL ? &myScratch->mySnapshot : NULL;
 }
 
 
@@ -269,4 +335,161 @@ void VEChunkData::SetIndexBuffer( ID3D11Buffer* anIndexBuffer )
 	}
 
 	myIndexBuffer = anIndexBuffer;
+}
+
+
+// Returns the number of visible faces in a Y-slab of the scratch buffer's snapshot
+unsigned int VEChunkData::CountSlabFaces( const VEMeshScratch& aScratch, int aY )
+{
+	const VEChunkSnapshot&	snapshot	= aScratch.mySnapshot;
+	const unsigned char*	visibility	= snapshot.GetVisibility();
+	int						dimensions	= snapshot.GetDimensions();
+
+	unsigned int faceCount = 0;
+	for( int x = 0; x < dimensions; x++ )
+	{
+		const unsigned char* row = &visibility[(x * dimensions + aY) * dimensions];
+		for( int z = 0; z < dimensions; z++ )
+		{
+			faceCount += CountFaces( row[z] );
+		}
+	}
+
+	return faceCount;
+}
+
+
+// Writes the faces of a Y-slab in to the slab's range of the scratch buffers
+void VEChunkData::FillSlab( VEMeshScratch& aScratch, int aY )
+{
+	const VEChunkSnapshot&	snapshot	= aScratch.mySnapshot;
+	const unsigned char*	visibility	= snapshot.GetVisibility();
+	int						dimensions	= snapshot.GetDimensions();
+	float					voxelSize	= snapshot.GetVoxelSize();
+
+	unsigned int	firstFace	= aScratch.mySlabOffsets[aY];
+	VoxelVertices*	vertices	= &aScratch.myVertices[0] + firstFace * 4;
+	unsigned long*	indices		= &aScratch.myIndices[0] + firstFace * 6;
+	unsigned long	baseVertex	= firstFace * 4;
+
+	// Positions are relative to the chunk's origin, so chunks with the same contents have the same mesh (see
+	// VEMeshCache). They're stepped the same way the slabs would be when built in order, so the output doesn't depend
+	// on how the slabs were split up
+	XMFLOAT3 voxelPosition( 0.0f, 0.0f, 0.0f );
+	for( int y = 0; y < aY; y++ )
+	{
+		voxelPosition.y += voxelSize;
+	}
+
+	for( int x = 0; x < dimensions; x++ )
+	{
+		const unsigned char* row = &visibility[(x * dimensions + aY) * dimensions];
+		for( int z = 0; z < dimensions; z++ )
+		{
+			DWORD faces = row[z];
+			if( faces != VV_None )
+			{
+				unsigned int faceCount = EmitFaces( vertices, indices, baseVertex, voxelPosition, voxelSize, faces );
+
+				vertices	+= faceCount * 4;
+				indices		+= faceCount * 6;
+				baseVertex	+= faceCount * 4;
+			}
+
+			voxelPosition.z += voxelSize;
+		}
+
+		voxelPosition.x += voxelSize;
+		voxelPosition.z = 0.0f;
+	}
+
+	assert( baseVertex == aScratch.mySlabOffsets[aY + 1] * 4 );
+}
+
+
+// Writes the visible faces of a voxel to the supplied vertices & indices, returning the number of faces written
+unsigned int VEChunkData::EmitFaces( VoxelVertices* someVertices, unsigned long* someIndices, unsigned long aBaseVertex, const XMFLOAT3& aPosition, float aVoxelSize, DWORD aVisibility )
+{
+	// The voxel's corners, the face definitions index in to these
+	const XMFLOAT3 corners[8] =
+	{
+		XMFLOAT3( aPosition.x, aPosition.y, aPosition.z ),
+		XMFLOAT3( aPosition.x + aVoxelSize, aPosition.y + aVoxelSize, aPosition.z ),
+		XMFLOAT3( aPosition.x + aVoxelSize, aPosition.y, aPosition.z ),
+		XMFLOAT3( aPosition.x, aPosition.y + aVoxelSize, aPosition.z ),
+
+		XMFLOAT3( aPosition.x, aPosition.y, aPosition.z + aVoxelSize ),
+		XMFLOAT3( aPosition.x + aVoxelSize, aPosition.y + aVoxelSize, aPosition.z + aVoxelSize ),
+		XMFLOAT3( aPosition.x, aPosition.y + aVoxelSize, aPosition.z + aVoxelSize ),
+		XMFLOAT3( aPosition.x + aVoxelSize, aPosition.y, aPosition.z + aVoxelSize )
+	};
+
+	unsigned int faceCount = 0;
+	for( unsigned int i = 0; i < ARRAYSIZE(ourFaces); i++ )
+	{
+		const FaceDefinition& face = ourFaces[i];
+		if( (aVisibility & face.myVisibility) == 0 )
+		{
+			continue;
+		}
+
+		for( unsigned int corner = 0; corner < 4; corner++ )
+		{
+			VoxelVertices& vertex = someVertices[corner];
+			vertex.myPosition	= corners[face.myCorners[corner]];
+			vertex.myNormal		= face.myNormal;
+			vertex.myColour		= ourGrassColour;
+		}
+
+		for( unsigned int index = 0; index < 6; index++ )
+		{
+			someIndices[index] = aBaseVertex + ourFaceIndices[index];
+		}
+
+		someVertices	+= 4;
+		someIndices		+= 6;
+		aBaseVertex		+= 4;
+		faceCount++;
+	}
+
+	return faceCount;
+}
+
+
+// Hands the scratch buffer back to the chunk manager
+void VEChunkData::ReleaseScratch()
+{
+	if( myScratch == NULL )
+	{
+		return;
+	}
+
+	VEChunkManager* chunkManager = VoxelEngine::GetInstance()->GetChunkManager();
+	assert( chunkManager != NULL );
+
+	chunkManager->GetMeshScratchPool()->Release( myScratch );
+	myScratch = NULL;
+}
+
+
+// Takes the buffers of a mesh cache entry the chunk holds a reference to, releasing its own. The entry's buffers are
+// add-ref'd, the cache keeps its own references to them
+void VEChunkData::SetMeshEntry( VEMeshCacheEntry* anEntry )
+{
+	ReleaseBuffers();
+
+	if( anEntry->myVertexBuffer != NULL )
+	{
+		anEntry->myVertexBuffer->AddRef();
+	}
+
+	if( anEntry->myIndexBuffer != NULL )
+	{
+		anEntry->myIndexBuffer->AddRef();
+	}
+
+	myVertexBuffer	= anEntry->myVertexBuffer;
+	myIndexBuffer	= anEntry->myIndexBuffer;
+	myIndexCount	= anEntry->myIndexCount;
+	myMeshEntry		= anEntry;
 }
\ No newline at end of file
@@ -10,11 +10,15 @@
 // ------------------ Forward Declarations ----------------
 
 class VEChunk;
+class VEChunkSnapshot;
+struct VEMeshScratch;
+struct VEMeshCacheEntry;
 
 
 // ----------------------- Classes ------------------------
 
-// The chunk data class maintains the vertex and index buffer data for a single chunk
+// The chunk data class maintains the vertex and index buffer data for a single chunk. The vertices are relative to the
+// chunk's origin, and chunks with the same contents share their buffers through the chunk manager's mesh cache
 class VEChunkData
 {
 	public :
@@ -30,15 +34,34 @@ class VEChunkData
 		// Cleans up the memory used by the 
 		void	Uninitialise();
 
-		// Clears the vertex and index buffers
+		// Clears the vertex and index buffers, and takes a scratch buffer from the chunk manager to capture the
+		// chunk's snapshot & build the new vertices & indices in
 		void	Reset();
 
-		// Adds voxel vertices and indices based on the visible faces
-		void	AddFaces( DirectX::XMFLOAT3& aPosition, DWORD aVisability, DirectX::XMFLOAT4& aColour );
+		// Builds the chunk's vertices & indices from the visibility in its snapshot, optionally splitting the work
+		// across threads by Y-slab. Reset must have been called & the snapshot's visibility calculated first
+		void	BuildMesh( bool anIsParallel );
 
-		// Creates a thread that builds the vertex and index buffers
+		// Builds the vertices & indices for the snapshot held in a scratch buffer. Only the scratch buffer is touched,
+		// so any number of scratch buffers can be meshed at once
+		static void	BuildMesh( VEMeshScratch& aScratch, bool anIsParallel );
+
+		// Shares the mesh cache's mesh for the snapshot rather than building one, handing the scratch buffer back.
+		// Returns false if the cache doesn't have it, in which case the mesh built next is added to the cache
+		bool	AcquireCachedMesh();
+
+		// Builds the vertex and index buffers, then hands the scratch buffer back to the chunk manager
 		bool	BuildBuffers();
 
+		// Creates the vertex & index buffers from the supplied vertices & indices, releasing any the chunk already has
+		bool	CreateBuffers( const VoxelVertices* someVertices, unsigned int aVertexCount, const unsigned long* someIndices, unsigned int anIndexCount );
+
+		// Releases the vertex & index buffers, leaving the chunk with nothing to draw
+		void	ReleaseBuffers();
+
+		// The bytes releasing the buffers would free, including a cached mesh no other chunk shares
+		unsigned int	GetReleasedBytes();
+
 
 		// ---------- Accessors ----------
 
@@ -48,27 +71,58 @@ class VEChunkData
 		ID3D11Buffer*				GetIndexBuffer()									{ return myIndexBuffer; }
 		void						SetIndexBuffer( ID3D11Buffer* anIndexBuffer );
 
-		std::vector<VoxelVertices>&	GetVertices()										{ return myVertices; }
-		std::vector<unsigned long>& GetIndices()										{ return myIndices; }
+		int							GetIndexCount()										{ return myIndexCount; }
 
-		int							GetIndexCount()										{ return myIndices.size(); }
+		// The bytes taken by the vertex & index buffers, unless they're shared through the mesh cache which counts its own
+		unsigned int				GetMeshBytes()										{ return myMeshBytes; }
+
+		// The snapshot in the current scratch buffer, NULL between builds
+		VEChunkSnapshot*			GetSnapshot();
+
+		// Whether the mesh being built is saved to the world cache, and the neighbour mask of the snapshot it's built from
+		void						SetMeshCacheable( bool anIsCacheable, unsigned int aNeighbourMask )	{ myIsMeshCacheable = anIsCacheable; myNeighbourMask = aNeighbourMask; }
 
 
 	private :
 
 		// ------- Private Functions ------
 
+		// Returns the number of visible faces in a Y-slab of the scratch buffer's snapshot
+		static unsigned int			CountSlabFaces( const VEMeshScratch& aScratch, int aY );
+
+		// Writes the faces of a Y-slab in to the slab's range of the scratch buffers
+		static void					FillSlab( VEMeshScratch& aScratch, int aY );
+
+		// Writes the visible faces of a voxel to the supplied vertices & indices, returning the number of faces written
+		static unsigned int			EmitFaces( VoxelVertices* someVertices, unsigned long* someIndices, unsigned long aBaseVertex, const DirectX::XMFLOAT3& aPosition, float aVoxelSize, DWORD aVisibility );
+
+		// Hands the scratch buffer back to the chunk manager
+		void						ReleaseScratch();
+
+		// Takes the buffers of a mesh cache entry the chunk holds a reference to, releasing its own
+		void						SetMeshEntry( VEMeshCacheEntry* anEntry );
+
+
 		// ------- Private Variables ------
 
 		ID3D11Buffer*				myVertexBuffer;
-		std::vector<VoxelVertices>	myVertices;
-
 		ID3D11Buffer*				myIndexBuffer;
-		std::vector<unsigned long>	myIndices;
+		int							myIndexCount;
+		unsigned int				myMeshBytes;
 
-		VEChunk*					myChunk;
+		// The mesh cache entry the buffers are shared through, and the hashes & start time of the mesh being built
+		VEMeshCacheEntry*			myMeshEntry;
+		unsigned long long			myMeshHash;
+		unsigned long long			myMeshCheckHash;
+		bool						myHasMeshHash;
+		long long					myBuildStartTime;
+
+		VEMeshScratch*				myScratch;
 
-		
+		bool						myIsMeshCacheable;
+		unsigned int				myNeighbourMask;
+
+		VEChunk*					myChunk;
 };
 
 
@@ -5,6 +5,14 @@
 #include "VEChunkManager.h"
 
 #include "VEChunk.h"
+#include "VoxelEngine.h"
+#include "VEEventBus.h"
+#include "VEProfiler.h"
+#include "VEPoolAllocator.h"
+#include "VEMeshScratchPool.h"
+#include "VEMeshCache.h"
+#include "VEVoxel.h"
+#include "VEWorldCache.h"
 
 
 // ------------------------- Namespaces -----------------------
@@ -19,8 +27,82 @@ VEChunkManager::VEChunkManager() :
 	myNextChunkId( 0 ),
 	myChunkDimensions( 0 ),
 	myGridWidth( 0 ),
-	myGridDepth( 0 )
+	myGridDepth( 0 ),
+	myVoxelPool( NULL ),
+	myUseLargePages( false ),
+	myViewPosition( 0.0f, 0.0f, 0.0f ),
+	myViewDistance( 0.0f ),
+	myAccessTime( 0.0 ),
+	myLastCompressionTime( 0.0 ),
+	myCompressionDelay( VE_CHUNK_COMPRESS_DELAY ),
+	myIsStopping( false ),
+	myCompressingChunk( NULL ),
+	myCompressionCount( 0 ),
+	mySpillCount( 0 ),
+	myDecompressionCount( 0 ),
+	myDecompressionTime( 0 ),
+	myMaxDecompressionTime( 0 )
 {
+	myChunkPool			= new VEPoolAllocator( sizeof(VEChunk), VE_CHUNK_POOL_PAGE_SIZE );
+	myMeshScratchPool	= new VEMeshScratchPool();
+	myMeshCache			= new VEMeshCache();
+}
+
+
+// Deconstruction, releases the pools. The chunks must have been uninitialised first
+VEChunkManager::~VEChunkManager()
+{
+	assert( myChunks.empty() );
+
+	{
+		VEScopedLock<VEMutex> lock( myCompressionLock );
+
+		myIsStopping = true;
+		myCompressionCondition.NotifyAll();
+	}
+	myCompressionThread.Join();
+
+	// Blocks cached by this thread would be lost otherwise
+	VEPoolAllocator::ReleaseThreadCaches();
+
+	if( myVoxelPool != NULL )
+	{
+		delete myVoxelPool;
+		myVoxelPool = NULL;
+	}
+
+	if( myChunkPool != NULL )
+	{
+		delete myChunkPool;
+		myChunkPool = NULL;
+	}
+
+	if( myMeshScratchPool != NULL )
+	{
+		delete myMeshScratchPool;
+		myMeshScratchPool = NULL;
+	}
+
+	if( myMeshCache != NULL )
+	{
+		delete myMeshCache;
+		myMeshCache = NULL;
+	}
+}
+
+
+// Registers for the events posted by the chunk build threads and starts the compression thread
+bool VEChunkManager::Initialise()
+{
+	VEEventBus* eventBus = VoxelEngine::GetInstance()->GetEventBus();
+	assert( eventBus != NULL );
+
+	if( !eventBus->RegisterHandler(EE_ChunkBuilt, VEChunkManager::HandleChunkBuiltEvent, this) )
+	{
+		return false;
+	}
+
+	return myCompressionThread.Start( VEChunkManager::CompressionThread, this );
 }
 
 
@@ -32,15 +114,29 @@ bool VEChunkManager::CreateGrid( int aWidth /* = 5 */, int aDepth /* = 5 */, int
 		return false;
 	}
 
-	myChunkDimensions	= aChunkDimensions;
-	myGridWidth			= aWidth;
-	myGridDepth			= aDepth;
-
 	if( myChunks.size() > 0 )
 	{
 		Uninitialise();
 	}
 
+	// Voxel blocks are sized for the chunk dimensions, so the pool is replaced when they change
+	if( myVoxelPool == NULL || aChunkDimensions != myChunkDimensions )
+	{
+		if( myVoxelPool != NULL )
+		{
+			VEPoolAllocator::ReleaseThreadCaches();
+			delete myVoxelPool;
+		}
+
+		// Voxel blocks are large, so threads don't cache any of them
+		unsigned int voxelBlockSize = aChunkDimensions * aChunkDimensions * aChunkDimensions * sizeof(VEVoxel);
+		myVoxelPool = new VEPoolAllocator( voxelBlockSize, VE_VOXEL_POOL_PAGE_SIZE, 0, myUseLargePages );
+	}
+
+	myChunkDimensions	= aChunkDimensions;
+	myGridWidth			= aWidth;
+	myGridDepth			= aDepth;
+
 	// Create the grid of chunks
 	XMFLOAT3 currentPosition = aStartPosition;
 	for( int z = 0; z < myGridDepth; z++ )
@@ -66,27 +162,63 @@ void VEChunkManager::Uninitialise()
 	{
 		if( myChunks[i] != NULL )
 		{
-			myChunks[i]->Uninitialise();
-
-			delete myChunks[i];
+			DestroyChunk( myChunks[i] );
 			myChunks[i] = NULL;
 		}
 	}
 
 	myChunks.clear();
+	myChunkIds.clear();
 }
 
 
-// Updates the chunks that need to be rebuilt
+// Updates the chunks that need to be rebuilt, queues the chunks that haven't been touched for a while to be
+// compressed and keeps the chunks within the memory budgets
 void VEChunkManager::Update( float anElapsedTime )
 {
+	VE_PROFILE_ZONE( "VEChunkManager::Update" );
+
+	myAccessTime += anElapsedTime;
+
+	unsigned int currentTime = (unsigned int)( myAccessTime * 1000.0 );
+	VEChunk::SetAccessTime( currentTime );
+
+	// Evicted meshes are restored before the rebuilds, so those that aren't in the world cache are rebuilt this update
+	UpdateVisibility( currentTime );
+
+	// A chunk's snapshot holds a copy of its neighbours' touching faces, so an edited chunk's neighbours are rebuilt
+	// along with it
 	for( unsigned int i = 0; i < myChunks.size(); i++ )
 	{
-		if( myChunks[i]->GetIsDirty() )
+		VEChunk* chunk = myChunks[i];
+		if( chunk->GetNeighboursDirty() )
+		{
+			MarkDirty( chunk->GetGridX() - 1, chunk->GetGridZ() );
+			MarkDirty( chunk->GetGridX() + 1, chunk->GetGridZ() );
+			MarkDirty( chunk->GetGridX(), chunk->GetGridZ() - 1 );
+			MarkDirty( chunk->GetGridX(), chunk->GetGridZ() + 1 );
+
+			chunk->SetNeighboursDirty( false );
+		}
+	}
+
+	// Chunks that are still building stay dirty, and are rebuilt from a fresh snapshot once their build has finished.
+	// Chunks whose meshes are evicted wait until they're back in view
+	for( unsigned int i = 0; i < myChunks.size(); i++ )
+	{
+		if( myChunks[i]->GetIsDirty() && !myChunks[i]->GetIsBuilding() && !myChunks[i]->GetIsMeshEvicted() )
 		{
 			myChunks[i]->Rebuild();
 		}
 	}
+
+	if( myCompressionDelay > 0 && (myAccessTime - myLastCompressionTime) * 1000.0 >= VE_CHUNK_COMPRESS_INTERVAL )
+	{
+		QueueCompression();
+		myLastCompressionTime = myAccessTime;
+	}
+
+	UpdateBudgets( currentTime );
 }
 
 
@@ -114,6 +246,157 @@ void VEChunkManager::CalculateVoxelOffset( DirectX::XMINT3& aChunkOffset, const
 }
 
 
+// Fills the list with the chunks that are ready to be drawn this frame
+void VEChunkManager::GetRenderableChunks( VEChunkRenderList& someChunks )
+{
+	someChunks.reserve( someChunks.size() + myChunks.size() );
+
+	for( unsigned int i = 0; i < myChunks.size(); i++ )
+	{
+		VEChunk* chunk = myChunks[i];
+		if( chunk->GetEnabled() && chunk->GetIndexCount() > 0 )
+		{
+			someChunks.push_back( chunk );
+		}
+	}
+}
+
+
+// Creates & initialises a chunk from the chunk pool, without adding it to the grid
+VEChunk* VEChunkManager::CreateChunk( const XMFLOAT3& aPosition, int aGridX, int aGridZ )
+{
+	void* chunkMemory = myChunkPool->Allocate();
+	if( chunkMemory == NULL )
+	{
+		return NULL;
+	}
+
+	VEChunk* newChunk = new( chunkMemory ) VEChunk( myNextChunkId++, myChunkDimensions, aGridX, aGridZ );
+	if( !newChunk->Initialise(aPosition) )
+	{
+		DestroyChunk( newChunk );
+		return NULL;
+	}
+
+	return newChunk;
+}
+
+
+// Uninitialises a chunk created by CreateChunk and hands it back to the chunk pool
+void VEChunkManager::DestroyChunk( VEChunk* aChunk )
+{
+	if( aChunk == NULL )
+	{
+		return;
+	}
+
+	// The compression thread mustn't be left with the chunk
+	{
+		VEScopedLock<VEMutex> lock( myCompressionLock );
+
+		myCompressionQueue.erase( std::remove(myCompressionQueue.begin(), myCompressionQueue.end(), aChunk), myCompressionQueue.end() );
+		myEvictionQueue.erase( std::remove(myEvictionQueue.begin(), myEvictionQueue.end(), aChunk), myEvictionQueue.end() );
+		while( myCompressingChunk == aChunk )
+		{
+			myCompressedCondition.Wait( myCompressionLock );
+		}
+	}
+
+	aChunk->Uninitialise();
+	aChunk->~VEChunk();
+
+	myChunkPool->Free( aChunk );
+}
+
+
+// Returns an uninitialised block of voxels for a chunk of the current dimensions
+VEVoxel* VEChunkManager::AllocateVoxels()
+{
+	assert( myVoxelPool != NULL );
+
+	return reinterpret_cast<VEVoxel*>( myVoxelPool->Allocate() );
+}
+
+
+// Hands a chunk's voxels back to the voxel pool, optionally handing their memory back to the system
+void VEChunkManager::FreeVoxels( VEVoxel* someVoxels, bool aDecommit )
+{
+	assert( myVoxelPool != NULL );
+
+	if( aDecommit )
+	{
+		myVoxelPool->FreeDecommitted( someVoxels );
+	}
+	else
+	{
+		myVoxelPool->Free( someVoxels );
+	}
+}
+
+
+// Counts a compressed chunk being decompressed
+void VEChunkManager::RecordDecompression( long long aTime )
+{
+	VEScopedLock<VEMutex> lock( myCompressionLock );
+
+	myDecompressionCount++;
+	myDecompressionTime += aTime;
+	myMaxDecompressionTime = aTime > myMaxDecompressionTime ? aTime : myMaxDecompressionTime;
+}
+
+
+// The number of chunks whose voxels are compressed
+unsigned int VEChunkManager::GetCompressedChunkCount()
+{
+	unsigned int chunkCount = 0;
+	for( unsigned int i = 0; i < myChunks.size(); i++ )
+	{
+		chunkCount += myChunks[i]->GetIsCompressed() ? 1 : 0;
+	}
+
+	return chunkCount;
+}
+
+
+// The bytes taken by the chunks' compressed voxels
+unsigned long long VEChunkManager::GetCompressedBytes()
+{
+	unsigned long long compressedBytes = 0;
+	for( unsigned int i = 0; i < myChunks.size(); i++ )
+	{
+		compressedBytes += myChunks[i]->GetCompressedSize();
+	}
+
+	return compressedBytes;
+}
+
+
+// The number of chunks whose voxels are spilled to the world cache
+unsigned int VEChunkManager::GetSpilledChunkCount()
+{
+	unsigned int chunkCount = 0;
+	for( unsigned int i = 0; i < myChunks.size(); i++ )
+	{
+		chunkCount += myChunks[i]->GetIsSpilled() ? 1 : 0;
+	}
+
+	return chunkCount;
+}
+
+
+// The number of chunks whose meshes are evicted
+unsigned int VEChunkManager::GetEvictedMeshCount()
+{
+	unsigned int chunkCount = 0;
+	for( unsigned int i = 0; i < myChunks.size(); i++ )
+	{
+		chunkCount += myChunks[i]->GetIsMeshEvicted() ? 1 : 0;
+	}
+
+	return chunkCount;
+}
+
+
 // Returns a pointer to the chunk at the calculated index
 VEChunk* VEChunkManager::GetChunk( int anX, int aZ )
 {
@@ -132,26 +415,30 @@ VEChunk* VEChunkManager::GetChunk( int anX, int aZ )
 }
 
 
-// Adds a chunk to the engine
-VEChunk* VEChunkManager::AddChunk( const XMFLOAT3& aPosition, int aGridX, int aGridZ )
+// Flags the chunk at the supplied grid coordinates to be rebuilt, if there is one
+void VEChunkManager::MarkDirty( int aGridX, int aGridZ )
 {
-	// Create the new chunk
-	VEChunk* newChunk = new VEChunk( myNextChunkId++, myChunkDimensions, aGridX, aGridZ );
-	if( newChunk == NULL )
+	VEChunk* chunk = GetChunk( aGridX, aGridZ );
+	if( chunk != NULL )
 	{
-		return NULL;
+		chunk->SetIsDirty( true );
 	}
+}
 
-	// Initialise the chunk
-	if( !newChunk->Initialise(aPosition) )
-	{
-		delete newChunk;
-		newChunk = NULL;
 
+// Adds a chunk to the engine
+VEChunk* VEChunkManager::AddChunk( const XMFLOAT3& aPosition, int aGridX, int aGridZ )
+{
+	// Create & initialise the new chunk
+	VEChunk* newChunk = CreateChunk( aPosition, aGridX, aGridZ );
+	if( newChunk == NULL )
+	{
 		return NULL;
 	}
 
 	myChunks.push_back( newChunk );
+	myChunkIds[newChunk->GetId()] = newChunk;
+
 	return newChunk;
 }
 
@@ -163,7 +450,9 @@ bool VEChunkManager::RemoveChunk( int aChunkId )
 	{
 		if( myChunks[i]->GetId() == aChunkId )
 		{
-			delete myChunks[i];
+			myChunkIds.erase( aChunkId );
+
+			DestroyChunk( myChunks[i] );
 			myChunks[i] = NULL;
 
 			myChunks.erase( myChunks.begin() + i );
@@ -172,4 +461,289 @@ bool VEChunkManager::RemoveChunk( int aChunkId )
 	}
 
 	return false;
+}
+
+
+// Enables chunks once their build thread has finished. The chunk is looked up by id, as it may have been
+// removed while it was being built
+void VEChunkManager::HandleChunkBuiltEvent( VEEvent* anEvent, LPVOID aParameter )
+{
+	VEChunkManager*		chunkManager	= reinterpret_cast<VEChunkManager*>( aParameter );
+	VEChunkBuiltEvent*	builtEvent		= static_cast<VEChunkBuiltEvent*>( anEvent );
+	assert( chunkManager != NULL && builtEvent != NULL );
+
+	ChunkIdMap::iterator iter = chunkManager->myChunkIds.find( builtEvent->GetChunkId() );
+	if( iter == chunkManager->myChunkIds.end() )
+	{
+		return;
+	}
+
+	VEChunk* chunk = iter->second;
+	chunk->SetIsBuilding( false );
+	chunk->SetEnabled( builtEvent->GetSucceeded() );
+}
+
+// Queues the chunks that haven't been touched for the compression delay, once the compression thread has finished
+// with the last ones
+void VEChunkManager::QueueCompression()
+{
+	VEScopedLock<VEMutex> lock( myCompressionLock );
+
+	if( !myCompressionQueue.empty() || myCompressingChunk != NULL )
+	{
+		return;
+	}
+
+	// Chunks waiting to be rebuilt are about to be read, the compression thread checks again before compressing
+	for( unsigned int i = 0; i < myChunks.size(); i++ )
+	{
+		VEChunk* chunk = myChunks[i];
+		if( chunk->GetIsResident() && !chunk->GetIsDirty() && !chunk->GetIsBuilding() && chunk->GetIdleTime() >= myCompressionDelay )
+		{
+			myCompressionQueue.push_back( chunk );
+		}
+	}
+
+	if( !myCompressionQueue.empty() )
+	{
+		myCompressionCondition.NotifyOne();
+	}
+}
+
+
+// Whether the chunk is within the view distance of the view position
+bool VEChunkManager::IsInView( VEChunk* aChunk )
+{
+	if( myViewDistance <= 0.0f )
+	{
+		return true;
+	}
+
+	// The distance to the nearest point of the chunk's footprint, so the chunk the view is in is always visible
+	const XMFLOAT3&	position	= aChunk->GetPosition();
+	float			size		= aChunk->GetDimensions() * aChunk->GetVoxelSize();
+
+	float deltaX = myViewPosition.x < position.x ? position.x - myViewPosition.x : myViewPosition.x - (position.x + size);
+	float deltaZ = myViewPosition.z < position.z ? position.z - myViewPosition.z : myViewPosition.z - (position.z + size);
+	deltaX = deltaX > 0.0f ? deltaX : 0.0f;
+	deltaZ = deltaZ > 0.0f ? deltaZ : 0.0f;
+
+	return deltaX * deltaX + deltaZ * deltaZ <= myViewDistance * myViewDistance;
+}
+
+
+// Stamps the chunks in view with the current time, restoring the meshes of any that were evicted
+void VEChunkManager::UpdateVisibility( unsigned int aCurrentTime )
+{
+	for( unsigned int i = 0; i < myChunks.size(); i++ )
+	{
+		VEChunk* chunk = myChunks[i];
+		if( !IsInView(chunk) )
+		{
+			continue;
+		}
+
+		chunk->SetVisibleTime( aCurrentTime );
+		if( chunk->GetIsMeshEvicted() )
+		{
+			chunk->RestoreMesh();
+		}
+	}
+}
+
+
+// Measures the memory each budget's data takes, and evicts the least recently visible data of those over budget. Only
+// chunks out of view are evicted, so a budget can stay over its limit if the chunks in view need more
+void VEChunkManager::UpdateBudgets( unsigned int aCurrentTime )
+{
+	VE_PROFILE_ZONE( "VEChunkManager::UpdateBudgets" );
+
+	unsigned long long voxelBlockSize	= myVoxelPool != NULL ? myVoxelPool->GetBlockSize() : 0;
+	unsigned long long voxelBytes		= 0;
+	unsigned long long meshBytes		= 0;
+	for( unsigned int i = 0; i < myChunks.size(); i++ )
+	{
+		VEChunk* chunk = myChunks[i];
+
+		voxelBytes	+= ( chunk->GetIsResident() ? voxelBlockSize : 0 ) + chunk->GetCompressedSize();
+		meshBytes	+= chunk->GetMeshBytes();
+	}
+
+	// Shared meshes are counted once, by the mesh cache
+	meshBytes += myMeshCache->GetBytes();
+
+	myMemoryBudget.SetUsage( MB_Voxels, voxelBytes );
+	myMemoryBudget.SetUsage( MB_GpuMeshes, meshBytes );
+	myMemoryBudget.SetUsage( MB_CpuMeshes, myMeshScratchPool->GetFreeBytes() );
+
+	// Cached meshes no chunk is using aren't drawn, so they go before any chunk's mesh
+	if( myMemoryBudget.GetIsOverBudget(MB_GpuMeshes) )
+	{
+		unsigned long long	trimmedBytes	= 0;
+		unsigned int		trimmedCount	= myMeshCache->Trim( 0, trimmedBytes );
+
+		meshBytes -= trimmedBytes;
+
+		myMemoryBudget.RecordEvictions( MB_GpuMeshes, trimmedCount, trimmedBytes );
+		myMemoryBudget.SetUsage( MB_GpuMeshes, meshBytes );
+	}
+
+	// Meshes are released straight away, render states hold their own references to the buffers
+	if( myMemoryBudget.GetIsOverBudget(MB_GpuMeshes) )
+	{
+		myEvictionCandidates.clear();
+		myEvictions.clear();
+
+		for( unsigned int i = 0; i < myChunks.size(); i++ )
+		{
+			VEChunk* chunk = myChunks[i];
+			if( chunk->GetVisibleTime() != aCurrentTime && chunk->GetEnabled() && !chunk->GetIsBuilding() && !chunk->GetIsDirty() )
+			{
+				myEvictionCandidates.push_back( VEEvictionCandidate(chunk, chunk->GetVisibleTime(), chunk->GetReleasedMeshBytes()) );
+			}
+		}
+
+		unsigned long long evictedBytes = VEMemoryBudget::SelectEvictions( myEvictionCandidates, meshBytes, myMemoryBudget.GetBudget(MB_GpuMeshes), myEvictions );
+		for( unsigned int i = 0; i < myEvictions.size(); i++ )
+		{
+			myEvictions[i]->EvictMesh();
+		}
+
+		// The cached meshes only the evicted chunks were using are freed with them
+		unsigned long long trimmedBytes = 0;
+		myMeshCache->Trim( 0, trimmedBytes );
+
+		myMemoryBudget.RecordEvictions( MB_GpuMeshes, (unsigned int)myEvictions.size(), evictedBytes );
+		myMemoryBudget.SetUsage( MB_GpuMeshes, meshBytes - evictedBytes );
+	}
+
+	// Only the scratch buffers waiting in the pool count, the meshes are only in scratch buffers while they're built
+	if( myMemoryBudget.GetIsOverBudget(MB_CpuMeshes) )
+	{
+		unsigned long long	trimmedBytes	= 0;
+		unsigned int		trimmedCount	= myMeshScratchPool->Trim( myMemoryBudget.GetBudget(MB_CpuMeshes), trimmedBytes );
+
+		myMemoryBudget.RecordEvictions( MB_CpuMeshes, trimmedCount, trimmedBytes );
+		myMemoryBudget.SetUsage( MB_CpuMeshes, myMeshScratchPool->GetFreeBytes() );
+	}
+
+	if( myMemoryBudget.GetIsOverBudget(MB_Voxels) )
+	{
+		QueueVoxelEvictions( aCurrentTime, voxelBytes );
+	}
+}
+
+
+// Queues the voxels of the least recently visible chunks to be compressed, or spilled if they already are, once the
+// compression thread has finished with the last ones
+void VEChunkManager::QueueVoxelEvictions( unsigned int aCurrentTime, unsigned long long aUsage )
+{
+	VEScopedLock<VEMutex> lock( myCompressionLock );
+
+	if( !myEvictionQueue.empty() || myCompressingChunk != NULL )
+	{
+		return;
+	}
+
+	VEWorldCache*	worldCache	= VoxelEngine::GetInstance()->GetWorldCache();
+	bool			canSpill	= worldCache != NULL && worldCache->GetIsOpen();
+
+	myEvictionCandidates.clear();
+	myEvictions.clear();
+
+	// Compressing a chunk frees most of its block, spilling it frees the rest. Chunks waiting to be rebuilt are about
+	// to be read, the compression thread checks again before compressing
+	unsigned long long voxelBlockSize = myVoxelPool->GetBlockSize();
+	for( unsigned int i = 0; i < myChunks.size(); i++ )
+	{
+		VEChunk* chunk = myChunks[i];
+		if( chunk->GetVisibleTime() == aCurrentTime || chunk->GetIsDirty() || chunk->GetIsBuilding() )
+		{
+			continue;
+		}
+
+		if( chunk->GetIsResident() )
+		{
+			myEvictionCandidates.push_back( VEEvictionCandidate(chunk, chunk->GetVisibleTime(), voxelBlockSize) );
+		}
+		else if( canSpill && chunk->GetIsCompressed() )
+		{
+			myEvictionCandidates.push_back( VEEvictionCandidate(chunk, chunk->GetVisibleTime(), chunk->GetCompressedSize()) );
+		}
+	}
+
+	unsigned long long evictedBytes = VEMemoryBudget::SelectEvictions( myEvictionCandidates, aUsage, myMemoryBudget.GetBudget(MB_Voxels), myEvictions );
+
+	// The thread takes chunks from the back, so the least recently visible go last
+	myEvictionQueue.assign( myEvictions.rbegin(), myEvictions.rend() );
+	myMemoryBudget.RecordEvictions( MB_Voxels, (unsigned int)myEvictions.size(), evictedBytes );
+
+	if( !myEvictionQueue.empty() )
+	{
+		myCompressionCondition.NotifyOne();
+	}
+}
+
+
+// The compression thread, compresses & spills queued chunks until the manager is destroyed
+unsigned int VEChunkManager::CompressionThread( void* aChunkManager )
+{
+	VEChunkManager* chunkManager = reinterpret_cast<VEChunkManager*>( aChunkManager );
+	assert( chunkManager != NULL );
+
+	std::vector<unsigned char> scratch;
+
+	{
+		VEScopedLock<VEMutex> lock( chunkManager->myCompressionLock );
+		while( true )
+		{
+			while( chunkManager->myCompressionQueue.empty() && chunkManager->myEvictionQueue.empty() && !chunkManager->myIsStopping )
+			{
+				chunkManager->myCompressionCondition.Wait( chunkManager->myCompressionLock );
+			}
+
+			if( chunkManager->myIsStopping )
+			{
+				break;
+			}
+
+			// Evictions go first, they're keeping the chunks within the voxel budget
+			bool					isEviction	= !chunkManager->myEvictionQueue.empty();
+			std::vector<VEChunk*>&	queue		= isEviction ? chunkManager->myEvictionQueue : chunkManager->myCompressionQueue;
+
+			// The chunk can't be destroyed while it's being compressed, see DestroyChunk
+			VEChunk*		chunk		= queue.back();
+			unsigned int	idleTime	= chunkManager->myCompressionDelay;
+
+			queue.pop_back();
+			chunkManager->myCompressingChunk = chunk;
+
+			chunkManager->myCompressionLock.Unlock();
+
+			// Evicted chunks are compressed however recently they were touched, and spilled if they already are
+			bool isCompressed	= false;
+			bool isSpilled		= false;
+			if( isEviction )
+			{
+				isSpilled		= chunk->GetIsCompressed() && chunk->SpillVoxels();
+				isCompressed	= !isSpilled && chunk->CompressVoxels( 0, scratch );
+			}
+			else
+			{
+				isCompressed	= idleTime > 0 && chunk->CompressVoxels( idleTime, scratch );
+			}
+
+			chunkManager->myCompressionLock.Lock();
+
+			chunkManager->myCompressingChunk = NULL;
+			chunkManager->myCompressionCount += isCompressed ? 1 : 0;
+			chunkManager->mySpillCount += isSpilled ? 1 : 0;
+			chunkManager->myCompressedCondition.NotifyAll();
+		}
+	}
+
+	// Hand the profiler buffer back before the thread exits
+	VE_PROFILE_THREAD_END();
+
+	return 0;
 }
\ No newline at end of file
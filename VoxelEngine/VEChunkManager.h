@@ -5,17 +5,52 @@
 // -------------------------- Includes -----------------------
 
 #include "VETypes.h"
+#include "VEFrameAllocator.h"
+#include "VEThreading.h"
+#include "VEMemoryBudget.h"
 
 
 // ------------------- Forward Declarations ------------------
 
 class VEChunk;
+class VEEvent;
+class VEVoxel;
+class VEPoolAllocator;
+class VEMeshScratchPool;
+class VEMeshCache;
+
+
+// ------------------------- Typedefs ------------------------
+
+// A list of chunks built in frame memory
+typedef VEFrameVector<VEChunk*>::Type	VEChunkRenderList;
+
+
+// ------------------------- Defines -------------------------
+
+// The number of chunk objects & voxel blocks carved from each page of the chunk manager's pools
+#define VE_CHUNK_POOL_PAGE_SIZE			64
+#define VE_VOXEL_POOL_PAGE_SIZE			4
+
+// How long a chunk's voxels go untouched before they're compressed, and how often the chunks are checked, in
+// milliseconds
+#define VE_CHUNK_COMPRESS_DELAY			30000
+#define VE_CHUNK_COMPRESS_INTERVAL		1000
 
 
 // ------------------------- Classes -------------------------
 
 // The chunk manager maintains all of the active chunks in the engine, providing methods for adding
-// new chunks and removing old ones
+// new chunks and removing old ones. Chunk objects, voxel blocks and mesh scratch buffers all come from pools
+// owned by the manager, so chunks streaming in & out recycle memory rather than going through the heap, and chunks with
+// the same contents share their meshes through the manager's mesh cache. Chunks that haven't been touched for a while
+// have their voxels compressed by the manager's compression thread.
+//
+// The manager also keeps the chunks within its memory budgets (see VEMemoryBudget). Chunks within the view distance of
+// the view position are stamped as visible each update, and when a budget is over its limit the data of the chunks
+// out of view is evicted, least recently visible first: cached meshes no chunk is using go first, then meshes are
+// released & brought back once the chunk is in view again, voxels are compressed & then spilled to the world cache, and
+// the mesh scratch buffers are trimmed
 class VEChunkManager
 {
 	public :
@@ -25,13 +60,20 @@ class VEChunkManager
 		// Construction
 		VEChunkManager();
 
+		// Deconstruction, releases the pools
+		~VEChunkManager();
+
+		// Registers for the events posted by the chunk build threads and starts the compression thread
+		bool							Initialise();
+
 		// Creates x * y voxel chunks, that can be accessed like a 2D array
 		bool							CreateGrid( int aWidth = 5, int aDepth = 5, int aChunkDimensions = 64, const DirectX::XMFLOAT3& aStartPosition = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f) );	
 
 		// Cleans the memory used by the chunks
 		void							Uninitialise();
 
-		// Updates the chunks that need to be rebuilt
+		// Updates the chunks that need to be rebuilt, and queues the chunks that haven't been touched for a while to be
+		// compressed
 		void							Update( float anElapsedTime );
 
 		// Returns the chunk that is active at the supplied position. The position is converted in to 'chuck-grid-space', and the appropriate chunk is 
@@ -41,6 +83,34 @@ class VEChunkManager
 		// Calculates the offset (in voxels) of the supplied position, given an active chunk
 		void							CalculateVoxelOffset( DirectX::XMINT3& aChunkOffset, const DirectX::XMFLOAT3& aCurrentPosition, const VEChunk* aChunk );
 
+		// Fills the list with the chunks that are ready to be drawn this frame (built, and with geometry)
+		void							GetRenderableChunks( VEChunkRenderList& someChunks );
+
+		// Creates & initialises a chunk from the chunk pool, without adding it to the grid. Returns NULL on failure
+		VEChunk*						CreateChunk( const DirectX::XMFLOAT3& aPosition, int aGridX, int aGridZ );
+
+		// Uninitialises a chunk created by CreateChunk and hands it back to the chunk pool
+		void							DestroyChunk( VEChunk* aChunk );
+
+		// Returns an uninitialised block of voxels for a chunk of the current dimensions
+		VEVoxel*						AllocateVoxels();
+
+		// Hands a chunk's voxels back to the voxel pool, optionally handing their memory back to the system until the
+		// block is used again
+		void							FreeVoxels( VEVoxel* someVoxels, bool aDecommit = false );
+
+		// Counts a compressed chunk being decompressed, which took the supplied time in performance counter ticks. Can
+		// be called from any thread
+		void							RecordDecompression( long long aTime );
+
+		// The number of chunks whose voxels are compressed, and the bytes they take
+		unsigned int					GetCompressedChunkCount();
+		unsigned long long				GetCompressedBytes();
+
+		// The number of chunks whose voxels are spilled to the world cache, and whose meshes are evicted
+		unsigned int					GetSpilledChunkCount();
+		unsigned int					GetEvictedMeshCount();
+
 
 		// ------------- Accessors --------------
 
@@ -50,26 +120,128 @@ class VEChunkManager
 
 		int								GetChunkDimensions()	{ return myChunkDimensions; }
 
+		VEPoolAllocator*				GetChunkPool()			{ return myChunkPool; }
+
+		VEPoolAllocator*				GetVoxelPool()			{ return myVoxelPool; }
+
+		VEMeshScratchPool*				GetMeshScratchPool()	{ return myMeshScratchPool; }
+
+		VEMeshCache*					GetMeshCache()			{ return myMeshCache; }
+
+		// The budgets for the chunks' memory, and what they're using
+		VEMemoryBudget&					GetMemoryBudget()		{ return myMemoryBudget; }
+
+		// Chunks within the view distance of the view position are visible, only chunks out of view have their data
+		// evicted. A view distance of zero makes every chunk visible
+		const DirectX::XMFLOAT3&		GetViewPosition()		{ return myViewPosition; }
+		void							SetViewPosition( const DirectX::XMFLOAT3& aPosition )	{ myViewPosition = aPosition; }
+
+		float							GetViewDistance()		{ return myViewDistance; }
+		void							SetViewDistance( float aDistance )	{ myViewDistance = aDistance; }
+
+		// Large pages are used by voxel pools created after this is set
+		bool							GetUseLargePages()		{ return myUseLargePages; }
+		void							SetUseLargePages( bool aUseLargePages )	{ myUseLargePages = aUseLargePages; }
+
+		// How long a chunk's voxels go untouched before they're compressed, in milliseconds. Zero stops chunks being
+		// compressed
+		unsigned int					GetCompressionDelay()	{ return myCompressionDelay; }
+		void							SetCompressionDelay( unsigned int aDelay )	{ myCompressionDelay = aDelay; }
+
+		// The chunks compressed, spilled & decompressed since the manager was created, and the total & longest time taken
+		// by the decompressions in performance counter ticks
+		unsigned int					GetCompressionCount()	{ return myCompressionCount; }
+		unsigned int					GetSpillCount()			{ return mySpillCount; }
+		unsigned int					GetDecompressionCount()	{ return myDecompressionCount; }
+		long long						GetDecompressionTime()	{ return myDecompressionTime; }
+		long long						GetMaxDecompressionTime()	{ return myMaxDecompressionTime; }
+
 
 	private :
 
 		// ---------- Private Functions ---------
+
+		// Enables chunks once their build thread has finished
+		static void						HandleChunkBuiltEvent( VEEvent* anEvent, LPVOID aParameter );
 		
+		// Flags the chunk at the supplied grid coordinates to be rebuilt, if there is one
+		void							MarkDirty( int aGridX, int aGridZ );
+
 		// Adds a chunk to the manager
 		VEChunk*						AddChunk( const DirectX::XMFLOAT3& aPosition, int aGridX, int aGridZ );
 			
 		// Removes a chunk from the manager
 		bool							RemoveChunk( int aChunkId );
 
+		// Queues the chunks that haven't been touched for the compression delay, once the compression thread has
+		// finished with the last ones
+		void							QueueCompression();
+
+		// Whether the chunk is within the view distance of the view position
+		bool							IsInView( VEChunk* aChunk );
+
+		// Stamps the chunks in view with the current time, restoring the meshes of any that were evicted
+		void							UpdateVisibility( unsigned int aCurrentTime );
+
+		// Measures the memory each budget's data takes, and evicts the least recently visible data of those over budget
+		void							UpdateBudgets( unsigned int aCurrentTime );
+
+		// Queues the voxels of the least recently visible chunks to be compressed, or spilled if they already are, once
+		// the compression thread has finished with the last ones
+		void							QueueVoxelEvictions( unsigned int aCurrentTime, unsigned long long aUsage );
+
+		// The compression thread, compresses & spills queued chunks until the manager is destroyed
+		static unsigned int				CompressionThread( void* aChunkManager );
+
 
 		// ---------- Private Variables ---------
 
+		typedef std::map<int, VEChunk*>	ChunkIdMap;
+
 		std::vector<VEChunk*>	myChunks;
 		int						myNextChunkId;
 
+		// The chunks in the grid by id, so built events find their chunk without walking the grid
+		ChunkIdMap				myChunkIds;
+
 		int						myChunkDimensions;
 		int						myGridWidth;
 		int						myGridDepth;
+
+		VEPoolAllocator*		myChunkPool;
+		VEPoolAllocator*		myVoxelPool;
+		VEMeshScratchPool*		myMeshScratchPool;
+		VEMeshCache*			myMeshCache;
+		bool					myUseLargePages;
+
+		VEMemoryBudget			myMemoryBudget;
+		DirectX::XMFLOAT3		myViewPosition;
+		float					myViewDistance;
+
+		// Kept between updates so choosing evictions doesn't allocate
+		std::vector<VEEvictionCandidate>	myEvictionCandidates;
+		std::vector<VEChunk*>				myEvictions;
+
+		// The manager's clock for stamping voxel accesses, in seconds
+		double					myAccessTime;
+		double					myLastCompressionTime;
+		unsigned int			myCompressionDelay;
+
+		// Everything below is guarded by the compression lock
+		VEMutex					myCompressionLock;
+		VEConditionVariable		myCompressionCondition;
+		VEConditionVariable		myCompressedCondition;
+		VEThread				myCompressionThread;
+		bool					myIsStopping;
+		std::vector<VEChunk*>	myCompressionQueue;
+		std::vector<VEChunk*>	myEvictionQueue;
+		VEChunk*				myCompressingChunk;
+
+		unsigned int			myCompressionCount;
+		unsigned int			mySpillCount;
+		unsigned int			myDecompressionCount;
+		long long				myDecompressionTime;
+		long long				myMaxDecompressionTime;
 };
 
 
@@ -0,0 +1,212 @@
+// ----------------------- Includes -----------------------
+
+#include "Stdafx.h"
+#include "VEChunkSnapshot.h"
+
+#include "VEChunk.h"
+#include "VEVoxel.h"
+#include "VEProfiler.h"
+
+
+// ---------------------- Namespaces ----------------------
+
+using namespace DirectX;
+
+
+// -------------------- Class Functions -------------------
+
+// Construction
+VEChunkSnapshot::VEChunkSnapshot() :
+	myDimensions( 0 ),
+	myPaddedDimensions( 0 ),
+	myVoxelSize( 1.0f )
+{
+}
+
+
+// Copies the chunk's voxels, and the faces of its neighbours that touch it
+void VEChunkSnapshot::Capture( VEChunk* aChunk, VEChunk* someNeighbours[CN_Max] )
+{
+	VE_PROFILE_ZONE( "VEChunkSnapshot::Capture" );
+
+	assert( aChunk != NULL );
+
+	myDimensions		= aChunk->GetDimensions();
+	myPaddedDimensions	= myDimensions + 2;
+	myVoxelSize			= aChunk->GetVoxelSize();
+
+	// Anything outside the chunk that isn't copied below (the halo above & below the chunk, missing neighbours)
+	// counts as empty. The vectors keep their capacity, so recycled snapshots don't allocate
+	mySolid.assign( myPaddedDimensions * myPaddedDimensions * myPaddedDimensions, 0 );
+	myVisibility.resize( myDimensions * myDimensions * myDimensions );
+
+	// Copy the chunk a row at a time, rows are contiguous in both the voxel block & the padded array. Each chunk is
+	// only locked for reading while it's copied, so snapshots never block each other
+	{
+		VEScopedSharedLock voxelLock( aChunk->GetVoxelLock() );
+
+		VEVoxel* voxels = aChunk->GetVoxels();
+		for( int x = 0; x < myDimensions; x++ )
+		{
+			for( int y = 0; y < myDimensions; y++ )
+			{
+				VEVoxel*		row		= &voxels[aChunk->GetVoxelIndex(x, y, 0)];
+				unsigned char*	solid	= &mySolid[GetPaddedIndex(x, y, 0)];
+
+				for( int z = 0; z < myDimensions; z++ )
+				{
+					solid[z] = row[z].GetEnabled() ? 1 : 0;
+				}
+			}
+		}
+	}
+
+	for( int side = 0; side < CN_Max; side++ )
+	{
+		if( someNeighbours[side] != NULL )
+		{
+			CaptureHalo( someNeighbours[side], (ChunkNeighbour)side );
+		}
+	}
+}
+
+
+// Sets the visibility of every voxel from the solid voxels around it, including the halo
+void VEChunkSnapshot::CalculateVisibility()
+{
+	VE_PROFILE_ZONE( "VEChunkSnapshot::CalculateVisibility" );
+
+	assert( !mySolid.empty() );
+
+	const unsigned char*	solid		= &mySolid[0];
+	unsigned char*			visibility	= &myVisibility[0];
+
+	// The offsets of a voxel's neighbours in the padded array, the halo means they never need bounds checks
+	const int xStride = myPaddedDimensions * myPaddedDimensions;
+	const int yStride = myPaddedDimensions;
+
+	for( int x = 0; x < myDimensions; x++ )
+	{
+		for( int y = 0; y < myDimensions; y++ )
+		{
+			int index = GetPaddedIndex( x, y, 0 );
+			for( int z = 0; z < myDimensions; z++, index++ )
+			{
+				if( solid[index] == 0 )
+				{
+					*visibility++ = VV_None;
+					continue;
+				}
+
+				DWORD hidden =	( solid[index - xStride] * VV_Left )	| ( solid[index + xStride] * VV_Right ) |
+								( solid[index - yStride] * VV_Bottom )	| ( solid[index + yStride] * VV_Top ) |
+								( solid[index - 1] * VV_Front )			| ( solid[index + 1] * VV_Back );
+
+				*visibility++ = (unsigned char)( VV_All & ~hidden );
+			}
+		}
+	}
+}
+
+
+// Hashes the solid voxels, halo included, with the chunk's dimensions & voxel size. The mesh is built from nothing
+// else, so snapshots with the same hash have the same mesh. The solid array is mixed in eight bytes at a time, in to
+// both the hash and the check hash
+unsigned long long VEChunkSnapshot::CalculateHash( unsigned long long& aCheckHash ) const
+{
+	VE_PROFILE_ZONE( "VEChunkSnapshot::CalculateHash" );
+
+	unsigned int voxelSizeBits;
+	memcpy( &voxelSizeBits, &myVoxelSize, sizeof(voxelSizeBits) );
+
+	unsigned long long hash = 14695981039346656037ull;
+	hash = MixHash( hash, (unsigned long long)myDimensions );
+	hash = MixHash( hash, (unsigned long long)voxelSizeBits );
+
+	unsigned long long checkHash = 0x84222325cbf29ce4ull;
+	checkHash = MixCheckHash( checkHash, (unsigned long long)myDimensions );
+	checkHash = MixCheckHash( checkHash, (unsigned long long)voxelSizeBits );
+
+	const unsigned char*	solid	= mySolid.empty() ? NULL : &mySolid[0];
+	size_t					size	= mySolid.size();
+
+	size_t i = 0;
+	for( ; i + sizeof(unsigned long long) <= size; i += sizeof(unsigned long long) )
+	{
+		unsigned long long word;
+		memcpy( &word, solid + i, sizeof(word) );
+
+		hash		= MixHash( hash, word );
+		checkHash	= MixCheckHash( checkHash, word );
+	}
+
+	for( ; i < size; i++ )
+	{
+		hash		= MixHash( hash, solid[i] );
+		checkHash	= MixCheckHash( checkHash, solid[i] );
+	}
+
+	aCheckHash = checkHash;
+
+	return hash;
+}
+
+
+// Copies a plane of the neighbour's voxels (at a fixed x or z) in to a plane of the halo
+void VEChunkSnapshot::CaptureHalo( VEChunk* aNeighbour, ChunkNeighbour aSide )
+{
+	assert( aNeighbour->GetDimensions() == myDimensions );
+
+	VEScopedSharedLock voxelLock( aNeighbour->GetVoxelLock() );
+
+	VEVoxel* voxels = aNeighbour->GetVoxels();
+	if( voxels == NULL )
+	{
+		return;
+	}
+
+	int lastVoxel = myDimensions - 1;
+
+	switch( aSide )
+	{
+		// The neighbour's plane at a fixed x is a single contiguous block, so the rows are copied straight across
+		case CN_Left :
+		case CN_Right :
+		{
+			int sourceX	= aSide == CN_Left ? lastVoxel : 0;
+			int haloX	= aSide == CN_Left ? -1 : myDimensions;
+
+			for( int y = 0; y < myDimensions; y++ )
+			{
+				VEVoxel*		row		= &voxels[aNeighbour->GetVoxelIndex(sourceX, y, 0)];
+				unsigned char*	solid	= &mySolid[GetPaddedIndex(haloX, y, 0)];
+
+				for( int z = 0; z < myDimensions; z++ )
+				{
+					solid[z] = row[z].GetEnabled() ? 1 : 0;
+				}
+			}
+			break;
+		}
+
+		// A plane at a fixed z takes one voxel from each row
+		case CN_Front :
+		case CN_Back :
+		{
+			int sourceZ	= aSide == CN_Front ? lastVoxel : 0;
+			int haloZ	= aSide == CN_Front ? -1 : myDimensions;
+
+			for( int x = 0; x < myDimensions; x++ )
+			{
+				for( int y = 0; y < myDimensions; y++ )
+				{
+					mySolid[GetPaddedIndex(x, y, haloZ)] = voxels[aNeighbour->GetVoxelIndex(x, y, sourceZ)].GetEnabled() ? 1 : 0;
+				}
+			}
+			break;
+		}
+
+		default :
+			break;
+	}
+}
@@ -0,0 +1,97 @@
+#ifndef VE_CHUNK_SNAPSHOT_H
+#define VE_CHUNK_SNAPSHOT_H
+
+
+// ----------------------- Includes -----------------------
+
+#include "VETypes.h"
+
+
+// ------------------ Forward Declarations ----------------
+
+class VEChunk;
+
+
+// ------------------------ Enums -------------------------
+
+// The chunks next to a chunk in the chunk grid. Chunks only neighbour each other along x & z
+enum ChunkNeighbour
+{
+	CN_Left = 0,
+	CN_Right,
+	CN_Front,
+	CN_Back,
+
+	CN_Max
+};
+
+
+// ----------------------- Classes ------------------------
+
+// A copy of which voxels in a chunk are solid, padded with a one voxel halo taken from the neighbouring chunks.
+// It's captured on the main thread before a chunk is rebuilt, after which visibility and meshing only read the
+// snapshot; the build threads never touch the chunk manager, the chunk's voxels or its neighbours
+class VEChunkSnapshot
+{
+	public :
+
+		// ------- Public Functions -------
+
+		// Construction
+		VEChunkSnapshot();
+
+		// Copies the chunk's voxels, and the faces of its neighbours that touch it. Neighbours can be NULL, in which
+		// case that side of the halo is empty
+		void						Capture( VEChunk* aChunk, VEChunk* someNeighbours[CN_Max] );
+
+		// Sets the visibility of every voxel from the solid voxels around it, including the halo
+		void						CalculateVisibility();
+
+		// Returns a hash of the solid voxels & halo, snapshots with the same hash build the same mesh. A second, independent
+		// hash of the same contents is returned through aCheckHash, so two snapshots whose hashes collide can still be told
+		// apart
+		unsigned long long			CalculateHash( unsigned long long& aCheckHash ) const;
+
+
+		// ---------- Accessors -----------
+
+		int							GetDimensions() const				{ return myDimensions; }
+
+		float						GetVoxelSize() const				{ return myVoxelSize; }
+
+		// The visibility of each of the chunk's voxels, laid out like the chunk's voxel block (see VEChunk::GetVoxelIndex)
+		const unsigned char*		GetVisibility() const				{ return myVisibility.empty() ? NULL : &myVisibility[0]; }
+
+		// The bytes the snapshot's arrays have reserved
+		size_t						GetMemorySize() const				{ return mySolid.capacity() + myVisibility.capacity(); }
+
+		// Returns the index of a voxel in the padded solid array, the halo is at -1 & the chunk's dimensions
+		int							GetPaddedIndex( int anX, int aY, int aZ ) const		{ return ((anX + 1) * myPaddedDimensions + (aY + 1)) * myPaddedDimensions + (aZ + 1); }
+
+
+	private :
+
+		// ------- Private Functions ------
+
+		// Copies a plane of the neighbour's voxels (at a fixed x or z) in to a plane of the halo
+		void						CaptureHalo( VEChunk* aNeighbour, ChunkNeighbour aSide );
+
+		// Mixes eight bytes in to a hash, the multiply & shift spread the value's bits across the whole hash
+		static unsigned long long	MixHash( unsigned long long aHash, unsigned long long aValue )	{ aHash ^= aValue; aHash *= 0xff51afd7ed558ccdull; return aHash ^ (aHash >> 33); }
+
+		// Mixes eight bytes in to the check hash, with a different multiplier & shift so it doesn't collide with MixHash
+		static unsigned long long	MixCheckHash( unsigned long long aHash, unsigned long long aValue )	{ aHash += aValue; aHash *= 0x9e3779b97f4a7c15ull; return aHash ^ (aHash >> 29); }
+
+
+		// ------- Private Variables ------
+
+		int							myDimensions;
+		int							myPaddedDimensions;
+		float						myVoxelSize;
+
+		std::vector<unsigned char>	mySolid;
+		std::vector<unsigned char>	myVisibility;
+};
+
+
+#endif // !VE_CHUNK_SNAPSHOT_H
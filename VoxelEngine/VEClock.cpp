@@ -0,0 +1,118 @@
+// --------------------- Includes ---------------------
+
+#include "Stdafx.h"
+#include "VEClock.h"
+
+#include <mmsystem.h>
+
+
+// --------------------- Defines ----------------------
+
+// Not defined by older SDKs. Creating a timer with the flag fails before Windows 10 1803
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+	#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION	0x00000002
+#endif
+
+// How late each kind of wait can wake up: a high resolution timer, Sleep with the system timer's period raised to
+// VE_TIMER_PERIOD milliseconds, and a standard timer at the default period
+#define VE_HIGH_RESOLUTION_WAIT_PRECISION		0.001
+#define VE_TIMER_PERIOD_WAIT_PRECISION			0.002
+#define VE_STANDARD_WAIT_PRECISION				0.016
+
+#define VE_TIMER_PERIOD							1
+
+
+// ------------------ Class Functions -----------------
+
+// Construction, creates the timer used to wait
+VESystemClock::VESystemClock() :
+	myTimer( NULL ),
+	myIsTimerPeriodRaised( false ),
+	myWaitPrecision( VE_HIGH_RESOLUTION_WAIT_PRECISION ),
+	myTimerFrequency( 1.0 )
+{
+	LARGE_INTEGER frequency;
+	if( QueryPerformanceFrequency(&frequency) )
+	{
+		myTimerFrequency = (double)frequency.QuadPart;
+	}
+
+	myTimer = CreateWaitableTimerEx( NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS );
+	if( myTimer != NULL )
+	{
+		return;
+	}
+
+	// Without a high resolution timer a wait can be a whole scheduler tick late, long enough that WaitUntil would spin
+	// for most of the frame. Raising the system timer's period lets Sleep wake within a couple of milliseconds instead
+	if( timeBeginPeriod(VE_TIMER_PERIOD) == TIMERR_NOERROR )
+	{
+		myIsTimerPeriodRaised	= true;
+		myWaitPrecision			= VE_TIMER_PERIOD_WAIT_PRECISION;
+	}
+	else
+	{
+		myTimer			= CreateWaitableTimer( NULL, TRUE, NULL );
+		myWaitPrecision	= VE_STANDARD_WAIT_PRECISION;
+	}
+}
+
+
+// Deconstruction
+VESystemClock::~VESystemClock()
+{
+	if( myTimer != NULL )
+	{
+		CloseHandle( myTimer );
+		myTimer = NULL;
+	}
+
+	if( myIsTimerPeriodRaised )
+	{
+		timeEndPeriod( VE_TIMER_PERIOD );
+		myIsTimerPeriodRaised = false;
+	}
+}
+
+
+// The performance counter, in seconds
+double VESystemClock::GetTime()
+{
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter( &counter );
+
+	return (double)counter.QuadPart / myTimerFrequency;
+}
+
+
+// Waits on the timer
+void VESystemClock::Wait( double aSeconds )
+{
+	if( aSeconds <= 0.0 )
+	{
+		return;
+	}
+
+	// Sleep only takes whole milliseconds, so a wait can wake up to a millisecond early for WaitUntil to spin out
+	if( myTimer == NULL )
+	{
+		Sleep( (DWORD)(aSeconds * 1000.0) );
+		return;
+	}
+
+	// Negative due times are relative, in 100 nanosecond units
+	LARGE_INTEGER dueTime;
+	dueTime.QuadPart = -(LONGLONG)( aSeconds * 10000000.0 );
+
+	if( SetWaitableTimer(myTimer, &dueTime, 0, NULL, NULL, FALSE) )
+	{
+		WaitForSingleObject( myTimer, INFINITE );
+	}
+}
+
+
+// Tells the CPU the thread is spinning
+void VESystemClock::Pause()
+{
+	YieldProcessor();
+}
@@ -0,0 +1,135 @@
+#ifndef VE_CLOCK_H
+#define VE_CLOCK_H
+
+
+// --------------------- Includes --------------------
+
+#include "VETypes.h"
+
+
+// --------------------- Classes ---------------------
+
+// A source of time that can also wait. Code that paces itself reads the time & waits through a clock rather than the
+// platform's API, so it can run against a manual clock in checks & replays, and porting only means porting
+// VESystemClock. Times are in seconds
+class VEClock
+{
+	public :
+
+		// ------ Public Functions ------
+
+		// Deconstruction
+		virtual ~VEClock()										{}
+
+		// The current time, from an arbitrary starting point
+		virtual double			GetTime() = 0;
+
+		// Blocks the calling thread for roughly the supplied time, without using the CPU. May wake up to
+		// GetWaitPrecision late
+		virtual void			Wait( double aSeconds ) = 0;
+
+		// A short pause for busy waits, far shorter than the wait precision
+		virtual void			Pause() = 0;
+
+		// How late Wait can wake up
+		virtual double			GetWaitPrecision() = 0;
+};
+
+
+// The real time, from the performance counter. Waits use a high resolution waitable timer where the OS has one,
+// otherwise Sleep with the system timer's period raised to a millisecond for as long as the clock exists. Only if the
+// period can't be raised do they fall back to a standard waitable timer, which can wake up a scheduler tick late
+class VESystemClock : public VEClock
+{
+	public :
+
+		// ------ Public Functions ------
+
+		// Construction, creates the timer used to wait
+		VESystemClock();
+
+		// Deconstruction
+		virtual ~VESystemClock();
+
+		// The performance counter, in seconds
+		virtual double			GetTime() override;
+
+		// Waits on the timer
+		virtual void			Wait( double aSeconds ) override;
+
+		// Tells the CPU the thread is spinning
+		virtual void			Pause() override;
+
+		// How late the timer can fire
+		virtual double			GetWaitPrecision() override			{ return myWaitPrecision; }
+
+
+	private :
+
+		// Clocks can't be copied
+		VESystemClock( const VESystemClock& );
+		VESystemClock& operator=( const VESystemClock& );
+
+		HANDLE					myTimer;
+		bool					myIsTimerPeriodRaised;
+		double					myWaitPrecision;
+		double					myTimerFrequency;
+};
+
+
+// A clock that only moves when it's told to. Waiting advances it by the time waited plus a configurable oversleep,
+// and pausing by a configurable tick, so anything paced by it runs deterministically & instantly
+class VEManualClock : public VEClock
+{
+	public :
+
+		// ------ Public Functions ------
+
+		// Construction
+		VEManualClock( double aWaitPrecision = 0.001, double aPauseTime = 0.00001 ) :
+			myTime( 0.0 ),
+			myWaitPrecision( aWaitPrecision ),
+			myPauseTime( aPauseTime ),
+			myOversleep( 0.0 ),
+			myWaitedTime( 0.0 ),
+			myPausedTime( 0.0 )
+		{
+		}
+
+		// Moves the clock on
+		void					Advance( double aSeconds )			{ myTime += aSeconds; }
+
+		virtual double			GetTime() override					{ return myTime; }
+
+		// Advances the clock by the time waited plus the oversleep
+		virtual void			Wait( double aSeconds ) override	{ myTime += aSeconds + myOversleep; myWaitedTime += aSeconds + myOversleep; }
+
+		// Advances the clock by the pause time
+		virtual void			Pause() override					{ myTime += myPauseTime; myPausedTime += myPauseTime; }
+
+		virtual double			GetWaitPrecision() override			{ return myWaitPrecision; }
+
+
+		// --------- Accessors ----------
+
+		// How late every wait wakes up, should be no more than the wait precision
+		void					SetOversleep( double aSeconds )		{ myOversleep = aSeconds; }
+
+		// The total time spent waiting & pausing, waiting stands in for idle time and pausing for busy time
+		double					GetWaitedTime()						{ return myWaitedTime; }
+		double					GetPausedTime()						{ return myPausedTime; }
+
+
+	private :
+
+		double					myTime;
+		double					myWaitPrecision;
+		double					myPauseTime;
+		double					myOversleep;
+
+		double					myWaitedTime;
+		double					myPausedTime;
+};
+
+
+#endif // !VE_CLOCK_H
@@ -14,10 +14,13 @@ class VEComponentMessage
 		// Construction
 		VEComponentMessage( unsigned int aMesageType );
 
+		// Deconstruction. Messages are destroyed in place when they leave a component's message queue
+		virtual ~VEComponentMessage()		{}
+
 
 		// -------- Accessors ---------
 
-		unsigned	int		GetType()	{ return myType; }
+		unsigned	int		GetType() const	{ return myType; }
 
 		virtual		bool	IsValid()	{ return true; }
 
@@ -0,0 +1,63 @@
+// --------------------- Includes ---------------------
+
+#include "Stdafx.h"
+#include "VEComponentService.h"
+
+#include "VEProfiler.h"
+
+
+// ----------------- Class Functions ------------------
+
+// Construction
+VEComponentService::VEComponentService()
+{
+}
+
+
+// Deconstruction
+VEComponentService::~VEComponentService()
+{
+	for( unsigned int i = 0; i < mySystems.size(); i++ )
+	{
+		delete mySystems[i];
+		mySystems[i] = NULL;
+	}
+
+	mySystems.clear();
+}
+
+
+// Returns the system registered for a component type, or NULL if there isn't one
+VEComponentSystemBase* VEComponentService::GetSystem( unsigned int aComponentType )
+{
+	// There are only ever a handful of systems, so a linear search beats a map here
+	for( unsigned int i = 0; i < mySystems.size(); i++ )
+	{
+		if( mySystems[i]->GetComponentType() == aComponentType )
+		{
+			return mySystems[i];
+		}
+	}
+
+	return NULL;
+}
+
+
+// Updates every registered system, in the order they were registered
+void VEComponentService::Update( float anElapsedTime )
+{
+	VE_PROFILE_ZONE( "VEComponentService::Update" );
+
+	for( unsigned int i = 0; i < mySystems.size(); i++ )
+	{
+		mySystems[i]->Update( anElapsedTime );
+	}
+}
+
+
+// Adds a newly created system to the service
+void VEComponentService::AddSystem( VEComponentSystemBase* aSystem )
+{
+	assert( aSystem != NULL );
+	mySystems.push_back( aSystem );
+}
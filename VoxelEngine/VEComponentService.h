@@ -0,0 +1,82 @@
+#ifndef VE_COMPONENT_SERVICE_H
+#define VE_COMPONENT_SERVICE_H
+
+// --------------------- Includes --------------------
+
+#include "VETypes.h"
+#include "VEComponentSystem.h"
+
+
+// --------------------- Classes ---------------------
+
+// Owns the engine's component systems. Component types are opted in to system-based storage by registering a
+// system for them, after which components of that type should be created through the service rather than with
+// new. Objects still hold system-owned components in their component maps (so AddComponent & GetComponent work
+// as before), but skip them when updating; the service updates each system in one pass before the objects
+class VEComponentService
+{
+	public :
+
+		// ------ Public Functions ------
+
+		// Construction
+		VEComponentService();
+
+		// Deconstruction
+		~VEComponentService();
+
+		// Creates the system for a component type, or returns the existing one
+		template <typename T>
+		VEComponentSystem<T>*	RegisterSystem( unsigned int aComponentType, bool anUpdateInParallel = false )
+		{
+			if( VEComponentSystemBase* existingSystem = GetSystem(aComponentType) )
+			{
+				return static_cast<VEComponentSystem<T>*>( existingSystem );
+			}
+
+			VEComponentSystem<T>* newSystem = new VEComponentSystem<T>( aComponentType, anUpdateInParallel );
+			AddSystem( newSystem );
+
+			return newSystem;
+		}
+
+		// Creates a component in its type's system. Returns NULL if no system has been registered for the type
+		template <typename T>
+		T*						CreateComponent( unsigned int aComponentType, VEObject* aParent )
+		{
+			VEComponentSystemBase* system = GetSystem( aComponentType );
+			if( system == NULL )
+			{
+				return NULL;
+			}
+
+			return static_cast<VEComponentSystem<T>*>( system )->CreateComponent( aParent );
+		}
+
+		// Returns the system registered for a component type, or NULL if there isn't one
+		VEComponentSystemBase*	GetSystem( unsigned int aComponentType );
+
+		// Updates every registered system, in the order they were registered
+		void					Update( float anElapsedTime );
+
+
+		// --------- Accessors ----------
+
+		unsigned int			GetSystemCount()		{ return mySystems.size(); }
+
+
+	private :
+
+		// ------ Private Functions ------
+
+		// Adds a newly created system to the service
+		void					AddSystem( VEComponentSystemBase* aSystem );
+
+
+		// ------ Private Variables ------
+
+		std::vector<VEComponentSystemBase*>	mySystems;
+};
+
+
+#endif // !VE_COMPONENT_SERVICE_H
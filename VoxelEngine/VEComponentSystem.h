@@ -0,0 +1,217 @@
+#ifndef VE_COMPONENT_SYSTEM_H
+#define VE_COMPONENT_SYSTEM_H
+
+
+// --------------------- Includes --------------------
+
+#include "VEObjectComponent.h"
+
+#include <ppl.h>
+
+
+// --------------------- Defines ---------------------
+
+// The number of components stored contiguously in each block of a component system
+#define VE_COMPONENT_BLOCK_SIZE		256
+
+// The minimum number of components handed to each worker when a system updates in parallel
+#define VE_COMPONENT_PARALLEL_BATCH	1024
+
+
+// --------------------- Classes ---------------------
+
+// The type-independent part of a component system, used by the component store to update and
+// destroy components without knowing their concrete type
+class VEComponentSystemBase
+{
+	public :
+
+		// ------ Public Functions ------
+
+		// Construction
+		VEComponentSystemBase( unsigned int aComponentType, bool anUpdateInParallel ) :
+			myComponentType( aComponentType ),
+			myUpdateInParallel( anUpdateInParallel )
+		{
+		}
+
+		// Deconstruction
+		virtual ~VEComponentSystemBase()										{}
+
+
+		// ----- Required Functions -----
+
+		// Updates every component owned by the system
+		virtual void	Update( float anElapsedTime ) = 0;
+
+		// Destroys a component created by the system, returning its memory to the system's blocks
+		virtual void	DestroyComponent( VEObjectComponent* aComponent ) = 0;
+
+		// The number of live components owned by the system
+		virtual unsigned int GetComponentCount() = 0;
+
+
+		// --------- Accessors ----------
+
+		unsigned int	GetComponentType()										{ return myComponentType; }
+
+		// Only enable parallel updates for components whose Update touches nothing but their own data
+		bool			GetUpdateInParallel()									{ return myUpdateInParallel; }
+		void			SetUpdateInParallel( bool anUpdateInParallel )			{ myUpdateInParallel = anUpdateInParallel; }
+
+
+	protected :
+
+		// ----- Protected Variables -----
+
+		unsigned int	myComponentType;
+		bool			myUpdateInParallel;
+};
+
+
+// A data-oriented home for all components of a single type. Components are constructed in place inside large
+// blocks, so components of one type sit next to each other in memory rather than being scattered around the
+// heap. Their addresses never change (message targets and objects hold pointers to them), and a dense array of
+// the live components is walked once per frame, calling T::Update directly rather than through the vtable
+template <typename T>
+class VEComponentSystem : public VEComponentSystemBase
+{
+	public :
+
+		// ------ Public Functions ------
+
+		// Construction
+		VEComponentSystem( unsigned int aComponentType, bool anUpdateInParallel = false ) :
+			VEComponentSystemBase( aComponentType, anUpdateInParallel )
+		{
+		}
+
+		// Deconstruction. All components should have been destroyed by their parent objects by now
+		virtual ~VEComponentSystem()
+		{
+			assert( myComponents.empty() );
+
+			for( unsigned int i = 0; i < myComponents.size(); i++ )
+			{
+				myComponents[i]->~T();
+			}
+			myComponents.clear();
+
+			for( unsigned int i = 0; i < myBlocks.size(); i++ )
+			{
+				_aligned_free( myBlocks[i] );
+				myBlocks[i] = NULL;
+			}
+			myBlocks.clear();
+			myFreeComponents.clear();
+		}
+
+		// Constructs a new component in the system's storage. The component still needs to be initialised and
+		// added to its parent object in the usual way
+		T* CreateComponent( VEObject* aParent )
+		{
+			if( myFreeComponents.empty() )
+			{
+				AllocateBlock();
+			}
+
+			void* memory = myFreeComponents.back();
+			myFreeComponents.pop_back();
+
+			T* newComponent = new (memory) T( aParent );
+			newComponent->SetSystem( this, myComponents.size() );
+			myComponents.push_back( newComponent );
+
+			return newComponent;
+		}
+
+		// Destroys a component created by the system, returning its memory to the system's blocks
+		virtual void DestroyComponent( VEObjectComponent* aComponent ) override
+		{
+			assert( aComponent != NULL && aComponent->GetSystem() == this );
+
+			// Swap the last component in to the destroyed component's place, keeping the array dense
+			unsigned int index	= aComponent->GetSystemIndex();
+			T* lastComponent	= myComponents.back();
+
+			myComponents[index] = lastComponent;
+			lastComponent->SetSystem( this, index );
+			myComponents.pop_back();
+
+			T* component = static_cast<T*>( aComponent );
+			component->~T();
+
+			myFreeComponents.push_back( component );
+		}
+
+		// Updates every component owned by the system
+		virtual void Update( float anElapsedTime ) override
+		{
+			unsigned int componentCount = myComponents.size();
+			if( !myUpdateInParallel || componentCount < VE_COMPONENT_PARALLEL_BATCH * 2 )
+			{
+				UpdateRange( 0, componentCount, anElapsedTime );
+				return;
+			}
+
+			// Hand out batches of components to the worker threads
+			unsigned int batchCount = (componentCount + VE_COMPONENT_PARALLEL_BATCH - 1) / VE_COMPONENT_PARALLEL_BATCH;
+			Concurrency::parallel_for( 0u, batchCount, [this, componentCount, anElapsedTime]( unsigned int aBatch )
+			{
+				unsigned int start	= aBatch * VE_COMPONENT_PARALLEL_BATCH;
+				unsigned int end	= start + VE_COMPONENT_PARALLEL_BATCH;
+
+				UpdateRange( start, end < componentCount ? end : componentCount, anElapsedTime );
+			});
+		}
+
+
+		// --------- Accessors ----------
+
+		virtual unsigned int	GetComponentCount() override	{ return myComponents.size(); }
+
+		T*						GetComponent( unsigned int anIndex )	{ return myComponents[anIndex]; }
+
+
+	private :
+
+		// ------ Private Functions -----
+
+		// Updates the enabled components in the supplied range of the dense array
+		void UpdateRange( unsigned int aStart, unsigned int anEnd, float anElapsedTime )
+		{
+			for( unsigned int i = aStart; i < anEnd; i++ )
+			{
+				T* component = myComponents[i];
+				if( component->GetEnabled() )
+				{
+					component->T::Update( anElapsedTime );
+				}
+			}
+		}
+
+		// Allocates a new block of components, adding its slots to the free list
+		void AllocateBlock()
+		{
+			unsigned char* block = (unsigned char*)_aligned_malloc( sizeof(T) * VE_COMPONENT_BLOCK_SIZE, 16 );
+			assert( block != NULL );
+
+			myBlocks.push_back( block );
+
+			// Push the slots in reverse so components are handed out in address order
+			for( int i = VE_COMPONENT_BLOCK_SIZE - 1; i >= 0; i-- )
+			{
+				myFreeComponents.push_back( block + (i * sizeof(T)) );
+			}
+		}
+
+
+		// ------ Private Variables -----
+
+		std::vector<T*>				myComponents;
+		std::vector<void*>			myFreeComponents;
+		std::vector<unsigned char*>	myBlocks;
+};
+
+
+#endif // !VE_COMPONENT_SYSTEM_H
\ No newline at end of file
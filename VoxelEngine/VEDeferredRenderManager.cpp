@@ -19,6 +19,7 @@
 #include "VESpotLight.h"
 #include "VESphere.h"
 #include "VEShader.h"
+#include "VEProfiler.h"
 
 #include "ScreenGrab.h"
 #include "DDSTextureLoader.h"
@@ -33,6 +34,25 @@ using namespace DirectX;
 
 #define RENDER_TARGET_COUNT 3
 
+// The SSAO pass's random normals
+#define RANDOM_NORMALS_TEXTURE	L"RandomNormals.dds"
+
+
+// ------------------------ Statics -------------------------
+
+// The shaders the deferred renderer loads, together so the ones missing from the shader cache are compiled in parallel
+static const VEShaderType ourDeferredShaders[] =
+{
+	VST_ClearGBuffer,
+	VST_RenderGBuffer,
+	VST_DirectionalLight,
+	VST_PointLight,
+	VST_SpotLight,
+	VST_ShadowMap,
+	VST_FinalBlend,
+	VST_SSAO
+};
+
 
 // --------------------- Class Functions --------------------
 
@@ -49,6 +69,7 @@ VEDeferredRenderManager::VEDeferredRenderManager() :
 	myShadowDepthTarget( NULL ),
 	myQuadRenderer( NULL ),
 	mySphere( NULL ),
+	myRenderState( NULL ),
 	myRandomNormalsTextureId( -1 )
 {
 }
@@ -104,7 +125,7 @@ bool VEDeferredRenderManager::Initialise( int aScreenWidth, int aScreenHeight )
 	// Load the SSAO random normal texture
 	VETextureManager* textureManager = VoxelEngine::GetInstance()->GetTextureManager();
 	assert( textureManager != NULL );
-	myRandomNormalsTextureId = textureManager->LoadTexture( L"RandomNormals.dds" );
+	myRandomNormalsTextureId = textureManager->LoadTexture( RANDOM_NORMALS_TEXTURE );
 	if( myRandomNormalsTextureId == -1 )
 	{
 		return false;
@@ -114,6 +135,14 @@ bool VEDeferredRenderManager::Initialise( int aScreenWidth, int aScreenHeight )
 }
 
 
+// Adds the deferred shaders & the SSAO random normals texture
+void VEDeferredRenderManager::GetResources( std::vector<VEShaderType>& someShaderTypes, std::vector<std::wstring>& someTextureFiles )
+{
+	someShaderTypes.insert( someShaderTypes.end(), ourDeferredShaders, ourDeferredShaders + ARRAYSIZE(ourDeferredShaders) );
+	someTextureFiles.push_back( RANDOM_NORMALS_TEXTURE );
+}
+
+
 // Cleans up the memory used by the deferred renderer
 void VEDeferredRenderManager::Uninitialise()
 {
@@ -182,20 +211,22 @@ void VEDeferredRenderManager::Uninitialise()
 
 
 // Uses deferred rendering to draw the scene
-void VEDeferredRenderManager::RenderScene()
+void VEDeferredRenderManager::RenderScene( VERenderState& aRenderState )
 {
+	VE_PROFILE_ZONE( "VEDeferredRenderManager::RenderScene" );
+
 	VEDirectXInterface* renderInterface = VoxelEngine::GetInstance()->GetRenderInterface();
 	assert( renderInterface != NULL );
 
-	VEBasicCamera* camera = VoxelEngine::GetInstance()->GetCamera();
+	VEBasicCamera* camera = aRenderState.GetCamera();
 	assert( camera != NULL );
 
-	VELightingManager* lightingManager = VoxelEngine::GetInstance()->GetLightingManager();
-	assert( lightingManager != NULL );
-
 	VEShaderManager* shaderManager = VoxelEngine::GetInstance()->GetShaderManager();
 	assert( shaderManager != NULL );
 
+	// The g-buffer, shadow & lighting passes all draw from the same state
+	myRenderState = &aRenderState;
+
 
 	// ------- g-buffer -------
 
@@ -219,13 +250,13 @@ void VEDeferredRenderManager::RenderScene()
 	// ------- lighting ---------
 
 	// Render directional lights to the lighting buffer
-	RenderDirectionalLights( renderInterface, camera, lightingManager, renderTargets, shaderManager );
+	RenderDirectionalLights( renderInterface, camera, renderTargets, shaderManager );
 
 	// Render point lights to the lighting buffer
-	RenderPointLights( renderInterface, camera, lightingManager, shaderManager );
+	RenderPointLights( renderInterface, camera, shaderManager );
 
 	// Render spot lights to the lighting buffer
-	RenderSpotLights( renderInterface, camera, lightingManager, renderTargets, shaderManager );
+	RenderSpotLights( renderInterface, camera, renderTargets, shaderManager );
 
 
 	// --------- final --------
@@ -246,6 +277,8 @@ void VEDeferredRenderManager::RenderScene()
 
 	// Display the back buffer
 	renderInterface->PresentBuffer();
+
+	myRenderState = NULL;
 }
 
 
@@ -255,47 +288,7 @@ bool VEDeferredRenderManager::InitialiseShaders()
 	VEShaderManager* shaderManager = VoxelEngine::GetInstance()->GetShaderManager();
 	assert( shaderManager != NULL );
 
-	if( !shaderManager->LoadShader(VST_ClearGBuffer) )
-	{
-		return false;
-	}
-
-	if( !shaderManager->LoadShader(VST_RenderGBuffer) )
-	{
-		return false;
-	}
-
-	if( !shaderManager->LoadShader(VST_DirectionalLight) )
-	{
-		return false;
-	}
-
-	if( !shaderManager->LoadShader(VST_PointLight) )
-	{
-		return false;
-	}
-
-	if( !shaderManager->LoadShader(VST_SpotLight) )
-	{
-		return false;
-	}
-
-	if( !shaderManager->LoadShader(VST_ShadowMap) )
-	{
-		return false;
-	}
-
-	if( !shaderManager->LoadShader(VST_FinalBlend) )
-	{
-		return false;
-	}
-
-	if( !shaderManager->LoadShader(VST_SSAO) )
-	{
-		return false;
-	}
-
-	return true;
+	return shaderManager->LoadShaders( ourDeferredShaders, ARRAYSIZE(ourDeferredShaders) );
 }
 
 
@@ -377,28 +370,26 @@ void VEDeferredRenderManager::ClearGBuffer( VEDirectXInterface* aRenderInterface
 // Renders all of the chunks to the g-buffer
 void VEDeferredRenderManager::RenderGBuffer( VEDirectXInterface* aRenderInterface, VEBasicCamera* aCamera, VEShaderManager* aShaderManager )
 {
-	VEChunkManager* chunkManager	= VoxelEngine::GetInstance()->GetChunkManager();
-	assert( chunkManager != NULL );
+	VE_PROFILE_ZONE( "VEDeferredRenderManager::RenderGBuffer" );
+
+	assert( myRenderState != NULL );
 
 	VEShader* gBufferShader = aShaderManager->GetShader( VST_RenderGBuffer );
 	assert( gBufferShader != NULL );
 
 	aRenderInterface->EnableDepthTesting();
 
-	gBufferShader->PopulateVertexShaderConstants( aCamera, NULL );
 	gBufferShader->PopulatePixelShaderConstants( aCamera, NULL );
 
-	// Draw the chunks to the colour, normal & depth render targets
-	std::vector<VEChunk*> engineChunks = chunkManager->GetChunks();
-	for( unsigned int i = 0; i < engineChunks.size(); i++ )
-	{			
-		if( !engineChunks[i]->GetEnabled() )
-		{
-			continue;
-		}
+	// Draw the chunks to the colour, normal & depth render targets, each chunk's mesh at its position
+	const std::vector<VEChunkDrawItem>& chunks = myRenderState->GetChunks();
+	for( unsigned int i = 0; i < chunks.size(); i++ )
+	{
+		VEChunk::Prepare( chunks[i] );
 
-		engineChunks[i]->Prepare();	
-		gBufferShader->DrawIndexed( engineChunks[i]->GetIndexCount() );
+		gBufferShader->SetDrawOffset( chunks[i].myPosition );
+		gBufferShader->PopulateVertexShaderConstants( aCamera, NULL );
+		gBufferShader->DrawIndexed( chunks[i].myIndexCount );
 	}
 
 	aRenderInterface->DisableDepthTesting();
@@ -408,6 +399,8 @@ void VEDeferredRenderManager::RenderGBuffer( VEDirectXInterface* aRenderInterfac
 // Renders an SSAO buffer, used in the final blend shader
 void VEDeferredRenderManager::RenderSSAO( VEDirectXInterface* aRenderInterface, VEBasicCamera* aCamera, ID3D11RenderTargetView** someRenderTargets, VEShaderManager* aShaderManager )
 {
+	VE_PROFILE_ZONE( "VEDeferredRenderManager::RenderSSAO" );
+
 	VEShader* ssaoShader = aShaderManager->GetShader( VST_SSAO );
 	assert( ssaoShader != NULL );
 
@@ -447,8 +440,9 @@ void VEDeferredRenderManager::RenderSSAO( VEDirectXInterface* aRenderInterface,
 // targets and cleared them
 void VEDeferredRenderManager::RenderShadowMap( VEDirectXInterface* aRenderInterface, VEBasicCamera* aCamera, VELight* aLight, VEShaderManager* aShaderManager )
 {
-	VEChunkManager* chunkManager = VoxelEngine::GetInstance()->GetChunkManager();
-	assert( chunkManager != NULL );
+	VE_PROFILE_ZONE( "VEDeferredRenderManager::RenderShadowMap" );
+
+	assert( myRenderState != NULL );
 	assert( aLight != NULL );
 
 	VEShader* shadowMapShader = aShaderManager->GetShader( VST_ShadowMap );
@@ -457,15 +451,17 @@ void VEDeferredRenderManager::RenderShadowMap( VEDirectXInterface* aRenderInterf
 	// Enable alpha blending and disable depth testing
 	aRenderInterface->EnableDepthTesting();
 	
-	shadowMapShader->PopulateVertexShaderConstants( aCamera, aLight );
 	shadowMapShader->PopulatePixelShaderConstants( aCamera, aLight );
 
-	const std::vector<VEChunk*> chunks = chunkManager->GetChunks();
+	// The state holds its own references to the chunks' buffers, so chunks can be rebuilt while they're drawn
+	const std::vector<VEChunkDrawItem>& chunks = myRenderState->GetChunks();
 	for( unsigned int i = 0; i < chunks.size(); i++ )
 	{
-		chunks[i]->Prepare();
+		VEChunk::Prepare( chunks[i] );
 
-		shadowMapShader->DrawIndexed( chunks[i]->GetIndexCount() );
+		shadowMapShader->SetDrawOffset( chunks[i].myPosition );
+		shadowMapShader->PopulateVertexShaderConstants( aCamera, aLight );
+		shadowMapShader->DrawIndexed( chunks[i].myIndexCount );
 	}
 
 	// Disable alpha blending
@@ -474,8 +470,10 @@ void VEDeferredRenderManager::RenderShadowMap( VEDirectXInterface* aRenderInterf
 
 
 // Renders all of the directional lights to the lighting buffer
-void VEDeferredRenderManager::RenderDirectionalLights( VEDirectXInterface* aRenderInterface, VEBasicCamera* aCamera, VELightingManager* aLightingManager, ID3D11RenderTargetView** someRenderTargets, VEShaderManager* aShaderManager )
+void VEDeferredRenderManager::RenderDirectionalLights( VEDirectXInterface* aRenderInterface, VEBasicCamera* aCamera, ID3D11RenderTargetView** someRenderTargets, VEShaderManager* aShaderManager )
 {
+	VE_PROFILE_ZONE( "VEDeferredRenderManager::RenderDirectionalLights" );
+
 	VEShader* directionalShader = aShaderManager->GetShader( VST_DirectionalLight );
 	assert( directionalShader != NULL );
 
@@ -487,7 +485,7 @@ void VEDeferredRenderManager::RenderDirectionalLights( VEDirectXInterface* aRend
 	aRenderInterface->SetRenderTargets( someRenderTargets, RENDER_TARGET_COUNT, NULL );
 	aRenderInterface->Clear( myClearColour, false );
 
-	const std::vector<VEDirectionalLight*> lights = aLightingManager->GetDirectionalLights();
+	std::vector<VEDirectionalLight>& lights = myRenderState->GetDirectionalLights();
 	if( lights.size() == 0 )
 	{
 		return;
@@ -497,7 +495,7 @@ void VEDeferredRenderManager::RenderDirectionalLights( VEDirectXInterface* aRend
 	for( unsigned int i = 0; i < lights.size(); i++ )
 	{
 		// If the current light casts shadows, render a shadow map from the light's perspective
-		if( lights[i]->GetCastsShadows() )
+		if( lights[i].GetCastsShadows() )
 		{
 			someRenderTargets[0] = myShadowRenderTarget->myRenderTarget;
 			someRenderTargets[1] = NULL;
@@ -507,7 +505,7 @@ void VEDeferredRenderManager::RenderDirectionalLights( VEDirectXInterface* aRend
 			aRenderInterface->SetViewport( myShadowDepthTarget->myWidth, myShadowDepthTarget->myHeight );
 			aRenderInterface->Clear( myDepthClearColour, true );
 
-			RenderShadowMap( aRenderInterface, aCamera, lights[i], aShaderManager );
+			RenderShadowMap( aRenderInterface, aCamera, &lights[i], aShaderManager );
 		}
 
 		// Reset the render target
@@ -522,8 +520,8 @@ void VEDeferredRenderManager::RenderDirectionalLights( VEDirectXInterface* aRend
 		ID3D11ShaderResourceView* lightingResources[]	= { myNormalTarget->myShaderResource, myDepthRenderTarget->myShaderResource, myShadowRenderTarget->myShaderResource };
 		directionalShader->SetShaderResources( lightingResources, 3 );
 		directionalShader->SetSamplerStates( samplerStates, 3 );
-		directionalShader->PopulatePixelShaderConstants( aCamera, lights[i] );
-		directionalShader->PopulateVertexShaderConstants( aCamera, lights[i] );
+		directionalShader->PopulatePixelShaderConstants( aCamera, &lights[i] );
+		directionalShader->PopulateVertexShaderConstants( aCamera, &lights[i] );
 
 		// Now accumulate light in the lighting buffer
 		aRenderInterface->EnableAlphaBlending();
@@ -540,15 +538,17 @@ void VEDeferredRenderManager::RenderDirectionalLights( VEDirectXInterface* aRend
 
 
 // Renders all of the point lights to the lighting buffer
-void VEDeferredRenderManager::RenderSpotLights( VEDirectXInterface* aRenderInterface, VEBasicCamera* aCamera, VELightingManager* aLightingManager, ID3D11RenderTargetView** someRenderTargets, VEShaderManager* aShaderManager )
+void VEDeferredRenderManager::RenderSpotLights( VEDirectXInterface* aRenderInterface, VEBasicCamera* aCamera, ID3D11RenderTargetView** someRenderTargets, VEShaderManager* aShaderManager )
 {
+	VE_PROFILE_ZONE( "VEDeferredRenderManager::RenderSpotLights" );
+
 	VEChunkManager* chunkManager = VoxelEngine::GetInstance()->GetChunkManager();
 	assert( chunkManager != NULL );
 
 	VEShader* spotShader = aShaderManager->GetShader( VST_SpotLight );
 	assert( spotShader != NULL );
 
-	const std::vector<VESpotLight*> lights = aLightingManager->GetSpotLights();
+	std::vector<VESpotLight>& lights = myRenderState->GetSpotLights();
 	if( lights.size() == 0 )
 	{
 		return;
@@ -559,7 +559,7 @@ void VEDeferredRenderManager::RenderSpotLights( VEDirectXInterface* aRenderInter
 	for( unsigned int i = 0; i < lights.size(); i++ )
 	{
 		// If the current light casts shadows, render a shadow map from the light's perspective
-		if( lights[i]->GetCastsShadows() )
+		if( lights[i].GetCastsShadows() )
 		{
 			someRenderTargets[0] = myShadowRenderTarget->myRenderTarget;
 			someRenderTargets[1] = NULL;
@@ -569,7 +569,7 @@ void VEDeferredRenderManager::RenderSpotLights( VEDirectXInterface* aRenderInter
 			aRenderInterface->SetViewport( myShadowDepthTarget->myWidth, myShadowDepthTarget->myHeight );
 			aRenderInterface->Clear( myDepthClearColour, true );
 
-			RenderShadowMap( aRenderInterface, aCamera, lights[i], aShaderManager );
+			RenderShadowMap( aRenderInterface, aCamera, &lights[i], aShaderManager );
 		}
 
 		// Reset the render target
@@ -589,12 +589,12 @@ void VEDeferredRenderManager::RenderSpotLights( VEDirectXInterface* aRenderInter
 		spotShader->SetShaderResources( lightingResources, 3 );
 
 		// Work out whether we are inside of the light's sphere, or looking at it from a distance
-		XMFLOAT3	lightPosition = lights[i]->GetPosition();
+		XMFLOAT3	lightPosition = lights[i].GetPosition();
 		XMFLOAT3	cameraToLight( cameraPosition.x - lightPosition.x, cameraPosition.y - lightPosition.y, cameraPosition.z - lightPosition.z );
 		float		distanceToLight = sqrt( (cameraToLight.x * cameraToLight.x) + (cameraToLight.y * cameraToLight.y) + (cameraToLight.z * cameraToLight.z) );
 
 		// Use front face culling if we are inside the sphere
-		if( distanceToLight < lights[i]->GetRadius() )
+		if( distanceToLight < lights[i].GetRadius() )
 		{
 			aRenderInterface->SetDrawMode( DM_FrontFaceCulling );
 		}
@@ -607,8 +607,8 @@ void VEDeferredRenderManager::RenderSpotLights( VEDirectXInterface* aRenderInter
 		aRenderInterface->DisableDepthTesting();
 
 		// Draw the sphere to touch the pixels that require spot-light lighting calculations
-		spotShader->PopulateVertexShaderConstants( aCamera, lights[i] );
-		spotShader->PopulatePixelShaderConstants( aCamera, lights[i] );
+		spotShader->PopulateVertexShaderConstants( aCamera, &lights[i] );
+		spotShader->PopulatePixelShaderConstants( aCamera, &lights[i] );
 		spotShader->DrawIndexed( mySphere->GetIndexCount() );
 
 		aRenderInterface->SetDrawMode( DM_BackFaceCulling );
@@ -622,15 +622,17 @@ void VEDeferredRenderManager::RenderSpotLights( VEDirectXInterface* aRenderInter
 
 
 // Renders all of the point lights to the lighting buffer
-void VEDeferredRenderManager::RenderPointLights( VEDirectXInterface* aRenderInterface, VEBasicCamera* aCamera, VELightingManager* aLightingManager, VEShaderManager* aShaderManager )
+void VEDeferredRenderManager::RenderPointLights( VEDirectXInterface* aRenderInterface, VEBasicCamera* aCamera, VEShaderManager* aShaderManager )
 {
+	VE_PROFILE_ZONE( "VEDeferredRenderManager::RenderPointLights" );
+
 	VEChunkManager* chunkManager = VoxelEngine::GetInstance()->GetChunkManager();
 	assert( chunkManager != NULL );
 
 	VEShader* pointShader = aShaderManager->GetShader( VST_PointLight );
 	assert( pointShader != NULL );
 
-	const std::vector<VEPointLight*> lights = aLightingManager->GetPointLights();
+	std::vector<VEPointLight>& lights = myRenderState->GetPointLights();
 	if( lights.size() == 0 )
 	{
 		return;
@@ -650,18 +652,16 @@ void VEDeferredRenderManager::RenderPointLights( VEDirectXInterface* aRenderInte
 
 	for( unsigned int i = 0; i < lights.size(); i++ )
 	{
-		assert( lights[i] != NULL );
-
 		// Add the sphere geometry to the input assembler
 		mySphere->Prepare();
 
 		// Calculate the distance from the camera to the light position.
 		// If we're inside the sphere we want to cull the front faces, not the back faces
-		XMFLOAT3 lightPosition	= lights[i]->GetPosition();
+		XMFLOAT3 lightPosition	= lights[i].GetPosition();
 		XMFLOAT3 cameraToLight( cameraPosition.x - lightPosition.x, cameraPosition.y - lightPosition.y, cameraPosition.z - lightPosition.z );
 		float	 distanceToLight = sqrt( cameraToLight.x * cameraToLight.x + cameraToLight.y * cameraToLight.y + cameraToLight.z * cameraToLight.z );
 
-		if( distanceToLight < lights[i]->GetRadius() )
+		if( distanceToLight < lights[i].GetRadius() )
 		{
 			aRenderInterface->SetDrawMode( DM_FrontFaceCulling );
 		}
@@ -671,8 +671,8 @@ void VEDeferredRenderManager::RenderPointLights( VEDirectXInterface* aRenderInte
 		}
 
 		// Render the sphere to the lighting buffer
-		pointShader->PopulateVertexShaderConstants( aCamera, lights[i] );
-		pointShader->PopulatePixelShaderConstants( aCamera, lights[i] );
+		pointShader->PopulateVertexShaderConstants( aCamera, &lights[i] );
+		pointShader->PopulatePixelShaderConstants( aCamera, &lights[i] );
 		pointShader->DrawIndexed( mySphere->GetIndexCount() );
 	}
 
@@ -688,6 +688,8 @@ void VEDeferredRenderManager::RenderPointLights( VEDirectXInterface* aRenderInte
 // Blends the lighting buffer with the colour buffer
 void VEDeferredRenderManager::RenderFinalFrame( VEDirectXInterface* aRenderInterface, VEBasicCamera* aCamera, VEShaderManager* aShaderManager )
 {
+	VE_PROFILE_ZONE( "VEDeferredRenderManager::RenderFinalFrame" );
+
 	VEShader* finalBlend = aShaderManager->GetShader( VST_FinalBlend );
 	assert( finalBlend != NULL );
 
@@ -7,7 +7,6 @@
 class VEQuadRenderer;
 class VEDirectXInterface;
 class VEBasicCamera;
-class VELightingManager;
 class VEShaderManager;
 class VEShader;
 class VELight;
@@ -17,6 +16,7 @@ class VESphere;
 // ------------------------ Includes -----------------------
 
 #include "VERenderManager.h"
+#include "VEChunkManager.h"
 
 
 // ------------------------ Classes ------------------------
@@ -35,11 +35,14 @@ class VEDeferredRenderManager : public VERenderManager
 		// Initialises the render targets used by the deferred renderer
 		virtual bool Initialise( int aScreenWidth, int aScreenHeight ) override;
 
+		// Adds the deferred shaders & the SSAO random normals texture
+		virtual void GetResources( std::vector<VEShaderType>& someShaderTypes, std::vector<std::wstring>& someTextureFiles ) override;
+
 		// Cleans up the memory used by the deferred renderer
 		virtual void Uninitialise() override;
 
 		// Uses deferred rendering to draw the scene
-		virtual void RenderScene() override;
+		virtual void RenderScene( VERenderState& aRenderState ) override;
 
 
 	private :
@@ -71,13 +74,13 @@ class VEDeferredRenderManager : public VERenderManager
 		void	RenderShadowMap( VEDirectXInterface* aRenderInterface, VEBasicCamera* aCamera, VELight* aLight, VEShaderManager* aShaderManager );
 		
 		// Renders all of the directional lights to the lighting buffer
-		void	RenderDirectionalLights( VEDirectXInterface* aRenderInterface, VEBasicCamera* aCamera, VELightingManager* aLightingManager, ID3D11RenderTargetView** someRenderTargets, VEShaderManager* aShaderManager );
+		void	RenderDirectionalLights( VEDirectXInterface* aRenderInterface, VEBasicCamera* aCamera, ID3D11RenderTargetView** someRenderTargets, VEShaderManager* aShaderManager );
 
 		// Renders all of the spot lights to the lighting buffer
-		void	RenderSpotLights( VEDirectXInterface* aRenderInterface, VEBasicCamera* aCamera, VELightingManager* aLightingManager, ID3D11RenderTargetView** someRenderTargets, VEShaderManager* aShaderManager );
+		void	RenderSpotLights( VEDirectXInterface* aRenderInterface, VEBasicCamera* aCamera, ID3D11RenderTargetView** someRenderTargets, VEShaderManager* aShaderManager );
 		
 		// Renders all of the point lights to the lighting buffer
-		void	RenderPointLights( VEDirectXInterface* aRenderInterface, VEBasicCamera* aCamera, VELightingManager* aLightingManager, VEShaderManager* aShaderManager );
+		void	RenderPointLights( VEDirectXInterface* aRenderInterface, VEBasicCamera* aCamera, VEShaderManager* aShaderManager );
 
 
 		// Blends the lighting buffer with the shadow & colour buffer
@@ -104,6 +107,9 @@ class VEDeferredRenderManager : public VERenderManager
 
 		VESphere*					mySphere;
 
+		// The state being drawn, only set while a frame is being rendered
+		VERenderState*				myRenderState;
+
 		int							myRandomNormalsTextureId;
 
 		float						myClearColour[4];
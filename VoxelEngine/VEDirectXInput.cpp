@@ -6,6 +6,8 @@
 
 #include "VoxelEngine.h"
 #include "VEDirectXInterface.h"
+#include "VEInputService.h"
+#include "VEProfiler.h"
 
 
 // ----------------------- Namespaces ---------------------
@@ -91,9 +93,11 @@ void VEDirectXInput::Uninitialise()
 }
 
 
-// Checks the device states and sends updates to any registered listeners
-void VEDirectXInput::Update()
+// Checks the device states and pushes the changes since the last check on to the input service
+void VEDirectXInput::Update( VEInputService* anInputService /* NULL */ )
 {
+	VE_PROFILE_ZONE( "VEDirectXInput::Update" );
+
     HRESULT result;
 
     // Read in the keyboard state
@@ -120,7 +124,41 @@ void VEDirectXInput::Update()
         {
             myMouse->Acquire();
         }
+
+		// No movement was read
+		myMouseState.lX = 0;
+		myMouseState.lY = 0;
     }
+
+	if( anInputService == NULL )
+	{
+		return;
+	}
+
+	// Each key that changed, then the mouse movement. The mouse is in relative mode, so its axes are the movement
+	// since the last read
+	for( unsigned int i = 0; i < 256; i++ )
+	{
+		if( (myKeyboardState[i] & 0x80) != (myPreviousKeyboardState[i] & 0x80) )
+		{
+			anInputService->PushEvent( (myKeyboardState[i] & 0x80) ? IE_KeyDown : IE_KeyUp, i );
+		}
+	}
+
+	if( myMouseState.lX != 0 || myMouseState.lY != 0 )
+	{
+		anInputService->PushEvent( IE_MouseMove, 0, myMouseState.lX, myMouseState.lY );
+	}
+}
+
+
+// The input service's source, pass the input interface as the source parameter
+void VEDirectXInput::Poll( VEInputService* anInputService, void* anInput )
+{
+	VEDirectXInput* input = reinterpret_cast<VEDirectXInput*>( anInput );
+	assert( input != NULL );
+
+	input->Update( anInputService );
 }
 
 
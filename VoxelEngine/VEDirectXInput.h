@@ -2,10 +2,15 @@
 #define VE_DIRECTX_INPUT_H
 
 
+// ------------------- Forward Declarations --------------
+
+class VEInputService;
+
+
 // ----------------------- Classes -----------------------
 
-// Handles the DirectX keyboard, mouse and gamepad interface. Input listeners can register
-// themselves with this class, so they are informed when input events occur
+// Handles the DirectX keyboard, mouse and gamepad interface. The input service polls it, and informs its listeners
+// of the changes between polls
 class VEDirectXInput
 {
 	public :
@@ -21,8 +26,11 @@ class VEDirectXInput
 		// Cleans up the memory used by the input interface
 		void Uninitialise();
 
-        // Checks the device states and sends updates to any registered listeners
-        void Update();
+        // Checks the device states and pushes the changes since the last check on to the input service
+        void Update( VEInputService* anInputService = NULL );
+
+		// The input service's source, pass the input interface as the source parameter
+		static void Poll( VEInputService* anInputService, void* anInput );
 
 
 		// ----------- Accessors -----------
@@ -190,6 +190,47 @@ void VEDirectXInterface::PresentBuffer()
 		// Present as fast as possible
 		mySwapChain->Present( 0, 0 );
 	}
+
+	RecordPresent();
+}
+
+
+// Creates a vertex or index buffer holding the supplied data
+bool VEDirectXInterface::CreateBuffer( BufferType aType, const void* someData, unsigned int aByteWidth, ID3D11Buffer** aBuffer )
+{
+	assert( aBuffer != NULL );
+
+	D3D11_BUFFER_DESC       bufferDescription;
+	D3D11_SUBRESOURCE_DATA  bufferData;
+
+	ZeroMemory( &bufferDescription, sizeof(D3D11_BUFFER_DESC) );
+	bufferDescription.Usage                 = D3D11_USAGE_DEFAULT;
+	bufferDescription.ByteWidth             = aByteWidth;
+	bufferDescription.BindFlags             = aType == BT_Index ? D3D11_BIND_INDEX_BUFFER : D3D11_BIND_VERTEX_BUFFER;
+	bufferDescription.CPUAccessFlags        = 0;
+	bufferDescription.MiscFlags             = 0;
+	bufferDescription.StructureByteStride   = 0;
+
+	bufferData.pSysMem          = someData;
+	bufferData.SysMemPitch      = 0;
+	bufferData.SysMemSlicePitch = 0;
+
+	HRESULT result = myDevice->CreateBuffer( &bufferDescription, &bufferData, aBuffer );
+	if( FAILED(result) )
+	{
+		return false;
+	}
+
+	RecordBuffer( aByteWidth );
+	return true;
+}
+
+
+// Draws indexed geometry using the currently bound buffers
+void VEDirectXInterface::DrawIndexed( unsigned int anIndexCount )
+{
+	myDeviceContext->DrawIndexed( anIndexCount, 0, 0 );
+	RecordDraw( anIndexCount );
 }
 
 
@@ -5,12 +5,13 @@
 // ------------------ Includes ------------------
 
 #include "VETypes.h"
+#include "VERenderBackend.h"
 
 
 // ------------------ Classes -------------------
 
 // Handles the connection to the DirectX framework
-class VEDirectXInterface
+class VEDirectXInterface : public VERenderBackend
 {
 	public :
 
@@ -30,7 +31,14 @@ class VEDirectXInterface
 		void Clear( float* aClearColour, bool aClearDepth = true );
 
 		// Swaps the back buffer with the front
-		void PresentBuffer();
+		virtual void PresentBuffer() override;
+
+
+		// Creates a vertex or index buffer holding the supplied data
+		virtual bool CreateBuffer( BufferType aType, const void* someData, unsigned int aByteWidth, ID3D11Buffer** aBuffer ) override;
+
+		// Draws indexed geometry using the currently bound buffers
+		virtual void DrawIndexed( unsigned int anIndexCount ) override;
 
 
 		// Creates a drawing render target and texture
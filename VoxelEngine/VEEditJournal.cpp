@@ -0,0 +1,750 @@
+// --------------------- Includes ---------------------
+
+#include "Stdafx.h"
+#include "VEEditJournal.h"
+
+#include "VEChunk.h"
+#include "VEVoxel.h"
+#include "VEMemoryTracker.h"
+#include "VEProfiler.h"
+
+#include <algorithm>
+
+
+// ------------------ Class Functions -----------------
+
+// Construction
+VEEditJournal::VEEditJournal() :
+	myFile( NULL ),
+	myIsOpen( false ),
+	myIsStopping( false ),
+	myIsCompactRequested( false ),
+	myIsCompacting( false ),
+	myLiveEditCount( 0 ),
+	mySequence( 0 ),
+	myWrittenSequence( 0 ),
+	myCurrentBlock( NULL ),
+	myFileSize( 0 ),
+	myJournalEditCount( 0 ),
+	myCompactionCount( 0 ),
+	myWrittenBytes( 0 ),
+	myWriteTime( 0 ),
+	myFailedWriteCount( 0 ),
+	myRecoveredEditCount( 0 ),
+	myDiscardedBytes( 0 ),
+	myRecoveryTime( 0 )
+{
+}
+
+
+// Deconstruction, closes the journal
+VEEditJournal::~VEEditJournal()
+{
+	Close();
+}
+
+
+// Opens the journal, creating it if it doesn't exist, reads back its edits and starts the writer thread
+bool VEEditJournal::Open( const std::wstring& aFilename )
+{
+	VE_MEMORY_TAG( MEM_World );
+
+	Close();
+
+	myFilename	= aFilename;
+	myFile		= CreateFileW( myFilename.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL );
+	if( myFile == INVALID_HANDLE_VALUE )
+	{
+		myFile = NULL;
+		return false;
+	}
+
+	myLiveEditCount		= 0;
+	mySequence			= 0;
+	myCompactionCount	= 0;
+	myWrittenBytes		= 0;
+	myWriteTime			= 0;
+	myFailedWriteCount	= 0;
+
+	long long startTime = VEProfiler::GetTime();
+
+	// Cut off anything after the last valid block, so new blocks follow straight on from it
+	unsigned long long	validSize = 0;
+	bool				succeeded = ReadJournal( validSize );
+	if( succeeded )
+	{
+		LARGE_INTEGER position;
+		position.QuadPart = (LONGLONG)validSize;
+
+		succeeded = SetFilePointerEx( myFile, position, NULL, FILE_BEGIN ) && SetEndOfFile( myFile );
+	}
+
+	myRecoveryTime		= VEProfiler::GetTime() - startTime;
+	myFileSize			= validSize;
+	myJournalEditCount	= myRecoveredEditCount;
+	myWrittenSequence	= mySequence;
+
+	myIsStopping			= false;
+	myIsCompactRequested	= false;
+	if( !succeeded || !myWriterThread.Start(WriterThread, this) )
+	{
+		myEdits.clear();
+
+		CloseHandle( myFile );
+		myFile = NULL;
+
+		return false;
+	}
+
+	myIsOpen = true;
+
+	return true;
+}
+
+
+// Writes every edit, compacting the journal if it's mostly edits that are no longer needed, and closes it
+void VEEditJournal::Close()
+{
+	if( !myIsOpen )
+	{
+		return;
+	}
+
+	{
+		VEScopedLock<VEMutex> lock( myLock );
+
+		// Leave a small journal behind for the next time the world's opened
+		if( myJournalEditCount + mySequence - myWrittenSequence > myLiveEditCount * 2 )
+		{
+			myIsCompactRequested = true;
+		}
+
+		myIsStopping = true;
+		myWriterCondition.NotifyOne();
+	}
+
+	// The thread writes every sealed block before finishing
+	myWriterThread.Join();
+
+	delete myCurrentBlock;
+	myCurrentBlock = NULL;
+
+	for( unsigned int i = 0; i < myFreeBlocks.size(); i++ )
+	{
+		delete myFreeBlocks[i];
+	}
+	myFreeBlocks.clear();
+
+	if( myFile != NULL )
+	{
+		CloseHandle( myFile );
+		myFile = NULL;
+	}
+
+	myEdits.clear();
+	myIsOpen = false;
+}
+
+
+// Records an edit to the voxel at the supplied index in a chunk
+void VEEditJournal::RecordEdit( int aGridX, int aGridZ, unsigned int anIndex, VEVoxel& anOldVoxel, VEVoxel& aNewVoxel )
+{
+	assert( aGridX >= -32768 && aGridX <= 32767 && aGridZ >= -32768 && aGridZ <= 32767 && anIndex < (1 << 24) );
+
+	unsigned char oldVoxel = EncodeVoxel( anOldVoxel );
+	unsigned char newVoxel = EncodeVoxel( aNewVoxel );
+
+	VEScopedLock<VEMutex> lock( myLock );
+
+	if( !myIsOpen || myIsStopping )
+	{
+		return;
+	}
+
+	Edit edit;
+	edit.myIndex	= anIndex;
+	edit.mySequence	= ++mySequence;
+	edit.myOldVoxel	= oldVoxel;
+	edit.myNewVoxel	= newVoxel;
+
+	{
+		VE_MEMORY_TAG( MEM_World );
+
+		myEdits[std::make_pair(aGridX, aGridZ)].push_back( edit );
+		AppendEdit( aGridX, aGridZ, anIndex, oldVoxel, newVoxel );
+	}
+
+	myLiveEditCount++;
+}
+
+
+// Applies the chunk's recorded edits to its voxels, in the order they were made
+unsigned int VEEditJournal::ReplayEdits( VEChunk* aChunk )
+{
+	assert( aChunk != NULL );
+
+	VE_PROFILE_ZONE( "VEEditJournal::ReplayEdits" );
+
+	unsigned int appliedCount = 0;
+	{
+		VEScopedLock<VESharedMutex> voxelLock( aChunk->GetVoxelLock() );
+		VEScopedLock<VEMutex>		lock( myLock );
+
+		EditMap::iterator iter = myEdits.find( std::make_pair(aChunk->GetGridX(), aChunk->GetGridZ()) );
+		if( iter == myEdits.end() )
+		{
+			return 0;
+		}
+
+		unsigned int		voxelCount	= (unsigned int)( aChunk->GetDimensions() * aChunk->GetDimensions() * aChunk->GetDimensions() );
+		VEVoxel*			voxels		= aChunk->GetVoxels();
+		std::vector<Edit>&	edits		= iter->second;
+		for( unsigned int i = 0; i < edits.size(); i++ )
+		{
+			if( edits[i].myIndex < voxelCount && (edits[i].myNewVoxel >> 1) < VT_Max )
+			{
+				DecodeVoxel( edits[i].myNewVoxel, voxels[edits[i].myIndex] );
+				appliedCount++;
+			}
+		}
+	}
+
+	// The chunk's voxels no longer match what's stored for it until it's saved again
+	if( appliedCount > 0 )
+	{
+		aChunk->SetIsDirty( true );
+		aChunk->SetNeighboursDirty( true );
+		aChunk->SetIsModified( true );
+	}
+
+	return appliedCount;
+}
+
+
+// Drops the chunk's edits up to the supplied sequence number
+void VEEditJournal::MarkSaved( int aGridX, int aGridZ, unsigned int aSequence )
+{
+	VEScopedLock<VEMutex> lock( myLock );
+
+	EditMap::iterator iter = myEdits.find( std::make_pair(aGridX, aGridZ) );
+	if( iter == myEdits.end() )
+	{
+		return;
+	}
+
+	// Compaction reorders a chunk's edits, so every edit is checked
+	std::vector<Edit>&	edits		= iter->second;
+	unsigned int		keptCount	= 0;
+	for( unsigned int i = 0; i < edits.size(); i++ )
+	{
+		if( edits[i].mySequence > aSequence )
+		{
+			edits[keptCount++] = edits[i];
+		}
+	}
+
+	myLiveEditCount -= (unsigned int)edits.size() - keptCount;
+
+	if( keptCount == 0 )
+	{
+		myEdits.erase( iter );
+	}
+	else
+	{
+		edits.resize( keptCount );
+	}
+}
+
+
+// Blocks until every edit recorded so far has been written
+void VEEditJournal::Flush()
+{
+	if( !myIsOpen )
+	{
+		return;
+	}
+
+	VE_PROFILE_ZONE( "VEEditJournal::Flush" );
+
+	VEScopedLock<VEMutex> lock( myLock );
+
+	SealBlock();
+	myWriterCondition.NotifyOne();
+
+	unsigned int sequence = mySequence;
+	while( myWrittenSequence < sequence )
+	{
+		myWrittenCondition.Wait( myLock );
+	}
+}
+
+
+// Has the writer thread compact the journal, and blocks until it has
+void VEEditJournal::Compact()
+{
+	if( !myIsOpen )
+	{
+		return;
+	}
+
+	VE_PROFILE_ZONE( "VEEditJournal::Compact" );
+
+	VEScopedLock<VEMutex> lock( myLock );
+
+	myIsCompactRequested = true;
+	myWriterCondition.NotifyOne();
+
+	while( myIsCompactRequested || myIsCompacting )
+	{
+		myWrittenCondition.Wait( myLock );
+	}
+}
+
+
+// Appends an edit to the current block, sealing it if it's full
+void VEEditJournal::AppendEdit( int aGridX, int aGridZ, unsigned int anIndex, unsigned char anOldVoxel, unsigned char aNewVoxel )
+{
+	if( myCurrentBlock == NULL )
+	{
+		if( !myFreeBlocks.empty() )
+		{
+			myCurrentBlock = myFreeBlocks.back();
+			myFreeBlocks.pop_back();
+		}
+		else
+		{
+			myCurrentBlock = new Block();
+			myCurrentBlock->myData.resize( sizeof(BlockHeader) + VE_JOURNAL_BLOCK_EDITS * VE_JOURNAL_EDIT_SIZE );
+		}
+
+		myCurrentBlock->myEditCount = 0;
+	}
+
+	// Grid coordinates are stored in two bytes each & the index in three, all little endian
+	unsigned char* edit = &myCurrentBlock->myData[sizeof(BlockHeader) + myCurrentBlock->myEditCount * VE_JOURNAL_EDIT_SIZE];
+	edit[0] = (unsigned char)( aGridX & 0xFF );
+	edit[1] = (unsigned char)( (aGridX >> 8) & 0xFF );
+	edit[2] = (unsigned char)( aGridZ & 0xFF );
+	edit[3] = (unsigned char)( (aGridZ >> 8) & 0xFF );
+	edit[4] = (unsigned char)( anIndex & 0xFF );
+	edit[5] = (unsigned char)( (anIndex >> 8) & 0xFF );
+	edit[6] = (unsigned char)( (anIndex >> 16) & 0xFF );
+	edit[7] = anOldVoxel;
+	edit[8] = aNewVoxel;
+
+	myCurrentBlock->myEditCount++;
+	myCurrentBlock->myLastSequence = mySequence;
+
+	if( myCurrentBlock->myEditCount == VE_JOURNAL_BLOCK_EDITS )
+	{
+		SealBlock();
+		myWriterCondition.NotifyOne();
+	}
+}
+
+
+// Queues the current block for the writer thread, if it holds any edits
+void VEEditJournal::SealBlock()
+{
+	if( myCurrentBlock == NULL || myCurrentBlock->myEditCount == 0 )
+	{
+		return;
+	}
+
+	mySealedBlocks.push_back( myCurrentBlock );
+	myCurrentBlock = NULL;
+}
+
+
+// Hands blocks back for reuse
+void VEEditJournal::FreeBlocks( std::vector<Block*>& someBlocks )
+{
+	myFreeBlocks.insert( myFreeBlocks.end(), someBlocks.begin(), someBlocks.end() );
+	someBlocks.clear();
+}
+
+
+// Reads back the blocks in the file, stopping at the first that's torn or corrupt
+bool VEEditJournal::ReadJournal( unsigned long long& aValidSize )
+{
+	VE_PROFILE_ZONE( "VEEditJournal::ReadJournal" );
+
+	myEdits.clear();
+	myRecoveredEditCount	= 0;
+	myDiscardedBytes		= 0;
+	aValidSize				= 0;
+
+	LARGE_INTEGER fileSize;
+	if( !GetFileSizeEx(myFile, &fileSize) )
+	{
+		return false;
+	}
+
+	std::vector<unsigned char> data( (size_t)fileSize.QuadPart );
+
+	DWORD bytesRead = 0;
+	if( !data.empty() && (!ReadFile(myFile, &data[0], (DWORD)data.size(), &bytesRead, NULL) || bytesRead != data.size()) )
+	{
+		return false;
+	}
+
+	size_t offset = 0;
+	while( offset + sizeof(BlockHeader) <= data.size() )
+	{
+		BlockHeader header;
+		memcpy( &header, &data[offset], sizeof(header) );
+
+		if( header.myMagic != VE_JOURNAL_MAGIC || header.myEditCount == 0 || header.myEditCount > VE_JOURNAL_BLOCK_EDITS )
+		{
+			break;
+		}
+
+		unsigned int editsSize = header.myEditCount * VE_JOURNAL_EDIT_SIZE;
+		if( offset + sizeof(header) + editsSize > data.size() )
+		{
+			break;
+		}
+
+		const unsigned char* edits = &data[offset + sizeof(header)];
+		if( CalculateChecksum(edits, editsSize) != header.myChecksum )
+		{
+			break;
+		}
+
+		for( unsigned int i = 0; i < header.myEditCount; i++ )
+		{
+			const unsigned char* editData = edits + i * VE_JOURNAL_EDIT_SIZE;
+
+			int gridX = (short)( editData[0] | (editData[1] << 8) );
+			int gridZ = (short)( editData[2] | (editData[3] << 8) );
+
+			Edit edit;
+			edit.myIndex	= editData[4] | (editData[5] << 8) | (editData[6] << 16);
+			edit.mySequence	= ++mySequence;
+			edit.myOldVoxel	= editData[7];
+			edit.myNewVoxel	= editData[8];
+
+			myEdits[std::make_pair(gridX, gridZ)].push_back( edit );
+		}
+
+		myRecoveredEditCount += header.myEditCount;
+		offset += sizeof(header) + editsSize;
+	}
+
+	myLiveEditCount		= myRecoveredEditCount;
+	myDiscardedBytes	= data.size() - offset;
+	aValidSize			= offset;
+
+	return true;
+}
+
+
+// Writes the blocks to the end of the journal
+bool VEEditJournal::WriteBlocks( const std::vector<Block*>& someBlocks )
+{
+	if( someBlocks.empty() )
+	{
+		return true;
+	}
+
+	VE_PROFILE_ZONE( "VEEditJournal::WriteBlocks" );
+
+	long long startTime = VEProfiler::GetTime();
+
+	LARGE_INTEGER position;
+	position.QuadPart = (LONGLONG)myFileSize;
+
+	bool				succeeded		= myFile != NULL && SetFilePointerEx( myFile, position, NULL, FILE_BEGIN );
+	unsigned long long	writtenBytes	= 0;
+	unsigned int		editCount		= 0;
+	for( unsigned int i = 0; i < someBlocks.size() && succeeded; i++ )
+	{
+		Block*			block		= someBlocks[i];
+		unsigned int	editsSize	= block->myEditCount * VE_JOURNAL_EDIT_SIZE;
+
+		BlockHeader header;
+		header.myMagic		= VE_JOURNAL_MAGIC;
+		header.myEditCount	= block->myEditCount;
+		header.myChecksum	= CalculateChecksum( &block->myData[sizeof(header)], editsSize );
+		memcpy( &block->myData[0], &header, sizeof(header) );
+
+		DWORD bytesWritten = 0;
+		succeeded = WriteFile( myFile, &block->myData[0], sizeof(header) + editsSize, &bytesWritten, NULL ) && bytesWritten == sizeof(header) + editsSize;
+
+		writtenBytes	+= sizeof(header) + editsSize;
+		editCount		+= block->myEditCount;
+	}
+
+	// The edits only count as written once they're on the disk, rather than in the system's cache
+	succeeded = succeeded && FlushFileBuffers( myFile );
+
+	// Anything after a failed write would be cut off the next time the journal's opened, so the blocks are cut off
+	// now and the whole journal is rewritten from memory instead
+	if( !succeeded && myFile != NULL && SetFilePointerEx(myFile, position, NULL, FILE_BEGIN) )
+	{
+		SetEndOfFile( myFile );
+	}
+
+	long long writeTime = VEProfiler::GetTime() - startTime;
+
+	VEScopedLock<VEMutex> lock( myLock );
+
+	myWrittenBytes	+= writtenBytes;
+	myWriteTime		+= writeTime;
+
+	if( succeeded )
+	{
+		myFileSize			+= writtenBytes;
+		myJournalEditCount	+= editCount;
+	}
+	else
+	{
+		myFailedWriteCount++;
+		myIsCompactRequested = true;
+	}
+
+	return succeeded;
+}
+
+
+// Rewrites the journal with only the edits still needed
+bool VEEditJournal::CompactJournal( std::vector<Block*>& somePendingBlocks, unsigned int& aWrittenSequence )
+{
+	VE_PROFILE_ZONE( "VEEditJournal::CompactJournal" );
+
+	std::vector<unsigned char>	data;
+	unsigned int				editCount = 0;
+	{
+		VE_MEMORY_TAG( MEM_World );
+
+		VEScopedLock<VEMutex> lock( myLock );
+
+		// Every edit recorded so far is rewritten from memory, so the blocks waiting to be written are covered too
+		SealBlock();
+		somePendingBlocks.insert( somePendingBlocks.end(), mySealedBlocks.begin(), mySealedBlocks.end() );
+		mySealedBlocks.clear();
+
+		aWrittenSequence = mySequence;
+
+		// Reduce each chunk's edits to one per voxel, from its first old voxel to its last new one. The sort is stable,
+		// so each voxel's edits stay in the order they were made
+		EditMap::iterator iter = myEdits.begin();
+		while( iter != myEdits.end() )
+		{
+			std::vector<Edit>& edits = iter->second;
+			std::stable_sort( edits.begin(), edits.end(), CompareEditIndices );
+
+			unsigned int keptCount = 0;
+			for( unsigned int i = 0; i < edits.size(); i++ )
+			{
+				if( keptCount > 0 && edits[keptCount - 1].myIndex == edits[i].myIndex )
+				{
+					edits[keptCount - 1].myNewVoxel	= edits[i].myNewVoxel;
+					edits[keptCount - 1].mySequence	= edits[i].mySequence;
+				}
+				else
+				{
+					edits[keptCount++] = edits[i];
+				}
+			}
+
+			// Voxels that were changed back to how they started are kept too. A snapshot captured between the changes may
+			// still be being written, and it has to have the voxel changed back when it's loaded after a crash
+			edits.resize( keptCount );
+
+			// Write the chunk's edits in to blocks
+			for( unsigned int i = 0; i < keptCount; i++ )
+			{
+				if( editCount % VE_JOURNAL_BLOCK_EDITS == 0 )
+				{
+					data.resize( data.size() + sizeof(BlockHeader) );
+				}
+
+				size_t editOffset = data.size();
+				data.resize( editOffset + VE_JOURNAL_EDIT_SIZE );
+
+				unsigned char* editData = &data[editOffset];
+				editData[0] = (unsigned char)( iter->first.first & 0xFF );
+				editData[1] = (unsigned char)( (iter->first.first >> 8) & 0xFF );
+				editData[2] = (unsigned char)( iter->first.second & 0xFF );
+				editData[3] = (unsigned char)( (iter->first.second >> 8) & 0xFF );
+				editData[4] = (unsigned char)( edits[i].myIndex & 0xFF );
+				editData[5] = (unsigned char)( (edits[i].myIndex >> 8) & 0xFF );
+				editData[6] = (unsigned char)( (edits[i].myIndex >> 16) & 0xFF );
+				editData[7] = edits[i].myOldVoxel;
+				editData[8] = edits[i].myNewVoxel;
+
+				editCount++;
+			}
+
+			iter++;
+		}
+
+		myLiveEditCount = editCount;
+	}
+
+	// Fill in the block headers
+	size_t offset = 0;
+	for( unsigned int remaining = editCount; remaining > 0; )
+	{
+		BlockHeader header;
+		header.myMagic		= VE_JOURNAL_MAGIC;
+		header.myEditCount	= remaining < VE_JOURNAL_BLOCK_EDITS ? remaining : VE_JOURNAL_BLOCK_EDITS;
+		header.myChecksum	= CalculateChecksum( &data[offset + sizeof(header)], header.myEditCount * VE_JOURNAL_EDIT_SIZE );
+		memcpy( &data[offset], &header, sizeof(header) );
+
+		offset		+= sizeof(header) + header.myEditCount * VE_JOURNAL_EDIT_SIZE;
+		remaining	-= header.myEditCount;
+	}
+
+	long long startTime = VEProfiler::GetTime();
+
+	// Write the compacted journal beside the old one, so a crash part way through leaves the old journal intact
+	std::wstring	compactFilename	= myFilename + L".compact";
+	HANDLE			compactFile		= CreateFileW( compactFilename.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL );
+	if( compactFile == INVALID_HANDLE_VALUE )
+	{
+		return false;
+	}
+
+	DWORD	bytesWritten	= 0;
+	bool	succeeded		= data.empty() || (WriteFile(compactFile, &data[0], (DWORD)data.size(), &bytesWritten, NULL) && bytesWritten == data.size());
+	succeeded = succeeded && FlushFileBuffers( compactFile );
+
+	CloseHandle( compactFile );
+
+	if( !succeeded )
+	{
+		DeleteFileW( compactFilename.c_str() );
+		return false;
+	}
+
+	// Swap it in for the old journal
+	if( myFile != NULL )
+	{
+		CloseHandle( myFile );
+	}
+
+	succeeded = MoveFileExW( compactFilename.c_str(), myFilename.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH ) != FALSE;
+
+	myFile = CreateFileW( myFilename.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL );
+	if( myFile == INVALID_HANDLE_VALUE )
+	{
+		myFile = NULL;
+	}
+
+	if( !succeeded )
+	{
+		DeleteFileW( compactFilename.c_str() );
+		return false;
+	}
+
+	long long writeTime = VEProfiler::GetTime() - startTime;
+
+	VEScopedLock<VEMutex> lock( myLock );
+
+	myFileSize			= data.size();
+	myJournalEditCount	= editCount;
+	myWrittenBytes		+= data.size();
+	myWriteTime			+= writeTime;
+	myCompactionCount++;
+
+	// The pending blocks are in the compacted journal already
+	FreeBlocks( somePendingBlocks );
+
+	return true;
+}
+
+
+// The writer thread, writes sealed blocks until the journal is closed
+unsigned int VEEditJournal::WriterThread( void* aJournal )
+{
+	VEEditJournal* journal = reinterpret_cast<VEEditJournal*>( aJournal );
+	assert( journal != NULL );
+
+	std::vector<Block*> blocks;
+
+	for( ;; )
+	{
+		unsigned int	writtenSequence	= 0;
+		bool			isCompacting	= false;
+		{
+			VEScopedLock<VEMutex> lock( journal->myLock );
+
+			if( journal->mySealedBlocks.empty() && !journal->myIsStopping && !journal->myIsCompactRequested )
+			{
+				journal->myWriterCondition.WaitFor( journal->myLock, VE_JOURNAL_FLUSH_INTERVAL );
+			}
+
+			// However few edits there are, they're written once the flush interval has passed
+			journal->SealBlock();
+
+			// Only finish once every block has been written
+			if( journal->mySealedBlocks.empty() && journal->myIsStopping && !journal->myIsCompactRequested )
+			{
+				break;
+			}
+
+			blocks.swap( journal->mySealedBlocks );
+			writtenSequence = journal->mySequence;
+
+			isCompacting = journal->myIsCompactRequested || (journal->myFileSize >= VE_JOURNAL_COMPACT_SIZE &&
+																journal->myJournalEditCount > journal->myLiveEditCount * 2);
+			journal->myIsCompactRequested	= false;
+			journal->myIsCompacting			= isCompacting;
+		}
+
+		if( !isCompacting || !journal->CompactJournal(blocks, writtenSequence) )
+		{
+			journal->WriteBlocks( blocks );
+		}
+
+		VEScopedLock<VEMutex> lock( journal->myLock );
+
+		journal->FreeBlocks( blocks );
+		journal->myWrittenSequence	= writtenSequence;
+		journal->myIsCompacting		= false;
+		journal->myWrittenCondition.NotifyAll();
+	}
+
+	VE_PROFILE_THREAD_END();
+
+	return 0;
+}
+
+
+// Packs a voxel in to a byte
+unsigned char VEEditJournal::EncodeVoxel( VEVoxel& aVoxel )
+{
+	assert( aVoxel.GetType() < 0x80 );
+
+	return (unsigned char)( (aVoxel.GetType() << 1) | (aVoxel.GetEnabled() ? 1 : 0) );
+}
+
+
+// Unpacks a voxel packed by EncodeVoxel
+void VEEditJournal::DecodeVoxel( unsigned char aCode, VEVoxel& aVoxel )
+{
+	aVoxel.SetType( (VoxelType)(aCode >> 1) );
+	aVoxel.SetEnabled( (aCode & 1) != 0 );
+}
+
+
+// Orders edits by voxel index
+bool VEEditJournal::CompareEditIndices( const Edit& anEdit, const Edit& anOtherEdit )
+{
+	return anEdit.myIndex < anOtherEdit.myIndex;
+}
+
+
+// Checksums a block's edits, FNV-1a
+unsigned int VEEditJournal::CalculateChecksum( const unsigned char* someData, unsigned int aSize )
+{
+	unsigned int checksum = 2166136261U;
+	for( unsigned int i = 0; i < aSize; i++ )
+	{
+		checksum = (checksum ^ someData[i]) * 16777619U;
+	}
+
+	return checksum;
+}
@@ -0,0 +1,218 @@
+#ifndef VE_EDIT_JOURNAL_H
+#define VE_EDIT_JOURNAL_H
+
+
+// --------------------- Includes --------------------
+
+#include "VETypes.h"
+#include "VEThreading.h"
+
+
+// ---------------- Forward Declarations -------------
+
+class VEChunk;
+class VEVoxel;
+
+
+// --------------------- Defines ---------------------
+
+// The number of edits in each checksummed block of the journal
+#define VE_JOURNAL_BLOCK_EDITS		4096
+
+// The longest an edit waits before its block is written, in milliseconds
+#define VE_JOURNAL_FLUSH_INTERVAL	100
+
+// The journal is compacted once it's grown to this size, if at least half of it is edits that have since been saved
+// in chunk snapshots or made again
+#define VE_JOURNAL_COMPACT_SIZE		(8 * 1024 * 1024)
+
+// Identifies the start of each block
+#define VE_JOURNAL_MAGIC			0x4C4E524A
+
+// The size of an edit in the file: the chunk's grid coordinates, the voxel's index and the old & new voxels
+#define VE_JOURNAL_EDIT_SIZE		9
+
+
+// --------------------- Classes ---------------------
+
+// An append only log of voxel edits, so changing a handful of voxels doesn't mean writing out whole chunks. Each edit
+// records the chunk, the voxel's index and the voxel before & after, a byte each. Edits are gathered in to blocks
+// that are checksummed & appended to the file by the journal's writer thread, at least every VE_JOURNAL_FLUSH_INTERVAL.
+//
+// Opening the journal reads back every block up to the first that's torn or corrupt, which is cut off, so a crash
+// loses at most the edits that hadn't been written yet. The edits are kept in memory per chunk and replayed on top of
+// each chunk's snapshot (or generated terrain) as it's loaded. Edits are dropped once a snapshot of their chunk has
+// been written, and the writer thread rewrites the journal with only the edits still needed once it's grown large
+// enough. A snapshot can be loaded with edits it already includes still in the journal, which only works because
+// replaying them in order ends at the same voxels, so anything that changes a chunk's voxels after it's been generated
+// has to journal what it changed. Lock order: a chunk's voxel lock is always taken before the journal's
+class VEEditJournal
+{
+	public :
+
+		// ------ Public Functions ------
+
+		// Construction
+		VEEditJournal();
+
+		// Deconstruction, closes the journal
+		~VEEditJournal();
+
+		// Opens the journal, creating it if it doesn't exist, reads back its edits and starts the writer thread
+		bool				Open( const std::wstring& aFilename );
+
+		// Writes every edit, compacting the journal if it's mostly edits that are no longer needed, and closes it
+		void				Close();
+
+		// Records an edit to the voxel at the supplied index in a chunk. Can be called from any thread
+		void				RecordEdit( int aGridX, int aGridZ, unsigned int anIndex, VEVoxel& anOldVoxel, VEVoxel& aNewVoxel );
+
+		// Applies the chunk's recorded edits to its voxels, in the order they were made. Returns the number of edits applied
+		unsigned int		ReplayEdits( VEChunk* aChunk );
+
+		// Drops the chunk's edits up to the supplied sequence number, once a snapshot including them has been written
+		void				MarkSaved( int aGridX, int aGridZ, unsigned int aSequence );
+
+		// Blocks until every edit recorded so far has been written
+		void				Flush();
+
+		// Has the writer thread compact the journal, whatever its size, and blocks until it has
+		void				Compact();
+
+
+		// --------- Accessors ----------
+
+		bool				GetIsOpen()							{ return myIsOpen; }
+
+		// The sequence number of the last edit recorded
+		unsigned int		GetSequence()						{ return mySequence; }
+
+		// The number of edits still needed, the size of the journal file and the number of compactions run
+		unsigned int		GetLiveEditCount()					{ return myLiveEditCount; }
+		unsigned long long	GetFileSize()						{ return myFileSize; }
+		unsigned int		GetCompactionCount()				{ return myCompactionCount; }
+
+		// The bytes the writer thread has written, and the time it spent writing them in performance counter ticks
+		unsigned long long	GetWrittenBytes()					{ return myWrittenBytes; }
+		long long			GetWriteTime()						{ return myWriteTime; }
+		unsigned int		GetFailedWriteCount()				{ return myFailedWriteCount; }
+
+		// What opening the journal read back: the edits recovered, the bytes cut off the end of the file and the time
+		// taken in performance counter ticks
+		unsigned int		GetRecoveredEditCount()				{ return myRecoveredEditCount; }
+		unsigned long long	GetDiscardedBytes()					{ return myDiscardedBytes; }
+		long long			GetRecoveryTime()					{ return myRecoveryTime; }
+
+
+	private :
+
+		// ----- Private Structures -----
+
+		// An edit held in memory
+		struct Edit
+		{
+			unsigned int	myIndex;
+			unsigned int	mySequence;
+			unsigned char	myOldVoxel;
+			unsigned char	myNewVoxel;
+		};
+
+		// Edits gathered for the file, the block's header is filled in when it's written
+		struct Block
+		{
+			std::vector<unsigned char>	myData;
+			unsigned int				myEditCount;
+			unsigned int				myLastSequence;
+		};
+
+		// The start of each block in the file, followed by the block's edits
+		struct BlockHeader
+		{
+			unsigned int	myMagic;
+			unsigned int	myEditCount;
+			unsigned int	myChecksum;
+		};
+
+		typedef std::map<std::pair<int, int>, std::vector<Edit> >	EditMap;
+
+
+		// ----- Private Functions ------
+
+		// Appends an edit to the current block, sealing it if it's full. The journal must be locked
+		void				AppendEdit( int aGridX, int aGridZ, unsigned int anIndex, unsigned char anOldVoxel, unsigned char aNewVoxel );
+
+		// Queues the current block for the writer thread, if it holds any edits. The journal must be locked
+		void				SealBlock();
+
+		// Hands blocks back for reuse. The journal must be locked
+		void				FreeBlocks( std::vector<Block*>& someBlocks );
+
+		// Reads back the blocks in the file, stopping at the first that's torn or corrupt, and returns the size of the
+		// valid blocks. Returns false if the file can't be read
+		bool				ReadJournal( unsigned long long& aValidSize );
+
+		// Writes the blocks to the end of the journal. A failed write is cut back off the file and the journal is
+		// compacted from memory instead, returns false if that happened
+		bool				WriteBlocks( const std::vector<Block*>& someBlocks );
+
+		// Rewrites the journal with only the edits still needed. The pending blocks are written as usual if it fails
+		bool				CompactJournal( std::vector<Block*>& somePendingBlocks, unsigned int& aWrittenSequence );
+
+		// The writer thread, writes sealed blocks until the journal is closed
+		static unsigned int	WriterThread( void* aJournal );
+
+		// Packs a voxel in to a byte: its type & whether it's enabled
+		static unsigned char EncodeVoxel( VEVoxel& aVoxel );
+
+		// Unpacks a voxel packed by EncodeVoxel
+		static void			DecodeVoxel( unsigned char aCode, VEVoxel& aVoxel );
+
+		// Orders edits by voxel index
+		static bool			CompareEditIndices( const Edit& anEdit, const Edit& anOtherEdit );
+
+		// Checksums a block's edits
+		static unsigned int	CalculateChecksum( const unsigned char* someData, unsigned int aSize );
+
+		// The journal can't be copied
+		VEEditJournal( const VEEditJournal& );
+		VEEditJournal& operator=( const VEEditJournal& );
+
+
+		// ----- Private Variables ------
+
+		std::wstring			myFilename;
+		HANDLE					myFile;
+		bool					myIsOpen;
+
+		// Everything below is guarded by the lock. The file is only touched by the writer thread once it's started
+		VEMutex					myLock;
+		VEConditionVariable		myWriterCondition;
+		VEConditionVariable		myWrittenCondition;
+		VEThread				myWriterThread;
+		bool					myIsStopping;
+		bool					myIsCompactRequested;
+		bool					myIsCompacting;
+
+		EditMap					myEdits;
+		unsigned int			myLiveEditCount;
+		unsigned int			mySequence;
+		unsigned int			myWrittenSequence;
+
+		Block*					myCurrentBlock;
+		std::vector<Block*>		mySealedBlocks;
+		std::vector<Block*>		myFreeBlocks;
+
+		unsigned long long		myFileSize;
+		unsigned int			myJournalEditCount;
+		unsigned int			myCompactionCount;
+		unsigned long long		myWrittenBytes;
+		long long				myWriteTime;
+		unsigned int			myFailedWriteCount;
+
+		unsigned int			myRecoveredEditCount;
+		unsigned long long		myDiscardedBytes;
+		long long				myRecoveryTime;
+};
+
+
+#endif // !VE_EDIT_JOURNAL_H
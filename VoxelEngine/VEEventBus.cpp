@@ -0,0 +1,214 @@
+// --------------------- Includes ---------------------
+
+#include "Stdafx.h"
+#include "VEEventBus.h"
+
+#include "VEProfiler.h"
+
+
+// ----------------- Class Functions ------------------
+
+// Construction
+VEEventBus::VEEventBus() :
+	myHead( &myStub ),
+	myTail( &myStub ),
+	myStub( EE_Max ),
+	myPostedCount( 0 ),
+	myDrainedCount( 0 ),
+	myTimerFrequency( 1 )
+{
+	LARGE_INTEGER frequency;
+	if( QueryPerformanceFrequency(&frequency) )
+	{
+		myTimerFrequency = frequency.QuadPart;
+	}
+
+	ResetStatistics();
+}
+
+
+// Deconstruction. Deletes any events that haven't been drained
+VEEventBus::~VEEventBus()
+{
+	Clear();
+}
+
+
+// Registers a function to be called on the main thread when an event of the supplied type is drained
+bool VEEventBus::RegisterHandler( unsigned int anEventType, VE_EVENT_HANDLER aHandler, LPVOID aParameter /* = NULL */ )
+{
+	if( anEventType >= VE_MAX_EVENT_TYPES || aHandler == NULL )
+	{
+		return false;
+	}
+
+	myHandlers[anEventType].push_back( EventHandler(aHandler, aParameter) );
+	return true;
+}
+
+
+// Removes a previously registered handler
+void VEEventBus::UnregisterHandler( unsigned int anEventType, VE_EVENT_HANDLER aHandler, LPVOID aParameter /* = NULL */ )
+{
+	if( anEventType >= VE_MAX_EVENT_TYPES )
+	{
+		return;
+	}
+
+	std::vector<EventHandler>& handlers = myHandlers[anEventType];
+	for( std::vector<EventHandler>::iterator iter = handlers.begin(); iter != handlers.end(); iter++ )
+	{
+		if( iter->myHandler == aHandler && iter->myParameter == aParameter )
+		{
+			handlers.erase( iter );
+			return;
+		}
+	}
+}
+
+
+// Posts an event to the bus. Safe to call from any thread
+void VEEventBus::Post( VEEvent* anEvent )
+{
+	assert( anEvent != NULL && anEvent != &myStub );
+
+	anEvent->myPostTime = GetTime();
+	myPostedCount++;
+
+	Push( anEvent );
+}
+
+
+// Dispatches queued events to their handlers until the queue is empty or the time budget has been used
+unsigned int VEEventBus::Drain( float aTimeBudget )
+{
+	VE_PROFILE_ZONE( "VEEventBus::Drain" );
+
+	long long startTime	= GetTime();
+	long long endTime	= startTime + (long long)( aTimeBudget * (float)myTimerFrequency );
+
+	unsigned int drainedCount = 0;
+	while( VEEvent* event = Pop() )
+	{
+		// Record how long the event spent in the queue
+		long long	currentTime	= GetTime();
+		long long	waitTime	= ((currentTime - event->myPostTime) * 1000000) / myTimerFrequency;
+		int			bucket		= 0;
+
+		while( waitTime > 1 && bucket < VE_EVENT_LATENCY_BUCKETS - 1 )
+		{
+			waitTime >>= 1;
+			bucket++;
+		}
+		myLatencyHistogram[bucket]++;
+
+		unsigned int eventType = event->GetType();
+		if( eventType < VE_MAX_EVENT_TYPES )
+		{
+			std::vector<EventHandler>& handlers = myHandlers[eventType];
+			for( unsigned int i = 0; i < handlers.size(); i++ )
+			{
+				handlers[i].myHandler( event, handlers[i].myParameter );
+			}
+		}
+
+		delete event;
+		drainedCount++;
+
+		// Leave anything that's left for the next frame once the budget has been used
+		if( GetTime() >= endTime )
+		{
+			break;
+		}
+	}
+
+	myDrainedCount += drainedCount;
+	return drainedCount;
+}
+
+
+// Deletes every queued event without dispatching it
+void VEEventBus::Clear()
+{
+	while( VEEvent* event = Pop() )
+	{
+		delete event;
+	}
+}
+
+
+// Clears the latency histogram and event counters
+void VEEventBus::ResetStatistics()
+{
+	myPostedCount	= 0;
+	myDrainedCount	= 0;
+
+	memset( myLatencyHistogram, 0, sizeof(myLatencyHistogram) );
+}
+
+
+// Links an event on to the head of the queue
+void VEEventBus::Push( VEEvent* anEvent )
+{
+	anEvent->myNext.store( NULL, std::memory_order_relaxed );
+
+	// Swing the head to the new event, then link the previous head to it. Until the link is made the consumer
+	// sees the queue as ending at the previous head
+	VEEvent* previous = myHead.exchange( anEvent, std::memory_order_acq_rel );
+	previous->myNext.store( anEvent, std::memory_order_release );
+}
+
+
+// Unlinks the oldest event from the tail of the queue
+VEEvent* VEEventBus::Pop()
+{
+	VEEvent* tail = myTail;
+	VEEvent* next = tail->myNext.load( std::memory_order_acquire );
+
+	// Step over the stub node
+	if( tail == &myStub )
+	{
+		if( next == NULL )
+		{
+			return NULL;
+		}
+
+		myTail	= next;
+		tail	= next;
+		next	= next->myNext.load( std::memory_order_acquire );
+	}
+
+	if( next != NULL )
+	{
+		myTail = next;
+		return tail;
+	}
+
+	// The tail is the last linked event. If it isn't also the head, a producer is mid-post
+	if( tail != myHead.load(std::memory_order_acquire) )
+	{
+		return NULL;
+	}
+
+	// Re-insert the stub behind the tail so the tail can be handed out
+	Push( &myStub );
+
+	next = tail->myNext.load( std::memory_order_acquire );
+	if( next != NULL )
+	{
+		myTail = next;
+		return tail;
+	}
+
+	return NULL;
+}
+
+
+// Returns the current value of the performance counter
+long long VEEventBus::GetTime()
+{
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter( &counter );
+
+	return counter.QuadPart;
+}
@@ -0,0 +1,165 @@
+#ifndef VE_EVENT_BUS_H
+#define VE_EVENT_BUS_H
+
+
+// --------------------- Includes --------------------
+
+#include "VETypes.h"
+
+#include <atomic>
+
+
+// --------------------- Defines ---------------------
+
+// The number of event types that handlers can be registered for
+#define VE_MAX_EVENT_TYPES			64
+
+// The time (in seconds) the engine spends dispatching events each frame
+#define VE_EVENT_FRAME_BUDGET		0.002f
+
+// The number of buckets in the post to drain latency histogram. Bucket n counts events that waited
+// between 2^n and 2^(n+1) microseconds, the last bucket counts everything slower
+#define VE_EVENT_LATENCY_BUCKETS	24
+
+
+// --------------------- Typedefs --------------------
+
+class VEEvent;
+
+typedef void (*VE_EVENT_HANDLER)( VEEvent* anEvent, LPVOID aParameter );
+
+
+// --------------------- Classes ---------------------
+
+// The base class for events posted to the event bus. Events are allocated by the posting thread and
+// ownership passes to the bus, which deletes them once they've been handled
+class VEEvent
+{
+	public :
+
+		// ------ Public Functions ------
+
+		// Construction
+		VEEvent( unsigned int anEventType ) :
+			myType( anEventType ),
+			myNext( NULL ),
+			myPostTime( 0 )
+		{
+		}
+
+		// Deconstruction
+		virtual ~VEEvent()										{}
+
+
+		// --------- Accessors ----------
+
+		unsigned int	GetType() const							{ return myType; }
+
+		// The performance counter value when the event was posted
+		long long		GetPostTime() const						{ return myPostTime; }
+
+
+	private :
+
+		friend class VEEventBus;
+
+		// ------ Private Variables ------
+
+		unsigned int			myType;
+		std::atomic<VEEvent*>	myNext;
+		long long				myPostTime;
+};
+
+
+// A lock free, multiple producer, single consumer event queue. Any thread can post events, they are only
+// dispatched to their handlers when the main thread drains the bus. Posting never blocks: it's a single
+// atomic exchange on the head of an intrusive linked list
+class VEEventBus
+{
+	public :
+
+		// ------ Public Functions ------
+
+		// Construction
+		VEEventBus();
+
+		// Deconstruction. Deletes any events that haven't been drained
+		~VEEventBus();
+
+		// Registers a function to be called on the main thread when an event of the supplied type is drained
+		bool			RegisterHandler( unsigned int anEventType, VE_EVENT_HANDLER aHandler, LPVOID aParameter = NULL );
+
+		// Removes a previously registered handler
+		void			UnregisterHandler( unsigned int anEventType, VE_EVENT_HANDLER aHandler, LPVOID aParameter = NULL );
+
+		// Posts an event to the bus. Safe to call from any thread, the bus takes ownership of the event
+		void			Post( VEEvent* anEvent );
+
+		// Dispatches queued events to their handlers until the queue is empty or the time budget (in seconds) has been
+		// used. Must only be called from one thread. Returns the number of events dispatched
+		unsigned int	Drain( float aTimeBudget );
+
+		// Deletes every queued event without dispatching it. Only safe once nothing else is posting
+		void			Clear();
+
+		// Clears the latency histogram and event counters
+		void			ResetStatistics();
+
+
+		// --------- Accessors ----------
+
+		unsigned int		GetPostedCount()						{ return myPostedCount; }
+
+		unsigned int		GetDrainedCount()						{ return myDrainedCount; }
+
+		const unsigned int*	GetLatencyHistogram()					{ return myLatencyHistogram; }
+
+
+	private :
+
+		// ------ Private Structures -----
+
+		// A registered event handler
+		struct EventHandler
+		{
+			EventHandler( VE_EVENT_HANDLER aHandler, LPVOID aParameter ) :
+				myHandler( aHandler ),
+				myParameter( aParameter )
+			{
+			}
+
+			VE_EVENT_HANDLER	myHandler;
+			LPVOID				myParameter;
+		};
+
+
+		// ------ Private Functions ------
+
+		// Links an event on to the head of the queue
+		void			Push( VEEvent* anEvent );
+
+		// Unlinks the oldest event from the tail of the queue. Returns NULL if the queue is empty, or if a producer
+		// is part way through posting the next event
+		VEEvent*		Pop();
+
+		// Returns the current value of the performance counter
+		static long long GetTime();
+
+
+		// ------ Private Variables ------
+
+		std::atomic<VEEvent*>		myHead;
+		VEEvent*					myTail;
+		VEEvent						myStub;
+
+		std::vector<EventHandler>	myHandlers[VE_MAX_EVENT_TYPES];
+
+		std::atomic<unsigned int>	myPostedCount;
+		unsigned int				myDrainedCount;
+		unsigned int				myLatencyHistogram[VE_EVENT_LATENCY_BUCKETS];
+
+		long long					myTimerFrequency;
+};
+
+
+#endif // !VE_EVENT_BUS_H
@@ -0,0 +1,121 @@
+// --------------------- Includes ---------------------
+
+#include "Stdafx.h"
+#include "VEFrameAllocator.h"
+
+
+// ------------------ Class Functions -----------------
+
+// Construction
+VEFrameAllocator::VEFrameAllocator( size_t aBufferSize ) :
+	myBufferSize( aBufferSize ),
+	myFrameIndex( 0 ),
+	myOverflowCount( 0 ),
+	myPeakUsedBytes( 0 )
+{
+	for( unsigned int i = 0; i < 2; i++ )
+	{
+		myBuffers[i].myMemory			= reinterpret_cast<unsigned char*>( _aligned_malloc(myBufferSize, VE_FRAME_ALLOCATOR_ALIGNMENT) );
+		myBuffers[i].myOffset			= 0;
+		myBuffers[i].myOverflowBlocks	= NULL;
+	}
+}
+
+
+// Deconstruction
+VEFrameAllocator::~VEFrameAllocator()
+{
+	for( unsigned int i = 0; i < 2; i++ )
+	{
+		FreeOverflow( myBuffers[i] );
+
+		_aligned_free( myBuffers[i].myMemory );
+		myBuffers[i].myMemory = NULL;
+	}
+}
+
+
+// Recycles the buffer used two frames ago and starts allocating from it
+void VEFrameAllocator::BeginFrame()
+{
+	size_t usedBytes = GetUsedBytes();
+	if( usedBytes > myPeakUsedBytes )
+	{
+		myPeakUsedBytes = usedBytes;
+	}
+
+	myFrameIndex++;
+
+	FrameBuffer& buffer = myBuffers[myFrameIndex & 1];
+
+#ifdef VE_FRAME_ALLOCATOR_CHECKS
+	// The offset keeps growing once the buffer has overflowed
+	size_t recycledBytes = buffer.myOffset < myBufferSize ? buffer.myOffset.load() : myBufferSize;
+	memset( buffer.myMemory, VE_FRAME_ALLOCATOR_FILL, recycledBytes );
+#endif
+
+	buffer.myOffset = 0;
+	FreeOverflow( buffer );
+}
+
+
+// Returns memory that's valid until the end of the next frame
+void* VEFrameAllocator::Allocate( size_t aSize, size_t anAlignment )
+{
+	assert( anAlignment > 0 && (anAlignment & (anAlignment - 1)) == 0 );
+
+	FrameBuffer& buffer = myBuffers[myFrameIndex & 1];
+
+	// Reserve enough for the worst case padding, so the offset only needs a single atomic add
+	size_t reservedSize	= aSize + anAlignment - 1;
+	size_t offset		= buffer.myOffset.fetch_add( reservedSize );
+	if( offset + reservedSize > myBufferSize )
+	{
+		return AllocateOverflow( buffer, aSize, anAlignment );
+	}
+
+	size_t address = (size_t)( buffer.myMemory + offset );
+	address = (address + anAlignment - 1) & ~(anAlignment - 1);
+
+	return (void*)address;
+}
+
+
+// Allocates memory that didn't fit in the buffer from the heap
+void* VEFrameAllocator::AllocateOverflow( FrameBuffer& aBuffer, size_t aSize, size_t anAlignment )
+{
+	myOverflowCount++;
+
+	// The block's link is kept at the start of the allocation, padded so the returned memory stays aligned
+	size_t			headerSize	= (sizeof(OverflowBlock) + anAlignment - 1) & ~(anAlignment - 1);
+	unsigned char*	memory		= reinterpret_cast<unsigned char*>( _aligned_malloc(headerSize + aSize, anAlignment) );
+	assert( memory != NULL );
+
+	OverflowBlock* block = reinterpret_cast<OverflowBlock*>( memory );
+
+	{
+		VEScopedLock<VEMutex> lock( myOverflowLock );
+
+		block->myNext				= aBuffer.myOverflowBlocks;
+		aBuffer.myOverflowBlocks	= block;
+	}
+
+	return memory + headerSize;
+}
+
+
+// Frees a buffer's overflow allocations
+void VEFrameAllocator::FreeOverflow( FrameBuffer& aBuffer )
+{
+	VEScopedLock<VEMutex> lock( myOverflowLock );
+
+	OverflowBlock* block = aBuffer.myOverflowBlocks;
+	while( block != NULL )
+	{
+		OverflowBlock* nextBlock = block->myNext;
+		_aligned_free( block );
+
+		block = nextBlock;
+	}
+	aBuffer.myOverflowBlocks = NULL;
+}
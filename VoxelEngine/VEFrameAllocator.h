@@ -0,0 +1,239 @@
+#ifndef VE_FRAME_ALLOCATOR_H
+#define VE_FRAME_ALLOCATOR_H
+
+
+// --------------------- Includes --------------------
+
+#include "VETypes.h"
+#include "VEThreading.h"
+
+#include <atomic>
+
+
+// --------------------- Defines ---------------------
+
+// The size of each of the frame allocator's two buffers. Allocations that don't fit fall back to the heap
+#define VE_FRAME_ALLOCATOR_SIZE			(1024 * 1024)
+
+// The default alignment of frame allocations
+#define VE_FRAME_ALLOCATOR_ALIGNMENT	16
+
+// Debug builds check that frame memory isn't used after it has been recycled, and fill recycled memory so stale
+// reads stand out
+#if defined(_DEBUG) && !defined(VE_FRAME_ALLOCATOR_CHECKS)
+	#define VE_FRAME_ALLOCATOR_CHECKS
+#endif
+
+// The byte recycled frame memory is filled with when checks are enabled
+#define VE_FRAME_ALLOCATOR_FILL			0xFE
+
+
+// --------------------- Classes ---------------------
+
+// A double buffered linear allocator for data that only lives for a frame or two (render lists, culling results
+// and the like). Allocating is a pointer bump and nothing is freed individually; BeginFrame, called at the start of
+// each engine update, recycles the buffer used two frames ago. Memory allocated during a frame is valid until the
+// end of the following frame, so it can be handed on to work that runs a frame behind. Safe to allocate from any thread
+class VEFrameAllocator
+{
+	public :
+
+		// ------ Public Functions ------
+
+		// Construction
+		VEFrameAllocator( size_t aBufferSize = VE_FRAME_ALLOCATOR_SIZE );
+
+		// Deconstruction
+		~VEFrameAllocator();
+
+		// Recycles the buffer used two frames ago and starts allocating from it
+		void			BeginFrame();
+
+		// Returns memory that's valid until the end of the next frame. Never returns NULL, allocations that don't fit
+		// in the frame's buffer come from the heap and are freed when the buffer is recycled
+		void*			Allocate( size_t aSize, size_t anAlignment = VE_FRAME_ALLOCATOR_ALIGNMENT );
+
+		// Whether memory allocated in the supplied frame is still valid
+		bool			IsLive( unsigned int aFrameIndex ) const	{ return aFrameIndex + 1 >= myFrameIndex; }
+
+
+		// --------- Accessors ----------
+
+		unsigned int	GetFrameIndex() const						{ return myFrameIndex; }
+
+		size_t			GetBufferSize() const						{ return myBufferSize; }
+
+		// The bytes allocated from the current frame's buffer (including alignment padding), and the most allocated in
+		// any frame. Overflow allocations count towards the used bytes
+		size_t			GetUsedBytes() const						{ return myBuffers[myFrameIndex & 1].myOffset; }
+		size_t			GetPeakUsedBytes() const					{ return myPeakUsedBytes; }
+
+		// The number of allocations that didn't fit in a buffer since the allocator was created
+		unsigned int	GetOverflowCount() const					{ return myOverflowCount; }
+
+
+	private :
+
+		// ----- Private Structures -----
+
+		// An allocation that didn't fit in a buffer, linked in to the buffer's overflow list
+		struct OverflowBlock
+		{
+			OverflowBlock*	myNext;
+		};
+
+		// One of the two buffers
+		struct FrameBuffer
+		{
+			unsigned char*		myMemory;
+			std::atomic<size_t>	myOffset;
+			OverflowBlock*		myOverflowBlocks;
+		};
+
+
+		// ------ Private Functions -----
+
+		// Allocates memory that didn't fit in the buffer from the heap
+		void*			AllocateOverflow( FrameBuffer& aBuffer, size_t aSize, size_t anAlignment );
+
+		// Frees a buffer's overflow allocations
+		void			FreeOverflow( FrameBuffer& aBuffer );
+
+
+		// ------ Private Variables -----
+
+		FrameBuffer					myBuffers[2];
+		size_t						myBufferSize;
+		unsigned int				myFrameIndex;
+
+		VEMutex						myOverflowLock;
+		std::atomic<unsigned int>	myOverflowCount;
+		size_t						myPeakUsedBytes;
+};
+
+
+// An STL allocator that allocates from a frame allocator, so containers of per-frame data don't touch the heap.
+// Deallocating does nothing, so containers should reserve what they need up front. With checks enabled it asserts
+// if a container is used after the frame it was created in has been recycled
+template <typename T>
+class VEFrameStlAllocator
+{
+	public :
+
+		// ------- STL Typedefs ---------
+
+		typedef T				value_type;
+		typedef T*				pointer;
+		typedef const T*		const_pointer;
+		typedef T&				reference;
+		typedef const T&		const_reference;
+		typedef size_t			size_type;
+		typedef ptrdiff_t		difference_type;
+
+		template <typename U>
+		struct rebind
+		{
+			typedef VEFrameStlAllocator<U> other;
+		};
+
+
+		// ------ Public Functions ------
+
+		// Construction
+		explicit VEFrameStlAllocator( VEFrameAllocator* anAllocator ) :
+			myAllocator( anAllocator ),
+			myFrameIndex( anAllocator->GetFrameIndex() )
+		{
+		}
+
+		// Conversion from an allocator of another type
+		template <typename U>
+		VEFrameStlAllocator( const VEFrameStlAllocator<U>& anOther ) :
+			myAllocator( anOther.GetAllocator() ),
+			myFrameIndex( anOther.GetFrameIndex() )
+		{
+		}
+
+		// Allocates space for a number of elements
+		pointer allocate( size_type aCount, const void* aHint = NULL )
+		{
+			CheckLive();
+			return reinterpret_cast<pointer>( myAllocator->Allocate(aCount * sizeof(T), __alignof(T) > VE_FRAME_ALLOCATOR_ALIGNMENT ? __alignof(T) : VE_FRAME_ALLOCATOR_ALIGNMENT) );
+		}
+
+		// Frame memory is recycled all at once, so there's nothing to free
+		void deallocate( pointer aPointer, size_type aCount )
+		{
+			CheckLive();
+		}
+
+		// Constructs an element in place
+		void construct( pointer aPointer, const T& aValue )
+		{
+			new( (void*)aPointer ) T( aValue );
+		}
+
+		// Destroys an element in place
+		void destroy( pointer aPointer )
+		{
+			aPointer->~T();
+		}
+
+		// Returns the address of an element
+		pointer			address( reference aValue ) const			{ return &aValue; }
+		const_pointer	address( const_reference aValue ) const		{ return &aValue; }
+
+		// The largest number of elements that could be allocated
+		size_type		max_size() const							{ return ((size_type)-1) / sizeof(T); }
+
+
+		// --------- Accessors ----------
+
+		VEFrameAllocator*	GetAllocator() const					{ return myAllocator; }
+
+		unsigned int		GetFrameIndex() const					{ return myFrameIndex; }
+
+
+	private :
+
+		// ------ Private Functions -----
+
+		// Asserts if the frame this allocator was created in has been recycled
+		void CheckLive() const
+		{
+#ifdef VE_FRAME_ALLOCATOR_CHECKS
+			assert( myAllocator->IsLive(myFrameIndex) && "Frame memory used after its frame was recycled" );
+#endif
+		}
+
+
+		// ------ Private Variables -----
+
+		VEFrameAllocator*	myAllocator;
+		unsigned int		myFrameIndex;
+};
+
+
+// Allocators compare equal when they allocate from the same frame allocator
+template <typename T, typename U>
+bool operator==( const VEFrameStlAllocator<T>& aLeft, const VEFrameStlAllocator<U>& aRight )
+{
+	return aLeft.GetAllocator() == aRight.GetAllocator();
+}
+
+template <typename T, typename U>
+bool operator!=( const VEFrameStlAllocator<T>& aLeft, const VEFrameStlAllocator<U>& aRight )
+{
+	return !( aLeft == aRight );
+}
+
+
+// Names a vector that allocates from a frame allocator, e.g. VEFrameVector<VEChunk*>::Type
+template <typename T>
+struct VEFrameVector
+{
+	typedef std::vector< T, VEFrameStlAllocator<T> > Type;
+};
+
+
+#endif // !VE_FRAME_ALLOCATOR_H
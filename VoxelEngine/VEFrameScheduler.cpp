@@ -0,0 +1,179 @@
+// --------------------- Includes ---------------------
+
+#include "Stdafx.h"
+#include "VEFrameScheduler.h"
+
+#include <math.h>
+
+#include "VEClock.h"
+#include "VEProfiler.h"
+
+
+// --------------------- Defines ----------------------
+
+// Absorbs the rounding error of adding up frame times, so a frame that's a whole number of steps long runs exactly
+// that many steps
+#define VE_FRAME_TIME_EPSILON		0.000001
+
+
+// ------------------ Class Functions -----------------
+
+// Construction, paces frames with the supplied clock. Without one, the scheduler uses the system clock
+VEFrameScheduler::VEFrameScheduler( VEClock* aClock /* NULL */ ) :
+	myClock( aClock ),
+	myOwnsClock( false ),
+	myTimeStep( 1.0 / VE_DEFAULT_SIMULATION_RATE ),
+	myFramePeriod( 1.0 / VE_DEFAULT_FRAME_RATE_CAP ),
+	myMaxSimulationSteps( VE_DEFAULT_MAX_SIMULATION_STEPS ),
+	mySpinTime( 0.0 ),
+	myFrameStart( 0.0 ),
+	myNextDeadline( 0.0 ),
+	myAccumulator( 0.0 ),
+	myFrameTime( 0.0 ),
+	mySleepTime( 0.0 ),
+	mySpinWaitTime( 0.0 ),
+	myFrameCount( 0 ),
+	mySimulationStepCount( 0 ),
+	myDroppedTime( 0.0 )
+{
+	if( myClock == NULL )
+	{
+		myClock		= new VESystemClock();
+		myOwnsClock	= true;
+	}
+
+	mySpinTime = myClock->GetWaitPrecision();
+}
+
+
+// Deconstruction
+VEFrameScheduler::~VEFrameScheduler()
+{
+	if( myOwnsClock )
+	{
+		delete myClock;
+	}
+	myClock = NULL;
+}
+
+
+// Sets the rate the simulation steps at, in steps per second
+void VEFrameScheduler::SetSimulationRate( double aRate )
+{
+	assert( aRate > 0.0 );
+	myTimeStep = 1.0 / aRate;
+}
+
+
+// Sets the most frames run per second, zero leaves the frame rate uncapped
+void VEFrameScheduler::SetFrameRateCap( double aRate )
+{
+	myFramePeriod = aRate > 0.0 ? 1.0 / aRate : 0.0;
+}
+
+
+// Starts timing from now, the first frame begins straight away
+void VEFrameScheduler::Start()
+{
+	myFrameStart			= myClock->GetTime();
+	myNextDeadline			= myFrameStart;
+	myAccumulator			= 0.0;
+
+	myFrameTime				= 0.0;
+	mySleepTime				= 0.0;
+	mySpinWaitTime			= 0.0;
+
+	myFrameCount			= 0;
+	mySimulationStepCount	= 0;
+	myDroppedTime			= 0.0;
+}
+
+
+// Waits until the next frame is due, then returns the number of simulation steps to run in it
+unsigned int VEFrameScheduler::BeginFrame()
+{
+	VE_PROFILE_ZONE( "VEFrameScheduler::BeginFrame" );
+
+	mySleepTime		= 0.0;
+	mySpinWaitTime	= 0.0;
+
+	double frameStart = myClock->GetTime();
+
+	if( myFramePeriod > 0.0 )
+	{
+		if( frameStart < myNextDeadline )
+		{
+			WaitUntil( myNextDeadline );
+
+			// Frames that waited start on their deadline, so the simulation sees exactly the frame period however late
+			// the wait finished
+			frameStart = myNextDeadline;
+		}
+
+		// A frame more than a period late has missed its slot. The next frame is due a period from now, rather than
+		// running frames back to back to catch up
+		myNextDeadline += myFramePeriod;
+		if( myNextDeadline <= frameStart )
+		{
+			myNextDeadline = frameStart + myFramePeriod;
+		}
+	}
+
+	myFrameTime		= frameStart - myFrameStart;
+	myFrameStart	= frameStart;
+	myFrameCount++;
+
+	// Accumulate the frame's time, and step the simulation by as much of it as fits
+	myAccumulator += myFrameTime;
+
+	unsigned int stepCount = (unsigned int)( (myAccumulator + VE_FRAME_TIME_EPSILON) / myTimeStep );
+	if( stepCount > myMaxSimulationSteps )
+	{
+		stepCount = myMaxSimulationSteps;
+	}
+
+	myAccumulator -= (double)stepCount * myTimeStep;
+	if( myAccumulator < 0.0 )
+	{
+		myAccumulator = 0.0;
+	}
+
+	// Keep the time left over after a clamped frame's last step, and drop the rest
+	if( myAccumulator >= myTimeStep )
+	{
+		double remainder = fmod( myAccumulator, myTimeStep );
+
+		myDroppedTime += myAccumulator - remainder;
+		myAccumulator = remainder;
+	}
+
+	mySimulationStepCount += stepCount;
+
+	return stepCount;
+}
+
+
+// Sleeps then spins until the deadline
+void VEFrameScheduler::WaitUntil( double aDeadline )
+{
+	double currentTime = myClock->GetTime();
+
+	// Sleep through most of the wait, the clock can wake up to the spin time late
+	if( aDeadline - currentTime > mySpinTime )
+	{
+		myClock->Wait( aDeadline - currentTime - mySpinTime );
+
+		double wakeTime = myClock->GetTime();
+		mySleepTime = wakeTime - currentTime;
+		currentTime = wakeTime;
+	}
+
+	// Spin through the rest
+	double spinStart = currentTime;
+	while( currentTime < aDeadline )
+	{
+		myClock->Pause();
+		currentTime = myClock->GetTime();
+	}
+	mySpinWaitTime = currentTime - spinStart;
+}
@@ -0,0 +1,122 @@
+#ifndef VE_FRAME_SCHEDULER_H
+#define VE_FRAME_SCHEDULER_H
+
+
+// --------------------- Includes --------------------
+
+#include "VETypes.h"
+
+
+// ---------------- Forward Declarations -------------
+
+class VEClock;
+
+
+// --------------------- Defines ---------------------
+
+// The default simulation rate & frame rate cap, in frames per second
+#define VE_DEFAULT_SIMULATION_RATE		60.0
+#define VE_DEFAULT_FRAME_RATE_CAP		60.0
+
+// The most simulation steps run in one frame by default. After a longer stall the excess time is dropped, rather than
+// spending the next frames catching up
+#define VE_DEFAULT_MAX_SIMULATION_STEPS	5
+
+
+// --------------------- Classes ---------------------
+
+// Paces the game loop. The simulation advances in fixed time steps, accumulated from the real time that passes, while
+// frames run at up to the frame rate cap. Between frames the scheduler sleeps until just before the next frame's
+// deadline, then spins for the rest, so a capped loop only uses the CPU the frames need. Deadlines are a fixed period
+// apart, so oversleeping one frame shortens the wait for the next rather than drifting
+class VEFrameScheduler
+{
+	public :
+
+		// ------ Public Functions ------
+
+		// Construction, paces frames with the supplied clock. Without one, the scheduler uses the system clock
+		VEFrameScheduler( VEClock* aClock = NULL );
+
+		// Deconstruction
+		~VEFrameScheduler();
+
+		// Sets the rate the simulation steps at, in steps per second
+		void					SetSimulationRate( double aRate );
+
+		// Sets the most frames run per second, zero leaves the frame rate uncapped
+		void					SetFrameRateCap( double aRate );
+
+		// Starts timing from now, the first frame begins straight away
+		void					Start();
+
+		// Waits until the next frame is due, then returns the number of simulation steps to run in it. Uncapped
+		// frames don't wait
+		unsigned int			BeginFrame();
+
+
+		// --------- Accessors ----------
+
+		double					GetTimeStep()							{ return myTimeStep; }
+		double					GetFramePeriod()						{ return myFramePeriod; }
+
+		void					SetMaxSimulationSteps( unsigned int aCount ) { myMaxSimulationSteps = aCount; }
+		unsigned int			GetMaxSimulationSteps()					{ return myMaxSimulationSteps; }
+
+		// How long before each deadline the scheduler stops sleeping and starts spinning. Defaults to the clock's wait
+		// precision, lower values use less CPU but can miss deadlines
+		void					SetSpinTime( double aSeconds )			{ mySpinTime = aSeconds; }
+		double					GetSpinTime()							{ return mySpinTime; }
+
+		// How far the simulation is between the last step and the next, from 0 to 1, for interpolating what's drawn
+		double					GetInterpolation()						{ return myAccumulator / myTimeStep; }
+
+		// The time between the start of the last frame & the one before, and how long the last frame slept & spun
+		// waiting for its deadline
+		double					GetFrameTime()							{ return myFrameTime; }
+		double					GetSleepTime()							{ return mySleepTime; }
+		double					GetSpinWaitTime()						{ return mySpinWaitTime; }
+
+		// Totals since Start
+		unsigned int			GetFrameCount()							{ return myFrameCount; }
+		unsigned int			GetSimulationStepCount()				{ return mySimulationStepCount; }
+		double					GetDroppedTime()						{ return myDroppedTime; }
+
+
+	private :
+
+		// ----- Private Functions ------
+
+		// Sleeps then spins until the deadline
+		void					WaitUntil( double aDeadline );
+
+		// The scheduler can't be copied
+		VEFrameScheduler( const VEFrameScheduler& );
+		VEFrameScheduler& operator=( const VEFrameScheduler& );
+
+
+		// ----- Private Variables ------
+
+		VEClock*				myClock;
+		bool					myOwnsClock;
+
+		double					myTimeStep;
+		double					myFramePeriod;
+		unsigned int			myMaxSimulationSteps;
+		double					mySpinTime;
+
+		double					myFrameStart;
+		double					myNextDeadline;
+		double					myAccumulator;
+
+		double					myFrameTime;
+		double					mySleepTime;
+		double					mySpinWaitTime;
+
+		unsigned int			myFrameCount;
+		unsigned int			mySimulationStepCount;
+		double					myDroppedTime;
+};
+
+
+#endif // !VE_FRAME_SCHEDULER_H
@@ -0,0 +1,96 @@
+// ----------------------- Includes -----------------------
+
+#include "Stdafx.h"
+#include "VEHLSLCompiler.h"
+
+
+// -------------------- Class Functions -------------------
+
+// Compiles a request, filling in the errors if it fails. The D3D compiler's standard include handler opens includes
+// relative to the including file
+bool VEHLSLCompiler::Compile( const VEShaderRequest& aRequest, const std::string& aSource, std::vector<unsigned char>& someBytecode,
+							  std::string& someErrors )
+{
+	// Split the defines in to names & values first, the macros point in to them
+	std::vector<std::string> names;
+	std::vector<std::string> values;
+
+	size_t start = 0;
+	while( start < aRequest.myDefines.size() )
+	{
+		size_t end = aRequest.myDefines.find( ';', start );
+		if( end == std::string::npos )
+		{
+			end = aRequest.myDefines.size();
+		}
+
+		std::string	define	= aRequest.myDefines.substr( start, end - start );
+		size_t		equals	= define.find( '=' );
+		if( !define.empty() )
+		{
+			names.push_back( define.substr(0, equals) );
+			values.push_back( equals == std::string::npos ? "1" : define.substr(equals + 1) );
+		}
+
+		start = end + 1;
+	}
+
+	std::vector<D3D_SHADER_MACRO> macros( names.size() + 1 );
+	for( unsigned int i = 0; i < names.size(); i++ )
+	{
+		macros[i].Name			= names[i].c_str();
+		macros[i].Definition	= values[i].c_str();
+	}
+	macros[names.size()].Name		= NULL;
+	macros[names.size()].Definition	= NULL;
+
+	std::string	sourceName( aRequest.myFile.begin(), aRequest.myFile.end() );
+	ID3D10Blob*	shaderBuffer	= NULL;
+	ID3D10Blob*	errorMessage	= NULL;
+
+	HRESULT result = D3DCompile(
+			aSource.c_str(),
+			aSource.size(),
+			sourceName.c_str(),
+			&macros[0],
+			D3D_COMPILE_STANDARD_FILE_INCLUDE,
+			aRequest.myFunction.c_str(),
+			aRequest.myProfile.c_str(),
+			aRequest.myFlags,
+			0,
+			&shaderBuffer,
+			&errorMessage );
+
+	if( errorMessage != NULL )
+	{
+		someErrors.assign( (const char*)errorMessage->GetBufferPointer(), errorMessage->GetBufferSize() );
+
+		errorMessage->Release();
+		errorMessage = NULL;
+	}
+
+	if( FAILED(result) || shaderBuffer == NULL )
+	{
+		if( shaderBuffer != NULL )
+		{
+			shaderBuffer->Release();
+		}
+
+		return false;
+	}
+
+	const unsigned char* bytecode = (const unsigned char*)shaderBuffer->GetBufferPointer();
+	someBytecode.assign( bytecode, bytecode + shaderBuffer->GetBufferSize() );
+
+	shaderBuffer->Release();
+	shaderBuffer = NULL;
+
+	return true;
+}
+
+
+// The version of the D3D compiler
+unsigned int VEHLSLCompiler::GetVersion()
+{
+	return D3D_COMPILER_VERSION;
+}
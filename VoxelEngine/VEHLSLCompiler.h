@@ -0,0 +1,37 @@
+#ifndef VE_HLSL_COMPILER_H
+#define VE_HLSL_COMPILER_H
+
+
+// ----------------------- Includes -----------------------
+
+#include "VEShaderCache.h"
+
+
+// ----------------------- Classes ------------------------
+
+// Compiles shader requests with the D3D compiler, the shader manager's compiler for its shader cache
+class VEHLSLCompiler
+{
+	public :
+
+		// ------- Public Functions -------
+
+		// Compiles a request, filling in the errors if it fails. Includes are opened relative to the including file, the
+		// same files the shader cache hashes
+		static bool			Compile( const VEShaderRequest& aRequest, const std::string& aSource, std::vector<unsigned char>& someBytecode,
+									 std::string& someErrors );
+
+		// The version of the D3D compiler, mixed in to the shader cache's keys
+		static unsigned int	GetVersion();
+
+
+	private :
+
+		// ------- Private Functions ------
+
+		// The compiler only has static functions
+		VEHLSLCompiler();
+};
+
+
+#endif // !VE_HLSL_COMPILER_H
@@ -0,0 +1,75 @@
+// --------------------- Includes ---------------------
+
+#include "Stdafx.h"
+#include "VEInputReplay.h"
+
+
+// ------------------ Class Functions -----------------
+
+// Construction
+VEInputReplay::VEInputReplay() :
+	myNextEvent( 0 ),
+	myLastUpdate( 0 ),
+	mySample( 0 )
+{
+}
+
+
+// Adds an event to play back, events must be added in the order they're played
+void VEInputReplay::AddEvent( unsigned int anUpdate, unsigned int aSample, InputEventType aType, unsigned int aKey, long aMouseX /* 0 */, long aMouseY /* 0 */ )
+{
+	assert( myEvents.empty() || myEvents.back().myUpdate < anUpdate || (myEvents.back().myUpdate == anUpdate && myEvents.back().mySample <= aSample) );
+
+	ReplayEvent replayEvent;
+	replayEvent.myUpdate			= anUpdate;
+	replayEvent.mySample			= aSample;
+	replayEvent.myEvent.myType		= aType;
+	replayEvent.myEvent.myKey		= aKey;
+	replayEvent.myEvent.myMouseX	= aMouseX;
+	replayEvent.myEvent.myMouseY	= aMouseY;
+	replayEvent.myEvent.myTime		= 0;
+
+	myEvents.push_back( replayEvent );
+}
+
+
+// Starts playing back from the first event
+void VEInputReplay::Reset()
+{
+	myNextEvent		= 0;
+	myLastUpdate	= 0;
+	mySample		= 0;
+}
+
+
+// The input source, pass the replay as the source parameter
+void VEInputReplay::Poll( VEInputService* anInputService, void* aReplay )
+{
+	VEInputReplay* replay = reinterpret_cast<VEInputReplay*>( aReplay );
+	assert( replay != NULL );
+
+	// Work out which sample of the current update this is
+	unsigned int currentUpdate = anInputService->GetUpdateCount();
+	if( currentUpdate != replay->myLastUpdate )
+	{
+		replay->myLastUpdate	= currentUpdate;
+		replay->mySample		= 0;
+	}
+	else
+	{
+		replay->mySample++;
+	}
+
+	// Play every event that's due
+	while( replay->myNextEvent < replay->myEvents.size() )
+	{
+		const ReplayEvent& replayEvent = replay->myEvents[replay->myNextEvent];
+		if( replayEvent.myUpdate > currentUpdate || (replayEvent.myUpdate == currentUpdate && replayEvent.mySample > replay->mySample) )
+		{
+			break;
+		}
+
+		anInputService->PushEvent( replayEvent.myEvent.myType, replayEvent.myEvent.myKey, replayEvent.myEvent.myMouseX, replayEvent.myEvent.myMouseY );
+		replay->myNextEvent++;
+	}
+}
@@ -0,0 +1,63 @@
+#ifndef VE_INPUT_REPLAY_H
+#define VE_INPUT_REPLAY_H
+
+
+// --------------------- Includes --------------------
+
+#include "VETypes.h"
+#include "VEInputService.h"
+
+
+// --------------------- Classes ---------------------
+
+// An input source that plays back scripted events, so input can be driven without a device. Each event is pushed
+// by a given sample of a given update: an update's first sample is its own poll, later samples are the late latches
+// of the frame it draws. Events are played in the order they were added, once their sample has been reached
+class VEInputReplay
+{
+	public :
+
+		// ------ Public Functions ------
+
+		// Construction
+		VEInputReplay();
+
+		// Adds an event to play back, events must be added in the order they're played
+		void				AddEvent( unsigned int anUpdate, unsigned int aSample, InputEventType aType, unsigned int aKey, long aMouseX = 0, long aMouseY = 0 );
+
+		// Starts playing back from the first event
+		void				Reset();
+
+		// The input source, pass the replay as the source parameter
+		static void			Poll( VEInputService* anInputService, void* aReplay );
+
+
+		// --------- Accessors ----------
+
+		// Whether every event has been played
+		bool				GetIsFinished()						{ return myNextEvent == myEvents.size(); }
+
+
+	private :
+
+		// ----- Private Structures -----
+
+		struct ReplayEvent
+		{
+			unsigned int	myUpdate;
+			unsigned int	mySample;
+			VEInputEvent	myEvent;
+		};
+
+
+		// ----- Private Variables ------
+
+		std::vector<ReplayEvent>	myEvents;
+		unsigned int				myNextEvent;
+
+		unsigned int				myLastUpdate;
+		unsigned int				mySample;
+};
+
+
+#endif // !VE_INPUT_REPLAY_H
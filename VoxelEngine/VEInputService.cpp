@@ -0,0 +1,228 @@
+// --------------------- Includes ---------------------
+
+#include "Stdafx.h"
+#include "VEInputService.h"
+
+#include "VEBasicCamera.h"
+#include "VEProfiler.h"
+
+
+// ------------------ Class Functions -----------------
+
+// Construction
+VEInputService::VEInputService() :
+	mySource( NULL ),
+	mySourceParameter( NULL ),
+	myLateLatch( NULL ),
+	myLateLatchParameter( NULL ),
+	myQueueStart( 0 ),
+	myQueueCount( 0 ),
+	myDroppedEventCount( 0 ),
+	myReceivedMouseX( 0 ),
+	myReceivedMouseY( 0 ),
+	myDispatchedMouseX( 0 ),
+	myDispatchedMouseY( 0 ),
+	myPollTime( 0 ),
+	myUpdateCount( 0 ),
+	mySampleTime( 0 )
+{
+	memset( myKeyStates, 0, sizeof(myKeyStates) );
+}
+
+
+// Deconstruction
+VEInputService::~VEInputService()
+{
+}
+
+
+// Sets the source polled for input, NULL for none. Sources are only polled from the main thread
+void VEInputService::SetSource( VEInputSource aSource, void* aParameter )
+{
+	VEScopedLock<VEMutex> lock( myPollLock );
+
+	mySource			= aSource;
+	mySourceParameter	= aParameter;
+}
+
+
+// Adds a function that receives every input event
+void VEInputService::AddListener( VEInputListener aListener, void* aParameter )
+{
+	assert( aListener != NULL );
+
+	Listener listener;
+	listener.myFunction		= aListener;
+	listener.myParameter	= aParameter;
+
+	myListeners.push_back( listener );
+}
+
+
+// Removes a listener added with the same function & parameter
+void VEInputService::RemoveListener( VEInputListener aListener, void* aParameter )
+{
+	for( std::vector<Listener>::iterator iter = myListeners.begin(); iter != myListeners.end(); iter++ )
+	{
+		if( iter->myFunction == aListener && iter->myParameter == aParameter )
+		{
+			myListeners.erase( iter );
+			return;
+		}
+	}
+}
+
+
+// Sets the function that applies late latched mouse movement to the camera, NULL turns late latching off
+void VEInputService::SetLateLatch( VELateLatchFunction aFunction, void* aParameter )
+{
+	myLateLatch				= aFunction;
+	myLateLatchParameter	= aParameter;
+}
+
+
+// Timestamps an event and queues it for the next update
+void VEInputService::PushEvent( InputEventType aType, unsigned int aKey, long aMouseX /* 0 */, long aMouseY /* 0 */ )
+{
+	long long currentTime = VEProfiler::GetTime();
+
+	VEScopedLock<VEMutex> lock( myQueueLock );
+
+	if( aType == IE_MouseMove )
+	{
+		myReceivedMouseX += aMouseX;
+		myReceivedMouseY += aMouseY;
+
+		// Consecutive mouse moves are merged, keeping the newest time
+		if( myQueueCount > 0 )
+		{
+			VEInputEvent& lastEvent = myQueue[(myQueueStart + myQueueCount - 1) % VE_INPUT_QUEUE_SIZE];
+			if( lastEvent.myType == IE_MouseMove )
+			{
+				lastEvent.myMouseX	+= aMouseX;
+				lastEvent.myMouseY	+= aMouseY;
+				lastEvent.myTime	= currentTime;
+				return;
+			}
+		}
+	}
+
+	if( myQueueCount == VE_INPUT_QUEUE_SIZE )
+	{
+		myDroppedEventCount++;
+		return;
+	}
+
+	VEInputEvent& newEvent = myQueue[(myQueueStart + myQueueCount) % VE_INPUT_QUEUE_SIZE];
+	newEvent.myType		= aType;
+	newEvent.myKey		= aKey;
+	newEvent.myMouseX	= aMouseX;
+	newEvent.myMouseY	= aMouseY;
+	newEvent.myTime		= currentTime;
+
+	myQueueCount++;
+}
+
+
+// Polls the source, then delivers every queued event to the listeners
+void VEInputService::Update()
+{
+	VE_PROFILE_ZONE( "VEInputService::Update" );
+
+	myUpdateCount++;
+
+	Poll();
+
+	// Take the queued events, so listeners run without the lock held and sources can push while they do
+	unsigned int eventCount = 0;
+	{
+		VEScopedLock<VEMutex> lock( myQueueLock );
+
+		for( ; eventCount < myQueueCount; eventCount++ )
+		{
+			myDispatchEvents[eventCount] = myQueue[(myQueueStart + eventCount) % VE_INPUT_QUEUE_SIZE];
+		}
+
+		myQueueStart	= 0;
+		myQueueCount	= 0;
+		mySampleTime	= myPollTime;
+	}
+
+	for( unsigned int i = 0; i < eventCount; i++ )
+	{
+		const VEInputEvent& inputEvent = myDispatchEvents[i];
+		switch( inputEvent.myType )
+		{
+			case IE_KeyDown :
+			case IE_KeyUp :
+				if( inputEvent.myKey < VE_INPUT_KEY_COUNT )
+				{
+					myKeyStates[inputEvent.myKey] = inputEvent.myType == IE_KeyDown;
+				}
+				break;
+
+			case IE_MouseMove :
+				myDispatchedMouseX += inputEvent.myMouseX;
+				myDispatchedMouseY += inputEvent.myMouseY;
+				break;
+
+			default :
+				break;
+		}
+
+		for( unsigned int j = 0; j < myListeners.size(); j++ )
+		{
+			myListeners[j].myFunction( inputEvent, myListeners[j].myParameter );
+		}
+	}
+}
+
+
+// Applies the mouse movement received since the supplied totals were dispatched to the camera
+long long VEInputService::LateLatch( VEBasicCamera& aCamera, long aDispatchedMouseX, long aDispatchedMouseY, bool isPolling )
+{
+	if( myLateLatch == NULL )
+	{
+		return 0;
+	}
+
+	VE_PROFILE_ZONE( "VEInputService::LateLatch" );
+
+	if( isPolling )
+	{
+		Poll();
+	}
+
+	long		mouseX;
+	long		mouseY;
+	long long	pollTime;
+	{
+		VEScopedLock<VEMutex> lock( myQueueLock );
+
+		mouseX		= myReceivedMouseX - aDispatchedMouseX;
+		mouseY		= myReceivedMouseY - aDispatchedMouseY;
+		pollTime	= myPollTime;
+	}
+
+	myLateLatch( aCamera, mouseX, mouseY, myLateLatchParameter );
+
+	return pollTime;
+}
+
+
+// Polls the source, one thread at a time
+void VEInputService::Poll()
+{
+	VEScopedLock<VEMutex> lock( myPollLock );
+
+	if( mySource != NULL )
+	{
+		mySource( this, mySourceParameter );
+	}
+
+	long long pollTime = VEProfiler::GetTime();
+	{
+		VEScopedLock<VEMutex> queueLock( myQueueLock );
+		myPollTime = pollTime;
+	}
+}
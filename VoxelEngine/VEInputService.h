@@ -0,0 +1,169 @@
+#ifndef VE_INPUT_SERVICE_H
+#define VE_INPUT_SERVICE_H
+
+
+// --------------------- Includes --------------------
+
+#include "VETypes.h"
+#include "VEThreading.h"
+
+
+// ---------------- Forward Declarations -------------
+
+class VEInputService;
+class VEBasicCamera;
+
+
+// --------------------- Defines ---------------------
+
+// The number of events that can be waiting for the next update. Mouse moves are merged while they wait, so this
+// only fills up if hundreds of keys change in one frame
+#define VE_INPUT_QUEUE_SIZE		256
+
+// The number of keys tracked, DirectInput's scan codes
+#define VE_INPUT_KEY_COUNT		256
+
+
+// --------------------- Structures ------------------
+
+// A raw input event, stamped with the performance counter value when its device was polled. Keys are DirectInput
+// scan codes, mouse moves are relative counts
+struct VEInputEvent
+{
+	InputEventType	myType;
+	unsigned int	myKey;
+	long			myMouseX;
+	long			myMouseY;
+	long long		myTime;
+};
+
+
+// --------------------- Typedefs --------------------
+
+// Polls a device (or a replay), pushing an event on to the input service for each change since the last poll
+typedef void (*VEInputSource)( VEInputService* anInputService, void* aSource );
+
+// Receives each input event, during the update it's delivered in
+typedef void (*VEInputListener)( const VEInputEvent& anEvent, void* aListener );
+
+// Turns a copy of the camera by mouse movement the simulation hasn't seen yet, see VEBasicCamera::RotateView
+typedef void (*VELateLatchFunction)( VEBasicCamera& aCamera, long aMouseX, long aMouseY, void* aParameter );
+
+
+// --------------------- Classes ---------------------
+
+// Timestamps raw input and delivers it to the game. Each update polls the input source and hands every event that
+// arrived since the last update to the listeners, in order. The update is the first task in the frame, so messages
+// listeners send to components are processed in the same frame.
+//
+// Mouse looks can also be late latched: just before a frame's view matrix is used, the mouse movement that arrived
+// after the frame was simulated is applied to the frame's copy of the camera. The simulation still receives that
+// movement in its next update
+class VEInputService
+{
+	public :
+
+		// ------ Public Functions ------
+
+		// Construction
+		VEInputService();
+
+		// Deconstruction
+		~VEInputService();
+
+		// Sets the source polled for input, NULL for none. Sources are only polled from the main thread
+		void				SetSource( VEInputSource aSource, void* aParameter );
+
+		// Adds a function that receives every input event
+		void				AddListener( VEInputListener aListener, void* aParameter );
+
+		// Removes a listener added with the same function & parameter
+		void				RemoveListener( VEInputListener aListener, void* aParameter );
+
+		// Sets the function that applies late latched mouse movement to the camera, NULL turns late latching off
+		void				SetLateLatch( VELateLatchFunction aFunction, void* aParameter );
+
+		// Timestamps an event and queues it for the next update. Can be called from any thread
+		void				PushEvent( InputEventType aType, unsigned int aKey, long aMouseX = 0, long aMouseY = 0 );
+
+		// Polls the source, then delivers every queued event to the listeners
+		void				Update();
+
+		// Applies the mouse movement received since the supplied totals were dispatched to the camera. Only polls the
+		// source if asked to, which must be on the main thread. Returns the time the input used was polled, or zero
+		// if there's no late latch
+		long long			LateLatch( VEBasicCamera& aCamera, long aDispatchedMouseX, long aDispatchedMouseY, bool isPolling );
+
+
+		// --------- Accessors ----------
+
+		// Whether a key was down as of the last update
+		bool				IsKeyDown( unsigned int aKey )		{ return aKey < VE_INPUT_KEY_COUNT && myKeyStates[aKey]; }
+
+		// The total mouse movement delivered to the listeners so far
+		long				GetDispatchedMouseX()				{ return myDispatchedMouseX; }
+		long				GetDispatchedMouseY()				{ return myDispatchedMouseY; }
+
+		// The number of updates run, and when the last one polled the source
+		unsigned int		GetUpdateCount()					{ return myUpdateCount; }
+		long long			GetSampleTime()						{ return mySampleTime; }
+
+		// The number of events dropped because the queue was full
+		unsigned int		GetDroppedEventCount()				{ return myDroppedEventCount; }
+
+
+	private :
+
+		// ----- Private Structures -----
+
+		struct Listener
+		{
+			VEInputListener	myFunction;
+			void*			myParameter;
+		};
+
+
+		// ----- Private Functions ------
+
+		// Polls the source, one thread at a time
+		void				Poll();
+
+		// The service can't be copied
+		VEInputService( const VEInputService& );
+		VEInputService& operator=( const VEInputService& );
+
+
+		// ----- Private Variables ------
+
+		VEInputSource			mySource;
+		void*					mySourceParameter;
+		VEMutex					myPollLock;
+
+		std::vector<Listener>	myListeners;
+
+		VELateLatchFunction		myLateLatch;
+		void*					myLateLatchParameter;
+
+		// Events waiting for the next update, in a ring, and the events being delivered by the current one
+		VEMutex					myQueueLock;
+		VEInputEvent			myQueue[VE_INPUT_QUEUE_SIZE];
+		unsigned int			myQueueStart;
+		unsigned int			myQueueCount;
+		VEInputEvent			myDispatchEvents[VE_INPUT_QUEUE_SIZE];
+		unsigned int			myDroppedEventCount;
+
+		// The mouse movement pushed and delivered so far, and when the source was last polled. Pushed totals & the
+		// poll time are guarded by the queue lock
+		long					myReceivedMouseX;
+		long					myReceivedMouseY;
+		long					myDispatchedMouseX;
+		long					myDispatchedMouseY;
+		long long				myPollTime;
+
+		bool					myKeyStates[VE_INPUT_KEY_COUNT];
+		unsigned int			myUpdateCount;
+		long long				mySampleTime;
+};
+
+
+#endif // !VE_INPUT_SERVICE_H
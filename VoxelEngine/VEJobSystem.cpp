@@ -0,0 +1,206 @@
+// ---------------------- Includes ----------------------
+
+// Built without the precompiled header, so the job system doesn't need the Windows SDK on other platforms
+#include "VEJobSystem.h"
+
+#include "VEPoolAllocator.h"
+#include "VEProfiler.h"
+
+#include <cassert>
+
+
+// ------------------- Class Functions ------------------
+
+// Construction
+VEJobSystem::VEJobSystem() :
+	myFirstJob( 0 ),
+	myJobCount( 0 ),
+	myStopping( false )
+{
+}
+
+
+// Starts the worker threads
+bool VEJobSystem::Initialise( unsigned int aWorkerCount /* = 0 */ )
+{
+	if( aWorkerCount == 0 )
+	{
+		unsigned int hardwareThreads = VEThread::GetHardwareThreadCount();
+		aWorkerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+	}
+
+	myStopping = false;
+
+	for( unsigned int i = 0; i < aWorkerCount; i++ )
+	{
+		VEThread* worker = new VEThread();
+		if( !worker->Start(VEJobSystem::WorkerThread, this) )
+		{
+			delete worker;
+			return false;
+		}
+
+		myWorkers.push_back( worker );
+	}
+
+	return true;
+}
+
+
+// Runs any jobs still queued, then stops & joins the worker threads
+void VEJobSystem::Uninitialise()
+{
+	while( RunPendingJob() )
+	{
+	}
+
+	{
+		VEScopedLock<VEMutex> lock( myLock );
+		myStopping = true;
+	}
+	myJobAvailable.NotifyAll();
+
+	for( unsigned int i = 0; i < myWorkers.size(); i++ )
+	{
+		myWorkers[i]->Join();
+
+		delete myWorkers[i];
+		myWorkers[i] = NULL;
+	}
+	myWorkers.clear();
+}
+
+
+// Queues a job
+void VEJobSystem::Submit( VEJobFunction aFunction, void* aParameter, VEJobCounter* aCounter /* = NULL */ )
+{
+	assert( aFunction != NULL );
+
+	Job job;
+	job.myFunction	= aFunction;
+	job.myParameter	= aParameter;
+	job.myCounter	= aCounter;
+
+	if( aCounter != NULL )
+	{
+		aCounter->myCount++;
+	}
+
+	// Without workers, or with a full queue, the job runs straight away rather than growing the queue
+	bool queued = false;
+	if( !myWorkers.empty() )
+	{
+		VEScopedLock<VEMutex> lock( myLock );
+
+		if( myJobCount < VE_JOB_QUEUE_SIZE )
+		{
+			myJobs[(myFirstJob + myJobCount) % VE_JOB_QUEUE_SIZE] = job;
+			myJobCount++;
+			queued = true;
+		}
+	}
+
+	if( queued )
+	{
+		myJobAvailable.NotifyOne();
+	}
+	else
+	{
+		RunJob( job );
+	}
+}
+
+
+// Runs one queued job on the calling thread, returns false if the queue was empty
+bool VEJobSystem::RunPendingJob()
+{
+	Job job;
+	{
+		VEScopedLock<VEMutex> lock( myLock );
+
+		if( myJobCount == 0 )
+		{
+			return false;
+		}
+
+		job = PopJob();
+	}
+
+	RunJob( job );
+	return true;
+}
+
+
+// Blocks until every job counted by the counter has finished, running queued jobs while it waits
+void VEJobSystem::Wait( VEJobCounter& aCounter )
+{
+	while( !aCounter.IsDone() )
+	{
+		if( !RunPendingJob() )
+		{
+			VEThread::YieldThread();
+		}
+	}
+}
+
+
+// Takes the job at the front of the queue, the lock must be held
+VEJobSystem::Job VEJobSystem::PopJob()
+{
+	assert( myJobCount > 0 );
+
+	Job job = myJobs[myFirstJob];
+
+	myFirstJob = (myFirstJob + 1) % VE_JOB_QUEUE_SIZE;
+	myJobCount--;
+
+	return job;
+}
+
+
+// Runs a job and marks it finished
+void VEJobSystem::RunJob( const Job& aJob )
+{
+	aJob.myFunction( aJob.myParameter );
+
+	if( aJob.myCounter != NULL )
+	{
+		aJob.myCounter->myCount--;
+	}
+}
+
+
+// Runs queued jobs until the job system is stopped
+unsigned int VEJobSystem::WorkerThread( void* aJobSystem )
+{
+	VEJobSystem* jobSystem = reinterpret_cast<VEJobSystem*>( aJobSystem );
+	assert( jobSystem != NULL );
+
+	for( ;; )
+	{
+		Job job;
+		{
+			VEScopedLock<VEMutex> lock( jobSystem->myLock );
+
+			while( jobSystem->myJobCount == 0 && !jobSystem->myStopping )
+			{
+				jobSystem->myJobAvailable.Wait( jobSystem->myLock );
+			}
+
+			if( jobSystem->myJobCount == 0 )
+			{
+				break;
+			}
+
+			job = jobSystem->PopJob();
+		}
+
+		RunJob( job );
+	}
+
+	// Hand the profiler buffer & the thread's pooled blocks back before the thread exits
+	VEPoolAllocator::ReleaseThreadCaches();
+	VE_PROFILE_THREAD_END();
+
+	return 0;
+}
@@ -0,0 +1,122 @@
+#ifndef VE_JOB_SYSTEM_H
+#define VE_JOB_SYSTEM_H
+
+
+// ---------------------- Includes ---------------------
+
+#include "VEThreading.h"
+
+#include <cstddef>
+#include <vector>
+
+
+// ---------------------- Defines ----------------------
+
+// The number of jobs that can be queued at once. Jobs submitted while the queue is full run on the submitting thread
+#define VE_JOB_QUEUE_SIZE		1024
+
+
+// ---------------------- Typedefs ---------------------
+
+// A function run by the job system
+typedef void (*VEJobFunction)( void* aParameter );
+
+
+// ---------------------- Classes ----------------------
+
+// Counts the jobs in a group that haven't finished yet, so a thread can wait for the group
+class VEJobCounter
+{
+	friend class VEJobSystem;
+
+	public :
+
+		// Construction
+		VEJobCounter() : myCount( 0 )	{}
+
+		// Whether every job in the group has finished
+		bool				IsDone() const	{ return myCount == 0; }
+
+
+	private :
+
+		std::atomic<int>	myCount;
+};
+
+
+// Runs short jobs on a fixed set of worker threads, started once when the engine initialises. Unlike the thread
+// manager nothing is created per job, and queueing a job doesn't allocate. Threads waiting for jobs to finish run
+// queued jobs themselves rather than sleeping
+class VEJobSystem
+{
+	public :
+
+		// --------- Public Functions ---------
+
+		// Construction
+		VEJobSystem();
+
+		// Starts the worker threads. With no count, one worker is started for each hardware thread besides the main thread
+		bool			Initialise( unsigned int aWorkerCount = 0 );
+
+		// Runs any jobs still queued, then stops & joins the worker threads
+		void			Uninitialise();
+
+		// Queues a job. The counter, if there is one, counts the job until it has finished
+		void			Submit( VEJobFunction aFunction, void* aParameter, VEJobCounter* aCounter = NULL );
+
+		// Runs one queued job on the calling thread, returns false if the queue was empty
+		bool			RunPendingJob();
+
+		// Blocks until every job counted by the counter has finished, running queued jobs while it waits
+		void			Wait( VEJobCounter& aCounter );
+
+
+		// ------------ Accessors -------------
+
+		unsigned int	GetWorkerCount()		{ return myWorkers.size(); }
+
+
+	private :
+
+		// --------- Private Structures -------
+
+		// A queued job
+		struct Job
+		{
+			VEJobFunction	myFunction;
+			void*			myParameter;
+			VEJobCounter*	myCounter;
+		};
+
+
+		// --------- Private Functions --------
+
+		// Takes the job at the front of the queue, the lock must be held
+		Job						PopJob();
+
+		// Runs a job and marks it finished
+		static void				RunJob( const Job& aJob );
+
+		// Runs queued jobs until the job system is stopped
+		static unsigned int		WorkerThread( void* aJobSystem );
+
+		// The job system can't be copied
+		VEJobSystem( const VEJobSystem& );
+		VEJobSystem& operator=( const VEJobSystem& );
+
+
+		// --------- Private Variables --------
+
+		std::vector<VEThread*>	myWorkers;
+
+		VEMutex					myLock;
+		VEConditionVariable		myJobAvailable;
+		Job						myJobs[VE_JOB_QUEUE_SIZE];
+		unsigned int			myFirstJob;
+		unsigned int			myJobCount;
+		bool					myStopping;
+};
+
+
+#endif // !VE_JOB_SYSTEM_H
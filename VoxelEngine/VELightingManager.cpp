@@ -7,6 +7,7 @@
 #include "VEDirectionalLight.h"
 #include "VEPointLight.h"
 #include "VESpotLight.h"
+#include "VEMemoryTracker.h"
 
 
 // ----------------------- Class Functions ----------------------
@@ -60,6 +61,8 @@ void VELightingManager::Uninitialise()
 // Adds a directional light to the lighting manager
 VEDirectionalLight* VELightingManager::AddDirectionalLight()
 {
+	VE_MEMORY_TAG( MEM_RenderLists );
+
 	VEDirectionalLight* directonalLight = new VEDirectionalLight();
 
 	myDirectionalLights.push_back( directonalLight );
@@ -71,6 +74,8 @@ VEDirectionalLight* VELightingManager::AddDirectionalLight()
 // Adds a point light to the lighting manager
 VEPointLight* VELightingManager::AddPointLight()
 {
+	VE_MEMORY_TAG( MEM_RenderLists );
+
 	VEPointLight* pointLight = new VEPointLight();
 
 	myPointLights.push_back( pointLight );
@@ -82,6 +87,8 @@ VEPointLight* VELightingManager::AddPointLight()
 // Adds a spot light to the lighting manager
 VESpotLight* VELightingManager::AddSpotLight()
 {
+	VE_MEMORY_TAG( MEM_RenderLists );
+
 	VESpotLight* spotLight = new VESpotLight();
 
 	mySpotLights.push_back( spotLight );
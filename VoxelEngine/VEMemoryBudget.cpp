@@ -0,0 +1,94 @@
+// --------------------- Includes ---------------------
+
+#include "Stdafx.h"
+#include "VEMemoryBudget.h"
+
+
+// ------------------ Class Functions -----------------
+
+// Construction, every budget is unlimited
+VEMemoryBudget::VEMemoryBudget()
+{
+	for( unsigned int i = 0; i < MB_Max; i++ )
+	{
+		myBudgets[i]		= 0;
+		myUsage[i]			= 0;
+		myPeakUsage[i]		= 0;
+		myEvictionCounts[i]	= 0;
+		myEvictedBytes[i]	= 0;
+	}
+}
+
+
+// Records the bytes a budget's data currently takes, tracking the peak
+void VEMemoryBudget::SetUsage( MemoryBudget aBudget, unsigned long long aUsage )
+{
+	myUsage[aBudget]		= aUsage;
+	myPeakUsage[aBudget]	= aUsage > myPeakUsage[aBudget] ? aUsage : myPeakUsage[aBudget];
+}
+
+
+// Counts data evicted to keep within a budget
+void VEMemoryBudget::RecordEvictions( MemoryBudget aBudget, unsigned int anEvictionCount, unsigned long long aBytes )
+{
+	myEvictionCounts[aBudget]	+= anEvictionCount;
+	myEvictedBytes[aBudget]		+= aBytes;
+}
+
+
+// Whether a budget's usage is over its limit
+bool VEMemoryBudget::GetIsOverBudget( MemoryBudget aBudget )
+{
+	return myBudgets[aBudget] > 0 && myUsage[aBudget] > myBudgets[aBudget];
+}
+
+
+// Resets the peak usage of every budget to its current usage
+void VEMemoryBudget::ResetPeakUsage()
+{
+	for( unsigned int i = 0; i < MB_Max; i++ )
+	{
+		myPeakUsage[i] = myUsage[i];
+	}
+}
+
+
+// Picks the candidates to evict to bring the usage within the budget, the least recently visible first
+unsigned long long VEMemoryBudget::SelectEvictions( std::vector<VEEvictionCandidate>& someCandidates, unsigned long long aUsage, unsigned long long aBudget,
+													std::vector<VEChunk*>& someEvictions )
+{
+	if( aBudget == 0 || aUsage <= aBudget )
+	{
+		return 0;
+	}
+
+	std::sort( someCandidates.begin(), someCandidates.end(), VEMemoryBudget::CompareCandidates );
+
+	unsigned long long freedBytes = 0;
+	for( unsigned int i = 0; i < someCandidates.size() && aUsage > aBudget + freedBytes; i++ )
+	{
+		// Evicting nothing doesn't help
+		const VEEvictionCandidate& candidate = someCandidates[i];
+		if( candidate.myBytes == 0 )
+		{
+			continue;
+		}
+
+		someEvictions.push_back( candidate.myChunk );
+		freedBytes += candidate.myBytes;
+	}
+
+	return freedBytes;
+}
+
+
+// Orders candidates by when they were last visible, then by size
+bool VEMemoryBudget::CompareCandidates( const VEEvictionCandidate& aCandidate, const VEEvictionCandidate& anOtherCandidate )
+{
+	if( aCandidate.myVisibleTime != anOtherCandidate.myVisibleTime )
+	{
+		return aCandidate.myVisibleTime < anOtherCandidate.myVisibleTime;
+	}
+
+	return aCandidate.myBytes > anOtherCandidate.myBytes;
+}
@@ -0,0 +1,112 @@
+#ifndef VE_MEMORY_BUDGET_H
+#define VE_MEMORY_BUDGET_H
+
+
+// --------------------- Includes --------------------
+
+#include "VETypes.h"
+
+
+// ---------------- Forward Declarations -------------
+
+class VEChunk;
+
+
+// -------------------- Structures -------------------
+
+// A chunk whose data could be evicted to bring one of the budgets' usage down
+struct VEEvictionCandidate
+{
+	VEEvictionCandidate() :
+		myChunk( NULL ),
+		myVisibleTime( 0 ),
+		myBytes( 0 )
+	{
+	}
+
+	VEEvictionCandidate( VEChunk* aChunk, unsigned int aVisibleTime, unsigned long long aBytes ) :
+		myChunk( aChunk ),
+		myVisibleTime( aVisibleTime ),
+		myBytes( aBytes )
+	{
+	}
+
+	VEChunk*			myChunk;
+
+	// When the chunk was last in view, in the chunk manager's milliseconds
+	unsigned int		myVisibleTime;
+
+	// The bytes evicting the chunk's data would free
+	unsigned long long	myBytes;
+};
+
+
+// --------------------- Classes ---------------------
+
+// Keeps the budgets for the memory the chunk manager holds: the chunks' voxels (resident & compressed), the mesh
+// scratch buffers the pool keeps between builds, and the chunks' vertex & index buffers. A budget of zero is unlimited.
+//
+// The budget only does the book-keeping & decides what goes; the chunk manager measures the usage each update and
+// evicts the data SelectEvictions picks, least recently visible first. Used from the main thread
+class VEMemoryBudget
+{
+	public :
+
+		// ------ Public Functions ------
+
+		// Construction, every budget is unlimited
+		VEMemoryBudget();
+
+		// Records the bytes a budget's data currently takes, tracking the peak
+		void						SetUsage( MemoryBudget aBudget, unsigned long long aUsage );
+
+		// Counts data evicted to keep within a budget
+		void						RecordEvictions( MemoryBudget aBudget, unsigned int anEvictionCount, unsigned long long aBytes );
+
+		// Whether a budget's usage is over its limit
+		bool						GetIsOverBudget( MemoryBudget aBudget );
+
+		// Resets the peak usage of every budget to its current usage
+		void						ResetPeakUsage();
+
+		// Picks the candidates to evict to bring the usage within the budget, the least recently visible first and the
+		// largest first between those seen at the same time. The candidates are sorted in place. Returns the bytes the
+		// evictions free, which can leave the usage over budget if there aren't enough candidates
+		static unsigned long long	SelectEvictions( std::vector<VEEvictionCandidate>& someCandidates, unsigned long long aUsage, unsigned long long aBudget,
+													 std::vector<VEChunk*>& someEvictions );
+
+
+		// --------- Accessors ----------
+
+		// The limit on each budget's usage in bytes, zero for none
+		unsigned long long			GetBudget( MemoryBudget aBudget )								{ return myBudgets[aBudget]; }
+		void						SetBudget( MemoryBudget aBudget, unsigned long long aBytes )	{ myBudgets[aBudget] = aBytes; }
+
+		unsigned long long			GetUsage( MemoryBudget aBudget )								{ return myUsage[aBudget]; }
+		unsigned long long			GetPeakUsage( MemoryBudget aBudget )							{ return myPeakUsage[aBudget]; }
+
+		// The evictions made to keep within each budget, and the bytes they freed
+		unsigned int				GetEvictionCount( MemoryBudget aBudget )						{ return myEvictionCounts[aBudget]; }
+		unsigned long long			GetEvictedBytes( MemoryBudget aBudget )							{ return myEvictedBytes[aBudget]; }
+
+
+	private :
+
+		// ----- Private Functions ------
+
+		// Orders candidates by when they were last visible, then by size
+		static bool					CompareCandidates( const VEEvictionCandidate& aCandidate, const VEEvictionCandidate& anOtherCandidate );
+
+
+		// ----- Private Variables ------
+
+		unsigned long long			myBudgets[MB_Max];
+		unsigned long long			myUsage[MB_Max];
+		unsigned long long			myPeakUsage[MB_Max];
+
+		unsigned int				myEvictionCounts[MB_Max];
+		unsigned long long			myEvictedBytes[MB_Max];
+};
+
+
+#endif // !VE_MEMORY_BUDGET_H
@@ -0,0 +1,215 @@
+// --------------------- Includes ---------------------
+
+#include "Stdafx.h"
+#include "VEMemoryTracker.h"
+
+#include <atomic>
+#include <new>
+#include <malloc.h>
+
+
+// ---------------------- Defines ---------------------
+
+// Marks the trailer written after every tracked allocation
+#define VE_ALLOCATION_MAGIC		0x4d454d54
+
+
+// -------------------- Structures --------------------
+
+#ifdef VE_MEMORY_TRACKING
+
+// Written after the end of every tracked allocation, so delete knows which tag to take the memory off. It's kept
+// behind the allocation rather than in front of it so the pointer handed out is still the heap's own, and memory
+// freed by another module (the CRT & third party DLLs) doesn't need to know about the tracker
+struct AllocationTrailer
+{
+	unsigned int	myMagic;
+	unsigned int	myTag;
+};
+
+
+// ---------------------- Globals ---------------------
+
+static __declspec(thread) unsigned int	ourThreadAllocationCount = 0;
+static __declspec(thread) unsigned int	ourThreadTag = MEM_General;
+static std::atomic<unsigned int>		ourTotalAllocationCount( 0 );
+
+static std::atomic<unsigned int>		ourTagAllocationCounts[MEM_Max];
+static std::atomic<size_t>				ourTagLiveBytes[MEM_Max];
+static std::atomic<size_t>				ourTagPeakBytes[MEM_Max];
+
+
+// ----------------- Global Operators -----------------
+
+// Counts the allocation and accounts it against the thread's tag before handing it to the heap
+void* operator new( size_t aSize )
+{
+	ourThreadAllocationCount++;
+	ourTotalAllocationCount++;
+
+	unsigned char* memory = (unsigned char*)malloc( aSize + sizeof(AllocationTrailer) );
+	if( memory == NULL )
+	{
+		throw std::bad_alloc();
+	}
+
+	AllocationTrailer trailer;
+	trailer.myMagic	= VE_ALLOCATION_MAGIC;
+	trailer.myTag	= ourThreadTag;
+
+	memcpy( memory + aSize, &trailer, sizeof(AllocationTrailer) );
+
+	ourTagAllocationCounts[trailer.myTag]++;
+
+	// Raise the tag's high-water mark if this allocation pushed the live bytes past it
+	size_t liveBytes = ourTagLiveBytes[trailer.myTag].fetch_add( aSize ) + aSize;
+	size_t peakBytes = ourTagPeakBytes[trailer.myTag].load();
+	while( liveBytes > peakBytes && !ourTagPeakBytes[trailer.myTag].compare_exchange_weak(peakBytes, liveBytes) )
+	{
+	}
+
+	return memory;
+}
+
+
+// Array version of the counted allocation
+void* operator new[]( size_t aSize )
+{
+	return operator new( aSize );
+}
+
+
+// Takes the allocation off its tag's live bytes and returns the memory to the heap
+void operator delete( void* aMemory )
+{
+	if( aMemory == NULL )
+	{
+		return;
+	}
+
+	// Memory allocated by another module has no trailer, it's released without being accounted for
+	size_t blockSize = _msize( aMemory );
+	if( blockSize >= sizeof(AllocationTrailer) )
+	{
+		size_t				allocationSize = blockSize - sizeof(AllocationTrailer);
+		AllocationTrailer	trailer;
+
+		memcpy( &trailer, (unsigned char*)aMemory + allocationSize, sizeof(AllocationTrailer) );
+		if( trailer.myMagic == VE_ALLOCATION_MAGIC && trailer.myTag < MEM_Max )
+		{
+			ourTagLiveBytes[trailer.myTag] -= allocationSize;
+		}
+	}
+
+	free( aMemory );
+}
+
+
+// Array version of the heap release
+void operator delete[]( void* aMemory )
+{
+	operator delete( aMemory );
+}
+
+#endif // VE_MEMORY_TRACKING
+
+
+// ------------------ Class Functions -----------------
+
+// Whether allocations are being counted in this build
+bool VEMemoryTracker::IsEnabled()
+{
+#ifdef VE_MEMORY_TRACKING
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+// The number of allocations made by the calling thread
+unsigned int VEMemoryTracker::GetThreadAllocationCount()
+{
+#ifdef VE_MEMORY_TRACKING
+	return ourThreadAllocationCount;
+#else
+	return 0;
+#endif
+}
+
+
+// The number of allocations made by every thread
+unsigned int VEMemoryTracker::GetTotalAllocationCount()
+{
+#ifdef VE_MEMORY_TRACKING
+	return ourTotalAllocationCount;
+#else
+	return 0;
+#endif
+}
+
+
+// The tag the calling thread's allocations are accounted against
+MemoryTag VEMemoryTracker::GetThreadTag()
+{
+#ifdef VE_MEMORY_TRACKING
+	return (MemoryTag)ourThreadTag;
+#else
+	return MEM_General;
+#endif
+}
+
+
+// Sets the tag the calling thread's allocations are accounted against
+void VEMemoryTracker::SetThreadTag( MemoryTag aTag )
+{
+	assert( aTag < MEM_Max );
+
+#ifdef VE_MEMORY_TRACKING
+	ourThreadTag = aTag;
+#endif
+}
+
+
+// Returns the allocations accounted against a tag
+void VEMemoryTracker::GetTagStatistics( MemoryTag aTag, VEMemoryTagStatistics& aStatistics )
+{
+	assert( aTag < MEM_Max );
+
+#ifdef VE_MEMORY_TRACKING
+	aStatistics.myAllocationCount	= ourTagAllocationCounts[aTag];
+	aStatistics.myLiveBytes			= ourTagLiveBytes[aTag];
+	aStatistics.myPeakBytes			= ourTagPeakBytes[aTag];
+#else
+	aStatistics = VEMemoryTagStatistics();
+#endif
+}
+
+
+// Resets the high-water mark of every tag to its current live bytes
+void VEMemoryTracker::ResetPeaks()
+{
+#ifdef VE_MEMORY_TRACKING
+	for( unsigned int i = 0; i < MEM_Max; i++ )
+	{
+		ourTagPeakBytes[i] = ourTagLiveBytes[i].load();
+	}
+#endif
+}
+
+
+// Returns a printable name for a tag
+const char* VEMemoryTracker::GetTagName( MemoryTag aTag )
+{
+	switch( aTag )
+	{
+		case MEM_General :		return "General";
+		case MEM_Chunks :		return "Chunks";
+		case MEM_Meshes :		return "Meshes";
+		case MEM_Noise :		return "Noise";
+		case MEM_Messages :		return "Messages";
+		case MEM_RenderLists :	return "RenderLists";
+		case MEM_World :		return "World";
+		default :				return "Unknown";
+	}
+}
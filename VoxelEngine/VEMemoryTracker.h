@@ -0,0 +1,142 @@
+#ifndef VE_MEMORY_TRACKER_H
+#define VE_MEMORY_TRACKER_H
+
+
+// --------------------- Includes --------------------
+
+#include "VETypes.h"
+
+
+// --------------------- Defines ---------------------
+
+// Tracking replaces the global new & delete operators, so it's only enabled by default in debug builds
+#if defined(_DEBUG) && !defined(VE_MEMORY_TRACKING)
+	#define VE_MEMORY_TRACKING
+#endif
+
+#define VE_MEMORY_CONCAT_INNER( a, b )	a##b
+#define VE_MEMORY_CONCAT( a, b )		VE_MEMORY_CONCAT_INNER( a, b )
+
+// Accounts the calling thread's allocations against a subsystem until the end of the current scope
+#ifdef VE_MEMORY_TRACKING
+	#define VE_MEMORY_TAG( aTag )		VEMemoryTagScope VE_MEMORY_CONCAT( memoryTagScope, __LINE__ )( aTag )
+#else
+	#define VE_MEMORY_TAG( aTag )
+#endif
+
+
+// -------------------- Structures -------------------
+
+// The allocations accounted against a single memory tag
+struct VEMemoryTagStatistics
+{
+	VEMemoryTagStatistics() :
+		myAllocationCount( 0 ),
+		myLiveBytes( 0 ),
+		myPeakBytes( 0 )
+	{
+	}
+
+	// The number of allocations made since the program started
+	unsigned int	myAllocationCount;
+
+	// The number of bytes currently allocated, and the high-water mark
+	size_t			myLiveBytes;
+	size_t			myPeakBytes;
+};
+
+
+// --------------------- Classes ---------------------
+
+// Counts the heap allocations made through operator new. Counts are kept per thread, so work done on the
+// chunk building threads doesn't show up in measurements taken on the main thread. Every allocation is also
+// accounted against the calling thread's current memory tag, which tracks the live bytes & high-water mark of
+// each subsystem
+class VEMemoryTracker
+{
+	public :
+
+		// ------ Public Functions ------
+
+		// Whether allocations are being counted in this build
+		static bool			IsEnabled();
+
+		// The number of allocations made by the calling thread
+		static unsigned int	GetThreadAllocationCount();
+
+		// The number of allocations made by every thread
+		static unsigned int	GetTotalAllocationCount();
+
+		// The tag the calling thread's allocations are accounted against
+		static MemoryTag	GetThreadTag();
+		static void			SetThreadTag( MemoryTag aTag );
+
+		// Returns the allocations accounted against a tag
+		static void			GetTagStatistics( MemoryTag aTag, VEMemoryTagStatistics& aStatistics );
+
+		// Resets the high-water mark of every tag to its current live bytes
+		static void			ResetPeaks();
+
+		// Returns a printable name for a tag
+		static const char*	GetTagName( MemoryTag aTag );
+};
+
+
+// Measures the number of allocations the calling thread makes during the lifetime of the scope
+class VEAllocationScope
+{
+	public :
+
+		// ------ Public Functions ------
+
+		// Construction
+		VEAllocationScope() :
+			myStartCount( VEMemoryTracker::GetThreadAllocationCount() )
+		{
+		}
+
+		// The number of allocations made since the scope was created
+		unsigned int GetAllocationCount()
+		{
+			return VEMemoryTracker::GetThreadAllocationCount() - myStartCount;
+		}
+
+
+	private :
+
+		// ------ Private Variables ------
+
+		unsigned int myStartCount;
+};
+
+
+// Sets the calling thread's memory tag for the lifetime of the scope, use through the VE_MEMORY_TAG macro
+class VEMemoryTagScope
+{
+	public :
+
+		// ------ Public Functions ------
+
+		// Construction
+		VEMemoryTagScope( MemoryTag aTag ) :
+			myPreviousTag( VEMemoryTracker::GetThreadTag() )
+		{
+			VEMemoryTracker::SetThreadTag( aTag );
+		}
+
+		// Deconstruction, restores the tag that was active when the scope was created
+		~VEMemoryTagScope()
+		{
+			VEMemoryTracker::SetThreadTag( myPreviousTag );
+		}
+
+
+	private :
+
+		// ------ Private Variables ------
+
+		MemoryTag myPreviousTag;
+};
+
+
+#endif // !VE_MEMORY_TRACKER_H
@@ -0,0 +1,265 @@
+// ----------------------- Includes -----------------------
+
+#include "Stdafx.h"
+#include "VEMeshCache.h"
+
+#include "VEMemoryTracker.h"
+
+
+// -------------------- Class Functions -------------------
+
+// Construction
+VEMeshCache::VEMeshCache() :
+	myBytes( 0 ),
+	myUnusedBytes( 0 ),
+	myUnusedLimit( VE_MESH_CACHE_SIZE ),
+	myIsEnabled( true ),
+	myHitCount( 0 ),
+	myMissCount( 0 ),
+	myCollisionCount( 0 ),
+	mySavedTime( 0 )
+{
+}
+
+
+// Deconstruction, releases every entry's buffers
+VEMeshCache::~VEMeshCache()
+{
+	assert( myUnusedEntries.size() == myEntries.size() );
+
+	for( EntryMap::iterator iter = myEntries.begin(); iter != myEntries.end(); iter++ )
+	{
+		DeleteEntry( iter->second );
+	}
+	myEntries.clear();
+	myUnusedEntries.clear();
+}
+
+
+// Returns the entry for the supplied hashes with a reference taken, or NULL if there isn't one
+VEMeshCacheEntry* VEMeshCache::Acquire( unsigned long long aHash, unsigned long long aCheckHash )
+{
+	if( !myIsEnabled )
+	{
+		return NULL;
+	}
+
+	VEScopedLock<VEMutex> lock( myLock );
+
+	EntryMap::iterator iter = myEntries.find( aHash );
+	if( iter == myEntries.end() )
+	{
+		myMissCount++;
+		return NULL;
+	}
+
+	VEMeshCacheEntry* entry = iter->second;
+	if( entry->myCheckHash != aCheckHash )
+	{
+		myMissCount++;
+		myCollisionCount++;
+		return NULL;
+	}
+
+	AddReference( entry );
+
+	myHitCount++;
+	mySavedTime += entry->myBuildTime;
+
+	return entry;
+}
+
+
+// Adds the supplied mesh to the cache and returns its entry with a reference taken
+VEMeshCacheEntry* VEMeshCache::Insert( unsigned long long aHash, unsigned long long aCheckHash, ID3D11Buffer* aVertexBuffer, ID3D11Buffer* anIndexBuffer, unsigned int anIndexCount,
+									   unsigned int aBytes, long long aBuildTime )
+{
+	if( !myIsEnabled )
+	{
+		return NULL;
+	}
+
+	VEScopedLock<VEMutex> lock( myLock );
+
+	// Two chunks with the same contents can be built at once, the second one shares the first one's mesh. A chunk whose
+	// hash collides with different contents can't share it, or replace it while other chunks are using it
+	EntryMap::iterator iter = myEntries.find( aHash );
+	if( iter != myEntries.end() )
+	{
+		if( iter->second->myCheckHash != aCheckHash )
+		{
+			myCollisionCount++;
+			return NULL;
+		}
+
+		AddReference( iter->second );
+		return iter->second;
+	}
+
+	VEMeshCacheEntry* entry;
+	{
+		VE_MEMORY_TAG( MEM_Meshes );
+
+		entry = new VEMeshCacheEntry();
+		myEntries[aHash] = entry;
+	}
+
+	entry->myHash			= aHash;
+	entry->myCheckHash		= aCheckHash;
+	entry->myVertexBuffer	= aVertexBuffer;
+	entry->myIndexBuffer	= anIndexBuffer;
+	entry->myIndexCount		= anIndexCount;
+	entry->myBytes			= aBytes;
+	entry->myBuildTime		= aBuildTime;
+	entry->myRefCount		= 1;
+
+	if( aVertexBuffer != NULL )
+	{
+		aVertexBuffer->AddRef();
+	}
+
+	if( anIndexBuffer != NULL )
+	{
+		anIndexBuffer->AddRef();
+	}
+
+	myBytes += aBytes;
+
+	return entry;
+}
+
+
+// Releases a reference to an entry, once no chunk is using it the entry is kept for reuse up to the unused limit
+void VEMeshCache::Release( VEMeshCacheEntry* anEntry )
+{
+	if( anEntry == NULL )
+	{
+		return;
+	}
+
+	VEScopedLock<VEMutex> lock( myLock );
+
+	assert( anEntry->myRefCount > 0 );
+	if( --anEntry->myRefCount > 0 )
+	{
+		return;
+	}
+
+	myUnusedEntries.push_back( anEntry );
+	myUnusedBytes += anEntry->myBytes;
+
+	unsigned long long trimmedBytes = 0;
+	TrimUnused( myUnusedLimit, trimmedBytes );
+}
+
+
+// Deletes the entries no chunk is using, least recently used first, until they take no more than the supplied bytes
+unsigned int VEMeshCache::Trim( unsigned long long aMaxBytes, unsigned long long& aTrimmedBytes )
+{
+	VEScopedLock<VEMutex> lock( myLock );
+	return TrimUnused( aMaxBytes, aTrimmedBytes );
+}
+
+
+// The bytes releasing the chunk's reference to an entry would free
+unsigned int VEMeshCache::GetReleasedBytes( VEMeshCacheEntry* anEntry )
+{
+	if( anEntry == NULL )
+	{
+		return 0;
+	}
+
+	VEScopedLock<VEMutex> lock( myLock );
+	return anEntry->myRefCount == 1 ? anEntry->myBytes : 0;
+}
+
+
+// The bytes taken by every entry's buffers
+unsigned long long VEMeshCache::GetBytes()
+{
+	VEScopedLock<VEMutex> lock( myLock );
+	return myBytes;
+}
+
+
+// The bytes taken by the entries no chunk is using
+unsigned long long VEMeshCache::GetUnusedBytes()
+{
+	VEScopedLock<VEMutex> lock( myLock );
+	return myUnusedBytes;
+}
+
+
+// The number of entries in the cache
+unsigned int VEMeshCache::GetEntryCount()
+{
+	VEScopedLock<VEMutex> lock( myLock );
+	return (unsigned int)myEntries.size();
+}
+
+
+// Clears the hit, miss & collision counts, and the time saved
+void VEMeshCache::ResetStatistics()
+{
+	VEScopedLock<VEMutex> lock( myLock );
+
+	myHitCount	= 0;
+	myMissCount			= 0;
+	myCollisionCount	= 0;
+	mySavedTime			= 0;
+}
+
+
+// Takes a reference to an entry, taking it off the unused list if no chunk was using it
+void VEMeshCache::AddReference( VEMeshCacheEntry* anEntry )
+{
+	if( anEntry->myRefCount++ == 0 )
+	{
+		myUnusedEntries.erase( std::find(myUnusedEntries.begin(), myUnusedEntries.end(), anEntry) );
+		myUnusedBytes -= anEntry->myBytes;
+	}
+}
+
+
+// Deletes the unused entries released longest ago until they take no more than the supplied bytes
+unsigned int VEMeshCache::TrimUnused( unsigned long long aMaxBytes, unsigned long long& aTrimmedBytes )
+{
+	aTrimmedBytes = 0;
+
+	// Entries are released on to the back, so the front has been unused longest
+	unsigned int trimCount = 0;
+	while( trimCount < myUnusedEntries.size() && myUnusedBytes > aMaxBytes )
+	{
+		VEMeshCacheEntry* entry = myUnusedEntries[trimCount];
+
+		myEntries.erase( entry->myHash );
+		myUnusedBytes	-= entry->myBytes;
+		myBytes			-= entry->myBytes;
+		aTrimmedBytes	+= entry->myBytes;
+
+		DeleteEntry( entry );
+		trimCount++;
+	}
+
+	myUnusedEntries.erase( myUnusedEntries.begin(), myUnusedEntries.begin() + trimCount );
+
+	return trimCount;
+}
+
+
+// Releases the cache's references to an entry's buffers and deletes it. Render states hold their own references, so a
+// frame being drawn keeps them
+void VEMeshCache::DeleteEntry( VEMeshCacheEntry* anEntry )
+{
+	if( anEntry->myVertexBuffer != NULL )
+	{
+		anEntry->myVertexBuffer->Release();
+	}
+
+	if( anEntry->myIndexBuffer != NULL )
+	{
+		anEntry->myIndexBuffer->Release();
+	}
+
+	delete anEntry;
+}
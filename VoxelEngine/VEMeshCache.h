@@ -0,0 +1,153 @@
+#ifndef VE_MESH_CACHE_H
+#define VE_MESH_CACHE_H
+
+
+// ----------------------- Includes -----------------------
+
+#include "VETypes.h"
+#include "VEThreading.h"
+
+
+// ----------------------- Defines ------------------------
+
+// The bytes of meshes no chunk is using that the cache keeps around for reuse
+#define VE_MESH_CACHE_SIZE		(32 * 1024 * 1024)
+
+
+// ---------------------- Structures ----------------------
+
+// A mesh in the cache, shared by every chunk whose snapshot has the entry's hash. The buffers are immutable once the
+// entry is added, the cache and each chunk using the entry hold their own references to them
+struct VEMeshCacheEntry
+{
+	unsigned long long	myHash;
+
+	// A second hash of the snapshot, a chunk whose hash matches but whose check hash doesn't has different contents
+	unsigned long long	myCheckHash;
+
+	ID3D11Buffer*		myVertexBuffer;
+	ID3D11Buffer*		myIndexBuffer;
+	unsigned int		myIndexCount;
+	unsigned int		myBytes;
+
+	// The time taken to build the mesh in performance counter ticks, each hit saves about as much
+	long long			myBuildTime;
+
+	// The number of chunks using the mesh, the entry is only trimmed once it's zero
+	unsigned int		myRefCount;
+};
+
+
+// ----------------------- Classes ------------------------
+
+// Shares meshes between chunks with identical contents. Meshes are built around the chunk's origin rather than its
+// position, so two chunks whose voxels & halos are solid in the same places have the same mesh (see
+// VEChunkSnapshot::CalculateHash). Flat or repeating terrain and chunks re-styled back & forth skip meshing & uploading
+// entirely, they take a reference to the mesh that's already been built.
+//
+// Entries are reference counted by the chunks using them. Entries no chunk is using are kept, least recently used
+// first, until they take more than the cache's unused limit. Safe to use from the build threads
+class VEMeshCache
+{
+	public :
+
+		// ------- Public Functions -------
+
+		// Construction
+		VEMeshCache();
+
+		// Deconstruction, releases every entry's buffers. No chunk should be using them by now
+		~VEMeshCache();
+
+		// Returns the entry for the supplied hashes with a reference taken, or NULL if there isn't one. An entry with the
+		// same hash but a different check hash is a collision, and misses
+		VEMeshCacheEntry*	Acquire( unsigned long long aHash, unsigned long long aCheckHash );
+
+		// Adds the supplied mesh to the cache, taking a reference to its buffers, and returns its entry with a reference
+		// taken. If another chunk added the same hashes first, that entry is returned instead. If the hash is taken by an
+		// entry with a different check hash NULL is returned, and the chunk keeps its mesh to itself
+		VEMeshCacheEntry*	Insert( unsigned long long aHash, unsigned long long aCheckHash, ID3D11Buffer* aVertexBuffer, ID3D11Buffer* anIndexBuffer, unsigned int anIndexCount,
+									unsigned int aBytes, long long aBuildTime );
+
+		// Releases a reference to an entry, once no chunk is using it the entry is kept for reuse up to the unused limit
+		void				Release( VEMeshCacheEntry* anEntry );
+
+		// Deletes the entries no chunk is using, least recently used first, until they take no more than the supplied
+		// bytes. Returns the number of entries deleted, and the bytes they took
+		unsigned int		Trim( unsigned long long aMaxBytes, unsigned long long& aTrimmedBytes );
+
+		// The bytes releasing the chunk's reference to an entry would free: all of the entry's if no other chunk uses it
+		unsigned int		GetReleasedBytes( VEMeshCacheEntry* anEntry );
+
+		// The bytes taken by every entry's buffers, and by the entries no chunk is using
+		unsigned long long	GetBytes();
+		unsigned long long	GetUnusedBytes();
+
+		// The number of entries in the cache
+		unsigned int		GetEntryCount();
+
+		// Clears the hit, miss & collision counts, and the time saved
+		void				ResetStatistics();
+
+
+		// ---------- Accessors -----------
+
+		// Acquire always misses & nothing is inserted while the cache is disabled
+		bool				GetIsEnabled()								{ return myIsEnabled; }
+		void				SetIsEnabled( bool anIsEnabled )			{ myIsEnabled = anIsEnabled; }
+
+		// The bytes of unused entries kept for reuse
+		unsigned long long	GetUnusedLimit()							{ return myUnusedLimit; }
+		void				SetUnusedLimit( unsigned long long aBytes )	{ myUnusedLimit = aBytes; }
+
+		// The meshes found & not found, and the build time the hits saved in performance counter ticks
+		unsigned int		GetHitCount()								{ return myHitCount; }
+		unsigned int		GetMissCount()								{ return myMissCount; }
+		long long			GetSavedTime()								{ return mySavedTime; }
+
+		// The lookups & inserts whose hash matched an entry with a different check hash
+		unsigned int		GetCollisionCount()							{ return myCollisionCount; }
+
+
+	private :
+
+		// ------- Private Functions ------
+
+		// Takes a reference to an entry, taking it off the unused list if no chunk was using it. The lock must be held
+		void				AddReference( VEMeshCacheEntry* anEntry );
+
+		// Deletes the unused entries released longest ago until they take no more than the supplied bytes. The lock
+		// must be held
+		unsigned int		TrimUnused( unsigned long long aMaxBytes, unsigned long long& aTrimmedBytes );
+
+		// Releases the cache's references to an entry's buffers and deletes it
+		static void			DeleteEntry( VEMeshCacheEntry* anEntry );
+
+		// The mesh cache can't be copied
+		VEMeshCache( const VEMeshCache& );
+		VEMeshCache& operator=( const VEMeshCache& );
+
+
+		// ------- Private Variables ------
+
+		typedef std::map<unsigned long long, VEMeshCacheEntry*>	EntryMap;
+
+		VEMutex								myLock;
+		EntryMap							myEntries;
+
+		// The entries no chunk is using, the least recently released first
+		std::vector<VEMeshCacheEntry*>		myUnusedEntries;
+
+		unsigned long long					myBytes;
+		unsigned long long					myUnusedBytes;
+		unsigned long long					myUnusedLimit;
+		bool								myIsEnabled;
+
+		unsigned int						myHitCount;
+		unsigned int						myMissCount;
+		unsigned int						myCollisionCount;
+		long long							mySavedTime;
+};
+
+
+#endif // !VE_MESH_CACHE_H
@@ -0,0 +1,127 @@
+// ----------------------- Includes -----------------------
+
+#include "Stdafx.h"
+#include "VEMeshScratchPool.h"
+
+
+// -------------------- Class Functions -------------------
+
+// Construction
+VEMeshScratchPool::VEMeshScratchPool() :
+	myScratchCount( 0 ),
+	myFreeBytes( 0 )
+{
+}
+
+
+// Deconstruction, deletes every scratch buffer
+VEMeshScratchPool::~VEMeshScratchPool()
+{
+	assert( myFreeScratch.size() == myScratchCount );
+
+	for( unsigned int i = 0; i < myFreeScratch.size(); i++ )
+	{
+		delete myFreeScratch[i];
+		myFreeScratch[i] = NULL;
+	}
+	myFreeScratch.clear();
+}
+
+
+// Returns an empty scratch buffer
+VEMeshScratch* VEMeshScratchPool::Acquire()
+{
+	VEMeshScratch* scratch = NULL;
+
+	{
+		VEScopedLock<VEMutex> lock( myLock );
+
+		if( !myFreeScratch.empty() )
+		{
+			scratch = myFreeScratch.back();
+			myFreeScratch.pop_back();
+
+			myFreeBytes -= GetScratchBytes( *scratch );
+		}
+		else
+		{
+			myScratchCount++;
+		}
+	}
+
+	if( scratch == NULL )
+	{
+		scratch = new VEMeshScratch();
+	}
+
+	// Clearing keeps the capacity from the last chunk that used the buffers
+	scratch->myVertices.clear();
+	scratch->myIndices.clear();
+
+	return scratch;
+}
+
+
+// Hands a scratch buffer back to the pool
+void VEMeshScratchPool::Release( VEMeshScratch* aScratch )
+{
+	if( aScratch == NULL )
+	{
+		return;
+	}
+
+	VEScopedLock<VEMutex> lock( myLock );
+	myFreeScratch.push_back( aScratch );
+
+	myFreeBytes += GetScratchBytes( *aScratch );
+}
+
+
+// Deletes the scratch buffers released longest ago until the free buffers take no more than the supplied bytes
+unsigned int VEMeshScratchPool::Trim( unsigned long long aMaxBytes, unsigned long long& aTrimmedBytes )
+{
+	std::vector<VEMeshScratch*> trimmedScratch;
+	aTrimmedBytes = 0;
+
+	{
+		VEScopedLock<VEMutex> lock( myLock );
+
+		// Buffers are acquired from the back, so the front has been waiting longest
+		unsigned int trimCount = 0;
+		while( trimCount < myFreeScratch.size() && myFreeBytes > aMaxBytes )
+		{
+			unsigned long long scratchBytes = GetScratchBytes( *myFreeScratch[trimCount] );
+
+			trimmedScratch.push_back( myFreeScratch[trimCount] );
+			myFreeBytes		-= scratchBytes;
+			aTrimmedBytes	+= scratchBytes;
+			trimCount++;
+		}
+
+		myFreeScratch.erase( myFreeScratch.begin(), myFreeScratch.begin() + trimCount );
+		myScratchCount -= trimCount;
+	}
+
+	for( unsigned int i = 0; i < trimmedScratch.size(); i++ )
+	{
+		delete trimmedScratch[i];
+	}
+
+	return (unsigned int)trimmedScratch.size();
+}
+
+
+// The bytes reserved by the scratch buffers waiting in the pool
+unsigned long long VEMeshScratchPool::GetFreeBytes()
+{
+	VEScopedLock<VEMutex> lock( myLock );
+	return myFreeBytes;
+}
+
+
+// The bytes a scratch buffer has reserved
+unsigned long long VEMeshScratchPool::GetScratchBytes( const VEMeshScratch& aScratch )
+{
+	return aScratch.myVertices.capacity() * sizeof(VoxelVertices) + aScratch.myIndices.capacity() * sizeof(unsigned long) +
+		   aScratch.mySlabOffsets.capacity() * sizeof(unsigned int) + aScratch.mySnapshot.GetMemorySize();
+}
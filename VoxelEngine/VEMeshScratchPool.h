@@ -0,0 +1,79 @@
+#ifndef VE_MESH_SCRATCH_POOL_H
+#define VE_MESH_SCRATCH_POOL_H
+
+
+// ----------------------- Includes -----------------------
+
+#include "VETypes.h"
+#include "VEChunkSnapshot.h"
+#include "VEThreading.h"
+
+
+// ---------------------- Structures ----------------------
+
+// The vertices & indices generated for a chunk, before they're uploaded to the vertex & index buffers, and the
+// snapshot of the chunk's voxels they're generated from
+struct VEMeshScratch
+{
+	VEChunkSnapshot				mySnapshot;
+
+	std::vector<VoxelVertices>	myVertices;
+	std::vector<unsigned long>	myIndices;
+
+	// The first face of each Y-slab of the chunk, plus the total face count
+	std::vector<unsigned int>	mySlabOffsets;
+};
+
+
+// ----------------------- Classes ------------------------
+
+// Recycles the scratch buffers chunks build their meshes in. Chunks only need the buffers while they're being built,
+// so rather than each chunk keeping its own (and growing them from empty on every rebuild), the buffers are handed
+// back once they've been uploaded and keep their capacity for the next chunk. The chunk manager trims the buffers that
+// have waited longest to keep within its CPU mesh budget. Safe to use from the build threads
+class VEMeshScratchPool
+{
+	public :
+
+		// ------- Public Functions -------
+
+		// Construction
+		VEMeshScratchPool();
+
+		// Deconstruction, deletes every scratch buffer. All of them should have been released by now
+		~VEMeshScratchPool();
+
+		// Returns an empty scratch buffer
+		VEMeshScratch*	Acquire();
+
+		// Hands a scratch buffer back to the pool
+		void			Release( VEMeshScratch* aScratch );
+
+		// Deletes the scratch buffers released longest ago until the free buffers take no more than the supplied bytes.
+		// Returns the number of buffers deleted, and the bytes they took
+		unsigned int	Trim( unsigned long long aMaxBytes, unsigned long long& aTrimmedBytes );
+
+		// The bytes reserved by the scratch buffers waiting in the pool
+		unsigned long long	GetFreeBytes();
+
+		// The bytes a scratch buffer has reserved
+		static unsigned long long	GetScratchBytes( const VEMeshScratch& aScratch );
+
+
+		// ---------- Accessors -----------
+
+		unsigned int	GetScratchCount()		{ return myScratchCount; }
+
+
+	private :
+
+		// ------- Private Variables ------
+
+		VEMutex							myLock;
+		std::vector<VEMeshScratch*>		myFreeScratch;
+		unsigned int					myScratchCount;
+		unsigned long long				myFreeBytes;
+};
+
+
+#endif // !VE_MESH_SCRATCH_POOL_H
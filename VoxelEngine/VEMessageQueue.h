@@ -0,0 +1,134 @@
+#ifndef VE_MESSAGE_QUEUE_H
+#define VE_MESSAGE_QUEUE_H
+
+
+// --------------------- Includes --------------------
+
+#include "VEComponentMessage.h"
+
+#include <new>
+
+
+// --------------------- Defines ---------------------
+
+// The size of each message slot. Messages larger than this won't compile when queued
+#define VE_MESSAGE_SLOT_SIZE		64
+
+// The number of messages a component can have queued between updates
+#define VE_MESSAGE_QUEUE_CAPACITY	32
+
+
+// --------------------- Classes ---------------------
+
+// A fixed size ring buffer of component messages. Messages are copied in to inline slots rather than being
+// allocated individually, so queueing and processing messages never touches the heap
+class VEMessageQueue
+{
+	public :
+
+		// ------ Public Functions ------
+
+		// Construction
+		VEMessageQueue() :
+			myHead( 0 ),
+			myCount( 0 ),
+			myDroppedCount( 0 )
+		{
+		}
+
+		// Deconstruction
+		~VEMessageQueue()
+		{
+			Clear();
+		}
+
+		// Copies a message in to the next free slot. Returns false, and counts the message as dropped, if the queue is full
+		template <typename T>
+		bool Push( const T& aMessage )
+		{
+			static_assert( sizeof(T) <= VE_MESSAGE_SLOT_SIZE, "Message is too large for a message slot" );
+
+			if( myCount == VE_MESSAGE_QUEUE_CAPACITY )
+			{
+				myDroppedCount++;
+				return false;
+			}
+
+			unsigned int slot = (myHead + myCount) % VE_MESSAGE_QUEUE_CAPACITY;
+			new (mySlots[slot].myData) T( aMessage );
+			myCount++;
+
+			return true;
+		}
+
+		// Returns the oldest message in the queue
+		VEComponentMessage* Front()
+		{
+			assert( myCount > 0 );
+			return GetSlot( myHead );
+		}
+
+		// Removes the oldest message from the queue
+		void Pop()
+		{
+			assert( myCount > 0 );
+
+			GetSlot( myHead )->~VEComponentMessage();
+			myHead = (myHead + 1) % VE_MESSAGE_QUEUE_CAPACITY;
+			myCount--;
+		}
+
+		// Removes all of the messages from the queue
+		void Clear()
+		{
+			while( myCount > 0 )
+			{
+				Pop();
+			}
+
+			myHead = 0;
+		}
+
+
+		// --------- Accessors ----------
+
+		unsigned int	GetCount()				{ return myCount; }
+
+		bool			IsEmpty()				{ return myCount == 0; }
+
+		// The number of messages dropped because the queue was full
+		unsigned int	GetDroppedCount()		{ return myDroppedCount; }
+
+
+	private :
+
+		// ------ Private Structures -----
+
+		// Storage for a single message, aligned for any of the message member types
+		union MessageSlot
+		{
+			unsigned char	myData[VE_MESSAGE_SLOT_SIZE];
+			double			myAlignment;
+			void*			myPointerAlignment;
+		};
+
+
+		// ------ Private Functions ------
+
+		// Returns the message stored in a slot
+		VEComponentMessage* GetSlot( unsigned int aSlot )
+		{
+			return reinterpret_cast<VEComponentMessage*>( mySlots[aSlot].myData );
+		}
+
+
+		// ------ Private Variables ------
+
+		MessageSlot		mySlots[VE_MESSAGE_QUEUE_CAPACITY];
+		unsigned int	myHead;
+		unsigned int	myCount;
+		unsigned int	myDroppedCount;
+};
+
+
+#endif // !VE_MESSAGE_QUEUE_H
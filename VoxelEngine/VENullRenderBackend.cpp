@@ -0,0 +1,54 @@
+// ---------------------- Includes ---------------------
+
+// Built without the precompiled header, so the null backend doesn't need the Windows SDK or D3D
+#include "VENullRenderBackend.h"
+
+#include "VEProfiler.h"
+
+#include <cassert>
+#include <cstddef>
+
+
+// ------------------ Class Functions ------------------
+
+// Construction
+VENullRenderBackend::VENullRenderBackend() :
+	VERenderBackend(),
+	myPresentTime( 0.0 ),
+	myTimerFrequency( VEProfiler::GetFrequency() )
+{
+}
+
+
+// Records the size of the buffer
+bool VENullRenderBackend::CreateBuffer( BufferType aType, const void* someData, unsigned int aByteWidth, ID3D11Buffer** aBuffer )
+{
+	assert( aBuffer != NULL );
+
+	RecordBuffer( aByteWidth );
+	*aBuffer = NULL;
+
+	return true;
+}
+
+
+// Records the draw call
+void VENullRenderBackend::DrawIndexed( unsigned int anIndexCount )
+{
+	RecordDraw( anIndexCount );
+}
+
+
+// Records the end of the frame
+void VENullRenderBackend::PresentBuffer()
+{
+	if( myPresentTime > 0.0 )
+	{
+		long long endTime = VEProfiler::GetTime() + (long long)( myPresentTime * (double)myTimerFrequency / 1000.0 );
+		while( VEProfiler::GetTime() < endTime )
+		{
+		}
+	}
+
+	RecordPresent();
+}
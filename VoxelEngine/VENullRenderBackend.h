@@ -0,0 +1,52 @@
+#ifndef VE_NULL_RENDER_BACKEND_H
+#define VE_NULL_RENDER_BACKEND_H
+
+
+// ---------------------- Includes ---------------------
+
+#include "VERenderBackend.h"
+
+
+// ---------------------- Classes ----------------------
+
+// A render backend that never touches the GPU. Buffers aren't created (the returned buffer is always NULL),
+// but their sizes and any draw calls are recorded, so the engine can run headless for benchmarking
+class VENullRenderBackend : public VERenderBackend
+{
+	public :
+
+		// --------- Public Functions ---------
+
+		// Construction
+		VENullRenderBackend();
+
+
+		// -------- Required Functions --------
+
+		// Records the size of the buffer
+		virtual bool	CreateBuffer( BufferType aType, const void* someData, unsigned int aByteWidth, ID3D11Buffer** aBuffer ) override;
+
+		// Records the draw call
+		virtual void	DrawIndexed( unsigned int anIndexCount ) override;
+
+		// Records the end of the frame
+		virtual void	PresentBuffer() override;
+
+
+		// ------------ Accessors -------------
+
+		// Time (in milliseconds) each present spends busy, standing in for the driver's submission cost so
+		// pipelined rendering can be measured headless
+		void			SetPresentTime( double aPresentTime )	{ myPresentTime = aPresentTime; }
+
+
+	private :
+
+		// -------- Private Variables ---------
+
+		double			myPresentTime;
+		long long		myTimerFrequency;
+};
+
+
+#endif // !VE_NULL_RENDER_BACKEND_H
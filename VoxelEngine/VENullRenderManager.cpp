@@ -0,0 +1,50 @@
+// ------------------ Includes ------------------
+
+#include "Stdafx.h"
+#include "VENullRenderManager.h"
+
+#include "VoxelEngine.h"
+#include "VERenderBackend.h"
+#include "VEChunkManager.h"
+#include "VEChunk.h"
+#include "VEProfiler.h"
+
+
+// -------------- Class Functions ---------------
+
+// Construction
+VENullRenderManager::VENullRenderManager() :
+	VERenderManager( RT_Null )
+{
+}
+
+
+// Nothing to initialise
+bool VENullRenderManager::Initialise( int aScreenWidth, int aScreenHeight )
+{
+	return true;
+}
+
+
+// Nothing to clean up
+void VENullRenderManager::Uninitialise()
+{
+}
+
+
+// Issues the draw calls for the enabled chunks
+void VENullRenderManager::RenderScene( VERenderState& aRenderState )
+{
+	VE_PROFILE_ZONE( "VENullRenderManager::RenderScene" );
+
+	VERenderBackend* renderBackend = VoxelEngine::GetInstance()->GetRenderBackend();
+	assert( renderBackend != NULL );
+
+	const std::vector<VEChunkDrawItem>& chunks = aRenderState.GetChunks();
+	for( unsigned int i = 0; i < chunks.size(); i++ )
+	{
+		renderBackend->DrawIndexed( chunks[i].myIndexCount );
+	}
+
+	renderBackend->PresentBuffer();
+}
@@ -0,0 +1,34 @@
+#ifndef VE_NULL_RENDER_MANAGER_H
+#define VE_NULL_RENDER_MANAGER_H
+
+
+// ------------------ Includes ------------------
+
+#include "VERenderManager.h"
+
+
+// ------------------ Classes -------------------
+
+// A render manager for running the engine headless. It walks the scene the same way the real render managers
+// do, issuing a draw call to the render backend for every enabled chunk, but binds no shaders or buffers
+class VENullRenderManager : public VERenderManager
+{
+	public :
+
+		// -------- Public Functions --------
+
+		// Construction
+		VENullRenderManager();
+
+		// Nothing to initialise
+		virtual bool	Initialise( int aScreenWidth, int aScreenHeight ) override;
+
+		// Nothing to clean up
+		virtual void	Uninitialise() override;
+
+		// Issues the draw calls for the enabled chunks
+		virtual void	RenderScene( VERenderState& aRenderState ) override;
+};
+
+
+#endif // !VE_NULL_RENDER_MANAGER_H
@@ -7,6 +7,7 @@
 #include "VoxelEngine.h"
 #include "VEObjectComponent.h"
 #include "VEObjectService.h"
+#include "VEComponentSystem.h"
 
 
 // --------------------- Namespaces ---------------------
@@ -20,6 +21,22 @@ typedef std::pair<unsigned int, VEObjectComponent*>				ComponentEntry;
 typedef std::map<unsigned int, VEObjectComponent*>::iterator	ComponentIter;
 
 
+// ------------------ Static Functions ------------------
+
+// Frees a component, handing it back to its system if it was created by one
+static void DestroyComponent( VEObjectComponent* aComponent )
+{
+	if( VEComponentSystemBase* system = aComponent->GetSystem() )
+	{
+		system->DestroyComponent( aComponent );
+	}
+	else
+	{
+		delete aComponent;
+	}
+}
+
+
 // ------------------ Class Functions -------------------
 
 // Construction
@@ -39,11 +56,20 @@ VEObject::~VEObject()
 	{
 		iter->second->Cleanup();
 
-		delete iter->second;
+		DestroyComponent( iter->second );
 		iter->second = NULL;
 	}
 
 	myComponents.clear();
+
+	// Remove the object from the object service if it's still registered
+	if( myId != VE_INVALID_OBJECT_ID )
+	{
+		if( VEObjectService* objectService = VoxelEngine::GetInstance()->GetObjectService() )
+		{
+			objectService->RemoveObject( myId );
+		}
+	}
 }
 
 
@@ -79,9 +105,7 @@ void VEObject::RemoveComponent( ComponentType aComponentId )
 	ComponentIter component = myComponents.find( aComponentId );
 	if( component != myComponents.end() )
 	{
-		delete myComponents[aComponentId];
-		myComponents[aComponentId] = NULL;
-
+		DestroyComponent( component->second );
 		myComponents.erase( component );
 	}
 }
@@ -99,12 +123,16 @@ VEObjectComponent* VEObject::GetComponent( ComponentType aComponentId )
 }
 
 
-// Updates the object and all of it's components
+// Updates the object and all of it's components. Components owned by a component system are updated
+// in bulk by their system instead
 void VEObject::Update( float anElapsedTime )
 {	
 	for( ComponentIter component = myComponents.begin(); component != myComponents.end(); component++ )
 	{
-		(*component).second->Update( anElapsedTime );
+		if( (*component).second->GetSystem() == NULL )
+		{
+			(*component).second->Update( anElapsedTime );
+		}
 	}
 }
 
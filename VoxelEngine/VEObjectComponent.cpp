@@ -8,18 +8,15 @@
 #include "VEComponentMessage.h"
 
 
-// --------------------- Typedefs ---------------------
-
-typedef std::vector<VEComponentMessage*>::iterator MessageIterator;
-
-
 // ----------------- Class Functions ------------------
 
 // Construction
 VEObjectComponent::VEObjectComponent( unsigned int aComponentType, VEObject* aParent ) :
 	myType( aComponentType ),
 	myParent( aParent ),
-	myEnabled( true )
+	myEnabled( true ),
+	mySystem( NULL ),
+	mySystemIndex( 0 )
 {
 }
 
@@ -64,52 +61,24 @@ void VEObjectComponent::RemoveMessageTarget( VEObjectComponent* aComponent )
 // Updates the state of the component
 void VEObjectComponent::Update( float anElapsedTime )
 {
-	if( myMessageQueue.size() > 0 )
+	if( !myMessageQueue.IsEmpty() )
 	{
 		ProcessMessages( anElapsedTime );
 	}
 }
 
 
-// Adds a message to the queue
-bool VEObjectComponent::QueueMessage( VESmartPointer<VEComponentMessage> aMessage )
-{
-	if( std::find(mySupportedMessageTypes.begin(), mySupportedMessageTypes.end(), aMessage->GetType()) != mySupportedMessageTypes.end() )
-	{
-		myMessageQueue.push_back( aMessage );
-		return true;
-	}
-	
-	return false;
-}
-
-
-// Sends a component message to all of the message targets
-void VEObjectComponent::SendMessage( VESmartPointer<VEComponentMessage> aMessage )
-{
-	for( std::vector<VEObjectComponent*>::iterator iter = myMessageTargets.begin(); iter != myMessageTargets.end(); iter++ )
-	{
-		(*iter)->QueueMessage( aMessage );
-	}
-}
-
-
 // Adds a supported message type
 void VEObjectComponent::AddMessageType( unsigned int aMessageType )
 {
-	if( std::find(mySupportedMessageTypes.begin(), mySupportedMessageTypes.end(), aMessageType) == mySupportedMessageTypes.end() )
-	{
-		mySupportedMessageTypes.push_back( aMessageType );
-	}
+	assert( aMessageType < VE_MAX_MESSAGE_TYPES );
+	mySupportedMessageTypes.set( aMessageType );
 }
 
 
 // Removes a supported message type
 void VEObjectComponent::RemoveMessageType( unsigned int aMessageType )
 {
-	std::vector<unsigned int>::iterator iter = std::find(mySupportedMessageTypes.begin(), mySupportedMessageTypes.end(), aMessageType );
-	if( iter != mySupportedMessageTypes.end() )
-	{
-		mySupportedMessageTypes.erase( iter );
-	}
+	assert( aMessageType < VE_MAX_MESSAGE_TYPES );
+	mySupportedMessageTypes.reset( aMessageType );
 }
\ No newline at end of file
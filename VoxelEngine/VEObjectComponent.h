@@ -6,12 +6,21 @@
 
 #include "VETypes.h"
 #include "VEComponentMessage.h"
-#include "VESmartPointer.h"
+#include "VEMessageQueue.h"
+
+#include <bitset>
+
+
+// --------------------- Defines ---------------------
+
+// The number of message types a component can filter on
+#define VE_MAX_MESSAGE_TYPES	64
 
 
 // --------------- Forward Declarations --------------
 
 class VEObject;
+class VEComponentSystemBase;
 
 
 // --------------------- Classes ---------------------
@@ -40,8 +49,23 @@ class VEObjectComponent
 		// Updates the state of the component
 		virtual void	Update( float anElapsedTime );
 
-		// Adds an object message to the component's message queue
-		virtual bool	QueueMessage( VESmartPointer<VEComponentMessage> aMessage );
+		// Copies a message in to the component's message queue, if the component supports the message type. Returns false
+		// if it doesn't, or the queue is full and the message was dropped
+		template <typename T>
+		bool			QueueMessage( const T& aMessage )
+		{
+			unsigned int messageType = aMessage.GetType();
+			if( messageType >= VE_MAX_MESSAGE_TYPES || !mySupportedMessageTypes.test(messageType) )
+			{
+				return false;
+			}
+
+			// The queue only fills if the component is sent more messages between updates than it has slots for
+			bool isQueued = myMessageQueue.Push( aMessage );
+			assert( isQueued && "Component message dropped, VE_MESSAGE_QUEUE_CAPACITY is too small" );
+
+			return isQueued;
+		}
 
 
 		// ----- Required Functions -----
@@ -62,6 +86,14 @@ class VEObjectComponent
 
 		const VEObject*	GetParent()						{ return myParent; }
 
+		// The number of messages dropped because the component's queue was full
+		unsigned int	GetDroppedMessageCount()		{ return myMessageQueue.GetDroppedCount(); }
+
+		// The system that owns the component's memory and updates it, NULL for components created with new
+		VEComponentSystemBase*	GetSystem()				{ return mySystem; }
+		unsigned int			GetSystemIndex()		{ return mySystemIndex; }
+		void					SetSystem( VEComponentSystemBase* aSystem, unsigned int anIndex )	{ mySystem = aSystem; mySystemIndex = anIndex; }
+
 
 	protected :		
 		
@@ -70,8 +102,16 @@ class VEObjectComponent
 		// Processes messages in the queue
 		virtual void	ProcessMessages( float anElapsedTime ) = 0;
 
-		// Sends a component message to all of the message targets
-		void			SendMessage( VESmartPointer<VEComponentMessage> aMessage );
+		// Sends a component message to all of the message targets. Each target receives its own copy, targets that don't
+		// support the message type ignore it and full queues drop it (see QueueMessage)
+		template <typename T>
+		void			SendMessage( const T& aMessage )
+		{
+			for( unsigned int i = 0; i < myMessageTargets.size(); i++ )
+			{
+				myMessageTargets[i]->QueueMessage( aMessage );
+			}
+		}
 
 		// Adds a supported message type
 		void			AddMessageType( unsigned int aMessageType );
@@ -87,9 +127,12 @@ class VEObjectComponent
 		unsigned int									myType;
 		VEObject*										myParent;
 
+		VEComponentSystemBase*							mySystem;
+		unsigned int									mySystemIndex;
+
 		std::vector<VEObjectComponent*>					myMessageTargets;
-		std::vector<VESmartPointer<VEComponentMessage>>	myMessageQueue;
-		std::vector<unsigned int>						mySupportedMessageTypes;
+		VEMessageQueue									myMessageQueue;
+		std::bitset<VE_MAX_MESSAGE_TYPES>				mySupportedMessageTypes;
 };
 
 
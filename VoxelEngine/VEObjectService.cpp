@@ -1,4 +1,3 @@
-
 // -------------------- Includes ---------------------
 
 #include "Stdafx.h"
@@ -7,23 +6,14 @@
 #include "VEObject.h"
 #include "VEObjectComponent.h"
 #include "VEPhysicsComponent.h"
-
-
-// -------------------- Statics ----------------------
-
-int VEObjectService::myNextObjectId = 0;
-
-
-// -------------------- Typedefs ---------------------
-
-typedef std::pair<int, VEObject*>			ObjectEntry;
-typedef std::map<int, VEObject*>::iterator	ObjectIter;
+#include "VEProfiler.h"
 
 
 // ----------------- Class Functions -----------------
 
 // Construction
-VEObjectService::VEObjectService()
+VEObjectService::VEObjectService() :
+	myIsUpdating( false )
 {
 }
 
@@ -31,82 +21,140 @@ VEObjectService::VEObjectService()
 // Deconstruction
 VEObjectService::~VEObjectService()
 {
-	for( ObjectIter iter = myStaticObjects.begin(); iter != myStaticObjects.end(); iter++ )
+	// Reset the ids first so that objects being deleted don't try to remove themselves from the service
+	// while it's being torn down. Static objects are owned by the service
+	for( unsigned int i = 0; i < myObjects.GetCapacity(); i++ )
 	{
-		delete iter->second;
-		iter->second = NULL;
+		ObjectRecord* record = myObjects.GetAt( i );
+		if( record == NULL )
+		{
+			continue;
+		}
+
+		record->myObject->SetId( VE_INVALID_OBJECT_ID );
+		if( record->myDynamicIndex == -1 )
+		{
+			delete record->myObject;
+			record->myObject = NULL;
+		}
 	}
 
-	myStaticObjects.clear();
+	myObjects.Clear();
+	myDynamicObjects.clear();
 }
 
 
 // Registers an object with the manager
 bool VEObjectService::RegisterObject( VEObject* anObject, bool isDynamic )
 {
-	if( anObject->GetId() == VE_INVALID_OBJECT_ID )
+	assert( anObject != NULL );
+
+	// Objects can only be registered once
+	if( GetObject(anObject->GetId()) != NULL )
 	{
-		anObject->SetId( GetNextId() );
+		return false;
 	}
 
+	int dynamicIndex = -1;
 	if( isDynamic )
 	{
-		if( myDynamicObjects.find(anObject->GetId()) == myDynamicObjects.end() )
-		{
-			myDynamicObjects.insert( ObjectEntry(anObject->GetId(), anObject) );
-			return true;
-		}
+		dynamicIndex = (int)myDynamicObjects.size();
+		myDynamicObjects.push_back( anObject );
+	}
+
+	anObject->SetId( myObjects.Insert(ObjectRecord(anObject, dynamicIndex)) );
+
+	return true;
+}
+
+
+// Removes an object from the manager. The object isn't deleted, and its id is reset
+bool VEObjectService::RemoveObject( int anObjectId )
+{
+	ObjectRecord* record = myObjects.Get( anObjectId );
+	if( record == NULL )
+	{
+		return false;
 	}
-	else
+
+	// Swapping the last dynamic object in to the removed object's place during the update could move it behind the
+	// object being updated, where it would be skipped. Instead the place is emptied, and filled once the update is done
+	if( record->myDynamicIndex != -1 )
 	{
-		if( myStaticObjects.find(anObject->GetId()) == myStaticObjects.end() )
+		if( myIsUpdating )
+		{
+			myDynamicObjects[record->myDynamicIndex] = NULL;
+			myRemovedIndices.push_back( record->myDynamicIndex );
+		}
+		else
 		{
-			myStaticObjects.insert( ObjectEntry(anObject->GetId(), anObject) );
-			return true;
+			RemoveDynamicObject( record->myDynamicIndex );
 		}
 	}
 
+	record->myObject->SetId( VE_INVALID_OBJECT_ID );
+	myObjects.Remove( anObjectId );
 
-	return false;
+	return true;
 }
 
 
-// Returns the object with the supplied id
+// Returns the object with the supplied id, or NULL if the id is stale
 VEObject* VEObjectService::GetObject( int anObjectId )
 {
-	if( anObjectId == VE_INVALID_OBJECT_ID )
+	ObjectRecord* record = myObjects.Get( anObjectId );
+	if( record == NULL )
 	{
 		return NULL;
 	}
-	
-	ObjectIter object = myDynamicObjects.find( anObjectId );
-	if( object != myDynamicObjects.end() )
-	{
-		return object->second;
-	}
-	
-	object = myStaticObjects.find( anObjectId );
-	if( object != myStaticObjects.end() )
-	{
-		return object->second;
-	}
 
-	return NULL;
+	return record->myObject;
 }
 
 
-// Updates all of the registered dynamic objects
+// Updates all of the registered dynamic objects. Objects may register & remove objects, themselves included, during
+// their update. Registered objects are added to the end, so the size of the array is checked on every iteration, and
+// removed objects leave an empty place that's skipped
 void VEObjectService::Update( float anElapsedTime )
 {
-	for( ObjectIter object = myDynamicObjects.begin(); object != myDynamicObjects.end(); object++ )
+	VE_PROFILE_ZONE( "VEObjectService::Update" );
+
+	myIsUpdating = true;
+
+	for( unsigned int i = 0; i < myDynamicObjects.size(); i++ )
 	{
-		object->second->Update( anElapsedTime );
+		if( myDynamicObjects[i] != NULL )
+		{
+			myDynamicObjects[i]->Update( anElapsedTime );
+		}
+	}
+
+	myIsUpdating = false;
+
+	// Fill the emptied places from the highest down, so the object swapped in to each is never one that was removed
+	if( !myRemovedIndices.empty() )
+	{
+		std::sort( myRemovedIndices.begin(), myRemovedIndices.end() );
+
+		for( std::vector<int>::reverse_iterator iter = myRemovedIndices.rbegin(); iter != myRemovedIndices.rend(); iter++ )
+		{
+			RemoveDynamicObject( *iter );
+		}
+		myRemovedIndices.clear();
 	}
 }
 
 
-// Returns the next object id, increments the counter
-int VEObjectService::GetNextId()
+// Swaps the last dynamic object in to the supplied place and shrinks the array, keeping it dense
+void VEObjectService::RemoveDynamicObject( int anIndex )
 {
-	return myNextObjectId++;
-}
\ No newline at end of file
+	VEObject* lastObject = myDynamicObjects.back();
+	myDynamicObjects[anIndex] = lastObject;
+
+	if( lastObject != NULL )
+	{
+		myObjects.Get( lastObject->GetId() )->myDynamicIndex = anIndex;
+	}
+
+	myDynamicObjects.pop_back();
+}
@@ -4,6 +4,7 @@
 // --------------------- Includes --------------------
 
 #include "VETypes.h"
+#include "VESlotMap.h"
 
 
 // --------------- Forward Declarations --------------
@@ -13,7 +14,9 @@ class VEObject;
 
 // --------------------- Classes ---------------------
 
-// A manager used for creating and maintaining engine object instances
+// A manager used for creating and maintaining engine object instances. Object ids are generational handles
+// in to a slot map, so lookups are O(1) and ids belonging to removed objects are detected as stale. Dynamic
+// objects are also kept in a dense array so the per-frame update doesn't have to walk the slot map
 class VEObjectService
 {
 	public :
@@ -29,28 +32,65 @@ class VEObjectService
 		// Registers an object with the manager
 		bool		RegisterObject( VEObject* anObject, bool isDynamic );
 
-		// Returns the object with the supplied id
+		// Removes an object from the manager. The object isn't deleted, and its id is reset
+		bool		RemoveObject( int anObjectId );
+
+		// Returns the object with the supplied id, or NULL if the id is stale
 		VEObject*	GetObject( int anObjectId );
 
-		// Updates all of the registered dynamic objects
+		// Updates all of the registered dynamic objects. Objects removed during the update are taken out of the dynamic
+		// array once it's finished
 		void		Update( float anElapsedTime );
 
 
+		// --------- Accessors ----------
+
+		unsigned int	GetObjectCount()			{ return myObjects.GetSize(); }
+
+		unsigned int	GetDynamicObjectCount()		{ return myDynamicObjects.size() - myRemovedIndices.size(); }
+
+
 	private :		
 		
+		// ------ Private Structures -----
+
+		// The slot map entry for a registered object
+		struct ObjectRecord
+		{
+			ObjectRecord() :
+				myObject( NULL ),
+				myDynamicIndex( -1 )
+			{
+			}
+
+			ObjectRecord( VEObject* anObject, int aDynamicIndex ) :
+				myObject( anObject ),
+				myDynamicIndex( aDynamicIndex )
+			{
+			}
+
+			VEObject*	myObject;
+
+			// Position of the object in the dense dynamic array, -1 for static objects
+			int			myDynamicIndex;
+		};
+
+
 		// ------ Private Functions ------
-		
-		// Returns the next object id, increments the counter
-		int			GetNextId();
+
+		// Swaps the last dynamic object in to the supplied place and shrinks the array, keeping it dense
+		void		RemoveDynamicObject( int anIndex );
 
 
 		// ------ Private Variables ------
 
-		std::map<int, VEObject*>	myStaticObjects;
-		std::map<int, VEObject*>	myDynamicObjects;
-		
-		static int					myNextObjectId;
+		VESlotMap<ObjectRecord>	myObjects;
+		std::vector<VEObject*>	myDynamicObjects;
+
+		// The places in the dynamic array emptied by objects removed during the update, and whether it's running
+		std::vector<int>		myRemovedIndices;
+		bool					myIsUpdating;
 };
 
 
-#endif // !VE_OBJECT_MANAGER_H
\ No newline at end of file
+#endif // !VE_OBJECT_MANAGER_H
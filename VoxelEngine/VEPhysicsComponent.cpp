@@ -76,13 +76,10 @@ void VEPhysicsComponent::ApplyGravity( float anElapsedTime )
 	{
 		XMINT3 chunkOffset; 
 		chunkManager->CalculateVoxelOffset( chunkOffset, myParent->GetPosition(), activeChunk );
-		if( VEVoxel* lowerVoxel = activeChunk->GetVoxel(chunkOffset.x, chunkOffset.y - 1, chunkOffset.z) )
+		if( activeChunk->GetVoxelEnabled(chunkOffset.x, chunkOffset.y - 1, chunkOffset.z) )
 		{
-			if( lowerVoxel->GetEnabled() )
-			{
-				myVelocity.y = 0.0f;
-				return;
-			}
+			myVelocity.y = 0.0f;
+			return;
 		}
 	}
 
@@ -10,6 +10,7 @@
 #include "VEChunkManager.h"
 #include "VEChunk.h"
 #include "VEVoxel.h"
+#include "VEProfiler.h"
 
 
 // ---------------------- Namespaces ---------------------
@@ -30,6 +31,7 @@ VEPhysicsService::VEPhysicsService() :
 // Updates the position & orientation of all registered physics objects
 void VEPhysicsService::Update( float anElapsedTime )
 {
+	VE_PROFILE_ZONE( "VEPhysicsService::Update" );
 }
 
 
@@ -69,12 +71,9 @@ bool VEPhysicsService::ValidateMovement( const DirectX::XMFLOAT3& aCurrentPositi
 	{
 		XMINT3 requestedOffset;
 		chunkManager->CalculateVoxelOffset( requestedOffset, aTargetPosition, activeChunk );
-		if( VEVoxel* targetVoxel = activeChunk->GetVoxel(requestedOffset.x, requestedOffset.y, requestedOffset.z) )
+		if( activeChunk->GetVoxelEnabled(requestedOffset.x, requestedOffset.y, requestedOffset.z) )
 		{
-			if( targetVoxel->GetEnabled() )
-			{
-				return false;
-			}
+			return false;
 		}
 	}
 
@@ -0,0 +1,415 @@
+// --------------------- Includes ---------------------
+
+// Built without the precompiled header, so the allocator doesn't need the Windows SDK on other platforms
+#include "VEPoolAllocator.h"
+
+#include <cassert>
+
+#ifdef _WIN32
+	#ifndef _WIN32_WINNT
+		#define _WIN32_WINNT	0x0600
+	#endif
+
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+#endif
+
+
+// -------------------- Structures --------------------
+
+// The blocks a thread has cached for a single pool, and the generation of the pool they came from
+struct ThreadCache
+{
+	void*			myBlocks;
+	unsigned int	myCount;
+	unsigned int	myGeneration;
+};
+
+
+// ---------------------- Globals ---------------------
+
+// Zero initialised for every thread, indexed by pool id
+static VE_THREAD_LOCAL ThreadCache ourThreadCaches[VE_POOL_MAX_POOLS];
+
+
+// ---------------------- Statics ---------------------
+
+VEPoolAllocator*	VEPoolAllocator::ourPools[VE_POOL_MAX_POOLS];
+unsigned int		VEPoolAllocator::ourPoolGenerations[VE_POOL_MAX_POOLS];
+VEMutex				VEPoolAllocator::ourPoolsLock;
+
+
+// ----------------- Global Functions -----------------
+
+// Returns the calling thread's cache for a pool. Blocks cached from an earlier pool with the same id were released with
+// its pages, so they're forgotten
+static ThreadCache& GetThreadCache( int anId, unsigned int aGeneration )
+{
+	ThreadCache& threadCache = ourThreadCaches[anId];
+	if( threadCache.myGeneration != aGeneration )
+	{
+		threadCache.myBlocks		= NULL;
+		threadCache.myCount			= 0;
+		threadCache.myGeneration	= aGeneration;
+	}
+
+	return threadCache;
+}
+
+
+// Returns the size of the system's large pages, or 0 if they aren't supported
+static size_t GetLargePageSize()
+{
+#ifdef _WIN32
+	return GetLargePageMinimum();
+#else
+	return 0;
+#endif
+}
+
+
+// Reserves & commits pages from the system, returns NULL if they couldn't be
+static void* AllocatePages( size_t aSize, bool aUseLargePages )
+{
+#ifdef _WIN32
+	return VirtualAlloc( NULL, aSize, MEM_RESERVE | MEM_COMMIT | (aUseLargePages ? MEM_LARGE_PAGES : 0), PAGE_READWRITE );
+#else
+	void* pages = mmap( NULL, aSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+	return pages != MAP_FAILED ? pages : NULL;
+#endif
+}
+
+
+// Hands pages allocated by AllocatePages back to the system
+static void FreePages( void* somePages, size_t aSize )
+{
+#ifdef _WIN32
+	VirtualFree( somePages, 0, MEM_RELEASE );
+#else
+	munmap( somePages, aSize );
+#endif
+}
+
+
+// Gives decommitted pages their memory back, returns false if it couldn't be
+static bool CommitPages( void* somePages, size_t aSize )
+{
+#ifdef _WIN32
+	return VirtualAlloc( somePages, aSize, MEM_COMMIT, PAGE_READWRITE ) != NULL;
+#else
+	// Pages released with madvise are given memory again the next time they're touched
+	return true;
+#endif
+}
+
+
+// Hands pages' memory back to the system while keeping their addresses, returns false if it couldn't be
+static bool DecommitPages( void* somePages, size_t aSize )
+{
+#ifdef _WIN32
+	return VirtualFree( somePages, aSize, MEM_DECOMMIT ) != FALSE;
+#else
+	return madvise( somePages, aSize, MADV_DONTNEED ) == 0;
+#endif
+}
+
+
+// ------------------ Class Functions -----------------
+
+// Construction
+VEPoolAllocator::VEPoolAllocator( unsigned int aBlockSize, unsigned int aBlocksPerPage, unsigned int aThreadCacheSize, bool aUseLargePages ) :
+	myId( -1 ),
+	myGeneration( 0 ),
+	myBlockSize( 0 ),
+	myBlocksPerPage( aBlocksPerPage > 0 ? aBlocksPerPage : 1 ),
+	myThreadCacheSize( aThreadCacheSize ),
+	myPageSize( 0 ),
+	myUsesLargePages( false ),
+	myFreeBlocks( NULL ),
+	myBlocksInUse( 0 ),
+	myPeakBlocksInUse( 0 ),
+	myAllocationCount( 0 ),
+	myDecommittedBlocks( 0 )
+{
+	// Take the first free id. Generations start at 1, so no thread's zeroed cache matches a pool
+	{
+		VEScopedLock<VEMutex> lock( ourPoolsLock );
+
+		for( int i = 0; i < VE_POOL_MAX_POOLS && myId < 0; i++ )
+		{
+			if( ourPools[i] == NULL )
+			{
+				myId			= i;
+				myGeneration	= ++ourPoolGenerations[i];
+				ourPools[i]		= this;
+			}
+		}
+	}
+
+	assert( myId >= 0 && "More than VE_POOL_MAX_POOLS pools exist at once" );
+
+	// Blocks hold the free list link while they're unused, and are kept aligned
+	unsigned int blockSize	= aBlockSize > sizeof(FreeBlock) ? aBlockSize : sizeof(FreeBlock);
+	myBlockSize				= (blockSize + VE_POOL_BLOCK_ALIGNMENT - 1) & ~(VE_POOL_BLOCK_ALIGNMENT - 1);
+	myPageSize				= (size_t)myBlockSize * myBlocksPerPage;
+
+	// Large pages must be a multiple of the large page size, any space left over is filled with more blocks
+	if( aUseLargePages )
+	{
+		size_t largePageSize = GetLargePageSize();
+		if( largePageSize > 0 )
+		{
+			myPageSize			= (myPageSize + largePageSize - 1) & ~(largePageSize - 1);
+			myBlocksPerPage		= (unsigned int)(myPageSize / myBlockSize);
+			myUsesLargePages	= true;
+		}
+	}
+}
+
+
+// Deconstruction, releases every page. All blocks should have been freed by now
+VEPoolAllocator::~VEPoolAllocator()
+{
+	assert( myBlocksInUse == 0 );
+
+	// Only the calling thread's cache can be cleared. Other threads forget their cached blocks the next time they use
+	// the id, as the next pool given it has a different generation
+	if( myId >= 0 )
+	{
+		ourThreadCaches[myId].myBlocks	= NULL;
+		ourThreadCaches[myId].myCount	= 0;
+
+		VEScopedLock<VEMutex> lock( ourPoolsLock );
+		ourPools[myId] = NULL;
+	}
+
+	for( unsigned int i = 0; i < myPages.size(); i++ )
+	{
+		FreePages( myPages[i], myPageSize );
+		myPages[i] = NULL;
+	}
+	myPages.clear();
+}
+
+
+// Returns a free block
+void* VEPoolAllocator::Allocate()
+{
+	if( myId < 0 )
+	{
+		return NULL;
+	}
+
+	ThreadCache& threadCache = GetThreadCache( myId, myGeneration );
+	if( threadCache.myCount == 0 && !RefillThreadCache() )
+	{
+		return NULL;
+	}
+
+	FreeBlock* block		= (FreeBlock*)threadCache.myBlocks;
+	threadCache.myBlocks	= block->myNext;
+	threadCache.myCount--;
+
+	// Give a decommitted block its memory back, it's left in the list if that fails
+	if( block->myIsDecommitted )
+	{
+		if( !CommitPages((unsigned char*)block + VE_POOL_SYSTEM_PAGE_SIZE, myBlockSize - VE_POOL_SYSTEM_PAGE_SIZE) )
+		{
+			threadCache.myBlocks = block;
+			threadCache.myCount++;
+			return NULL;
+		}
+
+		myDecommittedBlocks--;
+	}
+
+	myAllocationCount++;
+
+	// Keep track of the high-water mark
+	unsigned int blocksInUse	= ++myBlocksInUse;
+	unsigned int peakBlocks		= myPeakBlocksInUse.load();
+	while( blocksInUse > peakBlocks && !myPeakBlocksInUse.compare_exchange_weak(peakBlocks, blocksInUse) )
+	{
+	}
+
+	// Pools with no thread cache hand everything straight back
+	if( myThreadCacheSize == 0 && threadCache.myCount > 0 )
+	{
+		FlushThreadCache( 0 );
+	}
+
+	return block;
+}
+
+
+// Returns a block to the pool
+void VEPoolAllocator::Free( void* aBlock )
+{
+	if( aBlock == NULL )
+	{
+		return;
+	}
+
+	ReturnBlock( aBlock, false );
+}
+
+
+// Returns a block to the pool and hands all but its first page back to the system, until the block is allocated again
+void VEPoolAllocator::FreeDecommitted( void* aBlock )
+{
+	if( aBlock == NULL )
+	{
+		return;
+	}
+
+	// The first page is kept for the free list link
+	bool isDecommitted = !myUsesLargePages && myBlockSize > VE_POOL_SYSTEM_PAGE_SIZE && myBlockSize % VE_POOL_SYSTEM_PAGE_SIZE == 0 &&
+						 DecommitPages( (unsigned char*)aBlock + VE_POOL_SYSTEM_PAGE_SIZE, myBlockSize - VE_POOL_SYSTEM_PAGE_SIZE );
+
+	if( isDecommitted )
+	{
+		myDecommittedBlocks++;
+	}
+
+	ReturnBlock( aBlock, isDecommitted );
+}
+
+
+// Adds a freed block to the calling thread's list
+void VEPoolAllocator::ReturnBlock( void* aBlock, bool anIsDecommitted )
+{
+	myBlocksInUse--;
+
+	ThreadCache& threadCache	= GetThreadCache( myId, myGeneration );
+	FreeBlock*	 block			= (FreeBlock*)aBlock;
+
+	block->myNext			= (FreeBlock*)threadCache.myBlocks;
+	block->myIsDecommitted	= anIsDecommitted;
+	threadCache.myBlocks	= block;
+	threadCache.myCount++;
+
+	// Once the thread has twice its share, hand half of it back so other threads can use it
+	if( threadCache.myCount > myThreadCacheSize * 2 )
+	{
+		FlushThreadCache( myThreadCacheSize );
+	}
+}
+
+
+// Hands the blocks cached by the calling thread back to their pools
+void VEPoolAllocator::ReleaseThreadCaches()
+{
+	VEScopedLock<VEMutex> lock( ourPoolsLock );
+
+	for( unsigned int i = 0; i < VE_POOL_MAX_POOLS; i++ )
+	{
+		if( ourPools[i] != NULL && ourThreadCaches[i].myCount > 0 && ourThreadCaches[i].myGeneration == ourPools[i]->myGeneration )
+		{
+			ourPools[i]->FlushThreadCache( 0 );
+		}
+	}
+}
+
+
+// Returns a snapshot of the pool's usage
+void VEPoolAllocator::GetStatistics( VEPoolStatistics& aStatistics )
+{
+	{
+		VEScopedLock<VEMutex> lock( myLock );
+
+		aStatistics.myPageCount		= myPages.size();
+		aStatistics.myReservedBytes	= myPages.size() * myPageSize;
+	}
+
+	aStatistics.myBlockSize			= myBlockSize;
+	aStatistics.myBlocksInUse		= myBlocksInUse;
+	aStatistics.myPeakBlocksInUse	= myPeakBlocksInUse;
+	aStatistics.myAllocationCount	= myAllocationCount;
+	aStatistics.myDecommittedBlocks	= myDecommittedBlocks;
+	aStatistics.myUsesLargePages	= myUsesLargePages;
+}
+
+
+// Moves a batch of blocks from the shared list in to the calling thread's list, allocating a page if needed
+bool VEPoolAllocator::RefillThreadCache()
+{
+	ThreadCache&	threadCache = GetThreadCache( myId, myGeneration );
+	unsigned int	batchSize	= myThreadCacheSize > 0 ? myThreadCacheSize : 1;
+
+	VEScopedLock<VEMutex> lock( myLock );
+
+	if( myFreeBlocks == NULL && !AllocatePage() )
+	{
+		return false;
+	}
+
+	while( myFreeBlocks != NULL && threadCache.myCount < batchSize )
+	{
+		FreeBlock* block		= myFreeBlocks;
+		myFreeBlocks			= block->myNext;
+
+		block->myNext			= (FreeBlock*)threadCache.myBlocks;
+		threadCache.myBlocks	= block;
+		threadCache.myCount++;
+	}
+
+	return true;
+}
+
+
+// Moves blocks from the calling thread's list back to the shared list
+void VEPoolAllocator::FlushThreadCache( unsigned int aKeepCount )
+{
+	ThreadCache& threadCache = GetThreadCache( myId, myGeneration );
+
+	VEScopedLock<VEMutex> lock( myLock );
+
+	while( threadCache.myCount > aKeepCount )
+	{
+		FreeBlock* block		= (FreeBlock*)threadCache.myBlocks;
+		threadCache.myBlocks	= block->myNext;
+		threadCache.myCount--;
+
+		block->myNext	= myFreeBlocks;
+		myFreeBlocks	= block;
+	}
+}
+
+
+// Allocates a new page and adds its blocks to the shared list. The lock must be held
+bool VEPoolAllocator::AllocatePage()
+{
+	void* page = NULL;
+	if( myUsesLargePages )
+	{
+		page = AllocatePages( myPageSize, true );
+	}
+
+	// Large pages often aren't available (missing privilege, fragmented physical memory), so stop asking for them
+	if( page == NULL )
+	{
+		myUsesLargePages = false;
+
+		page = AllocatePages( myPageSize, false );
+	}
+
+	if( page == NULL )
+	{
+		return false;
+	}
+
+	myPages.push_back( page );
+
+	// Push the blocks in reverse so they're handed out in address order
+	unsigned char* pageMemory = (unsigned char*)page;
+	for( int i = (int)myBlocksPerPage - 1; i >= 0; i-- )
+	{
+		FreeBlock* block		= (FreeBlock*)( pageMemory + (size_t)i * myBlockSize );
+		block->myNext			= myFreeBlocks;
+		block->myIsDecommitted	= false;
+		myFreeBlocks			= block;
+	}
+
+	return true;
+}
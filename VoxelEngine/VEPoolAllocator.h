@@ -0,0 +1,162 @@
+#ifndef VE_POOL_ALLOCATOR_H
+#define VE_POOL_ALLOCATOR_H
+
+
+// --------------------- Includes --------------------
+
+#include "VEThreading.h"
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+
+// --------------------- Defines ---------------------
+
+// The maximum number of pools that can exist at once. A destroyed pool's id is reused by the next pool created
+#define VE_POOL_MAX_POOLS			32
+
+// Blocks handed out by a pool are aligned to this many bytes
+#define VE_POOL_BLOCK_ALIGNMENT		16
+
+// The size of the pages freed blocks are decommitted in
+#define VE_POOL_SYSTEM_PAGE_SIZE	4096
+
+
+// -------------------- Structures -------------------
+
+// A snapshot of a pool's usage
+struct VEPoolStatistics
+{
+	VEPoolStatistics() :
+		myBlockSize( 0 ),
+		myPageCount( 0 ),
+		myReservedBytes( 0 ),
+		myBlocksInUse( 0 ),
+		myPeakBlocksInUse( 0 ),
+		myAllocationCount( 0 ),
+		myDecommittedBlocks( 0 ),
+		myUsesLargePages( false )
+	{
+	}
+
+	unsigned int	myBlockSize;
+	unsigned int	myPageCount;
+	size_t			myReservedBytes;
+
+	unsigned int	myBlocksInUse;
+	unsigned int	myPeakBlocksInUse;
+	unsigned int	myAllocationCount;
+
+	// Free blocks whose memory has been handed back to the system
+	unsigned int	myDecommittedBlocks;
+
+	bool			myUsesLargePages;
+};
+
+
+// --------------------- Classes ---------------------
+
+// Hands out fixed size blocks carved from large pages, recycling freed blocks rather than returning them to the
+// heap. Each thread keeps a small free list of its own so most allocations & frees don't touch the pool's lock;
+// blocks move between a thread's list and the shared list in batches. Pages are only released when the pool is
+// destroyed, so a pool sized for the peak never fragments the heap
+class VEPoolAllocator
+{
+	public :
+
+		// ------ Public Functions ------
+
+		// Construction. Large pages need the 'lock pages in memory' privilege, the pool falls back to normal pages
+		// when they can't be allocated. Blocks larger than a few kilobytes should set a small (or zero) thread
+		// cache, so threads don't sit on lots of memory. If VE_POOL_MAX_POOLS pools already exist the pool can't
+		// hand out any blocks, Allocate always returns NULL
+		VEPoolAllocator( unsigned int aBlockSize, unsigned int aBlocksPerPage, unsigned int aThreadCacheSize = 32, bool aUseLargePages = false );
+
+		// Deconstruction, releases every page. All blocks should have been freed by now
+		~VEPoolAllocator();
+
+		// Returns a free block
+		void*			Allocate();
+
+		// Returns a block to the pool
+		void			Free( void* aBlock );
+
+		// Returns a block to the pool and hands all but its first page back to the system, until the block is allocated
+		// again. For large blocks that may not be reused for a while. Blocks from large pages, or that aren't a whole
+		// number of pages, are simply freed
+		void			FreeDecommitted( void* aBlock );
+
+		// Hands the blocks cached by the calling thread back to their pools. Worker threads should call this
+		// before they exit, otherwise the blocks they cached can't be reused
+		static void		ReleaseThreadCaches();
+
+		// Returns a snapshot of the pool's usage
+		void			GetStatistics( VEPoolStatistics& aStatistics );
+
+
+		// --------- Accessors ----------
+
+		unsigned int	GetBlockSize()			{ return myBlockSize; }
+
+		bool			GetUsesLargePages()		{ return myUsesLargePages; }
+
+
+	private :
+
+		// ----- Private Structures -----
+
+		// A free block, the link is stored in the block's own memory
+		struct FreeBlock
+		{
+			FreeBlock*	myNext;
+			bool		myIsDecommitted;
+		};
+
+
+		// ------ Private Functions -----
+
+		// Adds a freed block to the calling thread's list
+		void			ReturnBlock( void* aBlock, bool anIsDecommitted );
+
+		// Moves a batch of blocks from the shared list in to the calling thread's list, allocating a page if needed.
+		// Returns false if the pool is out of memory
+		bool			RefillThreadCache();
+
+		// Moves blocks from the calling thread's list back to the shared list, until the thread has the supplied
+		// number of blocks left
+		void			FlushThreadCache( unsigned int aKeepCount );
+
+		// Allocates a new page and adds its blocks to the shared list. The lock must be held
+		bool			AllocatePage();
+
+
+		// ------ Private Variables -----
+
+		static VEPoolAllocator*		ourPools[VE_POOL_MAX_POOLS];
+		static unsigned int			ourPoolGenerations[VE_POOL_MAX_POOLS];
+		static VEMutex				ourPoolsLock;
+
+		// The pool's slot in the pools & every thread's caches, -1 if there wasn't a free one, and the number of pools
+		// that have had the slot, so blocks cached from an earlier pool in it are forgotten rather than handed out
+		int							myId;
+		unsigned int				myGeneration;
+
+		unsigned int				myBlockSize;
+		unsigned int				myBlocksPerPage;
+		unsigned int				myThreadCacheSize;
+		size_t						myPageSize;
+		bool						myUsesLargePages;
+
+		VEMutex						myLock;
+		FreeBlock*					myFreeBlocks;
+		std::vector<void*>			myPages;
+
+		std::atomic<unsigned int>	myBlocksInUse;
+		std::atomic<unsigned int>	myPeakBlocksInUse;
+		std::atomic<unsigned int>	myAllocationCount;
+		std::atomic<unsigned int>	myDecommittedBlocks;
+};
+
+
+#endif // !VE_POOL_ALLOCATOR_H
@@ -0,0 +1,442 @@
+// --------------------- Includes ---------------------
+
+#include "Stdafx.h"
+#include "VEProfiler.h"
+#include "VEThreading.h"
+
+#include <atomic>
+
+
+// --------------------- Structs ----------------------
+
+// A single completed zone
+struct ProfileEvent
+{
+	const char*	myName;
+	long long	myStartTime;
+	long long	myEndTime;
+};
+
+
+// A completed zone kept by a capture
+struct CapturedEvent
+{
+	ProfileEvent	myEvent;
+	unsigned int	myThreadId;
+};
+
+
+// The ring buffer a thread records its zones in to. Only the owning thread writes events, only the main
+// thread reads them
+struct ThreadBuffer
+{
+	ThreadBuffer() :
+		myWriteIndex( 0 ),
+		myReadIndex( 0 ),
+		myDroppedCount( 0 ),
+		myReleased( false ),
+		myThreadId( 0 )
+	{
+	}
+
+	ProfileEvent				myEvents[VE_PROFILE_BUFFER_SIZE];
+
+	std::atomic<unsigned int>	myWriteIndex;
+	std::atomic<unsigned int>	myReadIndex;
+	std::atomic<unsigned int>	myDroppedCount;
+	std::atomic<bool>			myReleased;
+
+	unsigned int				myThreadId;
+};
+
+
+// The recent samples of a single zone, in milliseconds
+struct ZoneHistory
+{
+	ZoneHistory() :
+		myCount( 0 ),
+		myNext( 0 )
+	{
+	}
+
+	float			mySamples[VE_PROFILE_ZONE_HISTORY];
+	unsigned int	myCount;
+	unsigned int	myNext;
+};
+
+
+// --------------------- Globals ----------------------
+
+// Read by every thread recording a zone, while the main thread initialises & uninitialises the profiler
+static std::atomic<bool>				ourInitialised( false );
+static VEMutex							ourBufferLock;
+
+// Bumped whenever the buffers are freed, so a thread whose buffer was freed since it last recorded takes a new one
+static std::atomic<unsigned int>		ourGeneration( 0 );
+
+static VE_THREAD_LOCAL ThreadBuffer*	ourThreadBuffer		= NULL;
+static VE_THREAD_LOCAL unsigned int		ourThreadGeneration	= 0;
+static std::vector<ThreadBuffer*>		ourActiveBuffers;
+static std::vector<ThreadBuffer*>		ourFreeBuffers;
+
+// Zones are kept by their name's contents, as the same name doesn't always share an address (string literals
+// aren't pooled between modules), with each address looked up by name only once
+static std::map<std::string, ZoneHistory>	ourZoneHistories;
+static std::map<const char*, ZoneHistory*>	ourZoneHistoriesByAddress;
+
+static bool								ourCapturing		= false;
+static std::vector<CapturedEvent>		ourCapturedEvents;
+static unsigned int						ourDroppedCount		= 0;
+static unsigned long long				ourCollectedCount	= 0;
+
+static long long						ourTimerFrequency	= 1;
+static long long						ourStartTime		= 0;
+
+
+// ----------------- Static Functions -----------------
+
+// Returns the calling thread's buffer, taking one from the free list or creating one on first use, or when the one it
+// had was freed by Uninitialise
+static ThreadBuffer* GetThreadBuffer()
+{
+	if( ourThreadBuffer != NULL && ourThreadGeneration == ourGeneration )
+	{
+		return ourThreadBuffer;
+	}
+
+	ourBufferLock.Lock();
+
+	ThreadBuffer* buffer = NULL;
+	if( !ourFreeBuffers.empty() )
+	{
+		buffer = ourFreeBuffers.back();
+		ourFreeBuffers.pop_back();
+	}
+	else
+	{
+		buffer = new ThreadBuffer();
+	}
+
+	buffer->myThreadId = GetCurrentThreadId();
+	buffer->myReleased.store( false, std::memory_order_relaxed );
+	ourActiveBuffers.push_back( buffer );
+
+	ourThreadGeneration = ourGeneration;
+
+	ourBufferLock.Unlock();
+
+	ourThreadBuffer = buffer;
+	return buffer;
+}
+
+
+// Converts a performance counter duration to milliseconds
+static double ToMilliseconds( long long aDuration )
+{
+	return ( (double)aDuration * 1000.0 ) / (double)ourTimerFrequency;
+}
+
+
+// Converts a performance counter value to microseconds since the profiler was initialised
+static double ToTraceTime( long long aTime )
+{
+	return ( (double)(aTime - ourStartTime) * 1000000.0 ) / (double)ourTimerFrequency;
+}
+
+
+// Adds a completed zone to its zone's history
+static void AddZoneSample( const ProfileEvent& anEvent )
+{
+	ZoneHistory*& historyByAddress = ourZoneHistoriesByAddress[anEvent.myName];
+	if( historyByAddress == NULL )
+	{
+		historyByAddress = &ourZoneHistories[anEvent.myName];
+	}
+
+	ZoneHistory& history = *historyByAddress;
+
+	history.mySamples[history.myNext] = (float)ToMilliseconds( anEvent.myEndTime - anEvent.myStartTime );
+	history.myNext = (history.myNext + 1) % VE_PROFILE_ZONE_HISTORY;
+	if( history.myCount < VE_PROFILE_ZONE_HISTORY )
+	{
+		history.myCount++;
+	}
+}
+
+
+// Writes a string to the trace, escaping any characters JSON doesn't allow
+static void WriteJsonString( std::ofstream& aStream, const char* aString )
+{
+	aStream << '"';
+	for( const char* character = aString; *character != '\0'; character++ )
+	{
+		if( *character == '"' || *character == '\\' )
+		{
+			aStream << '\\';
+		}
+
+		aStream << *character;
+	}
+	aStream << '"';
+}
+
+
+// ----------------- Class Functions ------------------
+
+// Prepares the profiler for use
+void VEProfiler::Initialise()
+{
+#ifdef VE_PROFILING_ENABLED
+	if( ourInitialised )
+	{
+		return;
+	}
+
+	ourTimerFrequency = GetFrequency();
+
+	ourStartTime = GetTime();
+
+	ourInitialised = true;
+#endif
+}
+
+
+// Frees the thread buffers and any captured zones
+void VEProfiler::Uninitialise()
+{
+	if( !ourInitialised )
+	{
+		return;
+	}
+
+	ourInitialised	= false;
+	ourThreadBuffer	= NULL;
+
+	// Every thread's buffer is freed, not just the calling thread's, so the others are told to take new ones
+	ourBufferLock.Lock();
+	ourGeneration++;
+
+	for( unsigned int i = 0; i < ourActiveBuffers.size(); i++ )
+	{
+		delete ourActiveBuffers[i];
+	}
+	ourActiveBuffers.clear();
+
+	for( unsigned int i = 0; i < ourFreeBuffers.size(); i++ )
+	{
+		delete ourFreeBuffers[i];
+	}
+	ourFreeBuffers.clear();
+	ourBufferLock.Unlock();
+
+	ourZoneHistoriesByAddress.clear();
+	ourZoneHistories.clear();
+	ourCapturedEvents.clear();
+	ourCapturing		= false;
+	ourDroppedCount		= 0;
+	ourCollectedCount	= 0;
+}
+
+
+// Collects the zones recorded by every thread since the last call
+void VEProfiler::EndFrame()
+{
+	if( !ourInitialised )
+	{
+		return;
+	}
+
+	VE_PROFILE_ZONE( "VEProfiler::EndFrame" );
+
+	ourBufferLock.Lock();
+	for( unsigned int i = 0; i < ourActiveBuffers.size(); )
+	{
+		ThreadBuffer* buffer = ourActiveBuffers[i];
+
+		// Read the released flag first, so no events written before the release are missed
+		bool released = buffer->myReleased.load( std::memory_order_acquire );
+
+		unsigned int readIndex	= buffer->myReadIndex.load( std::memory_order_relaxed );
+		unsigned int writeIndex	= buffer->myWriteIndex.load( std::memory_order_acquire );
+
+		ourCollectedCount += writeIndex - readIndex;
+
+		for( ; readIndex != writeIndex; readIndex++ )
+		{
+			const ProfileEvent& event = buffer->myEvents[readIndex % VE_PROFILE_BUFFER_SIZE];
+			AddZoneSample( event );
+
+			if( ourCapturing && ourCapturedEvents.size() < VE_PROFILE_MAX_CAPTURE_EVENTS )
+			{
+				CapturedEvent capturedEvent;
+				capturedEvent.myEvent		= event;
+				capturedEvent.myThreadId	= buffer->myThreadId;
+
+				ourCapturedEvents.push_back( capturedEvent );
+			}
+		}
+
+		buffer->myReadIndex.store( readIndex, std::memory_order_release );
+		ourDroppedCount += buffer->myDroppedCount.exchange( 0, std::memory_order_relaxed );
+
+		// Buffers released by finished threads can be reused once they've been emptied
+		if( released )
+		{
+			buffer->myReadIndex.store( 0, std::memory_order_relaxed );
+			buffer->myWriteIndex.store( 0, std::memory_order_relaxed );
+
+			ourFreeBuffers.push_back( buffer );
+			ourActiveBuffers[i] = ourActiveBuffers.back();
+			ourActiveBuffers.pop_back();
+		}
+		else
+		{
+			i++;
+		}
+	}
+	ourBufferLock.Unlock();
+}
+
+
+// Records a completed zone in the calling thread's buffer
+void VEProfiler::RecordZone( const char* aName, long long aStartTime, long long anEndTime )
+{
+	if( !ourInitialised )
+	{
+		return;
+	}
+
+	ThreadBuffer* buffer = GetThreadBuffer();
+
+	unsigned int writeIndex	= buffer->myWriteIndex.load( std::memory_order_relaxed );
+	unsigned int readIndex	= buffer->myReadIndex.load( std::memory_order_acquire );
+	if( writeIndex - readIndex >= VE_PROFILE_BUFFER_SIZE )
+	{
+		buffer->myDroppedCount.fetch_add( 1, std::memory_order_relaxed );
+		return;
+	}
+
+	ProfileEvent& event = buffer->myEvents[writeIndex % VE_PROFILE_BUFFER_SIZE];
+	event.myName		= aName;
+	event.myStartTime	= aStartTime;
+	event.myEndTime		= anEndTime;
+
+	buffer->myWriteIndex.store( writeIndex + 1, std::memory_order_release );
+}
+
+
+// Hands the calling thread's buffer back to the profiler
+void VEProfiler::ReleaseThreadBuffer()
+{
+	// A buffer freed by Uninitialise has nothing left to hand back
+	if( ourThreadBuffer != NULL && ourThreadGeneration == ourGeneration )
+	{
+		ourThreadBuffer->myReleased.store( true, std::memory_order_release );
+	}
+
+	ourThreadBuffer = NULL;
+}
+
+
+// Starts keeping collected zones for export
+void VEProfiler::BeginCapture()
+{
+	ourCapturedEvents.clear();
+	ourCapturing = true;
+}
+
+
+// Stops keeping collected zones
+void VEProfiler::EndCapture()
+{
+	ourCapturing = false;
+}
+
+
+// Writes the captured zones to a Chrome trace JSON file
+bool VEProfiler::ExportChromeTrace( const std::wstring& aFilename )
+{
+	std::ofstream file( aFilename.c_str() );
+	if( !file.is_open() )
+	{
+		return false;
+	}
+
+	// Complete ('X') events, timestamps & durations in microseconds with nanosecond precision
+	file.setf( std::ios::fixed );
+	file.precision( 3 );
+
+	file << "{\"traceEvents\":[\n";
+	for( unsigned int i = 0; i < ourCapturedEvents.size(); i++ )
+	{
+		const CapturedEvent& capturedEvent = ourCapturedEvents[i];
+
+		file << "{\"name\":";
+		WriteJsonString( file, capturedEvent.myEvent.myName );
+		file << ",\"cat\":\"VoxelEngine\",\"ph\":\"X\",\"pid\":1,\"tid\":" << capturedEvent.myThreadId;
+		file << ",\"ts\":" << ToTraceTime( capturedEvent.myEvent.myStartTime );
+		file << ",\"dur\":" << ToTraceTime( capturedEvent.myEvent.myEndTime ) - ToTraceTime( capturedEvent.myEvent.myStartTime );
+		file << "}" << ( i + 1 < ourCapturedEvents.size() ? ",\n" : "\n" );
+	}
+	file << "],\"displayTimeUnit\":\"ns\"}\n";
+
+	return file.good();
+}
+
+
+// Fills the supplied array with the runtime summary of every zone seen so far
+void VEProfiler::GetZoneSummaries( std::vector<VEProfileZoneSummary>& someSummaries )
+{
+	someSummaries.clear();
+
+	std::vector<float> sortedSamples;
+	sortedSamples.reserve( VE_PROFILE_ZONE_HISTORY );
+
+	for( std::map<std::string, ZoneHistory>::iterator iter = ourZoneHistories.begin(); iter != ourZoneHistories.end(); iter++ )
+	{
+		const ZoneHistory& history = iter->second;
+		if( history.myCount == 0 )
+		{
+			continue;
+		}
+
+		sortedSamples.assign( history.mySamples, history.mySamples + history.myCount );
+		std::sort( sortedSamples.begin(), sortedSamples.end() );
+
+		double total = 0.0;
+		for( unsigned int i = 0; i < sortedSamples.size(); i++ )
+		{
+			total += sortedSamples[i];
+		}
+
+		VEProfileZoneSummary summary;
+		summary.myName			= iter->first.c_str();
+		summary.mySampleCount	= history.myCount;
+		summary.myMinimum		= sortedSamples.front();
+		summary.myAverage		= total / (double)sortedSamples.size();
+		summary.myPercentile99	= sortedSamples[ ((sortedSamples.size() - 1) * 99) / 100 ];
+
+		someSummaries.push_back( summary );
+	}
+}
+
+
+// Whether a capture is running
+bool VEProfiler::IsCapturing()
+{
+	return ourCapturing;
+}
+
+
+// The number of zones dropped because a thread's buffer was full
+unsigned int VEProfiler::GetDroppedZoneCount()
+{
+	return ourDroppedCount;
+}
+
+
+// The number of zones collected since the profiler was initialised
+unsigned long long VEProfiler::GetCollectedZoneCount()
+{
+	return ourCollectedCount;
+}
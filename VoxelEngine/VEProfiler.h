@@ -0,0 +1,170 @@
+#ifndef VE_PROFILER_H
+#define VE_PROFILER_H
+
+
+// --------------------- Includes --------------------
+
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <chrono>
+#endif
+
+
+// --------------------- Defines ---------------------
+
+// Profiling zones are compiled in unless VE_PROFILING_DISABLED is defined, in which case the zone macros
+// expand to nothing
+#if !defined(VE_PROFILING_DISABLED) && !defined(VE_PROFILING_ENABLED)
+	#define VE_PROFILING_ENABLED
+#endif
+
+// The number of zones each thread can record before the main thread collects them. Zones recorded
+// while a thread's buffer is full are dropped
+#define VE_PROFILE_BUFFER_SIZE			4096
+
+// The number of recent samples kept for each zone's runtime summary
+#define VE_PROFILE_ZONE_HISTORY			256
+
+// The maximum number of zones kept by a trace capture
+#define VE_PROFILE_MAX_CAPTURE_EVENTS	1000000
+
+#define VE_PROFILE_CONCAT_INNER( a, b )	a##b
+#define VE_PROFILE_CONCAT( a, b )		VE_PROFILE_CONCAT_INNER( a, b )
+
+#ifdef VE_PROFILING_ENABLED
+	// Times the rest of the enclosing scope. The name must be a string literal
+	#define VE_PROFILE_ZONE( aName )	VEProfileZone VE_PROFILE_CONCAT( profileZone, __LINE__ )( aName )
+
+	// Hands the calling thread's buffer back to the profiler. Must be called before a worker thread exits
+	#define VE_PROFILE_THREAD_END()		VEProfiler::ReleaseThreadBuffer()
+#else
+	#define VE_PROFILE_ZONE( aName )
+	#define VE_PROFILE_THREAD_END()
+#endif
+
+
+// --------------------- Structs ---------------------
+
+// Runtime timings for a single zone, in milliseconds, over the zone's most recent samples
+struct VEProfileZoneSummary
+{
+	const char*		myName;
+	unsigned int	mySampleCount;
+
+	double			myMinimum;
+	double			myAverage;
+	double			myPercentile99;
+};
+
+
+// --------------------- Classes ---------------------
+
+// A low overhead CPU profiler. Each thread records its zones in to its own single producer, single consumer
+// ring buffer without taking any locks; the main thread collects every buffer once a frame, updating the
+// rolling per-zone summaries and, while a capture is running, keeping the zones for export as a Chrome trace
+// (chrome://tracing or ui.perfetto.dev)
+class VEProfiler
+{
+	public :
+
+		// ------ Public Functions ------
+
+		// Prepares the profiler for use. Zones recorded before this are ignored
+		static void		Initialise();
+
+		// Frees the thread buffers and any captured zones. No other thread can be recording zones while it runs;
+		// threads that recorded zones before are given a new buffer if the profiler is initialised again
+		static void		Uninitialise();
+
+		// Collects the zones recorded by every thread since the last call. Called once a frame by the main thread
+		static void		EndFrame();
+
+		// Records a completed zone in the calling thread's buffer. Times are performance counter values
+		static void		RecordZone( const char* aName, long long aStartTime, long long anEndTime );
+
+		// Hands the calling thread's buffer back to the profiler, so it can be reused by another thread
+		static void		ReleaseThreadBuffer();
+
+		// Starts keeping collected zones for export
+		static void		BeginCapture();
+
+		// Stops keeping collected zones
+		static void		EndCapture();
+
+		// Writes the captured zones to a Chrome trace JSON file
+		static bool		ExportChromeTrace( const std::wstring& aFilename );
+
+		// Fills the supplied array with the runtime summary of every zone seen so far
+		static void		GetZoneSummaries( std::vector<VEProfileZoneSummary>& someSummaries );
+
+		// Whether a capture is running
+		static bool		IsCapturing();
+
+		// The number of zones dropped because a thread's buffer was full
+		static unsigned int	GetDroppedZoneCount();
+
+		// The number of zones collected since the profiler was initialised
+		static unsigned long long	GetCollectedZoneCount();
+
+		// Returns the number of GetTime ticks in a second
+		static long long GetFrequency()
+		{
+#ifdef _WIN32
+			LARGE_INTEGER frequency;
+			return QueryPerformanceFrequency( &frequency ) ? frequency.QuadPart : 1;
+#else
+			return 1000000000;
+#endif
+		}
+
+		// Returns the current value of the performance counter, or of the steady clock in nanoseconds on platforms
+		// without one
+		static long long GetTime()
+		{
+#ifdef _WIN32
+			LARGE_INTEGER counter;
+			QueryPerformanceCounter( &counter );
+
+			return counter.QuadPart;
+#else
+			return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+#endif
+		}
+};
+
+
+// Times the scope it's declared in, use through the VE_PROFILE_ZONE macro
+class VEProfileZone
+{
+	public :
+
+		// ------ Public Functions ------
+
+		// Construction
+		VEProfileZone( const char* aName ) :
+			myName( aName ),
+			myStartTime( VEProfiler::GetTime() )
+		{
+		}
+
+		// Deconstruction. Records the zone
+		~VEProfileZone()
+		{
+			VEProfiler::RecordZone( myName, myStartTime, VEProfiler::GetTime() );
+		}
+
+
+	private :
+
+		// ------ Private Variables ------
+
+		const char*	myName;
+		long long	myStartTime;
+};
+
+
+#endif // !VE_PROFILER_H
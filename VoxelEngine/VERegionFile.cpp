@@ -0,0 +1,347 @@
+// --------------------- Includes ---------------------
+
+#include "Stdafx.h"
+#include "VERegionFile.h"
+
+#include <stddef.h>
+
+
+// ------------------ Class Functions -----------------
+
+// Construction
+VERegionFile::VERegionFile() :
+	myFile( NULL ),
+	myMapping( NULL ),
+	myView( NULL ),
+	myMappedSize( 0 ),
+	myHeaderSectors( (sizeof(RegionHeader) + VE_REGION_SECTOR_SIZE - 1) / VE_REGION_SECTOR_SIZE ),
+	myChunkCount( 0 ),
+	mySectorCount( 0 )
+{
+	memset( &myHeader, 0, sizeof(myHeader) );
+}
+
+
+// Deconstruction, closes the file
+VERegionFile::~VERegionFile()
+{
+	Close();
+}
+
+
+// Opens the region file, creating it if it doesn't exist
+bool VERegionFile::Open( const std::wstring& aFilename, int aChunkDimensions )
+{
+	Close();
+
+	myFile = CreateFileW( aFilename.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL );
+	if( myFile == INVALID_HANDLE_VALUE )
+	{
+		myFile = NULL;
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if( !GetFileSizeEx(myFile, &fileSize) )
+	{
+		Close();
+		return false;
+	}
+
+	if( fileSize.QuadPart == 0 )
+	{
+		// A new region, write an empty offset table
+		memset( &myHeader, 0, sizeof(myHeader) );
+		myHeader.myMagic			= VE_REGION_MAGIC;
+		myHeader.myVersion			= VE_REGION_VERSION;
+		myHeader.myRegionSize		= VE_REGION_SIZE;
+		myHeader.myChunkDimensions	= (unsigned int)aChunkDimensions;
+
+		if( !WriteFileData(0, &myHeader, sizeof(myHeader)) )
+		{
+			Close();
+			return false;
+		}
+
+		mySectorCount = myHeaderSectors;
+	}
+	else
+	{
+		DWORD bytesRead = 0;
+		if( !ReadFile(myFile, &myHeader, sizeof(myHeader), &bytesRead, NULL) || bytesRead != sizeof(myHeader) ||
+			myHeader.myMagic != VE_REGION_MAGIC || myHeader.myVersion != VE_REGION_VERSION || myHeader.myRegionSize != VE_REGION_SIZE ||
+			myHeader.myChunkDimensions != (unsigned int)aChunkDimensions )
+		{
+			Close();
+			return false;
+		}
+
+		mySectorCount = (unsigned int)( (fileSize.QuadPart + VE_REGION_SECTOR_SIZE - 1) / VE_REGION_SECTOR_SIZE );
+	}
+
+	// Work out which sectors are in use. Entries that point outside the file, or overlap the header, are dropped so the
+	// chunks are generated again rather than decoded from the wrong bytes
+	myUsedSectors.assign( mySectorCount, false );
+	SetSectorsUsed( 0, myHeaderSectors, true );
+
+	myChunkCount = 0;
+	for( unsigned int i = 0; i < VE_REGION_SIZE * VE_REGION_SIZE; i++ )
+	{
+		RegionEntry& entry = myHeader.myEntries[i];
+		if( entry.mySectorCount == 0 )
+		{
+			continue;
+		}
+
+		if( entry.mySector < myHeaderSectors || entry.mySector > mySectorCount || entry.mySectorCount > mySectorCount - entry.mySector ||
+			entry.mySize > entry.mySectorCount * VE_REGION_SECTOR_SIZE )
+		{
+			memset( &entry, 0, sizeof(entry) );
+			continue;
+		}
+
+		SetSectorsUsed( entry.mySector, entry.mySectorCount, true );
+		myChunkCount++;
+	}
+
+	if( !MapFile() )
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+
+// Unmaps & closes the file
+void VERegionFile::Close()
+{
+	UnmapFile();
+
+	if( myFile != NULL )
+	{
+		CloseHandle( myFile );
+		myFile = NULL;
+	}
+
+	myUsedSectors.clear();
+	mySectorCount	= 0;
+	myChunkCount	= 0;
+}
+
+
+// Whether the region holds a record for the chunk at the supplied coordinates
+bool VERegionFile::HasChunk( int aLocalX, int aLocalZ )
+{
+	assert( aLocalX >= 0 && aLocalX < VE_REGION_SIZE && aLocalZ >= 0 && aLocalZ < VE_REGION_SIZE );
+
+	VEScopedLock<VEMutex> lock( myLock );
+
+	return myHeader.myEntries[aLocalZ * VE_REGION_SIZE + aLocalX].mySectorCount > 0;
+}
+
+
+// Returns the chunk's record in the mapped view and locks the region
+const unsigned char* VERegionFile::LockChunk( int aLocalX, int aLocalZ, unsigned int& aSize )
+{
+	assert( aLocalX >= 0 && aLocalX < VE_REGION_SIZE && aLocalZ >= 0 && aLocalZ < VE_REGION_SIZE );
+
+	myLock.Lock();
+
+	const RegionEntry& entry = myHeader.myEntries[aLocalZ * VE_REGION_SIZE + aLocalX];
+	if( entry.mySectorCount == 0 )
+	{
+		myLock.Unlock();
+		return NULL;
+	}
+
+	// The record was written after the view was mapped
+	unsigned long long recordStart = (unsigned long long)entry.mySector * VE_REGION_SECTOR_SIZE;
+	if( recordStart + entry.mySize > myMappedSize && (!MapFile() || recordStart + entry.mySize > myMappedSize) )
+	{
+		myLock.Unlock();
+		return NULL;
+	}
+
+	aSize = entry.mySize;
+	return myView + recordStart;
+}
+
+
+// Unlocks the region after LockChunk
+void VERegionFile::UnlockChunk()
+{
+	myLock.Unlock();
+}
+
+
+// Writes the chunk's record to the file & the offset table
+bool VERegionFile::WriteChunk( int aLocalX, int aLocalZ, const unsigned char* aRecord, unsigned int aSize )
+{
+	assert( aLocalX >= 0 && aLocalX < VE_REGION_SIZE && aLocalZ >= 0 && aLocalZ < VE_REGION_SIZE );
+	assert( aRecord != NULL && aSize > 0 );
+
+	VEScopedLock<VEMutex> lock( myLock );
+
+	if( myFile == NULL )
+	{
+		return false;
+	}
+
+	unsigned int	entryIndex	= aLocalZ * VE_REGION_SIZE + aLocalX;
+	RegionEntry&	entry		= myHeader.myEntries[entryIndex];
+	unsigned int	sectorCount	= (aSize + VE_REGION_SECTOR_SIZE - 1) / VE_REGION_SECTOR_SIZE;
+
+	// Records that still fit are written over in place, otherwise the record moves
+	unsigned int sector;
+	if( entry.mySectorCount >= sectorCount )
+	{
+		sector = entry.mySector;
+		SetSectorsUsed( sector + sectorCount, entry.mySectorCount - sectorCount, false );
+	}
+	else
+	{
+		if( entry.mySectorCount == 0 )
+		{
+			myChunkCount++;
+		}
+
+		SetSectorsUsed( entry.mySector, entry.mySectorCount, false );
+		sector = AllocateSectors( sectorCount );
+		SetSectorsUsed( sector, sectorCount, true );
+	}
+
+	entry.mySector		= sector;
+	entry.mySectorCount	= sectorCount;
+	entry.mySize		= aSize;
+
+	bool succeeded = WriteFileData( (unsigned long long)sector * VE_REGION_SECTOR_SIZE, aRecord, aSize );
+
+	// A failed write drops the chunk from the region, rather than leaving the table pointing at a partial record
+	if( !succeeded )
+	{
+		SetSectorsUsed( sector, sectorCount, false );
+		memset( &entry, 0, sizeof(entry) );
+		myChunkCount--;
+	}
+
+	unsigned long long entryPosition = offsetof( RegionHeader, myEntries ) + entryIndex * sizeof(RegionEntry);
+	return WriteFileData( entryPosition, &entry, sizeof(entry) ) && succeeded;
+}
+
+
+// Returns the region coordinate holding a chunk grid coordinate, rounding down for negative coordinates
+int VERegionFile::GetRegionCoordinate( int aGridCoordinate )
+{
+	return aGridCoordinate >= 0 ? aGridCoordinate / VE_REGION_SIZE : (aGridCoordinate + 1) / VE_REGION_SIZE - 1;
+}
+
+
+// Writes bytes to the file at the supplied position
+bool VERegionFile::WriteFileData( unsigned long long aPosition, const void* someData, unsigned int aSize )
+{
+	LARGE_INTEGER position;
+	position.QuadPart = (LONGLONG)aPosition;
+
+	if( !SetFilePointerEx(myFile, position, NULL, FILE_BEGIN) )
+	{
+		return false;
+	}
+
+	DWORD bytesWritten = 0;
+	return WriteFile( myFile, someData, aSize, &bytesWritten, NULL ) && bytesWritten == aSize;
+}
+
+
+// Maps the whole file, replacing the current view
+bool VERegionFile::MapFile()
+{
+	UnmapFile();
+
+	LARGE_INTEGER fileSize;
+	if( !GetFileSizeEx(myFile, &fileSize) )
+	{
+		return false;
+	}
+
+	myMapping = CreateFileMappingW( myFile, NULL, PAGE_READONLY, 0, 0, NULL );
+	if( myMapping == NULL )
+	{
+		return false;
+	}
+
+	myView = reinterpret_cast<const unsigned char*>( MapViewOfFile(myMapping, FILE_MAP_READ, 0, 0, 0) );
+	if( myView == NULL )
+	{
+		UnmapFile();
+		return false;
+	}
+
+	myMappedSize = (unsigned long long)fileSize.QuadPart;
+
+	return true;
+}
+
+
+// Unmaps the current view
+void VERegionFile::UnmapFile()
+{
+	if( myView != NULL )
+	{
+		UnmapViewOfFile( myView );
+		myView = NULL;
+	}
+
+	if( myMapping != NULL )
+	{
+		CloseHandle( myMapping );
+		myMapping = NULL;
+	}
+
+	myMappedSize = 0;
+}
+
+
+// Returns the first sector of a free run of sectors, growing the file if there isn't one
+unsigned int VERegionFile::AllocateSectors( unsigned int aSectorCount )
+{
+	unsigned int runStart	= 0;
+	unsigned int runLength	= 0;
+	for( unsigned int i = myHeaderSectors; i < mySectorCount; i++ )
+	{
+		if( myUsedSectors[i] )
+		{
+			runLength = 0;
+			continue;
+		}
+
+		if( runLength == 0 )
+		{
+			runStart = i;
+		}
+
+		if( ++runLength == aSectorCount )
+		{
+			return runStart;
+		}
+	}
+
+	// Grow the file, carrying on from any free sectors at the end of it
+	unsigned int sector = runLength > 0 ? runStart : mySectorCount;
+
+	mySectorCount = sector + aSectorCount;
+	myUsedSectors.resize( mySectorCount, false );
+
+	return sector;
+}
+
+
+// Marks a run of sectors used or free
+void VERegionFile::SetSectorsUsed( unsigned int aSector, unsigned int aSectorCount, bool anIsUsed )
+{
+	for( unsigned int i = aSector; i < aSector + aSectorCount && i < mySectorCount; i++ )
+	{
+		myUsedSectors[i] = anIsUsed;
+	}
+}
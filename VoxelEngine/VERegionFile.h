@@ -0,0 +1,143 @@
+#ifndef VE_REGION_FILE_H
+#define VE_REGION_FILE_H
+
+
+// --------------------- Includes --------------------
+
+#include "VETypes.h"
+#include "VEThreading.h"
+
+
+// --------------------- Defines ---------------------
+
+// The number of chunks along each side of a region
+#define VE_REGION_SIZE				32
+
+// Chunks are stored in whole sectors, so a chunk that's saved again usually fits where it was
+#define VE_REGION_SECTOR_SIZE		4096
+
+// Identifies region files, and the version of the format they're written in
+#define VE_REGION_MAGIC				0x47455256
+#define VE_REGION_VERSION			1
+
+
+// --------------------- Classes ---------------------
+
+// A region file stores a square of VE_REGION_SIZE x VE_REGION_SIZE chunks. The file starts with a header holding an
+// offset table, giving the sectors each chunk's record was written to, followed by the records themselves. Records that
+// outgrow their sectors move to the first free run of sectors big enough, or the end of the file.
+//
+// Reads come straight from a read only view of the file mapped in to memory, so a chunk's record can be decoded in place.
+// Writes go through the file and are seen by the view, the view is remapped when the file grows past it. The region is
+// locked around each read & write, so one thread can save chunks while another loads them
+class VERegionFile
+{
+	public :
+
+		// ------ Public Functions ------
+
+		// Construction
+		VERegionFile();
+
+		// Deconstruction, closes the file
+		~VERegionFile();
+
+		// Opens the region file, creating it if it doesn't exist. Returns false if the file can't be opened, or holds a
+		// region in a different format or with a different chunk size
+		bool				Open( const std::wstring& aFilename, int aChunkDimensions );
+
+		// Unmaps & closes the file
+		void				Close();
+
+		// Whether the region holds a record for the chunk at the supplied coordinates, which are local to the region
+		bool				HasChunk( int aLocalX, int aLocalZ );
+
+		// Returns the chunk's record in the mapped view and locks the region, so the view stays mapped until UnlockChunk
+		// is called. Returns NULL, without locking, if the region has no record for the chunk
+		const unsigned char* LockChunk( int aLocalX, int aLocalZ, unsigned int& aSize );
+
+		// Unlocks the region after LockChunk
+		void				UnlockChunk();
+
+		// Writes the chunk's record to the file & the offset table. Returns false if the write failed
+		bool				WriteChunk( int aLocalX, int aLocalZ, const unsigned char* aRecord, unsigned int aSize );
+
+		// Returns the region coordinate holding a chunk grid coordinate, rounding down for negative coordinates
+		static int			GetRegionCoordinate( int aGridCoordinate );
+
+
+		// --------- Accessors ----------
+
+		// The size of the file & how much of it is mapped, in bytes
+		unsigned long long	GetFileSize()						{ return (unsigned long long)mySectorCount * VE_REGION_SECTOR_SIZE; }
+		unsigned long long	GetMappedSize()						{ return myMappedSize; }
+
+		// The number of chunks stored in the region
+		unsigned int		GetChunkCount()						{ return myChunkCount; }
+
+
+	private :
+
+		// ----- Private Structures -----
+
+		// Where a chunk's record is, a sector count of zero means the chunk isn't stored
+		struct RegionEntry
+		{
+			unsigned int	mySector;
+			unsigned int	mySectorCount;
+			unsigned int	mySize;
+		};
+
+		// The start of every region file
+		struct RegionHeader
+		{
+			unsigned int	myMagic;
+			unsigned int	myVersion;
+			unsigned int	myRegionSize;
+			unsigned int	myChunkDimensions;
+			RegionEntry		myEntries[VE_REGION_SIZE * VE_REGION_SIZE];
+		};
+
+
+		// ----- Private Functions ------
+
+		// Writes bytes to the file at the supplied position
+		bool				WriteFileData( unsigned long long aPosition, const void* someData, unsigned int aSize );
+
+		// Maps the whole file, replacing the current view
+		bool				MapFile();
+
+		// Unmaps the current view
+		void				UnmapFile();
+
+		// Returns the first sector of a free run of sectors, growing the file if there isn't one
+		unsigned int		AllocateSectors( unsigned int aSectorCount );
+
+		// Marks a run of sectors used or free
+		void				SetSectorsUsed( unsigned int aSector, unsigned int aSectorCount, bool anIsUsed );
+
+		// The region can't be copied
+		VERegionFile( const VERegionFile& );
+		VERegionFile& operator=( const VERegionFile& );
+
+
+		// ----- Private Variables ------
+
+		HANDLE					myFile;
+		HANDLE					myMapping;
+		const unsigned char*	myView;
+		unsigned long long		myMappedSize;
+
+		RegionHeader			myHeader;
+		unsigned int			myHeaderSectors;
+		unsigned int			myChunkCount;
+
+		// Which sectors hold the header or a record
+		std::vector<bool>		myUsedSectors;
+		unsigned int			mySectorCount;
+
+		VEMutex					myLock;
+};
+
+
+#endif // !VE_REGION_FILE_H
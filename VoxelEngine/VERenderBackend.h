@@ -0,0 +1,124 @@
+#ifndef VE_RENDER_BACKEND_H
+#define VE_RENDER_BACKEND_H
+
+
+// ---------------------- Includes ---------------------
+
+#include <atomic>
+
+
+// ---------------- Forward Declarations ---------------
+
+struct ID3D11Buffer;
+
+
+// ----------------------- Enums -----------------------
+
+// Types of GPU buffer that can be created through a render backend
+enum BufferType
+{
+	BT_Vertex,
+	BT_Index,
+
+	BT_Max
+};
+
+
+// ---------------------- Classes ----------------------
+
+// The interface between the engine and the graphics API for the work done outside of the render managers,
+// such as building chunk buffers. VEDirectXInterface is the real implementation; VENullRenderBackend
+// stands in when the engine runs headless. Both keep count of the buffers they create and the draw calls
+// they're asked to make. Doesn't need the platform's or D3D's headers, so the null backend builds anywhere
+class VERenderBackend
+{
+	public :
+
+		// --------- Public Functions ---------
+
+		// Construction
+		VERenderBackend() :
+			myBufferCount( 0 ),
+			myBufferBytes( 0 ),
+			myFrameCount( 0 ),
+			myDrawCallCount( 0 ),
+			myIndexCount( 0 ),
+			myLastFrameDrawCallCount( 0 ),
+			myLastFrameIndexCount( 0 )
+		{
+		}
+
+		// Deconstruction
+		virtual ~VERenderBackend()								{}
+
+
+		// -------- Required Functions --------
+
+		// Creates a vertex or index buffer holding the supplied data. Safe to call from worker threads
+		virtual bool	CreateBuffer( BufferType aType, const void* someData, unsigned int aByteWidth, ID3D11Buffer** aBuffer ) = 0;
+
+		// Draws indexed geometry using the currently bound buffers
+		virtual void	DrawIndexed( unsigned int anIndexCount ) = 0;
+
+		// Finishes the current frame
+		virtual void	PresentBuffer() = 0;
+
+
+		// ------------ Accessors -------------
+
+		// Totals since the backend was created
+		unsigned int		GetBufferCount()					{ return myBufferCount; }
+		unsigned long long	GetBufferBytes()					{ return myBufferBytes; }
+		unsigned int		GetFrameCount()						{ return myFrameCount; }
+
+		// Draw calls made during the last presented frame
+		unsigned int		GetLastFrameDrawCallCount()			{ return myLastFrameDrawCallCount; }
+		unsigned int		GetLastFrameIndexCount()			{ return myLastFrameIndexCount; }
+
+
+	protected :
+
+		// -------- Protected Functions -------
+
+		// Records the creation of a buffer
+		void RecordBuffer( unsigned int aByteWidth )
+		{
+			myBufferCount++;
+			myBufferBytes += aByteWidth;
+		}
+
+		// Records a draw call
+		void RecordDraw( unsigned int anIndexCount )
+		{
+			myDrawCallCount++;
+			myIndexCount += anIndexCount;
+		}
+
+		// Records the end of a frame, starting the draw counts for the next one
+		void RecordPresent()
+		{
+			myLastFrameDrawCallCount	= myDrawCallCount;
+			myLastFrameIndexCount		= myIndexCount;
+
+			myDrawCallCount	= 0;
+			myIndexCount	= 0;
+			myFrameCount++;
+		}
+
+
+	private :
+
+		// -------- Private Variables ---------
+
+		std::atomic<unsigned int>		myBufferCount;
+		std::atomic<unsigned long long>	myBufferBytes;
+
+		unsigned int					myFrameCount;
+		unsigned int					myDrawCallCount;
+		unsigned int					myIndexCount;
+		unsigned int					myLastFrameDrawCallCount;
+		unsigned int					myLastFrameIndexCount;
+};
+
+
+#endif // !VE_RENDER_BACKEND_H
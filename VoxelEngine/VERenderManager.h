@@ -5,6 +5,8 @@
 // ---------------------- Includes ---------------------
 
 #include "VETypes.h"
+#include "VERenderState.h"
+#include "VEShaderManager.h"
 
 
 // ---------------------- Classes ----------------------
@@ -27,6 +29,10 @@ class VERenderManager
 		// Signals that the render manager should save the current frame to images on the disk
 		void				CaptureFrame()	{ myCaptureFrame = true; }
 
+		// Adds the shaders & textures the render manager loads when it's initialised, so startup can load them ahead of
+		// it alongside other work
+		virtual void		GetResources( std::vector<VEShaderType>& someShaderTypes, std::vector<std::wstring>& someTextureFiles )	{}
+
 		
 		// -------- Required Functions --------
 
@@ -36,8 +42,9 @@ class VERenderManager
 		// Cleans up the render manager
 		virtual void		Uninitialise() = 0;
 
-		// Draws all of the voxels
-		virtual void		RenderScene() = 0;
+		// Draws a frame from the captured render state. May be called from the render thread, so render managers
+		// read the camera, lights & chunks from the state rather than the engine
+		virtual void		RenderScene( VERenderState& aRenderState ) = 0;
 
 
 		// ------------ Accessors ------------
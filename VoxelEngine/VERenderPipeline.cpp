@@ -0,0 +1,257 @@
+// ---------------------- Includes ----------------------
+
+#include "Stdafx.h"
+#include "VERenderPipeline.h"
+
+#include "VERenderManager.h"
+#include "VEInputService.h"
+#include "VEPoolAllocator.h"
+#include "VEProfiler.h"
+
+
+// ------------------- Class Functions ------------------
+
+// Construction
+VERenderPipeline::VERenderPipeline() :
+	myRenderer( NULL ),
+	myInputService( NULL ),
+	myRenderThread( NULL ),
+	mySubmittedCount( 0 ),
+	myRenderedCount( 0 ),
+	myStopping( false ),
+	myLastLatency( 0 ),
+	myLatencyTotal( 0 ),
+	myLatencyCount( 0 ),
+	myTimerFrequency( 1 )
+{
+	LARGE_INTEGER frequency;
+	if( QueryPerformanceFrequency(&frequency) )
+	{
+		myTimerFrequency = frequency.QuadPart;
+	}
+}
+
+
+// Deconstruction
+VERenderPipeline::~VERenderPipeline()
+{
+	assert( myRenderThread == NULL );
+}
+
+
+// Sets the render manager states are drawn with, and the input service their cameras are late latched from
+bool VERenderPipeline::Initialise( VERenderManager* aRenderer, VEInputService* anInputService /* NULL */ )
+{
+	if( aRenderer == NULL )
+	{
+		return false;
+	}
+
+	myRenderer		= aRenderer;
+	myInputService	= anInputService;
+
+	return true;
+}
+
+
+// Draws any states still queued and stops the render thread
+void VERenderPipeline::Uninitialise()
+{
+	SetPipelined( false );
+
+	myRenderer		= NULL;
+	myInputService	= NULL;
+}
+
+
+// Starts or stops the render thread. States already submitted are drawn first
+void VERenderPipeline::SetPipelined( bool isPipelined )
+{
+	if( isPipelined == GetPipelined() )
+	{
+		return;
+	}
+
+	if( isPipelined )
+	{
+		myStopping		= false;
+		myRenderThread	= new VEThread();
+
+		if( !myRenderThread->Start(VERenderPipeline::RenderThread, this) )
+		{
+			delete myRenderThread;
+			myRenderThread = NULL;
+		}
+		return;
+	}
+
+	{
+		VEScopedLock<VEMutex> lock( myLock );
+		myStopping = true;
+	}
+	myStateSubmitted.NotifyAll();
+
+	// The render thread draws every submitted state before it exits
+	myRenderThread->Join();
+
+	delete myRenderThread;
+	myRenderThread = NULL;
+}
+
+
+// Returns the state to capture the next frame in to. Waits if every state is still queued for drawing
+VERenderState* VERenderPipeline::BeginState()
+{
+	VE_PROFILE_ZONE( "VERenderPipeline::BeginState" );
+
+	VEScopedLock<VEMutex> lock( myLock );
+
+	while( mySubmittedCount - myRenderedCount >= VE_RENDER_STATE_COUNT )
+	{
+		myStateRendered.Wait( myLock );
+	}
+
+	return &myStates[mySubmittedCount % VE_RENDER_STATE_COUNT];
+}
+
+
+// Draws the state returned by BeginState, or queues it for the render thread
+void VERenderPipeline::SubmitState( VERenderState* aState )
+{
+	assert( aState == &myStates[mySubmittedCount % VE_RENDER_STATE_COUNT] );
+
+	if( !GetPipelined() )
+	{
+		mySubmittedCount++;
+		RenderState( aState );
+		return;
+	}
+
+	{
+		VEScopedLock<VEMutex> lock( myLock );
+		mySubmittedCount++;
+	}
+	myStateSubmitted.NotifyOne();
+}
+
+
+// Waits until every submitted state has been drawn
+void VERenderPipeline::Flush()
+{
+	VEScopedLock<VEMutex> lock( myLock );
+
+	while( myRenderedCount != mySubmittedCount )
+	{
+		myStateRendered.Wait( myLock );
+	}
+}
+
+
+// Clears the latency measurements
+void VERenderPipeline::ResetStatistics()
+{
+	VEScopedLock<VEMutex> lock( myLock );
+
+	myLastLatency	= 0;
+	myLatencyTotal	= 0;
+	myLatencyCount	= 0;
+}
+
+
+// The input latency of the last drawn frame, in milliseconds
+double VERenderPipeline::GetLastLatency()
+{
+	VEScopedLock<VEMutex> lock( myLock );
+	return ToMilliseconds( myLastLatency );
+}
+
+
+// The average input latency of the frames drawn since the statistics were reset, in milliseconds
+double VERenderPipeline::GetAverageLatency()
+{
+	VEScopedLock<VEMutex> lock( myLock );
+
+	if( myLatencyCount == 0 )
+	{
+		return 0.0;
+	}
+
+	return ToMilliseconds( myLatencyTotal ) / (double)myLatencyCount;
+}
+
+
+// Late latches the state's camera, draws the state, releases its chunks' buffers and records the frame's latency
+void VERenderPipeline::RenderState( VERenderState* aState )
+{
+	assert( myRenderer != NULL );
+
+	// Turn the camera by the mouse movement that arrived after the frame was simulated, just before its view matrix
+	// is used. Input devices are only polled on the main thread, the render thread uses the newest input it has read
+	if( myInputService != NULL && aState->GetCamera() != NULL )
+	{
+		long long latchTime = myInputService->LateLatch( *aState->GetCamera(), aState->GetDispatchedMouseX(), aState->GetDispatchedMouseY(), !GetPipelined() );
+		if( latchTime != 0 )
+		{
+			aState->SetInputTime( latchTime );
+		}
+	}
+
+	myRenderer->RenderScene( *aState );
+	aState->Release();
+
+	long long latency = VEProfiler::GetTime() - aState->GetInputTime();
+
+	{
+		VEScopedLock<VEMutex> lock( myLock );
+
+		myLastLatency	= latency;
+		myLatencyTotal	+= latency;
+		myLatencyCount++;
+
+		myRenderedCount++;
+	}
+	myStateRendered.NotifyAll();
+}
+
+
+// Draws submitted states until the pipeline is stopped
+unsigned int VERenderPipeline::RenderThread( void* aPipeline )
+{
+	VERenderPipeline* pipeline = reinterpret_cast<VERenderPipeline*>( aPipeline );
+	assert( pipeline != NULL );
+
+	for( ;; )
+	{
+		VERenderState* state = NULL;
+		{
+			VEScopedLock<VEMutex> lock( pipeline->myLock );
+
+			while( pipeline->myRenderedCount == pipeline->mySubmittedCount && !pipeline->myStopping )
+			{
+				pipeline->myStateSubmitted.Wait( pipeline->myLock );
+			}
+
+			if( pipeline->myRenderedCount == pipeline->mySubmittedCount )
+			{
+				break;
+			}
+
+			state = &pipeline->myStates[pipeline->myRenderedCount % VE_RENDER_STATE_COUNT];
+		}
+
+		pipeline->RenderState( state );
+	}
+
+	// Hand the profiler buffer & the thread's pooled blocks back before the thread exits
+	VEPoolAllocator::ReleaseThreadCaches();
+	VE_PROFILE_THREAD_END();
+
+	return 0;
+}
+
+
+// Converts a performance counter duration to milliseconds
+double VERenderPipeline::ToMilliseconds( long long aDuration )
+{
+	return ( (double)aDuration * 1000.0 ) / (double)myTimerFrequency;
+}
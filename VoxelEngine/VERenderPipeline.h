@@ -0,0 +1,121 @@
+#ifndef VE_RENDER_PIPELINE_H
+#define VE_RENDER_PIPELINE_H
+
+
+// ---------------------- Includes ---------------------
+
+#include "VETypes.h"
+#include "VEThreading.h"
+#include "VERenderState.h"
+
+
+// ------------------ Forward Declarations -------------
+
+class VERenderManager;
+class VEInputService;
+
+
+// ---------------------- Defines ----------------------
+
+// The number of render states cycled through. With three, simulation can run a frame ahead of the frame being drawn
+// while the state for the frame after that is filled in. Two also works, but simulation waits for the render thread
+// more often
+#define VE_RENDER_STATE_COUNT		3
+
+
+// ---------------------- Classes ----------------------
+
+// Hands captured render states to the render manager. By default a state is drawn as soon as it's submitted, on the
+// submitting thread. Pipelined, states are drawn in order by a render thread, so simulating the next frame overlaps
+// drawing the last one. Also measures the input latency of each frame: the time from reading the input a frame was
+// simulated from to presenting the frame
+class VERenderPipeline
+{
+	public :
+
+		// --------- Public Functions ---------
+
+		// Construction
+		VERenderPipeline();
+
+		// Deconstruction
+		~VERenderPipeline();
+
+		// Sets the render manager states are drawn with, and the input service their cameras are late latched from
+		bool			Initialise( VERenderManager* aRenderer, VEInputService* anInputService = NULL );
+
+		// Draws any states still queued and stops the render thread
+		void			Uninitialise();
+
+		// Starts or stops the render thread. States already submitted are drawn first
+		void			SetPipelined( bool isPipelined );
+
+		// Returns the state to capture the next frame in to. Waits if every state is still queued for drawing
+		VERenderState*	BeginState();
+
+		// Draws the state returned by BeginState, or queues it for the render thread
+		void			SubmitState( VERenderState* aState );
+
+		// Waits until every submitted state has been drawn
+		void			Flush();
+
+		// Clears the latency measurements
+		void			ResetStatistics();
+
+
+		// ------------ Accessors -------------
+
+		bool			GetPipelined()					{ return myRenderThread != NULL; }
+
+		// The input latency of the last drawn frame, in milliseconds
+		double			GetLastLatency();
+
+		// The average input latency of the frames drawn since the statistics were reset, in milliseconds
+		double			GetAverageLatency();
+
+		unsigned int	GetRenderedFrameCount()			{ return myRenderedCount; }
+
+
+	private :
+
+		// --------- Private Functions --------
+
+		// Late latches the state's camera, draws the state, releases its chunks' buffers and records the frame's latency
+		void				RenderState( VERenderState* aState );
+
+		// Draws submitted states until the pipeline is stopped
+		static unsigned int	RenderThread( void* aPipeline );
+
+		// Converts a performance counter duration to milliseconds
+		double				ToMilliseconds( long long aDuration );
+
+		// The pipeline can't be copied
+		VERenderPipeline( const VERenderPipeline& );
+		VERenderPipeline& operator=( const VERenderPipeline& );
+
+
+		// --------- Private Variables --------
+
+		VERenderManager*		myRenderer;
+		VEInputService*			myInputService;
+		VEThread*				myRenderThread;
+
+		// States are used in order: state (n % VE_RENDER_STATE_COUNT) holds frame n. Frames before the rendered count
+		// have been drawn, frames before the submitted count are waiting to be
+		VERenderState			myStates[VE_RENDER_STATE_COUNT];
+		unsigned int			mySubmittedCount;
+		unsigned int			myRenderedCount;
+		bool					myStopping;
+
+		VEMutex					myLock;
+		VEConditionVariable		myStateSubmitted;
+		VEConditionVariable		myStateRendered;
+
+		long long				myLastLatency;
+		long long				myLatencyTotal;
+		unsigned int			myLatencyCount;
+		long long				myTimerFrequency;
+};
+
+
+#endif // !VE_RENDER_PIPELINE_H
@@ -0,0 +1,132 @@
+// ---------------------- Includes ----------------------
+
+#include "Stdafx.h"
+#include "VERenderState.h"
+
+#include "VEChunk.h"
+#include "VEChunkData.h"
+#include "VELightingManager.h"
+#include "VEInputService.h"
+#include "VEMemoryTracker.h"
+#include "VEProfiler.h"
+
+
+// ---------------------- Functions ---------------------
+
+// Replaces the copies with copies of the supplied lights, the copies keep their capacity
+template <typename T>
+static void CopyLights( const std::vector<T*>& someLights, std::vector<T>& someCopies )
+{
+	someCopies.clear();
+
+	for( unsigned int i = 0; i < someLights.size(); i++ )
+	{
+		someCopies.push_back( *someLights[i] );
+	}
+}
+
+
+// ------------------- Class Functions ------------------
+
+// Construction
+VERenderState::VERenderState() :
+	myCamera( CT_Basic ),
+	myHasCamera( false ),
+	myInputTime( 0 ),
+	myDispatchedMouseX( 0 ),
+	myDispatchedMouseY( 0 )
+{
+}
+
+
+// Deconstruction, releases the chunks' buffers
+VERenderState::~VERenderState()
+{
+	Release();
+}
+
+
+// Copies the camera & lights, takes a reference to each chunk's buffers, and records how much input the frame was
+// simulated from
+void VERenderState::Capture( VEBasicCamera* aCamera, VELightingManager* aLightingManager, const VEChunkRenderList& someChunks, VEInputService* anInputService )
+{
+	VE_PROFILE_ZONE( "VERenderState::Capture" );
+
+	VE_MEMORY_TAG( MEM_RenderLists );
+
+	assert( myChunks.empty() );
+
+	// The view matrix is brought up to date first, the copy only holds the base camera's state
+	myHasCamera = aCamera != NULL;
+	if( myHasCamera )
+	{
+		aCamera->GetView();
+		myCamera = *aCamera;
+	}
+
+	myChunks.reserve( someChunks.size() );
+	for( unsigned int i = 0; i < someChunks.size(); i++ )
+	{
+		VEChunkData* renderData = someChunks[i]->GetRenderData();
+
+		VEChunkDrawItem drawItem;
+		drawItem.myVertexBuffer	= renderData->GetVertexBuffer();
+		drawItem.myIndexBuffer	= renderData->GetIndexBuffer();
+		drawItem.myIndexCount	= renderData->GetIndexCount();
+		drawItem.myPosition		= someChunks[i]->GetPosition();
+
+		if( drawItem.myVertexBuffer != NULL )
+		{
+			drawItem.myVertexBuffer->AddRef();
+		}
+
+		if( drawItem.myIndexBuffer != NULL )
+		{
+			drawItem.myIndexBuffer->AddRef();
+		}
+
+		myChunks.push_back( drawItem );
+	}
+
+	// The lights are copied whole, the renderer reads their colours, directions, shadow settings & matrices
+	if( aLightingManager != NULL )
+	{
+		CopyLights( aLightingManager->GetDirectionalLights(), myDirectionalLights );
+		CopyLights( aLightingManager->GetPointLights(), myPointLights );
+		CopyLights( aLightingManager->GetSpotLights(), mySpotLights );
+	}
+
+	myInputTime			= VEProfiler::GetTime();
+	myDispatchedMouseX	= 0;
+	myDispatchedMouseY	= 0;
+
+	if( anInputService != NULL )
+	{
+		myInputTime			= anInputService->GetSampleTime();
+		myDispatchedMouseX	= anInputService->GetDispatchedMouseX();
+		myDispatchedMouseY	= anInputService->GetDispatchedMouseY();
+	}
+}
+
+
+// Releases the chunks' buffers, once the state has been drawn
+void VERenderState::Release()
+{
+	for( unsigned int i = 0; i < myChunks.size(); i++ )
+	{
+		if( myChunks[i].myVertexBuffer != NULL )
+		{
+			myChunks[i].myVertexBuffer->Release();
+		}
+
+		if( myChunks[i].myIndexBuffer != NULL )
+		{
+			myChunks[i].myIndexBuffer->Release();
+		}
+	}
+	myChunks.clear();
+
+	myDirectionalLights.clear();
+	myPointLights.clear();
+	mySpotLights.clear();
+}
@@ -0,0 +1,111 @@
+#ifndef VE_RENDER_STATE_H
+#define VE_RENDER_STATE_H
+
+
+// ---------------------- Includes ---------------------
+
+#include "VETypes.h"
+#include "VEBasicCamera.h"
+#include "VEChunkManager.h"
+#include "VEDirectionalLight.h"
+#include "VEPointLight.h"
+#include "VESpotLight.h"
+
+
+// ------------------ Forward Declarations -------------
+
+class VELightingManager;
+class VEInputService;
+
+
+// ---------------------- Structures -------------------
+
+// The buffers a chunk is drawn from, as they were when the render state was captured. Chunk meshes are built around
+// the origin, they're drawn offset by the chunk's position
+struct VEChunkDrawItem
+{
+	ID3D11Buffer*		myVertexBuffer;
+	ID3D11Buffer*		myIndexBuffer;
+	unsigned int		myIndexCount;
+	DirectX::XMFLOAT3	myPosition;
+};
+
+
+// ---------------------- Classes ----------------------
+
+// Everything the render managers read while drawing a frame, captured at the end of the frame's simulation so the
+// frame can be drawn while the next one is simulated. The camera & lights are copied, so the game can move, change or
+// remove them while the frame is drawn. Chunks are held by their buffers: each buffer is add-ref'd, so a chunk can be
+// rebuilt (releasing its old buffers) while the old ones are still being drawn. The state's lists keep their capacity,
+// so capturing a state doesn't allocate once the world has settled
+class VERenderState
+{
+	public :
+
+		// --------- Public Functions ---------
+
+		// Construction
+		VERenderState();
+
+		// Deconstruction, releases the chunks' buffers
+		~VERenderState();
+
+		// Copies the camera & lights, takes a reference to each chunk's buffers, and records how much input the frame was
+		// simulated from
+		void			Capture( VEBasicCamera* aCamera, VELightingManager* aLightingManager, const VEChunkRenderList& someChunks, VEInputService* anInputService );
+
+		// Releases the chunks' buffers, once the state has been drawn
+		void			Release();
+
+
+		// ------------ Accessors -------------
+
+		// The camera the frame is drawn from, NULL if the engine had no camera
+		VEBasicCamera*								GetCamera()						{ return myHasCamera ? &myCamera : NULL; }
+
+		const std::vector<VEChunkDrawItem>&			GetChunks() const				{ return myChunks; }
+
+		// The copies of the lights. They aren't const, as lights work out their matrices the first time they're read
+		std::vector<VEDirectionalLight>&			GetDirectionalLights()			{ return myDirectionalLights; }
+
+		std::vector<VEPointLight>&					GetPointLights()				{ return myPointLights; }
+
+		std::vector<VESpotLight>&					GetSpotLights()					{ return mySpotLights; }
+
+		// When the input the frame was simulated from was read, as a performance counter value. Late latching moves it
+		// on to when the input it used was read
+		long long									GetInputTime() const			{ return myInputTime; }
+		void										SetInputTime( long long aTime )	{ myInputTime = aTime; }
+
+		// The total mouse movement the simulation had received, late latching applies anything newer
+		long										GetDispatchedMouseX() const		{ return myDispatchedMouseX; }
+		long										GetDispatchedMouseY() const		{ return myDispatchedMouseY; }
+
+
+	private :
+
+		// --------- Private Functions --------
+
+		// Render states can't be copied, they hold references to the chunks' buffers
+		VERenderState( const VERenderState& );
+		VERenderState& operator=( const VERenderState& );
+
+
+		// --------- Private Variables --------
+
+		VEBasicCamera						myCamera;
+		bool								myHasCamera;
+
+		std::vector<VEChunkDrawItem>		myChunks;
+
+		std::vector<VEDirectionalLight>		myDirectionalLights;
+		std::vector<VEPointLight>			myPointLights;
+		std::vector<VESpotLight>			mySpotLights;
+
+		long long							myInputTime;
+		long								myDispatchedMouseX;
+		long								myDispatchedMouseY;
+};
+
+
+#endif // !VE_RENDER_STATE_H
@@ -8,6 +8,7 @@
 #include "VEDirectXInterface.h"
 #include "VETypes.h"
 #include "VEBasicCamera.h"
+#include "VEShaderManager.h"
 
 
 // ------------------ Namespaces ------------------
@@ -29,7 +30,8 @@ VEShader::VEShader( int aVertexCBSize, int aPixelCBSize ) :
 	mySamplerCount( 0 ),
 	myResourceCount( 0 ),
 	myVertexCBSize( aVertexCBSize ),
-	myPixelCBSize( aPixelCBSize )
+	myPixelCBSize( aPixelCBSize ),
+	myDrawOffset( 0.0f, 0.0f, 0.0f )
 {
     myPixelShaderFile       = L"";
     myPixelShaderProfile    = "ps_5_0";
@@ -84,6 +86,16 @@ bool VEShader::Initialise()
         return false;
     }
 
+    // Shaders loaded on their own rather than by the shader manager still compile their stages at once
+    if( myVertexRequest.myBytecode.empty() || myPixelRequest.myBytecode.empty() )
+    {
+        std::vector<VEShaderRequest*> requests;
+        GetShaderRequests( requests );
+
+        VoxelEngine* voxelEngine = VoxelEngine::GetInstance();
+        voxelEngine->GetShaderManager()->GetShaderCache()->LoadAll( requests, voxelEngine->GetJobSystem() );
+    }
+
     // A shader might not contain a vertex shader (post processing effects etc)
     if( !LoadVertexShader() )
     {
@@ -96,6 +108,10 @@ bool VEShader::Initialise()
         return false;
     }
 
+    // The device has its own copy of the bytecode
+    std::vector<unsigned char>().swap( myVertexRequest.myBytecode );
+    std::vector<unsigned char>().swap( myPixelRequest.myBytecode );
+
     // Create the constant & input buffers
     if( myVertexCBSize > 0 && !CreateVertexConstantBuffer() )
     {
@@ -112,6 +128,26 @@ bool VEShader::Initialise()
 }
 
 
+// Adds the requests for the shader's vertex & pixel bytecode
+void VEShader::GetShaderRequests( std::vector<VEShaderRequest*>& someRequests )
+{
+	std::wstring shaderDirectory = VoxelEngine::GetInstance()->GetDataDirectory() + L"Shaders/";
+
+	myVertexRequest.myFile		= shaderDirectory + myVertexShaderFile;
+	myVertexRequest.myFunction	= myVertexShaderFunction;
+	myVertexRequest.myProfile	= myVertexShaderProfile;
+	myVertexRequest.myFlags		= D3DCOMPILE_ENABLE_STRICTNESS;
+
+	myPixelRequest.myFile		= shaderDirectory + myPixelShaderFile;
+	myPixelRequest.myFunction	= myPixelShaderFunction;
+	myPixelRequest.myProfile	= myPixelShaderProfile;
+	myPixelRequest.myFlags		= D3DCOMPILE_ENABLE_STRICTNESS;
+
+	someRequests.push_back( &myVertexRequest );
+	someRequests.push_back( &myPixelRequest );
+}
+
+
 // Cleans up the memory used by the shader
 void VEShader::Uninitialise()
 {
@@ -147,13 +183,14 @@ void VEShader::Uninitialise()
 }
 
 
-// Fills the vertex shader constant buffer using the matrices from the supplied camera (world, view, projection)
+// Fills the vertex shader constant buffer using the matrices from the supplied camera (world, view, projection). The
+// draw offset is applied before the camera's world matrix
 bool VEShader::PopulateVertexShaderConstants( VEBasicCamera* aCamera, VELight* )
 {
 	HRESULT						result;
 	D3D11_MAPPED_SUBRESOURCE	mappedResource;
 	MatrixBuffer*				dataBuffer;
-	XMMATRIX					world			= XMLoadFloat4x4( &aCamera->GetWorld() );
+	XMMATRIX					world			= XMMatrixTranslation( myDrawOffset.x, myDrawOffset.y, myDrawOffset.z ) * XMLoadFloat4x4( &aCamera->GetWorld() );
 	XMMATRIX					view			= XMLoadFloat4x4( &aCamera->GetView() );
 	XMMATRIX					projection		= XMLoadFloat4x4( &aCamera->GetProjection() );
 
@@ -286,8 +323,8 @@ void VEShader::DrawIndexed( int anIndexCount )
 	deviceContext->VSSetShader( myVertexShader, NULL, 0 );
 	deviceContext->PSSetShader( myPixelShader, NULL, 0 );
 
-	// Draw the vertices
-	deviceContext->DrawIndexed( anIndexCount, 0, 0 );
+	// Draw the vertices through the render interface, so the draw is counted
+	renderInterface->DrawIndexed( anIndexCount );
 }
 
 
@@ -313,29 +350,13 @@ void VEShader::DrawInstanced( int anIndexCount, int anInstanceCount )
 
 
 // Logs an error in the shader log file
-void VEShader::LogError( ID3D10Blob* anErrorMessage, const std::string& aShaderFile )
+void VEShader::LogError( const std::string& someErrors )
 {
-    std::string     errors;
-    unsigned long   bufferSize;
     std::ofstream   outputFile;
 
-    // Grab the errors from the message
-	if( anErrorMessage != NULL )
-	{
-		errors      = (char*)anErrorMessage->GetBufferPointer();
-		bufferSize  = anErrorMessage->GetBufferSize();
-
-		anErrorMessage->Release();
-		anErrorMessage = NULL;
-	}
-	else
-	{
-		errors = "Unable to locate shader file : " + aShaderFile;
-	}
-
     // Write out the errors to a file
     outputFile.open( "shader-log.txt" );
-	outputFile.write( errors.c_str(), errors.size() );
+	outputFile.write( someErrors.c_str(), someErrors.size() );
     outputFile.close();
 }
 
@@ -357,7 +378,7 @@ bool VEShader::LoadVertexShader()
     }
 
     // Load the vertex shader in to the buffer
-    shaderBuffer = LoadShader(myVertexShaderFile, myVertexShaderFunction, myVertexShaderProfile);
+    shaderBuffer = LoadShader( myVertexRequest );
     if( shaderBuffer == NULL )
     {
         return false;
@@ -406,7 +427,7 @@ bool VEShader::LoadPixelShader()
     }
 
     // Load the pixel shader in to a buffer
-    shaderBuffer = LoadShader( myPixelShaderFile, myPixelShaderFunction, myPixelShaderProfile );
+    shaderBuffer = LoadShader( myPixelRequest );
     if( shaderBuffer == NULL )
     {
         return false;
@@ -432,35 +453,26 @@ bool VEShader::LoadPixelShader()
 }
 
 
-// Loads and compiles shader file from disk, storing the result in the supplied buffer
-ID3D10Blob* VEShader::LoadShader( const std::wstring& aFileName, const std::string& aMainFunction, const std::string& aShaderProfile )
+// Copies a request's bytecode, compiled or from the shader cache, in to a buffer the data layout can be created from
+ID3D10Blob* VEShader::LoadShader( const VEShaderRequest& aRequest )
 {
     HRESULT     result;
-    ID3D10Blob* errorMessage = NULL;
     ID3D10Blob* shaderBuffer = NULL;
 
-	std::wstring filePath = VoxelEngine::GetInstance()->GetDataDirectory();
-	filePath += L"Shaders/";
-	filePath += aFileName;
-
-    // Load the shader
-    result = D3DCompileFromFile(
-			filePath.c_str(),
-			NULL,
-			NULL,
-			aMainFunction.c_str(),
-			aShaderProfile.c_str(),
-			D3DCOMPILE_ENABLE_STRICTNESS,
-			0,
-			&shaderBuffer,
-			&errorMessage);
+    if( aRequest.myBytecode.empty() )
+    {
+        LogError( aRequest.myErrors );
+        return NULL;
+    }
 
+    result = D3DCreateBlob( aRequest.myBytecode.size(), &shaderBuffer );
     if( FAILED(result) )
     {
-        LogError( errorMessage, std::string(aFileName.begin(), aFileName.end()) );
         return NULL;
     }
 
+    memcpy( shaderBuffer->GetBufferPointer(), &aRequest.myBytecode[0], aRequest.myBytecode.size() );
+
     return shaderBuffer;
 }
 
@@ -2,6 +2,11 @@
 #define VE_SHADER_DX_H
 
 
+// ------------------- Includes -------------------
+
+#include "VEShaderCache.h"
+
+
 // ------------- Forward Declarations -------------
 
 class VEBasicCamera;
@@ -26,9 +31,14 @@ class VEShader
         // Deconstruction
         virtual ~VEShader();
 
-        // Loads the vertex & pixel shaders, initialises the associated buffers
+        // Loads the vertex & pixel shaders, initialises the associated buffers. Bytecode the shader manager hasn't
+        // already loaded through the shader cache is loaded first
         virtual bool        Initialise();
 
+		// Adds the requests for the shader's vertex & pixel bytecode, so the shader manager can load every shader's at
+		// once before the shaders are initialised
+		void				GetShaderRequests( std::vector<VEShaderRequest*>& someRequests );
+
 		// Cleans up the memory used by the shader
 		virtual void		Uninitialise();
 
@@ -70,6 +80,10 @@ class VEShader
 
 		ID3D11Buffer*		GetPixelBuffer()	{ return myPixelConstantBuffer; }
 
+		// Offsets the world matrix set by PopulateVertexShaderConstants, chunk meshes are built around the origin & drawn
+		// at the chunk's position
+		void				SetDrawOffset( const DirectX::XMFLOAT3& anOffset )	{ myDrawOffset = anOffset; }
+
 
     protected :
 
@@ -82,7 +96,7 @@ class VEShader
         // --------- Protected Functions --------
 
         // Logs an error in the shader log file
-        void				LogError( ID3D10Blob* anErrorMessage, const std::string& aShaderFile );
+        void				LogError( const std::string& someErrors );
 
 
         // --------- Protected Variables --------
@@ -109,6 +123,8 @@ class VEShader
 		int							myVertexCBSize;
 		int							myPixelCBSize;
 
+		DirectX::XMFLOAT3			myDrawOffset;
+
 
     private :
 
@@ -120,14 +136,21 @@ class VEShader
         // Loads and builds the pixel shader
         bool            LoadPixelShader();
 
-        // Loads and compiles shader file from disk, storing the result in the supplied buffer
-        ID3D10Blob*     LoadShader( const std::wstring& aFileName, const std::string& aMainFunction, const std::string& aShaderProfile );
+        // Copies a request's bytecode in to a buffer, logging the compiler's errors if it doesn't have any
+        ID3D10Blob*     LoadShader( const VEShaderRequest& aRequest );
 
 		// Creates the vertex shader constant buffer ( matrices)
 		bool			CreateVertexConstantBuffer();
 
 		// Creates the pixel shader buffer (e.g. lighting parameters)
 		bool			CreatePixelConstantBuffer();
+
+
+		// ---------- Private Variables ----------
+
+		// The bytecode is released once the shaders have been created
+		VEShaderRequest	myVertexRequest;
+		VEShaderRequest	myPixelRequest;
 };
 
 
@@ -0,0 +1,312 @@
+// ----------------------- Includes -----------------------
+
+// Built without the precompiled header, so the cache can be built & checked without the Windows SDK or D3D
+#include "VEShaderCache.h"
+
+#include "VEShaderStorage.h"
+#include "VEJobSystem.h"
+#include "VEProfiler.h"
+
+#include <cstring>
+
+
+// -------------------- Class Functions -------------------
+
+// Construction, with the storage the sources & entries are kept in, and the compiler & its version
+VEShaderCache::VEShaderCache( VEShaderStorage* aStorage, VEShaderCompiler aCompiler, unsigned int aCompilerVersion ) :
+	myStorage( aStorage ),
+	myIsOpen( false ),
+	myCompiler( aCompiler ),
+	myCompilerVersion( aCompilerVersion ),
+	myHitCount( 0 ),
+	myMissCount( 0 ),
+	myCompileTime( 0 )
+{
+}
+
+
+// Opens the cache in the supplied directory, creating the directory if it doesn't exist
+bool VEShaderCache::Open( const std::wstring& aDirectory )
+{
+	myIsOpen	= false;
+	myDirectory	= aDirectory;
+
+	if( !myStorage->MakeDirectory(myDirectory) )
+	{
+		return false;
+	}
+
+	myIsOpen = true;
+
+	return true;
+}
+
+
+// Closes the cache
+void VEShaderCache::Close()
+{
+	myIsOpen = false;
+}
+
+
+// Deletes every entry in the cache's directory
+void VEShaderCache::Clear()
+{
+	if( myIsOpen )
+	{
+		myStorage->DeleteData( myDirectory, L".vsc" );
+	}
+}
+
+
+// Fills in a request's bytecode, from the cache if it has an entry, otherwise by compiling its source
+bool VEShaderCache::Load( VEShaderRequest& aRequest )
+{
+	VE_PROFILE_ZONE( "VEShaderCache::Load" );
+
+	aRequest.myBytecode.clear();
+	aRequest.myErrors.clear();
+	aRequest.myIsCached = false;
+
+	// The source is read even when the bytecode is cached, it's part of the key
+	std::string source;
+	if( !myStorage->ReadData(aRequest.myFile, source) )
+	{
+		aRequest.myErrors = "Unable to locate shader file : " + std::string( aRequest.myFile.begin(), aRequest.myFile.end() );
+		return false;
+	}
+
+	unsigned long long key = CalculateKey( aRequest, source );
+	if( myIsOpen && ReadEntry(key, aRequest) )
+	{
+		VEScopedLock<VEMutex> lock( myStatisticsLock );
+		myHitCount++;
+
+		aRequest.myIsCached = true;
+		return true;
+	}
+
+	long long startTime = VEProfiler::GetTime();
+
+	bool succeeded = myCompiler( aRequest, source, aRequest.myBytecode, aRequest.myErrors ) && !aRequest.myBytecode.empty();
+	{
+		VEScopedLock<VEMutex> lock( myStatisticsLock );
+		myMissCount++;
+		myCompileTime += VEProfiler::GetTime() - startTime;
+	}
+
+	if( !succeeded )
+	{
+		aRequest.myBytecode.clear();
+		return false;
+	}
+
+	// A failed write only costs compiling the shader again next time
+	if( myIsOpen )
+	{
+		WriteEntry( key, aRequest );
+	}
+
+	return true;
+}
+
+
+// Loads a set of requests, running each on the job system if there is one
+bool VEShaderCache::LoadAll( const std::vector<VEShaderRequest*>& someRequests, VEJobSystem* aJobSystem )
+{
+	VE_PROFILE_ZONE( "VEShaderCache::LoadAll" );
+
+	if( aJobSystem == NULL || someRequests.size() < 2 )
+	{
+		bool succeeded = true;
+		for( unsigned int i = 0; i < someRequests.size(); i++ )
+		{
+			succeeded = Load( *someRequests[i] ) && succeeded;
+		}
+
+		return succeeded;
+	}
+
+	std::vector<LoadJob> jobs( someRequests.size() );
+
+	VEJobCounter counter;
+	for( unsigned int i = 0; i < jobs.size(); i++ )
+	{
+		jobs[i].myCache		= this;
+		jobs[i].myRequest	= someRequests[i];
+		jobs[i].mySucceeded	= false;
+
+		aJobSystem->Submit( VEShaderCache::LoadJobFunction, &jobs[i], &counter );
+	}
+
+	aJobSystem->Wait( counter );
+
+	bool succeeded = true;
+	for( unsigned int i = 0; i < jobs.size(); i++ )
+	{
+		succeeded = succeeded && jobs[i].mySucceeded;
+	}
+
+	return succeeded;
+}
+
+
+// Returns the key of a request with the supplied source
+unsigned long long VEShaderCache::CalculateKey( const VEShaderRequest& aRequest, const std::string& aSource )
+{
+	unsigned int version = VE_SHADER_CACHE_VERSION;
+
+	unsigned long long key = HashBytes( 0xcbf29ce484222325ull, &version, sizeof(version) );
+	key = HashBytes( key, &myCompilerVersion, sizeof(myCompilerVersion) );
+	key = HashBytes( key, &aRequest.myFlags, sizeof(aRequest.myFlags) );
+
+	// Each string is hashed with its terminator, so moving characters between them changes the key
+	key = HashBytes( key, aRequest.myFunction.c_str(), aRequest.myFunction.size() + 1 );
+	key = HashBytes( key, aRequest.myProfile.c_str(), aRequest.myProfile.size() + 1 );
+	key = HashBytes( key, aRequest.myDefines.c_str(), aRequest.myDefines.size() + 1 );
+
+	HashIncludes( key, aRequest.myFile, aSource, 0 );
+
+	return key;
+}
+
+
+// Sets the compiler, and a version mixed in to every key
+void VEShaderCache::SetCompiler( VEShaderCompiler aCompiler, unsigned int aCompilerVersion )
+{
+	myCompiler			= aCompiler;
+	myCompilerVersion	= aCompilerVersion;
+}
+
+
+// Clears the hit & miss counts, and the compile time
+void VEShaderCache::ResetStatistics()
+{
+	VEScopedLock<VEMutex> lock( myStatisticsLock );
+
+	myHitCount		= 0;
+	myMissCount		= 0;
+	myCompileTime	= 0;
+}
+
+
+// Mixes an included file's name & source in to a key, then the files it includes in turn. Every #include is followed,
+// even those the preprocessor would skip, which can only compile a shader more often than it needs to be
+void VEShaderCache::HashIncludes( unsigned long long& aKey, const std::wstring& aFile, const std::string& aSource, unsigned int aDepth )
+{
+	aKey = HashBytes( aKey, aSource.c_str(), aSource.size() + 1 );
+
+	if( aDepth >= VE_SHADER_INCLUDE_DEPTH )
+	{
+		return;
+	}
+
+	// Includes are relative to the including file's directory
+	size_t			separator	= aFile.find_last_of( L"/\\" );
+	std::wstring	directory	= separator == std::wstring::npos ? std::wstring() : aFile.substr( 0, separator + 1 );
+
+	size_t position = aSource.find( "#include" );
+	while( position != std::string::npos )
+	{
+		size_t nameStart	= aSource.find_first_of( "\"<\n", position + 8 );
+		size_t nameEnd		= nameStart == std::string::npos || aSource[nameStart] == '\n' ? std::string::npos :
+							  aSource.find_first_of( aSource[nameStart] == '"' ? "\"\n" : ">\n", nameStart + 1 );
+
+		if( nameEnd != std::string::npos && aSource[nameEnd] != '\n' )
+		{
+			std::string		name		= aSource.substr( nameStart + 1, nameEnd - nameStart - 1 );
+			std::wstring	includeFile	= directory + std::wstring( name.begin(), name.end() );
+
+			// A missing include only has its name hashed, the shader won't compile until it's there
+			std::string includeSource;
+			aKey = HashBytes( aKey, name.c_str(), name.size() + 1 );
+			if( myStorage->ReadData(includeFile, includeSource) )
+			{
+				HashIncludes( aKey, includeFile, includeSource, aDepth + 1 );
+			}
+		}
+
+		position = aSource.find( "#include", position + 8 );
+	}
+}
+
+
+// Reads the entry with the supplied key in to the request
+bool VEShaderCache::ReadEntry( unsigned long long aKey, VEShaderRequest& aRequest )
+{
+	std::string entry;
+	if( !myStorage->ReadData(GetEntryPath(aKey, L".vsc"), entry) || entry.size() < sizeof(EntryHeader) )
+	{
+		return false;
+	}
+
+	EntryHeader header;
+	memcpy( &header, entry.c_str(), sizeof(header) );
+
+	// Entries torn by a crash or written by another version are compiled again
+	const unsigned char* bytecode = (const unsigned char*)entry.c_str() + sizeof(header);
+	if( header.myMagic != VE_SHADER_CACHE_MAGIC || header.myKey != aKey || header.myBytecodeSize == 0 ||
+		entry.size() != sizeof(header) + header.myBytecodeSize || HashBytes(0xcbf29ce484222325ull, bytecode, header.myBytecodeSize) != header.myBytecodeHash )
+	{
+		return false;
+	}
+
+	aRequest.myBytecode.assign( bytecode, bytecode + header.myBytecodeSize );
+
+	return true;
+}
+
+
+// Writes the request's bytecode to the entry with the supplied key. The storage never shows it half written, and two
+// requests with the same key compiled at once write the same entry
+bool VEShaderCache::WriteEntry( unsigned long long aKey, const VEShaderRequest& aRequest )
+{
+	EntryHeader header;
+	header.myMagic			= VE_SHADER_CACHE_MAGIC;
+	header.myBytecodeSize	= (unsigned int)aRequest.myBytecode.size();
+	header.myKey			= aKey;
+	header.myBytecodeHash	= HashBytes( 0xcbf29ce484222325ull, &aRequest.myBytecode[0], header.myBytecodeSize );
+
+	std::string entry( sizeof(header) + header.myBytecodeSize, '\0' );
+	memcpy( &entry[0], &header, sizeof(header) );
+	memcpy( &entry[sizeof(header)], &aRequest.myBytecode[0], header.myBytecodeSize );
+
+	return myStorage->WriteData( GetEntryPath(aKey, L".vsc"), entry );
+}
+
+
+// Returns the path of the entry with the supplied key
+std::wstring VEShaderCache::GetEntryPath( unsigned long long aKey, const wchar_t* anExtension )
+{
+	// Entries are named after their key, in hex
+	std::wstring filename( 16, L'0' );
+	for( int i = 15; i >= 0; i-- )
+	{
+		filename[i]	= L"0123456789abcdef"[aKey & 0xf];
+		aKey		>>= 4;
+	}
+
+	return myDirectory + filename + anExtension;
+}
+
+
+// Mixes bytes in to a hash (FNV-1a)
+unsigned long long VEShaderCache::HashBytes( unsigned long long aHash, const void* someData, unsigned int aSize )
+{
+	const unsigned char* data = (const unsigned char*)someData;
+	for( unsigned int i = 0; i < aSize; i++ )
+	{
+		aHash ^= data[i];
+		aHash *= 0x100000001b3ull;
+	}
+
+	return aHash;
+}
+
+
+// Loads a request on a job system worker
+void VEShaderCache::LoadJobFunction( void* aJob )
+{
+	LoadJob* job = (LoadJob*)aJob;
+	job->mySucceeded = job->myCache->Load( *job->myRequest );
+}
@@ -0,0 +1,190 @@
+#ifndef VE_SHADER_CACHE_H
+#define VE_SHADER_CACHE_H
+
+
+// ----------------------- Includes -----------------------
+
+#include "VEThreading.h"
+
+#include <string>
+#include <vector>
+
+
+// ------------------ Forward Declarations ----------------
+
+class VEJobSystem;
+class VEShaderStorage;
+
+
+// ----------------------- Defines ------------------------
+
+// The version of the cache's entries. Bump it whenever the way shaders are compiled changes, so every entry made by an
+// older engine is compiled again
+#define VE_SHADER_CACHE_VERSION		1
+
+// Identifies the start of each cache entry
+#define VE_SHADER_CACHE_MAGIC		0x43534556
+
+// The directory, under the engine's data directory, the compiled shaders are kept in
+#define VE_SHADER_CACHE_DIRECTORY	L"ShaderCache/"
+
+// How deep includes are followed when hashing a shader's source
+#define VE_SHADER_INCLUDE_DEPTH		16
+
+
+// ---------------------- Structures ----------------------
+
+// A shader stage to load: the source file, how it's compiled, and once loaded the compiled bytecode
+struct VEShaderRequest
+{
+	VEShaderRequest() :
+		myFlags( 0 ),
+		myIsCached( false )
+	{
+	}
+
+	// The path of the HLSL source, its entry point & profile, the macros it's compiled with as "NAME=VALUE" pairs
+	// separated by ';', and the D3DCOMPILE flags
+	std::wstring				myFile;
+	std::string					myFunction;
+	std::string					myProfile;
+	std::string					myDefines;
+	unsigned int				myFlags;
+
+	// Filled in by the cache: the bytecode, the compiler's errors if there isn't any, and whether it came from the cache
+	std::vector<unsigned char>	myBytecode;
+	std::string					myErrors;
+	bool						myIsCached;
+};
+
+
+// ----------------------- Typedefs -----------------------
+
+// Compiles a request's HLSL source in to bytecode, filling in the errors if it fails. Called from the job system's
+// workers, so it has to be thread safe
+typedef bool (*VEShaderCompiler)( const VEShaderRequest& aRequest, const std::string& aSource, std::vector<unsigned char>& someBytecode,
+								  std::string& someErrors );
+
+
+// ----------------------- Classes ------------------------
+
+// Caches compiled shader bytecode on disk, so starting the engine again creates its shaders without compiling any HLSL.
+// Entries are keyed by a hash of the source, every file it includes, the entry point, profile, macros & flags, and the
+// version of the compiler, so editing a shader or anything it includes compiles it again. The key is the entry's name,
+// an entry that's missing or corrupt is compiled & written again.
+//
+// LoadAll fetches or compiles a set of requests at once on the job system. Sources & entries are read and written through
+// the supplied storage and bytecode comes from the supplied compiler, so the cache can be run without the disk or the
+// D3D compiler. Safe to use from any thread
+class VEShaderCache
+{
+	public :
+
+		// ------- Public Functions -------
+
+		// Construction, with the storage the sources & entries are kept in, and the compiler & its version
+		VEShaderCache( VEShaderStorage* aStorage, VEShaderCompiler aCompiler, unsigned int aCompilerVersion );
+
+		// Opens the cache in the supplied directory, creating the directory if it doesn't exist. While the cache is
+		// closed every request is compiled, and nothing is written
+		bool				Open( const std::wstring& aDirectory );
+
+		// Closes the cache
+		void				Close();
+
+		// Deletes every entry in the cache's directory
+		void				Clear();
+
+		// Fills in a request's bytecode, from the cache if its key has an entry, otherwise by compiling its source & adding
+		// the bytecode to the cache. Returns false if the source couldn't be read or didn't compile
+		bool				Load( VEShaderRequest& aRequest );
+
+		// Loads a set of requests, running each on the job system if there is one. Returns false if any failed
+		bool				LoadAll( const std::vector<VEShaderRequest*>& someRequests, VEJobSystem* aJobSystem );
+
+		// Returns the key of a request with the supplied source. Includes are read relative to the including file
+		unsigned long long	CalculateKey( const VEShaderRequest& aRequest, const std::string& aSource );
+
+		// Sets the compiler, and a version mixed in to every key so bytecode from different compilers isn't mixed up
+		void				SetCompiler( VEShaderCompiler aCompiler, unsigned int aCompilerVersion );
+
+		// Clears the hit & miss counts, and the compile time
+		void				ResetStatistics();
+
+
+		// ---------- Accessors -----------
+
+		bool				GetIsOpen()				{ return myIsOpen; }
+
+		// The requests found in & missing from the cache, and the time spent compiling the misses in performance
+		// counter ticks, summed over every thread
+		unsigned int		GetHitCount()			{ return myHitCount; }
+		unsigned int		GetMissCount()			{ return myMissCount; }
+		long long			GetCompileTime()		{ return myCompileTime; }
+
+
+	private :
+
+		// ------ Private Structures ------
+
+		// The start of each entry, followed by the bytecode
+		struct EntryHeader
+		{
+			unsigned int		myMagic;
+			unsigned int		myBytecodeSize;
+			unsigned long long	myKey;
+			unsigned long long	myBytecodeHash;
+		};
+
+		// A request being loaded on the job system
+		struct LoadJob
+		{
+			VEShaderCache*		myCache;
+			VEShaderRequest*	myRequest;
+			bool				mySucceeded;
+		};
+
+
+		// ------- Private Functions ------
+
+		// Mixes an included file's name & source in to a key, then the files it includes in turn
+		void				HashIncludes( unsigned long long& aKey, const std::wstring& aFile, const std::string& aSource, unsigned int aDepth );
+
+		// Reads the entry with the supplied key in to the request, returns false if there isn't one or it's corrupt
+		bool				ReadEntry( unsigned long long aKey, VEShaderRequest& aRequest );
+
+		// Writes the request's bytecode to the entry with the supplied key
+		bool				WriteEntry( unsigned long long aKey, const VEShaderRequest& aRequest );
+
+		// Returns the path of the entry with the supplied key
+		std::wstring		GetEntryPath( unsigned long long aKey, const wchar_t* anExtension );
+
+		// Mixes bytes in to a hash
+		static unsigned long long	HashBytes( unsigned long long aHash, const void* someData, unsigned int aSize );
+
+		// Loads a request on a job system worker
+		static void			LoadJobFunction( void* aJob );
+
+		// The shader cache can't be copied
+		VEShaderCache( const VEShaderCache& );
+		VEShaderCache& operator=( const VEShaderCache& );
+
+
+		// ------- Private Variables ------
+
+		VEShaderStorage*	myStorage;
+		std::wstring		myDirectory;
+		bool				myIsOpen;
+
+		VEShaderCompiler	myCompiler;
+		unsigned int		myCompilerVersion;
+
+		// Guarded by the statistics lock, as requests are loaded from the job system's workers
+		VEMutex				myStatisticsLock;
+		unsigned int		myHitCount;
+		unsigned int		myMissCount;
+		long long			myCompileTime;
+};
+
+
+#endif // !VE_SHADER_CACHE_H
@@ -0,0 +1,91 @@
+// ----------------------- Includes -----------------------
+
+#include "Stdafx.h"
+#include "VEShaderFileStorage.h"
+
+
+// -------------------- Class Functions -------------------
+
+// Construction
+VEShaderFileStorage::VEShaderFileStorage()
+{
+}
+
+
+// Creates the directory if it doesn't exist
+bool VEShaderFileStorage::MakeDirectory( const std::wstring& aDirectory )
+{
+	return CreateDirectoryW( aDirectory.c_str(), NULL ) || GetLastError() == ERROR_ALREADY_EXISTS;
+}
+
+
+// Reads a whole file
+bool VEShaderFileStorage::ReadData( const std::wstring& aFile, std::string& someData )
+{
+	HANDLE file = CreateFileW( aFile.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+	if( file == INVALID_HANDLE_VALUE )
+	{
+		return false;
+	}
+
+	LARGE_INTEGER	fileSize;
+	bool			succeeded = GetFileSizeEx( file, &fileSize ) != FALSE && fileSize.QuadPart < 0x7fffffff;
+	if( succeeded )
+	{
+		someData.resize( (size_t)fileSize.QuadPart );
+
+		DWORD bytesRead = 0;
+		succeeded = someData.empty() || (ReadFile(file, &someData[0], (DWORD)someData.size(), &bytesRead, NULL) && bytesRead == someData.size());
+	}
+
+	CloseHandle( file );
+
+	return succeeded;
+}
+
+
+// Writes the data beside the file first and moves it in to place, so the file is never seen half written
+bool VEShaderFileStorage::WriteData( const std::wstring& aFile, const std::string& someData )
+{
+	std::wstring temporaryFile = aFile + L".tmp";
+
+	// The temporary file isn't shared, so when two threads write the same file only one of them gets to
+	HANDLE file = CreateFileW( temporaryFile.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL );
+	if( file == INVALID_HANDLE_VALUE )
+	{
+		return false;
+	}
+
+	DWORD	bytesWritten	= 0;
+	bool	succeeded		= someData.empty() || (WriteFile(file, someData.c_str(), (DWORD)someData.size(), &bytesWritten, NULL) && bytesWritten == someData.size());
+
+	CloseHandle( file );
+
+	succeeded = succeeded && MoveFileExW( temporaryFile.c_str(), aFile.c_str(), MOVEFILE_REPLACE_EXISTING ) != FALSE;
+	if( !succeeded )
+	{
+		DeleteFileW( temporaryFile.c_str() );
+	}
+
+	return succeeded;
+}
+
+
+// Deletes every file in the directory with the supplied extension
+void VEShaderFileStorage::DeleteData( const std::wstring& aDirectory, const wchar_t* anExtension )
+{
+	WIN32_FIND_DATAW	findData;
+	HANDLE				findHandle = FindFirstFileW( (aDirectory + L"*" + anExtension).c_str(), &findData );
+	if( findHandle == INVALID_HANDLE_VALUE )
+	{
+		return;
+	}
+
+	do
+	{
+		DeleteFileW( (aDirectory + findData.cFileName).c_str() );
+	}
+	while( FindNextFileW(findHandle, &findData) );
+
+	FindClose( findHandle );
+}
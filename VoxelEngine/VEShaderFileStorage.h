@@ -0,0 +1,39 @@
+#ifndef VE_SHADER_FILE_STORAGE_H
+#define VE_SHADER_FILE_STORAGE_H
+
+
+// ----------------------- Includes -----------------------
+
+#include "VEShaderStorage.h"
+
+
+// ----------------------- Classes ------------------------
+
+// Keeps the shader cache's entries in files on disk, and reads shader sources from them
+class VEShaderFileStorage : public VEShaderStorage
+{
+	public :
+
+		// ------- Public Functions -------
+
+		// Construction
+		VEShaderFileStorage();
+
+
+		// ------ Required Functions ------
+
+		// Creates the directory if it doesn't exist
+		virtual bool	MakeDirectory( const std::wstring& aDirectory ) override;
+
+		// Reads a whole file
+		virtual bool	ReadData( const std::wstring& aFile, std::string& someData ) override;
+
+		// Writes the data beside the file first and moves it in to place
+		virtual bool	WriteData( const std::wstring& aFile, const std::string& someData ) override;
+
+		// Deletes every file in the directory with the supplied extension
+		virtual void	DeleteData( const std::wstring& aDirectory, const wchar_t* anExtension ) override;
+};
+
+
+#endif // !VE_SHADER_FILE_STORAGE_H
@@ -14,12 +14,15 @@
 #include "VEFinalBlendShader.h"
 #include "VEShadowMapShader.h"
 #include "VEVoxelShader.h"
+#include "VEHLSLCompiler.h"
+#include "VoxelEngine.h"
 
 
 // -------------- Class Functions -------------
 
 // Construction
-VEShaderManager::VEShaderManager()
+VEShaderManager::VEShaderManager() :
+	myShaderCache( &myShaderStorage, VEHLSLCompiler::Compile, VEHLSLCompiler::GetVersion() )
 {
 }
 
@@ -36,11 +39,111 @@ void VEShaderManager::Uninitialise()
 	}
 
 	myShaders.clear();
+
+	for( std::map<VEShaderType, VEShader*>::iterator iter = myPreparedShaders.begin(); iter != myPreparedShaders.end(); iter++ )
+	{
+		delete iter->second;
+	}
+	myPreparedShaders.clear();
 }
 
 
 // Loads a shader from disk
 bool VEShaderManager::LoadShader( VEShaderType aShaderType )
+{
+	return LoadShaders( &aShaderType, 1 );
+}
+
+
+// Loads a set of shaders, fetching or compiling the bytecode of those that weren't prepared at once before the shaders
+// are created
+bool VEShaderManager::LoadShaders( const VEShaderType* someShaderTypes, unsigned int aShaderCount )
+{
+	std::vector<VEShaderType> unpreparedTypes;
+	for( unsigned int i = 0; i < aShaderCount; i++ )
+	{
+		if( myPreparedShaders.find(someShaderTypes[i]) == myPreparedShaders.end() )
+		{
+			unpreparedTypes.push_back( someShaderTypes[i] );
+		}
+	}
+
+	// A shader whose bytecode failed to load tries again & logs the errors when it's initialised, so only a shader that
+	// couldn't be created is missing
+	if( !unpreparedTypes.empty() )
+	{
+		PrepareShaders( &unpreparedTypes[0], unpreparedTypes.size() );
+	}
+
+	// Compiling is the slow part, only creating the shaders needs the device
+	bool succeeded = true;
+	for( unsigned int i = 0; i < aShaderCount; i++ )
+	{
+		std::map<VEShaderType, VEShader*>::iterator prepared = myPreparedShaders.find( someShaderTypes[i] );
+		if( prepared == myPreparedShaders.end() )
+		{
+			succeeded = false;
+			continue;
+		}
+
+		VEShader* newShader = prepared->second;
+		myPreparedShaders.erase( prepared );
+
+		succeeded = succeeded && newShader->Initialise();
+		if( !succeeded )
+		{
+			newShader->Uninitialise();
+			delete newShader;
+			continue;
+		}
+
+		myShaders[someShaderTypes[i]] = newShader;
+	}
+
+	return succeeded;
+}
+
+
+// Loads the bytecode of a set of shaders ahead of them being loaded
+bool VEShaderManager::PrepareShaders( const VEShaderType* someShaderTypes, unsigned int aShaderCount )
+{
+	std::vector<VEShaderRequest*> requests;
+
+	for( unsigned int i = 0; i < aShaderCount; i++ )
+	{
+		if( myPreparedShaders.find(someShaderTypes[i]) != myPreparedShaders.end() )
+		{
+			continue;
+		}
+
+		VEShader* newShader = CreateShader( someShaderTypes[i] );
+		if( newShader == NULL )
+		{
+			return false;
+		}
+
+		newShader->GetShaderRequests( requests );
+		myPreparedShaders[someShaderTypes[i]] = newShader;
+	}
+
+	return myShaderCache.LoadAll( requests, VoxelEngine::GetInstance()->GetJobSystem() );
+}
+
+
+// Returns a shader from the map
+VEShader* VEShaderManager::GetShader( VEShaderType aShaderType )
+{
+	if( myShaders.find(aShaderType) != myShaders.end() )
+	{
+		return myShaders[aShaderType];
+	}
+
+	return NULL;
+}
+
+
+// Creates an uninitialised shader of the supplied type
+VEShader* VEShaderManager::CreateShader( VEShaderType aShaderType )
 {
 	VEShader* newShader = NULL;
 
@@ -86,29 +189,5 @@ bool VEShaderManager::LoadShader( VEShaderType aShaderType )
 			break;
 	}
 
-	if( newShader == NULL )
-	{
-		return false;
-	}
-
-	if( !newShader->Initialise() )
-	{
-		return false;
-	}
-
-	myShaders[aShaderType] = newShader;
-
-	return true;
-}
-
-
-// Returns a shader from the map
-VEShader* VEShaderManager::GetShader( VEShaderType aShaderType )
-{
-	if( myShaders.find(aShaderType) != myShaders.end() )
-	{
-		return myShaders[aShaderType];
-	}
-
-	return NULL;
+	return newShader;
 }
\ No newline at end of file
@@ -2,6 +2,12 @@
 #define VE_SHADER_MANAGER_H
 
 
+// ----------------- Includes ---------------
+
+#include "VEShaderCache.h"
+#include "VEShaderFileStorage.h"
+
+
 // ----------- Forward Declarations ---------
 
 class VEShader;
@@ -47,15 +53,38 @@ class VEShaderManager
 		// Loads a shader from disk
 		bool		LoadShader( VEShaderType aShaderType );
 
+		// Loads a set of shaders. Every shader's bytecode is fetched from the shader cache or compiled at once on the
+		// job system, unless it was prepared already, then the shaders are created on the calling thread
+		bool		LoadShaders( const VEShaderType* someShaderTypes, unsigned int aShaderCount );
+
+		// Loads the bytecode of a set of shaders ahead of them being loaded, without touching the device. Can run on a
+		// worker while the device is being created, as long as nothing else uses the shader manager
+		bool		PrepareShaders( const VEShaderType* someShaderTypes, unsigned int aShaderCount );
+
 		// Returns a shader from the map
 		VEShader*	GetShader( VEShaderType aShaderType );
 
+		// Creates an uninitialised shader of the supplied type, or returns NULL if there isn't one
+		static VEShader*	CreateShader( VEShaderType aShaderType );
+
+
+		// -------- Accessors ---------
+
+		VEShaderCache*		GetShaderCache()	{ return &myShaderCache; }
+
 
 	private :
 
 		// ----- Private Variables -----
 
 		std::map<VEShaderType, VEShader*> myShaders;
+
+		// Shaders whose bytecode has been loaded, waiting to be created
+		std::map<VEShaderType, VEShader*> myPreparedShaders;
+
+		// The cache keeps its entries on disk and compiles with the D3D compiler
+		VEShaderFileStorage	myShaderStorage;
+		VEShaderCache		myShaderCache;
 };
 
 
@@ -0,0 +1,42 @@
+#ifndef VE_SHADER_STORAGE_H
+#define VE_SHADER_STORAGE_H
+
+
+// ----------------------- Includes -----------------------
+
+#include <string>
+
+
+// ----------------------- Classes ------------------------
+
+// Where the shader cache reads shader sources from and keeps its entries. VEShaderFileStorage is the real
+// implementation, a check can supply its own to run the cache without touching the disk. Called from the job system's
+// workers, so implementations have to be thread safe
+class VEShaderStorage
+{
+	public :
+
+		// ------- Public Functions -------
+
+		// Deconstruction
+		virtual ~VEShaderStorage()											{}
+
+
+		// ------ Required Functions ------
+
+		// Creates the directory if it doesn't exist, returns false if it couldn't be
+		virtual bool	MakeDirectory( const std::wstring& aDirectory ) = 0;
+
+		// Reads a whole file, returns false if it couldn't be read
+		virtual bool	ReadData( const std::wstring& aFile, std::string& someData ) = 0;
+
+		// Replaces a file's contents without it ever being seen half written. When two threads write the same file at
+		// once only one has to succeed
+		virtual bool	WriteData( const std::wstring& aFile, const std::string& someData ) = 0;
+
+		// Deletes every file in the directory with the supplied extension
+		virtual void	DeleteData( const std::wstring& aDirectory, const wchar_t* anExtension ) = 0;
+};
+
+
+#endif // !VE_SHADER_STORAGE_H
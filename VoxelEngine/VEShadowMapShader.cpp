@@ -75,7 +75,7 @@ bool VEShadowMapShader::PopulateVertexShaderConstants( VEBasicCamera* aCamera, V
 	dataBuffer = (MatrixBuffer*)mappedResource.pData;
 
 	// Copy the matrices in to the constant buffer
-	dataBuffer->myWorld			= XMMatrixTranspose( XMMatrixIdentity() );
+	dataBuffer->myWorld			= XMMatrixTranspose( XMMatrixTranslation(myDrawOffset.x, myDrawOffset.y, myDrawOffset.z) );
 	dataBuffer->myView			= XMMatrixTranspose( XMLoadFloat4x4(&aLight->GetViewMatrix()) );
 	dataBuffer->myProjection	= XMMatrixTranspose( XMLoadFloat4x4(&aLight->GetProjectionMatrix()) );
 
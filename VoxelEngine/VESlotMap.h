@@ -0,0 +1,213 @@
+#ifndef VE_SLOT_MAP_H
+#define VE_SLOT_MAP_H
+
+
+// -------------------- Defines --------------------
+
+// Handles pack a slot index and a generation count in to a single positive integer, so they can be
+// used anywhere the engine previously used an integer id (-1 is never a valid handle)
+#define VE_HANDLE_INDEX_BITS		20
+#define VE_HANDLE_GENERATION_BITS	11
+
+#define VE_HANDLE_INDEX_MASK		( (1 << VE_HANDLE_INDEX_BITS) - 1 )
+#define VE_HANDLE_GENERATION_MASK	( (1 << VE_HANDLE_GENERATION_BITS) - 1 )
+
+#define VE_INVALID_HANDLE			-1
+
+
+// -------------------- Classes --------------------
+
+// A container that hands out generational handles for the items it stores. Lookups, insertions and removals
+// are all O(1), slots are recycled through a free list and each recycle bumps the slot's generation so that
+// handles to removed items are detected as stale rather than silently returning the slot's new occupant
+template <typename T>
+class VESlotMap
+{
+	public :
+
+		// ---- Public Functions -----
+
+		// Construction
+		VESlotMap() :
+			myFreeListHead( -1 ),
+			mySize( 0 )
+		{
+		}
+
+		// Reserves space for the supplied number of items
+		void Reserve( unsigned int aCapacity )
+		{
+			mySlots.reserve( aCapacity );
+		}
+
+		// Adds an item to the map, returning the handle used to access it
+		int Insert( const T& anItem )
+		{
+			int index = myFreeListHead;
+			if( index != -1 )
+			{
+				myFreeListHead = mySlots[index].myNextFree;
+			}
+			else
+			{
+				index = (int)mySlots.size();
+				assert( index <= VE_HANDLE_INDEX_MASK );
+
+				mySlots.push_back( Slot() );
+			}
+
+			Slot& slot		= mySlots[index];
+			slot.myItem		= anItem;
+			slot.myNextFree	= -1;
+			slot.myInUse	= true;
+			mySize++;
+
+			return MakeHandle( index, slot.myGeneration );
+		}
+
+		// Removes the item referenced by the handle. Returns false if the handle is stale
+		bool Remove( int aHandle )
+		{
+			Slot* slot = GetSlot( aHandle );
+			if( slot == NULL )
+			{
+				return false;
+			}
+
+			// Bump the generation so any outstanding handles to this slot become invalid
+			slot->myItem		= T();
+			slot->myInUse		= false;
+			slot->myGeneration	= (slot->myGeneration + 1) & VE_HANDLE_GENERATION_MASK;
+			slot->myNextFree	= myFreeListHead;
+
+			myFreeListHead = GetIndex( aHandle );
+			mySize--;
+
+			return true;
+		}
+
+		// Returns the item referenced by the handle, or NULL if the handle is stale
+		T* Get( int aHandle )
+		{
+			Slot* slot = GetSlot( aHandle );
+			if( slot == NULL )
+			{
+				return NULL;
+			}
+
+			return &slot->myItem;
+		}
+
+		// Returns the item stored in the supplied slot, or NULL if the slot is unused. Used for walking
+		// every item in the map (slots are in the range 0 - GetCapacity())
+		T* GetAt( unsigned int aSlotIndex )
+		{
+			if( aSlotIndex >= mySlots.size() || !mySlots[aSlotIndex].myInUse )
+			{
+				return NULL;
+			}
+
+			return &mySlots[aSlotIndex].myItem;
+		}
+
+		// Whether the handle references an item in the map
+		bool IsValid( int aHandle )
+		{
+			return GetSlot( aHandle ) != NULL;
+		}
+
+		// Removes all items, invalidating every outstanding handle
+		void Clear()
+		{
+			myFreeListHead = -1;
+			for( int i = (int)mySlots.size() - 1; i >= 0; i-- )
+			{
+				if( mySlots[i].myInUse )
+				{
+					mySlots[i].myItem		= T();
+					mySlots[i].myInUse		= false;
+					mySlots[i].myGeneration	= (mySlots[i].myGeneration + 1) & VE_HANDLE_GENERATION_MASK;
+				}
+
+				mySlots[i].myNextFree	= myFreeListHead;
+				myFreeListHead			= i;
+			}
+
+			mySize = 0;
+		}
+
+
+		// -------- Accessors --------
+
+		unsigned int	GetSize()						{ return mySize; }
+
+		unsigned int	GetCapacity()					{ return mySlots.size(); }
+
+		static int		GetIndex( int aHandle )			{ return aHandle & VE_HANDLE_INDEX_MASK; }
+
+		static int		GetGeneration( int aHandle )	{ return (aHandle >> VE_HANDLE_INDEX_BITS) & VE_HANDLE_GENERATION_MASK; }
+
+
+	private :
+
+		// ---- Private Structures ---
+
+		// A single entry in the map
+		struct Slot
+		{
+			Slot() :
+				myItem(),
+				myGeneration( 0 ),
+				myNextFree( -1 ),
+				myInUse( false )
+			{
+			}
+
+			T		myItem;
+			int		myGeneration;
+			int		myNextFree;
+			bool	myInUse;
+		};
+
+
+		// ---- Private Functions ----
+
+		// Builds a handle from a slot index and generation
+		static int MakeHandle( int anIndex, int aGeneration )
+		{
+			return (aGeneration << VE_HANDLE_INDEX_BITS) | anIndex;
+		}
+
+		// Returns the slot referenced by the handle, or NULL if the handle is stale
+		Slot* GetSlot( int aHandle )
+		{
+			if( aHandle < 0 )
+			{
+				return NULL;
+			}
+
+			unsigned int index = (unsigned int)GetIndex( aHandle );
+			if( index >= mySlots.size() )
+			{
+				return NULL;
+			}
+
+			Slot& slot = mySlots[index];
+			if( !slot.myInUse || slot.myGeneration != GetGeneration(aHandle) )
+			{
+				return NULL;
+			}
+
+			return &slot;
+		}
+
+
+		// ---- Private Variables ----
+
+		std::vector<Slot>	mySlots;
+		int					myFreeListHead;
+		unsigned int		mySize;
+};
+
+
+#endif // !VE_SLOT_MAP_H
\ No newline at end of file
@@ -2,13 +2,18 @@
 #define VE_SMART_POINTER_H
 
 
+// ------------------ Includes -------------------
+
+#include <atomic>
+
+
 // ------------------- Structs -------------------
 
 
 // ------------------- Classes -------------------
 
 // Used by the smart pointer class to keep track of the number of references to a particular 
-// block of data
+// block of data. The count is atomic, so smart pointers can be shared between threads
 class VEReferenceCount
 {
 	public :	
@@ -16,9 +21,9 @@ class VEReferenceCount
 		// ---- Public Functions -----
 
 		// Construction
-		VEReferenceCount()
+		VEReferenceCount() :
+			myReferenceCount( 0 )
 		{
-			myReferenceCount = 0;
 		}
 
 		// Adds a reference
@@ -30,10 +35,10 @@ class VEReferenceCount
 		// Releases a reference
 		int Release()
 		{
-			myReferenceCount--;
-			assert( myReferenceCount >= 0 );
+			int referenceCount = --myReferenceCount;
+			assert( referenceCount >= 0 );
 
-			return myReferenceCount;
+			return referenceCount;
 		}
 
 
@@ -41,7 +46,7 @@ class VEReferenceCount
 
 		// ---- Private Variables ----
 
-		int myReferenceCount;
+		std::atomic<int> myReferenceCount;
 };
 
 
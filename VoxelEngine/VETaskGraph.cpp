@@ -0,0 +1,300 @@
+// ---------------------- Includes ----------------------
+
+#include "Stdafx.h"
+#include "VETaskGraph.h"
+
+#include "VEJobSystem.h"
+#include "VEMemoryTracker.h"
+#include "VEProfiler.h"
+
+
+// ------------------- Class Functions ------------------
+
+// Construction
+VETaskGraph::VETaskGraph() :
+	myJobSystem( NULL ),
+	myRemainingTasks( 0 ),
+	myExecuteStartTime( 0 ),
+	myExecuteEndTime( 0 ),
+	myTimerFrequency( 1 )
+{
+	LARGE_INTEGER frequency;
+	if( QueryPerformanceFrequency(&frequency) )
+	{
+		myTimerFrequency = frequency.QuadPart;
+	}
+}
+
+
+// Deconstruction
+VETaskGraph::~VETaskGraph()
+{
+	Clear();
+}
+
+
+// Adds a task that runs after the earlier tasks it conflicts with
+unsigned int VETaskGraph::AddTask( const char* aName, VETaskFunction aFunction, void* aParameter, unsigned int someReads, unsigned int someWrites, bool isMainThreadOnly /* = false */ )
+{
+	assert( aFunction != NULL );
+
+	Task* newTask = new Task();
+	newTask->myGraph				= this;
+	newTask->myName					= aName;
+	newTask->myFunction				= aFunction;
+	newTask->myParameter			= aParameter;
+	newTask->myReads				= someReads;
+	newTask->myWrites				= someWrites;
+	newTask->myIsMainThreadOnly		= isMainThreadOnly;
+	newTask->myDependencyCount		= 0;
+	newTask->myPendingDependencies	= 0;
+	newTask->myStartTime			= 0;
+	newTask->myEndTime				= 0;
+	newTask->myAllocationCount		= 0;
+
+	for( unsigned int i = 0; i < myTasks.size(); i++ )
+	{
+		Task* earlierTask = myTasks[i];
+
+		bool conflicts = ( earlierTask->myWrites & (someReads | someWrites) ) != 0 || ( earlierTask->myReads & someWrites ) != 0;
+		if( conflicts )
+		{
+			earlierTask->myDependents.push_back( newTask );
+			newTask->myDependencyCount++;
+		}
+	}
+
+	myTasks.push_back( newTask );
+	myMainThreadTasks.reserve( myTasks.size() );
+
+	return myTasks.size() - 1;
+}
+
+
+// Removes every task
+void VETaskGraph::Clear()
+{
+	for( unsigned int i = 0; i < myTasks.size(); i++ )
+	{
+		delete myTasks[i];
+		myTasks[i] = NULL;
+	}
+	myTasks.clear();
+	myMainThreadTasks.clear();
+}
+
+
+// Runs the tasks on the job system, the calling thread runs the main thread tasks & helps with the rest
+void VETaskGraph::Execute( VEJobSystem* aJobSystem )
+{
+	assert( aJobSystem != NULL );
+
+	myJobSystem			= aJobSystem;
+	myRemainingTasks	= myTasks.size();
+	myExecuteStartTime	= VEProfiler::GetTime();
+
+	for( unsigned int i = 0; i < myTasks.size(); i++ )
+	{
+		myTasks[i]->myPendingDependencies = myTasks[i]->myDependencyCount;
+	}
+
+	for( unsigned int i = 0; i < myTasks.size(); i++ )
+	{
+		if( myTasks[i]->myDependencyCount == 0 )
+		{
+			ScheduleTask( myTasks[i] );
+		}
+	}
+
+	// Main thread tasks come first, as a worker can't pick them up. Otherwise the main thread helps with the
+	// queued jobs rather than waiting for them
+	while( myRemainingTasks > 0 )
+	{
+		Task* mainThreadTask = PopMainThreadTask();
+		if( mainThreadTask != NULL )
+		{
+			RunTask( mainThreadTask );
+		}
+		else if( !myJobSystem->RunPendingJob() )
+		{
+			VEThread::YieldThread();
+		}
+	}
+
+	myExecuteEndTime	= VEProfiler::GetTime();
+	myJobSystem			= NULL;
+}
+
+
+// Runs the tasks one after another on the calling thread, in the order they were added
+void VETaskGraph::ExecuteSerial()
+{
+	myRemainingTasks	= myTasks.size();
+	myExecuteStartTime	= VEProfiler::GetTime();
+
+	// Every dependency of a task was added before it, so the order the tasks were added is always a valid order
+	for( unsigned int i = 0; i < myTasks.size(); i++ )
+	{
+		myTasks[i]->myPendingDependencies = 0;
+		RunTask( myTasks[i] );
+	}
+
+	myExecuteEndTime = VEProfiler::GetTime();
+}
+
+
+// Writes the graph in Graphviz's dot format, each task labelled with its time from the last execution
+bool VETaskGraph::ExportDot( const std::wstring& aFilename )
+{
+	std::ofstream file( aFilename.c_str() );
+	if( !file.is_open() )
+	{
+		return false;
+	}
+
+	file.setf( std::ios::fixed );
+	file.precision( 3 );
+
+	file << "digraph TaskGraph\n{\n";
+	file << "\tnode [shape=box];\n";
+
+	for( unsigned int i = 0; i < myTasks.size(); i++ )
+	{
+		file << "\ttask" << i << " [label=\"" << myTasks[i]->myName << "\\n" << GetTaskTime( i ) << " ms\"";
+		if( myTasks[i]->myIsMainThreadOnly )
+		{
+			file << ", style=bold";
+		}
+		file << "];\n";
+	}
+
+	for( unsigned int i = 0; i < myTasks.size(); i++ )
+	{
+		const std::vector<Task*>& dependents = myTasks[i]->myDependents;
+		for( unsigned int j = 0; j < dependents.size(); j++ )
+		{
+			unsigned int dependent = std::find( myTasks.begin(), myTasks.end(), dependents[j] ) - myTasks.begin();
+			file << "\ttask" << i << " -> task" << dependent << ";\n";
+		}
+	}
+
+	file << "}\n";
+
+	return file.good();
+}
+
+
+// The time (in milliseconds) the task took during the last execution
+double VETaskGraph::GetTaskTime( unsigned int aTask )
+{
+	return ToMilliseconds( myTasks[aTask]->myEndTime - myTasks[aTask]->myStartTime );
+}
+
+
+// When the task started (in milliseconds) relative to the start of the last execution
+double VETaskGraph::GetTaskStartTime( unsigned int aTask )
+{
+	return ToMilliseconds( myTasks[aTask]->myStartTime - myExecuteStartTime );
+}
+
+
+// The number of heap allocations made by all of the tasks during the last execution
+unsigned int VETaskGraph::GetAllocationCount()
+{
+	unsigned int allocationCount = 0;
+	for( unsigned int i = 0; i < myTasks.size(); i++ )
+	{
+		allocationCount += myTasks[i]->myAllocationCount;
+	}
+
+	return allocationCount;
+}
+
+
+// The time (in milliseconds) the last execution took, from start to finish
+double VETaskGraph::GetExecuteTime()
+{
+	return ToMilliseconds( myExecuteEndTime - myExecuteStartTime );
+}
+
+
+// Hands a task whose dependencies have finished to the thread that will run it
+void VETaskGraph::ScheduleTask( Task* aTask )
+{
+	if( aTask->myIsMainThreadOnly )
+	{
+		VEScopedLock<VEMutex> lock( myMainThreadLock );
+		myMainThreadTasks.push_back( aTask );
+	}
+	else
+	{
+		myJobSystem->Submit( VETaskGraph::TaskJob, aTask );
+	}
+}
+
+
+// Runs a task, then schedules the dependents it was the last dependency of
+void VETaskGraph::RunTask( Task* aTask )
+{
+	{
+		VE_PROFILE_ZONE( aTask->myName );
+
+		// Allocation counts are per thread, so the scope only sees this task's allocations whichever thread runs it
+		VEAllocationScope taskAllocations;
+
+		aTask->myStartTime = VEProfiler::GetTime();
+		aTask->myFunction( aTask->myParameter );
+		aTask->myEndTime = VEProfiler::GetTime();
+
+		aTask->myAllocationCount = taskAllocations.GetAllocationCount();
+	}
+
+	// Serial execution runs the tasks in order, so there's nothing to schedule
+	if( myJobSystem != NULL )
+	{
+		for( unsigned int i = 0; i < aTask->myDependents.size(); i++ )
+		{
+			Task* dependent = aTask->myDependents[i];
+			if( --dependent->myPendingDependencies == 0 )
+			{
+				ScheduleTask( dependent );
+			}
+		}
+	}
+
+	myRemainingTasks--;
+}
+
+
+// Takes a ready main thread task, returns NULL if there isn't one
+VETaskGraph::Task* VETaskGraph::PopMainThreadTask()
+{
+	VEScopedLock<VEMutex> lock( myMainThreadLock );
+
+	if( myMainThreadTasks.empty() )
+	{
+		return NULL;
+	}
+
+	Task* task = myMainThreadTasks.back();
+	myMainThreadTasks.pop_back();
+
+	return task;
+}
+
+
+// Runs a task submitted to the job system
+void VETaskGraph::TaskJob( void* aTask )
+{
+	Task* task = reinterpret_cast<Task*>( aTask );
+	assert( task != NULL && task->myGraph != NULL );
+
+	task->myGraph->RunTask( task );
+}
+
+
+// Converts a performance counter duration to milliseconds
+double VETaskGraph::ToMilliseconds( long long aDuration )
+{
+	return ( (double)aDuration * 1000.0 ) / (double)myTimerFrequency;
+}
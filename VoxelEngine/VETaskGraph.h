@@ -0,0 +1,145 @@
+#ifndef VE_TASK_GRAPH_H
+#define VE_TASK_GRAPH_H
+
+
+// ---------------------- Includes ---------------------
+
+#include "VETypes.h"
+#include "VEThreading.h"
+
+
+// ------------------ Forward Declarations -------------
+
+class VEJobSystem;
+
+
+// ---------------------- Typedefs ---------------------
+
+// A function run by a task in the graph
+typedef void (*VETaskFunction)( void* aParameter );
+
+
+// ---------------------- Classes ----------------------
+
+// A fixed set of tasks, executed in dependency order on the job system. Each task declares the resources (a bitmask,
+// see FrameResource) it reads and writes, and depends on every earlier task it conflicts with: one that writes
+// something it reads or writes, or reads something it writes. Tasks that don't conflict run at the same time.
+// The graph is built once, executing it doesn't allocate
+class VETaskGraph
+{
+	public :
+
+		// --------- Public Functions ---------
+
+		// Construction
+		VETaskGraph();
+
+		// Deconstruction
+		~VETaskGraph();
+
+		// Adds a task that runs after the earlier tasks it conflicts with. Main thread tasks are never run by a worker.
+		// Returns the task's index
+		unsigned int	AddTask( const char* aName, VETaskFunction aFunction, void* aParameter, unsigned int someReads, unsigned int someWrites, bool isMainThreadOnly = false );
+
+		// Removes every task
+		void			Clear();
+
+		// Runs the tasks on the job system, the calling thread runs the main thread tasks & helps with the rest.
+		// Returns once every task has finished
+		void			Execute( VEJobSystem* aJobSystem );
+
+		// Runs the tasks one after another on the calling thread, in the order they were added
+		void			ExecuteSerial();
+
+		// Writes the graph in Graphviz's dot format, each task labelled with its time from the last execution
+		bool			ExportDot( const std::wstring& aFilename );
+
+
+		// ------------ Accessors -------------
+
+		unsigned int	GetTaskCount()							{ return myTasks.size(); }
+
+		const char*		GetTaskName( unsigned int aTask )		{ return myTasks[aTask]->myName; }
+
+		// The time (in milliseconds) the task took during the last execution
+		double			GetTaskTime( unsigned int aTask );
+
+		// When the task started (in milliseconds) relative to the start of the last execution
+		double			GetTaskStartTime( unsigned int aTask );
+
+		// The number of heap allocations the task made during the last execution (always 0 unless VE_MEMORY_TRACKING
+		// is defined)
+		unsigned int	GetTaskAllocationCount( unsigned int aTask )	{ return myTasks[aTask]->myAllocationCount; }
+
+		// The number of heap allocations made by all of the tasks during the last execution
+		unsigned int	GetAllocationCount();
+
+		// The time (in milliseconds) the last execution took, from start to finish
+		double			GetExecuteTime();
+
+
+	private :
+
+		// --------- Private Structures -------
+
+		// A task in the graph
+		struct Task
+		{
+			VETaskGraph*				myGraph;
+			const char*					myName;
+			VETaskFunction				myFunction;
+			void*						myParameter;
+			unsigned int				myReads;
+			unsigned int				myWrites;
+			bool						myIsMainThreadOnly;
+
+			std::vector<Task*>			myDependents;
+			unsigned int				myDependencyCount;
+			std::atomic<unsigned int>	myPendingDependencies;
+
+			long long					myStartTime;
+			long long					myEndTime;
+			unsigned int				myAllocationCount;
+		};
+
+
+		// --------- Private Functions --------
+
+		// Hands a task whose dependencies have finished to the thread that will run it
+		void				ScheduleTask( Task* aTask );
+
+		// Runs a task, then schedules the dependents it was the last dependency of
+		void				RunTask( Task* aTask );
+
+		// Takes a ready main thread task, returns NULL if there isn't one
+		Task*				PopMainThreadTask();
+
+		// Runs a task submitted to the job system
+		static void			TaskJob( void* aTask );
+
+		// Converts a performance counter duration to milliseconds
+		double				ToMilliseconds( long long aDuration );
+
+		// The graph can't be copied
+		VETaskGraph( const VETaskGraph& );
+		VETaskGraph& operator=( const VETaskGraph& );
+
+
+		// --------- Private Variables --------
+
+		std::vector<Task*>			myTasks;
+
+		VEJobSystem*				myJobSystem;
+		std::atomic<unsigned int>	myRemainingTasks;
+
+		// Ready tasks that must run on the main thread, reserved for every task so scheduling doesn't allocate
+		VEMutex						myMainThreadLock;
+		std::vector<Task*>			myMainThreadTasks;
+
+		long long					myExecuteStartTime;
+		long long					myExecuteEndTime;
+		long long					myTimerFrequency;
+};
+
+
+#endif // !VE_TASK_GRAPH_H
@@ -7,6 +7,11 @@
 #include "VoxelEngine.h"
 #include "VEChunkManager.h"
 #include "VEChunk.h"
+#include "VEWorldStore.h"
+#include "VEWorldCache.h"
+#include "VEJobSystem.h"
+#include "VEProfiler.h"
+#include "VEMemoryTracker.h"
 
 #include <noise/noise.h>
 #include "noiseutils.h"
@@ -19,7 +24,8 @@ VETerrainGenerator::VETerrainGenerator() :
 	myNoiseTexture( "NoiseTexture_" ),
 	myGenerateNoiseTexture( false ),
 	myNoiseStepSize( 0.8 ),
-	myNoiseRange( 50 )
+	myNoiseRange( 50 ),
+	mySeed( VE_TERRAIN_RANDOM_SEED )
 {
 }
 
@@ -37,9 +43,12 @@ void VETerrainGenerator::Uninitialise()
 }
 
 
-// Generates random terrain based on the number of required chunks
+// Generates random terrain based on the number of required chunks. Chunks stored in the world store are loaded rather
+// than generated, and chunks in the world cache are loaded along with their meshes
 void VETerrainGenerator::GenerateTerrain( int aChunkWidth, int aChunkDepth, DirectX::XMFLOAT3 aPosition )
 {
+	VE_PROFILE_ZONE( "VETerrainGenerator::GenerateTerrain" );
+
 	VEChunkManager* chunkManager = VoxelEngine::GetInstance()->GetChunkManager();
 	assert( chunkManager != NULL );
 	
@@ -50,17 +59,45 @@ void VETerrainGenerator::GenerateTerrain( int aChunkWidth, int aChunkDepth, Dire
 		return;
 	}
 
-	// Standard (divide results by 2 for a flat terrain)
-	module::Perlin				noiseGenerator;
-	utils::NoiseMap				heightMap;
-	utils::NoiseMapBuilderPlane planeBuilder;
+	// The chunks account for their own voxels, everything else generated here is noise data
+	VE_MEMORY_TAG( MEM_Noise );
 
-	planeBuilder.SetSourceModule( noiseGenerator );
-	planeBuilder.SetDestNoiseMap( heightMap );
-	planeBuilder.SetDestSize( chunkManager->GetChunkDimensions(), chunkManager->GetChunkDimensions() );
+	// A stored world keeps the seed it was first generated with, so chunks generated later join up with the stored ones
+	VEWorldStore*	worldStore	= VoxelEngine::GetInstance()->GetWorldStore();
+	bool			isStored	= worldStore != NULL && worldStore->GetIsOpen();
+
+	int seed = mySeed;
+	if( isStored && worldStore->GetHasSeed() )
+	{
+		seed = worldStore->GetSeed();
+	}
+	else
+	{
+		if( seed == VE_TERRAIN_RANDOM_SEED )
+		{
+			seed = (int)( time(NULL) & 0x7FFFFFFF );
+		}
+
+		if( isStored )
+		{
+			worldStore->SetSeed( seed );
+		}
+	}
+
+	// Generated chunks are only cached for the same seed & parameters
+	VEWorldCache*	worldCache	= VoxelEngine::GetInstance()->GetWorldCache();
+	bool			isCached	= worldCache != NULL && worldCache->GetIsOpen();
+
+	if( isCached )
+	{
+		worldCache->SetGenerator( seed, CalculateGeneratorHash(chunkManager->GetChunkDimensions(), aPosition) );
+	}
 
-	// Generate the terrain
-	srand( (unsigned int)time(NULL) );
+	// Load the chunks the store or the cache has. The store & the cache each read from one file, so this is done one
+	// chunk after another, the rest are queued to be generated
+	std::vector<GenerateJob> generateJobs;
+
+	srand( (unsigned int)seed );
 	double initialOffset				= (double)(rand() % myNoiseRange + 1);
 	double currentZ						= initialOffset;
 	for( int z = 0; z < aChunkDepth; z++ )
@@ -68,22 +105,132 @@ void VETerrainGenerator::GenerateTerrain( int aChunkWidth, int aChunkDepth, Dire
 		double currentX = initialOffset;
 		for( int x = 0; x < aChunkWidth; x++ )
 		{
-			// Build the height map data
-			planeBuilder.SetBounds( currentX, currentX + myNoiseStepSize, currentZ, currentZ + myNoiseStepSize );
-			planeBuilder.Build();
-
-			// Apply the height map to the chunk
 			VEChunk* currentChunk = chunkManager->GetChunk( x, z );
 			assert( currentChunk != NULL );
 
-			currentChunk->ApplyHeightMap( &heightMap );
-			//currentChunk->ApplyStyle( CS_Pyramid );
+			bool isLoaded = isStored && worldStore->LoadChunk( currentChunk );
+			if( !isLoaded && (!isCached || !worldCache->LoadVoxels(currentChunk)) )
+			{
+				GenerateJob generateJob;
+				generateJob.myChunk			= currentChunk;
+				generateJob.myX				= currentX;
+				generateJob.myZ				= currentZ;
+				generateJob.myStepSize		= myNoiseStepSize;
+				generateJob.myDimensions	= chunkManager->GetChunkDimensions();
+
+				generateJobs.push_back( generateJob );
+			}
+			else
+			{
+				currentChunk->SetIsGenerated( !isLoaded );
+
+				// Bring the chunk up to date with the edits made since it was last saved
+				if( isStored && worldStore->ReplayEdits(currentChunk) > 0 )
+				{
+					currentChunk->SetIsGenerated( false );
+				}
+			}
 
 			currentX += myNoiseStepSize;
 		}
 
 		currentZ += myNoiseStepSize;
 	}
+
+	// Generate the rest, each chunk's noise is independent of the others'
+	VEJobSystem* jobSystem = VoxelEngine::GetInstance()->GetJobSystem();
+	if( jobSystem != NULL && generateJobs.size() > 1 )
+	{
+		VEJobCounter counter;
+		for( unsigned int i = 0; i < generateJobs.size(); i++ )
+		{
+			jobSystem->Submit( VETerrainGenerator::GenerateJobFunction, &generateJobs[i], &counter );
+		}
+
+		jobSystem->Wait( counter );
+	}
+	else
+	{
+		for( unsigned int i = 0; i < generateJobs.size(); i++ )
+		{
+			GenerateJobFunction( &generateJobs[i] );
+		}
+	}
+
+	for( unsigned int i = 0; i < generateJobs.size(); i++ )
+	{
+		VEChunk* currentChunk = generateJobs[i].myChunk;
+
+		if( isCached )
+		{
+			worldCache->SaveVoxels( currentChunk );
+		}
+
+		currentChunk->SetIsGenerated( true );
+
+		// Edits can be stored for a chunk that was never saved
+		if( isStored && worldStore->ReplayEdits(currentChunk) > 0 )
+		{
+			currentChunk->SetIsGenerated( false );
+		}
+	}
+
+	if( !isCached )
+	{
+		return;
+	}
+
+	// Every chunk starts out dirty, so a generated chunk doesn't need to dirty its neighbours. Chunks whose neighbours
+	// are all generated too take their mesh straight from the cache rather than being built
+	for( int z = 0; z < aChunkDepth; z++ )
+	{
+		for( int x = 0; x < aChunkWidth; x++ )
+		{
+			VEChunk* currentChunk = chunkManager->GetChunk( x, z );
+			if( !currentChunk->GetIsGenerated() )
+			{
+				continue;
+			}
+
+			currentChunk->SetNeighboursDirty( false );
+
+			VEChunk* neighbours[CN_Max];
+			currentChunk->GetNeighbours( neighbours );
+
+			if( currentChunk->IsMeshCacheable(neighbours) )
+			{
+				worldCache->LoadMesh( currentChunk );
+			}
+		}
+	}
+}
+
+
+// Builds a job's height map & applies it to the job's chunk
+void VETerrainGenerator::GenerateJobFunction( void* aJob )
+{
+	VE_PROFILE_ZONE( "VETerrainGenerator::GenerateJob" );
+
+	GenerateJob* job = reinterpret_cast<GenerateJob*>( aJob );
+
+	VE_MEMORY_TAG( MEM_Noise );
+
+	// Standard (divide results by 2 for a flat terrain)
+	module::Perlin				noiseGenerator;
+	utils::NoiseMap				heightMap;
+	utils::NoiseMapBuilderPlane planeBuilder;
+
+	planeBuilder.SetSourceModule( noiseGenerator );
+	planeBuilder.SetDestNoiseMap( heightMap );
+	planeBuilder.SetDestSize( job->myDimensions, job->myDimensions );
+
+	// Build the height map data
+	planeBuilder.SetBounds( job->myX, job->myX + job->myStepSize, job->myZ, job->myZ + job->myStepSize );
+	planeBuilder.Build();
+
+	// Apply the height map to the chunk
+	job->myChunk->ApplyHeightMap( &heightMap );
+	//job->myChunk->ApplyStyle( CS_Pyramid );
 }
 
 
@@ -107,4 +254,24 @@ void VETerrainGenerator::SaveNoiseMapTexture( utils::NoiseMap* aNoiseMap, int aC
 	writer.SetSourceImage(image);
 	writer.SetDestFilename( path.c_str() );
 	writer.WriteDestFile();
+}
+
+
+// Hashes the parameters the terrain is generated with, other than the seed
+unsigned int VETerrainGenerator::CalculateGeneratorHash( int aChunkDimensions, const DirectX::XMFLOAT3& aPosition )
+{
+	unsigned char parameters[sizeof(double) + sizeof(int) * 2 + sizeof(DirectX::XMFLOAT3)];
+	memcpy( &parameters[0], &myNoiseStepSize, sizeof(double) );
+	memcpy( &parameters[sizeof(double)], &myNoiseRange, sizeof(int) );
+	memcpy( &parameters[sizeof(double) + sizeof(int)], &aChunkDimensions, sizeof(int) );
+	memcpy( &parameters[sizeof(double) + sizeof(int) * 2], &aPosition, sizeof(DirectX::XMFLOAT3) );
+
+	// FNV-1a
+	unsigned int hash = 2166136261u;
+	for( unsigned int i = 0; i < sizeof(parameters); i++ )
+	{
+		hash = (hash ^ parameters[i]) * 16777619u;
+	}
+
+	return hash;
 }
\ No newline at end of file
@@ -2,8 +2,16 @@
 #define VE_TERRAIN_GENERATOR_H
 
 
+// ---------------------- Defines ----------------------
+
+// Seeds the terrain from the system clock, so every run generates a different world
+#define VE_TERRAIN_RANDOM_SEED	-1
+
+
 // ---------------- Forward Declarations ---------------
 
+class VEChunk;
+
 namespace noise
 {
 	namespace utils
@@ -33,7 +41,9 @@ class VETerrainGenerator
 		// Cleans up the memory used by the terrain generator
 		void	Uninitialise();
 
-		// Generates random terrain based on the number of required chunks
+		// Generates random terrain based on the number of required chunks. Chunks stored in the world store are loaded rather
+		// than generated, and chunks in the world cache are loaded along with their meshes. The rest are generated in
+		// parallel on the job system
 		void	GenerateTerrain( int aChunkWidth, int aChunkDepth, DirectX::XMFLOAT3 aPosition = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f) );
 
 
@@ -48,14 +58,39 @@ class VETerrainGenerator
 		double	GetStepSize()								{ return myNoiseStepSize; }
 		void	SetStepSize( double aStepSize )				{ myNoiseStepSize = aStepSize; }
 
+		// The seed used to place the terrain in the noise map. Fixed seeds generate the same world every run, a stored world's
+		// own seed takes precedence
+		int		GetSeed()									{ return mySeed; }
+		void	SetSeed( int aSeed )						{ mySeed = aSeed; }
+
 
 	private :
 
+		// ------- Private Structures -------
+
+		// A chunk whose voxels are generated from the noise on the job system
+		struct GenerateJob
+		{
+			VEChunk*	myChunk;
+			double		myX;
+			double		myZ;
+			double		myStepSize;
+			int			myDimensions;
+		};
+
+
 		// -------- Private Functions -------
 
+		// Builds a job's height map & applies it to the job's chunk, each job has its own noise module & map so any
+		// number can run at once
+		static void	GenerateJobFunction( void* aJob );
+
 		// Saves the noise map to a texture file
 		void	SaveNoiseMapTexture( noise::utils::NoiseMap* aNoiseMap, int aCount );
 
+		// Hashes the parameters the terrain is generated with, other than the seed, for keying the world cache
+		unsigned int CalculateGeneratorHash( int aChunkDimensions, const DirectX::XMFLOAT3& aPosition );
+
 
 		// -------- Private Variables -------
 
@@ -64,6 +99,8 @@ class VETerrainGenerator
 
 		double		myNoiseStepSize;
 		int			myNoiseRange;
+
+		int			mySeed;
 };
 
 
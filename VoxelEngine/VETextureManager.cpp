@@ -31,6 +31,12 @@ VETextureManager::VETextureManager()
 // Loads a texture, returning a unique id
 int VETextureManager::LoadTexture( std::wstring aFileName )
 {
+	std::map<std::wstring, int>::iterator loadedTexture = myTextureIds.find( aFileName );
+	if( loadedTexture != myTextureIds.end() )
+	{
+		return loadedTexture->second;
+	}
+
 	VEDirectXInterface* renderInterface = VoxelEngine::GetInstance()->GetRenderInterface();
 	assert( renderInterface != NULL );
 		
@@ -55,7 +61,8 @@ int VETextureManager::LoadTexture( std::wstring aFileName )
 	}
 
 	int newId = GetNextTextureId();
-	myTextures[newId] = newTexture;
+	myTextures[newId]			= newTexture;
+	myTextureIds[aFileName]		= newId;
 
 	return newId;
 }
@@ -83,6 +90,7 @@ void VETextureManager::Uninitialise()
 	}
 
 	myTextures.clear();
+	myTextureIds.clear();
 }
 
 
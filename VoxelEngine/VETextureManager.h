@@ -19,7 +19,8 @@ class VETextureManager
 		// Construction
 		VETextureManager();
 
-		// Loads a texture, returning a unique id
+		// Loads a texture, returning a unique id. A texture that's already loaded returns the same id, so textures can be
+		// loaded ahead of the code that uses them
 		int			LoadTexture( std::wstring aFileName );
 
 		// Returns a texture given an ID
@@ -40,6 +41,7 @@ class VETextureManager
 		// ----- Private Variables ----
 
 		std::map<int, VETexture*>	myTextures;
+		std::map<std::wstring, int>	myTextureIds;
 		static int					myNextTextureId;
 };
 
@@ -5,14 +5,14 @@
 #include "VEThreadManager.h"
 
 #include "VoxelEngine.h"
+#include "VEProfiler.h"
 
 
 // ------------------- Class Functions ------------------
 
 // Construction
 VEThreadManager::VEThreadManager() :
-	myMaxThreadCount( 0 ),
-	myCurrentTheadId( 0 )
+	myMaxThreadCount( 0 )
 {
 }
 
@@ -26,7 +26,8 @@ bool VEThreadManager::Initialise( unsigned int aMaxThreadCount /* = 15 */)
 }
 
 
-// Stops all active threads and frees up the memory used by the thread manager
+// Discards the pending threads, waits for the active threads to finish and frees up the memory used by the thread
+// manager. Threads aren't terminated, as a terminated thread could leave a lock held or a pool half updated
 void VEThreadManager::Uninitialise()
 {
 	for( unsigned int i = 0; i < myPendingThreads.size(); i++ )
@@ -36,14 +37,9 @@ void VEThreadManager::Uninitialise()
 	}
 	myPendingThreads.clear();
 
-	DWORD exitCode;
 	for( unsigned int i = 0; i < myActiveThreads.size(); i++ )
 	{
-		GetExitCodeThread(myActiveThreads[i]->myThread, &exitCode);
-		if( exitCode == STILL_ACTIVE )
-		{
-			TerminateThread( myActiveThreads[i]->myThread, myActiveThreads[i]->myThreadId );
-		}
+		myActiveThreads[i]->myThread.Join();
 
 		delete myActiveThreads[i];
 		myActiveThreads[i] = NULL;
@@ -53,7 +49,7 @@ void VEThreadManager::Uninitialise()
 
 
 // Adds a job to the pending thread list
-bool VEThreadManager::SpawnThread( LPTHREAD_START_ROUTINE aThreadFunction, LPVOID aThreadParameter, VE_THREAD_CALLBACK aCallback /* = NULL */, LPVOID aCallbackParameter /* = NULL */ )
+bool VEThreadManager::SpawnThread( VEThreadFunction aThreadFunction, LPVOID aThreadParameter, VE_THREAD_CALLBACK aCallback /* = NULL */, LPVOID aCallbackParameter /* = NULL */ )
 {
 	if( aThreadFunction == NULL )
 	{
@@ -68,6 +64,8 @@ bool VEThreadManager::SpawnThread( LPTHREAD_START_ROUTINE aThreadFunction, LPVOI
 // Stops all active threads and frees up the memory used by the thread manager
 void VEThreadManager::Update( float anElapsedTime )
 {
+	VE_PROFILE_ZONE( "VEThreadManager::Update" );
+
 	UpdateActiveThreads();
 
 	UpdatePendingThreads();
@@ -78,25 +76,21 @@ void VEThreadManager::Update( float anElapsedTime )
 void VEThreadManager::UpdateActiveThreads()
 {
 	// Remove any threads that have finished executing
-	DWORD exitCode;
 	for( unsigned int i = 0; i < myActiveThreads.size(); )
 	{
-		if( GetExitCodeThread(myActiveThreads[i]->myThread, &exitCode) )
+		if( myActiveThreads[i]->myThread.IsFinished() )
 		{
-			if( exitCode != STILL_ACTIVE )
+			// Execute the callback
+			if( myActiveThreads[i]->myCallback != NULL )
 			{
-				// Execute the callback
-				if( myActiveThreads[i]->myCallback != NULL )
-				{
-					myActiveThreads[i]->myCallback( myActiveThreads[i]->myCallbackParameter );
-				}
+				myActiveThreads[i]->myCallback( myActiveThreads[i]->myCallbackParameter );
+			}
 
-				delete myActiveThreads[i];
-				myActiveThreads[i] = NULL;
-				myActiveThreads.erase( myActiveThreads.begin() + i );
+			delete myActiveThreads[i];
+			myActiveThreads[i] = NULL;
+			myActiveThreads.erase( myActiveThreads.begin() + i );
 
-				continue;
-			}
+			continue;
 		}
 
 		i++;
@@ -111,11 +105,12 @@ void VEThreadManager::UpdatePendingThreads()
 	{
 		if( myActiveThreads.size() < (unsigned int)myMaxThreadCount )
 		{
-			DWORD	threadId		= 0;
-			HANDLE	threadHandle	= CreateThread( NULL, 0, myPendingThreads[i]->myThreadFunction, myPendingThreads[i]->myThreadParameter, 0, &threadId );
-			assert( threadHandle != NULL );
+			ActiveThread* activeThread = new ActiveThread( myPendingThreads[i]->myCallback, myPendingThreads[i]->myCallbackParameter );
+
+			bool started = activeThread->myThread.Start( myPendingThreads[i]->myThreadFunction, myPendingThreads[i]->myThreadParameter );
+			assert( started );
 
-			myActiveThreads.push_back( new ActiveThread(threadHandle, threadId, myPendingThreads[i]->myCallback, myPendingThreads[i]->myCallbackParameter) );
+			myActiveThreads.push_back( activeThread );
 
 			delete myPendingThreads[i];
 			myPendingThreads[i] = NULL;
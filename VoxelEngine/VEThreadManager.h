@@ -2,10 +2,14 @@
 #define VE_THREAD_MANAGER_H
 
 
+// ---------------------- Includes ---------------------
+
+#include "VEThreading.h"
+
+
 // ---------------------- Typedefs ---------------------
 
 typedef void (*VE_THREAD_CALLBACK)( LPVOID aParameter );
-typedef long int VEThreadId;
 
 
 // ---------------------- Classes ----------------------
@@ -23,16 +27,23 @@ class VEThreadManager
 		// Creates the thread pool
 		bool Initialise( unsigned int aMaxTheadCount = 15 );
 
-		// Stops all active threads and frees up the memory used by the thread manager
+		// Discards the pending threads, waits for the active threads to finish and frees up the memory used by the
+		// thread manager
 		void Uninitialise();
 
 		// Adds a job to the pending thread list
-		bool SpawnThread( LPTHREAD_START_ROUTINE aThreadFunction, LPVOID aThreadParameter, VE_THREAD_CALLBACK aCallback = NULL, LPVOID aCallbackParameter = NULL );
+		bool SpawnThread( VEThreadFunction aThreadFunction, LPVOID aThreadParameter, VE_THREAD_CALLBACK aCallback = NULL, LPVOID aCallbackParameter = NULL );
 
 		// Updates the active threads
 		void Update( float anElapsedTime );
 
 
+		// ------------ Accessors -------------
+
+		// The number of threads waiting to run or still running
+		unsigned int GetThreadCount()		{ return myPendingThreads.size() + myActiveThreads.size(); }
+
+
 	private :
 
 		// --------- Private Structures -------
@@ -41,7 +52,7 @@ class VEThreadManager
 		struct PendingThread
 		{
 			// Construction
-			PendingThread( LPTHREAD_START_ROUTINE aThreadFunction, LPVOID aThreadParameter, VE_THREAD_CALLBACK aCallback, LPVOID aCallbackParameter )
+			PendingThread( VEThreadFunction aThreadFunction, LPVOID aThreadParameter, VE_THREAD_CALLBACK aCallback, LPVOID aCallbackParameter )
 			{
 				myThreadFunction	= aThreadFunction;
 				myThreadParameter	= aThreadParameter;
@@ -63,7 +74,7 @@ class VEThreadManager
 			VE_THREAD_CALLBACK		myCallback;
 			LPVOID					myCallbackParameter;
 
-			LPTHREAD_START_ROUTINE	myThreadFunction;
+			VEThreadFunction		myThreadFunction;
 			LPVOID					myThreadParameter;
 		};
 
@@ -71,11 +82,8 @@ class VEThreadManager
 		struct ActiveThread
 		{
 			// Construction
-			ActiveThread( HANDLE aThread, VEThreadId anId, VE_THREAD_CALLBACK aCallback, LPVOID aCallbackParameter )
+			ActiveThread( VE_THREAD_CALLBACK aCallback, LPVOID aCallbackParameter )
 			{
-				myThread			= aThread;
-				myThreadId			= anId;
-
 				myCallback			= aCallback;
 				myCallbackParameter = aCallbackParameter;
 			}
@@ -83,9 +91,6 @@ class VEThreadManager
 			// Deconstruction
 			~ActiveThread()
 			{
-				myThread			= NULL;
-				myThreadId			= 0;
-				
 				myCallback			= NULL;
 				myCallbackParameter	= NULL;
 			}
@@ -93,8 +98,7 @@ class VEThreadManager
 			VE_THREAD_CALLBACK	myCallback;
 			LPVOID				myCallbackParameter;
 
-			HANDLE				myThread;
-			VEThreadId			myThreadId;
+			VEThread			myThread;
 		};
 
 
@@ -113,8 +117,6 @@ class VEThreadManager
 		std::vector<ActiveThread*>	myActiveThreads;
 
 		unsigned int				myMaxThreadCount;
-
-		long int					myCurrentTheadId;
 };
 
 
@@ -0,0 +1,536 @@
+// --------------------- Includes ---------------------
+
+// Built without the precompiled header, so the threading layer doesn't need the Windows SDK on other platforms
+#include "VEThreading.h"
+
+#include <cassert>
+#include <cstddef>
+
+#ifdef _WIN32
+	#ifndef _WIN32_WINNT
+		#define _WIN32_WINNT	0x0600
+	#endif
+
+	#include <windows.h>
+#else
+	#include <errno.h>
+	#include <pthread.h>
+	#include <sched.h>
+	#include <time.h>
+	#include <unistd.h>
+#endif
+
+
+// ----------------- Global Functions -----------------
+
+// Runs a thread's function, called on the new thread by the platform's thread entry point
+unsigned int VERunThread( void* aThread )
+{
+	VEThread* thread = reinterpret_cast<VEThread*>( aThread );
+
+	thread->myExitCode = thread->myFunction( thread->myParameter );
+
+	return thread->myExitCode;
+}
+
+
+#ifdef _WIN32
+
+// --------------------- Statics ----------------------
+
+// Windows' locks & condition variables are a pointer each, so they're kept in the classes' pointer sized members
+static_assert( sizeof(SRWLOCK) == sizeof(void*) && sizeof(CONDITION_VARIABLE) == sizeof(void*), "The platform's locks don't fit their members" );
+
+
+// ----------------- Global Functions -----------------
+
+// Returns the lock kept in a lock's member
+static SRWLOCK* GetPlatformLock( void*& aLock )
+{
+	return reinterpret_cast<SRWLOCK*>( &aLock );
+}
+
+
+// Returns the condition variable kept in a condition variable's member
+static CONDITION_VARIABLE* GetPlatformConditionVariable( void*& aConditionVariable )
+{
+	return reinterpret_cast<CONDITION_VARIABLE*>( &aConditionVariable );
+}
+
+
+// The platform's thread entry point
+static DWORD WINAPI ThreadEntry( LPVOID aThread )
+{
+	return VERunThread( aThread );
+}
+
+
+// ------------------ Class Functions -----------------
+
+// Construction
+VEThread::VEThread() :
+	myHandle( NULL ),
+	myFunction( NULL ),
+	myParameter( NULL ),
+	myExitCode( 0 )
+{
+}
+
+
+// Deconstruction, the thread must have been joined
+VEThread::~VEThread()
+{
+	assert( myHandle == NULL && "Threads must be joined before they're destroyed" );
+}
+
+
+// Starts running the function on a new thread
+bool VEThread::Start( VEThreadFunction aFunction, void* aParameter )
+{
+	assert( myHandle == NULL && aFunction != NULL );
+
+	myFunction	= aFunction;
+	myParameter	= aParameter;
+	myExitCode	= 0;
+
+	myHandle = CreateThread( NULL, 0, ThreadEntry, this, 0, NULL );
+
+	return myHandle != NULL;
+}
+
+
+// Blocks until the thread has finished
+void VEThread::Join()
+{
+	if( myHandle == NULL )
+	{
+		return;
+	}
+
+	WaitForSingleObject( myHandle, INFINITE );
+
+	CloseHandle( myHandle );
+	myHandle = NULL;
+}
+
+
+// Whether the thread has finished running, without blocking. A finished thread has been joined
+bool VEThread::IsFinished()
+{
+	if( myHandle == NULL )
+	{
+		return true;
+	}
+
+	if( WaitForSingleObject(myHandle, 0) != WAIT_OBJECT_0 )
+	{
+		return false;
+	}
+
+	Join();
+	return true;
+}
+
+
+// Gives up the rest of the calling thread's time slice
+void VEThread::YieldThread()
+{
+	SwitchToThread();
+}
+
+
+// Returns the number of threads the hardware can run at once
+unsigned int VEThread::GetHardwareThreadCount()
+{
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo( &systemInfo );
+
+	return systemInfo.dwNumberOfProcessors > 0 ? systemInfo.dwNumberOfProcessors : 1;
+}
+
+
+// Construction
+VEMutex::VEMutex()
+{
+	InitializeSRWLock( GetPlatformLock(myLock) );
+}
+
+
+// Deconstruction, SRW locks don't need releasing
+VEMutex::~VEMutex()
+{
+}
+
+
+// Blocks until the calling thread holds the lock
+void VEMutex::Lock()
+{
+	AcquireSRWLockExclusive( GetPlatformLock(myLock) );
+}
+
+
+// Releases the lock
+void VEMutex::Unlock()
+{
+	ReleaseSRWLockExclusive( GetPlatformLock(myLock) );
+}
+
+
+// Construction
+VESharedMutex::VESharedMutex()
+{
+	InitializeSRWLock( GetPlatformLock(myLock) );
+}
+
+
+// Deconstruction, SRW locks don't need releasing
+VESharedMutex::~VESharedMutex()
+{
+}
+
+
+// Blocks until the calling thread holds the lock exclusively
+void VESharedMutex::Lock()
+{
+	AcquireSRWLockExclusive( GetPlatformLock(myLock) );
+}
+
+
+// Releases an exclusive lock
+void VESharedMutex::Unlock()
+{
+	ReleaseSRWLockExclusive( GetPlatformLock(myLock) );
+}
+
+
+// Blocks until the calling thread holds the lock shared
+void VESharedMutex::LockShared()
+{
+	AcquireSRWLockShared( GetPlatformLock(myLock) );
+}
+
+
+// Releases a shared lock
+void VESharedMutex::UnlockShared()
+{
+	ReleaseSRWLockShared( GetPlatformLock(myLock) );
+}
+
+
+// Construction
+VEConditionVariable::VEConditionVariable()
+{
+	InitializeConditionVariable( GetPlatformConditionVariable(myConditionVariable) );
+}
+
+
+// Deconstruction, condition variables don't need releasing
+VEConditionVariable::~VEConditionVariable()
+{
+}
+
+
+// Blocks until woken
+void VEConditionVariable::Wait( VEMutex& aMutex )
+{
+	SleepConditionVariableSRW( GetPlatformConditionVariable(myConditionVariable), GetPlatformLock(aMutex.myLock), INFINITE, 0 );
+}
+
+
+// Blocks until woken or the timeout expires, returns false on timeout
+bool VEConditionVariable::WaitFor( VEMutex& aMutex, unsigned int aMilliseconds )
+{
+	return SleepConditionVariableSRW( GetPlatformConditionVariable(myConditionVariable), GetPlatformLock(aMutex.myLock), aMilliseconds, 0 ) != FALSE;
+}
+
+
+// Wakes one waiting thread
+void VEConditionVariable::NotifyOne()
+{
+	WakeConditionVariable( GetPlatformConditionVariable(myConditionVariable) );
+}
+
+
+// Wakes every waiting thread
+void VEConditionVariable::NotifyAll()
+{
+	WakeAllConditionVariable( GetPlatformConditionVariable(myConditionVariable) );
+}
+
+#else
+
+// -------------------- Structures --------------------
+
+// A running thread. pthreads can't tell whether a thread has finished without joining it, so the thread flags it
+struct PlatformThread
+{
+	pthread_t			myThread;
+	VEThread*			myOwner;
+	std::atomic<bool>	myIsFinished;
+};
+
+
+// ----------------- Global Functions -----------------
+
+// Returns the mutex a lock's member points to
+static pthread_mutex_t* GetPlatformMutex( void* aLock )
+{
+	return reinterpret_cast<pthread_mutex_t*>( aLock );
+}
+
+
+// Returns the reader-writer lock a lock's member points to
+static pthread_rwlock_t* GetPlatformLock( void* aLock )
+{
+	return reinterpret_cast<pthread_rwlock_t*>( aLock );
+}
+
+
+// Returns the condition variable a condition variable's member points to
+static pthread_cond_t* GetPlatformConditionVariable( void* aConditionVariable )
+{
+	return reinterpret_cast<pthread_cond_t*>( aConditionVariable );
+}
+
+
+// The platform's thread entry point
+static void* ThreadEntry( void* aPlatformThread )
+{
+	PlatformThread* platformThread = reinterpret_cast<PlatformThread*>( aPlatformThread );
+
+	VERunThread( platformThread->myOwner );
+	platformThread->myIsFinished = true;
+
+	return NULL;
+}
+
+
+// ------------------ Class Functions -----------------
+
+// Construction
+VEThread::VEThread() :
+	myHandle( NULL ),
+	myFunction( NULL ),
+	myParameter( NULL ),
+	myExitCode( 0 )
+{
+}
+
+
+// Deconstruction, the thread must have been joined
+VEThread::~VEThread()
+{
+	assert( myHandle == NULL && "Threads must be joined before they're destroyed" );
+}
+
+
+// Starts running the function on a new thread
+bool VEThread::Start( VEThreadFunction aFunction, void* aParameter )
+{
+	assert( myHandle == NULL && aFunction != NULL );
+
+	myFunction	= aFunction;
+	myParameter	= aParameter;
+	myExitCode	= 0;
+
+	PlatformThread* platformThread	= new PlatformThread();
+	platformThread->myOwner			= this;
+	platformThread->myIsFinished	= false;
+
+	if( pthread_create(&platformThread->myThread, NULL, ThreadEntry, platformThread) != 0 )
+	{
+		delete platformThread;
+		return false;
+	}
+
+	myHandle = platformThread;
+
+	return true;
+}
+
+
+// Blocks until the thread has finished
+void VEThread::Join()
+{
+	if( myHandle == NULL )
+	{
+		return;
+	}
+
+	PlatformThread* platformThread = reinterpret_cast<PlatformThread*>( myHandle );
+	pthread_join( platformThread->myThread, NULL );
+
+	delete platformThread;
+	myHandle = NULL;
+}
+
+
+// Whether the thread has finished running, without blocking. A finished thread has been joined
+bool VEThread::IsFinished()
+{
+	if( myHandle == NULL )
+	{
+		return true;
+	}
+
+	if( !reinterpret_cast<PlatformThread*>(myHandle)->myIsFinished )
+	{
+		return false;
+	}
+
+	Join();
+	return true;
+}
+
+
+// Gives up the rest of the calling thread's time slice
+void VEThread::YieldThread()
+{
+	sched_yield();
+}
+
+
+// Returns the number of threads the hardware can run at once
+unsigned int VEThread::GetHardwareThreadCount()
+{
+	long processorCount = sysconf( _SC_NPROCESSORS_ONLN );
+
+	return processorCount > 0 ? (unsigned int)processorCount : 1;
+}
+
+
+// Construction
+VEMutex::VEMutex()
+{
+	myLock = new pthread_mutex_t;
+	pthread_mutex_init( GetPlatformMutex(myLock), NULL );
+}
+
+
+// Deconstruction
+VEMutex::~VEMutex()
+{
+	pthread_mutex_destroy( GetPlatformMutex(myLock) );
+	delete GetPlatformMutex( myLock );
+}
+
+
+// Blocks until the calling thread holds the lock
+void VEMutex::Lock()
+{
+	pthread_mutex_lock( GetPlatformMutex(myLock) );
+}
+
+
+// Releases the lock
+void VEMutex::Unlock()
+{
+	pthread_mutex_unlock( GetPlatformMutex(myLock) );
+}
+
+
+// Construction
+VESharedMutex::VESharedMutex()
+{
+	myLock = new pthread_rwlock_t;
+	pthread_rwlock_init( GetPlatformLock(myLock), NULL );
+}
+
+
+// Deconstruction
+VESharedMutex::~VESharedMutex()
+{
+	pthread_rwlock_destroy( GetPlatformLock(myLock) );
+	delete GetPlatformLock( myLock );
+}
+
+
+// Blocks until the calling thread holds the lock exclusively
+void VESharedMutex::Lock()
+{
+	pthread_rwlock_wrlock( GetPlatformLock(myLock) );
+}
+
+
+// Releases an exclusive lock
+void VESharedMutex::Unlock()
+{
+	pthread_rwlock_unlock( GetPlatformLock(myLock) );
+}
+
+
+// Blocks until the calling thread holds the lock shared
+void VESharedMutex::LockShared()
+{
+	pthread_rwlock_rdlock( GetPlatformLock(myLock) );
+}
+
+
+// Releases a shared lock
+void VESharedMutex::UnlockShared()
+{
+	pthread_rwlock_unlock( GetPlatformLock(myLock) );
+}
+
+
+// Construction. Timeouts are measured on the monotonic clock, so changing the system time doesn't stretch them
+VEConditionVariable::VEConditionVariable()
+{
+	pthread_condattr_t attributes;
+	pthread_condattr_init( &attributes );
+	pthread_condattr_setclock( &attributes, CLOCK_MONOTONIC );
+
+	myConditionVariable = new pthread_cond_t;
+	pthread_cond_init( GetPlatformConditionVariable(myConditionVariable), &attributes );
+
+	pthread_condattr_destroy( &attributes );
+}
+
+
+// Deconstruction
+VEConditionVariable::~VEConditionVariable()
+{
+	pthread_cond_destroy( GetPlatformConditionVariable(myConditionVariable) );
+	delete GetPlatformConditionVariable( myConditionVariable );
+}
+
+
+// Blocks until woken
+void VEConditionVariable::Wait( VEMutex& aMutex )
+{
+	pthread_cond_wait( GetPlatformConditionVariable(myConditionVariable), GetPlatformMutex(aMutex.myLock) );
+}
+
+
+// Blocks until woken or the timeout expires, returns false on timeout
+bool VEConditionVariable::WaitFor( VEMutex& aMutex, unsigned int aMilliseconds )
+{
+	timespec deadline;
+	clock_gettime( CLOCK_MONOTONIC, &deadline );
+
+	deadline.tv_sec		+= aMilliseconds / 1000;
+	deadline.tv_nsec	+= (long)( aMilliseconds % 1000 ) * 1000000;
+	if( deadline.tv_nsec >= 1000000000 )
+	{
+		deadline.tv_sec++;
+		deadline.tv_nsec -= 1000000000;
+	}
+
+	return pthread_cond_timedwait( GetPlatformConditionVariable(myConditionVariable), GetPlatformMutex(aMutex.myLock), &deadline ) != ETIMEDOUT;
+}
+
+
+// Wakes one waiting thread
+void VEConditionVariable::NotifyOne()
+{
+	pthread_cond_signal( GetPlatformConditionVariable(myConditionVariable) );
+}
+
+
+// Wakes every waiting thread
+void VEConditionVariable::NotifyAll()
+{
+	pthread_cond_broadcast( GetPlatformConditionVariable(myConditionVariable) );
+}
+
+#endif
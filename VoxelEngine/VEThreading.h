@@ -0,0 +1,253 @@
+#ifndef VE_THREADING_H
+#define VE_THREADING_H
+
+
+// --------------------- Includes --------------------
+
+#include <atomic>
+
+
+// --------------------- Defines ---------------------
+
+// Declares a global with a separate, zero initialised copy on every thread
+#ifdef _MSC_VER
+	#define VE_THREAD_LOCAL		__declspec(thread)
+#else
+	#define VE_THREAD_LOCAL		__thread
+#endif
+
+
+// --------------------- Typedefs --------------------
+
+// The function a VEThread runs, its return value becomes the thread's exit code
+typedef unsigned int (*VEThreadFunction)( void* aParameter );
+
+
+// --------------------- Classes ---------------------
+
+// The engine's threading primitives. Engine code creates threads and locks through these rather than the platform's
+// API, so porting the engine only means porting VEThreading.cpp. The platform's objects are kept in pointer sized
+// members, which hold the object itself where it fits (as Windows' locks do) or a pointer to it where it doesn't, so
+// this header doesn't need the platform's headers. Atomics use std::atomic directly
+
+// A thread. The thread starts running when Start is called, and must be joined before the object is destroyed
+class VEThread
+{
+	public :
+
+		// ------ Public Functions ------
+
+		// Construction
+		VEThread();
+
+		// Deconstruction, the thread must have been joined
+		~VEThread();
+
+		// Starts running the function on a new thread. Returns false if the thread couldn't be created
+		bool					Start( VEThreadFunction aFunction, void* aParameter );
+
+		// Blocks until the thread has finished
+		void					Join();
+
+		// Whether the thread has finished running, without blocking
+		bool					IsFinished();
+
+		// Gives up the rest of the calling thread's time slice
+		static void				YieldThread();
+
+		// Returns the number of threads the hardware can run at once
+		static unsigned int		GetHardwareThreadCount();
+
+
+		// --------- Accessors ----------
+
+		// The value returned by the thread function, only valid once the thread has finished
+		unsigned int			GetExitCode()					{ return myExitCode; }
+
+
+	private :
+
+		// ------ Private Functions -----
+
+		// Runs a thread's function, called on the new thread by the platform's thread entry point
+		friend unsigned int		VERunThread( void* aThread );
+
+		// Threads can't be copied
+		VEThread( const VEThread& );
+		VEThread& operator=( const VEThread& );
+
+
+		// ------ Private Variables -----
+
+		void*					myHandle;
+		VEThreadFunction		myFunction;
+		void*					myParameter;
+		unsigned int			myExitCode;
+};
+
+
+// An exclusive lock. Not recursive, a thread mustn't lock a mutex it already holds
+class VEMutex
+{
+	friend class VEConditionVariable;
+
+	public :
+
+		// ------ Public Functions ------
+
+		// Construction
+		VEMutex();
+
+		// Deconstruction
+		~VEMutex();
+
+		// Blocks until the calling thread holds the lock
+		void		Lock();
+
+		// Releases the lock
+		void		Unlock();
+
+
+	private :
+
+		// Mutexes can't be copied
+		VEMutex( const VEMutex& );
+		VEMutex& operator=( const VEMutex& );
+
+		void*		myLock;
+};
+
+
+// A reader-writer lock. Any number of threads can hold it shared at once, without blocking each other, while an
+// exclusive holder blocks everyone else. Not recursive
+class VESharedMutex
+{
+	public :
+
+		// ------ Public Functions ------
+
+		// Construction
+		VESharedMutex();
+
+		// Deconstruction
+		~VESharedMutex();
+
+		// Blocks until the calling thread holds the lock exclusively, for writing
+		void		Lock();
+
+		// Releases an exclusive lock
+		void		Unlock();
+
+		// Blocks until the calling thread holds the lock shared, for reading
+		void		LockShared();
+
+		// Releases a shared lock
+		void		UnlockShared();
+
+
+	private :
+
+		// Mutexes can't be copied
+		VESharedMutex( const VESharedMutex& );
+		VESharedMutex& operator=( const VESharedMutex& );
+
+		void*		myLock;
+};
+
+
+// Lets threads sleep until another thread signals them. Waiting releases the mutex & takes it again before returning
+class VEConditionVariable
+{
+	public :
+
+		// ------ Public Functions ------
+
+		// Construction
+		VEConditionVariable();
+
+		// Deconstruction
+		~VEConditionVariable();
+
+		// Blocks until woken. Can wake spuriously, so the condition being waited on should be checked in a loop
+		void		Wait( VEMutex& aMutex );
+
+		// Blocks until woken or the timeout expires, returns false on timeout
+		bool		WaitFor( VEMutex& aMutex, unsigned int aMilliseconds );
+
+		// Wakes one waiting thread
+		void		NotifyOne();
+
+		// Wakes every waiting thread
+		void		NotifyAll();
+
+
+	private :
+
+		// Condition variables can't be copied
+		VEConditionVariable( const VEConditionVariable& );
+		VEConditionVariable& operator=( const VEConditionVariable& );
+
+		void*		myConditionVariable;
+};
+
+
+// Holds a mutex exclusively for the scope it's declared in. Works with VEMutex & VESharedMutex
+template <typename TMutex>
+class VEScopedLock
+{
+	public :
+
+		// Construction, takes the lock
+		explicit VEScopedLock( TMutex& aMutex ) :
+			myMutex( aMutex )
+		{
+			myMutex.Lock();
+		}
+
+		// Deconstruction, releases the lock
+		~VEScopedLock()
+		{
+			myMutex.Unlock();
+		}
+
+
+	private :
+
+		// Scoped locks can't be copied
+		VEScopedLock( const VEScopedLock& );
+		VEScopedLock& operator=( const VEScopedLock& );
+
+		TMutex&		myMutex;
+};
+
+
+// Holds a shared mutex for reading for the scope it's declared in
+class VEScopedSharedLock
+{
+	public :
+
+		// Construction, takes the lock
+		explicit VEScopedSharedLock( VESharedMutex& aMutex ) :
+			myMutex( aMutex )
+		{
+			myMutex.LockShared();
+		}
+
+		// Deconstruction, releases the lock
+		~VEScopedSharedLock()
+		{
+			myMutex.UnlockShared();
+		}
+
+
+	private :
+
+		// Scoped locks can't be copied
+		VEScopedSharedLock( const VEScopedSharedLock& );
+		VEScopedSharedLock& operator=( const VEScopedSharedLock& );
+
+		VESharedMutex&	myMutex;
+};
+
+
+#endif // !VE_THREADING_H
@@ -62,11 +62,47 @@ enum RenderManagerType
 {
 	RT_Voxel,
 	RT_Deferred,
+	RT_Null,
 
 	RT_Max
 };
 
 
+// Events posted to the engine's event bus. Games can add their own events starting at EE_Max
+enum EngineEvent
+{
+	EE_ChunkBuilt,
+
+	EE_Max
+};
+
+
+// The subsystems heap allocations are accounted against, see VEMemoryTracker
+enum MemoryTag
+{
+	MEM_General,
+	MEM_Chunks,
+	MEM_Meshes,
+	MEM_Noise,
+	MEM_Messages,
+	MEM_RenderLists,
+	MEM_World,
+
+	MEM_Max
+};
+
+
+// The memory the chunk manager keeps within a budget, see VEMemoryBudget
+enum MemoryBudget
+{
+	MB_Voxels,
+	MB_CpuMeshes,
+	MB_GpuMeshes,
+
+	MB_Max
+};
+
+
 // Enumeration for the different types of lights available
 enum LightType
 {
@@ -87,6 +123,47 @@ enum ComponentType
 };
 
 
+// The raw input events the input service timestamps & hands to its listeners, see VEInputService
+enum InputEventType
+{
+	IE_KeyDown,
+	IE_KeyUp,
+	IE_MouseMove,
+
+	IE_Max
+};
+
+
+// The state the engine's per-frame tasks read & write, tasks that touch the same state don't run at the same time.
+// See VETaskGraph
+enum FrameResource
+{
+	FR_Input		= 0x01,
+	FR_Threads		= 0x02,
+	FR_Events		= 0x04,
+	FR_ChunkBuilds	= 0x08,
+	FR_RenderLists	= 0x10,
+	FR_Objects		= 0x20,
+	FR_Components	= 0x40,
+	FR_Physics		= 0x80,
+	FR_Render		= 0x100
+};
+
+
+// The state the engine's startup tasks read & write, tasks that touch the same state don't run at the same time. The
+// game's startup tasks use them too, e.g. generating the world reads the systems & the device. See VETaskGraph
+enum StartupResource
+{
+	SR_Device		= 0x01,
+	SR_Input		= 0x02,
+	SR_Systems		= 0x04,
+	SR_Shaders		= 0x08,
+	SR_Textures		= 0x10,
+	SR_Renderer		= 0x20,
+	SR_World		= 0x40
+};
+
+
 // ------------------ Structures ------------------
 
 // Voxel vertices structure
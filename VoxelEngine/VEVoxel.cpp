@@ -10,14 +10,12 @@
 
 // Construction
 VEVoxel::VEVoxel( VoxelType aVoxelType ) :
-    myType( aVoxelType ),
-	myVisibility( VV_None )
+    myType( aVoxelType )
 {	
 }
 
 
 VEVoxel::VEVoxel() :
-	myType( VT_Grass ),
-	myVisibility( VV_None )
+	myType( VT_Grass )
 {
 }
\ No newline at end of file
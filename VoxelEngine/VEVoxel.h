@@ -9,7 +9,7 @@
 
 // ------------------- Enums --------------------
 
-// A bit mask indicating which sides of a voxel are visible
+// A bit mask indicating which sides of a voxel are visible, calculated in a chunk's snapshot when it's rebuilt
 enum VoxelVisibility
 {
 	VV_None		= 0x00,
@@ -46,9 +46,6 @@ class VEVoxel
         void        SetEnabled( bool anIsEnabled )		{ myEnabled = anIsEnabled; }
         bool        GetEnabled()						{ return myEnabled; }
 
-		void		SetVisibility( DWORD aVisibility )	{ myVisibility = aVisibility; }
-		DWORD		GetVisibility()						{ return myVisibility; }
-
 		VoxelType	GetType()							{ return myType; }    
 		void		SetType( VoxelType aType )			{ myType = aType; }
 
@@ -58,8 +55,6 @@ class VEVoxel
 
         VoxelType	myType;
         bool        myEnabled;
-
-		DWORD		myVisibility;
 };
 
 
@@ -0,0 +1,320 @@
+// --------------------- Includes ---------------------
+
+#include "Stdafx.h"
+#include "VEVoxelCodec.h"
+
+#include "VEVoxel.h"
+
+
+// --------------------- Defines ----------------------
+
+// The shortest match worth encoding, and the furthest back a match can start
+#define VE_CODEC_MIN_MATCH			4
+#define VE_CODEC_MAX_OFFSET			65535
+
+// The compressor finds matches through a hash table of the last position each four byte sequence was seen at
+#define VE_CODEC_HASH_BITS			14
+#define VE_CODEC_HASH_SIZE			(1 << VE_CODEC_HASH_BITS)
+
+// Each sequence starts with a token: the literal count in the high nibble & the match length in the low nibble, where
+// a full nibble is continued in the bytes that follow
+#define VE_CODEC_NIBBLE_MAX			15
+
+// Palette entries are found through a table indexed by a voxel's type & enabled state
+#define VE_CODEC_VOXEL_KEYS			(VE_VOXEL_PALETTE_SIZE * 2)
+
+
+// --------------------- Functions --------------------
+
+// Reads four bytes, whatever their alignment
+static unsigned int ReadSequence( const unsigned char* someBytes )
+{
+	unsigned int sequence;
+	memcpy( &sequence, someBytes, sizeof(sequence) );
+
+	return sequence;
+}
+
+
+// Writes a length in to a token nibble, with the rest in continuation bytes
+static void WriteLength( unsigned int aLength, unsigned char& aNibble, unsigned char* aBuffer, unsigned int& anOutput )
+{
+	if( aLength < VE_CODEC_NIBBLE_MAX )
+	{
+		aNibble = (unsigned char)aLength;
+		return;
+	}
+
+	aNibble = VE_CODEC_NIBBLE_MAX;
+	aLength -= VE_CODEC_NIBBLE_MAX;
+
+	for( ; aLength >= 255; aLength -= 255 )
+	{
+		aBuffer[anOutput++] = 255;
+	}
+	aBuffer[anOutput++] = (unsigned char)aLength;
+}
+
+
+// Reads a length from a token nibble & its continuation bytes. Returns false if the data runs out
+static bool ReadLength( unsigned int aNibble, const unsigned char* aData, unsigned int aSize, unsigned int& anInput, unsigned int& aLength )
+{
+	aLength = aNibble;
+	if( aNibble < VE_CODEC_NIBBLE_MAX )
+	{
+		return true;
+	}
+
+	unsigned char lengthByte = 255;
+	while( lengthByte == 255 )
+	{
+		if( anInput >= aSize )
+		{
+			return false;
+		}
+
+		lengthByte	= aData[anInput++];
+		aLength		+= lengthByte;
+	}
+
+	return true;
+}
+
+
+// Writes a sequence: the literals, then the match if there is one. The last sequence in a block is only literals.
+// Returns false if the buffer is too small
+static bool WriteSequence( const unsigned char* someLiterals, unsigned int aLiteralCount, unsigned int aMatchOffset, unsigned int aMatchLength,
+						   unsigned char* aBuffer, unsigned int aBufferSize, unsigned int& anOutput )
+{
+	unsigned int requiredSize = 1 + aLiteralCount + aLiteralCount / 255 + 1;
+	if( aMatchLength > 0 )
+	{
+		requiredSize += 2 + aMatchLength / 255 + 1;
+	}
+
+	if( anOutput + requiredSize > aBufferSize )
+	{
+		return false;
+	}
+
+	unsigned int	tokenPosition	= anOutput++;
+	unsigned char	literalNibble	= 0;
+	unsigned char	matchNibble		= 0;
+
+	WriteLength( aLiteralCount, literalNibble, aBuffer, anOutput );
+	memcpy( aBuffer + anOutput, someLiterals, aLiteralCount );
+	anOutput += aLiteralCount;
+
+	if( aMatchLength > 0 )
+	{
+		aBuffer[anOutput++] = (unsigned char)( aMatchOffset & 0xFF );
+		aBuffer[anOutput++] = (unsigned char)( aMatchOffset >> 8 );
+
+		WriteLength( aMatchLength - VE_CODEC_MIN_MATCH, matchNibble, aBuffer, anOutput );
+	}
+
+	aBuffer[tokenPosition] = (unsigned char)( (literalNibble << 4) | matchNibble );
+
+	return true;
+}
+
+
+// ------------------ Class Functions -----------------
+
+// Reduces the voxels to palette indices
+unsigned int VEVoxelCodec::BuildPalette( VEVoxel* someVoxels, unsigned int aVoxelCount, VEVoxel* aPalette, unsigned char* someIndices )
+{
+	assert( someVoxels != NULL && aPalette != NULL && someIndices != NULL );
+
+	// Zero marks a voxel that isn't in the palette yet, entries are stored one higher
+	unsigned short paletteEntries[VE_CODEC_VOXEL_KEYS];
+	memset( paletteEntries, 0, sizeof(paletteEntries) );
+
+	unsigned int paletteSize = 0;
+	for( unsigned int i = 0; i < aVoxelCount; i++ )
+	{
+		VEVoxel&		voxel	= someVoxels[i];
+		unsigned int	key		= (unsigned int)voxel.GetType() * 2 + (voxel.GetEnabled() ? 1 : 0);
+		if( key >= VE_CODEC_VOXEL_KEYS )
+		{
+			return 0;
+		}
+
+		if( paletteEntries[key] == 0 )
+		{
+			if( paletteSize == VE_VOXEL_PALETTE_SIZE )
+			{
+				return 0;
+			}
+
+			aPalette[paletteSize]	= voxel;
+			paletteEntries[key]		= (unsigned short)++paletteSize;
+		}
+
+		someIndices[i] = (unsigned char)( paletteEntries[key] - 1 );
+	}
+
+	return paletteSize;
+}
+
+
+// Writes the palette as a type & enabled byte per entry
+void VEVoxelCodec::WritePalette( const VEVoxel* aPalette, unsigned int aPaletteSize, unsigned char* aBuffer )
+{
+	for( unsigned int i = 0; i < aPaletteSize; i++ )
+	{
+		VEVoxel voxel = aPalette[i];
+
+		aBuffer[i * 2]		= (unsigned char)voxel.GetType();
+		aBuffer[i * 2 + 1]	= voxel.GetEnabled() ? 1 : 0;
+	}
+}
+
+
+// Reads a palette written by WritePalette
+bool VEVoxelCodec::ReadPalette( const unsigned char* aData, unsigned int aPaletteSize, VEVoxel* aPalette )
+{
+	bool isValid = true;
+	for( unsigned int i = 0; i < aPaletteSize; i++ )
+	{
+		isValid &= aData[i * 2] < VT_Max;
+
+		aPalette[i].SetType( (VoxelType)aData[i * 2] );
+		aPalette[i].SetEnabled( aData[i * 2 + 1] != 0 );
+	}
+
+	return isValid;
+}
+
+
+// The largest compressed size of the supplied number of bytes, incompressible data grows by its literal lengths
+unsigned int VEVoxelCodec::GetMaxCompressedSize( unsigned int aSize )
+{
+	return aSize + aSize / 255 + 16;
+}
+
+
+// Compresses the bytes in to the buffer. Matches are found greedily through the hash table, the way LZ4's fast mode
+// does, trading a little ratio for speed
+unsigned int VEVoxelCodec::Compress( const unsigned char* someBytes, unsigned int aSize, unsigned char* aBuffer, unsigned int aBufferSize )
+{
+	assert( someBytes != NULL && aBuffer != NULL );
+
+	// Positions are stored one higher, so zero is an empty slot
+	unsigned int hashTable[VE_CODEC_HASH_SIZE];
+	memset( hashTable, 0, sizeof(hashTable) );
+
+	unsigned int input	= 0;
+	unsigned int anchor	= 0;
+	unsigned int output	= 0;
+
+	while( input + VE_CODEC_MIN_MATCH <= aSize )
+	{
+		unsigned int sequence	= ReadSequence( someBytes + input );
+		unsigned int hash		= (sequence * 2654435761U) >> (32 - VE_CODEC_HASH_BITS);
+		unsigned int candidate	= hashTable[hash];
+
+		hashTable[hash] = input + 1;
+
+		if( candidate == 0 || input - (candidate - 1) > VE_CODEC_MAX_OFFSET || ReadSequence(someBytes + candidate - 1) != sequence )
+		{
+			input++;
+			continue;
+		}
+		candidate--;
+
+		// Extend the match as far as it goes
+		unsigned int matchLength = VE_CODEC_MIN_MATCH;
+		while( input + matchLength < aSize && someBytes[candidate + matchLength] == someBytes[input + matchLength] )
+		{
+			matchLength++;
+		}
+
+		if( !WriteSequence(someBytes + anchor, input - anchor, input - candidate, matchLength, aBuffer, aBufferSize, output) )
+		{
+			return 0;
+		}
+
+		input	+= matchLength;
+		anchor	= input;
+	}
+
+	// The bytes after the last match are literals
+	if( !WriteSequence(someBytes + anchor, aSize - anchor, 0, 0, aBuffer, aBufferSize, output) )
+	{
+		return 0;
+	}
+
+	return output;
+}
+
+
+// Decompresses palette indices straight in to the voxels
+bool VEVoxelCodec::DecompressVoxels( const unsigned char* aData, unsigned int aSize, const VEVoxel* aPalette, unsigned int aPaletteSize,
+									 VEVoxel* someVoxels, unsigned int aVoxelCount )
+{
+	assert( aData != NULL && aPalette != NULL && someVoxels != NULL );
+
+	unsigned int input	= 0;
+	unsigned int output	= 0;
+
+	while( input < aSize )
+	{
+		unsigned char token = aData[input++];
+
+		// Literals, looked up in the palette
+		unsigned int literalCount;
+		if( !ReadLength(token >> 4, aData, aSize, input, literalCount) || literalCount > aSize - input || literalCount > aVoxelCount - output )
+		{
+			return false;
+		}
+
+		for( unsigned int i = 0; i < literalCount; i++ )
+		{
+			unsigned char paletteIndex = aData[input++];
+			if( paletteIndex >= aPaletteSize )
+			{
+				return false;
+			}
+
+			someVoxels[output++] = aPalette[paletteIndex];
+		}
+
+		// The last sequence ends with its literals
+		if( input == aSize )
+		{
+			break;
+		}
+
+		// The match, copied from the voxels already written. Matches can overlap the voxels they write, which is how
+		// runs are repeated, so they're copied one voxel at a time
+		if( aSize - input < 2 )
+		{
+			return false;
+		}
+
+		unsigned int matchOffset = aData[input] | (aData[input + 1] << 8);
+		input += 2;
+
+		unsigned int matchLength;
+		if( !ReadLength(token & VE_CODEC_NIBBLE_MAX, aData, aSize, input, matchLength) )
+		{
+			return false;
+		}
+		matchLength += VE_CODEC_MIN_MATCH;
+
+		if( matchOffset == 0 || matchOffset > output || matchLength > aVoxelCount - output )
+		{
+			return false;
+		}
+
+		const VEVoxel* matchSource = someVoxels + output - matchOffset;
+		for( unsigned int i = 0; i < matchLength; i++ )
+		{
+			someVoxels[output + i] = matchSource[i];
+		}
+		output += matchLength;
+	}
+
+	return output == aVoxelCount;
+}
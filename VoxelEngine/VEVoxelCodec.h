@@ -0,0 +1,59 @@
+#ifndef VE_VOXEL_CODEC_H
+#define VE_VOXEL_CODEC_H
+
+
+// --------------------- Includes --------------------
+
+#include "VETypes.h"
+
+
+// ---------------- Forward Declarations -------------
+
+class VEVoxel;
+
+
+// --------------------- Defines ---------------------
+
+// The most distinct voxels a chunk can hold, each voxel is stored as a one byte index in to the chunk's palette
+#define VE_VOXEL_PALETTE_SIZE		256
+
+
+// --------------------- Classes ---------------------
+
+// Compresses chunks for storage. A chunk's voxels are first reduced to one byte indices in to a palette of the distinct
+// voxels in the chunk, then the indices are compressed with a small LZ77 codec in the style of LZ4: sequences of
+// literals followed by a match copied from earlier in the chunk. Runs of the same voxel are matches one voxel back,
+// so the codec run length encodes air & solid ground without a separate pass.
+//
+// Decompression writes voxels straight in to a chunk's voxel block, literals are looked up in the palette and matches
+// copy voxels already written, so a stored chunk can be decoded from a mapped file without an intermediate buffer
+class VEVoxelCodec
+{
+	public :
+
+		// ------ Public Functions ------
+
+		// Reduces the voxels to palette indices. Returns the number of voxels in the palette, or zero if the voxels
+		// need more than VE_VOXEL_PALETTE_SIZE entries
+		static unsigned int		BuildPalette( VEVoxel* someVoxels, unsigned int aVoxelCount, VEVoxel* aPalette, unsigned char* someIndices );
+
+		// Writes the palette as a type & enabled byte per entry, two bytes per entry in all
+		static void				WritePalette( const VEVoxel* aPalette, unsigned int aPaletteSize, unsigned char* aBuffer );
+
+		// Reads a palette written by WritePalette. Returns false if it holds a voxel type the engine doesn't have
+		static bool				ReadPalette( const unsigned char* aData, unsigned int aPaletteSize, VEVoxel* aPalette );
+
+		// The largest compressed size of the supplied number of bytes
+		static unsigned int		GetMaxCompressedSize( unsigned int aSize );
+
+		// Compresses the bytes in to the buffer, returning the compressed size or zero if the buffer is too small
+		static unsigned int		Compress( const unsigned char* someBytes, unsigned int aSize, unsigned char* aBuffer, unsigned int aBufferSize );
+
+		// Decompresses palette indices straight in to the voxels. Returns false if the data is corrupt, or doesn't
+		// decompress to exactly the supplied number of voxels
+		static bool				DecompressVoxels( const unsigned char* aData, unsigned int aSize, const VEVoxel* aPalette, unsigned int aPaletteSize,
+												  VEVoxel* someVoxels, unsigned int aVoxelCount );
+};
+
+
+#endif // !VE_VOXEL_CODEC_H
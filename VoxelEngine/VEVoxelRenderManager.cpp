@@ -11,6 +11,7 @@
 #include "VEBasicCamera.h"
 #include "VEChunkManager.h"
 #include "VEShaderManager.h"
+#include "VEProfiler.h"
 
 
 // ----------------- Namespaces -----------------
@@ -54,6 +55,13 @@ bool VEVoxelRenderManager::Initialise( int aScreenWidth, int aScreenHeight )
 }
 
 
+// Adds the voxel shader
+void VEVoxelRenderManager::GetResources( std::vector<VEShaderType>& someShaderTypes, std::vector<std::wstring>& )
+{
+	someShaderTypes.push_back( VST_Voxel );
+}
+
+
 // Cleans up the renderer
 void VEVoxelRenderManager::Uninitialise()
 {
@@ -66,22 +74,19 @@ void VEVoxelRenderManager::Uninitialise()
 
 
 // Draws all of the voxels
-void VEVoxelRenderManager::RenderScene()
+void VEVoxelRenderManager::RenderScene( VERenderState& aRenderState )
 {
+	VE_PROFILE_ZONE( "VEVoxelRenderManager::RenderScene" );
+
     VEDirectXInterface* renderInterface = VoxelEngine::GetInstance()->GetRenderInterface();
     assert( renderInterface != NULL );
 
-	VEBasicCamera* camera = VoxelEngine::GetInstance()->GetCamera();
+	VEBasicCamera* camera = aRenderState.GetCamera();
 	assert( camera != NULL );
 
-	VEChunkManager* chunkManager = VoxelEngine::GetInstance()->GetChunkManager();
-	assert( chunkManager != NULL );
-
 	VEShaderManager* shaderManager = VoxelEngine::GetInstance()->GetShaderManager();
 	assert( shaderManager != NULL );
 
-	std::vector<VEChunk*> engineChunks = chunkManager->GetChunks();
-
 	// Set the render targets
 	renderInterface->SetBackBufferRenderTarget( myDepthStencilTarget->myDepthStencilView );
     renderInterface->Clear( myClearColour );
@@ -90,20 +95,17 @@ void VEVoxelRenderManager::RenderScene()
 	assert( voxelShader != NULL );
 
 	// Render the engine chunks
-	for( unsigned int i = 0; i < engineChunks.size(); i++ )
-	{			
-		if( !engineChunks[i]->GetEnabled() )
-		{
-			continue;
-		}
-
-		engineChunks[i]->Prepare();
+	const std::vector<VEChunkDrawItem>& chunks = aRenderState.GetChunks();
+	for( unsigned int i = 0; i < chunks.size(); i++ )
+	{
+		VEChunk::Prepare( chunks[i] );
 
-		// Populate the shader constants
+		// Populate the shader constants, the chunk's mesh is drawn at its position
+		voxelShader->SetDrawOffset( chunks[i].myPosition );
 		voxelShader->PopulateVertexShaderConstants( camera, NULL );
 		voxelShader->PopulatePixelShaderConstants( camera, NULL );
 
-		voxelShader->DrawIndexed( engineChunks[i]->GetIndexCount() );
+		voxelShader->DrawIndexed( chunks[i].myIndexCount );
 	}
 	
     renderInterface->PresentBuffer();
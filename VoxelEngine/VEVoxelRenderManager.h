@@ -30,11 +30,14 @@ class VEVoxelRenderManager : public VERenderManager
         // Initialises the renderer
         virtual bool        Initialise( int aScreenWidth, int aScreenHeight ) override;
 
+        // Adds the voxel shader
+        virtual void        GetResources( std::vector<VEShaderType>& someShaderTypes, std::vector<std::wstring>& someTextureFiles ) override;
+
         // Cleans up the renderer
         virtual void        Uninitialise() override;
 
         // Draws all of the voxels
-        virtual void        RenderScene() override;
+        virtual void        RenderScene( VERenderState& aRenderState ) override;
 
 
     private :
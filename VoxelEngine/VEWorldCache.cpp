@@ -0,0 +1,587 @@
+// --------------------- Includes ---------------------
+
+#include "Stdafx.h"
+#include "VEWorldCache.h"
+
+#include "VEChunk.h"
+#include "VEChunkData.h"
+#include "VERegionFile.h"
+#include "VEVoxelCodec.h"
+#include "VEVoxel.h"
+#include "VEMemoryTracker.h"
+#include "VEProfiler.h"
+
+
+// ------------------ Class Functions -----------------
+
+// Construction
+VEWorldCache::VEWorldCache() :
+	myIsOpen( false ),
+	mySeed( 0 ),
+	myGeneratorHash( 0 ),
+	myVoxelHitCount( 0 ),
+	myMeshHitCount( 0 ),
+	myStaleCount( 0 ),
+	mySavedCount( 0 ),
+	mySavedBytes( 0 ),
+	mySpilledCount( 0 ),
+	myRestoredCount( 0 )
+{
+}
+
+
+// Deconstruction, closes the cache
+VEWorldCache::~VEWorldCache()
+{
+	Close();
+}
+
+
+// Opens the cache in the supplied directory, creating the directory if it doesn't exist
+bool VEWorldCache::Open( const std::wstring& aDirectory )
+{
+	Close();
+
+	myDirectory = aDirectory;
+	if( !CreateDirectoryW(myDirectory.c_str(), NULL) && GetLastError() != ERROR_ALREADY_EXISTS )
+	{
+		return false;
+	}
+
+	myVoxelHitCount	= 0;
+	myMeshHitCount	= 0;
+	myStaleCount	= 0;
+	mySavedCount	= 0;
+	mySavedBytes	= 0;
+	mySpilledCount	= 0;
+	myRestoredCount	= 0;
+
+	myIsOpen = true;
+
+	return true;
+}
+
+
+// Closes the region files, deleting the spill regions
+void VEWorldCache::Close()
+{
+	if( !myIsOpen )
+	{
+		return;
+	}
+
+	VEScopedLock<VEMutex> lock( myRegionLock );
+
+	for( unsigned int i = 0; i < ET_Max; i++ )
+	{
+		for( RegionMap::iterator iter = myRegions[i].begin(); iter != myRegions[i].end(); iter++ )
+		{
+			iter->second->Close();
+			delete iter->second;
+
+			// Spilled voxels are only needed by the chunks that spilled them
+			if( i == ET_Spill )
+			{
+				DeleteFileW( GetRegionPath(ET_Spill, iter->first.first, iter->first.second).c_str() );
+			}
+		}
+		myRegions[i].clear();
+	}
+
+	myIsOpen = false;
+}
+
+
+// Sets the seed & a hash of the parameters the terrain is being generated with
+void VEWorldCache::SetGenerator( int aSeed, unsigned int aGeneratorHash )
+{
+	mySeed			= aSeed;
+	myGeneratorHash	= aGeneratorHash;
+}
+
+
+// Loads the chunk's generated voxels
+bool VEWorldCache::LoadVoxels( VEChunk* aChunk )
+{
+	assert( aChunk != NULL );
+
+	if( !myIsOpen )
+	{
+		return false;
+	}
+
+	VE_PROFILE_ZONE( "VEWorldCache::LoadVoxels" );
+
+	VERegionFile* region = GetRegion( ET_Voxels, aChunk->GetGridX(), aChunk->GetGridZ(), aChunk->GetDimensions(), false );
+	if( region == NULL )
+	{
+		return false;
+	}
+
+	int localX = aChunk->GetGridX() - VERegionFile::GetRegionCoordinate( aChunk->GetGridX() ) * VE_REGION_SIZE;
+	int localZ = aChunk->GetGridZ() - VERegionFile::GetRegionCoordinate( aChunk->GetGridZ() ) * VE_REGION_SIZE;
+
+	unsigned int			entrySize	= 0;
+	const unsigned char*	entry		= region->LockChunk( localX, localZ, entrySize );
+	if( entry == NULL )
+	{
+		return false;
+	}
+
+	EntryHeader key;
+	BuildHeader( aChunk, ET_Voxels, 0, key );
+
+	unsigned int	voxelCount	= (unsigned int)( aChunk->GetDimensions() * aChunk->GetDimensions() * aChunk->GetDimensions() );
+	bool			isStale		= true;
+	bool			succeeded	= false;
+
+	EntryHeader header;
+	if( entrySize >= sizeof(header) )
+	{
+		memcpy( &header, entry, sizeof(header) );
+
+		// The palette size & voxel count are the entry's counts
+		unsigned int headerSize = sizeof(header) + header.myCount * 2;
+
+		isStale = !IsHeaderMatching( header, key );
+		if( !isStale && header.mySecondCount == voxelCount && header.myCount > 0 && header.myCount <= VE_VOXEL_PALETTE_SIZE && headerSize <= entrySize )
+		{
+			// Decode straight from the mapped view in to the chunk
+			VEVoxel palette[VE_VOXEL_PALETTE_SIZE];
+			if( VEVoxelCodec::ReadPalette(entry + sizeof(header), header.myCount, palette) )
+			{
+				VEScopedLock<VESharedMutex> voxelLock( aChunk->GetVoxelLock() );
+
+				succeeded = VEVoxelCodec::DecompressVoxels( entry + headerSize, entrySize - headerSize, palette, header.myCount, aChunk->GetVoxels(), voxelCount );
+			}
+		}
+	}
+
+	region->UnlockChunk();
+
+	{
+		VEScopedLock<VEMutex> lock( myRegionLock );
+
+		if( succeeded )
+		{
+			myVoxelHitCount++;
+		}
+		else if( isStale )
+		{
+			myStaleCount++;
+		}
+	}
+
+	if( !succeeded )
+	{
+		return false;
+	}
+
+	// The same as the chunk having been generated
+	aChunk->SetIsDirty( true );
+	aChunk->SetNeighboursDirty( true );
+	aChunk->SetIsModified( true );
+
+	return true;
+}
+
+
+// Caches the chunk's voxels
+bool VEWorldCache::SaveVoxels( VEChunk* aChunk )
+{
+	assert( aChunk != NULL );
+
+	if( !myIsOpen )
+	{
+		return false;
+	}
+
+	VE_PROFILE_ZONE( "VEWorldCache::SaveVoxels" );
+	VE_MEMORY_TAG( MEM_World );
+
+	unsigned int				voxelCount = (unsigned int)( aChunk->GetDimensions() * aChunk->GetDimensions() * aChunk->GetDimensions() );
+	std::vector<unsigned char>	indices( voxelCount );
+	VEVoxel						palette[VE_VOXEL_PALETTE_SIZE];
+	unsigned int				paletteSize = 0;
+	{
+		VEScopedSharedLock voxelLock( aChunk->GetVoxelLock() );
+
+		paletteSize = VEVoxelCodec::BuildPalette( aChunk->GetVoxels(), voxelCount, palette, &indices[0] );
+	}
+
+	if( paletteSize == 0 )
+	{
+		return false;
+	}
+
+	EntryHeader header;
+	BuildHeader( aChunk, ET_Voxels, 0, header );
+	header.myCount			= paletteSize;
+	header.mySecondCount	= voxelCount;
+
+	unsigned int				headerSize	= sizeof(header) + paletteSize * 2;
+	std::vector<unsigned char>	entry( headerSize + VEVoxelCodec::GetMaxCompressedSize(voxelCount) );
+
+	memcpy( &entry[0], &header, sizeof(header) );
+	VEVoxelCodec::WritePalette( palette, paletteSize, &entry[sizeof(header)] );
+
+	unsigned int compressedSize = VEVoxelCodec::Compress( &indices[0], voxelCount, &entry[headerSize], (unsigned int)entry.size() - headerSize );
+	if( compressedSize == 0 )
+	{
+		return false;
+	}
+
+	entry.resize( headerSize + compressedSize );
+
+	return WriteEntry( ET_Voxels, aChunk, entry );
+}
+
+
+// Creates the chunk's vertex & index buffers straight from its cached mesh
+bool VEWorldCache::LoadMesh( VEChunk* aChunk )
+{
+	assert( aChunk != NULL && aChunk->GetRenderData() != NULL );
+
+	if( !myIsOpen )
+	{
+		return false;
+	}
+
+	VE_PROFILE_ZONE( "VEWorldCache::LoadMesh" );
+
+	VERegionFile* region = GetRegion( ET_Mesh, aChunk->GetGridX(), aChunk->GetGridZ(), aChunk->GetDimensions(), false );
+	if( region == NULL )
+	{
+		return false;
+	}
+
+	int localX = aChunk->GetGridX() - VERegionFile::GetRegionCoordinate( aChunk->GetGridX() ) * VE_REGION_SIZE;
+	int localZ = aChunk->GetGridZ() - VERegionFile::GetRegionCoordinate( aChunk->GetGridZ() ) * VE_REGION_SIZE;
+
+	unsigned int			entrySize	= 0;
+	const unsigned char*	entry		= region->LockChunk( localX, localZ, entrySize );
+	if( entry == NULL )
+	{
+		return false;
+	}
+
+	VEChunk* neighbours[CN_Max];
+	aChunk->GetNeighbours( neighbours );
+
+	EntryHeader key;
+	BuildHeader( aChunk, ET_Mesh, GetNeighbourMask(neighbours), key );
+
+	bool isStale	= true;
+	bool succeeded	= false;
+
+	EntryHeader header;
+	if( entrySize >= sizeof(header) )
+	{
+		memcpy( &header, entry, sizeof(header) );
+
+		// The vertex & index counts are the entry's counts
+		unsigned long long meshSize = (unsigned long long)header.myCount * sizeof(VoxelVertices) + (unsigned long long)header.mySecondCount * sizeof(unsigned long);
+
+		isStale = !IsHeaderMatching( header, key );
+		if( !isStale && sizeof(header) + meshSize == entrySize )
+		{
+			// Upload straight from the mapped view, the mesh is never copied in to memory of the engine's own
+			const VoxelVertices*	vertices	= reinterpret_cast<const VoxelVertices*>( entry + sizeof(header) );
+			const unsigned long*	indices		= reinterpret_cast<const unsigned long*>( entry + sizeof(header) + header.myCount * sizeof(VoxelVertices) );
+
+			succeeded = aChunk->GetRenderData()->CreateBuffers( vertices, header.myCount, indices, header.mySecondCount );
+		}
+	}
+
+	region->UnlockChunk();
+
+	{
+		VEScopedLock<VEMutex> lock( myRegionLock );
+
+		if( succeeded )
+		{
+			myMeshHitCount++;
+		}
+		else if( isStale )
+		{
+			myStaleCount++;
+		}
+	}
+
+	if( !succeeded )
+	{
+		return false;
+	}
+
+	aChunk->SetIsDirty( false );
+	aChunk->SetEnabled( true );
+
+	return true;
+}
+
+
+// Caches the mesh built for the chunk
+bool VEWorldCache::SaveMesh( VEChunk* aChunk, unsigned int aNeighbourMask, const VoxelVertices* someVertices, unsigned int aVertexCount,
+							 const unsigned long* someIndices, unsigned int anIndexCount )
+{
+	assert( aChunk != NULL );
+
+	if( !myIsOpen )
+	{
+		return false;
+	}
+
+	VE_PROFILE_ZONE( "VEWorldCache::SaveMesh" );
+	VE_MEMORY_TAG( MEM_World );
+
+	EntryHeader header;
+	BuildHeader( aChunk, ET_Mesh, aNeighbourMask, header );
+	header.myCount			= aVertexCount;
+	header.mySecondCount	= anIndexCount;
+
+	unsigned int				verticesSize	= aVertexCount * sizeof(VoxelVertices);
+	unsigned int				indicesSize		= anIndexCount * sizeof(unsigned long);
+	std::vector<unsigned char>	entry( sizeof(header) + verticesSize + indicesSize );
+
+	memcpy( &entry[0], &header, sizeof(header) );
+	if( verticesSize > 0 )
+	{
+		memcpy( &entry[sizeof(header)], someVertices, verticesSize );
+	}
+	if( indicesSize > 0 )
+	{
+		memcpy( &entry[sizeof(header) + verticesSize], someIndices, indicesSize );
+	}
+
+	return WriteEntry( ET_Mesh, aChunk, entry );
+}
+
+
+// Writes a chunk's compressed voxels to the spill regions
+bool VEWorldCache::SpillVoxels( VEChunk* aChunk, const unsigned char* someCompressedVoxels, unsigned int aCompressedSize, unsigned int aPaletteSize )
+{
+	assert( aChunk != NULL && someCompressedVoxels != NULL );
+
+	if( !myIsOpen )
+	{
+		return false;
+	}
+
+	VE_PROFILE_ZONE( "VEWorldCache::SpillVoxels" );
+	VE_MEMORY_TAG( MEM_World );
+
+	// The same layout as a voxel entry, the compressed voxels already start with the palette
+	EntryHeader header;
+	BuildHeader( aChunk, ET_Spill, 0, header );
+	header.myCount			= aPaletteSize;
+	header.mySecondCount	= aCompressedSize;
+
+	std::vector<unsigned char> entry( sizeof(header) + aCompressedSize );
+	memcpy( &entry[0], &header, sizeof(header) );
+	memcpy( &entry[sizeof(header)], someCompressedVoxels, aCompressedSize );
+
+	return WriteEntry( ET_Spill, aChunk, entry );
+}
+
+
+// Reads back a chunk's spilled voxels in to a buffer allocated with new[]
+unsigned char* VEWorldCache::RestoreVoxels( VEChunk* aChunk, unsigned int& aCompressedSize, unsigned int& aPaletteSize )
+{
+	assert( aChunk != NULL );
+
+	if( !myIsOpen )
+	{
+		return NULL;
+	}
+
+	VE_PROFILE_ZONE( "VEWorldCache::RestoreVoxels" );
+
+	VERegionFile* region = GetRegion( ET_Spill, aChunk->GetGridX(), aChunk->GetGridZ(), aChunk->GetDimensions(), false );
+	if( region == NULL )
+	{
+		return NULL;
+	}
+
+	int localX = aChunk->GetGridX() - VERegionFile::GetRegionCoordinate( aChunk->GetGridX() ) * VE_REGION_SIZE;
+	int localZ = aChunk->GetGridZ() - VERegionFile::GetRegionCoordinate( aChunk->GetGridZ() ) * VE_REGION_SIZE;
+
+	unsigned int			entrySize	= 0;
+	const unsigned char*	entry		= region->LockChunk( localX, localZ, entrySize );
+	if( entry == NULL )
+	{
+		return NULL;
+	}
+
+	EntryHeader key;
+	BuildHeader( aChunk, ET_Spill, 0, key );
+
+	unsigned char* compressedVoxels = NULL;
+
+	EntryHeader header;
+	if( entrySize >= sizeof(header) )
+	{
+		memcpy( &header, entry, sizeof(header) );
+
+		if( IsHeaderMatching(header, key) && sizeof(header) + header.mySecondCount == entrySize && header.myCount > 0 && header.myCount <= VE_VOXEL_PALETTE_SIZE )
+		{
+			VE_MEMORY_TAG( MEM_Chunks );
+
+			compressedVoxels = new unsigned char[header.mySecondCount];
+			memcpy( compressedVoxels, entry + sizeof(header), header.mySecondCount );
+
+			aCompressedSize	= header.mySecondCount;
+			aPaletteSize	= header.myCount;
+		}
+	}
+
+	region->UnlockChunk();
+
+	if( compressedVoxels != NULL )
+	{
+		VEScopedLock<VEMutex> lock( myRegionLock );
+		myRestoredCount++;
+	}
+
+	return compressedVoxels;
+}
+
+
+// Returns which of a chunk's neighbours are in the chunk grid
+unsigned int VEWorldCache::GetNeighbourMask( VEChunk* someNeighbours[CN_Max] )
+{
+	unsigned int neighbourMask = 0;
+	for( unsigned int i = 0; i < CN_Max; i++ )
+	{
+		if( someNeighbours[i] != NULL )
+		{
+			neighbourMask |= 1 << i;
+		}
+	}
+
+	return neighbourMask;
+}
+
+
+// The size of the cache's region files
+unsigned long long VEWorldCache::GetFileSize()
+{
+	VEScopedLock<VEMutex> lock( myRegionLock );
+
+	unsigned long long fileSize = 0;
+	for( unsigned int i = 0; i < ET_Max; i++ )
+	{
+		for( RegionMap::iterator iter = myRegions[i].begin(); iter != myRegions[i].end(); iter++ )
+		{
+			fileSize += iter->second->GetFileSize();
+		}
+	}
+
+	return fileSize;
+}
+
+
+// Fills in the key of the chunk's entry
+void VEWorldCache::BuildHeader( VEChunk* aChunk, EntryType aType, unsigned int aNeighbourMask, EntryHeader& aHeader )
+{
+	aHeader.myMagic			= VE_WORLD_CACHE_MAGIC;
+	aHeader.myVersion		= VE_WORLD_CACHE_VERSION;
+	aHeader.myType			= aType;
+	aHeader.mySeed			= mySeed;
+	aHeader.myGeneratorHash	= myGeneratorHash;
+	aHeader.myGridX			= aChunk->GetGridX();
+	aHeader.myGridZ			= aChunk->GetGridZ();
+	aHeader.myNeighbourMask	= aNeighbourMask;
+	aHeader.myMaxHeight		= aChunk->GetMaxHeight();
+	aHeader.myCount			= 0;
+	aHeader.mySecondCount	= 0;
+}
+
+
+// Whether an entry's header has the supplied key
+bool VEWorldCache::IsHeaderMatching( const EntryHeader& aHeader, const EntryHeader& aKey )
+{
+	return aHeader.myMagic == aKey.myMagic && aHeader.myVersion == aKey.myVersion && aHeader.myType == aKey.myType && aHeader.mySeed == aKey.mySeed &&
+		   aHeader.myGeneratorHash == aKey.myGeneratorHash && aHeader.myGridX == aKey.myGridX && aHeader.myGridZ == aKey.myGridZ &&
+		   aHeader.myNeighbourMask == aKey.myNeighbourMask && aHeader.myMaxHeight == aKey.myMaxHeight;
+}
+
+
+// Returns the path of the region file holding entries of the supplied type at the region coordinates
+std::wstring VEWorldCache::GetRegionPath( EntryType aType, int aRegionX, int aRegionZ )
+{
+	static const wchar_t* ourFilenames[ET_Max] = { L"voxels.%d.%d.vreg", L"mesh.%d.%d.vreg", L"spill.%d.%d.vreg" };
+
+	// Region files are named after what they hold & their coordinates
+	wchar_t filename[64];
+	swprintf_s( filename, ourFilenames[aType], aRegionX, aRegionZ );
+
+	return myDirectory + filename;
+}
+
+
+// Returns the region file holding the chunk's entries of the supplied type, opening it if it isn't already
+VERegionFile* VEWorldCache::GetRegion( EntryType aType, int aGridX, int aGridZ, int aChunkDimensions, bool aCreate )
+{
+	std::pair<int, int> regionCoordinates( VERegionFile::GetRegionCoordinate(aGridX), VERegionFile::GetRegionCoordinate(aGridZ) );
+
+	VEScopedLock<VEMutex> lock( myRegionLock );
+
+	RegionMap::iterator iter = myRegions[aType].find( regionCoordinates );
+	if( iter != myRegions[aType].end() )
+	{
+		return iter->second;
+	}
+
+	std::wstring path = GetRegionPath( aType, regionCoordinates.first, regionCoordinates.second );
+	if( !aCreate && GetFileAttributesW(path.c_str()) == INVALID_FILE_ATTRIBUTES )
+	{
+		return NULL;
+	}
+
+	VE_MEMORY_TAG( MEM_World );
+
+	// A region written by an engine with a different region format or chunk size is started again
+	VERegionFile* region = new VERegionFile();
+	if( !region->Open(path, aChunkDimensions) && (!aCreate || !DeleteFileW(path.c_str()) || !region->Open(path, aChunkDimensions)) )
+	{
+		delete region;
+		return NULL;
+	}
+
+	myRegions[aType][regionCoordinates] = region;
+
+	return region;
+}
+
+
+// Writes an entry to its region
+bool VEWorldCache::WriteEntry( EntryType aType, VEChunk* aChunk, const std::vector<unsigned char>& anEntry )
+{
+	VERegionFile* region = GetRegion( aType, aChunk->GetGridX(), aChunk->GetGridZ(), aChunk->GetDimensions(), true );
+	if( region == NULL )
+	{
+		return false;
+	}
+
+	int localX = aChunk->GetGridX() - VERegionFile::GetRegionCoordinate( aChunk->GetGridX() ) * VE_REGION_SIZE;
+	int localZ = aChunk->GetGridZ() - VERegionFile::GetRegionCoordinate( aChunk->GetGridZ() ) * VE_REGION_SIZE;
+
+	if( !region->WriteChunk(localX, localZ, &anEntry[0], (unsigned int)anEntry.size()) )
+	{
+		return false;
+	}
+
+	VEScopedLock<VEMutex> lock( myRegionLock );
+
+	if( aType == ET_Spill )
+	{
+		mySpilledCount++;
+	}
+	else
+	{
+		mySavedCount++;
+		mySavedBytes += anEntry.size();
+	}
+
+	return true;
+}
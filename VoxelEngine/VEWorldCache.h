@@ -0,0 +1,191 @@
+#ifndef VE_WORLD_CACHE_H
+#define VE_WORLD_CACHE_H
+
+
+// --------------------- Includes --------------------
+
+#include "VETypes.h"
+#include "VEThreading.h"
+#include "VEChunkSnapshot.h"
+
+
+// ---------------- Forward Declarations -------------
+
+class VEChunk;
+class VERegionFile;
+
+
+// --------------------- Defines ---------------------
+
+// The version of the terrain generation & meshing the cache's entries were made with. Bump it whenever either changes,
+// so every entry made by an older engine is regenerated
+#define VE_WORLD_CACHE_VERSION		2
+
+// Identifies the start of each cache entry
+#define VE_WORLD_CACHE_MAGIC		0x48434556
+
+
+// --------------------- Classes ---------------------
+
+// Caches the voxels the terrain generator made for each chunk, and the finished mesh built from them, so starting the
+// same world again skips the noise and the meshing. Entries are stored in region files in the cache's directory, one
+// set for voxels & one for meshes, and are keyed by the engine's cache version, the generator's seed & parameters,
+// the chunk's grid coordinates and, for meshes, which neighbouring chunks the grid has. Entries made with a different
+// key are stale, they're regenerated and written over.
+//
+// A chunk's voxels are only cached while they're exactly as generated, and its mesh only while its neighbours' are too,
+// see VEChunk::IsMeshCacheable. Meshes are uploaded straight from the region's mapped view in to the chunk's buffers.
+//
+// The cache also holds the compressed voxels of chunks spilled by the chunk manager to keep within its voxel budget.
+// Spilled entries only last until the cache is closed, their region files are deleted then
+class VEWorldCache
+{
+	public :
+
+		// ------ Public Functions ------
+
+		// Construction
+		VEWorldCache();
+
+		// Deconstruction, closes the cache
+		~VEWorldCache();
+
+		// Opens the cache in the supplied directory, creating the directory if it doesn't exist
+		bool				Open( const std::wstring& aDirectory );
+
+		// Closes the region files
+		void				Close();
+
+		// Sets the seed & a hash of the parameters the terrain is being generated with, entries made with any others are
+		// stale
+		void				SetGenerator( int aSeed, unsigned int aGeneratorHash );
+
+		// Loads the chunk's generated voxels. Returns false if they aren't cached, or the entry is stale or corrupt, in
+		// which case the chunk's voxels may have been partly overwritten and it should be generated again
+		bool				LoadVoxels( VEChunk* aChunk );
+
+		// Caches the chunk's voxels, which must be as the terrain generator made them
+		bool				SaveVoxels( VEChunk* aChunk );
+
+		// Creates the chunk's vertex & index buffers straight from its cached mesh, and enables it without it being
+		// rebuilt. Returns false if the mesh isn't cached or the entry is stale
+		bool				LoadMesh( VEChunk* aChunk );
+
+		// Caches the mesh built for the chunk, with the neighbour mask of the snapshot it was built from. Can be called
+		// from any thread
+		bool				SaveMesh( VEChunk* aChunk, unsigned int aNeighbourMask, const VoxelVertices* someVertices, unsigned int aVertexCount,
+									  const unsigned long* someIndices, unsigned int anIndexCount );
+
+		// Writes a chunk's compressed voxels (the palette followed by the compressed palette indices) to the spill regions.
+		// Can be called from any thread
+		bool				SpillVoxels( VEChunk* aChunk, const unsigned char* someCompressedVoxels, unsigned int aCompressedSize, unsigned int aPaletteSize );
+
+		// Reads back a chunk's spilled voxels in to a buffer allocated with new[], which the caller owns. Returns NULL if
+		// the chunk hasn't been spilled. Can be called from any thread
+		unsigned char*		RestoreVoxels( VEChunk* aChunk, unsigned int& aCompressedSize, unsigned int& aPaletteSize );
+
+		// Returns which of a chunk's neighbours are in the chunk grid, a bit for each ChunkNeighbour
+		static unsigned int	GetNeighbourMask( VEChunk* someNeighbours[CN_Max] );
+
+
+		// --------- Accessors ----------
+
+		bool				GetIsOpen()							{ return myIsOpen; }
+
+		// The voxels & meshes loaded from the cache since it was opened, and the entries found to be stale
+		unsigned int		GetVoxelHitCount()					{ return myVoxelHitCount; }
+		unsigned int		GetMeshHitCount()					{ return myMeshHitCount; }
+		unsigned int		GetStaleCount()						{ return myStaleCount; }
+
+		// The entries written since the cache was opened, and the bytes they took
+		unsigned int		GetSavedCount()						{ return mySavedCount; }
+		unsigned long long	GetSavedBytes()						{ return mySavedBytes; }
+
+		// The chunks spilled & restored since the cache was opened
+		unsigned int		GetSpilledCount()					{ return mySpilledCount; }
+		unsigned int		GetRestoredCount()					{ return myRestoredCount; }
+
+		// The size of the cache's region files
+		unsigned long long	GetFileSize();
+
+
+	private :
+
+		// ----- Private Structures -----
+
+		// The kinds of entry, each kept in its own region files
+		enum EntryType
+		{
+			ET_Voxels = 0,
+			ET_Mesh,
+			ET_Spill,
+
+			ET_Max
+		};
+
+		// The start of each entry. Voxel & spill entries are followed by the palette (a type & enabled byte per entry)
+		// and the compressed palette indices, mesh entries by the vertices & then the indices
+		struct EntryHeader
+		{
+			unsigned int	myMagic;
+			unsigned int	myVersion;
+			unsigned int	myType;
+			int				mySeed;
+			unsigned int	myGeneratorHash;
+			int				myGridX;
+			int				myGridZ;
+			unsigned int	myNeighbourMask;
+			int				myMaxHeight;
+			unsigned int	myCount;
+			unsigned int	mySecondCount;
+		};
+
+		typedef std::map<std::pair<int, int>, VERegionFile*>	RegionMap;
+
+
+		// ----- Private Functions ------
+
+		// Fills in the key of the chunk's entry. The counts are left at zero
+		void				BuildHeader( VEChunk* aChunk, EntryType aType, unsigned int aNeighbourMask, EntryHeader& aHeader );
+
+		// Whether an entry's header has the supplied key
+		static bool			IsHeaderMatching( const EntryHeader& aHeader, const EntryHeader& aKey );
+
+		// Returns the path of the region file holding entries of the supplied type at the region coordinates
+		std::wstring		GetRegionPath( EntryType aType, int aRegionX, int aRegionZ );
+
+		// Returns the region file holding the chunk's entries of the supplied type, opening it if it isn't already.
+		// Regions are only created if asked to, otherwise NULL is returned for regions that don't exist
+		VERegionFile*		GetRegion( EntryType aType, int aGridX, int aGridZ, int aChunkDimensions, bool aCreate );
+
+		// Writes an entry to its region
+		bool				WriteEntry( EntryType aType, VEChunk* aChunk, const std::vector<unsigned char>& anEntry );
+
+		// The cache can't be copied
+		VEWorldCache( const VEWorldCache& );
+		VEWorldCache& operator=( const VEWorldCache& );
+
+
+		// ----- Private Variables ------
+
+		std::wstring				myDirectory;
+		bool						myIsOpen;
+
+		int							mySeed;
+		unsigned int				myGeneratorHash;
+
+		RegionMap					myRegions[ET_Max];
+		VEMutex						myRegionLock;
+
+		// Guarded by the region lock, as meshes are saved from the build threads
+		unsigned int				myVoxelHitCount;
+		unsigned int				myMeshHitCount;
+		unsigned int				myStaleCount;
+		unsigned int				mySavedCount;
+		unsigned long long			mySavedBytes;
+		unsigned int				mySpilledCount;
+		unsigned int				myRestoredCount;
+};
+
+
+#endif // !VE_WORLD_CACHE_H
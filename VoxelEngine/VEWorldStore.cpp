@@ -0,0 +1,559 @@
+// --------------------- Includes ---------------------
+
+#include "Stdafx.h"
+#include "VEWorldStore.h"
+
+#include "VEChunk.h"
+#include "VERegionFile.h"
+#include "VEMemoryTracker.h"
+#include "VEProfiler.h"
+
+
+// ------------------ Class Functions -----------------
+
+// Construction
+VEWorldStore::VEWorldStore() :
+	myIsOpen( false ),
+	myHasSeed( false ),
+	mySeed( 0 ),
+	myWritingRequest( NULL ),
+	myIsStopping( false ),
+	myLoadedChunkCount( 0 ),
+	mySavedChunkCount( 0 ),
+	mySavedBytes( 0 ),
+	myFailedSaveCount( 0 )
+{
+}
+
+
+// Deconstruction, closes the world
+VEWorldStore::~VEWorldStore()
+{
+	Close();
+}
+
+
+// Opens the world stored in the supplied directory
+bool VEWorldStore::Open( const std::wstring& aDirectory )
+{
+	VE_MEMORY_TAG( MEM_World );
+
+	Close();
+
+	myDirectory = aDirectory;
+	if( !CreateDirectoryW(myDirectory.c_str(), NULL) && GetLastError() != ERROR_ALREADY_EXISTS )
+	{
+		return false;
+	}
+
+	// Read the world's seed, new worlds don't have one until the terrain is generated
+	myHasSeed	= false;
+	mySeed		= 0;
+
+	HANDLE infoFile = CreateFileW( (myDirectory + VE_WORLD_INFO_FILE).c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+	if( infoFile != INVALID_HANDLE_VALUE )
+	{
+		WorldInfo	info;
+		DWORD		bytesRead = 0;
+		if( ReadFile(infoFile, &info, sizeof(info), &bytesRead, NULL) && bytesRead == sizeof(info) && info.myMagic == VE_WORLD_MAGIC &&
+			info.myVersion == VE_WORLD_VERSION )
+		{
+			myHasSeed	= true;
+			mySeed		= info.mySeed;
+		}
+
+		CloseHandle( infoFile );
+	}
+
+	// Read back the edits made since their chunks were last saved
+	if( !myJournal.Open(myDirectory + VE_WORLD_JOURNAL_FILE) )
+	{
+		return false;
+	}
+
+	// Start the save thread with a full set of free requests
+	for( unsigned int i = 0; i < VE_WORLD_SAVE_QUEUE_SIZE; i++ )
+	{
+		myFreeRequests.push_back( new SaveRequest() );
+	}
+
+	myIsStopping = false;
+	if( !mySaveThread.Start(SaveThread, this) )
+	{
+		for( unsigned int i = 0; i < myFreeRequests.size(); i++ )
+		{
+			delete myFreeRequests[i];
+		}
+		myFreeRequests.clear();
+
+		myJournal.Close();
+
+		return false;
+	}
+
+	myLoadedChunkCount	= 0;
+	mySavedChunkCount	= 0;
+	mySavedBytes		= 0;
+	myFailedSaveCount	= 0;
+
+	myIsOpen = true;
+
+	return true;
+}
+
+
+// Writes every queued chunk, stops the save thread & closes the region files
+void VEWorldStore::Close()
+{
+	if( !myIsOpen )
+	{
+		return;
+	}
+
+	{
+		VEScopedLock<VEMutex> lock( myQueueLock );
+
+		myIsStopping = true;
+		myQueueCondition.NotifyAll();
+	}
+
+	// The thread writes everything still queued before finishing, then the journal drops the edits they included
+	mySaveThread.Join();
+
+	myJournal.Close();
+
+	for( unsigned int i = 0; i < myFreeRequests.size(); i++ )
+	{
+		delete myFreeRequests[i];
+	}
+	myFreeRequests.clear();
+
+	for( RegionMap::iterator iter = myRegions.begin(); iter != myRegions.end(); iter++ )
+	{
+		iter->second->Close();
+		delete iter->second;
+	}
+	myRegions.clear();
+
+	myIsOpen = false;
+}
+
+
+// Loads the chunk at the chunk's grid coordinates in to its voxels
+bool VEWorldStore::LoadChunk( VEChunk* aChunk )
+{
+	assert( aChunk != NULL );
+
+	if( !myIsOpen )
+	{
+		return false;
+	}
+
+	VE_PROFILE_ZONE( "VEWorldStore::LoadChunk" );
+
+	int gridX = aChunk->GetGridX();
+	int gridZ = aChunk->GetGridZ();
+
+	// The region doesn't have the chunk's latest voxels until its save has been written
+	if( IsSavePending(gridX, gridZ) )
+	{
+		Flush();
+	}
+
+	VERegionFile* region = GetRegion( gridX, gridZ, aChunk->GetDimensions(), false );
+	if( region == NULL )
+	{
+		return false;
+	}
+
+	int localX = gridX - VERegionFile::GetRegionCoordinate( gridX ) * VE_REGION_SIZE;
+	int localZ = gridZ - VERegionFile::GetRegionCoordinate( gridZ ) * VE_REGION_SIZE;
+
+	unsigned int			recordSize	= 0;
+	const unsigned char*	record		= region->LockChunk( localX, localZ, recordSize );
+	if( record == NULL )
+	{
+		return false;
+	}
+
+	unsigned int	voxelCount	= (unsigned int)( aChunk->GetDimensions() * aChunk->GetDimensions() * aChunk->GetDimensions() );
+	bool			succeeded	= false;
+
+	ChunkRecord header;
+	if( recordSize >= sizeof(header) )
+	{
+		memcpy( &header, record, sizeof(header) );
+
+		unsigned int headerSize = sizeof(header) + header.myPaletteSize * 2;
+		if( header.myVoxelCount == voxelCount && header.myPaletteSize > 0 && header.myPaletteSize <= VE_VOXEL_PALETTE_SIZE && headerSize <= recordSize )
+		{
+			// Decode straight from the mapped view in to the chunk
+			VEVoxel palette[VE_VOXEL_PALETTE_SIZE];
+			if( VEVoxelCodec::ReadPalette(record + sizeof(header), header.myPaletteSize, palette) )
+			{
+				VEScopedLock<VESharedMutex> voxelLock( aChunk->GetVoxelLock() );
+
+				succeeded = VEVoxelCodec::DecompressVoxels( record + headerSize, recordSize - headerSize, palette, header.myPaletteSize,
+															aChunk->GetVoxels(), voxelCount );
+			}
+		}
+	}
+
+	region->UnlockChunk();
+
+	if( !succeeded )
+	{
+		return false;
+	}
+
+	aChunk->SetMaxHeight( header.myMaxHeight );
+	aChunk->SetIsDirty( true );
+	aChunk->SetNeighboursDirty( true );
+	aChunk->SetIsModified( false );
+
+	myLoadedChunkCount++;
+
+	return true;
+}
+
+
+// Captures the chunk's voxels & queues them to be written
+bool VEWorldStore::SaveChunk( VEChunk* aChunk )
+{
+	assert( aChunk != NULL );
+
+	if( !myIsOpen )
+	{
+		return false;
+	}
+
+	VE_PROFILE_ZONE( "VEWorldStore::SaveChunk" );
+
+	// Wait for a free request
+	SaveRequest* request = NULL;
+	{
+		VEScopedLock<VEMutex> lock( myQueueLock );
+
+		while( myFreeRequests.empty() )
+		{
+			myFreeCondition.Wait( myQueueLock );
+		}
+
+		request = myFreeRequests.back();
+		myFreeRequests.pop_back();
+	}
+
+	// Capture the chunk's palette indices. The indices are an eighth of the voxels' size, and are all the save thread
+	// needs from the chunk
+	unsigned int voxelCount = (unsigned int)( aChunk->GetDimensions() * aChunk->GetDimensions() * aChunk->GetDimensions() );
+	{
+		VE_MEMORY_TAG( MEM_World );
+
+		request->myIndices.resize( voxelCount );
+	}
+
+	// Edits hold the voxel lock exclusively, so the chunk can't change between being captured & marked as saved
+	{
+		VEScopedSharedLock voxelLock( aChunk->GetVoxelLock() );
+
+		request->myPaletteSize		= VEVoxelCodec::BuildPalette( aChunk->GetVoxels(), voxelCount, request->myPalette, &request->myIndices[0] );
+		request->myJournalSequence	= myJournal.GetSequence();
+		if( request->myPaletteSize > 0 )
+		{
+			aChunk->SetIsModified( false );
+		}
+	}
+
+	request->myGridX			= aChunk->GetGridX();
+	request->myGridZ			= aChunk->GetGridZ();
+	request->myChunkDimensions	= aChunk->GetDimensions();
+	request->myMaxHeight		= aChunk->GetMaxHeight();
+
+	VEScopedLock<VEMutex> lock( myQueueLock );
+
+	if( request->myPaletteSize == 0 )
+	{
+		myFreeRequests.push_back( request );
+		myFailedSaveCount++;
+
+		return false;
+	}
+
+	myQueue.push_back( request );
+	myQueueCondition.NotifyOne();
+
+	return true;
+}
+
+
+// Blocks until every queued chunk has been written
+void VEWorldStore::Flush()
+{
+	if( !myIsOpen )
+	{
+		return;
+	}
+
+	VE_PROFILE_ZONE( "VEWorldStore::Flush" );
+
+	VEScopedLock<VEMutex> lock( myQueueLock );
+
+	while( !myQueue.empty() || myWritingRequest != NULL )
+	{
+		myFreeCondition.Wait( myQueueLock );
+	}
+}
+
+
+// Journals an edit to one of the chunk's voxels
+void VEWorldStore::RecordEdit( VEChunk* aChunk, unsigned int anIndex, VEVoxel& anOldVoxel, VEVoxel& aNewVoxel )
+{
+	assert( aChunk != NULL );
+
+	if( myIsOpen )
+	{
+		myJournal.RecordEdit( aChunk->GetGridX(), aChunk->GetGridZ(), anIndex, anOldVoxel, aNewVoxel );
+	}
+}
+
+
+// Applies the chunk's journaled edits, once it's been loaded or generated
+unsigned int VEWorldStore::ReplayEdits( VEChunk* aChunk )
+{
+	if( !myIsOpen )
+	{
+		return 0;
+	}
+
+	return myJournal.ReplayEdits( aChunk );
+}
+
+
+// Records the seed the world's terrain is generated from
+bool VEWorldStore::SetSeed( int aSeed )
+{
+	if( !myIsOpen )
+	{
+		return false;
+	}
+
+	HANDLE infoFile = CreateFileW( (myDirectory + VE_WORLD_INFO_FILE).c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL );
+	if( infoFile == INVALID_HANDLE_VALUE )
+	{
+		return false;
+	}
+
+	WorldInfo info;
+	info.myMagic	= VE_WORLD_MAGIC;
+	info.myVersion	= VE_WORLD_VERSION;
+	info.mySeed		= aSeed;
+
+	DWORD	bytesWritten	= 0;
+	bool	succeeded		= WriteFile( infoFile, &info, sizeof(info), &bytesWritten, NULL ) && bytesWritten == sizeof(info);
+
+	CloseHandle( infoFile );
+
+	if( succeeded )
+	{
+		myHasSeed	= true;
+		mySeed		= aSeed;
+	}
+
+	return succeeded;
+}
+
+
+// The number of region files open
+unsigned int VEWorldStore::GetRegionCount()
+{
+	VEScopedLock<VEMutex> lock( myRegionLock );
+
+	return (unsigned int)myRegions.size();
+}
+
+
+// The bytes of the region files mapped in to memory
+unsigned long long VEWorldStore::GetMappedSize()
+{
+	VEScopedLock<VEMutex> lock( myRegionLock );
+
+	unsigned long long mappedSize = 0;
+	for( RegionMap::iterator iter = myRegions.begin(); iter != myRegions.end(); iter++ )
+	{
+		mappedSize += iter->second->GetMappedSize();
+	}
+
+	return mappedSize;
+}
+
+
+// Returns the region file holding the chunk at the supplied grid coordinates, opening it if it isn't already
+VERegionFile* VEWorldStore::GetRegion( int aGridX, int aGridZ, int aChunkDimensions, bool aCreate )
+{
+	std::pair<int, int> regionCoordinates( VERegionFile::GetRegionCoordinate(aGridX), VERegionFile::GetRegionCoordinate(aGridZ) );
+
+	VEScopedLock<VEMutex> lock( myRegionLock );
+
+	RegionMap::iterator iter = myRegions.find( regionCoordinates );
+	if( iter != myRegions.end() )
+	{
+		return iter->second;
+	}
+
+	// Region files are named after their coordinates
+	wchar_t filename[64];
+	swprintf_s( filename, L"r.%d.%d.vreg", regionCoordinates.first, regionCoordinates.second );
+
+	std::wstring path = myDirectory + filename;
+	if( !aCreate && GetFileAttributesW(path.c_str()) == INVALID_FILE_ATTRIBUTES )
+	{
+		return NULL;
+	}
+
+	VE_MEMORY_TAG( MEM_World );
+
+	VERegionFile* region = new VERegionFile();
+	if( !region->Open(path, aChunkDimensions) )
+	{
+		delete region;
+		return NULL;
+	}
+
+	myRegions[regionCoordinates] = region;
+
+	return region;
+}
+
+
+// Whether the chunk at the supplied grid coordinates is queued or being written
+bool VEWorldStore::IsSavePending( int aGridX, int aGridZ )
+{
+	VEScopedLock<VEMutex> lock( myQueueLock );
+
+	if( myWritingRequest != NULL && myWritingRequest->myGridX == aGridX && myWritingRequest->myGridZ == aGridZ )
+	{
+		return true;
+	}
+
+	for( std::deque<SaveRequest*>::iterator iter = myQueue.begin(); iter != myQueue.end(); iter++ )
+	{
+		if( (*iter)->myGridX == aGridX && (*iter)->myGridZ == aGridZ )
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+// Compresses a request's palette indices and writes the record to its region
+unsigned int VEWorldStore::WriteRecord( const SaveRequest& aRequest, std::vector<unsigned char>& aRecord )
+{
+	VE_PROFILE_ZONE( "VEWorldStore::WriteRecord" );
+
+	unsigned int voxelCount		= (unsigned int)aRequest.myIndices.size();
+	unsigned int headerSize		= sizeof(ChunkRecord) + aRequest.myPaletteSize * 2;
+	unsigned int maxRecordSize	= headerSize + VEVoxelCodec::GetMaxCompressedSize( voxelCount );
+	if( aRecord.size() < maxRecordSize )
+	{
+		VE_MEMORY_TAG( MEM_World );
+
+		aRecord.resize( maxRecordSize );
+	}
+
+	ChunkRecord header;
+	header.myVoxelCount		= voxelCount;
+	header.myMaxHeight		= aRequest.myMaxHeight;
+	header.myPaletteSize	= aRequest.myPaletteSize;
+	memcpy( &aRecord[0], &header, sizeof(header) );
+
+	VEVoxelCodec::WritePalette( aRequest.myPalette, aRequest.myPaletteSize, &aRecord[sizeof(header)] );
+
+	unsigned int compressedSize = VEVoxelCodec::Compress( &aRequest.myIndices[0], voxelCount, &aRecord[headerSize], maxRecordSize - headerSize );
+	if( compressedSize == 0 )
+	{
+		return 0;
+	}
+
+	VERegionFile* region = GetRegion( aRequest.myGridX, aRequest.myGridZ, aRequest.myChunkDimensions, true );
+	if( region == NULL )
+	{
+		return 0;
+	}
+
+	int localX = aRequest.myGridX - VERegionFile::GetRegionCoordinate( aRequest.myGridX ) * VE_REGION_SIZE;
+	int localZ = aRequest.myGridZ - VERegionFile::GetRegionCoordinate( aRequest.myGridZ ) * VE_REGION_SIZE;
+
+	if( !region->WriteChunk(localX, localZ, &aRecord[0], headerSize + compressedSize) )
+	{
+		return 0;
+	}
+
+	return headerSize + compressedSize;
+}
+
+
+// The save thread, writes queued chunks until the store is closed
+unsigned int VEWorldStore::SaveThread( void* aWorldStore )
+{
+	VEWorldStore* worldStore = reinterpret_cast<VEWorldStore*>( aWorldStore );
+	assert( worldStore != NULL );
+
+	// Records are built in a buffer kept for the life of the thread
+	std::vector<unsigned char> record;
+
+	for( ;; )
+	{
+		SaveRequest* request = NULL;
+		{
+			VEScopedLock<VEMutex> lock( worldStore->myQueueLock );
+
+			while( worldStore->myQueue.empty() && !worldStore->myIsStopping )
+			{
+				worldStore->myQueueCondition.Wait( worldStore->myQueueLock );
+			}
+
+			// Only finish once the queue has been written
+			if( worldStore->myQueue.empty() )
+			{
+				break;
+			}
+
+			request = worldStore->myQueue.front();
+			worldStore->myQueue.pop_front();
+
+			worldStore->myWritingRequest = request;
+		}
+
+		unsigned int recordSize = worldStore->WriteRecord( *request, record );
+
+		// The chunk's record holds its edits now, so the journal doesn't need to
+		if( recordSize > 0 )
+		{
+			worldStore->myJournal.MarkSaved( request->myGridX, request->myGridZ, request->myJournalSequence );
+		}
+
+		{
+			VEScopedLock<VEMutex> lock( worldStore->myQueueLock );
+
+			if( recordSize > 0 )
+			{
+				worldStore->mySavedChunkCount++;
+				worldStore->mySavedBytes += recordSize;
+			}
+			else
+			{
+				worldStore->myFailedSaveCount++;
+			}
+
+			worldStore->myWritingRequest = NULL;
+			worldStore->myFreeRequests.push_back( request );
+			worldStore->myFreeCondition.NotifyAll();
+		}
+	}
+
+	VE_PROFILE_THREAD_END();
+
+	return 0;
+}
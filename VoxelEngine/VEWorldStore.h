@@ -0,0 +1,205 @@
+#ifndef VE_WORLD_STORE_H
+#define VE_WORLD_STORE_H
+
+
+// --------------------- Includes --------------------
+
+#include "VETypes.h"
+#include "VEThreading.h"
+#include "VEVoxelCodec.h"
+#include "VEVoxel.h"
+#include "VEEditJournal.h"
+
+#include <deque>
+
+
+// ---------------- Forward Declarations -------------
+
+class VEChunk;
+class VERegionFile;
+
+
+// --------------------- Defines ---------------------
+
+// The number of chunks that can wait to be written at once. Saving another chunk blocks until one has been written, so
+// the queue's memory is bounded however fast chunks are saved
+#define VE_WORLD_SAVE_QUEUE_SIZE	8
+
+// The file in the world's directory that records the world's seed
+#define VE_WORLD_INFO_FILE			L"World.info"
+
+// The file in the world's directory that journals voxel edits made since their chunks were last saved
+#define VE_WORLD_JOURNAL_FILE		L"Edits.journal"
+
+// Identifies world info files, and the version of the format they're written in
+#define VE_WORLD_MAGIC				0x444C5256
+#define VE_WORLD_VERSION			1
+
+
+// --------------------- Classes ---------------------
+
+// Stores a world's chunks on disk, in region files of VE_REGION_SIZE x VE_REGION_SIZE chunks kept in the world's
+// directory. Each chunk's record is its palette followed by its compressed palette indices, see VEVoxelCodec.
+//
+// Loading decodes a chunk straight from the region's mapped view in to the chunk's voxels. Saving captures the chunk's
+// palette indices on the calling thread, then queues them for the store's save thread, which compresses & writes them.
+// The chunk can be edited or destroyed as soon as SaveChunk returns.
+//
+// Single voxel edits go to the world's edit journal instead, see VEEditJournal. Loading a chunk replays its journaled
+// edits on top of its record, and writing a chunk's record drops the edits it includes from the journal
+class VEWorldStore
+{
+	public :
+
+		// ------ Public Functions ------
+
+		// Construction
+		VEWorldStore();
+
+		// Deconstruction, closes the world
+		~VEWorldStore();
+
+		// Opens the world stored in the supplied directory, creating the directory if it doesn't exist, and starts the
+		// save thread
+		bool				Open( const std::wstring& aDirectory );
+
+		// Writes every queued chunk, stops the save thread & closes the region files
+		void				Close();
+
+		// Loads the chunk at the chunk's grid coordinates in to its voxels. Returns false if the chunk isn't stored, or
+		// its record is corrupt, in which case the chunk's voxels may have been partly overwritten and it should be
+		// generated again
+		bool				LoadChunk( VEChunk* aChunk );
+
+		// Captures the chunk's voxels & queues them to be written. Blocks while the queue is full. Returns false if the
+		// chunk can't be stored
+		bool				SaveChunk( VEChunk* aChunk );
+
+		// Blocks until every queued chunk has been written
+		void				Flush();
+
+		// Journals an edit to one of the chunk's voxels. Called by the chunk with its voxel lock held
+		void				RecordEdit( VEChunk* aChunk, unsigned int anIndex, VEVoxel& anOldVoxel, VEVoxel& aNewVoxel );
+
+		// Applies the chunk's journaled edits, once it's been loaded or generated. Returns the number of edits applied
+		unsigned int		ReplayEdits( VEChunk* aChunk );
+
+		// Records the seed the world's terrain is generated from
+		bool				SetSeed( int aSeed );
+
+
+		// --------- Accessors ----------
+
+		bool				GetIsOpen()							{ return myIsOpen; }
+
+		// Whether the world has a recorded seed, and what it is
+		bool				GetHasSeed()						{ return myHasSeed; }
+		int					GetSeed()							{ return mySeed; }
+
+		// The number of chunks loaded & saved since the world was opened, the bytes their records took on disk, and the
+		// number of saves that failed
+		unsigned int		GetLoadedChunkCount()				{ return myLoadedChunkCount; }
+		unsigned int		GetSavedChunkCount()				{ return mySavedChunkCount; }
+		unsigned long long	GetSavedBytes()						{ return mySavedBytes; }
+		unsigned int		GetFailedSaveCount()				{ return myFailedSaveCount; }
+
+		// The number of region files open, and the bytes of them mapped in to memory
+		unsigned int		GetRegionCount();
+		unsigned long long	GetMappedSize();
+
+		VEEditJournal&		GetEditJournal()					{ return myJournal; }
+
+
+	private :
+
+		// ----- Private Structures -----
+
+		// A chunk's voxels waiting to be written
+		struct SaveRequest
+		{
+			int							myGridX;
+			int							myGridZ;
+			int							myChunkDimensions;
+			int							myMaxHeight;
+
+			// The journal's last edit when the chunk was captured, the chunk's edits up to it are in the record
+			unsigned int				myJournalSequence;
+
+			VEVoxel						myPalette[VE_VOXEL_PALETTE_SIZE];
+			unsigned int				myPaletteSize;
+			std::vector<unsigned char>	myIndices;
+		};
+
+		// The start of a chunk's record, followed by the palette (a type & enabled byte per entry) and the compressed
+		// palette indices
+		struct ChunkRecord
+		{
+			unsigned int	myVoxelCount;
+			int				myMaxHeight;
+			unsigned int	myPaletteSize;
+		};
+
+		// The contents of the world info file
+		struct WorldInfo
+		{
+			unsigned int	myMagic;
+			unsigned int	myVersion;
+			int				mySeed;
+		};
+
+		typedef std::map<std::pair<int, int>, VERegionFile*>	RegionMap;
+
+
+		// ----- Private Functions ------
+
+		// Returns the region file holding the chunk at the supplied grid coordinates, opening it if it isn't already.
+		// Regions are only created if asked to, otherwise NULL is returned for regions that don't exist
+		VERegionFile*		GetRegion( int aGridX, int aGridZ, int aChunkDimensions, bool aCreate );
+
+		// Whether the chunk at the supplied grid coordinates is queued or being written
+		bool				IsSavePending( int aGridX, int aGridZ );
+
+		// Compresses a request's palette indices and writes the record to its region. Returns the record's size, or zero
+		// if it couldn't be written
+		unsigned int		WriteRecord( const SaveRequest& aRequest, std::vector<unsigned char>& aRecord );
+
+		// The save thread, writes queued chunks until the store is closed
+		static unsigned int	SaveThread( void* aWorldStore );
+
+		// The store can't be copied
+		VEWorldStore( const VEWorldStore& );
+		VEWorldStore& operator=( const VEWorldStore& );
+
+
+		// ----- Private Variables ------
+
+		std::wstring				myDirectory;
+		bool						myIsOpen;
+
+		VEEditJournal				myJournal;
+
+		bool						myHasSeed;
+		int							mySeed;
+
+		RegionMap					myRegions;
+		VEMutex						myRegionLock;
+
+		// Requests waiting for the save thread & free for SaveChunk, the request being written and whether the thread
+		// should finish. Guarded by the queue lock
+		VEThread					mySaveThread;
+		VEMutex						myQueueLock;
+		VEConditionVariable			myQueueCondition;
+		VEConditionVariable			myFreeCondition;
+		std::deque<SaveRequest*>	myQueue;
+		std::vector<SaveRequest*>	myFreeRequests;
+		SaveRequest*				myWritingRequest;
+		bool						myIsStopping;
+
+		unsigned int				myLoadedChunkCount;
+		unsigned int				mySavedChunkCount;
+		unsigned long long			mySavedBytes;
+		unsigned int				myFailedSaveCount;
+};
+
+
+#endif // !VE_WORLD_STORE_H
@@ -8,6 +8,9 @@
 #include "VEDirectXInput.h"
 #include "VEVoxelRenderManager.h"
 #include "VEDeferredRenderManager.h"
+#include "VENullRenderManager.h"
+#include "VENullRenderBackend.h"
+#include "VERenderPipeline.h"
 #include "VEBasicCamera.h"
 #include "VELightingManager.h"
 #include "VEChunkManager.h"
@@ -15,9 +18,19 @@
 #include "VEShaderManager.h"
 #include "VETextureManager.h"
 #include "VETerrainGenerator.h"
+#include "VEWorldStore.h"
+#include "VEWorldCache.h"
 
 #include "VEPhysicsService.h"
 #include "VEObjectService.h"
+#include "VEComponentService.h"
+#include "VEInputService.h"
+#include "VEMemoryTracker.h"
+#include "VEEventBus.h"
+#include "VEFrameAllocator.h"
+#include "VEJobSystem.h"
+#include "VETaskGraph.h"
+#include "VEProfiler.h"
 
 
 // ----------------- Namespaces -----------------
@@ -32,6 +45,19 @@ VoxelEngine* VoxelEngine::myVoxelEngine = NULL;
 
 // ------------------ Functions -----------------
 
+// Converts a performance counter duration to milliseconds
+static double ToMilliseconds( long long aDuration )
+{
+	LARGE_INTEGER frequency;
+	if( !QueryPerformanceFrequency(&frequency) )
+	{
+		return 0.0;
+	}
+
+	return ( (double)aDuration * 1000.0 ) / (double)frequency.QuadPart;
+}
+
+
 // Returns (creates if necessary) the static instance of the engine
 VoxelEngine* VoxelEngine::GetInstance()
 {
@@ -60,52 +86,180 @@ bool VoxelEngine::Initialise( HINSTANCE anInstance, HWND aWindowHandle, int aScr
 {
 	myDataDirectory = aDataDirectory;
 
-	myRenderInterface = new VEDirectXInterface();
-	if( !myRenderInterface->Initialise( aWindowHandle, aScreenWidth, aScreenHeight, isFullScreen, anEnableVsync) )
+	VEProfiler::Initialise();
+	myStartupStartTime = VEProfiler::GetTime();
+
+	// Created first, so every other system can post events or register handlers while initialising
+	myEventBus = new VEEventBus();
+
+	myInstance			= anInstance;
+	myWindowHandle		= aWindowHandle;
+	myScreenWidth		= aScreenWidth;
+	myScreenHeight		= aScreenHeight;
+	myIsFullScreen		= isFullScreen;
+	myEnableVsync		= anEnableVsync;
+
+	// Created up front so the startup tasks can initialise them on whichever thread they run on
+	myRenderInterface	= new VEDirectXInterface();
+	myInputInterface	= new VEDirectXInput();
+	myShaderManager		= new VEShaderManager();	
+	myTextureManager    = new VETextureManager();
+
+	if( !CreateRenderer(RT_Deferred) )
 	{
 		return false;
 	}
 
-	myInputInterface = new VEDirectXInput();
-	if( !myInputInterface->Initialise(anInstance, aWindowHandle, aScreenWidth, aScreenHeight) )
+	if( !RunStartup() )
 	{
 		return false;
 	}
-	
-	myTerrainGenerator	= new VETerrainGenerator();
-	if( !myTerrainGenerator->Initialise() )
+
+	// The input service polls the devices at the start of each update
+	myInputService->SetSource( VEDirectXInput::Poll, myInputInterface );
+
+	return true;
+}
+
+
+// Initialises the engine without a window, input or GPU. Rendering goes through a null backend that only
+// records buffer sizes & draw calls, so terrain, meshing, objects & physics can be run & measured anywhere
+bool VoxelEngine::InitialiseHeadless( std::wstring aDataDirectory )
+{
+	myDataDirectory = aDataDirectory;
+
+	VEProfiler::Initialise();
+	myStartupStartTime = VEProfiler::GetTime();
+
+	myEventBus		= new VEEventBus();
+	myRenderBackend	= new VENullRenderBackend();
+
+	myScreenWidth	= 0;
+	myScreenHeight	= 0;
+
+	if( !CreateRenderer(RT_Null) )
 	{
 		return false;
 	}
 
-	myThreadManager = new VEThreadManager();
-	if( !myThreadManager->Initialise() )
+	return RunStartup();
+}
+
+
+// Adds a task to the startup graph, run by Initialise once the engine's startup tasks it reads from have finished
+void VoxelEngine::AddStartupTask( const char* aName, VETaskFunction aFunction, void* aParameter, unsigned int someReads, unsigned int someWrites, bool isMainThreadOnly /* false */ )
+{
+	assert( myStartupGraph == NULL );
+
+	StartupTask startupTask;
+	startupTask.myName				= aName;
+	startupTask.myFunction			= aFunction;
+	startupTask.myParameter			= aParameter;
+	startupTask.myReads				= someReads;
+	startupTask.myWrites			= someWrites;
+	startupTask.myIsMainThreadOnly	= isMainThreadOnly;
+
+	myStartupTasks.push_back( startupTask );
+}
+
+
+// Writes each startup task's start & duration, the time Initialise took and the time to the first frame to a text file
+bool VoxelEngine::WriteStartupReport( const std::wstring& aFilename )
+{
+	if( myStartupGraph == NULL )
 	{
 		return false;
 	}
 
-	myLightingManager	= new VELightingManager();
-	myChunkManager		= new VEChunkManager();
-	myShaderManager		= new VEShaderManager();	
-	myTextureManager    = new VETextureManager();
-	
-	myObjectService		= new VEObjectService();
-	myPhysicsService	= new VEPhysicsService();
-
-	if( !CreateRenderer(RT_Deferred, aScreenWidth, aScreenHeight) )
+	std::ofstream file( aFilename.c_str() );
+	if( !file.is_open() )
 	{
 		return false;
 	}
 
+	file.setf( std::ios::fixed );
+	file.precision( 3 );
+
+	file << "Task\tStart (ms)\tTime (ms)\n";
+	for( unsigned int i = 0; i < myStartupGraph->GetTaskCount(); i++ )
+	{
+		file << myStartupGraph->GetTaskName( i ) << "\t" << myStartupGraph->GetTaskStartTime( i ) << "\t" << myStartupGraph->GetTaskTime( i ) << "\n";
+	}
+
+	file << "\nStartup graph (ms)\t" << myStartupGraph->GetExecuteTime() << "\n";
+	file << "Initialise (ms)\t" << myStartupTime << "\n";
+	file << "Time to first frame (ms)\t" << myTimeToFirstFrame << "\n";
+
 	return true;
 }
 
 
+// Runs a number of engine updates back to back, with a fixed time step
+void VoxelEngine::RunFrames( unsigned int aFrameCount, float anElapsedTime )
+{
+	for( unsigned int i = 0; i < aFrameCount; i++ )
+	{
+		Update( anElapsedTime );
+	}
+}
+
+
 // Releases the static instance of the engine
 void VoxelEngine::Uninitialise()
 {
+	// Draws any frames still queued for the render thread, before anything they reference is released
+	if( myRenderPipeline != NULL )
+	{
+		myRenderPipeline->Uninitialise();
+
+		delete myRenderPipeline;
+		myRenderPipeline = NULL;
+	}
+
+	// Nothing runs on the workers between frames
+	if( myJobSystem != NULL )
+	{
+		myJobSystem->Uninitialise();
+
+		delete myJobSystem;
+		myJobSystem = NULL;
+	}
+
+	// Chunks still building create their buffers through the render backend, so their threads are joined before
+	// anything the renderer owns is released. The events they posted are thrown away, nothing will drain them now
+	if( myThreadManager != NULL )
+	{
+		myThreadManager->Uninitialise();
+
+		delete myThreadManager;
+		myThreadManager = NULL;
+	}
+
+	if( myEventBus != NULL )
+	{
+		myEventBus->Clear();
+	}
+
+	if( myFrameGraph != NULL )
+	{
+		delete myFrameGraph;
+		myFrameGraph = NULL;
+	}
+
+	if( myStartupGraph != NULL )
+	{
+		delete myStartupGraph;
+		myStartupGraph = NULL;
+	}
+	myStartupTasks.clear();
+
 	if( myInputInterface != NULL )
 	{
+		if( myInputService != NULL )
+		{
+			myInputService->SetSource( NULL, NULL );
+		}
+
 		myInputInterface->Uninitialise();
 
 		delete myInputInterface;
@@ -120,6 +274,13 @@ void VoxelEngine::Uninitialise()
 		myRenderer = NULL;
 	}
 	
+	// A headless engine owns a separate null backend, otherwise the backend is the render interface
+	if( myRenderBackend != myRenderInterface )
+	{
+		delete myRenderBackend;
+	}
+	myRenderBackend = NULL;
+
 	if( myRenderInterface != NULL )
 	{
 		myRenderInterface->Uninitialise();
@@ -128,14 +289,6 @@ void VoxelEngine::Uninitialise()
 		myRenderInterface = NULL;
 	}
 
-	if( myThreadManager != NULL )
-	{
-		myThreadManager->Uninitialise();
-
-		delete myThreadManager;
-		myThreadManager = NULL;
-	}
-
 	if( myLightingManager != NULL )
 	{
 		myLightingManager->Uninitialise();
@@ -144,6 +297,7 @@ void VoxelEngine::Uninitialise()
 		myLightingManager = NULL;
 	}
 
+	// The compression thread spills chunks to the world cache, so it's stopped before the cache is closed
 	if( myChunkManager != NULL )
 	{
 		myChunkManager->Uninitialise();
@@ -152,6 +306,23 @@ void VoxelEngine::Uninitialise()
 		myChunkManager = NULL;
 	}
 
+	// Writes any chunks still waiting in the save queue
+	if( myWorldStore != NULL )
+	{
+		myWorldStore->Close();
+
+		delete myWorldStore;
+		myWorldStore = NULL;
+	}
+
+	if( myWorldCache != NULL )
+	{
+		myWorldCache->Close();
+
+		delete myWorldCache;
+		myWorldCache = NULL;
+	}
+
 	if( myShaderManager != NULL )
 	{
 		myShaderManager->Uninitialise();
@@ -174,6 +345,13 @@ void VoxelEngine::Uninitialise()
 		myObjectService = NULL;
 	}
 
+	// Deleted after the object service, as objects hand their components back to the systems
+	if( myComponentService != NULL )
+	{
+		delete myComponentService;
+		myComponentService = NULL;
+	}
+
 	if( myTerrainGenerator != NULL )
 	{
 		myTerrainGenerator->Uninitialise();
@@ -187,24 +365,80 @@ void VoxelEngine::Uninitialise()
 		delete myPhysicsService;
 		myPhysicsService = NULL;
 	}
+
+	if( myInputService != NULL )
+	{
+		delete myInputService;
+		myInputService = NULL;
+	}
+
+	if( myFrameAllocator != NULL )
+	{
+		delete myFrameAllocator;
+		myFrameAllocator = NULL;
+	}
+
+	// Deleted last, any events still in the queue are discarded
+	if( myEventBus != NULL )
+	{
+		delete myEventBus;
+		myEventBus = NULL;
+	}
+
+	VEProfiler::Uninitialise();
 }
 
 
-// Updates and renders the current scene
-void VoxelEngine::Update( float anElapsedTime )
+// Updates the current scene, and renders it unless told not to
+void VoxelEngine::Update( float anElapsedTime, bool aRender /* true */ )
 {
-	myInputInterface->Update();
-	
-	myThreadManager->Update( anElapsedTime );
-	myChunkManager->Update( anElapsedTime );
-	
-	myObjectService->Update( anElapsedTime );
-	if( myPhysicsService->GetEnabled() )
 	{
-		myPhysicsService->Update( anElapsedTime );
+		VE_PROFILE_ZONE( "VoxelEngine::Update" );
+
+		VEAllocationScope frameAllocations;
+
+		// Recycle the frame memory used two frames ago
+		myFrameAllocator->BeginFrame();
+
+		// The chunks to draw are gathered in frame memory by one task, and drawn by the render task
+		VEChunkRenderList renderChunks( VEFrameStlAllocator<VEChunk*>(myFrameAllocator) );
+		myRenderChunks		= &renderChunks;
+		myFrameElapsedTime	= anElapsedTime;
+		myRenderFrame		= aRender;
+
+		// Chunks are judged visible from where the camera finished the last frame, as the object updates move it
+		// alongside the chunk update
+		if( myCamera != NULL )
+		{
+			myChunkManager->SetViewPosition( myCamera->GetPosition() );
+		}
+
+		unsigned int mainThreadAllocations = frameAllocations.GetAllocationCount();
+
+		if( myUseTaskGraph )
+		{
+			myFrameGraph->Execute( myJobSystem );
+		}
+		else
+		{
+			myFrameGraph->ExecuteSerial();
+		}
+
+		myRenderChunks = NULL;
+
+		// Each task counts its own allocations, whichever thread it ran on
+		myObjectUpdateAllocations	= myFrameGraph->GetTaskAllocationCount( myObjectUpdateTask ) + myFrameGraph->GetTaskAllocationCount( myComponentUpdateTask );
+		myFrameAllocations			= mainThreadAllocations + myFrameGraph->GetAllocationCount();
+		assert( !myCheckFrameAllocations || myFrameAllocations == 0 );
+
+		if( myRenderFrame && myTimeToFirstFrame == 0.0 )
+		{
+			myTimeToFirstFrame = ToMilliseconds( VEProfiler::GetTime() - myStartupStartTime );
+		}
 	}
-	
-	myRenderer->RenderScene();
+
+	// Collect the frame's profiling zones once the frame zone has closed
+	VEProfiler::EndFrame();
 }
 
 
@@ -233,6 +467,7 @@ void VoxelEngine::SetDrawMode( DrawMode aDrawMode )
 // Private construction - voxel engine should be accessed using the 'GetInstance' function
 VoxelEngine::VoxelEngine() :
 	myRenderer( NULL ),
+	myRenderPipeline( NULL ),
 	myCamera( NULL ),
 	myLightingManager( NULL ),
 	myChunkManager( NULL ),
@@ -240,17 +475,86 @@ VoxelEngine::VoxelEngine() :
 	myShaderManager( NULL ),
 	myTextureManager( NULL ),
 	myObjectService( NULL ),
+	myComponentService( NULL ),
 	myPhysicsService( NULL ),
+	myInputService( NULL ),
 	myRenderInterface( NULL ),
 	myDataDirectory( L"" ),
 	myInputInterface( NULL ),
-	myTerrainGenerator( NULL )
+	myTerrainGenerator( NULL ),
+	myWorldStore( NULL ),
+	myWorldCache( NULL ),
+	myObjectUpdateAllocations( 0 ),
+	myFrameAllocations( 0 ),
+	myCheckFrameAllocations( false ),
+	myEventBus( NULL ),
+	myFrameAllocator( NULL ),
+	myRenderBackend( NULL ),
+	myJobSystem( NULL ),
+	myFrameGraph( NULL ),
+	myUseTaskGraph( true ),
+	myObjectUpdateTask( 0 ),
+	myComponentUpdateTask( 0 ),
+	myFrameElapsedTime( 0.0f ),
+	myRenderFrame( true ),
+	myRenderChunks( NULL ),
+	myInstance( NULL ),
+	myWindowHandle( NULL ),
+	myScreenWidth( 0 ),
+	myScreenHeight( 0 ),
+	myIsFullScreen( false ),
+	myEnableVsync( false ),
+	myStartupGraph( NULL ),
+	myIsStartupFailed( false ),
+	myStartupStartTime( 0 ),
+	myStartupTime( 0.0 ),
+	myTimeToFirstFrame( 0.0 )
 {
 }
 
 
-// Creates and initialises the engine's renderer
-bool VoxelEngine::CreateRenderer( RenderManagerType aRendererType, int aScreenWidth, int aScreenHeight )
+// Creates the managers & services shared by the windowed and headless engines
+bool VoxelEngine::InitialiseSystems()
+{
+	myFrameAllocator	= new VEFrameAllocator();
+
+	myTerrainGenerator	= new VETerrainGenerator();
+	if( !myTerrainGenerator->Initialise() )
+	{
+		return false;
+	}
+
+	myWorldStore		= new VEWorldStore();
+	myWorldCache		= new VEWorldCache();
+
+	myThreadManager = new VEThreadManager();
+	if( !myThreadManager->Initialise() )
+	{
+		return false;
+	}
+
+	myLightingManager	= new VELightingManager();
+	myChunkManager		= new VEChunkManager();
+	if( !myChunkManager->Initialise() )
+	{
+		return false;
+	}
+
+	myObjectService		= new VEObjectService();
+	myComponentService	= new VEComponentService();
+	myPhysicsService	= new VEPhysicsService();
+	myInputService		= new VEInputService();
+
+	myFrameGraph		= new VETaskGraph();
+	BuildFrameGraph();
+
+	return true;
+}
+
+
+// Creates the engine's renderer, it's initialised by the startup graph once the device, systems, shaders & textures
+// it needs are ready
+bool VoxelEngine::CreateRenderer( RenderManagerType aRendererType )
 {
 	switch( aRendererType )
 	{
@@ -262,9 +566,298 @@ bool VoxelEngine::CreateRenderer( RenderManagerType aRendererType, int aScreenWi
 			myRenderer = new VEDeferredRenderManager();
 			break;
 
+		case RT_Null :
+			myRenderer = new VENullRenderManager();
+			break;
+
 		default :
 			return false;
 	}
 
-	return myRenderer->Initialise( aScreenWidth, aScreenHeight );
+	return true;
+}
+
+
+// Builds the startup graph and runs it on the job system. Tasks only wait for the state they read (see
+// StartupResource), so the systems, the shaders' bytecode, the textures and the game's own tasks are loaded alongside
+// each other. Only the device, DirectInput and the renderer stay on the main thread: they need the window, or draw
+// through the immediate context
+bool VoxelEngine::RunStartup()
+{
+	// The startup graph runs on the job system, so it's started first
+	myJobSystem = new VEJobSystem();
+	if( !myJobSystem->Initialise() )
+	{
+		return false;
+	}
+
+	myIsStartupFailed	= false;
+	myStartupGraph		= new VETaskGraph();
+
+	if( myRenderInterface != NULL )
+	{
+		myStartupGraph->AddTask( "RenderInterface", VoxelEngine::InitialiseRenderInterfaceTask, this, 0, SR_Device, true );
+		myStartupGraph->AddTask( "Input", VoxelEngine::InitialiseInputTask, this, 0, SR_Input, true );
+	}
+
+	myStartupGraph->AddTask( "Systems", VoxelEngine::InitialiseSystemsTask, this, 0, SR_Systems );
+
+	// Loading or compiling the shaders' bytecode doesn't need the device, and the device is free threaded so the
+	// textures are created on a worker once it exists
+	if( myShaderManager != NULL )
+	{
+		myStartupGraph->AddTask( "Shaders", VoxelEngine::PrepareShadersTask, this, 0, SR_Shaders );
+	}
+
+	if( myTextureManager != NULL )
+	{
+		myStartupGraph->AddTask( "Textures", VoxelEngine::LoadTexturesTask, this, SR_Device, SR_Textures );
+	}
+
+	myStartupGraph->AddTask( "Renderer", VoxelEngine::InitialiseRendererTask, this, SR_Device | SR_Systems | SR_Shaders | SR_Textures, SR_Renderer, true );
+
+	for( unsigned int i = 0; i < myStartupTasks.size(); i++ )
+	{
+		StartupTask& startupTask = myStartupTasks[i];
+		myStartupGraph->AddTask( startupTask.myName, VoxelEngine::GameStartupTask, &startupTask, startupTask.myReads, startupTask.myWrites, startupTask.myIsMainThreadOnly );
+	}
+
+	myStartupGraph->Execute( myJobSystem );
+	myStartupTime = ToMilliseconds( VEProfiler::GetTime() - myStartupStartTime );
+
+	return !myIsStartupFailed;
+}
+
+
+// Adds the tasks run by each update to the frame graph. A task waits for the earlier tasks that touch the same
+// state, so the chunk updates run alongside the object, component & physics updates. Input & the render submission
+// stay on the main thread: DirectInput isn't free threaded, and unless rendering is pipelined the frame is drawn on
+// the immediate context as soon as it's submitted
+void VoxelEngine::BuildFrameGraph()
+{
+	myFrameGraph->Clear();
+
+	// Input listeners queue messages for objects' components and can restyle chunks, so everything that touches
+	// objects or chunk builds runs after them
+	myFrameGraph->AddTask( "Input", VoxelEngine::UpdateInputTask, this, 0, FR_Input | FR_Objects | FR_ChunkBuilds, true );
+	myFrameGraph->AddTask( "Threads", VoxelEngine::UpdateThreadsTask, this, 0, FR_Threads );
+
+	// Event handlers are on the main thread, and can be game code that touches objects as well as chunks
+	myFrameGraph->AddTask( "Events", VoxelEngine::DrainEventsTask, this, 0, FR_Events | FR_ChunkBuilds | FR_Objects, true );
+
+	myFrameGraph->AddTask( "Chunks", VoxelEngine::UpdateChunksTask, this, 0, FR_ChunkBuilds | FR_Threads );
+	myFrameGraph->AddTask( "GatherChunks", VoxelEngine::GatherChunksTask, this, FR_ChunkBuilds, FR_RenderLists );
+
+	// Voxels are read through the chunks' locks, so object & physics updates don't wait for the chunk updates. The
+	// component systems run before the objects, keeping the order the components updated in when every component was
+	// updated by its object: the player's physics moves it before its camera follows
+	myComponentUpdateTask	= myFrameGraph->AddTask( "Components", VoxelEngine::UpdateComponentsTask, this, 0, FR_Objects | FR_Components );
+	myObjectUpdateTask		= myFrameGraph->AddTask( "Objects", VoxelEngine::UpdateObjectsTask, this, FR_Input | FR_Components, FR_Objects );
+	myFrameGraph->AddTask( "Physics", VoxelEngine::UpdatePhysicsTask, this, 0, FR_Objects | FR_Physics );
+
+	myFrameGraph->AddTask( "Render", VoxelEngine::RenderTask, this, FR_RenderLists | FR_ChunkBuilds | FR_Objects, FR_Render, true );
+}
+
+
+// Polls the input devices and delivers their events to the game
+void VoxelEngine::UpdateInputTask( void* anEngine )
+{
+	VoxelEngine* engine = reinterpret_cast<VoxelEngine*>( anEngine );
+	engine->myInputService->Update();
+}
+
+
+// Joins finished threads & starts pending ones
+void VoxelEngine::UpdateThreadsTask( void* anEngine )
+{
+	VoxelEngine* engine = reinterpret_cast<VoxelEngine*>( anEngine );
+	engine->myThreadManager->Update( engine->myFrameElapsedTime );
+}
+
+
+// Dispatches the events posted since the last frame
+void VoxelEngine::DrainEventsTask( void* anEngine )
+{
+	VoxelEngine* engine = reinterpret_cast<VoxelEngine*>( anEngine );
+	engine->myEventBus->Drain( VE_EVENT_FRAME_BUDGET );
+}
+
+
+// Starts rebuilding the dirty chunks
+void VoxelEngine::UpdateChunksTask( void* anEngine )
+{
+	VoxelEngine* engine = reinterpret_cast<VoxelEngine*>( anEngine );
+	engine->myChunkManager->Update( engine->myFrameElapsedTime );
+}
+
+
+// Gathers the chunks to draw this frame
+void VoxelEngine::GatherChunksTask( void* anEngine )
+{
+	VoxelEngine* engine = reinterpret_cast<VoxelEngine*>( anEngine );
+	assert( engine->myRenderChunks != NULL );
+
+	if( !engine->myRenderFrame )
+	{
+		return;
+	}
+
+	engine->myChunkManager->GetRenderableChunks( *engine->myRenderChunks );
+}
+
+
+// Updates the dynamic objects
+void VoxelEngine::UpdateObjectsTask( void* anEngine )
+{
+	VoxelEngine* engine = reinterpret_cast<VoxelEngine*>( anEngine );
+	engine->myObjectService->Update( engine->myFrameElapsedTime );
+}
+
+
+// Updates the component systems
+void VoxelEngine::UpdateComponentsTask( void* anEngine )
+{
+	VoxelEngine* engine = reinterpret_cast<VoxelEngine*>( anEngine );
+	engine->myComponentService->Update( engine->myFrameElapsedTime );
+}
+
+
+// Moves the physics objects
+void VoxelEngine::UpdatePhysicsTask( void* anEngine )
+{
+	VoxelEngine* engine = reinterpret_cast<VoxelEngine*>( anEngine );
+	if( engine->myPhysicsService->GetEnabled() )
+	{
+		engine->myPhysicsService->Update( engine->myFrameElapsedTime );
+	}
+}
+
+
+// Captures the frame's render state and submits it, to be drawn straight away or by the render thread
+void VoxelEngine::RenderTask( void* anEngine )
+{
+	VoxelEngine* engine = reinterpret_cast<VoxelEngine*>( anEngine );
+	assert( engine->myRenderChunks != NULL );
+
+	if( !engine->myRenderFrame )
+	{
+		return;
+	}
+
+	VERenderState* renderState = engine->myRenderPipeline->BeginState();
+	renderState->Capture( engine->myCamera, engine->myLightingManager, *engine->myRenderChunks, engine->myInputService );
+
+	engine->myRenderPipeline->SubmitState( renderState );
+}
+
+
+// Creates the device & swap chain, which need the window
+void VoxelEngine::InitialiseRenderInterfaceTask( void* anEngine )
+{
+	VoxelEngine* engine = reinterpret_cast<VoxelEngine*>( anEngine );
+	if( !engine->myRenderInterface->Initialise(engine->myWindowHandle, engine->myScreenWidth, engine->myScreenHeight, engine->myIsFullScreen, engine->myEnableVsync) )
+	{
+		engine->myIsStartupFailed = true;
+		return;
+	}
+
+	engine->myRenderBackend = engine->myRenderInterface;
+}
+
+
+// Creates the DirectInput devices, which need the window
+void VoxelEngine::InitialiseInputTask( void* anEngine )
+{
+	VoxelEngine* engine = reinterpret_cast<VoxelEngine*>( anEngine );
+	if( !engine->myInputInterface->Initialise(engine->myInstance, engine->myWindowHandle, engine->myScreenWidth, engine->myScreenHeight) )
+	{
+		engine->myIsStartupFailed = true;
+	}
+}
+
+
+// Creates the managers & services shared by the windowed and headless engines
+void VoxelEngine::InitialiseSystemsTask( void* anEngine )
+{
+	VoxelEngine* engine = reinterpret_cast<VoxelEngine*>( anEngine );
+	if( !engine->InitialiseSystems() )
+	{
+		engine->myIsStartupFailed = true;
+	}
+}
+
+
+// Loads the renderer's shaders' bytecode from the shader cache, compiling the misses on the job system. A shader that
+// fails is left for the renderer to report when it loads it
+void VoxelEngine::PrepareShadersTask( void* anEngine )
+{
+	VoxelEngine* engine = reinterpret_cast<VoxelEngine*>( anEngine );
+
+	// Without the cache every shader is compiled, which is only slower
+	engine->myShaderManager->GetShaderCache()->Open( engine->myDataDirectory + VE_SHADER_CACHE_DIRECTORY );
+
+	std::vector<VEShaderType> shaderTypes;
+	std::vector<std::wstring> textureFiles;
+	engine->myRenderer->GetResources( shaderTypes, textureFiles );
+
+	if( !shaderTypes.empty() )
+	{
+		engine->myShaderManager->PrepareShaders( &shaderTypes[0], shaderTypes.size() );
+	}
+}
+
+
+// Loads the renderer's textures. A texture that fails is left for the renderer to report when it loads it
+void VoxelEngine::LoadTexturesTask( void* anEngine )
+{
+	VoxelEngine* engine = reinterpret_cast<VoxelEngine*>( anEngine );
+	if( engine->myIsStartupFailed )
+	{
+		return;
+	}
+
+	std::vector<VEShaderType> shaderTypes;
+	std::vector<std::wstring> textureFiles;
+	engine->myRenderer->GetResources( shaderTypes, textureFiles );
+
+	for( unsigned int i = 0; i < textureFiles.size(); i++ )
+	{
+		engine->myTextureManager->LoadTexture( textureFiles[i] );
+	}
+}
+
+
+// Initialises the renderer & the render pipeline, creating the render targets and shaders on the main thread
+void VoxelEngine::InitialiseRendererTask( void* anEngine )
+{
+	VoxelEngine* engine = reinterpret_cast<VoxelEngine*>( anEngine );
+	if( engine->myIsStartupFailed )
+	{
+		return;
+	}
+
+	if( !engine->myRenderer->Initialise(engine->myScreenWidth, engine->myScreenHeight) )
+	{
+		engine->myIsStartupFailed = true;
+		return;
+	}
+
+	engine->myRenderPipeline = new VERenderPipeline();
+	if( !engine->myRenderPipeline->Initialise(engine->myRenderer, engine->myInputService) )
+	{
+		engine->myIsStartupFailed = true;
+	}
+}
+
+
+// Runs one of the game's startup tasks, unless an earlier task failed
+void VoxelEngine::GameStartupTask( void* aStartupTask )
+{
+	StartupTask* startupTask = reinterpret_cast<StartupTask*>( aStartupTask );
+	if( GetInstance()->myIsStartupFailed )
+	{
+		return;
+	}
+
+	startupTask->myFunction( startupTask->myParameter );
 }
@@ -5,6 +5,8 @@
 // ----------------- Includes -------------------
 
 #include "VETypes.h"
+#include "VEChunkManager.h"
+#include "VETaskGraph.h"
 
 
 // ------------ Forward Declarations ------------
@@ -12,16 +14,24 @@
 class VERenderManager;
 class VEBasicCamera;
 class VEDirectXInterface;
+class VERenderBackend;
 class VEDirectXInput;
 class VETerrainGenerator;
+class VEWorldStore;
+class VEWorldCache;
 class VELightingManager;
-class VEChunkManager;
 class VEThreadManager;
 class VEShaderManager;
 class VETextureManager;
 class VEObjectService;
+class VEComponentService;
+class VEEventBus;
+class VEFrameAllocator;
+class VEJobSystem;
+class VERenderPipeline;
 
 class VEPhysicsService;
+class VEInputService;
 
 
 // ------------------ Classes -------------------
@@ -43,19 +53,42 @@ class VoxelEngine
 		// Initialises the voxel engine
 		bool                Initialise( HINSTANCE anInstance, HWND aWindowHandle, int aScreenWidth, int aScreenHeight, bool isFullScreen, bool anEnableVsync, std::wstring aDataDirectory );
 
+		// Initialises the engine without a window, input or GPU, for benchmarking & testing. Still built against the
+		// Windows SDK, only the null render backend, job system & shader cache build without it so far
+		bool				InitialiseHeadless( std::wstring aDataDirectory );
+
+		// Adds a task to the startup graph, run by Initialise once the engine's startup tasks it reads from have finished
+		// (see StartupResource). Must be called before the engine is initialised, & is skipped if an earlier task failed
+		void				AddStartupTask( const char* aName, VETaskFunction aFunction, void* aParameter, unsigned int someReads, unsigned int someWrites, bool isMainThreadOnly = false );
+
+		// Writes each startup task's start & duration, the time Initialise took and the time to the first frame to a
+		// text file
+		bool				WriteStartupReport( const std::wstring& aFilename );
+
+		// Runs a number of engine updates back to back, with a fixed time step
+		void				RunFrames( unsigned int aFrameCount, float anElapsedTime );
+
 		// Uninitialises the voxel engine
 		void                Uninitialise();
 
-		// Updates & renders the current scene
-		void                Update( float anElapsedTime );
+		// Updates the current scene, and renders it unless told not to. Fixed time step loops only render the last of
+		// the steps they run in a frame
+		void                Update( float anElapsedTime, bool aRender = true );
 
 
 		// ------------- Accessors --------------
 
 		VEDirectXInterface* GetRenderInterface()				{ return myRenderInterface; }
 
+		VERenderBackend*	GetRenderBackend()					{ return myRenderBackend; }
+
+		bool				IsHeadless()						{ return myRenderInterface == NULL; }
+
 		VERenderManager*	GetRenderManager()					{ return myRenderer; }
 
+		// Hands each frame's render state to the render manager, optionally on a render thread
+		VERenderPipeline*	GetRenderPipeline()					{ return myRenderPipeline; }
+
 		VEDirectXInput*		GetInputInterface()					{ return myInputInterface; }
 
 		VELightingManager*	GetLightingManager()				{ return myLightingManager; }
@@ -70,12 +103,57 @@ class VoxelEngine
 
 		VEObjectService*	GetObjectService()					{ return myObjectService; }
 
+		VEComponentService*	GetComponentService()				{ return myComponentService; }
+
+		VEEventBus*			GetEventBus()						{ return myEventBus; }
+
+		VEJobSystem*		GetJobSystem()						{ return myJobSystem; }
+
+		// The tasks each update runs, with their timings from the last frame
+		VETaskGraph*		GetFrameGraph()						{ return myFrameGraph; }
+
+		// The tasks Initialise ran, with their timings
+		VETaskGraph*		GetStartupGraph()					{ return myStartupGraph; }
+
+		// The time (in milliseconds) Initialise took, and from the start of Initialise to the end of the first drawn
+		// frame (0 until one has been drawn)
+		double				GetStartupTime()					{ return myStartupTime; }
+		double				GetTimeToFirstFrame()				{ return myTimeToFirstFrame; }
+
+		// When disabled, the frame's tasks run one after another on the main thread
+		bool				GetUseTaskGraph()					{ return myUseTaskGraph; }
+		void				SetUseTaskGraph( bool aUseTaskGraph )	{ myUseTaskGraph = aUseTaskGraph; }
+
+		// Per-frame scratch memory, recycled at the start of every other update
+		VEFrameAllocator*	GetFrameAllocator()					{ return myFrameAllocator; }
+
 		VEPhysicsService*	GetPhysicsService()					{ return myPhysicsService; }
 
+		// Timestamps input & delivers it to the game at the start of each update
+		VEInputService*		GetInputService()					{ return myInputService; }
+
 		VETerrainGenerator* GetTerrainGenerator()				{ return myTerrainGenerator; }
+
+		// Loads & saves the world's chunks, once the game has opened a world
+		VEWorldStore*		GetWorldStore()						{ return myWorldStore; }
+
+		// Caches generated chunks & their meshes between runs, once the game has opened it
+		VEWorldCache*		GetWorldCache()						{ return myWorldCache; }
 		
 		std::wstring        GetDataDirectory()					{ return myDataDirectory; }
 
+		// The number of heap allocations made by the last frame's object & component updates (always 0 unless
+		// VE_MEMORY_TRACKING is defined)
+		unsigned int		GetObjectUpdateAllocations()		{ return myObjectUpdateAllocations; }
+
+		// The number of heap allocations the main thread made during the last frame
+		unsigned int		GetFrameAllocations()				{ return myFrameAllocations; }
+
+		// When enabled, every frame asserts that it made no heap allocations. Only meaningful once the world has
+		// settled (no chunks waiting to be built) and VE_MEMORY_TRACKING is defined
+		bool				GetCheckFrameAllocations()			{ return myCheckFrameAllocations; }
+		void				SetCheckFrameAllocations( bool aCheck )	{ myCheckFrameAllocations = aCheck; }
+
 		VEBasicCamera*		GetCamera()							{ return myCamera; }
 		void				SetCamera( VEBasicCamera* aCamera )	{ myCamera = aCamera; }
 
@@ -86,13 +164,58 @@ class VoxelEngine
 
 	private :
 
+		// --------- Private Structures ---------
+
+		// A task the game added to the startup graph
+		struct StartupTask
+		{
+			const char*			myName;
+			VETaskFunction		myFunction;
+			void*				myParameter;
+			unsigned int		myReads;
+			unsigned int		myWrites;
+			bool				myIsMainThreadOnly;
+		};
+
+
 		// ---------- Private Functions ---------
 
 		// Private construction - voxel engine should be accessed using the 'GetInstance' function
 		VoxelEngine();
 
-		// Creates and initialises the engine's renderer
-		bool				CreateRenderer( RenderManagerType aRendererType, int aScreenWidth, int aScreenHeight );
+		// Creates the managers & services shared by the windowed and headless engines
+		bool				InitialiseSystems();
+
+		// Creates the engine's renderer, it's initialised by the startup graph
+		bool				CreateRenderer( RenderManagerType aRendererType );
+
+		// Builds the startup graph and runs it on the job system. Returns false if any of its tasks failed
+		bool				RunStartup();
+
+		// Adds the tasks run by each update to the frame graph
+		void				BuildFrameGraph();
+
+		// The frame graph's tasks, each takes the engine as its parameter
+		static void			UpdateInputTask( void* anEngine );
+		static void			UpdateThreadsTask( void* anEngine );
+		static void			DrainEventsTask( void* anEngine );
+		static void			UpdateChunksTask( void* anEngine );
+		static void			GatherChunksTask( void* anEngine );
+		static void			UpdateObjectsTask( void* anEngine );
+		static void			UpdateComponentsTask( void* anEngine );
+		static void			UpdatePhysicsTask( void* anEngine );
+		static void			RenderTask( void* anEngine );
+
+		// The startup graph's tasks, each takes the engine as its parameter and sets the failed flag if it fails
+		static void			InitialiseRenderInterfaceTask( void* anEngine );
+		static void			InitialiseInputTask( void* anEngine );
+		static void			InitialiseSystemsTask( void* anEngine );
+		static void			PrepareShadersTask( void* anEngine );
+		static void			LoadTexturesTask( void* anEngine );
+		static void			InitialiseRendererTask( void* anEngine );
+
+		// Runs one of the game's startup tasks, unless an earlier task failed
+		static void			GameStartupTask( void* aStartupTask );
 
 
 		// ---------- Private Variables ---------
@@ -100,7 +223,9 @@ class VoxelEngine
 		static VoxelEngine*     myVoxelEngine;
 
 		VERenderManager*		myRenderer;
+		VERenderPipeline*		myRenderPipeline;
 		VEDirectXInterface*     myRenderInterface;
+		VERenderBackend*		myRenderBackend;
 		VEDirectXInput*			myInputInterface;
 
 		VEBasicCamera*          myCamera;
@@ -112,11 +237,48 @@ class VoxelEngine
 		VETextureManager*		myTextureManager;
 
 		VEObjectService*		myObjectService;
+		VEComponentService*		myComponentService;
+		VEEventBus*				myEventBus;
+		VEFrameAllocator*		myFrameAllocator;
 		VEPhysicsService*		myPhysicsService;
+		VEInputService*			myInputService;
+		VEJobSystem*			myJobSystem;
+
+		VETaskGraph*			myFrameGraph;
+		bool					myUseTaskGraph;
+		unsigned int			myObjectUpdateTask;
+		unsigned int			myComponentUpdateTask;
+
+		// The current frame's time step, whether it's drawn & its chunk render list, only valid while the frame graph is
+		// running
+		float					myFrameElapsedTime;
+		bool					myRenderFrame;
+		VEChunkRenderList*		myRenderChunks;
+
+		// The window & screen the startup tasks create the device & input for
+		HINSTANCE				myInstance;
+		HWND					myWindowHandle;
+		int						myScreenWidth;
+		int						myScreenHeight;
+		bool					myIsFullScreen;
+		bool					myEnableVsync;
+
+		VETaskGraph*			myStartupGraph;
+		std::vector<StartupTask> myStartupTasks;
+		std::atomic<bool>		myIsStartupFailed;
+		long long				myStartupStartTime;
+		double					myStartupTime;
+		double					myTimeToFirstFrame;
 
 		VETerrainGenerator*		myTerrainGenerator;
+		VEWorldStore*			myWorldStore;
+		VEWorldCache*			myWorldCache;
 
 		std::wstring            myDataDirectory;
+
+		unsigned int			myObjectUpdateAllocations;
+		unsigned int			myFrameAllocations;
+		bool					myCheckFrameAllocations;
 };
 
 
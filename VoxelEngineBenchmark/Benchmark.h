@@ -0,0 +1,54 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+
+// ---------------- Classes -----------------
+
+// A single benchmark run by the benchmark runner. Setup and Teardown are called once, outside of the timed
+// region, and Run is timed once per iteration
+class Benchmark
+{
+	public :
+
+		// ---------- Public Functions ----------
+
+		// Construction
+		Benchmark( const std::string& aName, unsigned int anIterationCount ) :
+			myName( aName ),
+			myIterationCount( anIterationCount )
+		{
+		}
+
+		// Deconstruction
+		virtual ~Benchmark()								{}
+
+		// Prepares the data used by the benchmark
+		virtual bool			Setup()						{ return true; }
+
+		// Runs a single timed iteration of the benchmark
+		virtual void			Run() = 0;
+
+		// Cleans up the data used by the benchmark
+		virtual void			Teardown()					{}
+
+		// Prints anything the benchmark measured besides its timings, called after Teardown
+		virtual void			PrintReport()				{}
+
+
+		// ------------- Accessors --------------
+
+		const std::string&		GetName()					{ return myName; }
+
+		unsigned int			GetIterationCount()			{ return myIterationCount; }
+
+
+	private :
+
+		// --------- Private Variables ----------
+
+		std::string				myName;
+		unsigned int			myIterationCount;
+};
+
+
+#endif // !BENCHMARK_H
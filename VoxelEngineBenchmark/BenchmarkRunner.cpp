@@ -0,0 +1,329 @@
+
+// ------------------ Includes ------------------
+
+#include "Stdafx.h"
+#include "BenchmarkRunner.h"
+
+#include "Benchmark.h"
+#include "VEProfiler.h"
+
+
+// ------------------ Functions -----------------
+
+// Finds the value of a "key" : value pair in a line of JSON written by the runner
+static bool FindValue( const std::string& aLine, const std::string& aKey, std::string& aValue )
+{
+	std::string::size_type keyStart = aLine.find( "\"" + aKey + "\"" );
+	if( keyStart == std::string::npos )
+	{
+		return false;
+	}
+
+	std::string::size_type valueStart = aLine.find_first_not_of( " :", keyStart + aKey.size() + 2 );
+	if( valueStart == std::string::npos )
+	{
+		return false;
+	}
+
+	// Strings run to the closing quote, numbers to the next separator
+	std::string::size_type valueEnd;
+	if( aLine[valueStart] == '"' )
+	{
+		valueStart++;
+		valueEnd = aLine.find( '"', valueStart );
+	}
+	else
+	{
+		valueEnd = aLine.find_first_of( ", }", valueStart );
+	}
+
+	if( valueEnd == std::string::npos )
+	{
+		return false;
+	}
+
+	aValue = aLine.substr( valueStart, valueEnd - valueStart );
+	return true;
+}
+
+
+// Finds a number in a line of JSON written by the runner. Returns false if the key is missing, or its value isn't
+// entirely a number that isn't negative
+static bool FindNumber( const std::string& aLine, const std::string& aKey, double& aNumber )
+{
+	std::string value;
+	if( !FindValue(aLine, aKey, value) || value.empty() )
+	{
+		return false;
+	}
+
+	char* end = NULL;
+	aNumber = strtod( value.c_str(), &end );
+
+	return end == value.c_str() + value.size() && aNumber >= 0.0;
+}
+
+
+// -------------- Class Functions ---------------
+
+// Construction
+BenchmarkRunner::BenchmarkRunner()
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency( &frequency );
+
+	myTimerFrequency = (double)frequency.QuadPart;
+}
+
+
+// Deconstruction
+BenchmarkRunner::~BenchmarkRunner()
+{
+	for( unsigned int i = 0; i < myBenchmarks.size(); i++ )
+	{
+		delete myBenchmarks[i];
+		myBenchmarks[i] = NULL;
+	}
+	myBenchmarks.clear();
+}
+
+
+// Adds a benchmark to the runner, the runner takes ownership of the benchmark
+void BenchmarkRunner::AddBenchmark( Benchmark* aBenchmark )
+{
+	assert( aBenchmark != NULL );
+
+	myBenchmarks.push_back( aBenchmark );
+}
+
+
+// Runs every benchmark whose name contains the filter (an empty filter runs everything)
+bool BenchmarkRunner::Run( const std::string& aFilter )
+{
+	myResults.clear();
+
+	bool succeeded = true;
+	for( unsigned int i = 0; i < myBenchmarks.size(); i++ )
+	{
+		Benchmark* benchmark = myBenchmarks[i];
+		if( !aFilter.empty() && benchmark->GetName().find(aFilter) == std::string::npos )
+		{
+			continue;
+		}
+
+		BenchmarkResult result;
+		if( !RunBenchmark(benchmark, result) )
+		{
+			printf( "%-40s FAILED\n", benchmark->GetName().c_str() );
+			succeeded = false;
+			continue;
+		}
+
+		printf( "%-40s %8u iterations   min %10.4fms   median %10.4fms   mean %10.4fms   max %10.4fms\n", result.myName.c_str(),
+				result.myIterationCount, result.myMinimum, result.myMedian, result.myMean, result.myMaximum );
+
+		benchmark->PrintReport();
+
+		myResults.push_back( result );
+	}
+
+	return succeeded;
+}
+
+
+// Writes the results of the last run to a JSON file. Each benchmark is written on a single line, which is
+// what ReadResults expects when the file is used as a baseline
+bool BenchmarkRunner::WriteResults( const std::wstring& aFilename, unsigned int aSeed )
+{
+	std::ofstream file( aFilename.c_str() );
+	if( !file.is_open() )
+	{
+		return false;
+	}
+
+	file.precision( 6 );
+	file << std::fixed;
+
+#ifdef _DEBUG
+	const char* configuration = "Debug";
+#else
+	const char* configuration = "Release";
+#endif
+
+	file << "{\n";
+	file << "\t\"configuration\" : \"" << configuration << "\",\n";
+	file << "\t\"seed\" : " << aSeed << ",\n";
+	file << "\t\"benchmarks\" :\n\t[\n";
+
+	for( unsigned int i = 0; i < myResults.size(); i++ )
+	{
+		const BenchmarkResult& result = myResults[i];
+
+		file << "\t\t{ \"name\" : \"" << result.myName << "\", \"iterations\" : " << result.myIterationCount
+			 << ", \"min_ms\" : " << result.myMinimum << ", \"median_ms\" : " << result.myMedian
+			 << ", \"mean_ms\" : " << result.myMean << ", \"max_ms\" : " << result.myMaximum << " }"
+			 << ( i + 1 < myResults.size() ? ",\n" : "\n" );
+	}
+
+	file << "\t]\n}\n";
+
+	return file.good();
+}
+
+
+// Compares the results of the last run against a baseline file written by WriteResults. Counts the benchmarks whose
+// median is slower than the baseline by more than the threshold, returns false if the baseline couldn't be read
+bool BenchmarkRunner::CompareToBaseline( const std::wstring& aFilename, float aThreshold, unsigned int& aRegressionCount )
+{
+	aRegressionCount = 0;
+
+	std::vector<BenchmarkResult> baseline;
+	if( !ReadResults(aFilename, baseline) )
+	{
+		printf( "Unable to read the baseline file, it's missing or isn't a results file\n" );
+		return false;
+	}
+
+	for( unsigned int i = 0; i < myResults.size(); i++ )
+	{
+		const BenchmarkResult& result = myResults[i];
+
+		// Find the matching baseline entry, new benchmarks have nothing to compare against
+		const BenchmarkResult* baselineResult = NULL;
+		for( unsigned int j = 0; j < baseline.size(); j++ )
+		{
+			if( baseline[j].myName == result.myName )
+			{
+				baselineResult = &baseline[j];
+				break;
+			}
+		}
+
+		if( baselineResult == NULL || baselineResult->myMedian <= 0.0 )
+		{
+			printf( "%-40s no baseline\n", result.myName.c_str() );
+			continue;
+		}
+
+		double change		= (result.myMedian - baselineResult->myMedian) / baselineResult->myMedian;
+		bool   isRegression	= change > aThreshold;
+		if( isRegression )
+		{
+			aRegressionCount++;
+		}
+
+		printf( "%-40s baseline %10.4fms   current %10.4fms   %+7.1f%%%s\n", result.myName.c_str(), baselineResult->myMedian,
+				result.myMedian, change * 100.0, isRegression ? "   REGRESSION" : "" );
+	}
+
+	return true;
+}
+
+
+// Times the iterations of a single benchmark
+bool BenchmarkRunner::RunBenchmark( Benchmark* aBenchmark, BenchmarkResult& aResult )
+{
+	if( !aBenchmark->Setup() )
+	{
+		aBenchmark->Teardown();
+		return false;
+	}
+
+	for( unsigned int i = 0; i < BENCHMARK_WARMUP_ITERATIONS; i++ )
+	{
+		aBenchmark->Run();
+	}
+
+	unsigned int		iterationCount = aBenchmark->GetIterationCount();
+	std::vector<double> timings( iterationCount );
+
+	for( unsigned int i = 0; i < iterationCount; i++ )
+	{
+		long long startTime = VEProfiler::GetTime();
+		aBenchmark->Run();
+		long long endTime	= VEProfiler::GetTime();
+
+		timings[i] = (double)(endTime - startTime) * 1000.0 / myTimerFrequency;
+	}
+
+	aBenchmark->Teardown();
+
+	if( timings.empty() )
+	{
+		return false;
+	}
+
+	std::sort( timings.begin(), timings.end() );
+
+	double total = 0.0;
+	for( unsigned int i = 0; i < timings.size(); i++ )
+	{
+		total += timings[i];
+	}
+
+	aResult.myName				= aBenchmark->GetName();
+	aResult.myIterationCount	= iterationCount;
+	aResult.myMinimum			= timings.front();
+	aResult.myMedian			= timings[timings.size() / 2];
+	aResult.myMean				= total / timings.size();
+	aResult.myMaximum			= timings.back();
+
+	return true;
+}
+
+
+// Reads the results from a file written by WriteResults. Returns false if the file is missing, has no benchmarks, a
+// benchmark's line is missing a value, or the file was cut off before the end of the benchmark list
+bool BenchmarkRunner::ReadResults( const std::wstring& aFilename, std::vector<BenchmarkResult>& someResults )
+{
+	std::ifstream file( aFilename.c_str() );
+	if( !file.is_open() )
+	{
+		return false;
+	}
+
+	bool			isListStarted	= false;
+	bool			isListEnded		= false;
+	unsigned int	lineNumber		= 0;
+
+	std::string line;
+	while( std::getline(file, line) )
+	{
+		lineNumber++;
+
+		// The benchmarks are listed between the "benchmarks" key and the closing bracket
+		if( line.find("\"benchmarks\"") != std::string::npos )
+		{
+			isListStarted = true;
+			continue;
+		}
+
+		std::string::size_type firstCharacter = line.find_first_not_of( " \t\r" );
+		if( isListStarted && firstCharacter != std::string::npos && line[firstCharacter] == ']' )
+		{
+			isListEnded = true;
+			continue;
+		}
+
+		BenchmarkResult result;
+		if( !FindValue(line, "name", result.myName) )
+		{
+			continue;
+		}
+
+		// Every value WriteResults writes has to be there
+		double iterationCount = 0.0;
+		if( !isListStarted || isListEnded || !FindNumber(line, "iterations", iterationCount) || !FindNumber(line, "min_ms", result.myMinimum) ||
+			!FindNumber(line, "median_ms", result.myMedian) || !FindNumber(line, "mean_ms", result.myMean) ||
+			!FindNumber(line, "max_ms", result.myMaximum) )
+		{
+			printf( "Baseline line %u isn't a benchmark result: %s\n", lineNumber, line.c_str() );
+			return false;
+		}
+
+		result.myIterationCount = (unsigned int)iterationCount;
+		someResults.push_back( result );
+	}
+
+	return isListEnded && !someResults.empty();
+}
@@ -0,0 +1,99 @@
+#ifndef BENCHMARK_RUNNER_H
+#define BENCHMARK_RUNNER_H
+
+
+// ---------------- Defines -----------------
+
+// The number of untimed iterations run before timing starts, to warm the caches & allocators
+#define BENCHMARK_WARMUP_ITERATIONS		2
+
+// The default slowdown (as a fraction of the baseline median) before a benchmark is flagged as a regression
+#define BENCHMARK_REGRESSION_THRESHOLD	0.1f
+
+
+// ---------- Forward Declarations ----------
+
+class Benchmark;
+
+
+// ---------------- Structures --------------
+
+// The timings of a single benchmark, in milliseconds
+struct BenchmarkResult
+{
+	BenchmarkResult() :
+		myIterationCount( 0 ),
+		myMinimum( 0.0 ),
+		myMedian( 0.0 ),
+		myMean( 0.0 ),
+		myMaximum( 0.0 )
+	{
+	}
+
+	std::string		myName;
+	unsigned int	myIterationCount;
+
+	double			myMinimum;
+	double			myMedian;
+	double			myMean;
+	double			myMaximum;
+};
+
+
+// ---------------- Classes -----------------
+
+// Runs a set of benchmarks, writes their timings out as JSON and compares them against a previously
+// written baseline
+class BenchmarkRunner
+{
+	public :
+
+		// ---------- Public Functions ----------
+
+		// Construction
+		BenchmarkRunner();
+
+		// Deconstruction
+		~BenchmarkRunner();
+
+		// Adds a benchmark to the runner, the runner takes ownership of the benchmark
+		void			AddBenchmark( Benchmark* aBenchmark );
+
+		// Runs every benchmark whose name contains the filter (an empty filter runs everything)
+		bool			Run( const std::string& aFilter );
+
+		// Writes the results of the last run to a JSON file
+		bool			WriteResults( const std::wstring& aFilename, unsigned int aSeed );
+
+		// Compares the results of the last run against a baseline file written by WriteResults. Counts the benchmarks
+		// whose median is slower than the baseline by more than the threshold. Returns false if the baseline is missing
+		// or corrupt, in which case nothing was compared
+		bool			CompareToBaseline( const std::wstring& aFilename, float aThreshold, unsigned int& aRegressionCount );
+
+
+		// ------------- Accessors --------------
+
+		const std::vector<BenchmarkResult>&	GetResults()	{ return myResults; }
+
+
+	private :
+
+		// --------- Private Functions ----------
+
+		// Times the iterations of a single benchmark
+		bool			RunBenchmark( Benchmark* aBenchmark, BenchmarkResult& aResult );
+
+		// Reads the results from a file written by WriteResults, returns false if it's missing or corrupt
+		static bool		ReadResults( const std::wstring& aFilename, std::vector<BenchmarkResult>& someResults );
+
+
+		// --------- Private Variables ----------
+
+		std::vector<Benchmark*>			myBenchmarks;
+		std::vector<BenchmarkResult>	myResults;
+
+		double							myTimerFrequency;
+};
+
+
+#endif // !BENCHMARK_RUNNER_H
@@ -0,0 +1,3335 @@
+
+// ------------------ Includes ------------------
+
+#include "Stdafx.h"
+#include "EngineBenchmarks.h"
+
+#include "Benchmark.h"
+#include "BenchmarkRunner.h"
+
+#include "VoxelEngine.h"
+#include "VEChunkManager.h"
+#include "VEChunk.h"
+#include "VEChunkData.h"
+#include "VEChunkSnapshot.h"
+#include "VEMeshScratchPool.h"
+#include "VEVoxel.h"
+#include "VEObject.h"
+#include "VEObjectComponent.h"
+#include "VEObjectService.h"
+#include "VEComponentService.h"
+#include "VEPhysicsService.h"
+#include "VEEventBus.h"
+#include "VEThreadManager.h"
+#include "VEMemoryTracker.h"
+#include "VEPoolAllocator.h"
+#include "VEFrameAllocator.h"
+#include "VEThreading.h"
+#include "VETaskGraph.h"
+#include "VEJobSystem.h"
+#include "VERenderPipeline.h"
+#include "VENullRenderBackend.h"
+#include "VEProfiler.h"
+#include "VEClock.h"
+#include "VEFrameScheduler.h"
+#include "VEInputService.h"
+#include "VEInputReplay.h"
+#include "VEBasicCamera.h"
+#include "VEWorldStore.h"
+#include "VEEditJournal.h"
+#include "VEWorldCache.h"
+#include "VERegionFile.h"
+#include "VETerrainGenerator.h"
+#include "VEMemoryBudget.h"
+#include "VEMeshCache.h"
+#include "VEShaderManager.h"
+#include "VEShaderCache.h"
+#include "VEShaderFileStorage.h"
+#include "VEHLSLCompiler.h"
+#include "VEShader.h"
+
+#include <noise/noise.h>
+#include "noiseutils.h"
+
+
+// ----------------- Namespaces -----------------
+
+using namespace DirectX;
+
+
+// ------------------- Enums --------------------
+
+// Component & event types used by the benchmarks, kept clear of the engine's own types
+enum BenchmarkType
+{
+	BT_BenchmarkComponent	= CM_Max,
+	BT_BenchmarkEvent		= EE_Max
+};
+
+// How the component update benchmark stores & updates its components
+enum BenchmarkComponentModel
+{
+	BCM_ObjectMap,
+	BCM_System,
+	BCM_ParallelSystem
+};
+
+
+// ------------------ Functions -----------------
+
+// A small deterministic random number generator, so the benchmarks don't depend on the CRT's rand
+static unsigned int NextRandom( unsigned int& aState )
+{
+	aState = aState * 1664525u + 1013904223u;
+	return aState >> 8;
+}
+
+
+// Returns a deterministic random float in the 0.0f - aRange range
+static float RandomFloat( unsigned int& aState, float aRange )
+{
+	return (float)(NextRandom(aState) & 0xffff) / 65535.0f * aRange;
+}
+
+
+// Returns the interior chunk used by the chunk benchmarks, it has neighbours on every side
+static VEChunk* GetBenchmarkChunk()
+{
+	VEChunkManager* chunkManager = VoxelEngine::GetInstance()->GetChunkManager();
+	assert( chunkManager != NULL );
+
+	return chunkManager->GetChunk( BENCHMARK_WORLD_WIDTH / 2, BENCHMARK_WORLD_DEPTH / 2 );
+}
+
+
+// Prints a pool's usage. Pools only hand out fixed size blocks so the heap can't fragment, the cost is instead
+// memory reserved by the pool that isn't in use
+static void PrintPoolStatistics( const char* aName, const VEPoolStatistics& aStatistics )
+{
+	size_t peakBytes	= (size_t)aStatistics.myPeakBlocksInUse * aStatistics.myBlockSize;
+	double utilisation	= aStatistics.myReservedBytes > 0 ? (double)peakBytes * 100.0 / (double)aStatistics.myReservedBytes : 0.0;
+
+	printf( "    %-36s %10u byte blocks   %4u pages   %8.2fMB reserved   %6u peak blocks   %6.1f%% utilised%s\n", aName,
+			aStatistics.myBlockSize, aStatistics.myPageCount, (double)aStatistics.myReservedBytes / (1024.0 * 1024.0),
+			aStatistics.myPeakBlocksInUse, utilisation, aStatistics.myUsesLargePages ? "   (large pages)" : "" );
+}
+
+
+// ------------------- Classes ------------------
+
+// Builds a single chunk's worth of height map data
+class NoiseMapBuildBenchmark : public Benchmark
+{
+	public :
+
+		// Construction
+		NoiseMapBuildBenchmark() : Benchmark( "NoiseMapBuilderPlane::Build", 200 )
+		{
+		}
+
+		// Points the plane builder at the noise module & map
+		virtual bool Setup() override
+		{
+			int chunkDimensions = VoxelEngine::GetInstance()->GetChunkManager()->GetChunkDimensions();
+
+			myPlaneBuilder.SetSourceModule( myNoiseGenerator );
+			myPlaneBuilder.SetDestNoiseMap( myHeightMap );
+			myPlaneBuilder.SetDestSize( chunkDimensions, chunkDimensions );
+			myPlaneBuilder.SetBounds( 2.0, 2.8, 2.0, 2.8 );
+
+			return true;
+		}
+
+		// Builds the height map
+		virtual void Run() override
+		{
+			myPlaneBuilder.Build();
+		}
+
+	private :
+
+		noise::module::Perlin				myNoiseGenerator;
+		noise::utils::NoiseMap				myHeightMap;
+		noise::utils::NoiseMapBuilderPlane	myPlaneBuilder;
+};
+
+
+// Applies a height map to a chunk that isn't part of the world, so the world stays untouched
+class ApplyHeightMapBenchmark : public Benchmark
+{
+	public :
+
+		// Construction
+		ApplyHeightMapBenchmark() : Benchmark( "VEChunk::ApplyHeightMap", 200 ),
+			myChunk( NULL )
+		{
+		}
+
+		// Creates the chunk and builds the height map
+		virtual bool Setup() override
+		{
+			int chunkDimensions = VoxelEngine::GetInstance()->GetChunkManager()->GetChunkDimensions();
+
+			myChunk = VoxelEngine::GetInstance()->GetChunkManager()->CreateChunk( XMFLOAT3(0.0f, 0.0f, 0.0f), -1, -1 );
+			if( myChunk == NULL )
+			{
+				return false;
+			}
+
+			noise::module::Perlin				noiseGenerator;
+			noise::utils::NoiseMapBuilderPlane	planeBuilder;
+
+			planeBuilder.SetSourceModule( noiseGenerator );
+			planeBuilder.SetDestNoiseMap( myHeightMap );
+			planeBuilder.SetDestSize( chunkDimensions, chunkDimensions );
+			planeBuilder.SetBounds( 2.0, 2.8, 2.0, 2.8 );
+			planeBuilder.Build();
+
+			return true;
+		}
+
+		// Applies the height map
+		virtual void Run() override
+		{
+			myChunk->ApplyHeightMap( &myHeightMap );
+		}
+
+		// Deletes the chunk
+		virtual void Teardown() override
+		{
+			if( myChunk != NULL )
+			{
+				VoxelEngine::GetInstance()->GetChunkManager()->DestroyChunk( myChunk );
+				myChunk = NULL;
+			}
+		}
+
+	private :
+
+		VEChunk*					myChunk;
+		noise::utils::NoiseMap		myHeightMap;
+};
+
+
+// Finishes building the benchmark chunk from its snapshot, so it's left drawable and its scratch buffer goes back
+// to the pool
+static void FinishBenchmarkChunk()
+{
+	VEChunk* chunk = GetBenchmarkChunk();
+
+	chunk->CalculateVisibility();
+	chunk->BuildMesh();
+	chunk->GetRenderData()->BuildBuffers();
+}
+
+
+// Captures the snapshot a chunk is built from: the chunk's voxels plus a halo from each neighbouring chunk
+class CaptureSnapshotBenchmark : public Benchmark
+{
+	public :
+
+		// Construction
+		CaptureSnapshotBenchmark() : Benchmark( "VEChunk::PrepareBuild", 200 )
+		{
+		}
+
+		// Captures the snapshot
+		virtual void Run() override
+		{
+			GetBenchmarkChunk()->PrepareBuild();
+		}
+
+		// Builds the chunk from the last snapshot
+		virtual void Teardown() override
+		{
+			FinishBenchmarkChunk();
+		}
+};
+
+
+// Calculates the visibility of every voxel in a chunk's snapshot, including the halo from the neighbouring chunks
+class CalculateVisibilityBenchmark : public Benchmark
+{
+	public :
+
+		// Construction
+		CalculateVisibilityBenchmark() : Benchmark( "VEChunkSnapshot::CalculateVisibility", 50 )
+		{
+		}
+
+		// The snapshot only needs capturing once
+		virtual bool Setup() override
+		{
+			GetBenchmarkChunk()->PrepareBuild();
+			return true;
+		}
+
+		// Calculates the visibility
+		virtual void Run() override
+		{
+			GetBenchmarkChunk()->CalculateVisibility();
+		}
+
+		// Builds the chunk from the snapshot
+		virtual void Teardown() override
+		{
+			FinishBenchmarkChunk();
+		}
+};
+
+
+// Meshes a chunk: counts the visible faces, then fills the exactly sized vertex & index buffers. Run both on the
+// calling thread and split across the worker threads by Y-slab
+class BuildMeshBenchmark : public Benchmark
+{
+	public :
+
+		// Construction
+		BuildMeshBenchmark( bool anIsParallel ) : Benchmark( anIsParallel ? "VEChunk::BuildMesh (parallel)" : "VEChunk::BuildMesh", 50 ),
+			myIsParallel( anIsParallel ),
+			myIndexCount( 0 )
+		{
+		}
+
+		// The snapshot & its visibility only need calculating once
+		virtual bool Setup() override
+		{
+			VEChunk* chunk = GetBenchmarkChunk();
+
+			chunk->PrepareBuild();
+			chunk->CalculateVisibility();
+			return true;
+		}
+
+		// Builds the mesh, the buffers are resized to fit so the previous iteration's mesh is overwritten
+		virtual void Run() override
+		{
+			GetBenchmarkChunk()->BuildMesh( myIsParallel );
+		}
+
+		// Uploads the last mesh, so the chunk can still be drawn & its size reported
+		virtual void Teardown() override
+		{
+			VEChunk* chunk = GetBenchmarkChunk();
+
+			chunk->GetRenderData()->BuildBuffers();
+			myIndexCount = chunk->GetIndexCount();
+		}
+
+		// Prints the size of the mesh, to turn the timings in to a throughput
+		virtual void PrintReport() override
+		{
+			printf( "    %u faces, %u vertices & %u indices per chunk\n", myIndexCount / 6, (myIndexCount / 6) * 4, myIndexCount );
+		}
+
+	private :
+
+		bool			myIsParallel;
+		unsigned int	myIndexCount;
+};
+
+
+// Rebuilds a chunk from scratch: snapshot, visibility, mesh and buffers (through the null render backend)
+class ChunkRebuildBenchmark : public Benchmark
+{
+	public :
+
+		// Construction
+		ChunkRebuildBenchmark() : Benchmark( "VEChunk::BuildData", 30 )
+		{
+		}
+
+		// Rebuilds the chunk
+		virtual void Run() override
+		{
+			VEChunk* chunk = GetBenchmarkChunk();
+
+			chunk->PrepareBuild();
+			chunk->BuildData();
+		}
+};
+
+
+// A dynamic object that drifts a little every update
+class BenchmarkObject : public VEObject
+{
+	public :
+
+		// Updates the object's components and moves it
+		virtual void Update( float anElapsedTime ) override
+		{
+			VEObject::Update( anElapsedTime );
+
+			myPosition.x += anElapsedTime;
+			myPosition.z += anElapsedTime;
+		}
+};
+
+
+// Updates a world full of dynamic objects
+class ObjectUpdateBenchmark : public Benchmark
+{
+	public :
+
+		// Construction
+		ObjectUpdateBenchmark() : Benchmark( "VEObjectService::Update", 200 )
+		{
+		}
+
+		// Creates & registers the objects
+		virtual bool Setup() override
+		{
+			unsigned int randomState = BENCHMARK_SEED;
+
+			myObjects.reserve( BENCHMARK_OBJECT_COUNT );
+			for( unsigned int i = 0; i < BENCHMARK_OBJECT_COUNT; i++ )
+			{
+				BenchmarkObject* newObject = new BenchmarkObject();
+				newObject->SetPosition( XMFLOAT3(RandomFloat(randomState, 256.0f), 20.0f, RandomFloat(randomState, 256.0f)) );
+
+				if( !newObject->Initialise(true) )
+				{
+					delete newObject;
+					return false;
+				}
+
+				myObjects.push_back( newObject );
+			}
+
+			return true;
+		}
+
+		// Updates the objects
+		virtual void Run() override
+		{
+			VoxelEngine::GetInstance()->GetObjectService()->Update( BENCHMARK_TIME_STEP );
+		}
+
+		// Deletes the objects, which removes them from the object service
+		virtual void Teardown() override
+		{
+			for( unsigned int i = 0; i < myObjects.size(); i++ )
+			{
+				delete myObjects[i];
+				myObjects[i] = NULL;
+			}
+			myObjects.clear();
+		}
+
+	private :
+
+		std::vector<BenchmarkObject*>	myObjects;
+};
+
+
+// Creates & registers a number of plain objects for the object handle benchmarks
+static bool CreateBenchmarkObjects( std::vector<VEObject*>& someObjects, unsigned int aCount, bool isDynamic )
+{
+	someObjects.reserve( aCount );
+	for( unsigned int i = 0; i < aCount; i++ )
+	{
+		VEObject* newObject = new VEObject();
+		if( !newObject->Initialise(isDynamic) )
+		{
+			delete newObject;
+			return false;
+		}
+
+		someObjects.push_back( newObject );
+	}
+
+	return true;
+}
+
+
+// Deletes the objects created for a benchmark, which removes them from the object service
+static void DeleteBenchmarkObjects( std::vector<VEObject*>& someObjects )
+{
+	for( unsigned int i = 0; i < someObjects.size(); i++ )
+	{
+		delete someObjects[i];
+		someObjects[i] = NULL;
+	}
+	someObjects.clear();
+}
+
+
+// Looks up every live object by its handle, along with stale handles to removed objects. Some of the stale handles
+// belong to slots that have been recycled until their generation wrapped
+class ObjectLookupBenchmark : public Benchmark
+{
+	public :
+
+		// Construction
+		ObjectLookupBenchmark() : Benchmark( "VEObjectService::GetObject", 200 ),
+			myFoundCount( 0 ),
+			myWrappedCount( 0 )
+		{
+		}
+
+		// Registers the objects, then recycles the first few slots until their generations wrap, keeping every handle
+		// they've had. Returns false if a stale handle resolves before its slot's generation has come round again
+		virtual bool Setup() override
+		{
+			if( !CreateBenchmarkObjects(myObjects, BENCHMARK_HANDLE_OBJECT_COUNT, false) )
+			{
+				return false;
+			}
+
+			VEObjectService* objectService = VoxelEngine::GetInstance()->GetObjectService();
+
+			// The free list hands a removed slot straight back, so each cycle bumps the slot's generation by one
+			for( unsigned int i = 0; i < BENCHMARK_HANDLE_WRAP_SLOTS; i++ )
+			{
+				VEObject* object = myObjects[i];
+				for( unsigned int j = 0; j <= VE_HANDLE_GENERATION_MASK + 1; j++ )
+				{
+					myStaleIds.push_back( object->GetId() );
+
+					objectService->RemoveObject( object->GetId() );
+					objectService->RegisterObject( object, false );
+				}
+			}
+
+			// A stale handle only resolves if its generation matches the slot's again
+			myWrappedCount = 0;
+			for( unsigned int i = 0; i < myStaleIds.size(); i++ )
+			{
+				VEObject*	object		= myObjects[i / (VE_HANDLE_GENERATION_MASK + 2)];
+				bool		isWrapped	= VESlotMap<int>::GetGeneration( myStaleIds[i] ) == VESlotMap<int>::GetGeneration( object->GetId() );
+
+				if( isWrapped )
+				{
+					myWrappedCount++;
+				}
+
+				if( (objectService->GetObject(myStaleIds[i]) != NULL) != isWrapped )
+				{
+					return false;
+				}
+			}
+
+			myIds.reserve( myObjects.size() + myStaleIds.size() );
+			for( unsigned int i = 0; i < myObjects.size(); i++ )
+			{
+				myIds.push_back( myObjects[i]->GetId() );
+			}
+			myIds.insert( myIds.end(), myStaleIds.begin(), myStaleIds.end() );
+
+			// Looked up in a random order, the way the game looks objects up by id
+			unsigned int randomState = BENCHMARK_SEED;
+			for( unsigned int i = (unsigned int)myIds.size() - 1; i > 0; i-- )
+			{
+				std::swap( myIds[i], myIds[NextRandom(randomState) % (i + 1)] );
+			}
+
+			return true;
+		}
+
+		// Looks up every handle
+		virtual void Run() override
+		{
+			VEObjectService* objectService = VoxelEngine::GetInstance()->GetObjectService();
+
+			unsigned int foundCount = 0;
+			for( unsigned int i = 0; i < myIds.size(); i++ )
+			{
+				if( objectService->GetObject(myIds[i]) != NULL )
+				{
+					foundCount++;
+				}
+			}
+
+			// Keep the result around so the lookups can't be optimised away
+			myFoundCount = foundCount;
+		}
+
+		// Deletes the objects
+		virtual void Teardown() override
+		{
+			DeleteBenchmarkObjects( myObjects );
+			myIds.clear();
+			myStaleIds.clear();
+		}
+
+		// Prints how many of the stale handles resolved
+		virtual void PrintReport() override
+		{
+			printf( "    %u live & %u stale handles, %u stale handles resolved after their slot's generation wrapped\n",
+					BENCHMARK_HANDLE_OBJECT_COUNT, (unsigned int)myStaleIds.size(), myWrappedCount );
+		}
+
+	private :
+
+		std::vector<VEObject*>	myObjects;
+		std::vector<int>		myIds;
+		std::vector<int>		myStaleIds;
+
+		unsigned int			myFoundCount;
+		unsigned int			myWrappedCount;
+};
+
+
+// Walks a large number of dynamic objects without components, so only the cost of iterating the dense array and
+// calling each object's update is measured
+class ObjectIterationBenchmark : public Benchmark
+{
+	public :
+
+		// Construction
+		ObjectIterationBenchmark() : Benchmark( "VEObjectService::Iterate", 200 )
+		{
+		}
+
+		// Registers the objects
+		virtual bool Setup() override
+		{
+			return CreateBenchmarkObjects( myObjects, BENCHMARK_HANDLE_OBJECT_COUNT, true );
+		}
+
+		// Updates the objects
+		virtual void Run() override
+		{
+			VoxelEngine::GetInstance()->GetObjectService()->Update( BENCHMARK_TIME_STEP );
+		}
+
+		// Deletes the objects
+		virtual void Teardown() override
+		{
+			DeleteBenchmarkObjects( myObjects );
+		}
+
+	private :
+
+		std::vector<VEObject*>	myObjects;
+};
+
+
+// Removes random dynamic objects and registers them again, then looks up the handles they had before
+class ObjectChurnBenchmark : public Benchmark
+{
+	public :
+
+		// Construction
+		ObjectChurnBenchmark() : Benchmark( "VEObjectService::Churn", 200 ),
+			myRandomState( BENCHMARK_SEED ),
+			myChurnCount( 0 ),
+			myStaleFoundCount( 0 )
+		{
+		}
+
+		// Registers the objects
+		virtual bool Setup() override
+		{
+			return CreateBenchmarkObjects( myObjects, BENCHMARK_HANDLE_OBJECT_COUNT, true );
+		}
+
+		// Churns the objects
+		virtual void Run() override
+		{
+			VEObjectService* objectService = VoxelEngine::GetInstance()->GetObjectService();
+
+			for( unsigned int i = 0; i < BENCHMARK_HANDLE_CHURN_COUNT; i++ )
+			{
+				VEObject*	object	= myObjects[NextRandom(myRandomState) % myObjects.size()];
+				int			oldId	= object->GetId();
+
+				objectService->RemoveObject( oldId );
+				objectService->RegisterObject( object, true );
+
+				if( objectService->GetObject(oldId) != NULL )
+				{
+					myStaleFoundCount++;
+				}
+			}
+
+			myChurnCount += BENCHMARK_HANDLE_CHURN_COUNT;
+		}
+
+		// Deletes the objects
+		virtual void Teardown() override
+		{
+			DeleteBenchmarkObjects( myObjects );
+		}
+
+		// Prints how many of the removed objects' handles still resolved
+		virtual void PrintReport() override
+		{
+			printf( "    %u objects churned, %u stale handles resolved\n", myChurnCount, myStaleFoundCount );
+		}
+
+	private :
+
+		std::vector<VEObject*>	myObjects;
+
+		unsigned int			myRandomState;
+		unsigned int			myChurnCount;
+		unsigned int			myStaleFoundCount;
+};
+
+
+// Checks a batch of random movements against the world's voxels
+class ValidateMovementBenchmark : public Benchmark
+{
+	public :
+
+		// Construction
+		ValidateMovementBenchmark() : Benchmark( "VEPhysicsService::ValidateMovement", 50 ),
+			myValidCount( 0 )
+		{
+		}
+
+		// Generates the movements
+		virtual bool Setup() override
+		{
+			int		chunkDimensions = VoxelEngine::GetInstance()->GetChunkManager()->GetChunkDimensions();
+			float	worldWidth		= (float)(chunkDimensions * BENCHMARK_WORLD_WIDTH);
+			float	worldDepth		= (float)(chunkDimensions * BENCHMARK_WORLD_DEPTH);
+
+			unsigned int randomState = BENCHMARK_SEED;
+
+			myStartPositions.resize( BENCHMARK_MOVEMENT_COUNT );
+			myTargetPositions.resize( BENCHMARK_MOVEMENT_COUNT );
+			for( unsigned int i = 0; i < BENCHMARK_MOVEMENT_COUNT; i++ )
+			{
+				XMFLOAT3 startPosition( RandomFloat(randomState, worldWidth), RandomFloat(randomState, 30.0f), RandomFloat(randomState, worldDepth) );
+
+				myStartPositions[i]		= startPosition;
+				myTargetPositions[i]	= XMFLOAT3( startPosition.x + 0.5f, startPosition.y, startPosition.z + 0.5f );
+			}
+
+			return true;
+		}
+
+		// Validates every movement
+		virtual void Run() override
+		{
+			VEPhysicsService* physicsService = VoxelEngine::GetInstance()->GetPhysicsService();
+
+			unsigned int validCount = 0;
+			for( unsigned int i = 0; i < myStartPositions.size(); i++ )
+			{
+				XMFLOAT3 targetPosition = myTargetPositions[i];
+				if( physicsService->ValidateMovement(myStartPositions[i], targetPosition) )
+				{
+					validCount++;
+				}
+			}
+
+			// Keep the result around so the checks can't be optimised away
+			myValidCount = validCount;
+		}
+
+	private :
+
+		std::vector<XMFLOAT3>	myStartPositions;
+		std::vector<XMFLOAT3>	myTargetPositions;
+
+		unsigned int			myValidCount;
+};
+
+
+// A component that only touches its own data, so its system can update in parallel
+class BenchmarkComponent : public VEObjectComponent
+{
+	public :
+
+		// Construction
+		BenchmarkComponent( VEObject* aParent ) : VEObjectComponent( BT_BenchmarkComponent, aParent ),
+			myValue( 0.0f ),
+			myVelocity( 1.0f )
+		{
+		}
+
+		// Integrates the component's value
+		virtual void Update( float anElapsedTime ) override
+		{
+			myVelocity	-= myValue * anElapsedTime;
+			myValue		+= myVelocity * anElapsedTime;
+		}
+
+		// Nothing to initialise
+		virtual bool Initialise() override		{ return true; }
+
+		// Nothing to clean up
+		virtual void Cleanup() override			{}
+
+	protected :
+
+		// The component doesn't accept any messages
+		virtual void ProcessMessages( float anElapsedTime ) override
+		{
+		}
+
+	private :
+
+		float	myValue;
+		float	myVelocity;
+};
+
+
+// Updates a component on each of a large number of objects. The components are either heap allocated & kept in each
+// object's component map, updated through the objects' virtual updates the way every component was before component
+// systems, or constructed in a component system & updated by it in one loop, serially or across the workers
+class ComponentUpdateBenchmark : public Benchmark
+{
+	public :
+
+		// Construction
+		ComponentUpdateBenchmark( BenchmarkComponentModel aModel ) : Benchmark( GetModelName(aModel), 200 ),
+			myModel( aModel ),
+			mySystem( NULL )
+		{
+		}
+
+		// Creates the objects & their components
+		virtual bool Setup() override
+		{
+			VEComponentService* componentService = VoxelEngine::GetInstance()->GetComponentService();
+
+			if( myModel != BCM_ObjectMap )
+			{
+				mySystem = componentService->RegisterSystem<BenchmarkComponent>( BT_BenchmarkComponent );
+				mySystem->SetUpdateInParallel( myModel == BCM_ParallelSystem );
+			}
+
+			// Objects with system components aren't updated, their components are updated by the system
+			myObjects.reserve( BENCHMARK_COMPONENT_COUNT );
+			for( unsigned int i = 0; i < BENCHMARK_COMPONENT_COUNT; i++ )
+			{
+				VEObject* newObject = new VEObject();
+				myObjects.push_back( newObject );
+
+				if( !newObject->Initialise(myModel == BCM_ObjectMap) )
+				{
+					return false;
+				}
+
+				if( mySystem != NULL )
+				{
+					newObject->AddComponent( mySystem->CreateComponent(newObject) );
+				}
+				else
+				{
+					newObject->AddComponent( new BenchmarkComponent(newObject) );
+				}
+			}
+
+			return true;
+		}
+
+		// Updates the components
+		virtual void Run() override
+		{
+			if( mySystem != NULL )
+			{
+				VoxelEngine::GetInstance()->GetComponentService()->Update( BENCHMARK_TIME_STEP );
+			}
+			else
+			{
+				VoxelEngine::GetInstance()->GetObjectService()->Update( BENCHMARK_TIME_STEP );
+			}
+		}
+
+		// Deletes the objects, which deletes their components or returns them to the system
+		virtual void Teardown() override
+		{
+			for( unsigned int i = 0; i < myObjects.size(); i++ )
+			{
+				delete myObjects[i];
+				myObjects[i] = NULL;
+			}
+			myObjects.clear();
+		}
+
+	private :
+
+		// Returns the benchmark's name for a component model
+		static const char* GetModelName( BenchmarkComponentModel aModel )
+		{
+			switch( aModel )
+			{
+				case BCM_ObjectMap :
+					return "VEObject::Update (component maps)";
+
+				case BCM_System :
+					return "VEComponentService::Update (serial)";
+
+				default :
+					return "VEComponentService::Update";
+			}
+		}
+
+		BenchmarkComponentModel					myModel;
+		std::vector<VEObject*>					myObjects;
+		VEComponentSystem<BenchmarkComponent>*	mySystem;
+};
+
+
+// Posts a batch of events to the event bus and drains them
+class EventBusBenchmark : public Benchmark
+{
+	public :
+
+		// Construction
+		EventBusBenchmark() : Benchmark( "VEEventBus::Drain", 100 ),
+			myHandledCount( 0 )
+		{
+		}
+
+		// Registers the event handler
+		virtual bool Setup() override
+		{
+			return VoxelEngine::GetInstance()->GetEventBus()->RegisterHandler( BT_BenchmarkEvent, HandleEvent, this );
+		}
+
+		// Posts & drains the events
+		virtual void Run() override
+		{
+			VEEventBus* eventBus = VoxelEngine::GetInstance()->GetEventBus();
+
+			for( unsigned int i = 0; i < BENCHMARK_EVENT_COUNT; i++ )
+			{
+				eventBus->Post( new VEEvent(BT_BenchmarkEvent) );
+			}
+
+			eventBus->Drain( 1.0f );
+		}
+
+		// Unregisters the event handler
+		virtual void Teardown() override
+		{
+			VoxelEngine::GetInstance()->GetEventBus()->UnregisterHandler( BT_BenchmarkEvent, HandleEvent, this );
+		}
+
+	private :
+
+		// Counts the handled events
+		static void HandleEvent( VEEvent* anEvent, LPVOID aParameter )
+		{
+			static_cast<EventBusBenchmark*>( aParameter )->myHandledCount++;
+		}
+
+		unsigned int	myHandledCount;
+};
+
+
+// Streams chunks in & out the way the world will as the camera moves: a window of loaded chunks, where the oldest
+// chunk is unloaded each time a new one is loaded. Includes initialising each chunk's voxels
+class ChunkStreamingBenchmark : public Benchmark
+{
+	public :
+
+		// Construction
+		ChunkStreamingBenchmark() : Benchmark( "VEChunkManager::ChunkStreaming", 5 )
+		{
+		}
+
+		// Loads & unloads the chunks
+		virtual void Run() override
+		{
+			VEChunkManager* chunkManager = VoxelEngine::GetInstance()->GetChunkManager();
+
+			VEChunk* loadedChunks[BENCHMARK_STREAMING_WINDOW] = { NULL };
+			for( unsigned int i = 0; i < BENCHMARK_STREAMING_COUNT; i++ )
+			{
+				VEChunk*& slot = loadedChunks[i % BENCHMARK_STREAMING_WINDOW];
+				if( slot != NULL )
+				{
+					chunkManager->DestroyChunk( slot );
+				}
+
+				slot = chunkManager->CreateChunk( XMFLOAT3(0.0f, 0.0f, 0.0f), -1, -1 );
+			}
+
+			for( unsigned int i = 0; i < BENCHMARK_STREAMING_WINDOW; i++ )
+			{
+				chunkManager->DestroyChunk( loadedChunks[i] );
+			}
+		}
+
+		// Prints the chunk manager's pools
+		virtual void PrintReport() override
+		{
+			VEChunkManager* chunkManager = VoxelEngine::GetInstance()->GetChunkManager();
+
+			VEPoolStatistics statistics;
+			chunkManager->GetChunkPool()->GetStatistics( statistics );
+			PrintPoolStatistics( "Chunk pool", statistics );
+
+			chunkManager->GetVoxelPool()->GetStatistics( statistics );
+			PrintPoolStatistics( "Voxel pool", statistics );
+		}
+};
+
+
+// Times only the allocator for the streaming pattern above, with chunk sized voxel blocks. Run against both a pool
+// and the heap, so the two can be compared
+class VoxelBlockStreamingBenchmark : public Benchmark
+{
+	public :
+
+		// Construction
+		VoxelBlockStreamingBenchmark( bool aUsePool ) : Benchmark( aUsePool ? "VEPoolAllocator::VoxelBlockStreaming" : "HeapAllocator::VoxelBlockStreaming", 20 ),
+			myUsePool( aUsePool ),
+			myPool( NULL ),
+			myBlockSize( 0 )
+		{
+		}
+
+		// Creates the pool
+		virtual bool Setup() override
+		{
+			int chunkDimensions	= VoxelEngine::GetInstance()->GetChunkManager()->GetChunkDimensions();
+			myBlockSize			= chunkDimensions * chunkDimensions * chunkDimensions * sizeof(VEVoxel);
+
+			if( myUsePool )
+			{
+				myPool = new VEPoolAllocator( myBlockSize, VE_VOXEL_POOL_PAGE_SIZE, 0 );
+			}
+
+			return true;
+		}
+
+		// Allocates & frees the blocks. The first byte of each block is written, so the heap can't defer committing it
+		virtual void Run() override
+		{
+			void* loadedBlocks[BENCHMARK_STREAMING_WINDOW] = { NULL };
+			for( unsigned int i = 0; i < BENCHMARK_STREAMING_COUNT; i++ )
+			{
+				void*& slot = loadedBlocks[i % BENCHMARK_STREAMING_WINDOW];
+				FreeBlock( slot );
+
+				slot = myUsePool ? myPool->Allocate() : malloc( myBlockSize );
+				*(unsigned char*)slot = 0;
+			}
+
+			for( unsigned int i = 0; i < BENCHMARK_STREAMING_WINDOW; i++ )
+			{
+				FreeBlock( loadedBlocks[i] );
+			}
+		}
+
+		// Keeps the pool's usage for the report & deletes the pool
+		virtual void Teardown() override
+		{
+			if( myPool != NULL )
+			{
+				myPool->GetStatistics( myPoolStatistics );
+
+				delete myPool;
+				myPool = NULL;
+			}
+		}
+
+		// Prints the pool's usage
+		virtual void PrintReport() override
+		{
+			if( myUsePool )
+			{
+				PrintPoolStatistics( "Voxel block pool", myPoolStatistics );
+			}
+		}
+
+	private :
+
+		// Frees a block, if there is one
+		void FreeBlock( void* aBlock )
+		{
+			if( aBlock == NULL )
+			{
+				return;
+			}
+
+			if( myUsePool )
+			{
+				myPool->Free( aBlock );
+			}
+			else
+			{
+				free( aBlock );
+			}
+		}
+
+		bool				myUsePool;
+		VEPoolAllocator*	myPool;
+		VEPoolStatistics	myPoolStatistics;
+		unsigned int		myBlockSize;
+};
+
+
+// Returns the process' resident memory in bytes
+static unsigned long long GetResidentMemory()
+{
+	PROCESS_MEMORY_COUNTERS counters;
+	if( !GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) )
+	{
+		return 0;
+	}
+
+	return counters.WorkingSetSize;
+}
+
+
+// Prints the process' resident memory, the pages of the process that are in physical memory
+static void PrintResidentMemory()
+{
+	PROCESS_MEMORY_COUNTERS counters;
+	if( GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) )
+	{
+		printf( "    %.2fMB resident, %.2fMB at peak\n", (double)counters.WorkingSetSize / (1024.0 * 1024.0),
+				(double)counters.PeakWorkingSetSize / (1024.0 * 1024.0) );
+	}
+}
+
+
+// Saves the world's chunks to region files, or loads them back in to chunks of their own. Saves are timed until every
+// chunk has been written by the save thread, loads decode straight from the mapped region files
+class WorldStoreBenchmark : public Benchmark
+{
+	public :
+
+		// Construction
+		WorldStoreBenchmark( bool anIsLoading ) : Benchmark( anIsLoading ? "VEWorldStore::LoadChunks" : "VEWorldStore::SaveChunks", 20 ),
+			myIsLoading( anIsLoading ),
+			myChunkCount( 0 ),
+			myTime( 0 ),
+			myIsMatching( true ),
+			myMappedSize( 0 ),
+			myRegionCount( 0 )
+		{
+		}
+
+		// Opens an empty world. The load benchmark saves the world to it, and creates the chunks it loads in to
+		virtual bool Setup() override
+		{
+			DeleteWorld();
+
+			if( !myWorldStore.Open(BENCHMARK_WORLD_STORE_DIRECTORY) )
+			{
+				return false;
+			}
+
+			if( myIsLoading )
+			{
+				VEChunkManager*					chunkManager	= VoxelEngine::GetInstance()->GetChunkManager();
+				const std::vector<VEChunk*>&	chunks			= chunkManager->GetChunks();
+				for( unsigned int i = 0; i < chunks.size(); i++ )
+				{
+					myWorldStore.SaveChunk( chunks[i] );
+
+					VEChunk* chunk = chunkManager->CreateChunk( chunks[i]->GetPosition(), chunks[i]->GetGridX(), chunks[i]->GetGridZ() );
+					if( chunk == NULL )
+					{
+						return false;
+					}
+					myChunks.push_back( chunk );
+				}
+
+				myWorldStore.Flush();
+			}
+
+			return true;
+		}
+
+		// Saves or loads every chunk in the world
+		virtual void Run() override
+		{
+			long long startTime = VEProfiler::GetTime();
+
+			if( myIsLoading )
+			{
+				for( unsigned int i = 0; i < myChunks.size(); i++ )
+				{
+					myIsMatching &= myWorldStore.LoadChunk( myChunks[i] );
+				}
+				myChunkCount += (unsigned int)myChunks.size();
+			}
+			else
+			{
+				const std::vector<VEChunk*>& chunks = VoxelEngine::GetInstance()->GetChunkManager()->GetChunks();
+				for( unsigned int i = 0; i < chunks.size(); i++ )
+				{
+					myWorldStore.SaveChunk( chunks[i] );
+				}
+				myWorldStore.Flush();
+
+				myChunkCount += (unsigned int)chunks.size();
+			}
+
+			myTime += VEProfiler::GetTime() - startTime;
+		}
+
+		// Checks the loaded chunks match the world, then closes the world & destroys the chunks
+		virtual void Teardown() override
+		{
+			VEChunkManager* chunkManager = VoxelEngine::GetInstance()->GetChunkManager();
+
+			for( unsigned int i = 0; i < myChunks.size(); i++ )
+			{
+				VEChunk* source = chunkManager->GetChunk( myChunks[i]->GetGridX(), myChunks[i]->GetGridZ() );
+
+				unsigned int voxelCount = (unsigned int)( source->GetDimensions() * source->GetDimensions() * source->GetDimensions() );
+				for( unsigned int j = 0; j < voxelCount && myIsMatching; j++ )
+				{
+					VEVoxel& sourceVoxel = source->GetVoxels()[j];
+					VEVoxel& loadedVoxel = myChunks[i]->GetVoxels()[j];
+
+					myIsMatching = sourceVoxel.GetType() == loadedVoxel.GetType() && sourceVoxel.GetEnabled() == loadedVoxel.GetEnabled();
+				}
+
+				chunkManager->DestroyChunk( myChunks[i] );
+			}
+			myChunks.clear();
+
+			// Measured before closing, while the region files are still mapped
+			myMappedSize	= myWorldStore.GetMappedSize();
+			myRegionCount	= myWorldStore.GetRegionCount();
+
+			myWorldStore.Close();
+		}
+
+		// Prints the throughput, the size of the chunks on disk and the memory used
+		virtual void PrintReport() override
+		{
+			LARGE_INTEGER frequency;
+			QueryPerformanceFrequency( &frequency );
+
+			double seconds = (double)myTime / (double)frequency.QuadPart;
+			printf( "    %.1f chunks/s\n", seconds > 0.0 ? (double)myChunkCount / seconds : 0.0 );
+
+			if( myWorldStore.GetSavedChunkCount() > 0 )
+			{
+				int			dimensions	= VoxelEngine::GetInstance()->GetChunkManager()->GetChunkDimensions();
+				double		voxelBytes	= (double)dimensions * dimensions * dimensions * sizeof(VEVoxel);
+				double		recordBytes	= (double)myWorldStore.GetSavedBytes() / (double)myWorldStore.GetSavedChunkCount();
+
+				printf( "    %.1fKB per chunk on disk, %.1f:1 against the voxels in memory, %u failed saves\n", recordBytes / 1024.0,
+						voxelBytes / recordBytes, myWorldStore.GetFailedSaveCount() );
+			}
+
+			printf( "    %.2fMB mapped from %u region files\n", (double)myMappedSize / (1024.0 * 1024.0), myRegionCount );
+			PrintResidentMemory();
+
+			if( myIsLoading )
+			{
+				printf( "    %s\n", myIsMatching ? "Loaded chunks match the world" : "Loaded chunks DON'T match the world" );
+			}
+		}
+
+	private :
+
+		// Deletes the files saved by previous runs
+		static void DeleteWorld()
+		{
+			std::wstring		directory = BENCHMARK_WORLD_STORE_DIRECTORY;
+			WIN32_FIND_DATAW	findData;
+
+			HANDLE findHandle = FindFirstFileW( (directory + L"*").c_str(), &findData );
+			if( findHandle == INVALID_HANDLE_VALUE )
+			{
+				return;
+			}
+
+			do
+			{
+				if( (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0 )
+				{
+					DeleteFileW( (directory + findData.cFileName).c_str() );
+				}
+			}
+			while( FindNextFileW(findHandle, &findData) );
+
+			FindClose( findHandle );
+		}
+
+		bool					myIsLoading;
+		VEWorldStore			myWorldStore;
+		std::vector<VEChunk*>	myChunks;
+
+		unsigned int			myChunkCount;
+		long long				myTime;
+		bool					myIsMatching;
+
+		unsigned long long		myMappedSize;
+		unsigned int			myRegionCount;
+};
+
+
+// Reads a chunk's voxels from several threads while another thread keeps editing it, the way physics queries, snapshots
+// and edits share a chunk. Run with the readers sharing the chunk's voxel lock, and with every reader taking it
+// exclusively, to show what the reader-writer lock buys
+class ChunkContentionBenchmark : public Benchmark
+{
+	public :
+
+		// Construction
+		ChunkContentionBenchmark( bool aUseSharedLock ) : Benchmark( aUseSharedLock ? "VEChunk::ContendedReads (shared)" : "VEChunk::ContendedReads (exclusive)", 10 ),
+			myUseSharedLock( aUseSharedLock ),
+			myChunk( NULL ),
+			myStopWriter( false ),
+			mySolidCount( 0 ),
+			myWriteCount( 0 ),
+			myReadCount( 0 ),
+			myReadTime( 0 )
+		{
+		}
+
+		// Picks the chunk the threads share
+		virtual bool Setup() override
+		{
+			myChunk = GetBenchmarkChunk();
+			return myChunk != NULL;
+		}
+
+		// Starts the writer, then times the readers
+		virtual void Run() override
+		{
+			myStopWriter = false;
+
+			VEThread writer;
+			if( !writer.Start(WriterThread, this) )
+			{
+				return;
+			}
+
+			VEThread readers[BENCHMARK_CONTENTION_READERS];
+
+			long long startTime = VEProfiler::GetTime();
+			for( unsigned int i = 0; i < BENCHMARK_CONTENTION_READERS; i++ )
+			{
+				readers[i].Start( ReaderThread, this );
+			}
+
+			for( unsigned int i = 0; i < BENCHMARK_CONTENTION_READERS; i++ )
+			{
+				readers[i].Join();
+			}
+			myReadTime	+= VEProfiler::GetTime() - startTime;
+			myReadCount	+= BENCHMARK_CONTENTION_READERS * BENCHMARK_CONTENTION_READS;
+
+			myStopWriter = true;
+			writer.Join();
+		}
+
+		// Prints the readers' combined throughput
+		virtual void PrintReport() override
+		{
+			LARGE_INTEGER frequency;
+			QueryPerformanceFrequency( &frequency );
+
+			double seconds = (double)myReadTime / (double)frequency.QuadPart;
+			printf( "    %u readers & 1 writer: %.2f million reads/s, %u writes\n", BENCHMARK_CONTENTION_READERS,
+					seconds > 0.0 ? (double)myReadCount / seconds / 1000000.0 : 0.0, myWriteCount.load() );
+		}
+
+	private :
+
+		// Reads voxels across the whole chunk
+		static unsigned int ReaderThread( void* aBenchmark )
+		{
+			ChunkContentionBenchmark*	benchmark	= reinterpret_cast<ChunkContentionBenchmark*>( aBenchmark );
+			VEChunk*					chunk		= benchmark->myChunk;
+			int							dimensions	= chunk->GetDimensions();
+
+			unsigned int solidCount = 0;
+			for( unsigned int i = 0; i < BENCHMARK_CONTENTION_READS; i++ )
+			{
+				int x = i % dimensions;
+				int y = (i / dimensions) % dimensions;
+				int z = (i / (dimensions * dimensions)) % dimensions;
+
+				if( benchmark->myUseSharedLock )
+				{
+					solidCount += chunk->GetVoxelEnabled( x, y, z ) ? 1 : 0;
+				}
+				else
+				{
+					VEScopedLock<VESharedMutex> voxelLock( chunk->GetVoxelLock() );
+					solidCount += chunk->GetVoxel( x, y, z )->GetEnabled() ? 1 : 0;
+				}
+			}
+
+			// Stops the reads from being optimised away
+			benchmark->mySolidCount += solidCount;
+			return 0;
+		}
+
+		// Keeps flipping a voxel at the top of the chunk until the readers have finished, then puts it back
+		static unsigned int WriterThread( void* aBenchmark )
+		{
+			ChunkContentionBenchmark*	benchmark	= reinterpret_cast<ChunkContentionBenchmark*>( aBenchmark );
+			VEChunk*					chunk		= benchmark->myChunk;
+			VEVoxel*					voxel		= chunk->GetVoxel( 0, chunk->GetDimensions() - 1, 0 );
+
+			bool wasEnabled = chunk->GetVoxelEnabled( 0, chunk->GetDimensions() - 1, 0 );
+			while( !benchmark->myStopWriter )
+			{
+				{
+					VEScopedLock<VESharedMutex> voxelLock( chunk->GetVoxelLock() );
+					voxel->SetEnabled( !voxel->GetEnabled() );
+				}
+
+				benchmark->myWriteCount++;
+				VEThread::YieldThread();
+			}
+
+			VEScopedLock<VESharedMutex> voxelLock( chunk->GetVoxelLock() );
+			voxel->SetEnabled( wasEnabled );
+
+			return 0;
+		}
+
+		bool						myUseSharedLock;
+		VEChunk*					myChunk;
+
+		std::atomic<bool>			myStopWriter;
+		std::atomic<unsigned int>	mySolidCount;
+		std::atomic<unsigned int>	myWriteCount;
+
+		unsigned long long			myReadCount;
+		long long					myReadTime;
+};
+
+
+// Runs whole engine frames over a world full of dynamic objects, with the frame's tasks on the job system or one
+// after another on the main thread. Reports the average time of each task in the frame graph
+class FrameUpdateBenchmark : public Benchmark
+{
+	public :
+
+		// Construction
+		FrameUpdateBenchmark( bool aUseTaskGraph ) :
+			Benchmark( aUseTaskGraph ? "VoxelEngine::Update (task graph)" : "VoxelEngine::Update (serial)", 200 ),
+			myUseTaskGraph( aUseTaskGraph ),
+			myFrameCount( 0 )
+		{
+		}
+
+		// Creates & registers the objects, and picks how the frame's tasks are run
+		virtual bool Setup() override
+		{
+			unsigned int randomState = BENCHMARK_SEED;
+
+			myObjects.reserve( BENCHMARK_OBJECT_COUNT );
+			for( unsigned int i = 0; i < BENCHMARK_OBJECT_COUNT; i++ )
+			{
+				BenchmarkObject* newObject = new BenchmarkObject();
+				newObject->SetPosition( XMFLOAT3(RandomFloat(randomState, 256.0f), 20.0f, RandomFloat(randomState, 256.0f)) );
+
+				if( !newObject->Initialise(true) )
+				{
+					delete newObject;
+					return false;
+				}
+
+				myObjects.push_back( newObject );
+			}
+
+			VoxelEngine* voxelEngine = VoxelEngine::GetInstance();
+			voxelEngine->SetUseTaskGraph( myUseTaskGraph );
+
+			myTaskTimes.assign( voxelEngine->GetFrameGraph()->GetTaskCount(), 0.0 );
+			myTaskStartTimes.assign( voxelEngine->GetFrameGraph()->GetTaskCount(), 0.0 );
+
+			return true;
+		}
+
+		// Runs a frame, and adds up the time each task took
+		virtual void Run() override
+		{
+			VoxelEngine* voxelEngine = VoxelEngine::GetInstance();
+			voxelEngine->Update( BENCHMARK_TIME_STEP );
+
+			VETaskGraph* frameGraph = voxelEngine->GetFrameGraph();
+			for( unsigned int i = 0; i < frameGraph->GetTaskCount(); i++ )
+			{
+				myTaskTimes[i]		+= frameGraph->GetTaskTime( i );
+				myTaskStartTimes[i]	+= frameGraph->GetTaskStartTime( i );
+			}
+			myFrameCount++;
+		}
+
+		// Deletes the objects, and puts the engine back to running its tasks on the job system
+		virtual void Teardown() override
+		{
+			for( unsigned int i = 0; i < myObjects.size(); i++ )
+			{
+				delete myObjects[i];
+				myObjects[i] = NULL;
+			}
+			myObjects.clear();
+
+			VoxelEngine::GetInstance()->SetUseTaskGraph( true );
+		}
+
+		// Prints the average start & run time of each task
+		virtual void PrintReport() override
+		{
+			if( myFrameCount == 0 )
+			{
+				return;
+			}
+
+			VETaskGraph* frameGraph = VoxelEngine::GetInstance()->GetFrameGraph();
+
+			printf( "    %-16s %10s %10s\n", "Task", "Start ms", "Time ms" );
+			for( unsigned int i = 0; i < myTaskTimes.size(); i++ )
+			{
+				printf( "    %-16s %10.3f %10.3f\n", frameGraph->GetTaskName(i), myTaskStartTimes[i] / myFrameCount, myTaskTimes[i] / myFrameCount );
+			}
+
+			if( myUseTaskGraph )
+			{
+				printf( "    %u job system workers\n", VoxelEngine::GetInstance()->GetJobSystem()->GetWorkerCount() );
+			}
+		}
+
+	private :
+
+		bool							myUseTaskGraph;
+		std::vector<BenchmarkObject*>	myObjects;
+
+		unsigned int					myFrameCount;
+		std::vector<double>				myTaskTimes;
+		std::vector<double>				myTaskStartTimes;
+};
+
+
+// Runs whole engine frames with a present that takes BENCHMARK_PRESENT_TIME, drawing each frame straight away or on
+// the render thread while the next frame is simulated. Reports the input latency, from reading the input to the
+// frame being presented
+class PipelinedRenderBenchmark : public Benchmark
+{
+	public :
+
+		// Construction
+		PipelinedRenderBenchmark( bool aPipelined ) :
+			Benchmark( aPipelined ? "VoxelEngine::Update (pipelined render)" : "VoxelEngine::Update (inline render)", 200 ),
+			myPipelined( aPipelined ),
+			myAverageLatency( 0.0 ),
+			myRenderedCount( 0 )
+		{
+		}
+
+		// Creates & registers the objects, slows the present down and starts the render thread if need be
+		virtual bool Setup() override
+		{
+			VoxelEngine* voxelEngine = VoxelEngine::GetInstance();
+			if( !voxelEngine->IsHeadless() )
+			{
+				return false;
+			}
+
+			unsigned int randomState = BENCHMARK_SEED;
+
+			myObjects.reserve( BENCHMARK_OBJECT_COUNT );
+			for( unsigned int i = 0; i < BENCHMARK_OBJECT_COUNT; i++ )
+			{
+				BenchmarkObject* newObject = new BenchmarkObject();
+				newObject->SetPosition( XMFLOAT3(RandomFloat(randomState, 256.0f), 20.0f, RandomFloat(randomState, 256.0f)) );
+
+				if( !newObject->Initialise(true) )
+				{
+					delete newObject;
+					return false;
+				}
+
+				myObjects.push_back( newObject );
+			}
+
+			static_cast<VENullRenderBackend*>( voxelEngine->GetRenderBackend() )->SetPresentTime( BENCHMARK_PRESENT_TIME );
+
+			VERenderPipeline* renderPipeline = voxelEngine->GetRenderPipeline();
+			renderPipeline->SetPipelined( myPipelined );
+			renderPipeline->ResetStatistics();
+			myRenderedCount = renderPipeline->GetRenderedFrameCount();
+
+			return true;
+		}
+
+		// Runs a frame
+		virtual void Run() override
+		{
+			VoxelEngine::GetInstance()->Update( BENCHMARK_TIME_STEP );
+		}
+
+		// Draws the queued frames, then deletes the objects and puts the render pipeline & backend back
+		virtual void Teardown() override
+		{
+			VoxelEngine*		voxelEngine		= VoxelEngine::GetInstance();
+			VERenderPipeline*	renderPipeline	= voxelEngine->GetRenderPipeline();
+
+			renderPipeline->Flush();
+			myAverageLatency	= renderPipeline->GetAverageLatency();
+			myRenderedCount		= renderPipeline->GetRenderedFrameCount() - myRenderedCount;
+
+			renderPipeline->SetPipelined( false );
+			static_cast<VENullRenderBackend*>( voxelEngine->GetRenderBackend() )->SetPresentTime( 0.0 );
+
+			for( unsigned int i = 0; i < myObjects.size(); i++ )
+			{
+				delete myObjects[i];
+				myObjects[i] = NULL;
+			}
+			myObjects.clear();
+		}
+
+		// Prints the average input latency
+		virtual void PrintReport() override
+		{
+			printf( "    %.2fms input latency on average over %u frames, %.1fms present\n", myAverageLatency, myRenderedCount, BENCHMARK_PRESENT_TIME );
+		}
+
+	private :
+
+		bool							myPipelined;
+		std::vector<BenchmarkObject*>	myObjects;
+
+		double							myAverageLatency;
+		unsigned int					myRenderedCount;
+};
+
+
+// ------------------ Functions -----------------
+
+// Adds the engine's CPU benchmarks to the runner. The engine must have been initialised and the benchmark
+// world generated first
+void AddEngineBenchmarks( BenchmarkRunner* aRunner )
+{
+	assert( aRunner != NULL );
+
+	aRunner->AddBenchmark( new NoiseMapBuildBenchmark() );
+	aRunner->AddBenchmark( new ApplyHeightMapBenchmark() );
+	aRunner->AddBenchmark( new CaptureSnapshotBenchmark() );
+	aRunner->AddBenchmark( new CalculateVisibilityBenchmark() );
+	aRunner->AddBenchmark( new BuildMeshBenchmark(false) );
+	aRunner->AddBenchmark( new BuildMeshBenchmark(true) );
+	aRunner->AddBenchmark( new ChunkRebuildBenchmark() );
+	aRunner->AddBenchmark( new ObjectUpdateBenchmark() );
+	aRunner->AddBenchmark( new ObjectLookupBenchmark() );
+	aRunner->AddBenchmark( new ObjectIterationBenchmark() );
+	aRunner->AddBenchmark( new ObjectChurnBenchmark() );
+	aRunner->AddBenchmark( new ValidateMovementBenchmark() );
+	aRunner->AddBenchmark( new ComponentUpdateBenchmark(BCM_ObjectMap) );
+	aRunner->AddBenchmark( new ComponentUpdateBenchmark(BCM_System) );
+	aRunner->AddBenchmark( new ComponentUpdateBenchmark(BCM_ParallelSystem) );
+	aRunner->AddBenchmark( new EventBusBenchmark() );
+	aRunner->AddBenchmark( new ChunkStreamingBenchmark() );
+	aRunner->AddBenchmark( new VoxelBlockStreamingBenchmark(true) );
+	aRunner->AddBenchmark( new VoxelBlockStreamingBenchmark(false) );
+	aRunner->AddBenchmark( new WorldStoreBenchmark(false) );
+	aRunner->AddBenchmark( new WorldStoreBenchmark(true) );
+	aRunner->AddBenchmark( new ChunkContentionBenchmark(true) );
+	aRunner->AddBenchmark( new ChunkContentionBenchmark(false) );
+	aRunner->AddBenchmark( new FrameUpdateBenchmark(false) );
+	aRunner->AddBenchmark( new FrameUpdateBenchmark(true) );
+	aRunner->AddBenchmark( new PipelinedRenderBenchmark(false) );
+	aRunner->AddBenchmark( new PipelinedRenderBenchmark(true) );
+}
+
+
+// Runs the engine until every chunk has been built, then checks that steady-state frames make no heap allocations
+// on the main thread. Prints the allocations accounted against each memory tag, returns false if any frame allocated
+bool CheckFrameAllocations()
+{
+	if( !VEMemoryTracker::IsEnabled() )
+	{
+		printf( "Allocation tracking isn't enabled in this build, define VE_MEMORY_TRACKING\n" );
+		return false;
+	}
+
+	VoxelEngine*		voxelEngine		= VoxelEngine::GetInstance();
+	VEChunkManager*		chunkManager	= voxelEngine->GetChunkManager();
+	VEThreadManager*	threadManager	= voxelEngine->GetThreadManager();
+
+	// Let the chunk builds finish, the frames that start them are expected to allocate
+	unsigned int settleFrames			= 0;
+	unsigned int settleAllocationCount	= 0;
+	for( ; settleFrames < BENCHMARK_SETTLE_FRAMES; settleFrames++ )
+	{
+		voxelEngine->Update( BENCHMARK_TIME_STEP );
+		settleAllocationCount += voxelEngine->GetFrameAllocations();
+
+		bool isSettled = threadManager->GetThreadCount() == 0;
+		
+		const std::vector<VEChunk*>& chunks = chunkManager->GetChunks();
+		for( unsigned int i = 0; i < chunks.size() && isSettled; i++ )
+		{
+			isSettled = !chunks[i]->GetIsDirty() && !chunks[i]->GetIsBuilding();
+		}
+
+		if( isSettled )
+		{
+			break;
+		}
+
+		Sleep( 1 );
+	}
+
+	if( settleFrames == BENCHMARK_SETTLE_FRAMES )
+	{
+		printf( "The world didn't settle within %u frames\n", BENCHMARK_SETTLE_FRAMES );
+		return false;
+	}
+
+	// One more frame picks up anything posted by the last builds
+	voxelEngine->Update( BENCHMARK_TIME_STEP );
+	VEMemoryTracker::ResetPeaks();
+
+	unsigned int allocatingFrames	= 0;
+	unsigned int allocationCount	= 0;
+	for( unsigned int i = 0; i < BENCHMARK_STEADY_STATE_FRAMES; i++ )
+	{
+		voxelEngine->Update( BENCHMARK_TIME_STEP );
+
+		if( voxelEngine->GetFrameAllocations() > 0 )
+		{
+			allocatingFrames++;
+			allocationCount += voxelEngine->GetFrameAllocations();
+		}
+	}
+
+	printf( "%-16s %12s %14s %14s\n", "Tag", "Allocations", "Live bytes", "Peak bytes" );
+	for( unsigned int i = 0; i < MEM_Max; i++ )
+	{
+		VEMemoryTagStatistics statistics;
+		VEMemoryTracker::GetTagStatistics( (MemoryTag)i, statistics );
+
+		printf( "%-16s %12u %14u %14u\n", VEMemoryTracker::GetTagName((MemoryTag)i), statistics.myAllocationCount,
+				(unsigned int)statistics.myLiveBytes, (unsigned int)statistics.myPeakBytes );
+	}
+
+	VEFrameAllocator* frameAllocator = voxelEngine->GetFrameAllocator();
+	printf( "Frame allocator: %u of %u bytes used at peak, %u overflowed to the heap\n", (unsigned int)frameAllocator->GetPeakUsedBytes(),
+			(unsigned int)frameAllocator->GetBufferSize(), frameAllocator->GetOverflowCount() );
+
+	printf( "Heap allocations per frame: %.2f while settling, %.2f in steady state\n", (float)settleAllocationCount / (float)(settleFrames + 1),
+			(float)allocationCount / (float)BENCHMARK_STEADY_STATE_FRAMES );
+
+	printf( "Settled after %u frames, %u of %u steady-state frames allocated (%u allocations)\n", settleFrames + 1,
+			allocatingFrames, BENCHMARK_STEADY_STATE_FRAMES, allocationCount );
+
+	return allocatingFrames == 0;
+}
+
+
+// Paces frames that each do the supplied work with a manual clock, and checks the simulation keeps up with the clock
+// without drifting. Returns false & prints why if not
+static bool CheckScheduledFrames( const char* aName, double aFrameRateCap, double aWork, bool isExpectedToWait )
+{
+	VEManualClock clock;
+	clock.SetOversleep( clock.GetWaitPrecision() * 0.8 );
+
+	VEFrameScheduler scheduler( &clock );
+	scheduler.SetFrameRateCap( aFrameRateCap );
+	scheduler.Start();
+
+	double			startTime		= clock.GetTime();
+	double			timeStep		= scheduler.GetTimeStep();
+	unsigned int	wrongStepFrames	= 0;
+
+	for( unsigned int i = 0; i < BENCHMARK_SCHEDULER_FRAMES; i++ )
+	{
+		unsigned int stepCount = scheduler.BeginFrame();
+
+		// After the first frame, a frame's steps should cover the time since the last frame to within a step
+		unsigned int expectedSteps = (unsigned int)( scheduler.GetFrameTime() / timeStep + 0.5 );
+		if( i > 0 && (stepCount + 1 < expectedSteps || stepCount > expectedSteps + 1) )
+		{
+			wrongStepFrames++;
+		}
+
+		clock.Advance( aWork );
+	}
+
+	// The simulation should be no more than a frame behind the clock, however many frames have run
+	double elapsedTime		= clock.GetTime() - startTime;
+	double simulatedTime	= (double)scheduler.GetSimulationStepCount() * timeStep;
+	double lag				= elapsedTime - simulatedTime;
+	double framePeriod		= std::max( scheduler.GetFramePeriod(), aWork );
+
+	printf( "%-10s %8.3fs elapsed %8.3fs simulated %6.1f%% idle %6.1f%% spinning\n", aName, elapsedTime, simulatedTime,
+			clock.GetWaitedTime() * 100.0 / elapsedTime, clock.GetPausedTime() * 100.0 / elapsedTime );
+
+	bool isPassed = true;
+	if( lag < 0.0 || lag > framePeriod + timeStep )
+	{
+		printf( "  The simulation drifted %.4fs from the clock\n", lag );
+		isPassed = false;
+	}
+
+	if( wrongStepFrames > 0 )
+	{
+		printf( "  %u frames ran the wrong number of steps\n", wrongStepFrames );
+		isPassed = false;
+	}
+
+	if( aFrameRateCap > 0.0 && elapsedTime < (double)(BENCHMARK_SCHEDULER_FRAMES - 1) / aFrameRateCap )
+	{
+		printf( "  Frames ran faster than the cap\n" );
+		isPassed = false;
+	}
+
+	if( isExpectedToWait != (clock.GetWaitedTime() > 0.0) )
+	{
+		printf( isExpectedToWait ? "  Frames didn't sleep\n" : "  Uncapped frames slept\n" );
+		isPassed = false;
+	}
+
+	return isPassed;
+}
+
+
+// Checks the frame scheduler's pacing against a manual clock, then paces empty frames with the system clock and prints
+// how closely the deadlines were met & the CPU used. Returns false if a manual clock check fails
+bool CheckFrameScheduler()
+{
+	bool isPassed = true;
+
+	isPassed &= CheckScheduledFrames( "Light", VE_DEFAULT_FRAME_RATE_CAP, BENCHMARK_SCHEDULER_LIGHT_WORK, true );
+	isPassed &= CheckScheduledFrames( "Heavy", VE_DEFAULT_FRAME_RATE_CAP, BENCHMARK_SCHEDULER_HEAVY_WORK, false );
+	isPassed &= CheckScheduledFrames( "Uncapped", 0.0, BENCHMARK_SCHEDULER_LIGHT_WORK, false );
+
+	// A stall runs the most steps allowed and drops the rest of the time
+	{
+		VEManualClock		clock;
+		VEFrameScheduler	scheduler( &clock );
+		scheduler.Start();
+
+		clock.Advance( 1.0 );
+		unsigned int stepCount = scheduler.BeginFrame();
+
+		printf( "%-10s %8u steps %8.3fs dropped\n", "Stall", stepCount, scheduler.GetDroppedTime() );
+		if( stepCount != scheduler.GetMaxSimulationSteps() || scheduler.GetDroppedTime() <= 0.0 || scheduler.GetInterpolation() >= 1.0 )
+		{
+			printf( "  The stall wasn't clamped\n" );
+			isPassed = false;
+		}
+	}
+
+	// Real frames, for the deadline precision & CPU use on this machine
+	{
+		VESystemClock		clock;
+		VEFrameScheduler	scheduler( &clock );
+
+		FILETIME creationTime, exitTime, kernelStart, userStart, kernelEnd, userEnd;
+		GetProcessTimes( GetCurrentProcess(), &creationTime, &exitTime, &kernelStart, &userStart );
+
+		unsigned int	frameCount	= (unsigned int)VE_DEFAULT_FRAME_RATE_CAP;
+		double			worstMiss	= 0.0;
+
+		scheduler.Start();
+		double startTime = clock.GetTime();
+
+		for( unsigned int i = 0; i < frameCount; i++ )
+		{
+			scheduler.BeginFrame();
+
+			// Frame n is due n periods after the first, the miss is how long after that it actually started
+			double frameMiss = clock.GetTime() - startTime - (double)i * scheduler.GetFramePeriod();
+			worstMiss = std::max( worstMiss, frameMiss );
+		}
+
+		GetProcessTimes( GetCurrentProcess(), &creationTime, &exitTime, &kernelEnd, &userEnd );
+
+		ULARGE_INTEGER kernelBegin, kernelFinish, userBegin, userFinish;
+		kernelBegin.LowPart		= kernelStart.dwLowDateTime;	kernelBegin.HighPart	= kernelStart.dwHighDateTime;
+		kernelFinish.LowPart	= kernelEnd.dwLowDateTime;		kernelFinish.HighPart	= kernelEnd.dwHighDateTime;
+		userBegin.LowPart		= userStart.dwLowDateTime;		userBegin.HighPart		= userStart.dwHighDateTime;
+		userFinish.LowPart		= userEnd.dwLowDateTime;		userFinish.HighPart		= userEnd.dwHighDateTime;
+
+		// Process times are in 100 nanosecond units
+		double cpuTime		= (double)( (kernelFinish.QuadPart - kernelBegin.QuadPart) + (userFinish.QuadPart - userBegin.QuadPart) ) / 10000000.0;
+		double elapsedTime	= clock.GetTime() - startTime;
+
+		printf( "%-10s %8.3fs elapsed for %u frames, %.1f%% CPU, %.3fms worst deadline miss, spinning %.2fms before each deadline\n",
+				"System", elapsedTime, frameCount, cpuTime * 100.0 / elapsedTime, worstMiss * 1000.0, scheduler.GetSpinTime() * 1000.0 );
+	}
+
+	return isPassed;
+}
+
+
+// What the input latency check saw: the update each replayed event reached the simulation in, and the update whose
+// frame late latched the mouse movement. Zero until seen
+struct InputLatencyRecord
+{
+	VEInputService*	myInputService;
+	unsigned int	myKeyUpdate;
+	unsigned int	myMouseUpdate;
+	unsigned int	myLatchUpdate;
+};
+
+
+// Records the update each replayed event is delivered in
+static void RecordInputEvent( const VEInputEvent& anEvent, void* aRecord )
+{
+	InputLatencyRecord* record = reinterpret_cast<InputLatencyRecord*>( aRecord );
+
+	if( anEvent.myType == IE_KeyDown && record->myKeyUpdate == 0 )
+	{
+		record->myKeyUpdate = record->myInputService->GetUpdateCount();
+	}
+	else if( anEvent.myType == IE_MouseMove && record->myMouseUpdate == 0 )
+	{
+		record->myMouseUpdate = record->myInputService->GetUpdateCount();
+	}
+}
+
+
+// Records the update whose frame first late latches any mouse movement
+static void RecordLateLatch( VEBasicCamera& aCamera, long aMouseX, long aMouseY, void* aRecord )
+{
+	InputLatencyRecord* record = reinterpret_cast<InputLatencyRecord*>( aRecord );
+
+	if( (aMouseX != 0 || aMouseY != 0) && record->myLatchUpdate == 0 )
+	{
+		record->myLatchUpdate = record->myInputService->GetUpdateCount();
+	}
+}
+
+
+// Replays a key press & late mouse movement, and prints how many frames later each reached the simulation & the
+// screen
+bool CheckInputLatency()
+{
+	VoxelEngine*	voxelEngine		= VoxelEngine::GetInstance();
+	VEInputService*	inputService	= voxelEngine->GetInputService();
+
+	// Late latching needs a camera to turn
+	VEBasicCamera camera( CT_Basic );
+	camera.Initialise( 1024, 768 );
+	voxelEngine->SetCamera( &camera );
+
+	InputLatencyRecord record;
+	record.myInputService	= inputService;
+	record.myKeyUpdate		= 0;
+	record.myMouseUpdate	= 0;
+	record.myLatchUpdate	= 0;
+
+	// The key is pressed before the frame's input is polled, the mouse moves after the frame has been simulated, in
+	// time for the frame's late latch
+	unsigned int firstUpdate	= inputService->GetUpdateCount() + 1;
+	unsigned int keyUpdate		= firstUpdate + BENCHMARK_INPUT_KEY_FRAME;
+	unsigned int mouseUpdate	= firstUpdate + BENCHMARK_INPUT_MOUSE_FRAME;
+
+	VEInputReplay replay;
+	replay.AddEvent( keyUpdate, 0, IE_KeyDown, DIK_W );
+	replay.AddEvent( mouseUpdate, 1, IE_MouseMove, 0, 10, 5 );
+
+	inputService->SetSource( VEInputReplay::Poll, &replay );
+	inputService->AddListener( RecordInputEvent, &record );
+	inputService->SetLateLatch( RecordLateLatch, &record );
+
+	voxelEngine->RunFrames( BENCHMARK_INPUT_FRAMES, BENCHMARK_TIME_STEP );
+
+	inputService->SetLateLatch( NULL, NULL );
+	inputService->RemoveListener( RecordInputEvent, &record );
+	inputService->SetSource( NULL, NULL );
+	voxelEngine->SetCamera( NULL );
+
+	if( !replay.GetIsFinished() || record.myKeyUpdate == 0 || record.myMouseUpdate == 0 || record.myLatchUpdate == 0 )
+	{
+		printf( "Not every replayed event was seen\n" );
+		return false;
+	}
+
+	unsigned int keyLatency			= record.myKeyUpdate - keyUpdate;
+	unsigned int latchLatency		= record.myLatchUpdate - mouseUpdate;
+	unsigned int simulationLatency	= record.myMouseUpdate - mouseUpdate;
+
+	printf( "Key press reached the simulation after %u frame(s)\n", keyLatency );
+	printf( "Mouse movement reached the screen after %u frame(s) late latched, %u frame(s) through the simulation\n", latchLatency, simulationLatency );
+
+	return keyLatency == 0 && latchLatency == 0;
+}
+
+
+// Creates a copy of each of the world's chunks, with the voxels the world was generated with
+static bool CreateChunkCopies( std::vector<VEChunk*>& someChunks )
+{
+	VEChunkManager*					chunkManager	= VoxelEngine::GetInstance()->GetChunkManager();
+	const std::vector<VEChunk*>&	chunks			= chunkManager->GetChunks();
+	unsigned int					voxelCount		= (unsigned int)( chunkManager->GetChunkDimensions() * chunkManager->GetChunkDimensions() * chunkManager->GetChunkDimensions() );
+
+	for( unsigned int i = 0; i < chunks.size(); i++ )
+	{
+		VEChunk* chunk = chunkManager->CreateChunk( chunks[i]->GetPosition(), chunks[i]->GetGridX(), chunks[i]->GetGridZ() );
+		if( chunk == NULL )
+		{
+			return false;
+		}
+
+		memcpy( chunk->GetVoxels(), chunks[i]->GetVoxels(), voxelCount * sizeof(VEVoxel) );
+		someChunks.push_back( chunk );
+	}
+
+	return true;
+}
+
+
+// Destroys the chunks created by CreateChunkCopies
+static void DestroyChunkCopies( std::vector<VEChunk*>& someChunks )
+{
+	for( unsigned int i = 0; i < someChunks.size(); i++ )
+	{
+		VoxelEngine::GetInstance()->GetChunkManager()->DestroyChunk( someChunks[i] );
+	}
+	someChunks.clear();
+}
+
+
+// Whether two chunks' voxels are the same
+static bool CompareChunkVoxels( VEChunk* aChunk, VEChunk* anOtherChunk )
+{
+	unsigned int voxelCount = (unsigned int)( aChunk->GetDimensions() * aChunk->GetDimensions() * aChunk->GetDimensions() );
+	for( unsigned int i = 0; i < voxelCount; i++ )
+	{
+		VEVoxel& voxel		= aChunk->GetVoxels()[i];
+		VEVoxel& otherVoxel	= anOtherChunk->GetVoxels()[i];
+
+		if( voxel.GetType() != otherVoxel.GetType() || voxel.GetEnabled() != otherVoxel.GetEnabled() )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+// Records random voxel edits in a journal, tears its last block and replays the edits that survive in to fresh
+// copies of the world's chunks, then compacts it
+bool CheckEditJournal()
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency( &frequency );
+
+	double tickSeconds = 1.0 / (double)frequency.QuadPart;
+
+	// The reference chunks have every edit made to them, the snapshot is a copy of the restyled chunk taken before
+	// the rest of the edits
+	std::vector<VEChunk*> references;
+	std::vector<VEChunk*> replayed;
+	std::vector<VEChunk*> snapshots;
+	if( !CreateChunkCopies(references) || !CreateChunkCopies(snapshots) )
+	{
+		printf( "Unable to create the chunks\n" );
+
+		DestroyChunkCopies( snapshots );
+		DestroyChunkCopies( references );
+		return false;
+	}
+
+	// The edits go through the engine's world store, the way the game's are journaled
+	std::wstring	journalFilename	= std::wstring( BENCHMARK_JOURNAL_DIRECTORY ) + VE_WORLD_JOURNAL_FILE;
+	VEWorldStore*	worldStore		= VoxelEngine::GetInstance()->GetWorldStore();
+	DeleteFileW( journalFilename.c_str() );
+
+	bool isPassed = worldStore->Open( BENCHMARK_JOURNAL_DIRECTORY );
+	if( !isPassed )
+	{
+		printf( "Unable to open the world store\n" );
+	}
+
+	// Make the edits
+	unsigned int recordedCount = 0;
+	if( isPassed )
+	{
+		VEEditJournal&	storeJournal	= worldStore->GetEditJournal();
+		int				dimensions		= references[0]->GetDimensions();
+		unsigned int	randomState		= BENCHMARK_SEED;
+		unsigned int	editCount		= 0;
+		bool			isRestyled		= false;
+		long long		restyleTime		= 0;
+		long long		startTime		= VEProfiler::GetTime();
+
+		while( editCount < BENCHMARK_JOURNAL_EDITS )
+		{
+			// Restyle the first chunk half way through, so its earlier edits are stale in its snapshot
+			if( editCount == BENCHMARK_JOURNAL_EDITS / 2 && !isRestyled )
+			{
+				isRestyled = true;
+
+				long long restyleStart = VEProfiler::GetTime();
+				references[0]->ApplyStyle( CS_Sphere );
+				restyleTime = VEProfiler::GetTime() - restyleStart;
+
+				memcpy( snapshots[0]->GetVoxels(), references[0]->GetVoxels(), dimensions * dimensions * dimensions * sizeof(VEVoxel) );
+			}
+
+			VEChunk*	chunk	= references[NextRandom(randomState) % references.size()];
+			int			x		= NextRandom( randomState ) % dimensions;
+			int			y		= NextRandom( randomState ) % dimensions;
+			int			z		= NextRandom( randomState ) % dimensions;
+			VoxelType	type	= (VoxelType)( NextRandom(randomState) % VT_Max );
+
+			// Edits that don't change the voxel aren't journaled
+			if( chunk->SetVoxel(x, y, z, type, (NextRandom(randomState) & 1) != 0) )
+			{
+				editCount++;
+			}
+		}
+
+		long long recordTime = VEProfiler::GetTime() - startTime;
+		storeJournal.Flush();
+		long long flushTime = VEProfiler::GetTime() - startTime;
+
+		recordedCount = storeJournal.GetSequence();
+
+		double writeSeconds = (double)storeJournal.GetWriteTime() * tickSeconds;
+		printf( "Made %u edits in %.1fms, %.0fns per edit, all written after %.1fms\n", BENCHMARK_JOURNAL_EDITS, recordTime * tickSeconds * 1000.0,
+				recordTime * tickSeconds * 1000000000.0 / BENCHMARK_JOURNAL_EDITS, flushTime * tickSeconds * 1000.0 );
+		printf( "Restyling a chunk journaled %u edits in %.1fms\n", recordedCount - BENCHMARK_JOURNAL_EDITS, restyleTime * tickSeconds * 1000.0 );
+		printf( "Journal is %.2fMB, written at %.1fMB/s with %u failed writes\n", storeJournal.GetFileSize() / (1024.0 * 1024.0),
+				writeSeconds > 0.0 ? storeJournal.GetWrittenBytes() / (1024.0 * 1024.0) / writeSeconds : 0.0, storeJournal.GetFailedWriteCount() );
+
+		worldStore->Close();
+	}
+
+	// Tear the end of the journal, the way a crash part way through a write would
+	if( isPassed )
+	{
+		unsigned char tornBlock[BENCHMARK_JOURNAL_TORN_SIZE];
+		memset( tornBlock, 0xAB, sizeof(tornBlock) );
+
+		unsigned int magic = VE_JOURNAL_MAGIC;
+		memcpy( tornBlock, &magic, sizeof(magic) );
+
+		HANDLE file = CreateFileW( journalFilename.c_str(), FILE_APPEND_DATA, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+
+		DWORD bytesWritten = 0;
+		isPassed = file != INVALID_HANDLE_VALUE && WriteFile( file, tornBlock, sizeof(tornBlock), &bytesWritten, NULL ) && bytesWritten == sizeof(tornBlock);
+
+		if( file != INVALID_HANDLE_VALUE )
+		{
+			CloseHandle( file );
+		}
+
+		if( !isPassed )
+		{
+			printf( "Unable to tear the journal\n" );
+		}
+	}
+
+	// Recover the edits and replay them on top of the generated voxels
+	VEEditJournal journal;
+	if( isPassed )
+	{
+		isPassed = journal.Open( journalFilename ) && CreateChunkCopies( replayed );
+
+		long long startTime = VEProfiler::GetTime();
+		for( unsigned int i = 0; i < replayed.size() && isPassed; i++ )
+		{
+			journal.ReplayEdits( replayed[i] );
+		}
+		long long replayTime = VEProfiler::GetTime() - startTime;
+
+		printf( "Recovered %u edits in %.1fms and replayed them in %.1fms, %llu torn bytes cut off\n", journal.GetRecoveredEditCount(),
+				journal.GetRecoveryTime() * tickSeconds * 1000.0, replayTime * tickSeconds * 1000.0, journal.GetDiscardedBytes() );
+
+		if( !isPassed || journal.GetRecoveredEditCount() != recordedCount || journal.GetDiscardedBytes() != BENCHMARK_JOURNAL_TORN_SIZE )
+		{
+			printf( "The journal wasn't recovered\n" );
+			isPassed = false;
+		}
+
+		for( unsigned int i = 0; i < replayed.size() && isPassed; i++ )
+		{
+			if( !CompareChunkVoxels(replayed[i], references[i]) )
+			{
+				printf( "Replayed chunk %d, %d doesn't match its edits\n", replayed[i]->GetGridX(), replayed[i]->GetGridZ() );
+				isPassed = false;
+			}
+		}
+
+		// The snapshot already includes the edits from before the restyle, replaying them again mustn't undo it
+		if( isPassed )
+		{
+			journal.ReplayEdits( snapshots[0] );
+
+			if( !CompareChunkVoxels(snapshots[0], references[0]) )
+			{
+				printf( "Replaying on to the restyled snapshot doesn't match its edits\n" );
+				isPassed = false;
+			}
+		}
+	}
+
+	// Save half the chunks, compact away their edits and each voxel's overwritten edits, then check the rest still
+	// replay to the same voxels
+	if( isPassed )
+	{
+		for( unsigned int i = 0; i < references.size(); i += 2 )
+		{
+			journal.MarkSaved( references[i]->GetGridX(), references[i]->GetGridZ(), journal.GetSequence() );
+		}
+
+		unsigned long long fileSize = journal.GetFileSize();
+
+		long long startTime = VEProfiler::GetTime();
+		journal.Compact();
+		long long compactTime = VEProfiler::GetTime() - startTime;
+
+		printf( "Compacted the journal from %.2fMB to %.2fMB in %.1fms, %u edits left\n", fileSize / (1024.0 * 1024.0),
+				journal.GetFileSize() / (1024.0 * 1024.0), compactTime * tickSeconds * 1000.0, journal.GetLiveEditCount() );
+
+		journal.Close();
+		DestroyChunkCopies( replayed );
+
+		isPassed = journal.Open( journalFilename ) && CreateChunkCopies( replayed );
+		for( unsigned int i = 1; i < replayed.size() && isPassed; i += 2 )
+		{
+			journal.ReplayEdits( replayed[i] );
+
+			if( !CompareChunkVoxels(replayed[i], references[i]) )
+			{
+				printf( "Compacted chunk %d, %d doesn't match its edits\n", replayed[i]->GetGridX(), replayed[i]->GetGridZ() );
+				isPassed = false;
+			}
+		}
+	}
+
+	// Change a voxel and change it back either side of a snapshot being captured, and compact before the snapshot is
+	// written. The snapshot has the first change, so the change back has to survive the compaction to be replayed
+	if( isPassed )
+	{
+		journal.Close();
+		DeleteFileW( journalFilename.c_str() );
+		DestroyChunkCopies( replayed );
+
+		isPassed = journal.Open( journalFilename ) && CreateChunkCopies( replayed );
+		if( isPassed )
+		{
+			VEChunk*	chunk		= replayed[0];
+			VEVoxel		oldVoxel	= chunk->GetVoxels()[0];
+			VEVoxel		newVoxel	= oldVoxel;
+			newVoxel.SetEnabled( !oldVoxel.GetEnabled() );
+
+			journal.RecordEdit( chunk->GetGridX(), chunk->GetGridZ(), 0, oldVoxel, newVoxel );
+			unsigned int snapshotSequence = journal.GetSequence();
+			journal.RecordEdit( chunk->GetGridX(), chunk->GetGridZ(), 0, newVoxel, oldVoxel );
+
+			journal.Compact();
+			journal.MarkSaved( chunk->GetGridX(), chunk->GetGridZ(), snapshotSequence );
+			journal.Close();
+
+			// Load the snapshot that was written, then replay what's left of the journal on to it
+			chunk->GetVoxels()[0] = newVoxel;
+
+			isPassed = journal.Open( journalFilename );
+			journal.ReplayEdits( chunk );
+
+			if( !isPassed || chunk->GetVoxels()[0].GetEnabled() != oldVoxel.GetEnabled() )
+			{
+				printf( "A voxel changed back after a snapshot was captured was compacted away\n" );
+				isPassed = false;
+			}
+		}
+	}
+
+	journal.Close();
+	DeleteFileW( journalFilename.c_str() );
+
+	DestroyChunkCopies( replayed );
+	DestroyChunkCopies( snapshots );
+	DestroyChunkCopies( references );
+
+	return isPassed;
+}
+
+
+// Runs frames until every chunk has been built. Returns false if the world didn't settle
+static bool SettleWorld()
+{
+	VoxelEngine*		voxelEngine		= VoxelEngine::GetInstance();
+	VEChunkManager*		chunkManager	= voxelEngine->GetChunkManager();
+	VEThreadManager*	threadManager	= voxelEngine->GetThreadManager();
+
+	for( unsigned int i = 0; i < BENCHMARK_SETTLE_FRAMES; i++ )
+	{
+		voxelEngine->Update( BENCHMARK_TIME_STEP );
+
+		bool isSettled = threadManager->GetThreadCount() == 0;
+
+		const std::vector<VEChunk*>& chunks = chunkManager->GetChunks();
+		for( unsigned int j = 0; j < chunks.size() && isSettled; j++ )
+		{
+			isSettled = !chunks[j]->GetIsDirty() && !chunks[j]->GetIsBuilding();
+		}
+
+		if( isSettled )
+		{
+			return true;
+		}
+
+		Sleep( 1 );
+	}
+
+	return false;
+}
+
+
+// Generates a world of the supplied size and runs frames until every chunk has been built. Returns the time taken in
+// performance counter ticks, or -1 if the world didn't settle
+static long long StartWorld( int aWidth, int aDepth )
+{
+	long long startTime = VEProfiler::GetTime();
+
+	VoxelEngine::GetInstance()->GetTerrainGenerator()->GenerateTerrain( aWidth, aDepth );
+
+	if( !SettleWorld() )
+	{
+		return -1;
+	}
+
+	return VEProfiler::GetTime() - startTime;
+}
+
+
+// Returns the number of indices in every chunk's mesh
+static unsigned long long GetWorldIndexCount()
+{
+	const std::vector<VEChunk*>& chunks = VoxelEngine::GetInstance()->GetChunkManager()->GetChunks();
+
+	unsigned long long indexCount = 0;
+	for( unsigned int i = 0; i < chunks.size(); i++ )
+	{
+		indexCount += chunks[i]->GetIndexCount();
+	}
+
+	return indexCount;
+}
+
+
+// Generates a larger world with an empty world cache and runs frames until every chunk has been built, then does the
+// same again with the cache filled in
+bool CheckStartupCache()
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency( &frequency );
+
+	double tickSeconds = 1.0 / (double)frequency.QuadPart;
+
+	VoxelEngine*	voxelEngine	= VoxelEngine::GetInstance();
+	VEWorldCache*	worldCache	= voxelEngine->GetWorldCache();
+
+	// Start from an empty cache
+	CreateDirectoryW( BENCHMARK_CACHE_DIRECTORY, NULL );
+	for( int z = 0; z <= VERegionFile::GetRegionCoordinate(BENCHMARK_STARTUP_DEPTH - 1); z++ )
+	{
+		for( int x = 0; x <= VERegionFile::GetRegionCoordinate(BENCHMARK_STARTUP_WIDTH - 1); x++ )
+		{
+			wchar_t filename[64];
+
+			swprintf_s( filename, L"voxels.%d.%d.vreg", x, z );
+			DeleteFileW( (std::wstring(BENCHMARK_CACHE_DIRECTORY) + filename).c_str() );
+
+			swprintf_s( filename, L"mesh.%d.%d.vreg", x, z );
+			DeleteFileW( (std::wstring(BENCHMARK_CACHE_DIRECTORY) + filename).c_str() );
+		}
+	}
+
+	unsigned int chunkCount = BENCHMARK_STARTUP_WIDTH * BENCHMARK_STARTUP_DEPTH;
+
+	// The cold start generates & builds every chunk, and fills in the cache
+	bool isPassed = worldCache->Open( BENCHMARK_CACHE_DIRECTORY );
+	if( !isPassed )
+	{
+		printf( "Unable to open the world cache\n" );
+		return false;
+	}
+
+	long long			coldTime		= StartWorld( BENCHMARK_STARTUP_WIDTH, BENCHMARK_STARTUP_DEPTH );
+	unsigned long long	coldIndexCount	= GetWorldIndexCount();
+
+	printf( "Cold start: %u chunks in %.1fms, %u entries (%.2fMB) written to the cache\n", chunkCount, coldTime * tickSeconds * 1000.0,
+			worldCache->GetSavedCount(), worldCache->GetSavedBytes() / (1024.0 * 1024.0) );
+
+	worldCache->Close();
+
+	// The warm start takes every chunk's voxels & mesh from the cache
+	isPassed = coldTime >= 0 && worldCache->Open( BENCHMARK_CACHE_DIRECTORY );
+
+	long long			warmTime		= isPassed ? StartWorld( BENCHMARK_STARTUP_WIDTH, BENCHMARK_STARTUP_DEPTH ) : -1;
+	unsigned long long	warmIndexCount	= GetWorldIndexCount();
+
+	printf( "Warm start: %u chunks in %.1fms, %u voxel & %u mesh hits, %u stale entries\n", chunkCount, warmTime * tickSeconds * 1000.0,
+			worldCache->GetVoxelHitCount(), worldCache->GetMeshHitCount(), worldCache->GetStaleCount() );
+	printf( "Cache is %.2fMB on disk, the warm start took %.1f%% of the cold start\n", worldCache->GetFileSize() / (1024.0 * 1024.0),
+			coldTime > 0 ? 100.0 * warmTime / coldTime : 0.0 );
+
+	if( coldTime < 0 || warmTime < 0 )
+	{
+		printf( "The world didn't settle within %u frames\n", BENCHMARK_SETTLE_FRAMES );
+		isPassed = false;
+	}
+	else if( worldCache->GetVoxelHitCount() != chunkCount || worldCache->GetMeshHitCount() != chunkCount || worldCache->GetStaleCount() != 0 )
+	{
+		printf( "The warm start didn't take every chunk from the cache\n" );
+		isPassed = false;
+	}
+	else if( warmIndexCount != coldIndexCount )
+	{
+		printf( "The cached meshes have %llu indices, the built meshes %llu\n", warmIndexCount, coldIndexCount );
+		isPassed = false;
+	}
+
+	worldCache->Close();
+
+	return isPassed;
+}
+
+
+// Checksums a chunk's voxels
+static unsigned int ChecksumChunkVoxels( VEChunk* aChunk )
+{
+	VEScopedSharedLock voxelLock( aChunk->GetVoxelLock() );
+
+	VEVoxel*		voxels		= aChunk->GetVoxels();
+	unsigned int	voxelCount	= (unsigned int)( aChunk->GetDimensions() * aChunk->GetDimensions() * aChunk->GetDimensions() );
+
+	unsigned int checksum = 2166136261u;
+	for( unsigned int i = 0; i < voxelCount; i++ )
+	{
+		checksum = (checksum ^ ((unsigned int)voxels[i].GetType() << 1 | (voxels[i].GetEnabled() ? 1 : 0))) * 16777619u;
+	}
+
+	return checksum;
+}
+
+
+// Builds a large world and lets every chunk sit untouched until it's compressed, then reads a voxel from each chunk
+bool CheckChunkCompression()
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency( &frequency );
+
+	double tickSeconds = 1.0 / (double)frequency.QuadPart;
+
+	VoxelEngine*	voxelEngine		= VoxelEngine::GetInstance();
+	VEChunkManager*	chunkManager	= voxelEngine->GetChunkManager();
+
+	if( StartWorld(BENCHMARK_COMPRESSION_WIDTH, BENCHMARK_COMPRESSION_DEPTH) < 0 )
+	{
+		printf( "The world didn't settle within %u frames\n", BENCHMARK_SETTLE_FRAMES );
+		return false;
+	}
+
+	const std::vector<VEChunk*>&	chunks		= chunkManager->GetChunks();
+	unsigned long long				voxelBytes	= (unsigned long long)chunks.size() * chunkManager->GetVoxelPool()->GetBlockSize();
+
+	std::vector<unsigned int> checksums( chunks.size() );
+	for( unsigned int i = 0; i < chunks.size(); i++ )
+	{
+		checksums[i] = ChecksumChunkVoxels( chunks[i] );
+	}
+
+	printf( "%u chunks built, %.2fMB of voxels\n", (unsigned int)chunks.size(), voxelBytes / (1024.0 * 1024.0) );
+	PrintResidentMemory();
+
+	// Leave the world untouched until the compression thread has compressed every chunk
+	chunkManager->SetCompressionDelay( BENCHMARK_COMPRESSION_DELAY );
+
+	long long		startTime	= VEProfiler::GetTime();
+	unsigned int	frameCount	= 0;
+	for( ; frameCount < BENCHMARK_SETTLE_FRAMES && chunkManager->GetCompressedChunkCount() < chunks.size(); frameCount++ )
+	{
+		voxelEngine->Update( BENCHMARK_TIME_STEP );
+		Sleep( 1 );
+	}
+	long long compressTime = VEProfiler::GetTime() - startTime;
+
+	// Nothing is compressed again while the chunks are read back
+	chunkManager->SetCompressionDelay( 0 );
+
+	unsigned int		compressedCount	= chunkManager->GetCompressedChunkCount();
+	unsigned long long	compressedBytes	= chunkManager->GetCompressedBytes();
+
+	VEPoolStatistics poolStatistics;
+	chunkManager->GetVoxelPool()->GetStatistics( poolStatistics );
+
+	printf( "%u chunks compressed after %u frames (%.1fms) to %.2fMB, %.1f%% of their voxels, %u voxel blocks decommitted\n", compressedCount,
+			frameCount, compressTime * tickSeconds * 1000.0, compressedBytes / (1024.0 * 1024.0), 100.0 * compressedBytes / voxelBytes,
+			poolStatistics.myDecommittedBlocks );
+	PrintResidentMemory();
+
+	// The first access to each chunk decompresses it, the second finds it resident
+	long long firstAccessTime		= 0;
+	long long maxFirstAccessTime	= 0;
+	long long secondAccessTime		= 0;
+	for( unsigned int i = 0; i < chunks.size(); i++ )
+	{
+		long long accessStart = VEProfiler::GetTime();
+		chunks[i]->GetVoxelEnabled( 0, 0, 0 );
+		long long accessTime = VEProfiler::GetTime() - accessStart;
+
+		firstAccessTime		+= accessTime;
+		maxFirstAccessTime	= accessTime > maxFirstAccessTime ? accessTime : maxFirstAccessTime;
+
+		accessStart = VEProfiler::GetTime();
+		chunks[i]->GetVoxelEnabled( 0, 0, 0 );
+		secondAccessTime += VEProfiler::GetTime() - accessStart;
+	}
+
+	printf( "First access %.1fus on average, %.1fus at worst, second access %.2fus on average\n", firstAccessTime * tickSeconds * 1000000.0 / chunks.size(),
+			maxFirstAccessTime * tickSeconds * 1000000.0, secondAccessTime * tickSeconds * 1000000.0 / chunks.size() );
+	PrintResidentMemory();
+
+	bool isPassed = compressedCount == chunks.size() && chunkManager->GetDecompressionCount() == chunks.size();
+	if( !isPassed )
+	{
+		printf( "%u of %u chunks were compressed, %u decompressed\n", compressedCount, (unsigned int)chunks.size(), chunkManager->GetDecompressionCount() );
+	}
+
+	for( unsigned int i = 0; i < chunks.size() && isPassed; i++ )
+	{
+		if( ChecksumChunkVoxels(chunks[i]) != checksums[i] )
+		{
+			printf( "Chunk %d, %d has different voxels after being decompressed\n", chunks[i]->GetGridX(), chunks[i]->GetGridZ() );
+			isPassed = false;
+		}
+	}
+
+	return isPassed;
+}
+
+
+// Checks the chunks SelectEvictions picks from a set of candidates against the chunks expected, in order
+static bool CheckEvictionCase( const char* aName, std::vector<VEEvictionCandidate> someCandidates, unsigned long long aUsage, unsigned long long aBudget,
+							   const std::vector<VEChunk*>& someExpectedEvictions, unsigned long long anExpectedBytes )
+{
+	std::vector<VEChunk*>	evictions;
+	unsigned long long		evictedBytes = VEMemoryBudget::SelectEvictions( someCandidates, aUsage, aBudget, evictions );
+
+	if( evictions != someExpectedEvictions || evictedBytes != anExpectedBytes )
+	{
+		printf( "Eviction case '%s' evicted %u chunks (%llu bytes), expected %u (%llu bytes)\n", aName, (unsigned int)evictions.size(), evictedBytes,
+				(unsigned int)someExpectedEvictions.size(), anExpectedBytes );
+		return false;
+	}
+
+	return true;
+}
+
+
+// Checks the memory budget's eviction choices against hand-worked cases. The chunks are only used as identities
+static bool CheckEvictionChoices()
+{
+	const std::vector<VEChunk*>& chunks = VoxelEngine::GetInstance()->GetChunkManager()->GetChunks();
+	if( chunks.size() < 4 )
+	{
+		printf( "The eviction cases need at least 4 chunks\n" );
+		return false;
+	}
+
+	VEChunk* a = chunks[0];
+	VEChunk* b = chunks[1];
+	VEChunk* c = chunks[2];
+	VEChunk* d = chunks[3];
+
+	std::vector<VEEvictionCandidate>	candidates;
+	std::vector<VEChunk*>				expected;
+	bool								isPassed = true;
+
+	// Nothing is evicted while the usage is within the budget, or the budget is unlimited
+	candidates.push_back( VEEvictionCandidate(a, 100, 10) );
+	candidates.push_back( VEEvictionCandidate(b, 200, 10) );
+	isPassed &= CheckEvictionCase( "within budget", candidates, 100, 100, expected, 0 );
+	isPassed &= CheckEvictionCase( "unlimited", candidates, 100, 0, expected, 0 );
+
+	// The least recently visible go first, and only until the usage is within the budget
+	candidates.clear();
+	candidates.push_back( VEEvictionCandidate(a, 500, 10) );
+	candidates.push_back( VEEvictionCandidate(b, 100, 10) );
+	candidates.push_back( VEEvictionCandidate(c, 300, 10) );
+	candidates.push_back( VEEvictionCandidate(d, 400, 10) );
+	expected.push_back( b );
+	expected.push_back( c );
+	isPassed &= CheckEvictionCase( "least recently visible", candidates, 100, 85, expected, 20 );
+
+	// Between chunks seen at the same time, the largest goes first
+	candidates.clear();
+	candidates.push_back( VEEvictionCandidate(a, 100, 5) );
+	candidates.push_back( VEEvictionCandidate(b, 100, 20) );
+	candidates.push_back( VEEvictionCandidate(c, 50, 0) );
+	expected.clear();
+	expected.push_back( b );
+	isPassed &= CheckEvictionCase( "largest first, empty skipped", candidates, 100, 90, expected, 20 );
+
+	// Every candidate goes if they can't bring the usage within the budget
+	candidates.clear();
+	candidates.push_back( VEEvictionCandidate(a, 300, 10) );
+	candidates.push_back( VEEvictionCandidate(b, 200, 10) );
+	expected.clear();
+	expected.push_back( b );
+	expected.push_back( a );
+	isPassed &= CheckEvictionCase( "not enough candidates", candidates, 100, 10, expected, 20 );
+
+	return isPassed;
+}
+
+
+// Checks the eviction choices, then walks the view across a larger world & back with budgets for the voxels & meshes
+bool CheckMemoryBudget()
+{
+	if( !CheckEvictionChoices() )
+	{
+		return false;
+	}
+
+	printf( "Eviction choices are as expected\n" );
+
+	VoxelEngine*	voxelEngine		= VoxelEngine::GetInstance();
+	VEChunkManager*	chunkManager	= voxelEngine->GetChunkManager();
+	VEWorldCache*	worldCache		= voxelEngine->GetWorldCache();
+	VEMemoryBudget&	memoryBudget	= chunkManager->GetMemoryBudget();
+
+	// Voxels are spilled to the world cache
+	if( !worldCache->Open(BENCHMARK_CACHE_DIRECTORY) )
+	{
+		printf( "Unable to open the world cache\n" );
+		return false;
+	}
+
+	if( StartWorld(BENCHMARK_BUDGET_WIDTH, BENCHMARK_BUDGET_DEPTH) < 0 )
+	{
+		printf( "The world didn't settle within %u frames\n", BENCHMARK_SETTLE_FRAMES );
+		worldCache->Close();
+		return false;
+	}
+
+	// What the world should come back as once the budgets are lifted
+	const std::vector<VEChunk*>&	chunks			= chunkManager->GetChunks();
+	unsigned long long				indexCount		= GetWorldIndexCount();
+
+	std::vector<unsigned int> checksums( chunks.size() );
+	for( unsigned int i = 0; i < chunks.size(); i++ )
+	{
+		checksums[i] = ChecksumChunkVoxels( chunks[i] );
+	}
+
+	printf( "%u chunks built without budgets\n", (unsigned int)chunks.size() );
+	PrintResidentMemory();
+
+	unsigned long long megabyte = 1024 * 1024;
+	memoryBudget.SetBudget( MB_Voxels, BENCHMARK_BUDGET_VOXELS * megabyte );
+	memoryBudget.SetBudget( MB_CpuMeshes, BENCHMARK_BUDGET_CPU_MESHES * megabyte );
+	memoryBudget.SetBudget( MB_GpuMeshes, BENCHMARK_BUDGET_GPU_MESHES * megabyte );
+	memoryBudget.ResetPeakUsage();
+
+	// Stand at the start of the walk until the chunks out of view have been evicted
+	float worldWidth	= (float)( BENCHMARK_BUDGET_WIDTH * chunkManager->GetChunkDimensions() );
+	float viewZ			= (float)( BENCHMARK_BUDGET_DEPTH * chunkManager->GetChunkDimensions() ) * 0.5f;
+
+	chunkManager->SetViewDistance( BENCHMARK_BUDGET_VIEW_DISTANCE );
+	chunkManager->SetViewPosition( XMFLOAT3(0.0f, 0.0f, viewZ) );
+
+	unsigned int settleFrames = 0;
+	for( ; settleFrames < BENCHMARK_SETTLE_FRAMES; settleFrames++ )
+	{
+		voxelEngine->Update( BENCHMARK_TIME_STEP );
+
+		if( !memoryBudget.GetIsOverBudget(MB_Voxels) && !memoryBudget.GetIsOverBudget(MB_GpuMeshes) )
+		{
+			break;
+		}
+
+		Sleep( 1 );
+	}
+
+	printf( "Evicted down to the budgets after %u frames\n", settleFrames );
+	PrintResidentMemory();
+
+	// Walk along the world & back through the middle of its depth
+	unsigned int		halfWalk		= BENCHMARK_BUDGET_WALK_FRAMES / 2;
+	unsigned long long	startResident	= GetResidentMemory();
+	unsigned long long	peakResident	= startResident;
+
+	memoryBudget.ResetPeakUsage();
+
+	for( unsigned int i = 0; i < BENCHMARK_BUDGET_WALK_FRAMES; i++ )
+	{
+		float progress = i < halfWalk ? (float)i / halfWalk : (float)(BENCHMARK_BUDGET_WALK_FRAMES - i) / halfWalk;
+		chunkManager->SetViewPosition( XMFLOAT3(progress * worldWidth, 0.0f, viewZ) );
+
+		voxelEngine->Update( BENCHMARK_TIME_STEP );
+
+		unsigned long long resident = GetResidentMemory();
+		peakResident = resident > peakResident ? resident : peakResident;
+
+		Sleep( 1 );
+	}
+
+	printf( "Walked %.0f units & back over %u frames, viewing %.0f units\n", worldWidth, BENCHMARK_BUDGET_WALK_FRAMES, BENCHMARK_BUDGET_VIEW_DISTANCE );
+	printf( "    %.2fMB resident at the start of the walk, %.2fMB at its peak, %.2fMB at the end\n", startResident / (double)megabyte,
+			peakResident / (double)megabyte, GetResidentMemory() / (double)megabyte );
+
+	const char* budgetNames[MB_Max] = { "Voxels", "CPU meshes", "GPU meshes" };
+	for( unsigned int i = 0; i < MB_Max; i++ )
+	{
+		MemoryBudget budget = (MemoryBudget)i;
+		printf( "    %-10s %7.2fMB budget, %7.2fMB at peak, %7.2fMB now, %u evictions (%.2fMB)\n", budgetNames[i], memoryBudget.GetBudget(budget) / (double)megabyte,
+				memoryBudget.GetPeakUsage(budget) / (double)megabyte, memoryBudget.GetUsage(budget) / (double)megabyte, memoryBudget.GetEvictionCount(budget),
+				memoryBudget.GetEvictedBytes(budget) / (double)megabyte );
+	}
+
+	printf( "    %u chunks compressed, %u spilled (%u restored), %u meshes evicted, %u loaded from the cache\n", chunkManager->GetCompressionCount(),
+			chunkManager->GetSpillCount(), worldCache->GetRestoredCount(), memoryBudget.GetEvictionCount(MB_GpuMeshes), worldCache->GetMeshHitCount() );
+
+	// Lift the budgets, every chunk comes back in to view & has its mesh restored
+	for( unsigned int i = 0; i < MB_Max; i++ )
+	{
+		memoryBudget.SetBudget( (MemoryBudget)i, 0 );
+	}
+	chunkManager->SetViewDistance( 0.0f );
+
+	bool isPassed = SettleWorld();
+	if( !isPassed )
+	{
+		printf( "The world didn't settle within %u frames once the budgets were lifted\n", BENCHMARK_SETTLE_FRAMES );
+	}
+	else if( GetWorldIndexCount() != indexCount )
+	{
+		printf( "The restored meshes have %llu indices, the built meshes %llu\n", GetWorldIndexCount(), indexCount );
+		isPassed = false;
+	}
+
+	for( unsigned int i = 0; i < chunks.size() && isPassed; i++ )
+	{
+		if( ChecksumChunkVoxels(chunks[i]) != checksums[i] )
+		{
+			printf( "Chunk %d, %d has different voxels after being evicted\n", chunks[i]->GetGridX(), chunks[i]->GetGridZ() );
+			isPassed = false;
+		}
+	}
+
+	worldCache->Close();
+
+	return isPassed;
+}
+
+
+// Applies a style to every chunk in the world and runs frames until they've all been rebuilt. Returns the time taken
+// in performance counter ticks, or -1 if the world didn't settle
+static long long RestyleWorld( ChunkStyle aStyle )
+{
+	long long startTime = VEProfiler::GetTime();
+
+	const std::vector<VEChunk*>& chunks = VoxelEngine::GetInstance()->GetChunkManager()->GetChunks();
+	for( unsigned int i = 0; i < chunks.size(); i++ )
+	{
+		chunks[i]->ApplyStyle( aStyle );
+	}
+
+	if( !SettleWorld() )
+	{
+		return -1;
+	}
+
+	return VEProfiler::GetTime() - startTime;
+}
+
+
+// Prints how long a world took to rebuild with the mesh cache disabled & enabled, and how much the cache shared
+static void PrintMeshCacheResult( const char* aName, long long anUncachedTime, long long aCachedTime, unsigned int aHitCount, unsigned int aLookupCount,
+								  long long aSavedTime, double aTickMilliseconds )
+{
+	printf( "    %-8s %8.1fms uncached, %8.1fms cached, %4u of %4u meshes shared (%5.1f%%), %8.1fms of building saved\n", aName,
+			anUncachedTime * aTickMilliseconds, aCachedTime * aTickMilliseconds, aHitCount, aLookupCount,
+			aLookupCount > 0 ? 100.0 * aHitCount / aLookupCount : 0.0, aSavedTime * aTickMilliseconds );
+}
+
+
+// Re-styles every chunk of a world as boxes, spheres & pyramids in turn, then generates terrain, with the mesh cache
+// disabled & then enabled
+bool CheckMeshCache()
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency( &frequency );
+
+	double tickMilliseconds = 1000.0 / (double)frequency.QuadPart;
+
+	VoxelEngine*	voxelEngine		= VoxelEngine::GetInstance();
+	VEChunkManager*	chunkManager	= voxelEngine->GetChunkManager();
+	VEMeshCache*	meshCache		= chunkManager->GetMeshCache();
+
+	// The world cache stays closed, the meshes it saves are always built
+	if( StartWorld(BENCHMARK_MESH_CACHE_WIDTH, BENCHMARK_MESH_CACHE_DEPTH) < 0 )
+	{
+		printf( "The world didn't settle within %u frames\n", BENCHMARK_SETTLE_FRAMES );
+		return false;
+	}
+
+	const ChunkStyle	styles[]		= { CS_Box, CS_Sphere, CS_Pyramid };
+	const char*			styleNames[]	= { "Box", "Sphere", "Pyramid" };
+	const unsigned int	styleCount		= ARRAYSIZE( styles );
+
+	// Indexed by whether the cache was enabled, then by style
+	long long			buildTimes[2][ARRAYSIZE(styles)]	= { 0 };
+	unsigned long long	indexCounts[2][ARRAYSIZE(styles)]	= { 0 };
+
+	unsigned int		hitCounts[ARRAYSIZE(styles)]		= { 0 };
+	unsigned int		lookupCounts[ARRAYSIZE(styles)]		= { 0 };
+	long long			savedTimes[ARRAYSIZE(styles)]		= { 0 };
+
+	// Lookups are only counted while the cache is enabled
+	bool isPassed = true;
+	for( unsigned int pass = 0; pass < 2 && isPassed; pass++ )
+	{
+		meshCache->SetIsEnabled( pass == 1 );
+
+		for( unsigned int round = 0; round < BENCHMARK_MESH_CACHE_ROUNDS && isPassed; round++ )
+		{
+			for( unsigned int i = 0; i < styleCount && isPassed; i++ )
+			{
+				unsigned int	hitCount	= meshCache->GetHitCount();
+				unsigned int	lookupCount	= hitCount + meshCache->GetMissCount();
+				long long		savedTime	= meshCache->GetSavedTime();
+
+				long long buildTime = RestyleWorld( styles[i] );
+				if( buildTime < 0 )
+				{
+					printf( "The world didn't settle within %u frames of being re-styled\n", BENCHMARK_SETTLE_FRAMES );
+					isPassed = false;
+					break;
+				}
+
+				buildTimes[pass][i]		+= buildTime;
+				indexCounts[pass][i]	= GetWorldIndexCount();
+
+				hitCounts[i]	+= meshCache->GetHitCount() - hitCount;
+				lookupCounts[i]	+= meshCache->GetHitCount() + meshCache->GetMissCount() - lookupCount;
+				savedTimes[i]	+= meshCache->GetSavedTime() - savedTime;
+			}
+		}
+	}
+
+	if( !isPassed )
+	{
+		meshCache->SetIsEnabled( true );
+		return false;
+	}
+
+	unsigned int chunkCount = BENCHMARK_MESH_CACHE_WIDTH * BENCHMARK_MESH_CACHE_DEPTH;
+	printf( "%u chunks re-styled %u times over, with the mesh cache disabled & enabled\n", chunkCount, BENCHMARK_MESH_CACHE_ROUNDS );
+
+	for( unsigned int i = 0; i < styleCount; i++ )
+	{
+		PrintMeshCacheResult( styleNames[i], buildTimes[0][i], buildTimes[1][i], hitCounts[i], lookupCounts[i], savedTimes[i], tickMilliseconds );
+
+		if( indexCounts[0][i] != indexCounts[1][i] )
+		{
+			printf( "The shared %s meshes have %llu indices, the built meshes %llu\n", styleNames[i], indexCounts[1][i], indexCounts[0][i] );
+			isPassed = false;
+		}
+	}
+
+	// Generated terrain only shares the meshes of chunks that are flat in the same places
+	long long			terrainTimes[2]			= { 0 };
+	unsigned long long	terrainIndexCounts[2]	= { 0 };
+
+	for( unsigned int pass = 0; pass < 2 && isPassed; pass++ )
+	{
+		meshCache->SetIsEnabled( pass == 1 );
+		meshCache->ResetStatistics();
+
+		terrainTimes[pass]			= StartWorld( BENCHMARK_MESH_CACHE_WIDTH, BENCHMARK_MESH_CACHE_DEPTH );
+		terrainIndexCounts[pass]	= GetWorldIndexCount();
+
+		if( terrainTimes[pass] < 0 )
+		{
+			printf( "The terrain didn't settle within %u frames\n", BENCHMARK_SETTLE_FRAMES );
+			isPassed = false;
+		}
+	}
+
+	meshCache->SetIsEnabled( true );
+
+	if( !isPassed )
+	{
+		return false;
+	}
+
+	PrintMeshCacheResult( "Terrain", terrainTimes[0], terrainTimes[1], meshCache->GetHitCount(), meshCache->GetHitCount() + meshCache->GetMissCount(),
+						  meshCache->GetSavedTime(), tickMilliseconds );
+
+	printf( "    The cache holds %u meshes (%.2fMB), %.2fMB of them unused, %u hash collisions\n", meshCache->GetEntryCount(),
+			meshCache->GetBytes() / (1024.0 * 1024.0), meshCache->GetUnusedBytes() / (1024.0 * 1024.0), meshCache->GetCollisionCount() );
+
+	if( terrainIndexCounts[0] != terrainIndexCounts[1] )
+	{
+		printf( "The shared terrain meshes have %llu indices, the built meshes %llu\n", terrainIndexCounts[1], terrainIndexCounts[0] );
+		isPassed = false;
+	}
+
+	return isPassed;
+}
+
+
+// Loads the bytecode of every shader through an empty shader cache, one at a time & then on the job system, then again
+// with the cache filled in. The headless engine has no device, so the shaders are only created for their requests
+bool CheckShaderCache()
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency( &frequency );
+
+	double tickMilliseconds = 1000.0 / (double)frequency.QuadPart;
+
+	std::vector<VEShader*>			shaders;
+	std::vector<VEShaderRequest*>	requests;
+	for( unsigned int i = 0; i < VST_Max; i++ )
+	{
+		VEShader* shader = VEShaderManager::CreateShader( (VEShaderType)i );
+		if( shader != NULL )
+		{
+			shader->GetShaderRequests( requests );
+			shaders.push_back( shader );
+		}
+	}
+
+	VEShaderFileStorage	shaderStorage;
+	VEShaderCache		shaderCache( &shaderStorage, VEHLSLCompiler::Compile, VEHLSLCompiler::GetVersion() );
+	bool				isPassed = shaderCache.Open( BENCHMARK_SHADER_CACHE_DIRECTORY );
+	if( !isPassed )
+	{
+		printf( "Unable to open the shader cache\n" );
+	}
+
+	const char*				passNames[]	= { "Cold, serial", "Cold, parallel", "Warm, parallel" };
+	const unsigned int		passCount	= ARRAYSIZE( passNames );
+	long long				loadTimes[ARRAYSIZE(passNames)]	= { 0 };
+
+	std::vector< std::vector<unsigned char> > compiledBytecode( requests.size() );
+
+	printf( "%u shaders (%u stages) loaded through the shader cache\n", (unsigned int)shaders.size(), (unsigned int)requests.size() );
+
+	for( unsigned int pass = 0; pass < passCount && isPassed; pass++ )
+	{
+		// Both cold loads start from an empty cache, the warm load uses what the parallel load wrote
+		if( pass < 2 )
+		{
+			shaderCache.Clear();
+		}
+		shaderCache.ResetStatistics();
+
+		long long startTime = VEProfiler::GetTime();
+		bool isLoaded = shaderCache.LoadAll( requests, pass == 0 ? NULL : VoxelEngine::GetInstance()->GetJobSystem() );
+		loadTimes[pass] = VEProfiler::GetTime() - startTime;
+
+		printf( "    %-16s %8.1fms, %2u of %2u stages from the cache, %8.1fms compiling\n", passNames[pass], loadTimes[pass] * tickMilliseconds,
+				shaderCache.GetHitCount(), (unsigned int)requests.size(), shaderCache.GetCompileTime() * tickMilliseconds );
+
+		for( unsigned int i = 0; i < requests.size() && isPassed; i++ )
+		{
+			if( !isLoaded && requests[i]->myBytecode.empty() )
+			{
+				printf( "%ls didn't compile: %s\n", requests[i]->myFile.c_str(), requests[i]->myErrors.c_str() );
+				isPassed = false;
+			}
+			else if( pass == 0 )
+			{
+				compiledBytecode[i] = requests[i]->myBytecode;
+			}
+			else if( requests[i]->myBytecode != compiledBytecode[i] )
+			{
+				printf( "%ls loaded different bytecode to the first cold load\n", requests[i]->myFile.c_str() );
+				isPassed = false;
+			}
+		}
+	}
+
+	if( isPassed && shaderCache.GetHitCount() != requests.size() )
+	{
+		printf( "The warm load compiled %u stages\n", shaderCache.GetMissCount() );
+		isPassed = false;
+	}
+
+	if( isPassed )
+	{
+		printf( "    The warm load took %.1f%% of the serial cold load\n", loadTimes[0] > 0 ? 100.0 * loadTimes[2] / loadTimes[0] : 0.0 );
+	}
+
+	shaderCache.Clear();
+	shaderCache.Close();
+
+	for( unsigned int i = 0; i < shaders.size(); i++ )
+	{
+		delete shaders[i];
+	}
+
+	return isPassed;
+}
+
+
+// An event posted by one of the event bus check's producers, numbered in the order the producer posted it
+class ProducerEvent : public VEEvent
+{
+	public :
+
+		// Construction
+		ProducerEvent( unsigned int aProducer, unsigned int aSequence ) : VEEvent( BT_BenchmarkEvent ),
+			myProducer( aProducer ),
+			mySequence( aSequence )
+		{
+		}
+
+		unsigned int	myProducer;
+		unsigned int	mySequence;
+};
+
+
+// A thread posting events to the event bus check's bus
+struct EventProducer
+{
+	VEEventBus*		myEventBus;
+	unsigned int	myProducer;
+};
+
+
+// What the event bus check's handler has seen: the sequence each producer's next event should have, and the events
+// that arrived out of order or from an unknown producer
+struct EventBusRecord
+{
+	std::vector<unsigned int>	myNextSequences;
+	unsigned int				myErrorCount;
+};
+
+
+// Posts a producer's events as fast as it can
+static unsigned int PostProducerEvents( void* aProducer )
+{
+	EventProducer* producer = reinterpret_cast<EventProducer*>( aProducer );
+
+	for( unsigned int i = 0; i < BENCHMARK_EVENT_PRODUCER_EVENTS; i++ )
+	{
+		producer->myEventBus->Post( new ProducerEvent(producer->myProducer, i) );
+	}
+
+	return 0;
+}
+
+
+// Checks each drained event is the next one its producer posted. An event lost, delivered twice or overtaken by a
+// later one from the same producer breaks the sequence
+static void RecordProducerEvent( VEEvent* anEvent, LPVOID aRecord )
+{
+	EventBusRecord* record	= reinterpret_cast<EventBusRecord*>( aRecord );
+	ProducerEvent*	event	= static_cast<ProducerEvent*>( anEvent );
+
+	if( event->myProducer >= record->myNextSequences.size() || event->mySequence != record->myNextSequences[event->myProducer] )
+	{
+		record->myErrorCount++;
+		return;
+	}
+
+	record->myNextSequences[event->myProducer]++;
+}
+
+
+// Posts events from several threads at once while the main thread drains them a frame's budget at a time
+bool CheckEventBus()
+{
+	VEEventBus		eventBus;
+	EventBusRecord	record;
+
+	record.myNextSequences.resize( BENCHMARK_EVENT_PRODUCERS, 0 );
+	record.myErrorCount = 0;
+
+	if( !eventBus.RegisterHandler(BT_BenchmarkEvent, RecordProducerEvent, &record) )
+	{
+		printf( "Unable to register the event handler\n" );
+		return false;
+	}
+
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency( &frequency );
+
+	long long startTime = VEProfiler::GetTime();
+
+	EventProducer	producers[BENCHMARK_EVENT_PRODUCERS];
+	VEThread		threads[BENCHMARK_EVENT_PRODUCERS];
+	bool			isStarted = true;
+	for( unsigned int i = 0; i < BENCHMARK_EVENT_PRODUCERS; i++ )
+	{
+		producers[i].myEventBus	= &eventBus;
+		producers[i].myProducer	= i;
+
+		isStarted = threads[i].Start( PostProducerEvents, &producers[i] ) && isStarted;
+	}
+
+	// Drain until every producer has finished and the queue is empty
+	unsigned int frameCount = 0;
+	for( ;; )
+	{
+		bool isFinished = true;
+		for( unsigned int i = 0; i < BENCHMARK_EVENT_PRODUCERS; i++ )
+		{
+			isFinished = isFinished && threads[i].IsFinished();
+		}
+
+		unsigned int drainedCount = eventBus.Drain( VE_EVENT_FRAME_BUDGET );
+		frameCount++;
+
+		if( drainedCount == 0 )
+		{
+			if( isFinished )
+			{
+				break;
+			}
+
+			VEThread::YieldThread();
+		}
+	}
+
+	for( unsigned int i = 0; i < BENCHMARK_EVENT_PRODUCERS; i++ )
+	{
+		threads[i].Join();
+	}
+
+	double seconds = (double)(VEProfiler::GetTime() - startTime) / (double)frequency.QuadPart;
+
+	eventBus.UnregisterHandler( BT_BenchmarkEvent, RecordProducerEvent, &record );
+
+	unsigned int expectedCount	= BENCHMARK_EVENT_PRODUCERS * BENCHMARK_EVENT_PRODUCER_EVENTS;
+	unsigned int receivedCount	= 0;
+	for( unsigned int i = 0; i < BENCHMARK_EVENT_PRODUCERS; i++ )
+	{
+		receivedCount += record.myNextSequences[i];
+	}
+
+	printf( "%u producers posted %u events, %u drained in order over %u drains in %.3fs (%.0f events/s)\n", BENCHMARK_EVENT_PRODUCERS,
+			eventBus.GetPostedCount(), receivedCount, frameCount, seconds, seconds > 0.0 ? (double)receivedCount / seconds : 0.0 );
+
+	// Bucket n counts the events that waited between 2^n and 2^(n+1) microseconds
+	printf( "Post to drain latency:\n" );
+
+	const unsigned int* histogram = eventBus.GetLatencyHistogram();
+	for( unsigned int i = 0; i < VE_EVENT_LATENCY_BUCKETS; i++ )
+	{
+		if( histogram[i] == 0 )
+		{
+			continue;
+		}
+
+		// The first bucket also counts the events that didn't wait at all, the last everything slower
+		unsigned int lowerBound = i == 0 ? 0 : 1u << i;
+		if( i == VE_EVENT_LATENCY_BUCKETS - 1 )
+		{
+			printf( "    %10u +            us   %10u events\n", lowerBound, histogram[i] );
+		}
+		else
+		{
+			printf( "    %10u - %-10u us   %10u events\n", lowerBound, 1u << (i + 1), histogram[i] );
+		}
+	}
+
+	if( !isStarted )
+	{
+		printf( "Unable to start every producer\n" );
+		return false;
+	}
+
+	if( record.myErrorCount > 0 || receivedCount != expectedCount || eventBus.GetDrainedCount() != expectedCount )
+	{
+		printf( "%u events arrived out of order, %u of %u arrived\n", record.myErrorCount, receivedCount, expectedCount );
+		return false;
+	}
+
+	return true;
+}
+
+
+// Times a profiling zone, recorded & collected, and counts the zones recorded by frames that rebuild a chunk
+bool CheckProfilerOverhead()
+{
+#ifdef VE_PROFILING_ENABLED
+	double frequency = (double)VEProfiler::GetFrequency();
+
+	// A zone's whole cost: reading the counter twice, recording the zone in the thread's buffer and collecting it at
+	// the end of a frame. The buffer is collected before it fills, so no zone is dropped
+	long long startTime = VEProfiler::GetTime();
+	for( unsigned int i = 0; i < BENCHMARK_PROFILER_ZONES; i++ )
+	{
+		{
+			VE_PROFILE_ZONE( "CheckProfilerOverhead" );
+		}
+
+		if( i % (VE_PROFILE_BUFFER_SIZE / 2) == 0 )
+		{
+			VEProfiler::EndFrame();
+		}
+	}
+	VEProfiler::EndFrame();
+
+	double zoneTime = (double)( VEProfiler::GetTime() - startTime ) / frequency / (double)BENCHMARK_PROFILER_ZONES;
+
+	// Frames that rebuild a chunk, as frames do while the player walks, with their zones counted as they're collected
+	VoxelEngine*	voxelEngine	= VoxelEngine::GetInstance();
+	VEChunk*		chunk		= GetBenchmarkChunk();
+
+	chunk->PrepareBuild();
+	chunk->BuildData();
+	voxelEngine->RunFrames( 1, BENCHMARK_TIME_STEP );
+
+	unsigned long long	firstZoneCount	= VEProfiler::GetCollectedZoneCount();
+	unsigned int		droppedCount	= VEProfiler::GetDroppedZoneCount();
+
+	startTime = VEProfiler::GetTime();
+	for( unsigned int i = 0; i < BENCHMARK_PROFILER_FRAMES; i++ )
+	{
+		chunk->PrepareBuild();
+		chunk->BuildData();
+		voxelEngine->RunFrames( 1, BENCHMARK_TIME_STEP );
+	}
+
+	double frameTime		= (double)( VEProfiler::GetTime() - startTime ) / frequency / (double)BENCHMARK_PROFILER_FRAMES;
+	double zonesPerFrame	= (double)( VEProfiler::GetCollectedZoneCount() - firstZoneCount ) / (double)BENCHMARK_PROFILER_FRAMES;
+
+	// Compared against the frame without its zones, as it would run with profiling compiled out
+	double zonesTime	= zonesPerFrame * zoneTime;
+	double overhead		= frameTime > zonesTime ? 100.0 * zonesTime / (frameTime - zonesTime) : 100.0;
+
+	printf( "A zone costs %.1fns recorded & collected\n", zoneTime * 1000000000.0 );
+	printf( "%.1f zones a frame, %.3fms a frame rebuilding a chunk\n", zonesPerFrame, frameTime * 1000.0 );
+	printf( "Profiling adds %.3f%% to the frame (at most %.1f%%)\n", overhead, BENCHMARK_PROFILER_MAX_OVERHEAD );
+
+	if( VEProfiler::GetDroppedZoneCount() != droppedCount )
+	{
+		printf( "%u zones were dropped, so the overhead is under counted\n", VEProfiler::GetDroppedZoneCount() - droppedCount );
+		return false;
+	}
+
+	return overhead < BENCHMARK_PROFILER_MAX_OVERHEAD;
+#else
+	printf( "Profiling is compiled out, zones cost nothing\n" );
+
+	return true;
+#endif
+}
+
+
+// Checksums a mesh's vertices & indices. Indices are mixed in as 32 bit values, so the checksum doesn't depend on the
+// size of an unsigned long
+static unsigned int ChecksumMesh( const VEMeshScratch& aScratch )
+{
+	unsigned int checksum = 2166136261u;
+
+	const unsigned char*	vertexBytes	= aScratch.myVertices.empty() ? NULL : (const unsigned char*)&aScratch.myVertices[0];
+	size_t					vertexSize	= aScratch.myVertices.size() * sizeof(VoxelVertices);
+	for( size_t i = 0; i < vertexSize; i++ )
+	{
+		checksum = (checksum ^ vertexBytes[i]) * 16777619u;
+	}
+
+	for( size_t i = 0; i < aScratch.myIndices.size(); i++ )
+	{
+		unsigned int index = (unsigned int)aScratch.myIndices[i];
+		for( unsigned int byte = 0; byte < sizeof(index); byte++ )
+		{
+			checksum = (checksum ^ ((index >> (byte * 8)) & 0xFF)) * 16777619u;
+		}
+	}
+
+	return checksum;
+}
+
+
+// Whether two meshes have the same vertices & indices, in the same order
+static bool CompareMeshes( const VEMeshScratch& aScratch, const VEMeshScratch& anOtherScratch )
+{
+	if( aScratch.myVertices.size() != anOtherScratch.myVertices.size() || aScratch.myIndices.size() != anOtherScratch.myIndices.size() )
+	{
+		return false;
+	}
+
+	return aScratch.myVertices.empty() ||
+		   ( memcmp(&aScratch.myVertices[0], &anOtherScratch.myVertices[0], aScratch.myVertices.size() * sizeof(VoxelVertices)) == 0 &&
+			 memcmp(&aScratch.myIndices[0], &anOtherScratch.myIndices[0], aScratch.myIndices.size() * sizeof(unsigned long)) == 0 );
+}
+
+
+// Meshes a chunk of seeded random voxels, with a neighbour of random voxels behind & to its right, on the calling
+// thread and split across the worker threads by Y-slab
+bool CheckMeshBuild()
+{
+	VEChunkManager*	chunkManager	= VoxelEngine::GetInstance()->GetChunkManager();
+	int				dimensions		= chunkManager->GetChunkDimensions();
+
+	if( dimensions != BENCHMARK_MESH_BUILD_DIMENSIONS )
+	{
+		printf( "The world's chunks are %d voxels across, the golden checksum is for %d\n", dimensions, BENCHMARK_MESH_BUILD_DIMENSIONS );
+		return false;
+	}
+
+	VEChunk* chunk		= chunkManager->CreateChunk( XMFLOAT3(0.0f, 0.0f, 0.0f), -1, -1 );
+	VEChunk* neighbour	= chunkManager->CreateChunk( XMFLOAT3(0.0f, 0.0f, 0.0f), -1, -1 );
+	if( chunk == NULL || neighbour == NULL )
+	{
+		chunkManager->DestroyChunk( chunk );
+		chunkManager->DestroyChunk( neighbour );
+		return false;
+	}
+
+	// Voxels get sparser towards the top of the chunks, so the mesh has buried voxels, exposed voxels & holes
+	unsigned int	randomState	= BENCHMARK_SEED;
+	VEChunk*		chunks[2]	= { chunk, neighbour };
+	for( unsigned int i = 0; i < ARRAYSIZE(chunks); i++ )
+	{
+		VEVoxel* voxels = chunks[i]->GetVoxels();
+		for( int x = 0; x < dimensions; x++ )
+		{
+			for( int y = 0; y < dimensions; y++ )
+			{
+				for( int z = 0; z < dimensions; z++ )
+				{
+					voxels[chunks[i]->GetVoxelIndex(x, y, z)].SetEnabled( (int)(NextRandom(randomState) % dimensions) >= y );
+				}
+			}
+		}
+	}
+
+	VEChunk* neighbours[CN_Max] = { NULL };
+	neighbours[CN_Right]	= neighbour;
+	neighbours[CN_Back]		= neighbour;
+
+	VEMeshScratch serialScratch;
+	serialScratch.mySnapshot.Capture( chunk, neighbours );
+	serialScratch.mySnapshot.CalculateVisibility();
+
+	VEMeshScratch parallelScratch;
+	parallelScratch.mySnapshot.Capture( chunk, neighbours );
+	parallelScratch.mySnapshot.CalculateVisibility();
+
+	chunkManager->DestroyChunk( chunk );
+	chunkManager->DestroyChunk( neighbour );
+
+	VEChunkData::BuildMesh( serialScratch, false );
+
+	unsigned int	serialChecksum	= ChecksumMesh( serialScratch );
+	bool			isPassed		= true;
+
+	printf( "%u faces, mesh checksum %08x (golden %08x)\n", (unsigned int)serialScratch.myIndices.size() / 6, serialChecksum, BENCHMARK_MESH_BUILD_CHECKSUM );
+
+	if( serialChecksum != BENCHMARK_MESH_BUILD_CHECKSUM )
+	{
+		printf( "The serial mesh doesn't match the golden checksum\n" );
+		isPassed = false;
+	}
+
+	// The slabs are split up differently each run, so the parallel build is repeated to catch slabs that overlap
+	for( unsigned int i = 0; i < BENCHMARK_MESH_BUILD_RUNS; i++ )
+	{
+		VEChunkData::BuildMesh( parallelScratch, true );
+
+		if( !CompareMeshes(parallelScratch, serialScratch) )
+		{
+			printf( "Parallel build %u differs from the serial build, checksum %08x\n", i, ChecksumMesh(parallelScratch) );
+			isPassed = false;
+			break;
+		}
+	}
+
+	return isPassed;
+}
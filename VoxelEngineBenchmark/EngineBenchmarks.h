@@ -0,0 +1,200 @@
+#ifndef ENGINE_BENCHMARKS_H
+#define ENGINE_BENCHMARKS_H
+
+
+// ---------------- Defines -----------------
+
+// The seed & size of the world the benchmarks run against. Changing any of these invalidates existing baselines
+#define BENCHMARK_SEED					1337
+#define BENCHMARK_WORLD_WIDTH			4
+#define BENCHMARK_WORLD_DEPTH			4
+
+#define BENCHMARK_OBJECT_COUNT			10000
+#define BENCHMARK_COMPONENT_COUNT		50000
+#define BENCHMARK_MOVEMENT_COUNT		100000
+#define BENCHMARK_EVENT_COUNT			10000
+
+// The number of threads the event bus check posts from at once, and the events each of them posts
+#define BENCHMARK_EVENT_PRODUCERS		8
+#define BENCHMARK_EVENT_PRODUCER_EVENTS	100000
+
+// The zones the profiler overhead check records to time a single zone, the frames it counts zones over, and the
+// percentage of a frame the zones may cost
+#define BENCHMARK_PROFILER_ZONES		1000000
+#define BENCHMARK_PROFILER_FRAMES		200
+#define BENCHMARK_PROFILER_MAX_OVERHEAD	1.0
+
+// The chunk dimensions the mesh build check's golden checksum is for, the checksum of the mesh it builds, and the
+// number of times it builds the mesh split across threads. Changing the mesher's output changes the checksum
+#define BENCHMARK_MESH_BUILD_DIMENSIONS	64
+#define BENCHMARK_MESH_BUILD_CHECKSUM	0xf45d54a0u
+#define BENCHMARK_MESH_BUILD_RUNS		16
+
+// The number of objects the object lookup, iteration & churn benchmarks register, the objects the churn benchmark
+// removes & registers again per iteration, and the slots the lookup benchmark recycles until their generations wrap
+#define BENCHMARK_HANDLE_OBJECT_COUNT	100000
+#define BENCHMARK_HANDLE_CHURN_COUNT	10000
+#define BENCHMARK_HANDLE_WRAP_SLOTS		64
+
+// The number of chunks the streaming benchmarks load & unload per iteration, and how many are loaded at once
+#define BENCHMARK_STREAMING_COUNT		1000
+#define BENCHMARK_STREAMING_WINDOW		32
+
+// Where the world store benchmarks save the world, emptied before each benchmark
+#define BENCHMARK_WORLD_STORE_DIRECTORY	L"Data/BenchmarkWorld/"
+
+// Where the edit journal check opens the engine's world store, the edits it makes and the size of the torn block it
+// appends to the journal
+#define BENCHMARK_JOURNAL_DIRECTORY		L"Data/BenchmarkJournal/"
+#define BENCHMARK_JOURNAL_EDITS			1000000
+#define BENCHMARK_JOURNAL_TORN_SIZE		1000
+
+// The size of the world the startup check generates, and where it caches the world
+#define BENCHMARK_STARTUP_WIDTH			16
+#define BENCHMARK_STARTUP_DEPTH			16
+#define BENCHMARK_CACHE_DIRECTORY		L"Data/BenchmarkCache/"
+
+// The size of the world the compression check builds, and how long its chunks sit untouched before they're compressed
+// in milliseconds
+#define BENCHMARK_COMPRESSION_WIDTH		16
+#define BENCHMARK_COMPRESSION_DEPTH		16
+#define BENCHMARK_COMPRESSION_DELAY		1000
+
+// The size of the world the memory budget check walks across, how far the walk sees, the frames it takes to cross the
+// world & come back, and the budgets it keeps to in megabytes
+#define BENCHMARK_BUDGET_WIDTH			32
+#define BENCHMARK_BUDGET_DEPTH			4
+#define BENCHMARK_BUDGET_VIEW_DISTANCE	192.0f
+#define BENCHMARK_BUDGET_WALK_FRAMES	4000
+#define BENCHMARK_BUDGET_VOXELS			64
+#define BENCHMARK_BUDGET_CPU_MESHES		8
+#define BENCHMARK_BUDGET_GPU_MESHES		96
+
+// The size of the world the mesh cache check re-styles, and the number of times it goes through the styles
+#define BENCHMARK_MESH_CACHE_WIDTH		8
+#define BENCHMARK_MESH_CACHE_DEPTH		8
+#define BENCHMARK_MESH_CACHE_ROUNDS		2
+
+// Where the shader cache check keeps the bytecode it compiles, emptied before & after the check
+#define BENCHMARK_SHADER_CACHE_DIRECTORY	L"Data/BenchmarkShaderCache/"
+
+// The shader & the file it includes that the shader key check keeps in memory
+#define BENCHMARK_SHADER_STUB_FILE			L"Shaders/StubShader.hlsl"
+#define BENCHMARK_SHADER_STUB_INCLUDE		L"Shaders/StubCommon.hlsli"
+
+// The number of variants of the stub shader the shader key check loads at once on the job system
+#define BENCHMARK_SHADER_STUB_JOBS			8
+
+// The number of threads reading a chunk while another thread edits it, and the voxels each reader reads per iteration
+#define BENCHMARK_CONTENTION_READERS	8
+#define BENCHMARK_CONTENTION_READS		100000
+
+// The time each present spends busy in the null render backend during the pipelined rendering benchmarks, in
+// milliseconds
+#define BENCHMARK_PRESENT_TIME			4.0
+
+// The fixed time step passed to the update benchmarks
+#define BENCHMARK_TIME_STEP				(1.0f / 60.0f)
+
+// The number of frames each frame scheduler check runs, and the work each frame does in the light & heavy checks, in
+// seconds
+#define BENCHMARK_SCHEDULER_FRAMES		600
+#define BENCHMARK_SCHEDULER_LIGHT_WORK	0.005
+#define BENCHMARK_SCHEDULER_HEAVY_WORK	0.035
+
+// The number of frames the input latency check runs, and the frames (counted from the start of the check) its key
+// press & mouse movement arrive in
+#define BENCHMARK_INPUT_FRAMES			30
+#define BENCHMARK_INPUT_KEY_FRAME		10
+#define BENCHMARK_INPUT_MOUSE_FRAME		20
+
+// The number of frames the allocation check runs once the world has settled, and the number of frames it waits
+// for the world to settle
+#define BENCHMARK_STEADY_STATE_FRAMES	300
+#define BENCHMARK_SETTLE_FRAMES			10000
+
+
+// ---------- Forward Declarations ----------
+
+class BenchmarkRunner;
+
+
+// ---------------- Functions ---------------
+
+// Adds the engine's CPU benchmarks to the runner. The engine must have been initialised and the benchmark
+// world generated first
+void AddEngineBenchmarks( BenchmarkRunner* aRunner );
+
+// Runs the engine until every chunk has been built, then checks that steady-state frames make no heap allocations
+// on the main thread. Prints the allocations accounted against each memory tag, returns false if any frame allocated
+bool CheckFrameAllocations();
+
+// Checks the frame scheduler's pacing against a manual clock: capped frames keep to their deadlines without drifting,
+// slow frames run enough simulation steps to keep up, stalls are clamped and uncapped frames never wait. Then paces
+// a second of empty frames with the system clock and prints how closely the deadlines were met & the CPU used.
+// Returns false if a manual clock check fails
+bool CheckFrameScheduler();
+
+// Replays a key press at the start of a frame, and mouse movement that arrives after a frame has been simulated, then
+// prints how many frames later each reached the simulation & the screen. Returns false if the key press wasn't
+// delivered in the frame it arrived in, or the mouse movement wasn't late latched in to the frame it arrived in
+bool CheckInputLatency();
+
+// Makes a million random voxel edits through VEChunk::SetVoxel with the engine's world store open, restyling a chunk
+// half way through, then tears the journal's last block the way a crash would and replays the edits that survive in
+// to fresh copies of the world's chunks, and in to a snapshot of the restyled chunk. Prints the journal's write
+// bandwidth and the recovery time, then compacts the journal and checks it still replays the same voxels, including a
+// voxel changed back after a snapshot was captured. Returns false if the edits weren't all recovered, or replayed to
+// different voxels
+bool CheckEditJournal();
+
+// Generates a larger world with an empty world cache and runs frames until every chunk has been built, then does the
+// same again with the cache filled in. Prints both startup times, the cache's hits and its size on disk. Returns false
+// if the warm start didn't take every chunk's voxels & mesh from the cache, or built different meshes
+bool CheckStartupCache();
+
+// Builds a larger world and runs frames without touching it until every chunk's voxels have been compressed, then
+// reads a voxel from each chunk. Prints the resident memory before & after, and how long the first access to each
+// chunk took. Returns false if a chunk wasn't compressed, or decompressed to different voxels
+bool CheckChunkCompression();
+
+// Checks the memory budget's eviction choices against hand-worked cases, then walks the view across a larger world
+// and back with budgets for the voxels & meshes. Prints the peak resident memory during the walk, each budget's peak
+// usage and what was evicted. Returns false if an eviction choice was wrong, or the world didn't come back with the
+// same voxels & meshes once the budgets were lifted
+bool CheckMemoryBudget();
+
+// Re-styles every chunk of a world as boxes, spheres & pyramids in turn, then generates terrain, first with the mesh
+// cache disabled & then enabled. Prints each style's rebuild time both ways, the cache's hit rate and the build time
+// its hits saved. Returns false if a world didn't settle, or the shared meshes differ from the built ones
+bool CheckMeshCache();
+
+// Loads the bytecode of every shader the engine has through an empty shader cache, one shader at a time and then on
+// the job system, then again with the cache filled in. Prints each load's time & the time spent compiling. Returns false
+// if a shader didn't compile, the warm load compiled anything, or the cached bytecode differs from the compiled
+bool CheckShaderCache();
+
+// Loads a shader through a shader cache kept in memory, with a stub in place of the D3D compiler. Changes the file it
+// includes, its defines and the compiler's version, and tears its entry, checking each is compiled again and that the
+// load after it is a hit, then loads variants of it at once on the job system. Doesn't need the Windows SDK, so it can
+// be built & run anywhere the cache can. Returns false if any load was a hit or a miss when it shouldn't have been, or
+// loaded the wrong bytecode
+bool CheckShaderKeys();
+
+// Posts events from several threads at once while the main thread drains them a frame's budget at a time. Prints the
+// throughput and the histogram of each event's wait from post to drain. Returns false if an event was lost, delivered
+// twice or delivered before an earlier event from the same thread
+bool CheckEventBus();
+
+// Times a profiling zone, recorded & collected, and counts the zones recorded by frames that rebuild a chunk. Prints
+// the share of the frame the zones would cost over a build with profiling compiled out. Returns false if it's more
+// than BENCHMARK_PROFILER_MAX_OVERHEAD percent
+bool CheckProfilerOverhead();
+
+// Meshes a chunk of seeded random voxels, with a neighbour's halo on two sides, on the calling thread and then several
+// times split across threads by Y-slab. Prints the mesh's checksum. Returns false if the serial mesh doesn't match
+// BENCHMARK_MESH_BUILD_CHECKSUM, or a parallel mesh differs from the serial one
+bool CheckMeshBuild();
+
+
+#endif // !ENGINE_BENCHMARKS_H
@@ -0,0 +1,289 @@
+
+// ------------------ Includes ------------------
+
+#include "Stdafx.h"
+
+#include "BenchmarkRunner.h"
+#include "EngineBenchmarks.h"
+
+#include "VoxelEngine.h"
+#include "VETerrainGenerator.h"
+#include "VEChunkManager.h"
+#include "VEMeshCache.h"
+#include "VETaskGraph.h"
+
+
+// ------------------ Functions -----------------
+
+// Generates the benchmark world, run by the engine's startup graph once the systems are created
+static void GenerateWorldTask( void* anEngine )
+{
+	VoxelEngine* voxelEngine = reinterpret_cast<VoxelEngine*>( anEngine );
+
+	// The benchmarks are timed against uncompressed chunks & meshes built from scratch, only the compression & mesh
+	// cache checks compress or share them
+	voxelEngine->GetChunkManager()->SetCompressionDelay( 0 );
+	voxelEngine->GetChunkManager()->GetMeshCache()->SetIsEnabled( false );
+
+	VETerrainGenerator* terrainGenerator = voxelEngine->GetTerrainGenerator();
+	terrainGenerator->SetSeed( BENCHMARK_SEED );
+	terrainGenerator->GenerateTerrain( BENCHMARK_WORLD_WIDTH, BENCHMARK_WORLD_DEPTH );
+}
+
+
+// Prints the command line options
+static void PrintUsage()
+{
+	printf( "Usage: VoxelEngineBenchmark [options]\n" );
+	printf( "  --output <file>       Writes the results to a JSON file (default BenchmarkResults.json)\n" );
+	printf( "  --baseline <file>     Compares the results against a previously written results file\n" );
+	printf( "  --threshold <value>   Slowdown allowed before a benchmark is flagged, as a fraction (default %.2f)\n", BENCHMARK_REGRESSION_THRESHOLD );
+	printf( "  --filter <name>       Only runs the benchmarks whose name contains the filter\n" );
+	printf( "  --check-allocations   Checks that steady-state frames make no heap allocations, instead of benchmarking\n" );
+	printf( "  --check-scheduler     Checks the frame scheduler's pacing, instead of benchmarking\n" );
+	printf( "  --check-input         Measures input latency in frames with replayed input, instead of benchmarking\n" );
+	printf( "  --check-journal       Checks the edit journal's recovery & measures its bandwidth, instead of benchmarking\n" );
+	printf( "  --check-startup       Measures cold & warm startup with the world cache, instead of benchmarking\n" );
+	printf( "  --check-compression   Measures the memory saved by compressing untouched chunks, instead of benchmarking\n" );
+	printf( "  --check-budget        Checks the memory budget's evictions & measures a long walk's memory, instead of benchmarking\n" );
+	printf( "  --check-mesh-cache    Measures the rebuild time the mesh cache saves re-styling chunks, instead of benchmarking\n" );
+	printf( "  --check-shader-cache  Measures cold & warm shader loads with the shader cache, instead of benchmarking\n" );
+	printf( "  --check-shader-keys   Checks what makes the shader cache compile again, instead of benchmarking\n" );
+	printf( "  --check-event-bus     Checks events posted from many threads arrive once & in order, instead of benchmarking\n" );
+	printf( "  --check-profiler      Measures the share of a frame the profiler's zones cost, instead of benchmarking\n" );
+	printf( "  --check-mesh-build    Checks serial & parallel chunk meshing build the golden mesh, instead of benchmarking\n" );
+	printf( "  --graph <file>        Writes the frame's task graph, with the last frame's task timings, to a Graphviz dot file\n" );
+	printf( "  --startup <file>      Writes each startup task's timings and the time to the first frame to a text file\n" );
+}
+
+
+// Entry point for the benchmarks - initialises a headless engine, generates a fixed world and times the
+// engine's CPU hot paths. Returns non-zero if a benchmark fails or regresses against the baseline
+int wmain( int anArgumentCount, wchar_t* someArguments[] )
+{
+	std::wstring	outputFile		= L"BenchmarkResults.json";
+	std::wstring	baselineFile	= L"";
+	std::wstring	graphFile		= L"";
+	std::wstring	startupFile		= L"";
+	std::string		filter			= "";
+	float			threshold		= BENCHMARK_REGRESSION_THRESHOLD;
+	bool			checkAllocations	= false;
+	bool			checkScheduler		= false;
+	bool			checkInput			= false;
+	bool			checkJournal		= false;
+	bool			checkStartup		= false;
+	bool			checkCompression	= false;
+	bool			checkBudget			= false;
+	bool			checkMeshCache		= false;
+	bool			checkShaderCache	= false;
+	bool			checkShaderKeys		= false;
+	bool			checkEventBus		= false;
+	bool			checkProfiler		= false;
+	bool			checkMeshBuild		= false;
+
+	for( int i = 1; i < anArgumentCount; i++ )
+	{
+		std::wstring argument = someArguments[i];
+		bool hasValue = i + 1 < anArgumentCount;
+
+		if( argument == L"--output" && hasValue )
+		{
+			outputFile = someArguments[++i];
+		}
+		else if( argument == L"--baseline" && hasValue )
+		{
+			baselineFile = someArguments[++i];
+		}
+		else if( argument == L"--graph" && hasValue )
+		{
+			graphFile = someArguments[++i];
+		}
+		else if( argument == L"--startup" && hasValue )
+		{
+			startupFile = someArguments[++i];
+		}
+		else if( argument == L"--threshold" && hasValue )
+		{
+			threshold = (float)_wtof( someArguments[++i] );
+		}
+		else if( argument == L"--filter" && hasValue )
+		{
+			std::wstring wideFilter = someArguments[++i];
+			filter.assign( wideFilter.begin(), wideFilter.end() );
+		}
+		else if( argument == L"--check-allocations" )
+		{
+			checkAllocations = true;
+		}
+		else if( argument == L"--check-scheduler" )
+		{
+			checkScheduler = true;
+		}
+		else if( argument == L"--check-input" )
+		{
+			checkInput = true;
+		}
+		else if( argument == L"--check-journal" )
+		{
+			checkJournal = true;
+		}
+		else if( argument == L"--check-startup" )
+		{
+			checkStartup = true;
+		}
+		else if( argument == L"--check-compression" )
+		{
+			checkCompression = true;
+		}
+		else if( argument == L"--check-budget" )
+		{
+			checkBudget = true;
+		}
+		else if( argument == L"--check-mesh-cache" )
+		{
+			checkMeshCache = true;
+		}
+		else if( argument == L"--check-shader-cache" )
+		{
+			checkShaderCache = true;
+		}
+		else if( argument == L"--check-shader-keys" )
+		{
+			checkShaderKeys = true;
+		}
+		else if( argument == L"--check-event-bus" )
+		{
+			checkEventBus = true;
+		}
+		else if( argument == L"--check-profiler" )
+		{
+			checkProfiler = true;
+		}
+		else if( argument == L"--check-mesh-build" )
+		{
+			checkMeshBuild = true;
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	// Initialise the engine without a window or GPU, generating the benchmark world as part of its startup
+	VoxelEngine* voxelEngine = VoxelEngine::GetInstance();
+	assert( voxelEngine != NULL );
+
+	voxelEngine->AddStartupTask( "World", GenerateWorldTask, voxelEngine, SR_Systems, SR_World );
+
+	if( !voxelEngine->InitialiseHeadless(L"Data/") )
+	{
+		printf( "Unable to initialise the engine\n" );
+
+		voxelEngine->Uninitialise();
+		VoxelEngine::Cleanup();
+		return 1;
+	}
+
+	// Run the benchmarks, or one of the checks
+	int exitCode = 0;
+	if( checkAllocations )
+	{
+		exitCode = CheckFrameAllocations() ? 0 : 1;
+	}
+	else if( checkScheduler )
+	{
+		exitCode = CheckFrameScheduler() ? 0 : 1;
+	}
+	else if( checkInput )
+	{
+		exitCode = CheckInputLatency() ? 0 : 1;
+	}
+	else if( checkJournal )
+	{
+		exitCode = CheckEditJournal() ? 0 : 1;
+	}
+	else if( checkStartup )
+	{
+		exitCode = CheckStartupCache() ? 0 : 1;
+	}
+	else if( checkCompression )
+	{
+		exitCode = CheckChunkCompression() ? 0 : 1;
+	}
+	else if( checkBudget )
+	{
+		exitCode = CheckMemoryBudget() ? 0 : 1;
+	}
+	else if( checkMeshCache )
+	{
+		exitCode = CheckMeshCache() ? 0 : 1;
+	}
+	else if( checkShaderCache )
+	{
+		exitCode = CheckShaderCache() ? 0 : 1;
+	}
+	else if( checkShaderKeys )
+	{
+		exitCode = CheckShaderKeys() ? 0 : 1;
+	}
+	else if( checkEventBus )
+	{
+		exitCode = CheckEventBus() ? 0 : 1;
+	}
+	else if( checkProfiler )
+	{
+		exitCode = CheckProfilerOverhead() ? 0 : 1;
+	}
+	else if( checkMeshBuild )
+	{
+		exitCode = CheckMeshBuild() ? 0 : 1;
+	}
+	else
+	{
+		BenchmarkRunner runner;
+		AddEngineBenchmarks( &runner );
+
+		if( !runner.Run(filter) )
+		{
+			exitCode = 1;
+		}
+
+		if( !runner.WriteResults(outputFile, BENCHMARK_SEED) )
+		{
+			printf( "Unable to write the results file\n" );
+			exitCode = 1;
+		}
+
+		if( !baselineFile.empty() )
+		{
+			unsigned int regressionCount = 0;
+			if( !runner.CompareToBaseline(baselineFile, threshold, regressionCount) )
+			{
+				exitCode = 1;
+			}
+			else if( regressionCount > 0 )
+			{
+				printf( "%u benchmark(s) regressed\n", regressionCount );
+				exitCode = 1;
+			}
+		}
+	}
+
+	if( !graphFile.empty() && !voxelEngine->GetFrameGraph()->ExportDot(graphFile) )
+	{
+		printf( "Unable to write the task graph file\n" );
+		exitCode = 1;
+	}
+
+	if( !startupFile.empty() && !voxelEngine->WriteStartupReport(startupFile) )
+	{
+		printf( "Unable to write the startup report\n" );
+		exitCode = 1;
+	}
+
+	voxelEngine->Uninitialise();
+	VoxelEngine::Cleanup();
+
+	return exitCode;
+}
@@ -0,0 +1,251 @@
+// ------------------ Includes ------------------
+
+// Built without the precompiled header, so the shader key check can be built & run without the Windows SDK or D3D
+#include "EngineBenchmarks.h"
+
+#include "VEShaderCache.h"
+#include "VEShaderStorage.h"
+#include "VEJobSystem.h"
+#include "VEThreading.h"
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+
+// ------------------- Classes ------------------
+
+// Keeps the shader key check's files in memory
+class MemoryShaderStorage : public VEShaderStorage
+{
+	public :
+
+		// Every directory exists
+		virtual bool MakeDirectory( const std::wstring& aDirectory ) override
+		{
+			return true;
+		}
+
+		// Reads a file
+		virtual bool ReadData( const std::wstring& aFile, std::string& someData ) override
+		{
+			VEScopedLock<VEMutex> lock( myLock );
+
+			std::map<std::wstring, std::string>::iterator iter = myFiles.find( aFile );
+			if( iter == myFiles.end() )
+			{
+				return false;
+			}
+
+			someData = iter->second;
+			return true;
+		}
+
+		// Writes a file
+		virtual bool WriteData( const std::wstring& aFile, const std::string& someData ) override
+		{
+			VEScopedLock<VEMutex> lock( myLock );
+
+			myFiles[aFile] = someData;
+			return true;
+		}
+
+		// Deletes the directory's files with the extension
+		virtual void DeleteData( const std::wstring& aDirectory, const wchar_t* anExtension ) override
+		{
+			VEScopedLock<VEMutex> lock( myLock );
+
+			std::map<std::wstring, std::string>::iterator iter = myFiles.begin();
+			while( iter != myFiles.end() )
+			{
+				if( IsInDirectory(iter->first, aDirectory, anExtension) )
+				{
+					iter = myFiles.erase( iter );
+				}
+				else
+				{
+					iter++;
+				}
+			}
+		}
+
+		// Cuts the directory's files with the extension in half, the way a crash part way through writing them would
+		void TearData( const std::wstring& aDirectory, const wchar_t* anExtension )
+		{
+			VEScopedLock<VEMutex> lock( myLock );
+
+			for( std::map<std::wstring, std::string>::iterator iter = myFiles.begin(); iter != myFiles.end(); iter++ )
+			{
+				if( IsInDirectory(iter->first, aDirectory, anExtension) )
+				{
+					iter->second.resize( iter->second.size() / 2 );
+				}
+			}
+		}
+
+	private :
+
+		// Whether a file is in the directory & has the extension
+		static bool IsInDirectory( const std::wstring& aFile, const std::wstring& aDirectory, const wchar_t* anExtension )
+		{
+			std::wstring extension( anExtension );
+
+			return aFile.size() >= aDirectory.size() + extension.size() && aFile.compare( 0, aDirectory.size(), aDirectory ) == 0 &&
+				   aFile.compare( aFile.size() - extension.size(), extension.size(), extension ) == 0;
+		}
+
+		VEMutex								myLock;
+		std::map<std::wstring, std::string>	myFiles;
+};
+
+
+
+// ------------------ Functions -----------------
+
+// Stands in for the D3D compiler in the shader key check, the bytecode is the defines followed by the source
+static bool CompileStubShader( const VEShaderRequest& aRequest, const std::string& aSource, std::vector<unsigned char>& someBytecode, std::string& someErrors )
+{
+	std::string bytecode = aRequest.myDefines + "\n" + aSource;
+	someBytecode.assign( bytecode.begin(), bytecode.end() );
+
+	return true;
+}
+
+
+// Loads the shader key check's request and prints whether it was a hit. Returns false if it failed, wasn't the hit or
+// miss expected, or a hit didn't load the bytecode the last miss compiled
+static bool LoadStubShader( VEShaderCache& aShaderCache, VEShaderRequest& aRequest, const char* aName, bool anIsHit,
+							std::vector<unsigned char>& someCompiledBytecode )
+{
+	aShaderCache.ResetStatistics();
+
+	bool isLoaded = aShaderCache.Load( aRequest );
+
+	printf( "    %-30s %s\n", aName, !isLoaded ? "failed" : aRequest.myIsCached ? "hit" : "miss" );
+
+	if( !isLoaded || aRequest.myIsCached != anIsHit || aShaderCache.GetHitCount() + aShaderCache.GetMissCount() != 1 )
+	{
+		printf( "%s should have been a %s\n", aName, anIsHit ? "hit" : "miss" );
+		return false;
+	}
+
+	if( !anIsHit )
+	{
+		someCompiledBytecode = aRequest.myBytecode;
+	}
+	else if( aRequest.myBytecode != someCompiledBytecode )
+	{
+		printf( "%s loaded different bytecode to the last compile\n", aName );
+		return false;
+	}
+
+	return true;
+}
+
+
+// Loads copies of the shader key check's request on the job system, each with its own define, and prints whether they
+// were hits. Returns false if any failed, wasn't the hit or miss expected, or a hit didn't load the bytecode the last
+// miss compiled
+static bool LoadStubShaders( VEShaderCache& aShaderCache, VEJobSystem& aJobSystem, const VEShaderRequest& aRequest, const char* aName,
+							 bool anIsHit, std::vector<std::vector<unsigned char> >& someCompiledBytecode )
+{
+	std::vector<VEShaderRequest>	requests( BENCHMARK_SHADER_STUB_JOBS, aRequest );
+	std::vector<VEShaderRequest*>	requestPointers;
+
+	for( unsigned int i = 0; i < requests.size(); i++ )
+	{
+		requests[i].myDefines += ";STUB_VARIANT=" + std::string( 1, (char)('A' + i) );
+		requestPointers.push_back( &requests[i] );
+	}
+
+	aShaderCache.ResetStatistics();
+
+	bool isLoaded = aShaderCache.LoadAll( requestPointers, &aJobSystem );
+
+	printf( "    %-30s %s, %u hits & %u misses\n", aName, isLoaded ? "loaded" : "failed", aShaderCache.GetHitCount(), aShaderCache.GetMissCount() );
+
+	if( !isLoaded || aShaderCache.GetHitCount() != (anIsHit ? requests.size() : 0) || aShaderCache.GetHitCount() + aShaderCache.GetMissCount() != requests.size() )
+	{
+		printf( "%s should all have been %s\n", aName, anIsHit ? "hits" : "misses" );
+		return false;
+	}
+
+	someCompiledBytecode.resize( requests.size() );
+	for( unsigned int i = 0; i < requests.size(); i++ )
+	{
+		if( requests[i].myIsCached != anIsHit || (anIsHit && requests[i].myBytecode != someCompiledBytecode[i]) )
+		{
+			printf( "%s loaded the wrong bytecode for request %u\n", aName, i );
+			return false;
+		}
+
+		someCompiledBytecode[i] = requests[i].myBytecode;
+	}
+
+	return true;
+}
+
+
+// Loads a shader through a shader cache kept in memory, with a stub in place of the D3D compiler, changing what it's
+// keyed by between loads, then loads variants of it on the job system
+bool CheckShaderKeys()
+{
+	MemoryShaderStorage	shaderStorage;
+	VEShaderCache		shaderCache( &shaderStorage, CompileStubShader, 1 );
+
+	shaderStorage.WriteData( BENCHMARK_SHADER_STUB_FILE, "#include \"StubCommon.hlsli\"\nfloat4 main() : SV_TARGET { return StubColour; }\n" );
+	shaderStorage.WriteData( BENCHMARK_SHADER_STUB_INCLUDE, "static const float4 StubColour = float4( 1.0f, 0.0f, 0.0f, 1.0f );\n" );
+
+	VEShaderRequest request;
+	request.myFile		= BENCHMARK_SHADER_STUB_FILE;
+	request.myFunction	= "main";
+	request.myProfile	= "ps_5_0";
+	request.myDefines	= "STUB_SHADOWS=1";
+
+	std::vector<unsigned char> compiledBytecode;
+
+	printf( "Loading a shader through the shader cache with a stub compiler\n" );
+
+	bool isPassed = shaderCache.Open( BENCHMARK_SHADER_CACHE_DIRECTORY );
+	isPassed = isPassed && LoadStubShader( shaderCache, request, "First load", false, compiledBytecode );
+	isPassed = isPassed && LoadStubShader( shaderCache, request, "Second load", true, compiledBytecode );
+
+	// Editing the included file, without touching the shader's own source
+	shaderStorage.WriteData( BENCHMARK_SHADER_STUB_INCLUDE, "static const float4 StubColour = float4( 0.0f, 1.0f, 0.0f, 1.0f );\n" );
+	isPassed = isPassed && LoadStubShader( shaderCache, request, "Include changed", false, compiledBytecode );
+	isPassed = isPassed && LoadStubShader( shaderCache, request, "Include changed, second load", true, compiledBytecode );
+
+	request.myDefines = "STUB_SHADOWS=0";
+	isPassed = isPassed && LoadStubShader( shaderCache, request, "Define changed", false, compiledBytecode );
+	isPassed = isPassed && LoadStubShader( shaderCache, request, "Define changed, second load", true, compiledBytecode );
+
+	shaderStorage.TearData( BENCHMARK_SHADER_CACHE_DIRECTORY, L".vsc" );
+	isPassed = isPassed && LoadStubShader( shaderCache, request, "Entry torn", false, compiledBytecode );
+	isPassed = isPassed && LoadStubShader( shaderCache, request, "Entry torn, second load", true, compiledBytecode );
+
+	shaderCache.SetCompiler( CompileStubShader, 2 );
+	isPassed = isPassed && LoadStubShader( shaderCache, request, "Compiler changed", false, compiledBytecode );
+	isPassed = isPassed && LoadStubShader( shaderCache, request, "Compiler changed, second load", true, compiledBytecode );
+
+	// Loading a set of variants at once from the job system's workers
+	VEJobSystem jobSystem;
+	if( isPassed && jobSystem.Initialise() )
+	{
+		std::vector<std::vector<unsigned char> > compiledVariants;
+
+		isPassed = LoadStubShaders( shaderCache, jobSystem, request, "Variants on the job system", false, compiledVariants );
+		isPassed = isPassed && LoadStubShaders( shaderCache, jobSystem, request, "Variants, second load", true, compiledVariants );
+	}
+	else if( isPassed )
+	{
+		printf( "Unable to start the job system\n" );
+		isPassed = false;
+	}
+
+	jobSystem.Uninitialise();
+
+	shaderCache.Close();
+
+	return isPassed;
+}
@@ -0,0 +1,29 @@
+
+// ------------------ Includes ------------------
+
+#include "Stdafx.h"
+
+
+// -------------------- Libs --------------------
+
+// DirectX    
+#pragma comment( lib, "dxgi.lib" )
+#pragma comment( lib, "d3d11.lib" )
+#pragma comment( lib, "dinput8.lib" )
+#pragma comment( lib, "dxguid.lib" )
+#pragma comment( lib, "d3dcompiler.lib" )
+
+// Windows codecs
+#pragma comment( lib, "windowscodecs.lib" )
+
+// The system timer's period, for the engine's clock
+#pragma comment( lib, "winmm.lib" )
+
+// Process memory counters
+#pragma comment( lib, "psapi.lib" )
+
+// Noise generation
+#pragma comment( lib, "libnoise.lib" )
+
+// DirectXTK
+#pragma comment( lib, "DirectXTK.lib" )
\ No newline at end of file